@@ -0,0 +1,547 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of efficiency of client attribute caches
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <iomanip>
+
+#include <arpa/inet.h>
+
+#include "attr_cache_analyzer.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+const uint64_t MicrosecondsPerSecond = 1000000U;
+const uint64_t ReportedTimeouts[] = {3U, 30U, 60U, 600U};
+
+uint64_t microseconds(const struct timeval& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * MicrosecondsPerSecond + static_cast<uint64_t>(time.tv_usec);
+}
+
+uint64_t nfstime(const NFS3::nfstime3& time)
+{
+    return (static_cast<uint64_t>(time.seconds) << 32) | time.nseconds;
+}
+
+double percent(uint64_t part, uint64_t total)
+{
+    return total == 0U ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+}
+
+//! Reads the change attribute from XDR-encoded values of fattr4 in place.
+//! Attributes are encoded in order of their numbers, so only supported_attrs,
+//! type and fh_expire_type may precede the change attribute.
+template<typename Fattr4>
+bool changeAttribute(const Fattr4& attributes, uint64_t& change)
+{
+    const uint32_t changeBit = 1U << NFS4::FATTR4_CHANGE;
+    if (attributes.attrmask.bitmap4_len == 0U || !(attributes.attrmask.bitmap4_val[0] & changeBit))
+    {
+        return false;
+    }
+    const uint32_t mask = attributes.attrmask.bitmap4_val[0];
+    const char* values = attributes.attr_vals.attrlist4_val;
+    const std::size_t size = attributes.attr_vals.attrlist4_len;
+    std::size_t position = 0U;
+    auto word = [&](uint32_t& value) -> bool
+    {
+        if (size - position < sizeof(value))
+        {
+            return false;
+        }
+        memcpy(&value, values + position, sizeof(value));
+        value = ntohl(value);
+        position += sizeof(value);
+        return true;
+    };
+
+    uint32_t value;
+    if (mask & (1U << NFS4::FATTR4_SUPPORTED_ATTRS))
+    {
+        if (!word(value) || value > (size - position) / sizeof(uint32_t))
+        {
+            return false;
+        }
+        position += value * sizeof(uint32_t);
+    }
+    if ((mask & (1U << NFS4::FATTR4_TYPE)) && !word(value))
+    {
+        return false;
+    }
+    if ((mask & (1U << NFS4::FATTR4_FH_EXPIRE_TYPE)) && !word(value))
+    {
+        return false;
+    }
+    uint32_t high;
+    uint32_t low;
+    if (!word(high) || !word(low))
+    {
+        return false;
+    }
+    change = (static_cast<uint64_t>(high) << 32) | low;
+    return true;
+}
+
+} // namespace
+
+bool AttrCacheAnalyzer::ClientAddress::operator==(const ClientAddress& other) const
+{
+    return type == other.type && memcmp(words, other.words, sizeof(words)) == 0;
+}
+
+std::string AttrCacheAnalyzer::ClientAddress::str() const
+{
+    char buf[INET6_ADDRSTRLEN];
+    if (!inet_ntop(type == Session::IPType::v4 ? AF_INET : AF_INET6, words, buf, sizeof(buf)))
+    {
+        return std::string{};
+    }
+    return std::string{buf};
+}
+
+std::size_t AttrCacheAnalyzer::ClientAddressHash::operator()(const ClientAddress& address) const
+{
+    // FNV-1a over 32-bit words of address
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t word : address.words)
+    {
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+}
+
+AttrCacheAnalyzer::AttrCacheAnalyzer(std::size_t capacity, uint64_t idleTimeout, std::ostream& out) :
+    _table{capacity, idleTimeout * MicrosecondsPerSecond},
+    _out(out),
+    _clients{},
+    _handles{},
+    _pending{}
+{
+}
+
+void AttrCacheAnalyzer::getattr3(const RPCProcedure* proc,
+                                 const struct NFS3::GETATTR3args* args,
+                                 const struct NFS3::GETATTR3res* res)
+{
+    if (args && res && res->status == NFS3::NFS3_OK)
+    {
+        account(proc, FileHandle{args->object.data.data_val, args->object.data.data_len},
+                attributes(res->GETATTR3res_u.resok.obj_attributes), true);
+    }
+}
+
+void AttrCacheAnalyzer::access3(const RPCProcedure* proc,
+                                const struct NFS3::ACCESS3args* args,
+                                const struct NFS3::ACCESS3res* res)
+{
+    if (args && res && res->status == NFS3::NFS3_OK)
+    {
+        account(proc, FileHandle{args->object.data.data_val, args->object.data.data_len},
+                attributes(res->ACCESS3res_u.resok.obj_attributes), true);
+    }
+}
+
+void AttrCacheAnalyzer::setattr3(const RPCProcedure* proc,
+                                 const struct NFS3::SETATTR3args* args,
+                                 const struct NFS3::SETATTR3res* res)
+{
+    if (args && res && res->status == NFS3::NFS3_OK)
+    {
+        account(proc, FileHandle{args->object.data.data_val, args->object.data.data_len},
+                attributes(res->SETATTR3res_u.resok.obj_wcc.after), false);
+    }
+}
+
+void AttrCacheAnalyzer::write3(const RPCProcedure* proc,
+                               const struct NFS3::WRITE3args* args,
+                               const struct NFS3::WRITE3res* res)
+{
+    if (args && res && res->status == NFS3::NFS3_OK)
+    {
+        account(proc, FileHandle{args->file.data.data_val, args->file.data.data_len},
+                attributes(res->WRITE3res_u.resok.file_wcc.after), false);
+    }
+}
+
+void AttrCacheAnalyzer::compound4(const RPCProcedure*,
+                                  const struct NFS4::COMPOUND4args*,
+                                  const struct NFS4::COMPOUND4res*)
+{
+    commitPending();
+    _handles.start();
+}
+
+void AttrCacheAnalyzer::putfh40(const RPCProcedure*,
+                                const struct NFS4::PUTFH4args* args,
+                                const struct NFS4::PUTFH4res*)
+{
+    commitPending();
+    _handles.putfh(args);
+}
+
+void AttrCacheAnalyzer::putrootfh40(const RPCProcedure*,
+                                    const struct NFS4::PUTROOTFH4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::putpubfh40(const RPCProcedure*,
+                                   const struct NFS4::PUTPUBFH4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::restorefh40(const RPCProcedure*,
+                                    const struct NFS4::RESTOREFH4res*)
+{
+    commitPending();
+    _handles.restore();
+}
+
+void AttrCacheAnalyzer::savefh40(const RPCProcedure*,
+                                 const struct NFS4::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void AttrCacheAnalyzer::lookup40(const RPCProcedure*,
+                                 const struct NFS4::LOOKUP4args*,
+                                 const struct NFS4::LOOKUP4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::lookupp40(const RPCProcedure*,
+                                  const struct NFS4::LOOKUPP4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::open40(const RPCProcedure*,
+                               const struct NFS4::OPEN4args*,
+                               const struct NFS4::OPEN4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::access40(const RPCProcedure* proc,
+                                 const struct NFS4::ACCESS4args* args,
+                                 const struct NFS4::ACCESS4res* res)
+{
+    if (args && res && res->status == NFS4::NFS4_OK)
+    {
+        accountCurrent(proc, Attributes{}, true);
+    }
+}
+
+void AttrCacheAnalyzer::getattr40(const RPCProcedure* proc,
+                                  const struct NFS4::GETATTR4args* args,
+                                  const struct NFS4::GETATTR4res* res)
+{
+    if (args && res && res->status == NFS4::NFS4_OK)
+    {
+        accountCurrent(proc, attributes(res->GETATTR4res_u.resok4.obj_attributes), true);
+    }
+}
+
+void AttrCacheAnalyzer::setattr40(const RPCProcedure* proc,
+                                  const struct NFS4::SETATTR4args* args,
+                                  const struct NFS4::SETATTR4res* res)
+{
+    if (args && res && res->status == NFS4::NFS4_OK)
+    {
+        accountCurrent(proc, Attributes{}, false);
+    }
+}
+
+void AttrCacheAnalyzer::write40(const RPCProcedure* proc,
+                                const struct NFS4::WRITE4args* args,
+                                const struct NFS4::WRITE4res* res)
+{
+    if (args && res && res->status == NFS4::NFS4_OK)
+    {
+        accountCurrent(proc, Attributes{}, false);
+    }
+}
+
+void AttrCacheAnalyzer::compound41(const RPCProcedure*,
+                                   const struct NFS41::COMPOUND4args*,
+                                   const struct NFS41::COMPOUND4res*)
+{
+    commitPending();
+    _handles.start();
+}
+
+void AttrCacheAnalyzer::putfh41(const RPCProcedure*,
+                                const struct NFS41::PUTFH4args* args,
+                                const struct NFS41::PUTFH4res*)
+{
+    commitPending();
+    _handles.putfh(args);
+}
+
+void AttrCacheAnalyzer::putrootfh41(const RPCProcedure*,
+                                    const struct NFS41::PUTROOTFH4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::putpubfh41(const RPCProcedure*,
+                                   const struct NFS41::PUTPUBFH4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::restorefh41(const RPCProcedure*,
+                                    const struct NFS41::RESTOREFH4res*)
+{
+    commitPending();
+    _handles.restore();
+}
+
+void AttrCacheAnalyzer::savefh41(const RPCProcedure*,
+                                 const struct NFS41::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void AttrCacheAnalyzer::lookup41(const RPCProcedure*,
+                                 const struct NFS41::LOOKUP4args*,
+                                 const struct NFS41::LOOKUP4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::lookupp41(const RPCProcedure*,
+                                  const struct NFS41::LOOKUPP4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::open41(const RPCProcedure*,
+                               const struct NFS41::OPEN4args*,
+                               const struct NFS41::OPEN4res*)
+{
+    commitPending();
+    _handles.forget();
+}
+
+void AttrCacheAnalyzer::access41(const RPCProcedure* proc,
+                                 const struct NFS41::ACCESS4args* args,
+                                 const struct NFS41::ACCESS4res* res)
+{
+    if (args && res && res->status == NFS41::NFS4_OK)
+    {
+        accountCurrent(proc, Attributes{}, true);
+    }
+}
+
+void AttrCacheAnalyzer::getattr41(const RPCProcedure* proc,
+                                  const struct NFS41::GETATTR4args* args,
+                                  const struct NFS41::GETATTR4res* res)
+{
+    if (args && res && res->status == NFS41::NFS4_OK)
+    {
+        accountCurrent(proc, attributes(res->GETATTR4res_u.resok4.obj_attributes), true);
+    }
+}
+
+void AttrCacheAnalyzer::setattr41(const RPCProcedure* proc,
+                                  const struct NFS41::SETATTR4args* args,
+                                  const struct NFS41::SETATTR4res* res)
+{
+    if (args && res && res->status == NFS41::NFS4_OK)
+    {
+        accountCurrent(proc, Attributes{}, false);
+    }
+}
+
+void AttrCacheAnalyzer::write41(const RPCProcedure* proc,
+                                const struct NFS41::WRITE4args* args,
+                                const struct NFS41::WRITE4res* res)
+{
+    if (args && res && res->status == NFS41::NFS4_OK)
+    {
+        accountCurrent(proc, Attributes{}, false);
+    }
+}
+
+void AttrCacheAnalyzer::flush_statistics()
+{
+    commitPending();
+
+    _out << "### Attribute cache statistics ###" << std::endl;
+    _out << "Tracked file handles: " << _table.size()
+         << " (idle evicted " << _table.idleEvictedAmount()
+         << ", evicted on overflow " << _table.forcedEvictedAmount() << ")" << std::endl;
+    for (const auto& client : _clients)
+    {
+        const RevalidationStat& stat = client.second;
+        _out << "Client " << client.first.str() << ": revalidations " << stat.total
+             << " (first " << stat.first << ", unchanged " << stat.unchanged
+             << ", changed " << stat.changed << ", unknown " << stat.unknown << ")" << std::endl;
+        _out << "  interval ";
+        for (std::size_t i = 0; i < RevalidationStat::IntervalsAmount; ++i)
+        {
+            _out << std::setw(8) << RevalidationStat::intervalLabel(i);
+        }
+        _out << std::endl << "  unchanged";
+        for (uint64_t amount : stat.unchangedIntervals)
+        {
+            _out << std::setw(8) << amount;
+        }
+        _out << std::endl << "  changed  ";
+        for (uint64_t amount : stat.changedIntervals)
+        {
+            _out << std::setw(8) << amount;
+        }
+        _out << std::endl << std::fixed << std::setprecision(1);
+        for (uint64_t timeout : ReportedTimeouts)
+        {
+            _out << "  actimeo=" << timeout << "s: saved " << stat.savedWith(timeout)
+                 << " (" << percent(stat.savedWith(timeout), stat.total) << "%)"
+                 << " stale " << stat.staleWith(timeout) << std::endl;
+        }
+        _out << "  delegation: saved " << stat.savedWithDelegation()
+             << " (" << percent(stat.savedWithDelegation(), stat.total) << "%)" << std::endl;
+        _out.unsetf(std::ios::floatfield);
+    }
+}
+
+AttrCacheAnalyzer::ClientAddress AttrCacheAnalyzer::client(const Session& session)
+{
+    ClientAddress address{{0U, 0U, 0U, 0U}, session.ip_type};
+    switch (session.ip_type)
+    {
+    case Session::IPType::v4:
+        address.words[0] = session.ip.v4.addr[Session::Source];
+        break;
+    case Session::IPType::v6:
+        memcpy(address.words, session.ip.v6.addr[Session::Source], sizeof(address.words));
+        break;
+    }
+    return address;
+}
+
+AttrCacheAnalyzer::Attributes AttrCacheAnalyzer::attributes(const NFS3::fattr3& attributes)
+{
+    return Attributes{true, {nfstime(attributes.mtime), nfstime(attributes.ctime)}};
+}
+
+AttrCacheAnalyzer::Attributes AttrCacheAnalyzer::attributes(const NFS3::post_op_attr& attributes)
+{
+    return attributes.attributes_follow ? AttrCacheAnalyzer::attributes(attributes.post_op_attr_u.attributes) : Attributes{};
+}
+
+AttrCacheAnalyzer::Attributes AttrCacheAnalyzer::attributes(const NFS4::fattr4& attributes)
+{
+    Attributes result{};
+    result.known = changeAttribute(attributes, result.version[0]);
+    return result;
+}
+
+AttrCacheAnalyzer::Attributes AttrCacheAnalyzer::attributes(const NFS41::fattr4& attributes)
+{
+    Attributes result{};
+    result.known = changeAttribute(attributes, result.version[0]);
+    return result;
+}
+
+void AttrCacheAnalyzer::account(const RPCProcedure* proc, const FileHandle& handle, const Attributes& attributes, bool counted)
+{
+    account(client(*proc->session), handle, microseconds(*proc->rtimestamp), attributes, counted);
+}
+
+void AttrCacheAnalyzer::account(const ClientAddress& client, const FileHandle& handle, uint64_t time, const Attributes& attributes, bool counted)
+{
+    AttrKey key;
+    memcpy(key.client, client.words, sizeof(key.client));
+    key.handle = handle;
+    bool inserted;
+    AttrEntry& entry = _table.find(key, time, inserted);
+    if (counted)
+    {
+        Revalidation result = Revalidation::First;
+        if (!inserted)
+        {
+            if (!attributes.known || !entry.hasAttributes)
+            {
+                result = Revalidation::Unknown;
+            }
+            else if (attributes.version[0] == entry.version[0] && attributes.version[1] == entry.version[1])
+            {
+                result = Revalidation::Unchanged;
+            }
+            else
+            {
+                result = Revalidation::Changed;
+            }
+        }
+        _clients[client].account(result, time > entry.lastSeen ? time - entry.lastSeen : 0U);
+    }
+    entry.lastSeen = time;
+    if (attributes.known)
+    {
+        entry.hasAttributes = true;
+        entry.version[0] = attributes.version[0];
+        entry.version[1] = attributes.version[1];
+    }
+}
+
+void AttrCacheAnalyzer::accountCurrent(const RPCProcedure* proc, const Attributes& attributes, bool counted)
+{
+    if (!_handles.known())
+    {
+        return;
+    }
+    if (!_pending.valid)
+    {
+        _pending = Pending{true, counted, client(*proc->session), microseconds(*proc->rtimestamp), attributes};
+        return;
+    }
+    // modification in the same COMPOUND makes the whole COMPOUND not a revalidation
+    _pending.counted = _pending.counted && counted;
+    if (attributes.known)
+    {
+        _pending.attributes = attributes;
+    }
+}
+
+void AttrCacheAnalyzer::commitPending()
+{
+    if (_pending.valid)
+    {
+        account(_pending.client, _handles.current(), _pending.time, _pending.attributes, _pending.counted);
+        _pending.valid = false;
+    }
+}
+//------------------------------------------------------------------------------
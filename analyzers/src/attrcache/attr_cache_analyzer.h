@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of efficiency of client attribute caches
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef ATTR_CACHE_ANALYZER_H
+#define ATTR_CACHE_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "api/ianalyzer.h"
+#include "common/compound_handles.h"
+#include "attr_table.h"
+#include "revalidation_stat.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer of revalidations of attributes cached by clients
+/*!
+ * Tracks per client and file handle the time of the last GETATTR or ACCESS
+ * and the attributes it returned: mtime and ctime of NFSv3 post_op_attr or
+ * the change attribute of NFSv4.x decoded in place from fattr4. Each next
+ * revalidation is classified by interval and by whether attributes changed,
+ * which shows how many revalidations would disappear with a longer attribute
+ * cache timeout or with delegations. Own SETATTR and WRITE of the client
+ * refresh attributes without being counted as revalidations.
+ *
+ * NFSv4.x operations of one COMPOUND on the current file handle are merged
+ * into one revalidation, so PUTFH, ACCESS, GETATTR is counted once.
+ */
+class AttrCacheAnalyzer : public IAnalyzer
+{
+public:
+    AttrCacheAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param capacity Max amount of tracked pairs of client and file handle
+     * \param idleTimeout Time in seconds after which an unused pair is forgotten
+     * \param out Stream to report to
+     */
+    AttrCacheAnalyzer(std::size_t capacity, uint64_t idleTimeout, std::ostream& out = std::cout);
+    AttrCacheAnalyzer(const AttrCacheAnalyzer&) = delete;
+    AttrCacheAnalyzer& operator=(const AttrCacheAnalyzer&) = delete;
+
+    // NFSv3 procedures
+
+    void getattr3(const RPCProcedure* proc,
+                  const struct NFS3::GETATTR3args* args,
+                  const struct NFS3::GETATTR3res* res) override final;
+    void access3(const RPCProcedure* proc,
+                 const struct NFS3::ACCESS3args* args,
+                 const struct NFS3::ACCESS3res* res) override final;
+    void setattr3(const RPCProcedure* proc,
+                  const struct NFS3::SETATTR3args* args,
+                  const struct NFS3::SETATTR3res* res) override final;
+    void write3(const RPCProcedure* proc,
+                const struct NFS3::WRITE3args* args,
+                const struct NFS3::WRITE3res* res) override final;
+
+    // NFSv4.0 procedures and operations
+
+    void compound4(const RPCProcedure* proc,
+                   const struct NFS4::COMPOUND4args* args,
+                   const struct NFS4::COMPOUND4res* res) override final;
+    void putfh40(const RPCProcedure* proc,
+                 const struct NFS4::PUTFH4args* args,
+                 const struct NFS4::PUTFH4res* res) override final;
+    void putrootfh40(const RPCProcedure* proc,
+                     const struct NFS4::PUTROOTFH4res* res) override final;
+    void putpubfh40(const RPCProcedure* proc,
+                    const struct NFS4::PUTPUBFH4res* res) override final;
+    void restorefh40(const RPCProcedure* proc,
+                     const struct NFS4::RESTOREFH4res* res) override final;
+    void savefh40(const RPCProcedure* proc,
+                  const struct NFS4::SAVEFH4res* res) override final;
+    void lookup40(const RPCProcedure* proc,
+                  const struct NFS4::LOOKUP4args* args,
+                  const struct NFS4::LOOKUP4res* res) override final;
+    void lookupp40(const RPCProcedure* proc,
+                   const struct NFS4::LOOKUPP4res* res) override final;
+    void open40(const RPCProcedure* proc,
+                const struct NFS4::OPEN4args* args,
+                const struct NFS4::OPEN4res* res) override final;
+    void access40(const RPCProcedure* proc,
+                  const struct NFS4::ACCESS4args* args,
+                  const struct NFS4::ACCESS4res* res) override final;
+    void getattr40(const RPCProcedure* proc,
+                   const struct NFS4::GETATTR4args* args,
+                   const struct NFS4::GETATTR4res* res) override final;
+    void setattr40(const RPCProcedure* proc,
+                   const struct NFS4::SETATTR4args* args,
+                   const struct NFS4::SETATTR4res* res) override final;
+    void write40(const RPCProcedure* proc,
+                 const struct NFS4::WRITE4args* args,
+                 const struct NFS4::WRITE4res* res) override final;
+
+    // NFSv4.1 procedures and operations
+
+    void compound41(const RPCProcedure* proc,
+                    const struct NFS41::COMPOUND4args* args,
+                    const struct NFS41::COMPOUND4res* res) override final;
+    void putfh41(const RPCProcedure* proc,
+                 const struct NFS41::PUTFH4args* args,
+                 const struct NFS41::PUTFH4res* res) override final;
+    void putrootfh41(const RPCProcedure* proc,
+                     const struct NFS41::PUTROOTFH4res* res) override final;
+    void putpubfh41(const RPCProcedure* proc,
+                    const struct NFS41::PUTPUBFH4res* res) override final;
+    void restorefh41(const RPCProcedure* proc,
+                     const struct NFS41::RESTOREFH4res* res) override final;
+    void savefh41(const RPCProcedure* proc,
+                  const struct NFS41::SAVEFH4res* res) override final;
+    void lookup41(const RPCProcedure* proc,
+                  const struct NFS41::LOOKUP4args* args,
+                  const struct NFS41::LOOKUP4res* res) override final;
+    void lookupp41(const RPCProcedure* proc,
+                   const struct NFS41::LOOKUPP4res* res) override final;
+    void open41(const RPCProcedure* proc,
+                const struct NFS41::OPEN4args* args,
+                const struct NFS41::OPEN4res* res) override final;
+    void access41(const RPCProcedure* proc,
+                  const struct NFS41::ACCESS4args* args,
+                  const struct NFS41::ACCESS4res* res) override final;
+    void getattr41(const RPCProcedure* proc,
+                   const struct NFS41::GETATTR4args* args,
+                   const struct NFS41::GETATTR4res* res) override final;
+    void setattr41(const RPCProcedure* proc,
+                   const struct NFS41::SETATTR4args* args,
+                   const struct NFS41::SETATTR4res* res) override final;
+    void write41(const RPCProcedure* proc,
+                 const struct NFS41::WRITE4args* args,
+                 const struct NFS41::WRITE4res* res) override final;
+
+    void flush_statistics() override final;
+private:
+    //! Attributes returned by server
+    struct Attributes
+    {
+        bool known;
+        uint64_t version[2];
+    };
+
+    //! IP-address of a client
+    struct ClientAddress
+    {
+        bool operator==(const ClientAddress& other) const;
+        std::string str() const;
+
+        uint32_t words[4]; // IPv4 address is stored in the first word
+        Session::IPType type;
+    };
+
+    struct ClientAddressHash
+    {
+        std::size_t operator()(const ClientAddress& address) const;
+    };
+
+    //! Revalidation of NFSv4.x COMPOUND which is not finished yet
+    struct Pending
+    {
+        bool valid;
+        bool counted;
+        ClientAddress client;
+        uint64_t time;
+        Attributes attributes;
+    };
+
+    static ClientAddress client(const Session& session);
+    static Attributes attributes(const NFS3::fattr3& attributes);
+    static Attributes attributes(const NFS3::post_op_attr& attributes);
+    static Attributes attributes(const NFS4::fattr4& attributes);
+    static Attributes attributes(const NFS41::fattr4& attributes);
+
+    void account(const RPCProcedure* proc, const FileHandle& handle, const Attributes& attributes, bool counted);
+    void account(const ClientAddress& client, const FileHandle& handle, uint64_t time, const Attributes& attributes, bool counted);
+    void accountCurrent(const RPCProcedure* proc, const Attributes& attributes, bool counted);
+    void commitPending();
+
+    AttrTable _table;
+    std::ostream& _out;
+    std::unordered_map<ClientAddress, RevalidationStat, ClientAddressHash> _clients;
+    CompoundHandles _handles; // current and saved file handles of NFSv4.x COMPOUND
+    Pending _pending;
+};
+//------------------------------------------------------------------------------
+#endif//ATTR_CACHE_ANALYZER_H
+//------------------------------------------------------------------------------
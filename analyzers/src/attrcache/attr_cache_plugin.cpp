@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Entry points of attribute cache analyzer plugin
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "api/plugin_api.h" // include plugin development definitions
+#include "attr_cache_analyzer.h"
+//------------------------------------------------------------------------------
+
+static constexpr std::size_t DefaultFilesCapacity = 65536U;
+static constexpr uint64_t DefaultIdleTimeout = 3600U;
+
+extern "C"
+{
+
+    const char* usage()
+    {
+        return "files - Max amount of pairs of client and file handle to track (default is 65536)\n"
+               "idle - Time in seconds after which an unused pair is forgotten (default is 3600)";
+    }
+
+    IAnalyzer* create(const char* opts)
+    {
+        // Initializing plugin options with default values
+        std::size_t filesCapacity = DefaultFilesCapacity;
+        uint64_t idleTimeout = DefaultIdleTimeout;
+        // Parising plugin options
+        enum
+        {
+            FILES_SUBOPT_INDEX = 0,
+            IDLE_SUBOPT_INDEX
+        };
+        char filesSubOptName[] = "files";
+        char idleSubOptName[] = "idle";
+        char* const tokens[] =
+        {
+            filesSubOptName,
+            idleSubOptName,
+            NULL
+        };
+        std::size_t optsLen = strlen(opts);
+        std::vector<char> optsBuf{opts, opts + optsLen + 2};
+        char* optionp = &optsBuf[0];
+        char* valuep;
+        int optIndex;
+        while ((optIndex = getsubopt(&optionp, tokens, &valuep)) >= 0)
+        {
+            try
+            {
+                switch (optIndex)
+                {
+                case FILES_SUBOPT_INDEX:
+                    filesCapacity = std::stoul(valuep);
+                    break;
+                case IDLE_SUBOPT_INDEX:
+                    idleTimeout = std::stoull(valuep);
+                    break;
+                default:
+                    throw std::runtime_error{std::string{"Invalid suboption index: "} + std::to_string(optIndex)};
+                }
+            }
+            catch (std::logic_error& e)
+            {
+                throw std::runtime_error{std::string{"Invalid value provided for '"} + tokens[optIndex] + "' suboption"};
+            }
+        }
+        if (filesCapacity == 0U)
+        {
+            throw std::runtime_error{"Value of 'files' suboption must be positive"};
+        }
+        // Creating and returning plugin
+        return new AttrCacheAnalyzer{filesCapacity, idleTimeout};
+    }
+
+    void destroy(IAnalyzer* instance)
+    {
+        delete instance;
+    }
+
+    NST_PLUGIN_ENTRY_POINTS (&usage, &create, &destroy, nullptr)
+
+} //extern "C"
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,171 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Arena-backed hash table of cached attributes with idle eviction
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+
+#include "attr_table.h"
+//------------------------------------------------------------------------------
+constexpr std::size_t AttrTable::ChunkSize;
+
+bool AttrKey::operator==(const AttrKey& other) const
+{
+    return memcmp(client, other.client, sizeof(client)) == 0 && handle == other.handle;
+}
+
+uint64_t AttrKey::hash() const
+{
+    uint64_t result = handle.hash();
+    for (uint32_t word : client)
+    {
+        result ^= word;
+        result *= 1099511628211ULL;
+    }
+    return result ^ (result >> 32);
+}
+
+AttrTable::AttrTable(std::size_t capacity, uint64_t idleTimeout) :
+    _capacity{std::max<std::size_t>(capacity, 1U)},
+    _idleTimeout{idleTimeout},
+    _chunks{},
+    _chunkUsed{ChunkSize},
+    _free{nullptr},
+    _buckets{},
+    _newest{nullptr},
+    _oldest{nullptr},
+    _size{0U},
+    _idleEvicted{0U},
+    _forcedEvicted{0U}
+{
+    std::size_t buckets = 1U;
+    while (buckets < _capacity)
+    {
+        buckets <<= 1;
+    }
+    _buckets.resize(buckets, nullptr);
+}
+
+AttrEntry& AttrTable::find(const AttrKey& key, uint64_t now, bool& inserted)
+{
+    while (_oldest && _oldest->lastSeen + _idleTimeout < now)
+    {
+        evict(_oldest);
+        ++_idleEvicted;
+    }
+
+    AttrEntry*& head = _buckets[bucket(key)];
+    for (AttrEntry* entry = head; entry; entry = entry->next)
+    {
+        if (entry->key == key)
+        {
+            unlink(entry);
+            pushNewest(entry);
+            inserted = false;
+            return *entry;
+        }
+    }
+
+    if (_size == _capacity)
+    {
+        evict(_oldest);
+        ++_forcedEvicted;
+    }
+    AttrEntry* entry = allocate();
+    entry->key = key;
+    entry->lastSeen = now;
+    entry->hasAttributes = false;
+    entry->version[0] = 0U;
+    entry->version[1] = 0U;
+    entry->next = head;
+    head = entry;
+    pushNewest(entry);
+    ++_size;
+    inserted = true;
+    return *entry;
+}
+
+AttrEntry* AttrTable::allocate()
+{
+    if (_free)
+    {
+        AttrEntry* entry = _free;
+        _free = entry->next;
+        return entry;
+    }
+    if (_chunkUsed == ChunkSize)
+    {
+        _chunks.emplace_back(new AttrEntry[ChunkSize]);
+        _chunkUsed = 0U;
+    }
+    return &_chunks.back()[_chunkUsed++];
+}
+
+void AttrTable::evict(AttrEntry* entry)
+{
+    AttrEntry** link = &_buckets[bucket(entry->key)];
+    while (*link != entry)
+    {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    unlink(entry);
+    entry->next = _free;
+    _free = entry;
+    --_size;
+}
+
+void AttrTable::unlink(AttrEntry* entry)
+{
+    if (entry->newer)
+    {
+        entry->newer->older = entry->older;
+    }
+    else
+    {
+        _newest = entry->older;
+    }
+    if (entry->older)
+    {
+        entry->older->newer = entry->newer;
+    }
+    else
+    {
+        _oldest = entry->newer;
+    }
+    entry->newer = nullptr;
+    entry->older = nullptr;
+}
+
+void AttrTable::pushNewest(AttrEntry* entry)
+{
+    entry->older = _newest;
+    entry->newer = nullptr;
+    if (_newest)
+    {
+        _newest->newer = entry;
+    }
+    _newest = entry;
+    if (!_oldest)
+    {
+        _oldest = entry;
+    }
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Arena-backed hash table of cached attributes with idle eviction
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef ATTR_TABLE_H
+#define ATTR_TABLE_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/file_handle.h"
+//------------------------------------------------------------------------------
+//! File handle as seen by a client
+struct AttrKey
+{
+    bool operator==(const AttrKey& other) const;
+    uint64_t hash() const;
+
+    uint32_t client[4]; // IP-address, IPv4 address is stored in the first word
+    FileHandle handle;
+};
+
+//! Attributes of file last seen by a client
+struct AttrEntry
+{
+    AttrKey key;
+    uint64_t lastSeen;    // time of the last revalidation, microseconds
+    bool hasAttributes;
+    uint64_t version[2];  // NFSv3 mtime and ctime or NFSv4 change attribute
+    AttrEntry* next;      // next entry of bucket or of free list
+    AttrEntry* newer;
+    AttrEntry* older;
+};
+
+//! Hash table of attributes with bounded capacity
+/*!
+ * Entries are allocated from an arena of fixed-size chunks and reused through
+ * a free list, so the table allocates memory only while it grows to capacity.
+ * Entries are linked in order of their last access: entries idle for longer
+ * than idle timeout are evicted from the old end on each lookup, and the
+ * oldest entry is evicted when the table is full.
+ */
+class AttrTable
+{
+public:
+    static constexpr std::size_t ChunkSize = 1024U;
+
+    AttrTable() = delete;
+    //! Constructs table
+    /*!
+     * \param capacity Max amount of entries
+     * \param idleTimeout Time in microseconds after which unused entry is evicted
+     */
+    AttrTable(std::size_t capacity, uint64_t idleTimeout);
+    AttrTable(const AttrTable&) = delete;
+    AttrTable& operator=(const AttrTable&) = delete;
+
+    //! Finds or inserts entry of key and marks it as the most recent
+    /*!
+     * \param key Key
+     * \param now Current time in microseconds
+     * \param inserted Set to true if the entry is new
+     * \return Entry, a new entry has only key filled
+     */
+    AttrEntry& find(const AttrKey& key, uint64_t now, bool& inserted);
+
+    inline std::size_t size() const
+    {
+        return _size;
+    }
+    inline uint64_t idleEvictedAmount() const
+    {
+        return _idleEvicted;
+    }
+    inline uint64_t forcedEvictedAmount() const
+    {
+        return _forcedEvicted;
+    }
+private:
+    AttrEntry* allocate();
+    void evict(AttrEntry* entry);
+    void unlink(AttrEntry* entry);
+    void pushNewest(AttrEntry* entry);
+    inline std::size_t bucket(const AttrKey& key) const
+    {
+        return static_cast<std::size_t>(key.hash()) & (_buckets.size() - 1);
+    }
+
+    std::size_t _capacity;
+    uint64_t _idleTimeout;
+    std::vector<std::unique_ptr<AttrEntry[]>> _chunks;
+    std::size_t _chunkUsed; // amount of used entries in the last chunk
+    AttrEntry* _free;
+    std::vector<AttrEntry*> _buckets;
+    AttrEntry* _newest;
+    AttrEntry* _oldest;
+    std::size_t _size;
+    uint64_t _idleEvicted;
+    uint64_t _forcedEvicted;
+};
+//------------------------------------------------------------------------------
+#endif//ATTR_TABLE_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Statistics of revalidations of cached attributes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include "revalidation_stat.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+const uint64_t IntervalBounds[RevalidationStat::IntervalsAmount] = {1U, 3U, 10U, 30U, 60U, 300U, 600U, 0U};
+const char* const IntervalLabels[RevalidationStat::IntervalsAmount] =
+{
+    "<1s", "<3s", "<10s", "<30s", "<60s", "<300s", "<600s", ">=600s"
+};
+const uint64_t MicrosecondsPerSecond = 1000000U;
+
+} // namespace
+
+constexpr std::size_t RevalidationStat::IntervalsAmount;
+
+uint64_t RevalidationStat::intervalBound(std::size_t interval)
+{
+    return interval < IntervalsAmount ? IntervalBounds[interval] : 0U;
+}
+
+const char* RevalidationStat::intervalLabel(std::size_t interval)
+{
+    return interval < IntervalsAmount ? IntervalLabels[interval] : "";
+}
+
+void RevalidationStat::account(Revalidation result, uint64_t interval)
+{
+    std::size_t index = 0U;
+    while (index < IntervalsAmount - 1 && interval >= IntervalBounds[index] * MicrosecondsPerSecond)
+    {
+        ++index;
+    }
+
+    ++total;
+    switch (result)
+    {
+    case Revalidation::First:
+        ++first;
+        break;
+    case Revalidation::Unchanged:
+        ++unchanged;
+        ++unchangedIntervals[index];
+        break;
+    case Revalidation::Changed:
+        ++changed;
+        ++changedIntervals[index];
+        break;
+    case Revalidation::Unknown:
+        ++unknown;
+        break;
+    }
+}
+
+uint64_t RevalidationStat::savedWith(uint64_t timeout) const
+{
+    return sumWithin(unchangedIntervals, timeout);
+}
+
+uint64_t RevalidationStat::staleWith(uint64_t timeout) const
+{
+    return sumWithin(changedIntervals, timeout);
+}
+
+uint64_t RevalidationStat::sumWithin(const uint64_t (&intervals)[IntervalsAmount], uint64_t timeout)
+{
+    uint64_t result = 0U;
+    for (std::size_t i = 0; i < IntervalsAmount - 1 && IntervalBounds[i] <= timeout; ++i)
+    {
+        result += intervals[i];
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
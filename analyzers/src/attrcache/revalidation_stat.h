@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Statistics of revalidations of cached attributes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef REVALIDATION_STAT_H
+#define REVALIDATION_STAT_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdlib>
+//------------------------------------------------------------------------------
+//! Result of revalidation compared with the previous one of the same file
+enum class Revalidation
+{
+    First,     //!< No previous revalidation
+    Unchanged, //!< Attributes are the same
+    Changed,   //!< Attributes are changed
+    Unknown    //!< Attributes of either revalidation are unknown
+};
+
+//! Revalidations of a client split by interval since the previous revalidation
+/*!
+ * A revalidation which found unchanged attributes within attribute cache
+ * timeout would be served from cache, one which found changed attributes
+ * would return stale data instead. With a delegation only revalidations
+ * with unchanged attributes disappear.
+ */
+class RevalidationStat
+{
+public:
+    static constexpr std::size_t IntervalsAmount = 8U;
+
+    //! Returns upper bound of interval in seconds, 0 for the last unbounded one
+    static uint64_t intervalBound(std::size_t interval);
+    //! Returns label of interval ("<1s", ..., ">=600s")
+    static const char* intervalLabel(std::size_t interval);
+
+    //! Accounts revalidation
+    /*!
+     * \param result Result of revalidation
+     * \param interval Time since the previous revalidation in microseconds
+     */
+    void account(Revalidation result, uint64_t interval);
+
+    //! Returns amount of revalidations served from cache with attribute timeout
+    /*!
+     * \param timeout Timeout in seconds, intervals up to the greatest bound
+     * not above timeout are counted
+     */
+    uint64_t savedWith(uint64_t timeout) const;
+    //! Returns amount of revalidations returning stale attributes with timeout
+    uint64_t staleWith(uint64_t timeout) const;
+    //! Returns amount of revalidations disappearing with delegations
+    inline uint64_t savedWithDelegation() const
+    {
+        return unchanged;
+    }
+
+    uint64_t total {0U};
+    uint64_t first {0U};
+    uint64_t unchanged {0U};
+    uint64_t changed {0U};
+    uint64_t unknown {0U};
+    uint64_t unchangedIntervals[IntervalsAmount] {};
+    uint64_t changedIntervals[IntervalsAmount] {};
+private:
+    static uint64_t sumWithin(const uint64_t (&intervals)[IntervalsAmount], uint64_t timeout);
+};
+//------------------------------------------------------------------------------
+#endif//REVALIDATION_STAT_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,1290 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer writing NFS operations to columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "api/plugin_api.h"
+#include "columnar_analyzer.h"
+//------------------------------------------------------------------------------
+using namespace Columnar;
+
+namespace
+{
+
+uint64_t microseconds(const struct timeval& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000U + static_cast<uint64_t>(time.tv_usec);
+}
+
+} // namespace
+
+constexpr uint32_t ColumnarAnalyzer::NoStatus;
+
+const Schema& ColumnarAnalyzer::schema()
+{
+    static const Schema columns
+    {
+        {"timestamp", Type::U64,    Codec::Delta},
+        {"xid",       Type::U32,    Codec::Delta},
+        {"program",   Type::U8,     Codec::Varint},
+        {"procedure", Type::U16,    Codec::Varint},
+        {"status",    Type::U32,    Codec::Varint},
+        {"latency",   Type::U32,    Codec::Varint},
+        {"offset",    Type::U64,    Codec::Delta},
+        {"size",      Type::U32,    Codec::Varint},
+        {"session",   Type::String, Codec::Varint},
+        {"name",      Type::String, Codec::Varint}
+    };
+    return columns;
+}
+
+ColumnarAnalyzer::ColumnarAnalyzer(const std::string& path, std::size_t blockRows, std::ostream& out) :
+    _writer{path, schema(), blockRows},
+    _out(out),
+    _sessions{},
+    _sessionKey{}
+{
+    // Empty name has id 0
+    _writer.intern(Name, "", 0U);
+}
+
+void ColumnarAnalyzer::null(const RPCProcedure* proc,
+                            const struct NFS3::NULL3args*,
+                            const struct NFS3::NULL3res*)
+{
+    commit(start(proc, Version::NFSv3, ProcEnumNFS3::NFS_NULL));
+}
+
+void ColumnarAnalyzer::getattr3(const RPCProcedure* proc,
+                                const struct NFS3::GETATTR3args*,
+                                const struct NFS3::GETATTR3res* res)
+{
+    operation(proc, Version::NFSv3, ProcEnumNFS3::GETATTR, res);
+}
+
+void ColumnarAnalyzer::setattr3(const RPCProcedure* proc,
+                                const struct NFS3::SETATTR3args*,
+                                const struct NFS3::SETATTR3res* res)
+{
+    operation(proc, Version::NFSv3, ProcEnumNFS3::SETATTR, res);
+}
+
+void ColumnarAnalyzer::lookup3(const RPCProcedure* proc,
+                               const struct NFS3::LOOKUP3args* args,
+                               const struct NFS3::LOOKUP3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::LOOKUP);
+    if (args)
+    {
+        setName(row, args->what.name, strlen(args->what.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::access3(const RPCProcedure* proc,
+                               const struct NFS3::ACCESS3args*,
+                               const struct NFS3::ACCESS3res* res)
+{
+    operation(proc, Version::NFSv3, ProcEnumNFS3::ACCESS, res);
+}
+
+void ColumnarAnalyzer::readlink3(const RPCProcedure* proc,
+                                 const struct NFS3::READLINK3args*,
+                                 const struct NFS3::READLINK3res* res)
+{
+    operation(proc, Version::NFSv3, ProcEnumNFS3::READLINK, res);
+}
+
+void ColumnarAnalyzer::read3(const RPCProcedure* proc,
+                             const struct NFS3::READ3args* args,
+                             const struct NFS3::READ3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::READ);
+    if (args)
+    {
+        setRange(row, args->offset, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::write3(const RPCProcedure* proc,
+                              const struct NFS3::WRITE3args* args,
+                              const struct NFS3::WRITE3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::WRITE);
+    if (args)
+    {
+        setRange(row, args->offset, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::create3(const RPCProcedure* proc,
+                               const struct NFS3::CREATE3args* args,
+                               const struct NFS3::CREATE3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::CREATE);
+    if (args)
+    {
+        setName(row, args->where.name, strlen(args->where.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::mkdir3(const RPCProcedure* proc,
+                              const struct NFS3::MKDIR3args* args,
+                              const struct NFS3::MKDIR3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::MKDIR);
+    if (args)
+    {
+        setName(row, args->where.name, strlen(args->where.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::symlink3(const RPCProcedure* proc,
+                                const struct NFS3::SYMLINK3args* args,
+                                const struct NFS3::SYMLINK3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::SYMLINK);
+    if (args)
+    {
+        setName(row, args->where.name, strlen(args->where.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::mknod3(const RPCProcedure* proc,
+                              const struct NFS3::MKNOD3args* args,
+                              const struct NFS3::MKNOD3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::MKNOD);
+    if (args)
+    {
+        setName(row, args->where.name, strlen(args->where.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::remove3(const RPCProcedure* proc,
+                               const struct NFS3::REMOVE3args* args,
+                               const struct NFS3::REMOVE3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::REMOVE);
+    if (args)
+    {
+        setName(row, args->object.name, strlen(args->object.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::rmdir3(const RPCProcedure* proc,
+                              const struct NFS3::RMDIR3args* args,
+                              const struct NFS3::RMDIR3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::RMDIR);
+    if (args)
+    {
+        setName(row, args->object.name, strlen(args->object.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::rename3(const RPCProcedure* proc,
+                               const struct NFS3::RENAME3args* args,
+                               const struct NFS3::RENAME3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::RENAME);
+    if (args)
+    {
+        setName(row, args->from.name, strlen(args->from.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::link3(const RPCProcedure* proc,
+                             const struct NFS3::LINK3args* args,
+                             const struct NFS3::LINK3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::LINK);
+    if (args)
+    {
+        setName(row, args->link.name, strlen(args->link.name));
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::readdir3(const RPCProcedure* proc,
+                                const struct NFS3::READDIR3args* args,
+                                const struct NFS3::READDIR3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::READDIR);
+    if (args)
+    {
+        setRange(row, args->cookie, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::readdirplus3(const RPCProcedure* proc,
+                                    const struct NFS3::READDIRPLUS3args* args,
+                                    const struct NFS3::READDIRPLUS3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::READDIRPLUS);
+    if (args)
+    {
+        setRange(row, args->cookie, args->maxcount);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::fsstat3(const RPCProcedure* proc,
+                               const struct NFS3::FSSTAT3args*,
+                               const struct NFS3::FSSTAT3res* res)
+{
+    operation(proc, Version::NFSv3, ProcEnumNFS3::FSSTAT, res);
+}
+
+void ColumnarAnalyzer::fsinfo3(const RPCProcedure* proc,
+                               const struct NFS3::FSINFO3args*,
+                               const struct NFS3::FSINFO3res* res)
+{
+    operation(proc, Version::NFSv3, ProcEnumNFS3::FSINFO, res);
+}
+
+void ColumnarAnalyzer::pathconf3(const RPCProcedure* proc,
+                                 const struct NFS3::PATHCONF3args*,
+                                 const struct NFS3::PATHCONF3res* res)
+{
+    operation(proc, Version::NFSv3, ProcEnumNFS3::PATHCONF, res);
+}
+
+void ColumnarAnalyzer::commit3(const RPCProcedure* proc,
+                               const struct NFS3::COMMIT3args* args,
+                               const struct NFS3::COMMIT3res* res)
+{
+    Row row = start(proc, Version::NFSv3, ProcEnumNFS3::COMMIT);
+    if (args)
+    {
+        setRange(row, args->offset, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::null4(const RPCProcedure* proc,
+                             const struct NFS4::NULL4args*,
+                             const struct NFS4::NULL4res*)
+{
+    commit(start(proc, Version::NFSv40, ProcEnumNFS4::NFS_NULL));
+}
+
+void ColumnarAnalyzer::access40(const RPCProcedure* proc,
+                                const struct NFS4::ACCESS4args*,
+                                const struct NFS4::ACCESS4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::ACCESS, res);
+}
+
+void ColumnarAnalyzer::close40(const RPCProcedure* proc,
+                               const struct NFS4::CLOSE4args*,
+                               const struct NFS4::CLOSE4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::CLOSE, res);
+}
+
+void ColumnarAnalyzer::commit40(const RPCProcedure* proc,
+                                const struct NFS4::COMMIT4args* args,
+                                const struct NFS4::COMMIT4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::COMMIT);
+    if (args)
+    {
+        setRange(row, args->offset, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::create40(const RPCProcedure* proc,
+                                const struct NFS4::CREATE4args* args,
+                                const struct NFS4::CREATE4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::CREATE);
+    if (args)
+    {
+        setName(row, args->objname.utf8string_val, args->objname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::delegpurge40(const RPCProcedure* proc,
+                                    const struct NFS4::DELEGPURGE4args*,
+                                    const struct NFS4::DELEGPURGE4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::DELEGPURGE, res);
+}
+
+void ColumnarAnalyzer::delegreturn40(const RPCProcedure* proc,
+                                     const struct NFS4::DELEGRETURN4args*,
+                                     const struct NFS4::DELEGRETURN4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::DELEGRETURN, res);
+}
+
+void ColumnarAnalyzer::getattr40(const RPCProcedure* proc,
+                                 const struct NFS4::GETATTR4args*,
+                                 const struct NFS4::GETATTR4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::GETATTR, res);
+}
+
+void ColumnarAnalyzer::getfh40(const RPCProcedure* proc,
+                               const struct NFS4::GETFH4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::GETFH, res);
+}
+
+void ColumnarAnalyzer::link40(const RPCProcedure* proc,
+                              const struct NFS4::LINK4args* args,
+                              const struct NFS4::LINK4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::LINK);
+    if (args)
+    {
+        setName(row, args->newname.utf8string_val, args->newname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::lock40(const RPCProcedure* proc,
+                              const struct NFS4::LOCK4args*,
+                              const struct NFS4::LOCK4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::LOCK, res);
+}
+
+void ColumnarAnalyzer::lockt40(const RPCProcedure* proc,
+                               const struct NFS4::LOCKT4args*,
+                               const struct NFS4::LOCKT4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::LOCKT, res);
+}
+
+void ColumnarAnalyzer::locku40(const RPCProcedure* proc,
+                               const struct NFS4::LOCKU4args*,
+                               const struct NFS4::LOCKU4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::LOCKU, res);
+}
+
+void ColumnarAnalyzer::lookup40(const RPCProcedure* proc,
+                                const struct NFS4::LOOKUP4args* args,
+                                const struct NFS4::LOOKUP4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::LOOKUP);
+    if (args)
+    {
+        setName(row, args->objname.utf8string_val, args->objname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::lookupp40(const RPCProcedure* proc,
+                                 const struct NFS4::LOOKUPP4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::LOOKUPP, res);
+}
+
+void ColumnarAnalyzer::nverify40(const RPCProcedure* proc,
+                                 const struct NFS4::NVERIFY4args*,
+                                 const struct NFS4::NVERIFY4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::NVERIFY, res);
+}
+
+void ColumnarAnalyzer::open40(const RPCProcedure* proc,
+                              const struct NFS4::OPEN4args* args,
+                              const struct NFS4::OPEN4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::OPEN);
+    if (args && args->claim.claim == NFS4::CLAIM_NULL)
+    {
+        setName(row, args->claim.open_claim4_u.file.utf8string_val, args->claim.open_claim4_u.file.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::openattr40(const RPCProcedure* proc,
+                                  const struct NFS4::OPENATTR4args*,
+                                  const struct NFS4::OPENATTR4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::OPENATTR, res);
+}
+
+void ColumnarAnalyzer::open_confirm40(const RPCProcedure* proc,
+                                      const struct NFS4::OPEN_CONFIRM4args*,
+                                      const struct NFS4::OPEN_CONFIRM4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::OPEN_CONFIRM, res);
+}
+
+void ColumnarAnalyzer::open_downgrade40(const RPCProcedure* proc,
+                                        const struct NFS4::OPEN_DOWNGRADE4args*,
+                                        const struct NFS4::OPEN_DOWNGRADE4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::OPEN_DOWNGRADE, res);
+}
+
+void ColumnarAnalyzer::putfh40(const RPCProcedure* proc,
+                               const struct NFS4::PUTFH4args*,
+                               const struct NFS4::PUTFH4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::PUTFH, res);
+}
+
+void ColumnarAnalyzer::putpubfh40(const RPCProcedure* proc,
+                                  const struct NFS4::PUTPUBFH4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::PUTPUBFH, res);
+}
+
+void ColumnarAnalyzer::putrootfh40(const RPCProcedure* proc,
+                                   const struct NFS4::PUTROOTFH4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::PUTROOTFH, res);
+}
+
+void ColumnarAnalyzer::read40(const RPCProcedure* proc,
+                              const struct NFS4::READ4args* args,
+                              const struct NFS4::READ4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::READ);
+    if (args)
+    {
+        setRange(row, args->offset, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::readdir40(const RPCProcedure* proc,
+                                 const struct NFS4::READDIR4args* args,
+                                 const struct NFS4::READDIR4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::READDIR);
+    if (args)
+    {
+        setRange(row, args->cookie, args->maxcount);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::readlink40(const RPCProcedure* proc,
+                                  const struct NFS4::READLINK4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::READLINK, res);
+}
+
+void ColumnarAnalyzer::remove40(const RPCProcedure* proc,
+                                const struct NFS4::REMOVE4args* args,
+                                const struct NFS4::REMOVE4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::REMOVE);
+    if (args)
+    {
+        setName(row, args->target.utf8string_val, args->target.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::rename40(const RPCProcedure* proc,
+                                const struct NFS4::RENAME4args* args,
+                                const struct NFS4::RENAME4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::RENAME);
+    if (args)
+    {
+        setName(row, args->oldname.utf8string_val, args->oldname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::renew40(const RPCProcedure* proc,
+                               const struct NFS4::RENEW4args*,
+                               const struct NFS4::RENEW4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::RENEW, res);
+}
+
+void ColumnarAnalyzer::restorefh40(const RPCProcedure* proc,
+                                   const struct NFS4::RESTOREFH4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::RESTOREFH, res);
+}
+
+void ColumnarAnalyzer::savefh40(const RPCProcedure* proc,
+                                const struct NFS4::SAVEFH4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::SAVEFH, res);
+}
+
+void ColumnarAnalyzer::secinfo40(const RPCProcedure* proc,
+                                 const struct NFS4::SECINFO4args* args,
+                                 const struct NFS4::SECINFO4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::SECINFO);
+    if (args)
+    {
+        setName(row, args->name.utf8string_val, args->name.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::setattr40(const RPCProcedure* proc,
+                                 const struct NFS4::SETATTR4args*,
+                                 const struct NFS4::SETATTR4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::SETATTR, res);
+}
+
+void ColumnarAnalyzer::setclientid40(const RPCProcedure* proc,
+                                     const struct NFS4::SETCLIENTID4args*,
+                                     const struct NFS4::SETCLIENTID4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::SETCLIENTID, res);
+}
+
+void ColumnarAnalyzer::setclientid_confirm40(const RPCProcedure* proc,
+                                             const struct NFS4::SETCLIENTID_CONFIRM4args*,
+                                             const struct NFS4::SETCLIENTID_CONFIRM4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::SETCLIENTID_CONFIRM, res);
+}
+
+void ColumnarAnalyzer::verify40(const RPCProcedure* proc,
+                                const struct NFS4::VERIFY4args*,
+                                const struct NFS4::VERIFY4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::VERIFY, res);
+}
+
+void ColumnarAnalyzer::write40(const RPCProcedure* proc,
+                               const struct NFS4::WRITE4args* args,
+                               const struct NFS4::WRITE4res* res)
+{
+    Row row = start(proc, Version::NFSv40, ProcEnumNFS4::WRITE);
+    if (args)
+    {
+        setRange(row, args->offset, args->data.data_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::release_lockowner40(const RPCProcedure* proc,
+                                           const struct NFS4::RELEASE_LOCKOWNER4args*,
+                                           const struct NFS4::RELEASE_LOCKOWNER4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::RELEASE_LOCKOWNER, res);
+}
+
+void ColumnarAnalyzer::get_dir_delegation40(const RPCProcedure* proc,
+                                            const struct NFS4::GET_DIR_DELEGATION4args*,
+                                            const struct NFS4::GET_DIR_DELEGATION4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::GET_DIR_DELEGATION, res);
+}
+
+void ColumnarAnalyzer::illegal40(const RPCProcedure* proc,
+                                 const struct NFS4::ILLEGAL4res* res)
+{
+    operation(proc, Version::NFSv40, ProcEnumNFS4::ILLEGAL, res);
+}
+
+void ColumnarAnalyzer::access41(const RPCProcedure* proc,
+                                const struct NFS41::ACCESS4args*,
+                                const struct NFS41::ACCESS4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::ACCESS, res);
+}
+
+void ColumnarAnalyzer::close41(const RPCProcedure* proc,
+                               const struct NFS41::CLOSE4args*,
+                               const struct NFS41::CLOSE4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::CLOSE, res);
+}
+
+void ColumnarAnalyzer::commit41(const RPCProcedure* proc,
+                                const struct NFS41::COMMIT4args* args,
+                                const struct NFS41::COMMIT4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::COMMIT);
+    if (args)
+    {
+        setRange(row, args->offset, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::create41(const RPCProcedure* proc,
+                                const struct NFS41::CREATE4args* args,
+                                const struct NFS41::CREATE4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::CREATE);
+    if (args)
+    {
+        setName(row, args->objname.utf8string_val, args->objname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::delegpurge41(const RPCProcedure* proc,
+                                    const struct NFS41::DELEGPURGE4args*,
+                                    const struct NFS41::DELEGPURGE4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::DELEGPURGE, res);
+}
+
+void ColumnarAnalyzer::delegreturn41(const RPCProcedure* proc,
+                                     const struct NFS41::DELEGRETURN4args*,
+                                     const struct NFS41::DELEGRETURN4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::DELEGRETURN, res);
+}
+
+void ColumnarAnalyzer::getattr41(const RPCProcedure* proc,
+                                 const struct NFS41::GETATTR4args*,
+                                 const struct NFS41::GETATTR4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::GETATTR, res);
+}
+
+void ColumnarAnalyzer::getfh41(const RPCProcedure* proc,
+                               const struct NFS41::GETFH4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::GETFH, res);
+}
+
+void ColumnarAnalyzer::link41(const RPCProcedure* proc,
+                              const struct NFS41::LINK4args* args,
+                              const struct NFS41::LINK4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::LINK);
+    if (args)
+    {
+        setName(row, args->newname.utf8string_val, args->newname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::lock41(const RPCProcedure* proc,
+                              const struct NFS41::LOCK4args*,
+                              const struct NFS41::LOCK4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::LOCK, res);
+}
+
+void ColumnarAnalyzer::lockt41(const RPCProcedure* proc,
+                               const struct NFS41::LOCKT4args*,
+                               const struct NFS41::LOCKT4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::LOCKT, res);
+}
+
+void ColumnarAnalyzer::locku41(const RPCProcedure* proc,
+                               const struct NFS41::LOCKU4args*,
+                               const struct NFS41::LOCKU4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::LOCKU, res);
+}
+
+void ColumnarAnalyzer::lookup41(const RPCProcedure* proc,
+                                const struct NFS41::LOOKUP4args* args,
+                                const struct NFS41::LOOKUP4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::LOOKUP);
+    if (args)
+    {
+        setName(row, args->objname.utf8string_val, args->objname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::lookupp41(const RPCProcedure* proc,
+                                 const struct NFS41::LOOKUPP4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::LOOKUPP, res);
+}
+
+void ColumnarAnalyzer::nverify41(const RPCProcedure* proc,
+                                 const struct NFS41::NVERIFY4args*,
+                                 const struct NFS41::NVERIFY4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::NVERIFY, res);
+}
+
+void ColumnarAnalyzer::open41(const RPCProcedure* proc,
+                              const struct NFS41::OPEN4args* args,
+                              const struct NFS41::OPEN4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::OPEN);
+    if (args && args->claim.claim == NFS41::CLAIM_NULL)
+    {
+        setName(row, args->claim.open_claim4_u.file.utf8string_val, args->claim.open_claim4_u.file.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::openattr41(const RPCProcedure* proc,
+                                  const struct NFS41::OPENATTR4args*,
+                                  const struct NFS41::OPENATTR4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::OPENATTR, res);
+}
+
+void ColumnarAnalyzer::open_confirm41(const RPCProcedure* proc,
+                                      const struct NFS41::OPEN_CONFIRM4args*,
+                                      const struct NFS41::OPEN_CONFIRM4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::OPEN_CONFIRM, res);
+}
+
+void ColumnarAnalyzer::open_downgrade41(const RPCProcedure* proc,
+                                        const struct NFS41::OPEN_DOWNGRADE4args*,
+                                        const struct NFS41::OPEN_DOWNGRADE4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::OPEN_DOWNGRADE, res);
+}
+
+void ColumnarAnalyzer::putfh41(const RPCProcedure* proc,
+                               const struct NFS41::PUTFH4args*,
+                               const struct NFS41::PUTFH4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::PUTFH, res);
+}
+
+void ColumnarAnalyzer::putpubfh41(const RPCProcedure* proc,
+                                  const struct NFS41::PUTPUBFH4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::PUTPUBFH, res);
+}
+
+void ColumnarAnalyzer::putrootfh41(const RPCProcedure* proc,
+                                   const struct NFS41::PUTROOTFH4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::PUTROOTFH, res);
+}
+
+void ColumnarAnalyzer::read41(const RPCProcedure* proc,
+                              const struct NFS41::READ4args* args,
+                              const struct NFS41::READ4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::READ);
+    if (args)
+    {
+        setRange(row, args->offset, args->count);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::readdir41(const RPCProcedure* proc,
+                                 const struct NFS41::READDIR4args* args,
+                                 const struct NFS41::READDIR4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::READDIR);
+    if (args)
+    {
+        setRange(row, args->cookie, args->maxcount);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::readlink41(const RPCProcedure* proc,
+                                  const struct NFS41::READLINK4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::READLINK, res);
+}
+
+void ColumnarAnalyzer::remove41(const RPCProcedure* proc,
+                                const struct NFS41::REMOVE4args* args,
+                                const struct NFS41::REMOVE4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::REMOVE);
+    if (args)
+    {
+        setName(row, args->target.utf8string_val, args->target.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::rename41(const RPCProcedure* proc,
+                                const struct NFS41::RENAME4args* args,
+                                const struct NFS41::RENAME4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::RENAME);
+    if (args)
+    {
+        setName(row, args->oldname.utf8string_val, args->oldname.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::renew41(const RPCProcedure* proc,
+                               const struct NFS41::RENEW4args*,
+                               const struct NFS41::RENEW4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::RENEW, res);
+}
+
+void ColumnarAnalyzer::restorefh41(const RPCProcedure* proc,
+                                   const struct NFS41::RESTOREFH4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::RESTOREFH, res);
+}
+
+void ColumnarAnalyzer::savefh41(const RPCProcedure* proc,
+                                const struct NFS41::SAVEFH4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::SAVEFH, res);
+}
+
+void ColumnarAnalyzer::secinfo41(const RPCProcedure* proc,
+                                 const struct NFS41::SECINFO4args* args,
+                                 const struct NFS41::SECINFO4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::SECINFO);
+    if (args)
+    {
+        setName(row, args->name.utf8string_val, args->name.utf8string_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::setattr41(const RPCProcedure* proc,
+                                 const struct NFS41::SETATTR4args*,
+                                 const struct NFS41::SETATTR4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::SETATTR, res);
+}
+
+void ColumnarAnalyzer::setclientid41(const RPCProcedure* proc,
+                                     const struct NFS41::SETCLIENTID4args*,
+                                     const struct NFS41::SETCLIENTID4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::SETCLIENTID, res);
+}
+
+void ColumnarAnalyzer::setclientid_confirm41(const RPCProcedure* proc,
+                                             const struct NFS41::SETCLIENTID_CONFIRM4args*,
+                                             const struct NFS41::SETCLIENTID_CONFIRM4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::SETCLIENTID_CONFIRM, res);
+}
+
+void ColumnarAnalyzer::verify41(const RPCProcedure* proc,
+                                const struct NFS41::VERIFY4args*,
+                                const struct NFS41::VERIFY4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::VERIFY, res);
+}
+
+void ColumnarAnalyzer::write41(const RPCProcedure* proc,
+                               const struct NFS41::WRITE4args* args,
+                               const struct NFS41::WRITE4res* res)
+{
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::WRITE);
+    if (args)
+    {
+        setRange(row, args->offset, args->data.data_len);
+    }
+    setStatus(row, res);
+    commit(row);
+}
+
+void ColumnarAnalyzer::release_lockowner41(const RPCProcedure* proc,
+                                           const struct NFS41::RELEASE_LOCKOWNER4args*,
+                                           const struct NFS41::RELEASE_LOCKOWNER4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::RELEASE_LOCKOWNER, res);
+}
+
+void ColumnarAnalyzer::backchannel_ctl41(const RPCProcedure* proc,
+                                         const struct NFS41::BACKCHANNEL_CTL4args*,
+                                         const struct NFS41::BACKCHANNEL_CTL4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::BACKCHANNEL_CTL);
+    if (res)
+    {
+        row.values[Status] = res->bcr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::bind_conn_to_session41(const RPCProcedure* proc,
+                                              const struct NFS41::BIND_CONN_TO_SESSION4args*,
+                                              const struct NFS41::BIND_CONN_TO_SESSION4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::BIND_CONN_TO_SESSION);
+    if (res)
+    {
+        row.values[Status] = res->bctsr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::exchange_id41(const RPCProcedure* proc,
+                                     const struct NFS41::EXCHANGE_ID4args*,
+                                     const struct NFS41::EXCHANGE_ID4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::EXCHANGE_ID);
+    if (res)
+    {
+        row.values[Status] = res->eir_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::create_session41(const RPCProcedure* proc,
+                                        const struct NFS41::CREATE_SESSION4args*,
+                                        const struct NFS41::CREATE_SESSION4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::CREATE_SESSION);
+    if (res)
+    {
+        row.values[Status] = res->csr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::destroy_session41(const RPCProcedure* proc,
+                                         const struct NFS41::DESTROY_SESSION4args*,
+                                         const struct NFS41::DESTROY_SESSION4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::DESTROY_SESSION);
+    if (res)
+    {
+        row.values[Status] = res->dsr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::free_stateid41(const RPCProcedure* proc,
+                                      const struct NFS41::FREE_STATEID4args*,
+                                      const struct NFS41::FREE_STATEID4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::FREE_STATEID);
+    if (res)
+    {
+        row.values[Status] = res->fsr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::get_dir_delegation41(const RPCProcedure* proc,
+                                            const struct NFS41::GET_DIR_DELEGATION4args*,
+                                            const struct NFS41::GET_DIR_DELEGATION4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::GET_DIR_DELEGATION);
+    if (res)
+    {
+        row.values[Status] = res->gddr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::getdeviceinfo41(const RPCProcedure* proc,
+                                       const struct NFS41::GETDEVICEINFO4args*,
+                                       const struct NFS41::GETDEVICEINFO4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::GETDEVICEINFO);
+    if (res)
+    {
+        row.values[Status] = res->gdir_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::getdevicelist41(const RPCProcedure* proc,
+                                       const struct NFS41::GETDEVICELIST4args*,
+                                       const struct NFS41::GETDEVICELIST4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::GETDEVICELIST);
+    if (res)
+    {
+        row.values[Status] = res->gdlr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::layoutcommit41(const RPCProcedure* proc,
+                                      const struct NFS41::LAYOUTCOMMIT4args*,
+                                      const struct NFS41::LAYOUTCOMMIT4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::LAYOUTCOMMIT);
+    if (res)
+    {
+        row.values[Status] = res->locr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::layoutget41(const RPCProcedure* proc,
+                                   const struct NFS41::LAYOUTGET4args*,
+                                   const struct NFS41::LAYOUTGET4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::LAYOUTGET);
+    if (res)
+    {
+        row.values[Status] = res->logr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::layoutreturn41(const RPCProcedure* proc,
+                                      const struct NFS41::LAYOUTRETURN4args*,
+                                      const struct NFS41::LAYOUTRETURN4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::LAYOUTRETURN);
+    if (res)
+    {
+        row.values[Status] = res->lorr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::sequence41(const RPCProcedure* proc,
+                                  const struct NFS41::SEQUENCE4args*,
+                                  const struct NFS41::SEQUENCE4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::SEQUENCE);
+    if (res)
+    {
+        row.values[Status] = res->sr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::set_ssv41(const RPCProcedure* proc,
+                                 const struct NFS41::SET_SSV4args*,
+                                 const struct NFS41::SET_SSV4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::SET_SSV);
+    if (res)
+    {
+        row.values[Status] = res->ssr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::test_stateid41(const RPCProcedure* proc,
+                                      const struct NFS41::TEST_STATEID4args*,
+                                      const struct NFS41::TEST_STATEID4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::TEST_STATEID);
+    if (res)
+    {
+        row.values[Status] = res->tsr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::want_delegation41(const RPCProcedure* proc,
+                                         const struct NFS41::WANT_DELEGATION4args*,
+                                         const struct NFS41::WANT_DELEGATION4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::WANT_DELEGATION);
+    if (res)
+    {
+        row.values[Status] = res->wdr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::destroy_clientid41(const RPCProcedure* proc,
+                                          const struct NFS41::DESTROY_CLIENTID4args*,
+                                          const struct NFS41::DESTROY_CLIENTID4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::DESTROY_CLIENTID);
+    if (res)
+    {
+        row.values[Status] = res->dcr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::reclaim_complete41(const RPCProcedure* proc,
+                                          const struct NFS41::RECLAIM_COMPLETE4args*,
+                                          const struct NFS41::RECLAIM_COMPLETE4res* res)
+{
+    // Result of NFSv4.1 session operation has own name of status
+    Row row = start(proc, Version::NFSv41, ProcEnumNFS41::RECLAIM_COMPLETE);
+    if (res)
+    {
+        row.values[Status] = res->rcr_status;
+    }
+    commit(row);
+}
+
+void ColumnarAnalyzer::illegal41(const RPCProcedure* proc,
+                                 const struct NFS41::ILLEGAL4res* res)
+{
+    operation(proc, Version::NFSv41, ProcEnumNFS41::ILLEGAL, res);
+}
+
+void ColumnarAnalyzer::flush_statistics()
+{
+    _writer.flush();
+
+    _out << "### Columnar trace statistics ###" << std::endl;
+    _out << "Rows: " << _writer.rowsAmount() << std::endl;
+    _out << "Written bytes: " << _writer.writtenBytes() << std::endl;
+    if (_writer.failed())
+    {
+        _out << "Some data was not written to columnar trace" << std::endl;
+    }
+}
+
+ColumnarAnalyzer::Row ColumnarAnalyzer::start(const RPCProcedure* proc, Version version, uint32_t procedure)
+{
+    const uint64_t call = microseconds(*proc->ctimestamp);
+    const uint64_t reply = microseconds(*proc->rtimestamp);
+
+    // Session objects are reused by the parser, so key is made of addresses
+    const struct Session& session = *proc->session;
+    _sessionKey.assign(reinterpret_cast<const char*>(session.port), sizeof(session.port));
+    _sessionKey.push_back(static_cast<char>(session.type));
+    if (session.ip_type == Session::v4)
+    {
+        _sessionKey.append(reinterpret_cast<const char*>(session.ip.v4.addr), sizeof(session.ip.v4.addr));
+    }
+    else
+    {
+        _sessionKey.append(reinterpret_cast<const char*>(session.ip.v6.addr), sizeof(session.ip.v6.addr));
+    }
+    auto inserted = _sessions.emplace(_sessionKey, 0U);
+    if (inserted.second)
+    {
+        std::ostringstream stream;
+        print_session(stream, session);
+        const std::string str = stream.str();
+        inserted.first->second = _writer.intern(Session, str.data(), str.size());
+    }
+
+    Row row;
+    row.values[Timestamp] = call;
+    row.values[Xid] = proc->call.rm_xid;
+    row.values[Program] = static_cast<uint64_t>(version);
+    row.values[Procedure] = procedure;
+    row.values[Status] = NoStatus;
+    row.values[Latency] = std::min<uint64_t>(reply > call ? reply - call : 0U, UINT32_MAX);
+    row.values[Offset] = 0U;
+    row.values[Size] = 0U;
+    row.values[Session] = inserted.first->second;
+    row.values[Name] = 0U;
+    return row;
+}
+
+template <typename Res>
+void ColumnarAnalyzer::setStatus(Row& row, const Res* res)
+{
+    if (res)
+    {
+        row.values[Status] = static_cast<uint32_t>(res->status);
+    }
+}
+
+void ColumnarAnalyzer::setRange(Row& row, uint64_t offset, uint32_t size)
+{
+    row.values[Offset] = offset;
+    row.values[Size] = size;
+}
+
+void ColumnarAnalyzer::setName(Row& row, const char* name, std::size_t length)
+{
+    row.values[Name] = _writer.intern(Name, name, length);
+}
+
+void ColumnarAnalyzer::commit(const Row& row)
+{
+    _writer.append(row.values);
+}
+
+template <typename Res>
+void ColumnarAnalyzer::operation(const RPCProcedure* proc, Version version, uint32_t procedure, const Res* res)
+{
+    Row row = start(proc, version, procedure);
+    setStatus(row, res);
+    commit(row);
+}
+//------------------------------------------------------------------------------
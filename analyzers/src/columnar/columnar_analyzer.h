@@ -0,0 +1,452 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer writing NFS operations to columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COLUMNAR_ANALYZER_H
+#define COLUMNAR_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <unordered_map>
+
+#include "api/ianalyzer.h"
+#include "columnar_writer.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer writing NFS operations to columnar trace
+/*!
+ * Writes a row for each NFSv3 procedure and each NFSv4.x operation, rows of
+ * operations of one COMPOUND share its XID and timestamps. Columns are
+ * described by schema() and stored as described in columnar_format.h:
+ * numbers in fixed-width types, sessions and entry names in dictionaries.
+ */
+class ColumnarAnalyzer : public IAnalyzer
+{
+public:
+    //! Columns of trace
+    enum Column
+    {
+        Timestamp,  //!< call time, microseconds since Epoch
+        Xid,
+        Program,    //!< 3, 40 or 41
+        Procedure,  //!< NFSv3 procedure or NFSv4.x operation number
+        Status,     //!< NFS status or NoStatus if RPC call failed
+        Latency,    //!< microseconds
+        Offset,     //!< offset or cookie of READ, WRITE, COMMIT and READDIR
+        Size,       //!< bytes requested by READ, WRITE, COMMIT and READDIR
+        Session,    //!< string of client and server addresses
+        Name,       //!< entry name of directory operations, empty for others
+        ColumnsAmount
+    };
+
+    static constexpr uint32_t NoStatus = 0xFFFFFFFFU;
+
+    //! Returns schema of trace
+    static const Columnar::Schema& schema();
+
+    ColumnarAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param path Path of trace file to create
+     * \param blockRows Amount of rows in a block
+     * \param out Stream to report to
+     */
+    ColumnarAnalyzer(const std::string& path, std::size_t blockRows, std::ostream& out = std::cout);
+    ColumnarAnalyzer(const ColumnarAnalyzer&) = delete;
+    ColumnarAnalyzer& operator=(const ColumnarAnalyzer&) = delete;
+
+    // NFSv3 procedures
+
+    void null(const RPCProcedure* proc,
+              const struct NFS3::NULL3args* args,
+              const struct NFS3::NULL3res* res) override final;
+    void getattr3(const RPCProcedure* proc,
+                  const struct NFS3::GETATTR3args* args,
+                  const struct NFS3::GETATTR3res* res) override final;
+    void setattr3(const RPCProcedure* proc,
+                  const struct NFS3::SETATTR3args* args,
+                  const struct NFS3::SETATTR3res* res) override final;
+    void lookup3(const RPCProcedure* proc,
+                 const struct NFS3::LOOKUP3args* args,
+                 const struct NFS3::LOOKUP3res* res) override final;
+    void access3(const RPCProcedure* proc,
+                 const struct NFS3::ACCESS3args* args,
+                 const struct NFS3::ACCESS3res* res) override final;
+    void readlink3(const RPCProcedure* proc,
+                   const struct NFS3::READLINK3args* args,
+                   const struct NFS3::READLINK3res* res) override final;
+    void read3(const RPCProcedure* proc,
+               const struct NFS3::READ3args* args,
+               const struct NFS3::READ3res* res) override final;
+    void write3(const RPCProcedure* proc,
+                const struct NFS3::WRITE3args* args,
+                const struct NFS3::WRITE3res* res) override final;
+    void create3(const RPCProcedure* proc,
+                 const struct NFS3::CREATE3args* args,
+                 const struct NFS3::CREATE3res* res) override final;
+    void mkdir3(const RPCProcedure* proc,
+                const struct NFS3::MKDIR3args* args,
+                const struct NFS3::MKDIR3res* res) override final;
+    void symlink3(const RPCProcedure* proc,
+                  const struct NFS3::SYMLINK3args* args,
+                  const struct NFS3::SYMLINK3res* res) override final;
+    void mknod3(const RPCProcedure* proc,
+                const struct NFS3::MKNOD3args* args,
+                const struct NFS3::MKNOD3res* res) override final;
+    void remove3(const RPCProcedure* proc,
+                 const struct NFS3::REMOVE3args* args,
+                 const struct NFS3::REMOVE3res* res) override final;
+    void rmdir3(const RPCProcedure* proc,
+                const struct NFS3::RMDIR3args* args,
+                const struct NFS3::RMDIR3res* res) override final;
+    void rename3(const RPCProcedure* proc,
+                 const struct NFS3::RENAME3args* args,
+                 const struct NFS3::RENAME3res* res) override final;
+    void link3(const RPCProcedure* proc,
+               const struct NFS3::LINK3args* args,
+               const struct NFS3::LINK3res* res) override final;
+    void readdir3(const RPCProcedure* proc,
+                  const struct NFS3::READDIR3args* args,
+                  const struct NFS3::READDIR3res* res) override final;
+    void readdirplus3(const RPCProcedure* proc,
+                      const struct NFS3::READDIRPLUS3args* args,
+                      const struct NFS3::READDIRPLUS3res* res) override final;
+    void fsstat3(const RPCProcedure* proc,
+                 const struct NFS3::FSSTAT3args* args,
+                 const struct NFS3::FSSTAT3res* res) override final;
+    void fsinfo3(const RPCProcedure* proc,
+                 const struct NFS3::FSINFO3args* args,
+                 const struct NFS3::FSINFO3res* res) override final;
+    void pathconf3(const RPCProcedure* proc,
+                   const struct NFS3::PATHCONF3args* args,
+                   const struct NFS3::PATHCONF3res* res) override final;
+    void commit3(const RPCProcedure* proc,
+                 const struct NFS3::COMMIT3args* args,
+                 const struct NFS3::COMMIT3res* res) override final;
+
+    // NFSv4.0 procedures and operations
+
+    void null4(const RPCProcedure* proc,
+               const struct NFS4::NULL4args* args,
+               const struct NFS4::NULL4res* res) override final;
+    void access40(const RPCProcedure* proc,
+                  const struct NFS4::ACCESS4args* args,
+                  const struct NFS4::ACCESS4res* res) override final;
+    void close40(const RPCProcedure* proc,
+                 const struct NFS4::CLOSE4args* args,
+                 const struct NFS4::CLOSE4res* res) override final;
+    void commit40(const RPCProcedure* proc,
+                  const struct NFS4::COMMIT4args* args,
+                  const struct NFS4::COMMIT4res* res) override final;
+    void create40(const RPCProcedure* proc,
+                  const struct NFS4::CREATE4args* args,
+                  const struct NFS4::CREATE4res* res) override final;
+    void delegpurge40(const RPCProcedure* proc,
+                      const struct NFS4::DELEGPURGE4args* args,
+                      const struct NFS4::DELEGPURGE4res* res) override final;
+    void delegreturn40(const RPCProcedure* proc,
+                       const struct NFS4::DELEGRETURN4args* args,
+                       const struct NFS4::DELEGRETURN4res* res) override final;
+    void getattr40(const RPCProcedure* proc,
+                   const struct NFS4::GETATTR4args* args,
+                   const struct NFS4::GETATTR4res* res) override final;
+    void getfh40(const RPCProcedure* proc,
+                 const struct NFS4::GETFH4res* res) override final;
+    void link40(const RPCProcedure* proc,
+                const struct NFS4::LINK4args* args,
+                const struct NFS4::LINK4res* res) override final;
+    void lock40(const RPCProcedure* proc,
+                const struct NFS4::LOCK4args* args,
+                const struct NFS4::LOCK4res* res) override final;
+    void lockt40(const RPCProcedure* proc,
+                 const struct NFS4::LOCKT4args* args,
+                 const struct NFS4::LOCKT4res* res) override final;
+    void locku40(const RPCProcedure* proc,
+                 const struct NFS4::LOCKU4args* args,
+                 const struct NFS4::LOCKU4res* res) override final;
+    void lookup40(const RPCProcedure* proc,
+                  const struct NFS4::LOOKUP4args* args,
+                  const struct NFS4::LOOKUP4res* res) override final;
+    void lookupp40(const RPCProcedure* proc,
+                   const struct NFS4::LOOKUPP4res* res) override final;
+    void nverify40(const RPCProcedure* proc,
+                   const struct NFS4::NVERIFY4args* args,
+                   const struct NFS4::NVERIFY4res* res) override final;
+    void open40(const RPCProcedure* proc,
+                const struct NFS4::OPEN4args* args,
+                const struct NFS4::OPEN4res* res) override final;
+    void openattr40(const RPCProcedure* proc,
+                    const struct NFS4::OPENATTR4args* args,
+                    const struct NFS4::OPENATTR4res* res) override final;
+    void open_confirm40(const RPCProcedure* proc,
+                        const struct NFS4::OPEN_CONFIRM4args* args,
+                        const struct NFS4::OPEN_CONFIRM4res* res) override final;
+    void open_downgrade40(const RPCProcedure* proc,
+                          const struct NFS4::OPEN_DOWNGRADE4args* args,
+                          const struct NFS4::OPEN_DOWNGRADE4res* res) override final;
+    void putfh40(const RPCProcedure* proc,
+                 const struct NFS4::PUTFH4args* args,
+                 const struct NFS4::PUTFH4res* res) override final;
+    void putpubfh40(const RPCProcedure* proc,
+                    const struct NFS4::PUTPUBFH4res* res) override final;
+    void putrootfh40(const RPCProcedure* proc,
+                     const struct NFS4::PUTROOTFH4res* res) override final;
+    void read40(const RPCProcedure* proc,
+                const struct NFS4::READ4args* args,
+                const struct NFS4::READ4res* res) override final;
+    void readdir40(const RPCProcedure* proc,
+                   const struct NFS4::READDIR4args* args,
+                   const struct NFS4::READDIR4res* res) override final;
+    void readlink40(const RPCProcedure* proc,
+                    const struct NFS4::READLINK4res* res) override final;
+    void remove40(const RPCProcedure* proc,
+                  const struct NFS4::REMOVE4args* args,
+                  const struct NFS4::REMOVE4res* res) override final;
+    void rename40(const RPCProcedure* proc,
+                  const struct NFS4::RENAME4args* args,
+                  const struct NFS4::RENAME4res* res) override final;
+    void renew40(const RPCProcedure* proc,
+                 const struct NFS4::RENEW4args* args,
+                 const struct NFS4::RENEW4res* res) override final;
+    void restorefh40(const RPCProcedure* proc,
+                     const struct NFS4::RESTOREFH4res* res) override final;
+    void savefh40(const RPCProcedure* proc,
+                  const struct NFS4::SAVEFH4res* res) override final;
+    void secinfo40(const RPCProcedure* proc,
+                   const struct NFS4::SECINFO4args* args,
+                   const struct NFS4::SECINFO4res* res) override final;
+    void setattr40(const RPCProcedure* proc,
+                   const struct NFS4::SETATTR4args* args,
+                   const struct NFS4::SETATTR4res* res) override final;
+    void setclientid40(const RPCProcedure* proc,
+                       const struct NFS4::SETCLIENTID4args* args,
+                       const struct NFS4::SETCLIENTID4res* res) override final;
+    void setclientid_confirm40(const RPCProcedure* proc,
+                               const struct NFS4::SETCLIENTID_CONFIRM4args* args,
+                               const struct NFS4::SETCLIENTID_CONFIRM4res* res) override final;
+    void verify40(const RPCProcedure* proc,
+                  const struct NFS4::VERIFY4args* args,
+                  const struct NFS4::VERIFY4res* res) override final;
+    void write40(const RPCProcedure* proc,
+                 const struct NFS4::WRITE4args* args,
+                 const struct NFS4::WRITE4res* res) override final;
+    void release_lockowner40(const RPCProcedure* proc,
+                             const struct NFS4::RELEASE_LOCKOWNER4args* args,
+                             const struct NFS4::RELEASE_LOCKOWNER4res* res) override final;
+    void get_dir_delegation40(const RPCProcedure* proc,
+                              const struct NFS4::GET_DIR_DELEGATION4args* args,
+                              const struct NFS4::GET_DIR_DELEGATION4res* res) override final;
+    void illegal40(const RPCProcedure* proc,
+                   const struct NFS4::ILLEGAL4res* res) override final;
+
+    // NFSv4.1 operations
+
+    void access41(const RPCProcedure* proc,
+                  const struct NFS41::ACCESS4args* args,
+                  const struct NFS41::ACCESS4res* res) override final;
+    void close41(const RPCProcedure* proc,
+                 const struct NFS41::CLOSE4args* args,
+                 const struct NFS41::CLOSE4res* res) override final;
+    void commit41(const RPCProcedure* proc,
+                  const struct NFS41::COMMIT4args* args,
+                  const struct NFS41::COMMIT4res* res) override final;
+    void create41(const RPCProcedure* proc,
+                  const struct NFS41::CREATE4args* args,
+                  const struct NFS41::CREATE4res* res) override final;
+    void delegpurge41(const RPCProcedure* proc,
+                      const struct NFS41::DELEGPURGE4args* args,
+                      const struct NFS41::DELEGPURGE4res* res) override final;
+    void delegreturn41(const RPCProcedure* proc,
+                       const struct NFS41::DELEGRETURN4args* args,
+                       const struct NFS41::DELEGRETURN4res* res) override final;
+    void getattr41(const RPCProcedure* proc,
+                   const struct NFS41::GETATTR4args* args,
+                   const struct NFS41::GETATTR4res* res) override final;
+    void getfh41(const RPCProcedure* proc,
+                 const struct NFS41::GETFH4res* res) override final;
+    void link41(const RPCProcedure* proc,
+                const struct NFS41::LINK4args* args,
+                const struct NFS41::LINK4res* res) override final;
+    void lock41(const RPCProcedure* proc,
+                const struct NFS41::LOCK4args* args,
+                const struct NFS41::LOCK4res* res) override final;
+    void lockt41(const RPCProcedure* proc,
+                 const struct NFS41::LOCKT4args* args,
+                 const struct NFS41::LOCKT4res* res) override final;
+    void locku41(const RPCProcedure* proc,
+                 const struct NFS41::LOCKU4args* args,
+                 const struct NFS41::LOCKU4res* res) override final;
+    void lookup41(const RPCProcedure* proc,
+                  const struct NFS41::LOOKUP4args* args,
+                  const struct NFS41::LOOKUP4res* res) override final;
+    void lookupp41(const RPCProcedure* proc,
+                   const struct NFS41::LOOKUPP4res* res) override final;
+    void nverify41(const RPCProcedure* proc,
+                   const struct NFS41::NVERIFY4args* args,
+                   const struct NFS41::NVERIFY4res* res) override final;
+    void open41(const RPCProcedure* proc,
+                const struct NFS41::OPEN4args* args,
+                const struct NFS41::OPEN4res* res) override final;
+    void openattr41(const RPCProcedure* proc,
+                    const struct NFS41::OPENATTR4args* args,
+                    const struct NFS41::OPENATTR4res* res) override final;
+    void open_confirm41(const RPCProcedure* proc,
+                        const struct NFS41::OPEN_CONFIRM4args* args,
+                        const struct NFS41::OPEN_CONFIRM4res* res) override final;
+    void open_downgrade41(const RPCProcedure* proc,
+                          const struct NFS41::OPEN_DOWNGRADE4args* args,
+                          const struct NFS41::OPEN_DOWNGRADE4res* res) override final;
+    void putfh41(const RPCProcedure* proc,
+                 const struct NFS41::PUTFH4args* args,
+                 const struct NFS41::PUTFH4res* res) override final;
+    void putpubfh41(const RPCProcedure* proc,
+                    const struct NFS41::PUTPUBFH4res* res) override final;
+    void putrootfh41(const RPCProcedure* proc,
+                     const struct NFS41::PUTROOTFH4res* res) override final;
+    void read41(const RPCProcedure* proc,
+                const struct NFS41::READ4args* args,
+                const struct NFS41::READ4res* res) override final;
+    void readdir41(const RPCProcedure* proc,
+                   const struct NFS41::READDIR4args* args,
+                   const struct NFS41::READDIR4res* res) override final;
+    void readlink41(const RPCProcedure* proc,
+                    const struct NFS41::READLINK4res* res) override final;
+    void remove41(const RPCProcedure* proc,
+                  const struct NFS41::REMOVE4args* args,
+                  const struct NFS41::REMOVE4res* res) override final;
+    void rename41(const RPCProcedure* proc,
+                  const struct NFS41::RENAME4args* args,
+                  const struct NFS41::RENAME4res* res) override final;
+    void renew41(const RPCProcedure* proc,
+                 const struct NFS41::RENEW4args* args,
+                 const struct NFS41::RENEW4res* res) override final;
+    void restorefh41(const RPCProcedure* proc,
+                     const struct NFS41::RESTOREFH4res* res) override final;
+    void savefh41(const RPCProcedure* proc,
+                  const struct NFS41::SAVEFH4res* res) override final;
+    void secinfo41(const RPCProcedure* proc,
+                   const struct NFS41::SECINFO4args* args,
+                   const struct NFS41::SECINFO4res* res) override final;
+    void setattr41(const RPCProcedure* proc,
+                   const struct NFS41::SETATTR4args* args,
+                   const struct NFS41::SETATTR4res* res) override final;
+    void setclientid41(const RPCProcedure* proc,
+                       const struct NFS41::SETCLIENTID4args* args,
+                       const struct NFS41::SETCLIENTID4res* res) override final;
+    void setclientid_confirm41(const RPCProcedure* proc,
+                               const struct NFS41::SETCLIENTID_CONFIRM4args* args,
+                               const struct NFS41::SETCLIENTID_CONFIRM4res* res) override final;
+    void verify41(const RPCProcedure* proc,
+                  const struct NFS41::VERIFY4args* args,
+                  const struct NFS41::VERIFY4res* res) override final;
+    void write41(const RPCProcedure* proc,
+                 const struct NFS41::WRITE4args* args,
+                 const struct NFS41::WRITE4res* res) override final;
+    void release_lockowner41(const RPCProcedure* proc,
+                             const struct NFS41::RELEASE_LOCKOWNER4args* args,
+                             const struct NFS41::RELEASE_LOCKOWNER4res* res) override final;
+    void backchannel_ctl41(const RPCProcedure* proc,
+                           const struct NFS41::BACKCHANNEL_CTL4args* args,
+                           const struct NFS41::BACKCHANNEL_CTL4res* res) override final;
+    void bind_conn_to_session41(const RPCProcedure* proc,
+                                const struct NFS41::BIND_CONN_TO_SESSION4args* args,
+                                const struct NFS41::BIND_CONN_TO_SESSION4res* res) override final;
+    void exchange_id41(const RPCProcedure* proc,
+                       const struct NFS41::EXCHANGE_ID4args* args,
+                       const struct NFS41::EXCHANGE_ID4res* res) override final;
+    void create_session41(const RPCProcedure* proc,
+                          const struct NFS41::CREATE_SESSION4args* args,
+                          const struct NFS41::CREATE_SESSION4res* res) override final;
+    void destroy_session41(const RPCProcedure* proc,
+                           const struct NFS41::DESTROY_SESSION4args* args,
+                           const struct NFS41::DESTROY_SESSION4res* res) override final;
+    void free_stateid41(const RPCProcedure* proc,
+                        const struct NFS41::FREE_STATEID4args* args,
+                        const struct NFS41::FREE_STATEID4res* res) override final;
+    void get_dir_delegation41(const RPCProcedure* proc,
+                              const struct NFS41::GET_DIR_DELEGATION4args* args,
+                              const struct NFS41::GET_DIR_DELEGATION4res* res) override final;
+    void getdeviceinfo41(const RPCProcedure* proc,
+                         const struct NFS41::GETDEVICEINFO4args* args,
+                         const struct NFS41::GETDEVICEINFO4res* res) override final;
+    void getdevicelist41(const RPCProcedure* proc,
+                         const struct NFS41::GETDEVICELIST4args* args,
+                         const struct NFS41::GETDEVICELIST4res* res) override final;
+    void layoutcommit41(const RPCProcedure* proc,
+                        const struct NFS41::LAYOUTCOMMIT4args* args,
+                        const struct NFS41::LAYOUTCOMMIT4res* res) override final;
+    void layoutget41(const RPCProcedure* proc,
+                     const struct NFS41::LAYOUTGET4args* args,
+                     const struct NFS41::LAYOUTGET4res* res) override final;
+    void layoutreturn41(const RPCProcedure* proc,
+                        const struct NFS41::LAYOUTRETURN4args* args,
+                        const struct NFS41::LAYOUTRETURN4res* res) override final;
+    void sequence41(const RPCProcedure* proc,
+                    const struct NFS41::SEQUENCE4args* args,
+                    const struct NFS41::SEQUENCE4res* res) override final;
+    void set_ssv41(const RPCProcedure* proc,
+                   const struct NFS41::SET_SSV4args* args,
+                   const struct NFS41::SET_SSV4res* res) override final;
+    void test_stateid41(const RPCProcedure* proc,
+                        const struct NFS41::TEST_STATEID4args* args,
+                        const struct NFS41::TEST_STATEID4res* res) override final;
+    void want_delegation41(const RPCProcedure* proc,
+                           const struct NFS41::WANT_DELEGATION4args* args,
+                           const struct NFS41::WANT_DELEGATION4res* res) override final;
+    void destroy_clientid41(const RPCProcedure* proc,
+                            const struct NFS41::DESTROY_CLIENTID4args* args,
+                            const struct NFS41::DESTROY_CLIENTID4res* res) override final;
+    void reclaim_complete41(const RPCProcedure* proc,
+                            const struct NFS41::RECLAIM_COMPLETE4args* args,
+                            const struct NFS41::RECLAIM_COMPLETE4res* res) override final;
+    void illegal41(const RPCProcedure* proc,
+                   const struct NFS41::ILLEGAL4res* res) override final;
+
+    void flush_statistics() override final;
+private:
+    struct Row
+    {
+        uint64_t values[ColumnsAmount];
+    };
+
+    enum class Version : uint8_t
+    {
+        NFSv3  = 3,
+        NFSv40 = 40,
+        NFSv41 = 41
+    };
+
+    Row start(const RPCProcedure* proc, Version version, uint32_t procedure);
+    template <typename Res>
+    void setStatus(Row& row, const Res* res);
+    void setRange(Row& row, uint64_t offset, uint32_t size);
+    void setName(Row& row, const char* name, std::size_t length);
+    void commit(const Row& row);
+    template <typename Res>
+    void operation(const RPCProcedure* proc, Version version, uint32_t procedure, const Res* res);
+
+    ColumnarWriter _writer;
+    std::ostream& _out;
+    std::unordered_map<std::string, uint64_t> _sessions; // ids of sessions by their addresses
+    std::string _sessionKey;
+};
+//------------------------------------------------------------------------------
+#endif//COLUMNAR_ANALYZER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Format of columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <stdexcept>
+
+#include "columnar_format.h"
+//------------------------------------------------------------------------------
+namespace Columnar
+{
+
+namespace
+{
+
+const uint8_t* next(const uint8_t* in, const uint8_t* end, uint64_t& value)
+{
+    in = getVarint(in, end, value);
+    if (!in)
+    {
+        throw std::runtime_error{"Truncated chunk of columnar trace"};
+    }
+    return in;
+}
+
+} // namespace
+
+std::size_t width(Type type)
+{
+    switch (type)
+    {
+    case Type::U8:
+        return 1U;
+    case Type::U16:
+        return 2U;
+    case Type::U32:
+    case Type::String:
+        return 4U;
+    case Type::U64:
+        return 8U;
+    }
+    return 8U;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80U)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80U));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+const uint8_t* getVarint(const uint8_t* in, const uint8_t* end, uint64_t& value)
+{
+    value = 0U;
+    for (unsigned shift = 0U; in != end && shift < 64U; shift += 7U)
+    {
+        const uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7fU) << shift;
+        if ((byte & 0x80U) == 0U)
+        {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+void encode(Codec codec, Type type, const std::vector<uint64_t>& values, std::vector<uint8_t>& out)
+{
+    switch (codec)
+    {
+    case Codec::Plain:
+    {
+        const std::size_t bytes = width(type);
+        for (uint64_t value : values)
+        {
+            for (std::size_t i = 0; i < bytes; ++i)
+            {
+                out.push_back(static_cast<uint8_t>(value >> (i * 8U)));
+            }
+        }
+        break;
+    }
+    case Codec::Varint:
+        for (uint64_t value : values)
+        {
+            putVarint(out, value);
+        }
+        break;
+    case Codec::Delta:
+    {
+        uint64_t previous = 0U;
+        for (uint64_t value : values)
+        {
+            const int64_t delta = static_cast<int64_t>(value - previous);
+            putVarint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+            previous = value;
+        }
+        break;
+    }
+    }
+}
+
+void decode(Codec codec, Type type, const uint8_t* in, const uint8_t* end, std::size_t amount, std::vector<uint64_t>& values)
+{
+    // Each compressed value takes at least one byte
+    if (codec != Codec::Plain && amount > static_cast<std::size_t>(end - in))
+    {
+        throw std::runtime_error{"Truncated chunk of columnar trace"};
+    }
+    values.resize(amount);
+    switch (codec)
+    {
+    case Codec::Plain:
+    {
+        const std::size_t bytes = width(type);
+        if (static_cast<std::size_t>(end - in) < bytes * amount)
+        {
+            throw std::runtime_error{"Truncated chunk of columnar trace"};
+        }
+        for (uint64_t& value : values)
+        {
+            value = 0U;
+            for (std::size_t i = 0; i < bytes; ++i)
+            {
+                value |= static_cast<uint64_t>(*in++) << (i * 8U);
+            }
+        }
+        break;
+    }
+    case Codec::Varint:
+        for (uint64_t& value : values)
+        {
+            in = next(in, end, value);
+        }
+        break;
+    case Codec::Delta:
+    {
+        uint64_t previous = 0U;
+        for (uint64_t& value : values)
+        {
+            uint64_t zigzag;
+            in = next(in, end, zigzag);
+            previous += static_cast<uint64_t>(static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1U));
+            value = previous;
+        }
+        break;
+    }
+    default:
+        throw std::runtime_error{"Unknown codec of columnar trace"};
+    }
+}
+
+} // namespace Columnar
+//------------------------------------------------------------------------------
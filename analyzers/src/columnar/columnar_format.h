@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Format of columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COLUMNAR_FORMAT_H
+#define COLUMNAR_FORMAT_H
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+//------------------------------------------------------------------------------
+//! Self-describing columnar trace
+/*!
+ * File starts with Magic and schema followed by blocks of rows. A block keeps
+ * each column in a separate chunk prefixed with its length, so a reader can
+ * skip columns it does not need without decoding them:
+ *
+ *   file    := magic:8 columns:varint column* block*
+ *   column  := length:varint name type:u8 codec:u8
+ *   block   := rows:varint chunk*          // one chunk per column
+ *   chunk   := length:varint payload
+ *
+ * Values of a chunk are compressed by the codec of column. Payload of String
+ * column starts with entries added to its dictionary by the block:
+ *
+ *   strings := entries:varint (length:varint bytes)* ids
+ *
+ * and values are ids of strings in the dictionary (order of addition from 0).
+ * All varints are LEB128.
+ */
+namespace Columnar
+{
+
+constexpr std::size_t MagicSize = 8U;
+constexpr uint8_t Magic[MagicSize] = {'N', 'S', 'T', 'C', 'O', 'L', 'S', '1'};
+
+//! Logical type of values of column
+enum class Type : uint8_t
+{
+    U8     = 1,
+    U16    = 2,
+    U32    = 3,
+    U64    = 4,
+    String = 5  // dictionary-encoded string, values are ids
+};
+
+//! Compression of values of a chunk
+enum class Codec : uint8_t
+{
+    Plain  = 1, // fixed width little-endian values
+    Varint = 2, // varints, for small values
+    Delta  = 3  // zigzag varints of differences, for ordered values
+};
+
+struct Column
+{
+    std::string name;
+    Type type;
+    Codec codec;
+};
+
+using Schema = std::vector<Column>;
+
+//! Returns width of fixed-width values of type in bytes
+std::size_t width(Type type);
+
+//! Appends varint to buffer
+void putVarint(std::vector<uint8_t>& out, uint64_t value);
+//! Decodes varint
+/*!
+ * \return Pointer past the last read byte or nullptr if data is truncated
+ */
+const uint8_t* getVarint(const uint8_t* in, const uint8_t* end, uint64_t& value);
+
+//! Appends values compressed by codec to buffer
+void encode(Codec codec, Type type, const std::vector<uint64_t>& values, std::vector<uint8_t>& out);
+//! Decodes amount of values compressed by codec
+/*!
+ * \throw std::runtime_error if data is truncated
+ */
+void decode(Codec codec, Type type, const uint8_t* in, const uint8_t* end, std::size_t amount, std::vector<uint64_t>& values);
+
+} // namespace Columnar
+//------------------------------------------------------------------------------
+#endif//COLUMNAR_FORMAT_H
+//------------------------------------------------------------------------------
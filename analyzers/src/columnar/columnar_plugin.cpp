@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Entry points of columnar trace plugin
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "api/plugin_api.h" // include plugin development definitions
+#include "columnar_analyzer.h"
+//------------------------------------------------------------------------------
+
+static const char* const DefaultPath = "nfstrace.columns";
+static constexpr std::size_t DefaultBlockRows = 65536U;
+
+extern "C"
+{
+
+    const char* usage()
+    {
+        return "file - Path of columnar trace to create (default is nfstrace.columns)\n"
+               "block - Amount of rows in a block of columns (default is 65536)";
+    }
+
+    IAnalyzer* create(const char* opts)
+    {
+        // Initializing plugin options with default values
+        std::string path = DefaultPath;
+        std::size_t blockRows = DefaultBlockRows;
+        // Parising plugin options
+        enum
+        {
+            FILE_SUBOPT_INDEX = 0,
+            BLOCK_SUBOPT_INDEX
+        };
+        char fileSubOptName[] = "file";
+        char blockSubOptName[] = "block";
+        char* const tokens[] =
+        {
+            fileSubOptName,
+            blockSubOptName,
+            NULL
+        };
+        std::size_t optsLen = strlen(opts);
+        std::vector<char> optsBuf{opts, opts + optsLen + 2};
+        char* optionp = &optsBuf[0];
+        char* valuep;
+        int optIndex;
+        while ((optIndex = getsubopt(&optionp, tokens, &valuep)) >= 0)
+        {
+            try
+            {
+                switch (optIndex)
+                {
+                case FILE_SUBOPT_INDEX:
+                    if (!valuep || *valuep == '\0')
+                    {
+                        throw std::invalid_argument{"empty path"};
+                    }
+                    path = valuep;
+                    break;
+                case BLOCK_SUBOPT_INDEX:
+                    blockRows = std::stoul(valuep);
+                    break;
+                default:
+                    throw std::runtime_error{std::string{"Invalid suboption index: "} + std::to_string(optIndex)};
+                }
+            }
+            catch (std::logic_error& e)
+            {
+                throw std::runtime_error{std::string{"Invalid value provided for '"} + tokens[optIndex] + "' suboption"};
+            }
+        }
+        if (blockRows == 0U)
+        {
+            throw std::runtime_error{"Value of 'block' suboption must be positive"};
+        }
+        // Creating and returning plugin
+        return new ColumnarAnalyzer{path, blockRows};
+    }
+
+    void destroy(IAnalyzer* instance)
+    {
+        delete instance;
+    }
+
+    NST_PLUGIN_ENTRY_POINTS (&usage, &create, &destroy, nullptr)
+
+} //extern "C"
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Reader of columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "columnar_reader.h"
+//------------------------------------------------------------------------------
+using namespace Columnar;
+
+namespace
+{
+
+constexpr uint64_t MaxNameLength = 4096U;
+
+} // namespace
+
+ColumnarReader::ColumnarReader(const std::string& path) :
+    _file{fopen(path.c_str(), "rb")},
+    _schema{},
+    _firstBlock{0},
+    _dictionaries{},
+    _chunk{}
+{
+    if (!_file)
+    {
+        throw std::runtime_error{"Can't open columnar trace " + path + ": " + strerror(errno)};
+    }
+    try
+    {
+        uint8_t magic[MagicSize];
+        if (fread(magic, 1, MagicSize, _file) != MagicSize || memcmp(magic, Magic, MagicSize) != 0)
+        {
+            throw std::runtime_error{path + " is not a columnar trace"};
+        }
+        uint64_t columns;
+        if (!readVarint(columns))
+        {
+            throw std::runtime_error{"Truncated schema of columnar trace"};
+        }
+        for (uint64_t i = 0; i < columns; ++i)
+        {
+            uint64_t length;
+            uint8_t typeAndCodec[2];
+            if (!readVarint(length) || length > MaxNameLength)
+            {
+                throw std::runtime_error{"Malformed schema of columnar trace"};
+            }
+            std::string name(length, '\0');
+            if (fread(&name[0], 1, length, _file) != length || fread(typeAndCodec, 1, 2, _file) != 2)
+            {
+                throw std::runtime_error{"Truncated schema of columnar trace"};
+            }
+            _schema.push_back(Column{name, static_cast<Type>(typeAndCodec[0]), static_cast<Codec>(typeAndCodec[1])});
+        }
+    }
+    catch (...)
+    {
+        fclose(_file);
+        throw;
+    }
+    _firstBlock = ftell(_file);
+    _dictionaries.resize(_schema.size());
+}
+
+ColumnarReader::~ColumnarReader()
+{
+    fclose(_file);
+}
+
+std::size_t ColumnarReader::find(const std::string& name) const
+{
+    for (std::size_t i = 0; i < _schema.size(); ++i)
+    {
+        if (_schema[i].name == name)
+        {
+            return i;
+        }
+    }
+    throw std::out_of_range{"No column " + name + " in columnar trace"};
+}
+
+bool ColumnarReader::scan(std::size_t column, std::vector<uint64_t>& values)
+{
+    if (column >= _schema.size())
+    {
+        throw std::out_of_range{"Invalid column index of columnar trace"};
+    }
+    uint64_t rows;
+    if (!readVarint(rows))
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < _schema.size(); ++i)
+    {
+        if (i == column)
+        {
+            readChunk(i, rows, values);
+            continue;
+        }
+        uint64_t length;
+        if (!readVarint(length) || fseek(_file, static_cast<long>(length), SEEK_CUR) != 0)
+        {
+            throw std::runtime_error{"Truncated block of columnar trace"};
+        }
+    }
+    return true;
+}
+
+void ColumnarReader::rewind()
+{
+    if (fseek(_file, _firstBlock, SEEK_SET) != 0)
+    {
+        throw std::runtime_error{"Can't rewind columnar trace"};
+    }
+    for (std::vector<std::string>& dictionary : _dictionaries)
+    {
+        dictionary.clear();
+    }
+}
+
+bool ColumnarReader::readVarint(uint64_t& value)
+{
+    value = 0U;
+    for (unsigned shift = 0U; shift < 64U; shift += 7U)
+    {
+        const int byte = getc(_file);
+        if (byte == EOF)
+        {
+            if (shift != 0U)
+            {
+                throw std::runtime_error{"Truncated varint in columnar trace"};
+            }
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    throw std::runtime_error{"Malformed varint in columnar trace"};
+}
+
+void ColumnarReader::readChunk(std::size_t column, std::size_t rows, std::vector<uint64_t>& values)
+{
+    uint64_t length;
+    if (!readVarint(length))
+    {
+        throw std::runtime_error{"Truncated block of columnar trace"};
+    }
+    _chunk.resize(length);
+    if (fread(_chunk.data(), 1, length, _file) != length)
+    {
+        throw std::runtime_error{"Truncated chunk of columnar trace"};
+    }
+    const uint8_t* in = _chunk.data();
+    const uint8_t* end = in + length;
+    if (_schema[column].type == Type::String)
+    {
+        uint64_t entries;
+        in = getVarint(in, end, entries);
+        for (uint64_t i = 0; in && i < entries; ++i)
+        {
+            uint64_t size;
+            in = getVarint(in, end, size);
+            if (!in || size > static_cast<uint64_t>(end - in))
+            {
+                in = nullptr;
+                break;
+            }
+            _dictionaries[column].emplace_back(reinterpret_cast<const char*>(in), size);
+            in += size;
+        }
+        if (!in)
+        {
+            throw std::runtime_error{"Truncated dictionary of columnar trace"};
+        }
+    }
+    decode(_schema[column].codec, _schema[column].type, in, end, rows, values);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Reader of columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COLUMNAR_READER_H
+#define COLUMNAR_READER_H
+//------------------------------------------------------------------------------
+#include <cstdio>
+
+#include "columnar_format.h"
+//------------------------------------------------------------------------------
+//! Reader of columnar trace which scans one column at a time
+/*!
+ * Each call of scan() reads the next block and decodes the requested column
+ * only, chunks of other columns are skipped by their lengths. Another column
+ * can be scanned after rewind().
+ */
+class ColumnarReader
+{
+public:
+    ColumnarReader() = delete;
+    //! Opens trace and reads its schema
+    /*!
+     * \param path Path of trace file
+     * \throw std::runtime_error if file can not be opened or is not a trace
+     */
+    explicit ColumnarReader(const std::string& path);
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader& operator=(const ColumnarReader&) = delete;
+    ~ColumnarReader();
+
+    inline const Columnar::Schema& schema() const
+    {
+        return _schema;
+    }
+    //! Returns index of column
+    /*!
+     * \throw std::out_of_range if there is no column with the name
+     */
+    std::size_t find(const std::string& name) const;
+
+    //! Decodes column of the next block
+    /*!
+     * \param column Index of column
+     * \param values Values of column in the block (ids for String column)
+     * \return False at the end of trace
+     * \throw std::runtime_error if trace is truncated or malformed
+     */
+    bool scan(std::size_t column, std::vector<uint64_t>& values);
+    //! Returns strings of String column read by scan() so far
+    inline const std::vector<std::string>& dictionary(std::size_t column) const
+    {
+        return _dictionaries.at(column);
+    }
+    //! Moves to the first block and forgets dictionaries
+    void rewind();
+private:
+    bool readVarint(uint64_t& value);
+    void readChunk(std::size_t column, std::size_t rows, std::vector<uint64_t>& values);
+
+    FILE* _file;
+    Columnar::Schema _schema;
+    long _firstBlock; // offset of the first block
+    std::vector<std::vector<std::string>> _dictionaries;
+    std::vector<uint8_t> _chunk;
+};
+//------------------------------------------------------------------------------
+#endif//COLUMNAR_READER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Writer of columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "columnar_writer.h"
+//------------------------------------------------------------------------------
+using namespace Columnar;
+
+ColumnarWriter::ColumnarWriter(const std::string& path, const Schema& schema, std::size_t blockRows) :
+    _file{fopen(path.c_str(), "wb")},
+    _schema(schema),
+    _blockRows{blockRows},
+    _values(schema.size()),
+    _dictionaries(schema.size()),
+    _chunk{},
+    _header{Magic, Magic + MagicSize},
+    _rows{0U},
+    _writtenBytes{0U},
+    _failed{false}
+{
+    if (!_file)
+    {
+        throw std::runtime_error{"Can't create columnar trace " + path + ": " + strerror(errno)};
+    }
+    putVarint(_header, _schema.size());
+    for (const Column& column : _schema)
+    {
+        putVarint(_header, column.name.size());
+        _header.insert(_header.end(), column.name.begin(), column.name.end());
+        _header.push_back(static_cast<uint8_t>(column.type));
+        _header.push_back(static_cast<uint8_t>(column.codec));
+    }
+    write(_header);
+    for (std::vector<uint64_t>& values : _values)
+    {
+        values.reserve(_blockRows);
+    }
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+    writeBlock();
+    fclose(_file);
+}
+
+uint64_t ColumnarWriter::intern(std::size_t column, const char* data, std::size_t length)
+{
+    Dictionary& dictionary = _dictionaries[column];
+    auto inserted = dictionary.ids.emplace(std::string{data, length}, dictionary.ids.size());
+    if (inserted.second)
+    {
+        // Keys of unordered_map are not moved on rehash
+        dictionary.added.push_back(&inserted.first->first);
+    }
+    return inserted.first->second;
+}
+
+void ColumnarWriter::append(const uint64_t* values)
+{
+    for (std::size_t i = 0; i < _values.size(); ++i)
+    {
+        _values[i].push_back(values[i]);
+    }
+    ++_rows;
+    if (_values.front().size() >= _blockRows)
+    {
+        writeBlock();
+    }
+}
+
+void ColumnarWriter::flush()
+{
+    writeBlock();
+    if (fflush(_file) != 0)
+    {
+        _failed = true;
+    }
+}
+
+void ColumnarWriter::writeBlock()
+{
+    if (_values.empty() || _values.front().empty())
+    {
+        return;
+    }
+    _header.clear();
+    putVarint(_header, _values.front().size());
+    write(_header);
+
+    for (std::size_t i = 0; i < _schema.size(); ++i)
+    {
+        _chunk.clear();
+        if (_schema[i].type == Type::String)
+        {
+            Dictionary& dictionary = _dictionaries[i];
+            putVarint(_chunk, dictionary.added.size());
+            for (const std::string* entry : dictionary.added)
+            {
+                putVarint(_chunk, entry->size());
+                _chunk.insert(_chunk.end(), entry->begin(), entry->end());
+            }
+            dictionary.added.clear();
+        }
+        encode(_schema[i].codec, _schema[i].type, _values[i], _chunk);
+        _values[i].clear();
+
+        _header.clear();
+        putVarint(_header, _chunk.size());
+        write(_header);
+        write(_chunk);
+    }
+}
+
+void ColumnarWriter::write(const std::vector<uint8_t>& data)
+{
+    if (fwrite(data.data(), 1, data.size(), _file) == data.size())
+    {
+        _writtenBytes += data.size();
+    }
+    else
+    {
+        _failed = true;
+    }
+}
+//------------------------------------------------------------------------------
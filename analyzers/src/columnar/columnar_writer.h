@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Writer of columnar trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COLUMNAR_WRITER_H
+#define COLUMNAR_WRITER_H
+//------------------------------------------------------------------------------
+#include <cstdio>
+#include <unordered_map>
+
+#include "columnar_format.h"
+//------------------------------------------------------------------------------
+//! Writer of rows to columnar trace
+/*!
+ * Rows are accumulated column by column and written as a block when amount
+ * of rows reaches block size, so each column of a block is compressed alone.
+ */
+class ColumnarWriter
+{
+public:
+    ColumnarWriter() = delete;
+    //! Creates file and writes schema
+    /*!
+     * \param path Path of file to create
+     * \param schema Columns of rows
+     * \param blockRows Amount of rows in a block
+     * \throw std::runtime_error if file can not be created
+     */
+    ColumnarWriter(const std::string& path, const Columnar::Schema& schema, std::size_t blockRows);
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+    //! Writes pending rows and closes file
+    ~ColumnarWriter();
+
+    //! Returns id of string in dictionary of String column
+    uint64_t intern(std::size_t column, const char* data, std::size_t length);
+    //! Appends row
+    /*!
+     * \param values Values of all columns in order of schema
+     */
+    void append(const uint64_t* values);
+    //! Writes pending rows as a block and flushes file
+    void flush();
+
+    inline uint64_t rowsAmount() const
+    {
+        return _rows;
+    }
+    inline uint64_t writtenBytes() const
+    {
+        return _writtenBytes;
+    }
+    inline bool failed() const
+    {
+        return _failed;
+    }
+private:
+    //! Dictionary of String column
+    struct Dictionary
+    {
+        std::unordered_map<std::string, uint64_t> ids;
+        std::vector<const std::string*> added; // entries added since the last block
+    };
+
+    void writeBlock();
+    void write(const std::vector<uint8_t>& data);
+
+    FILE* _file;
+    Columnar::Schema _schema;
+    std::size_t _blockRows;
+    std::vector<std::vector<uint64_t>> _values; // pending values of each column
+    std::vector<Dictionary> _dictionaries;      // per column, used by String ones
+    std::vector<uint8_t> _chunk;
+    std::vector<uint8_t> _header;
+    uint64_t _rows;
+    uint64_t _writtenBytes;
+    bool _failed; // some data was not written
+};
+//------------------------------------------------------------------------------
+#endif//COLUMNAR_WRITER_H
+//------------------------------------------------------------------------------
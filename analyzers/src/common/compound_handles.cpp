@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Current and saved file handles of NFSv4.x COMPOUND
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include "compound_handles.h"
+//------------------------------------------------------------------------------
+CompoundHandles::CompoundHandles() :
+    _current{},
+    _saved{},
+    _hasCurrent{false},
+    _hasSaved{false}
+{
+}
+
+void CompoundHandles::start()
+{
+    _hasCurrent = false;
+    _hasSaved = false;
+}
+
+void CompoundHandles::forget()
+{
+    _hasCurrent = false;
+}
+
+void CompoundHandles::save()
+{
+    _saved = _current;
+    _hasSaved = _hasCurrent;
+}
+
+void CompoundHandles::restore()
+{
+    _current = _saved;
+    _hasCurrent = _hasSaved;
+}
+
+void CompoundHandles::set(const char* data, std::size_t length)
+{
+    _current = FileHandle{data, length};
+    _hasCurrent = true;
+}
+//------------------------------------------------------------------------------
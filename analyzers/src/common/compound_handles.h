@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Current and saved file handles of NFSv4.x COMPOUND
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COMMON_COMPOUND_HANDLES_H
+#define COMMON_COMPOUND_HANDLES_H
+//------------------------------------------------------------------------------
+#include "file_handle.h"
+//------------------------------------------------------------------------------
+//! Current and saved file handles of NFSv4.x COMPOUND
+/*!
+ * NFSv4.x operations refer to the current file handle set by preceding
+ * operations of the same COMPOUND. Operations are passed to analyzers in
+ * order, so handles are tracked by calls from hooks of these operations.
+ * Arguments and results of NFSv4.0 and NFSv4.1 have the same layout, so
+ * hooks of both versions call the same templates.
+ */
+class CompoundHandles
+{
+public:
+    CompoundHandles();
+
+    //! Forgets both handles, called by COMPOUND
+    void start();
+    //! Sets current handle passed by PUTFH
+    template <typename Args>
+    void putfh(const Args* args)
+    {
+        if (args)
+        {
+            set(args->object.nfs_fh4_val, args->object.nfs_fh4_len);
+        }
+    }
+    //! Sets current handle returned by GETFH
+    template <typename Res>
+    void getfh(const Res* res)
+    {
+        if (res && res->status == 0) // NFS4_OK
+        {
+            set(res->GETFH4res_u.resok4.object.nfs_fh4_val, res->GETFH4res_u.resok4.object.nfs_fh4_len);
+        }
+    }
+    //! Forgets current handle changed to unknown one by PUTROOTFH, PUTPUBFH, LOOKUP, LOOKUPP, OPEN or CREATE
+    void forget();
+    //! Saves current handle, called by SAVEFH
+    void save();
+    //! Restores saved handle, called by RESTOREFH
+    void restore();
+
+    inline bool known() const
+    {
+        return _hasCurrent;
+    }
+    //! Returns current handle, valid if it is known
+    inline const FileHandle& current() const
+    {
+        return _current;
+    }
+    inline bool saved_known() const
+    {
+        return _hasSaved;
+    }
+    //! Returns saved handle, valid if it is known
+    inline const FileHandle& saved() const
+    {
+        return _saved;
+    }
+private:
+    void set(const char* data, std::size_t length);
+
+    FileHandle _current;
+    FileHandle _saved;
+    bool _hasCurrent;
+    bool _hasSaved;
+};
+//------------------------------------------------------------------------------
+#endif//COMMON_COMPOUND_HANDLES_H
+//------------------------------------------------------------------------------
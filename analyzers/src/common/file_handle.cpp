@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: NFS file handle stored in place
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+
+#include "file_handle.h"
+//------------------------------------------------------------------------------
+constexpr std::size_t FileHandle::MaxSize;
+
+FileHandle::FileHandle() :
+    length{0U},
+    data{}
+{
+}
+
+FileHandle::FileHandle(const char* handle, std::size_t handleLength) :
+    length{static_cast<uint8_t>(std::min(handleLength, MaxSize))},
+    data{}
+{
+    memcpy(data, handle, length);
+}
+
+bool FileHandle::operator==(const FileHandle& other) const
+{
+    return length == other.length && memcmp(data, other.data, length) == 0;
+}
+
+uint64_t FileHandle::hash() const
+{
+    // FNV-1a over bytes of handle
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string FileHandle::str() const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(length * 2U);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        result += digits[data[i] >> 4];
+        result += digits[data[i] & 0x0f];
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
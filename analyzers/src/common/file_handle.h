@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: NFS file handle stored in place
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COMMON_FILE_HANDLE_H
+#define COMMON_FILE_HANDLE_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+//------------------------------------------------------------------------------
+//! NFS file handle stored in place
+/*!
+ * Both NFSv3 and NFSv4.x handles are at most 128 bytes long, so the key has a
+ * fixed size and tables of handles do not allocate memory per handle.
+ */
+struct FileHandle
+{
+    static constexpr std::size_t MaxSize = 128U;
+
+    FileHandle();
+    //! Copies handle, longer handles are truncated to MaxSize
+    FileHandle(const char* data, std::size_t length);
+
+    bool operator==(const FileHandle& other) const;
+    //! Returns 64-bit hash of handle
+    uint64_t hash() const;
+    //! Returns hexadecimal representation of handle
+    std::string str() const;
+
+    uint8_t length;
+    uint8_t data[MaxSize];
+};
+
+struct FileHandleHash
+{
+    inline std::size_t operator()(const FileHandle& handle) const
+    {
+        return static_cast<std::size_t>(handle.hash());
+    }
+};
+//------------------------------------------------------------------------------
+#endif//COMMON_FILE_HANDLE_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Count-Min sketch of weights of objects
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <limits>
+
+#include "count_min_sketch.h"
+//------------------------------------------------------------------------------
+CountMinSketch::CountMinSketch(std::size_t width, std::size_t depth) :
+    _width{std::max<std::size_t>(width, 1U)},
+    _depth{std::max<std::size_t>(depth, 1U)},
+    _counters(_width * _depth, 0U),
+    _total{0U}
+{
+}
+
+uint64_t CountMinSketch::add(uint64_t hash, uint64_t weight)
+{
+    // Conservative update: raise only counters below the new estimate
+    const uint64_t value = estimate(hash) + weight;
+    for (std::size_t row = 0; row < _depth; ++row)
+    {
+        uint64_t& counter = _counters[index(row, hash)];
+        counter = std::max(counter, value);
+    }
+    _total += weight;
+    return value;
+}
+
+uint64_t CountMinSketch::estimate(uint64_t hash) const
+{
+    uint64_t result = std::numeric_limits<uint64_t>::max();
+    for (std::size_t row = 0; row < _depth; ++row)
+    {
+        result = std::min(result, _counters[index(row, hash)]);
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Count-Min sketch of weights of objects
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COUNT_MIN_SKETCH_H
+#define COUNT_MIN_SKETCH_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+//------------------------------------------------------------------------------
+//! Count-Min sketch with conservative update
+/*!
+ * Estimates total weight of any object in fixed memory: depth rows of width
+ * counters. An estimate never underestimates the true weight and exceeds it
+ * by at most e/width of the total weight with probability 1 - exp(-depth).
+ * Objects are given by their 64-bit hash, row indexes are derived from it by
+ * double hashing.
+ */
+class CountMinSketch
+{
+public:
+    CountMinSketch() = delete;
+    //! Constructs sketch
+    /*!
+     * \param width Amount of counters in a row
+     * \param depth Amount of rows
+     */
+    CountMinSketch(std::size_t width, std::size_t depth);
+
+    //! Adds weight of object and returns its new estimate
+    uint64_t add(uint64_t hash, uint64_t weight);
+    //! Returns estimate of weight of object
+    uint64_t estimate(uint64_t hash) const;
+
+    inline uint64_t total() const
+    {
+        return _total;
+    }
+    inline std::size_t width() const
+    {
+        return _width;
+    }
+    inline std::size_t depth() const
+    {
+        return _depth;
+    }
+private:
+    inline std::size_t index(std::size_t row, uint64_t hash) const
+    {
+        const uint64_t h1 = hash & 0xffffffffU;
+        const uint64_t h2 = (hash >> 32) | 1U;
+        return row * _width + static_cast<std::size_t>((h1 + row * h2) % _width);
+    }
+
+    std::size_t _width;
+    std::size_t _depth;
+    std::vector<uint64_t> _counters;
+    uint64_t _total;
+};
+//------------------------------------------------------------------------------
+#endif//COUNT_MIN_SKETCH_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,384 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of the most accessed file handles
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <iomanip>
+
+#include "hot_files_analyzer.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+const char* const OperationNames[OperationsAmount] =
+{
+    "getattr", "lookup", "access", "read", "write"
+};
+
+} // namespace
+
+HotFilesAnalyzer::HotFilesAnalyzer(const Options& options, std::ostream& out) :
+    _options(options),
+    _out(out),
+    _opsSketch{options.width, options.depth},
+    _bytesSketch{options.width, options.depth},
+    _byOps{options.capacity},
+    _byBytes{options.capacity},
+    _handles{}
+{
+}
+
+void HotFilesAnalyzer::getattr3(const RPCProcedure* proc,
+                                const struct NFS3::GETATTR3args* args,
+                                const struct NFS3::GETATTR3res*)
+{
+    if (args)
+    {
+        account(proc, FileHandle{args->object.data.data_val, args->object.data.data_len}, Operation::Getattr, 0U);
+    }
+}
+
+void HotFilesAnalyzer::lookup3(const RPCProcedure* proc,
+                               const struct NFS3::LOOKUP3args* args,
+                               const struct NFS3::LOOKUP3res*)
+{
+    if (args)
+    {
+        account(proc, FileHandle{args->what.dir.data.data_val, args->what.dir.data.data_len}, Operation::Lookup, 0U);
+    }
+}
+
+void HotFilesAnalyzer::access3(const RPCProcedure* proc,
+                               const struct NFS3::ACCESS3args* args,
+                               const struct NFS3::ACCESS3res*)
+{
+    if (args)
+    {
+        account(proc, FileHandle{args->object.data.data_val, args->object.data.data_len}, Operation::Access, 0U);
+    }
+}
+
+void HotFilesAnalyzer::read3(const RPCProcedure* proc,
+                             const struct NFS3::READ3args* args,
+                             const struct NFS3::READ3res* res)
+{
+    if (args)
+    {
+        account(proc, FileHandle{args->file.data.data_val, args->file.data.data_len}, Operation::Read,
+                res && res->status == NFS3::NFS3_OK ? res->READ3res_u.resok.count : 0U);
+    }
+}
+
+void HotFilesAnalyzer::write3(const RPCProcedure* proc,
+                              const struct NFS3::WRITE3args* args,
+                              const struct NFS3::WRITE3res*)
+{
+    if (args)
+    {
+        account(proc, FileHandle{args->file.data.data_val, args->file.data.data_len}, Operation::Write, args->count);
+    }
+}
+
+void HotFilesAnalyzer::compound4(const RPCProcedure*,
+                                 const struct NFS4::COMPOUND4args*,
+                                 const struct NFS4::COMPOUND4res*)
+{
+    _handles.start();
+}
+
+void HotFilesAnalyzer::putfh40(const RPCProcedure*,
+                               const struct NFS4::PUTFH4args* args,
+                               const struct NFS4::PUTFH4res*)
+{
+    _handles.putfh(args);
+}
+
+void HotFilesAnalyzer::getfh40(const RPCProcedure*,
+                               const struct NFS4::GETFH4res* res)
+{
+    _handles.getfh(res);
+}
+
+void HotFilesAnalyzer::putrootfh40(const RPCProcedure*,
+                                   const struct NFS4::PUTROOTFH4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::putpubfh40(const RPCProcedure*,
+                                  const struct NFS4::PUTPUBFH4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::restorefh40(const RPCProcedure*,
+                                   const struct NFS4::RESTOREFH4res*)
+{
+    _handles.restore();
+}
+
+void HotFilesAnalyzer::savefh40(const RPCProcedure*,
+                                const struct NFS4::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void HotFilesAnalyzer::lookup40(const RPCProcedure* proc,
+                                const struct NFS4::LOOKUP4args* args,
+                                const struct NFS4::LOOKUP4res*)
+{
+    // LOOKUP is done in the current directory and replaces the current file handle
+    if (args)
+    {
+        accountCurrent(proc, Operation::Lookup, 0U);
+    }
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::lookupp40(const RPCProcedure*,
+                                 const struct NFS4::LOOKUPP4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::open40(const RPCProcedure*,
+                              const struct NFS4::OPEN4args*,
+                              const struct NFS4::OPEN4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::getattr40(const RPCProcedure* proc,
+                                 const struct NFS4::GETATTR4args* args,
+                                 const struct NFS4::GETATTR4res*)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Getattr, 0U);
+    }
+}
+
+void HotFilesAnalyzer::access40(const RPCProcedure* proc,
+                                const struct NFS4::ACCESS4args* args,
+                                const struct NFS4::ACCESS4res*)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Access, 0U);
+    }
+}
+
+void HotFilesAnalyzer::read40(const RPCProcedure* proc,
+                              const struct NFS4::READ4args* args,
+                              const struct NFS4::READ4res* res)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Read,
+                       res && res->status == NFS4::NFS4_OK ? res->READ4res_u.resok4.data.data_len : 0U);
+    }
+}
+
+void HotFilesAnalyzer::write40(const RPCProcedure* proc,
+                               const struct NFS4::WRITE4args* args,
+                               const struct NFS4::WRITE4res*)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Write, args->data.data_len);
+    }
+}
+
+void HotFilesAnalyzer::compound41(const RPCProcedure*,
+                                  const struct NFS41::COMPOUND4args*,
+                                  const struct NFS41::COMPOUND4res*)
+{
+    _handles.start();
+}
+
+void HotFilesAnalyzer::putfh41(const RPCProcedure*,
+                               const struct NFS41::PUTFH4args* args,
+                               const struct NFS41::PUTFH4res*)
+{
+    _handles.putfh(args);
+}
+
+void HotFilesAnalyzer::getfh41(const RPCProcedure*,
+                               const struct NFS41::GETFH4res* res)
+{
+    _handles.getfh(res);
+}
+
+void HotFilesAnalyzer::putrootfh41(const RPCProcedure*,
+                                   const struct NFS41::PUTROOTFH4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::putpubfh41(const RPCProcedure*,
+                                  const struct NFS41::PUTPUBFH4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::restorefh41(const RPCProcedure*,
+                                   const struct NFS41::RESTOREFH4res*)
+{
+    _handles.restore();
+}
+
+void HotFilesAnalyzer::savefh41(const RPCProcedure*,
+                                const struct NFS41::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void HotFilesAnalyzer::lookup41(const RPCProcedure* proc,
+                                const struct NFS41::LOOKUP4args* args,
+                                const struct NFS41::LOOKUP4res*)
+{
+    // LOOKUP is done in the current directory and replaces the current file handle
+    if (args)
+    {
+        accountCurrent(proc, Operation::Lookup, 0U);
+    }
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::lookupp41(const RPCProcedure*,
+                                 const struct NFS41::LOOKUPP4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::open41(const RPCProcedure*,
+                              const struct NFS41::OPEN4args*,
+                              const struct NFS41::OPEN4res*)
+{
+    _handles.forget();
+}
+
+void HotFilesAnalyzer::getattr41(const RPCProcedure* proc,
+                                 const struct NFS41::GETATTR4args* args,
+                                 const struct NFS41::GETATTR4res*)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Getattr, 0U);
+    }
+}
+
+void HotFilesAnalyzer::access41(const RPCProcedure* proc,
+                                const struct NFS41::ACCESS4args* args,
+                                const struct NFS41::ACCESS4res*)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Access, 0U);
+    }
+}
+
+void HotFilesAnalyzer::read41(const RPCProcedure* proc,
+                              const struct NFS41::READ4args* args,
+                              const struct NFS41::READ4res* res)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Read,
+                       res && res->status == NFS41::NFS4_OK ? res->READ4res_u.resok4.data.data_len : 0U);
+    }
+}
+
+void HotFilesAnalyzer::write41(const RPCProcedure* proc,
+                               const struct NFS41::WRITE4args* args,
+                               const struct NFS41::WRITE4res*)
+{
+    if (args)
+    {
+        accountCurrent(proc, Operation::Write, args->data.data_len);
+    }
+}
+
+void HotFilesAnalyzer::flush_statistics()
+{
+    _out << "### Hot file handles ###" << std::endl;
+    _out << "Operations " << _opsSketch.total() << ", bytes " << _bytesSketch.total()
+         << " (sketch " << _opsSketch.depth() << "x" << _opsSketch.width()
+         << ", monitored " << _byOps.size() << " of " << _byOps.capacity()
+         << ", replaced " << _byOps.replacedAmount() << ")" << std::endl;
+
+    const std::vector<const HotObject*> byOps = _byOps.top(_options.top);
+    _out << "Top by operations:" << std::endl;
+    for (const HotObject* object : byOps)
+    {
+        printObject(*object);
+    }
+    _out << "Top by bytes:" << std::endl;
+    for (const HotObject* object : _byBytes.top(_options.top))
+    {
+        printObject(*object);
+    }
+    _out << "Metadata storms (>= " << _options.stormOps << " ops/s):" << std::endl;
+    for (const HotObject* object : _byOps.top(_byOps.size()))
+    {
+        if (object->peakMetadataOps >= _options.stormOps)
+        {
+            printObject(*object);
+        }
+    }
+}
+
+void HotFilesAnalyzer::account(const RPCProcedure* proc, const FileHandle& handle, Operation operation, uint64_t bytes)
+{
+    const uint64_t hash = handle.hash();
+    const uint64_t second = static_cast<uint64_t>(proc->rtimestamp->tv_sec);
+    _byOps.add(handle, 1U, _opsSketch.add(hash, 1U)).account(operation, bytes, second);
+    if (bytes != 0U)
+    {
+        _byBytes.add(handle, bytes, _bytesSketch.add(hash, bytes)).account(operation, bytes, second);
+    }
+}
+
+void HotFilesAnalyzer::accountCurrent(const RPCProcedure* proc, Operation operation, uint64_t bytes)
+{
+    if (_handles.known())
+    {
+        account(proc, _handles.current(), operation, bytes);
+    }
+}
+
+void HotFilesAnalyzer::printObject(const HotObject& object)
+{
+    _out << "  FH " << object.handle.str() << " weight " << object.count;
+    if (object.error != 0U)
+    {
+        _out << " (+-" << object.error << ")";
+    }
+    for (std::size_t i = 0; i < OperationsAmount; ++i)
+    {
+        if (object.ops[i] != 0U)
+        {
+            _out << " " << OperationNames[i] << " " << object.ops[i];
+        }
+    }
+    _out << " bytes " << object.bytes
+         << " peak " << object.peakOps << " ops/s"
+         << " metadata peak " << object.peakMetadataOps << " ops/s" << std::endl;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,182 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of the most accessed file handles
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef HOT_FILES_ANALYZER_H
+#define HOT_FILES_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <iostream>
+
+#include "api/ianalyzer.h"
+#include "common/compound_handles.h"
+#include "count_min_sketch.h"
+#include "space_saving.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer of hot file handles and directories
+/*!
+ * Accounts GETATTR, LOOKUP, ACCESS, READ and WRITE of each file handle in
+ * Count-Min sketches of operations and bytes and keeps Space-Saving summaries
+ * of the heaviest handles, so memory is fixed by options and does not grow
+ * with amount of handles. LOOKUP is accounted to the directory. NFSv4.x
+ * operations are accounted to the current file handle of COMPOUND which is
+ * tracked from PUTFH and GETFH operations.
+ *
+ * Besides totals each monitored handle has peak amount of operations and of
+ * metadata operations (GETATTR, LOOKUP, ACCESS) per second, handles with
+ * metadata peak above a threshold are reported as metadata storms.
+ */
+class HotFilesAnalyzer : public IAnalyzer
+{
+public:
+    //! Options of analyzer
+    struct Options
+    {
+        std::size_t width;     //!< Width of sketches
+        std::size_t depth;     //!< Depth of sketches
+        std::size_t capacity;  //!< Amount of monitored handles in each summary
+        std::size_t top;       //!< Amount of reported handles
+        uint64_t stormOps;     //!< Metadata operations per second considered as storm
+    };
+
+    HotFilesAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param options Options
+     * \param out Stream to report to
+     */
+    explicit HotFilesAnalyzer(const Options& options, std::ostream& out = std::cout);
+    HotFilesAnalyzer(const HotFilesAnalyzer&) = delete;
+    HotFilesAnalyzer& operator=(const HotFilesAnalyzer&) = delete;
+
+    // NFSv3 procedures
+
+    void getattr3(const RPCProcedure* proc,
+                  const struct NFS3::GETATTR3args* args,
+                  const struct NFS3::GETATTR3res* res) override final;
+    void lookup3(const RPCProcedure* proc,
+                 const struct NFS3::LOOKUP3args* args,
+                 const struct NFS3::LOOKUP3res* res) override final;
+    void access3(const RPCProcedure* proc,
+                 const struct NFS3::ACCESS3args* args,
+                 const struct NFS3::ACCESS3res* res) override final;
+    void read3(const RPCProcedure* proc,
+               const struct NFS3::READ3args* args,
+               const struct NFS3::READ3res* res) override final;
+    void write3(const RPCProcedure* proc,
+                const struct NFS3::WRITE3args* args,
+                const struct NFS3::WRITE3res* res) override final;
+
+    // NFSv4.0 procedures and operations
+
+    void compound4(const RPCProcedure* proc,
+                   const struct NFS4::COMPOUND4args* args,
+                   const struct NFS4::COMPOUND4res* res) override final;
+    void putfh40(const RPCProcedure* proc,
+                 const struct NFS4::PUTFH4args* args,
+                 const struct NFS4::PUTFH4res* res) override final;
+    void getfh40(const RPCProcedure* proc,
+                 const struct NFS4::GETFH4res* res) override final;
+    void putrootfh40(const RPCProcedure* proc,
+                     const struct NFS4::PUTROOTFH4res* res) override final;
+    void putpubfh40(const RPCProcedure* proc,
+                    const struct NFS4::PUTPUBFH4res* res) override final;
+    void restorefh40(const RPCProcedure* proc,
+                     const struct NFS4::RESTOREFH4res* res) override final;
+    void savefh40(const RPCProcedure* proc,
+                  const struct NFS4::SAVEFH4res* res) override final;
+    void lookup40(const RPCProcedure* proc,
+                  const struct NFS4::LOOKUP4args* args,
+                  const struct NFS4::LOOKUP4res* res) override final;
+    void lookupp40(const RPCProcedure* proc,
+                   const struct NFS4::LOOKUPP4res* res) override final;
+    void open40(const RPCProcedure* proc,
+                const struct NFS4::OPEN4args* args,
+                const struct NFS4::OPEN4res* res) override final;
+    void getattr40(const RPCProcedure* proc,
+                   const struct NFS4::GETATTR4args* args,
+                   const struct NFS4::GETATTR4res* res) override final;
+    void access40(const RPCProcedure* proc,
+                  const struct NFS4::ACCESS4args* args,
+                  const struct NFS4::ACCESS4res* res) override final;
+    void read40(const RPCProcedure* proc,
+                const struct NFS4::READ4args* args,
+                const struct NFS4::READ4res* res) override final;
+    void write40(const RPCProcedure* proc,
+                 const struct NFS4::WRITE4args* args,
+                 const struct NFS4::WRITE4res* res) override final;
+
+    // NFSv4.1 procedures and operations
+
+    void compound41(const RPCProcedure* proc,
+                    const struct NFS41::COMPOUND4args* args,
+                    const struct NFS41::COMPOUND4res* res) override final;
+    void putfh41(const RPCProcedure* proc,
+                 const struct NFS41::PUTFH4args* args,
+                 const struct NFS41::PUTFH4res* res) override final;
+    void getfh41(const RPCProcedure* proc,
+                 const struct NFS41::GETFH4res* res) override final;
+    void putrootfh41(const RPCProcedure* proc,
+                     const struct NFS41::PUTROOTFH4res* res) override final;
+    void putpubfh41(const RPCProcedure* proc,
+                    const struct NFS41::PUTPUBFH4res* res) override final;
+    void restorefh41(const RPCProcedure* proc,
+                     const struct NFS41::RESTOREFH4res* res) override final;
+    void savefh41(const RPCProcedure* proc,
+                  const struct NFS41::SAVEFH4res* res) override final;
+    void lookup41(const RPCProcedure* proc,
+                  const struct NFS41::LOOKUP4args* args,
+                  const struct NFS41::LOOKUP4res* res) override final;
+    void lookupp41(const RPCProcedure* proc,
+                   const struct NFS41::LOOKUPP4res* res) override final;
+    void open41(const RPCProcedure* proc,
+                const struct NFS41::OPEN4args* args,
+                const struct NFS41::OPEN4res* res) override final;
+    void getattr41(const RPCProcedure* proc,
+                   const struct NFS41::GETATTR4args* args,
+                   const struct NFS41::GETATTR4res* res) override final;
+    void access41(const RPCProcedure* proc,
+                  const struct NFS41::ACCESS4args* args,
+                  const struct NFS41::ACCESS4res* res) override final;
+    void read41(const RPCProcedure* proc,
+                const struct NFS41::READ4args* args,
+                const struct NFS41::READ4res* res) override final;
+    void write41(const RPCProcedure* proc,
+                 const struct NFS41::WRITE4args* args,
+                 const struct NFS41::WRITE4res* res) override final;
+
+    void flush_statistics() override final;
+private:
+    void account(const RPCProcedure* proc, const FileHandle& handle, Operation operation, uint64_t bytes);
+    void accountCurrent(const RPCProcedure* proc, Operation operation, uint64_t bytes);
+    void printObject(const HotObject& object);
+
+    Options _options;
+    std::ostream& _out;
+    CountMinSketch _opsSketch;
+    CountMinSketch _bytesSketch;
+    SpaceSaving _byOps;
+    SpaceSaving _byBytes;
+    CompoundHandles _handles; // current and saved file handles of NFSv4.x COMPOUND
+};
+//------------------------------------------------------------------------------
+#endif//HOT_FILES_ANALYZER_H
+//------------------------------------------------------------------------------
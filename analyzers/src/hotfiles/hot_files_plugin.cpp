@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Entry points of hot file handles analyzer plugin
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "api/plugin_api.h" // include plugin development definitions
+#include "hot_files_analyzer.h"
+//------------------------------------------------------------------------------
+
+static constexpr std::size_t DefaultWidth = 8192U;
+static constexpr std::size_t DefaultDepth = 4U;
+static constexpr std::size_t DefaultCapacity = 256U;
+static constexpr std::size_t DefaultTop = 10U;
+static constexpr uint64_t DefaultStormOps = 1000U;
+
+extern "C"
+{
+
+    const char* usage()
+    {
+        return "width - Width of Count-Min sketches (default is 8192)\n"
+               "depth - Depth of Count-Min sketches (default is 4)\n"
+               "capacity - Amount of monitored file handles (default is 256)\n"
+               "top - Amount of reported file handles (default is 10)\n"
+               "storm - Metadata operations per second of one handle reported as storm (default is 1000)";
+    }
+
+    IAnalyzer* create(const char* opts)
+    {
+        // Initializing plugin options with default values
+        HotFilesAnalyzer::Options options;
+        options.width = DefaultWidth;
+        options.depth = DefaultDepth;
+        options.capacity = DefaultCapacity;
+        options.top = DefaultTop;
+        options.stormOps = DefaultStormOps;
+        // Parising plugin options
+        enum
+        {
+            WIDTH_SUBOPT_INDEX = 0,
+            DEPTH_SUBOPT_INDEX,
+            CAPACITY_SUBOPT_INDEX,
+            TOP_SUBOPT_INDEX,
+            STORM_SUBOPT_INDEX
+        };
+        char widthSubOptName[] = "width";
+        char depthSubOptName[] = "depth";
+        char capacitySubOptName[] = "capacity";
+        char topSubOptName[] = "top";
+        char stormSubOptName[] = "storm";
+        char* const tokens[] =
+        {
+            widthSubOptName,
+            depthSubOptName,
+            capacitySubOptName,
+            topSubOptName,
+            stormSubOptName,
+            NULL
+        };
+        std::size_t optsLen = strlen(opts);
+        std::vector<char> optsBuf{opts, opts + optsLen + 2};
+        char* optionp = &optsBuf[0];
+        char* valuep;
+        int optIndex;
+        while ((optIndex = getsubopt(&optionp, tokens, &valuep)) >= 0)
+        {
+            try
+            {
+                switch (optIndex)
+                {
+                case WIDTH_SUBOPT_INDEX:
+                    options.width = std::stoul(valuep);
+                    break;
+                case DEPTH_SUBOPT_INDEX:
+                    options.depth = std::stoul(valuep);
+                    break;
+                case CAPACITY_SUBOPT_INDEX:
+                    options.capacity = std::stoul(valuep);
+                    break;
+                case TOP_SUBOPT_INDEX:
+                    options.top = std::stoul(valuep);
+                    break;
+                case STORM_SUBOPT_INDEX:
+                    options.stormOps = std::stoull(valuep);
+                    break;
+                default:
+                    throw std::runtime_error{std::string{"Invalid suboption index: "} + std::to_string(optIndex)};
+                }
+            }
+            catch (std::logic_error& e)
+            {
+                throw std::runtime_error{std::string{"Invalid value provided for '"} + tokens[optIndex] + "' suboption"};
+            }
+        }
+        if (options.width == 0U || options.depth == 0U || options.capacity == 0U)
+        {
+            throw std::runtime_error{"Values of 'width', 'depth' and 'capacity' suboptions must be positive"};
+        }
+        // Creating and returning plugin
+        return new HotFilesAnalyzer{options};
+    }
+
+    void destroy(IAnalyzer* instance)
+    {
+        delete instance;
+    }
+
+    NST_PLUGIN_ENTRY_POINTS (&usage, &create, &destroy, nullptr)
+
+} //extern "C"
+
+//------------------------------------------------------------------------------
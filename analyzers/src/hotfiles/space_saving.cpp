@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Space-Saving top-K of file handles
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <utility>
+
+#include "space_saving.h"
+//------------------------------------------------------------------------------
+void HotObject::account(Operation operation, uint64_t amount, uint64_t time)
+{
+    const bool metadata = operation == Operation::Getattr || operation == Operation::Lookup || operation == Operation::Access;
+    ++ops[static_cast<std::size_t>(operation)];
+    bytes += amount;
+    if (time != second)
+    {
+        second = time;
+        secondOps = 0U;
+        secondMetadataOps = 0U;
+    }
+    peakOps = std::max(peakOps, ++secondOps);
+    if (metadata)
+    {
+        peakMetadataOps = std::max(peakMetadataOps, ++secondMetadataOps);
+    }
+}
+
+SpaceSaving::SpaceSaving(std::size_t capacity) :
+    _capacity{std::max<std::size_t>(capacity, 1U)},
+    _objects{},
+    _index{},
+    _replacedAmount{0U}
+{
+    _objects.reserve(_capacity);
+    _index.reserve(_capacity);
+}
+
+HotObject& SpaceSaving::add(const FileHandle& handle, uint64_t weight, uint64_t estimate)
+{
+    auto found = _index.find(handle);
+    if (found != _index.end())
+    {
+        _objects[found->second].count += weight;
+        return _objects[siftDown(found->second)];
+    }
+
+    if (_objects.size() < _capacity)
+    {
+        // Nothing was replaced yet, so the count is exact
+        _objects.push_back(HotObject{});
+        HotObject& object = _objects.back();
+        object.handle = handle;
+        object.count = weight;
+        _index.emplace(handle, _objects.size() - 1);
+        return _objects[siftUp(_objects.size() - 1)];
+    }
+
+    // Replace the lightest object
+    HotObject& object = _objects.front();
+    const uint64_t count = std::min(object.count + weight, std::max(estimate, weight));
+    _index.erase(object.handle);
+    object = HotObject{};
+    object.handle = handle;
+    object.count = count;
+    object.error = count - weight;
+    _index.emplace(handle, 0U);
+    ++_replacedAmount;
+    return _objects[siftDown(0U)];
+}
+
+std::vector<const HotObject*> SpaceSaving::top(std::size_t amount) const
+{
+    std::vector<const HotObject*> result;
+    result.reserve(_objects.size());
+    for (const HotObject& object : _objects)
+    {
+        result.push_back(&object);
+    }
+    amount = std::min(amount, result.size());
+    std::partial_sort(result.begin(), result.begin() + amount, result.end(), [](const HotObject* a, const HotObject* b)
+    {
+        return a->count > b->count;
+    });
+    result.resize(amount);
+    return result;
+}
+
+std::size_t SpaceSaving::siftUp(std::size_t position)
+{
+    while (position > 0U)
+    {
+        const std::size_t parent = (position - 1U) / 2U;
+        if (_objects[parent].count <= _objects[position].count)
+        {
+            break;
+        }
+        swap(parent, position);
+        position = parent;
+    }
+    return position;
+}
+
+std::size_t SpaceSaving::siftDown(std::size_t position)
+{
+    for (;;)
+    {
+        const std::size_t left = position * 2U + 1U;
+        const std::size_t right = left + 1U;
+        std::size_t smallest = position;
+        if (left < _objects.size() && _objects[left].count < _objects[smallest].count)
+        {
+            smallest = left;
+        }
+        if (right < _objects.size() && _objects[right].count < _objects[smallest].count)
+        {
+            smallest = right;
+        }
+        if (smallest == position)
+        {
+            break;
+        }
+        swap(smallest, position);
+        position = smallest;
+    }
+    return position;
+}
+
+void SpaceSaving::swap(std::size_t a, std::size_t b)
+{
+    std::swap(_objects[a], _objects[b]);
+    _index[_objects[a].handle] = a;
+    _index[_objects[b].handle] = b;
+}
+//------------------------------------------------------------------------------
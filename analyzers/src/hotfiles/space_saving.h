@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Space-Saving top-K of file handles
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef SPACE_SAVING_H
+#define SPACE_SAVING_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "common/file_handle.h"
+//------------------------------------------------------------------------------
+//! Operations on file handles which are accounted
+enum class Operation
+{
+    Getattr,
+    Lookup,
+    Access,
+    Read,
+    Write
+};
+
+static constexpr std::size_t OperationsAmount = 5U;
+
+//! Monitored file handle
+struct HotObject
+{
+    //! Accounts operation with object
+    /*!
+     * \param operation Operation
+     * \param bytes Amount of read or written bytes
+     * \param second Time of operation in seconds
+     */
+    void account(Operation operation, uint64_t bytes, uint64_t second);
+
+    FileHandle handle;
+    uint64_t count;  //!< Estimated weight, never less than the true one
+    uint64_t error;  //!< Max overestimation of count
+    // Exact counters since the object is monitored:
+    uint64_t ops[OperationsAmount];
+    uint64_t bytes;
+    uint64_t second;
+    uint64_t secondOps;
+    uint64_t secondMetadataOps;
+    uint64_t peakOps;          //!< Max amount of operations per second
+    uint64_t peakMetadataOps;  //!< Max amount of GETATTR, LOOKUP and ACCESS per second
+};
+
+//! Space-Saving summary of the heaviest file handles
+/*!
+ * Monitors a fixed amount of objects. A new object replaces the lightest one
+ * and inherits its count, so every object heavier than total/capacity is
+ * monitored. Initial count of replacing object is additionally bounded by an
+ * external estimate (of Count-Min sketch) which makes it tighter. Objects are
+ * kept in a min-heap by count, so an update costs O(log capacity).
+ */
+class SpaceSaving
+{
+public:
+    SpaceSaving() = delete;
+    explicit SpaceSaving(std::size_t capacity);
+    SpaceSaving(const SpaceSaving&) = delete;
+    SpaceSaving& operator=(const SpaceSaving&) = delete;
+
+    //! Adds weight of object
+    /*!
+     * \param handle Object
+     * \param weight Weight to add
+     * \param estimate Upper bound of total weight of object including this one
+     * \return Monitored object, the reference is valid till the next call
+     */
+    HotObject& add(const FileHandle& handle, uint64_t weight, uint64_t estimate);
+    //! Returns the heaviest objects in descending order of count
+    std::vector<const HotObject*> top(std::size_t amount) const;
+
+    inline std::size_t size() const
+    {
+        return _objects.size();
+    }
+    inline std::size_t capacity() const
+    {
+        return _capacity;
+    }
+    inline uint64_t replacedAmount() const
+    {
+        return _replacedAmount;
+    }
+private:
+    std::size_t siftUp(std::size_t position);
+    std::size_t siftDown(std::size_t position);
+    void swap(std::size_t a, std::size_t b);
+
+    std::size_t _capacity;
+    std::vector<HotObject> _objects; // min-heap by count
+    std::unordered_map<FileHandle, std::size_t, FileHandleHash> _index; // position in heap
+    uint64_t _replacedAmount;
+};
+//------------------------------------------------------------------------------
+#endif//SPACE_SAVING_H
+//------------------------------------------------------------------------------
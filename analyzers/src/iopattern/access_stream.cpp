@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Classification of consecutive I/O requests to a file
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include "access_stream.h"
+//------------------------------------------------------------------------------
+constexpr std::size_t AccessCounters::SizeBuckets;
+constexpr unsigned AccessCounters::MinSizeShift;
+
+std::size_t AccessCounters::sizeBucket(uint64_t size)
+{
+    std::size_t bucket = 0U;
+    uint64_t bound = uint64_t{1} << MinSizeShift;
+    while (size > bound && bucket < SizeBuckets - 1)
+    {
+        bound <<= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+const char* AccessCounters::bucketLabel(std::size_t bucket)
+{
+    static const char* const labels[SizeBuckets] =
+    {
+        "<=512", "<=1K", "<=2K", "<=4K", "<=8K", "<=16K", "<=32K",
+        "<=64K", "<=128K", "<=256K", "<=512K", "<=1M", ">1M"
+    };
+    return bucket < SizeBuckets ? labels[bucket] : "";
+}
+
+void AccessCounters::add(Access access, uint64_t size)
+{
+    ++ops;
+    bytes += size;
+    ++sizes[sizeBucket(size)];
+    switch (access)
+    {
+    case Access::Sequential:
+        ++sequential;
+        break;
+    case Access::Strided:
+        ++strided;
+        break;
+    case Access::Random:
+        ++random;
+        break;
+    case Access::First:
+        break;
+    }
+}
+
+void AccessCounters::add(const AccessCounters& other)
+{
+    ops += other.ops;
+    bytes += other.bytes;
+    sequential += other.sequential;
+    strided += other.strided;
+    random += other.random;
+    for (std::size_t i = 0; i < SizeBuckets; ++i)
+    {
+        sizes[i] += other.sizes[i];
+    }
+}
+
+Access AccessStream::account(uint64_t offset, uint64_t size)
+{
+    Access access = Access::First;
+    const int64_t stride = static_cast<int64_t>(offset - _lastOffset);
+    if (_counters.ops != 0U)
+    {
+        if (offset == _lastOffset + _lastSize)
+        {
+            access = Access::Sequential;
+        }
+        else if (stride != 0 && stride == _lastStride)
+        {
+            access = Access::Strided;
+        }
+        else
+        {
+            access = Access::Random;
+        }
+        _lastStride = stride;
+    }
+    _lastOffset = offset;
+    _lastSize = size;
+    _counters.add(access, size);
+    return access;
+}
+//------------------------------------------------------------------------------
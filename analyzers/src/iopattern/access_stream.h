@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Classification of consecutive I/O requests to a file
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef ACCESS_STREAM_H
+#define ACCESS_STREAM_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdlib>
+//------------------------------------------------------------------------------
+//! Kind of a request relative to the previous request of the same stream
+enum class Access
+{
+    First,      //!< No previous request
+    Sequential, //!< Starts where the previous one ended
+    Strided,    //!< Same distance between offsets as for the previous pair
+    Random      //!< Anything else
+};
+
+//! Counters of requests: amounts by access kind and histogram of sizes
+struct AccessCounters
+{
+    //! Histogram buckets: <=512, <=1K, ... <=1M, >1M
+    static constexpr std::size_t SizeBuckets = 13U;
+    static constexpr unsigned MinSizeShift = 9U;
+
+    //! Returns index of bucket of request size
+    static std::size_t sizeBucket(uint64_t size);
+    //! Returns label of bucket ("<=512", "<=4K", ">1M" etc.)
+    static const char* bucketLabel(std::size_t bucket);
+
+    void add(Access access, uint64_t size);
+    void add(const AccessCounters& other);
+
+    uint64_t ops {0U};
+    uint64_t bytes {0U};
+    uint64_t sequential {0U};
+    uint64_t strided {0U};
+    uint64_t random {0U};
+    uint64_t sizes[SizeBuckets] {};
+};
+
+//! Stream of reads or writes of one file
+/*!
+ * Remembers the previous request only, so classification costs O(1) time and
+ * a few words of memory per file.
+ */
+class AccessStream
+{
+public:
+    //! Accounts request and returns its kind
+    /*!
+     * \param offset Offset of request in file
+     * \param size Requested amount of bytes
+     */
+    Access account(uint64_t offset, uint64_t size);
+
+    inline const AccessCounters& counters() const
+    {
+        return _counters;
+    }
+private:
+    AccessCounters _counters;
+    uint64_t _lastOffset {0U};
+    uint64_t _lastSize {0U};
+    int64_t _lastStride {0};
+};
+//------------------------------------------------------------------------------
+#endif//ACCESS_STREAM_H
+//------------------------------------------------------------------------------
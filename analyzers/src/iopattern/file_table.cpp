@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Bounded LRU table of statistics of files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+
+#include "file_table.h"
+//------------------------------------------------------------------------------
+constexpr std::size_t FileTable::None;
+
+FileTable::FileTable(std::size_t capacity) :
+    _capacity{std::max<std::size_t>(capacity, 1U)},
+    _entries{},
+    _index{},
+    _head{None},
+    _tail{None},
+    _evictedAmount{0U}
+{
+    _entries.reserve(_capacity);
+    _index.reserve(_capacity);
+}
+
+FileStat& FileTable::find(const FileHandle& handle)
+{
+    auto found = _index.find(handle);
+    if (found != _index.end())
+    {
+        if (found->second != _head)
+        {
+            unlink(found->second);
+            pushFront(found->second);
+        }
+        return _entries[found->second].stat;
+    }
+
+    std::size_t entry;
+    if (_entries.size() < _capacity)
+    {
+        entry = _entries.size();
+        _entries.push_back(Entry{});
+    }
+    else
+    {
+        entry = _tail;
+        unlink(entry);
+        _index.erase(_entries[entry].stat.handle);
+        _entries[entry].stat = FileStat{};
+        ++_evictedAmount;
+    }
+    _entries[entry].stat.handle = handle;
+    _index.emplace(handle, entry);
+    pushFront(entry);
+    return _entries[entry].stat;
+}
+
+std::vector<const FileStat*> FileTable::files() const
+{
+    std::vector<const FileStat*> result;
+    result.reserve(_index.size());
+    for (std::size_t entry = _head; entry != None; entry = _entries[entry].next)
+    {
+        result.push_back(&_entries[entry].stat);
+    }
+    return result;
+}
+
+void FileTable::unlink(std::size_t entry)
+{
+    Entry& e = _entries[entry];
+    if (e.prev != None)
+    {
+        _entries[e.prev].next = e.next;
+    }
+    else
+    {
+        _head = e.next;
+    }
+    if (e.next != None)
+    {
+        _entries[e.next].prev = e.prev;
+    }
+    else
+    {
+        _tail = e.prev;
+    }
+    e.prev = None;
+    e.next = None;
+}
+
+void FileTable::pushFront(std::size_t entry)
+{
+    Entry& e = _entries[entry];
+    e.prev = None;
+    e.next = _head;
+    if (_head != None)
+    {
+        _entries[_head].prev = entry;
+    }
+    _head = entry;
+    if (_tail == None)
+    {
+        _tail = entry;
+    }
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Bounded LRU table of statistics of files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef FILE_TABLE_H
+#define FILE_TABLE_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "access_stream.h"
+#include "common/file_handle.h"
+//------------------------------------------------------------------------------
+//! Statistics of one file
+struct FileStat
+{
+    FileHandle handle;
+    AccessStream reads;
+    AccessStream writes;
+};
+
+//! Table of files with bounded capacity
+/*!
+ * Entries are preallocated and linked into a recency list, so a lookup of a
+ * known file is a hash lookup and relinking of two entries. When the table is
+ * full the least recently accessed file is evicted.
+ */
+class FileTable
+{
+public:
+    FileTable() = delete;
+    //! Constructs table
+    /*!
+     * \param capacity Max amount of files to keep
+     */
+    explicit FileTable(std::size_t capacity);
+    FileTable(const FileTable&) = delete;
+    FileTable& operator=(const FileTable&) = delete;
+
+    //! Returns statistics of file, inserts file evicting the least recent one if needed
+    FileStat& find(const FileHandle& handle);
+    //! Returns statistics of all kept files, the most recent first
+    std::vector<const FileStat*> files() const;
+
+    inline std::size_t size() const
+    {
+        return _index.size();
+    }
+    inline std::size_t capacity() const
+    {
+        return _capacity;
+    }
+    inline uint64_t evictedAmount() const
+    {
+        return _evictedAmount;
+    }
+private:
+    static constexpr std::size_t None = static_cast<std::size_t>(-1);
+
+    struct Entry
+    {
+        FileStat stat;
+        std::size_t prev;
+        std::size_t next;
+    };
+
+    void unlink(std::size_t entry);
+    void pushFront(std::size_t entry);
+
+    std::size_t _capacity;
+    std::vector<Entry> _entries;
+    std::unordered_map<FileHandle, std::size_t, FileHandleHash> _index;
+    std::size_t _head; // the most recent
+    std::size_t _tail; // the least recent
+    uint64_t _evictedAmount;
+};
+//------------------------------------------------------------------------------
+#endif//FILE_TABLE_H
+//------------------------------------------------------------------------------
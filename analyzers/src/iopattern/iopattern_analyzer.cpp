@@ -0,0 +1,434 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of sizes and offsets of NFS reads and writes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+#include <arpa/inet.h>
+
+#include "iopattern_analyzer.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+double percent(uint64_t part, uint64_t total)
+{
+    return total == 0U ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+}
+
+double seconds(const struct timeval& from, const struct timeval& to)
+{
+    return static_cast<double>(to.tv_sec - from.tv_sec) + static_cast<double>(to.tv_usec - from.tv_usec) / 1000000.0;
+}
+
+} // namespace
+
+IOPatternAnalyzer::ClientAddress::ClientAddress(const Session& session) :
+    words{0U, 0U, 0U, 0U},
+    type{session.ip_type}
+{
+    switch (type)
+    {
+    case Session::IPType::v4:
+        words[0] = session.ip.v4.addr[Session::Source];
+        break;
+    case Session::IPType::v6:
+        memcpy(words, session.ip.v6.addr[Session::Source], sizeof(words));
+        break;
+    }
+}
+
+bool IOPatternAnalyzer::ClientAddress::operator==(const ClientAddress& other) const
+{
+    return type == other.type && memcmp(words, other.words, sizeof(words)) == 0;
+}
+
+std::string IOPatternAnalyzer::ClientAddress::str() const
+{
+    char buf[INET6_ADDRSTRLEN];
+    if (!inet_ntop(type == Session::IPType::v4 ? AF_INET : AF_INET6, words, buf, sizeof(buf)))
+    {
+        return std::string{};
+    }
+    return std::string{buf};
+}
+
+std::size_t IOPatternAnalyzer::ClientAddressHash::operator()(const ClientAddress& address) const
+{
+    // FNV-1a over 32-bit words of address
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t word : address.words)
+    {
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+}
+
+IOPatternAnalyzer::IOPatternAnalyzer(std::size_t filesCapacity, std::size_t topAmount, std::ostream& out) :
+    _files{filesCapacity},
+    _topAmount{topAmount},
+    _out(out),
+    _totalReads{},
+    _totalWrites{},
+    _clients{},
+    _handles{},
+    _unknownHandleAmount{0U}
+{
+}
+
+void IOPatternAnalyzer::read3(const RPCProcedure* proc,
+                              const struct NFS3::READ3args* args,
+                              const struct NFS3::READ3res* res)
+{
+    if (args)
+    {
+        account(Direction::Read, FileHandle{args->file.data.data_val, args->file.data.data_len}, args->offset, args->count);
+    }
+    if (res && res->status == NFS3::NFS3_OK)
+    {
+        accountClient(proc, Direction::Read, res->READ3res_u.resok.count);
+    }
+}
+
+void IOPatternAnalyzer::write3(const RPCProcedure* proc,
+                               const struct NFS3::WRITE3args* args,
+                               const struct NFS3::WRITE3res* res)
+{
+    if (args)
+    {
+        account(Direction::Write, FileHandle{args->file.data.data_val, args->file.data.data_len}, args->offset, args->count);
+    }
+    if (res && res->status == NFS3::NFS3_OK)
+    {
+        accountClient(proc, Direction::Write, res->WRITE3res_u.resok.count);
+    }
+}
+
+void IOPatternAnalyzer::compound4(const RPCProcedure*,
+                                  const struct NFS4::COMPOUND4args*,
+                                  const struct NFS4::COMPOUND4res*)
+{
+    _handles.start();
+}
+
+void IOPatternAnalyzer::putfh40(const RPCProcedure*,
+                                const struct NFS4::PUTFH4args* args,
+                                const struct NFS4::PUTFH4res*)
+{
+    _handles.putfh(args);
+}
+
+void IOPatternAnalyzer::getfh40(const RPCProcedure*,
+                                const struct NFS4::GETFH4res* res)
+{
+    _handles.getfh(res);
+}
+
+void IOPatternAnalyzer::putrootfh40(const RPCProcedure*,
+                                    const struct NFS4::PUTROOTFH4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::putpubfh40(const RPCProcedure*,
+                                   const struct NFS4::PUTPUBFH4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::lookup40(const RPCProcedure*,
+                                 const struct NFS4::LOOKUP4args*,
+                                 const struct NFS4::LOOKUP4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::lookupp40(const RPCProcedure*,
+                                  const struct NFS4::LOOKUPP4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::open40(const RPCProcedure*,
+                               const struct NFS4::OPEN4args*,
+                               const struct NFS4::OPEN4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::restorefh40(const RPCProcedure*,
+                                    const struct NFS4::RESTOREFH4res*)
+{
+    _handles.restore();
+}
+
+void IOPatternAnalyzer::savefh40(const RPCProcedure*,
+                                 const struct NFS4::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void IOPatternAnalyzer::read40(const RPCProcedure* proc,
+                               const struct NFS4::READ4args* args,
+                               const struct NFS4::READ4res* res)
+{
+    if (args)
+    {
+        if (_handles.known())
+        {
+            account(Direction::Read, _handles.current(), args->offset, args->count);
+        }
+        else
+        {
+            ++_unknownHandleAmount;
+        }
+    }
+    if (res && res->status == NFS4::NFS4_OK)
+    {
+        accountClient(proc, Direction::Read, res->READ4res_u.resok4.data.data_len);
+    }
+}
+
+void IOPatternAnalyzer::write40(const RPCProcedure* proc,
+                                const struct NFS4::WRITE4args* args,
+                                const struct NFS4::WRITE4res* res)
+{
+    if (args)
+    {
+        if (_handles.known())
+        {
+            account(Direction::Write, _handles.current(), args->offset, args->data.data_len);
+        }
+        else
+        {
+            ++_unknownHandleAmount;
+        }
+    }
+    if (res && res->status == NFS4::NFS4_OK)
+    {
+        accountClient(proc, Direction::Write, res->WRITE4res_u.resok4.count);
+    }
+}
+
+void IOPatternAnalyzer::compound41(const RPCProcedure*,
+                                   const struct NFS41::COMPOUND4args*,
+                                   const struct NFS41::COMPOUND4res*)
+{
+    _handles.start();
+}
+
+void IOPatternAnalyzer::putfh41(const RPCProcedure*,
+                                const struct NFS41::PUTFH4args* args,
+                                const struct NFS41::PUTFH4res*)
+{
+    _handles.putfh(args);
+}
+
+void IOPatternAnalyzer::getfh41(const RPCProcedure*,
+                                const struct NFS41::GETFH4res* res)
+{
+    _handles.getfh(res);
+}
+
+void IOPatternAnalyzer::putrootfh41(const RPCProcedure*,
+                                    const struct NFS41::PUTROOTFH4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::putpubfh41(const RPCProcedure*,
+                                   const struct NFS41::PUTPUBFH4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::lookup41(const RPCProcedure*,
+                                 const struct NFS41::LOOKUP4args*,
+                                 const struct NFS41::LOOKUP4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::lookupp41(const RPCProcedure*,
+                                  const struct NFS41::LOOKUPP4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::open41(const RPCProcedure*,
+                               const struct NFS41::OPEN4args*,
+                               const struct NFS41::OPEN4res*)
+{
+    _handles.forget();
+}
+
+void IOPatternAnalyzer::restorefh41(const RPCProcedure*,
+                                    const struct NFS41::RESTOREFH4res*)
+{
+    _handles.restore();
+}
+
+void IOPatternAnalyzer::savefh41(const RPCProcedure*,
+                                 const struct NFS41::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void IOPatternAnalyzer::read41(const RPCProcedure* proc,
+                               const struct NFS41::READ4args* args,
+                               const struct NFS41::READ4res* res)
+{
+    if (args)
+    {
+        if (_handles.known())
+        {
+            account(Direction::Read, _handles.current(), args->offset, args->count);
+        }
+        else
+        {
+            ++_unknownHandleAmount;
+        }
+    }
+    if (res && res->status == NFS41::NFS4_OK)
+    {
+        accountClient(proc, Direction::Read, res->READ4res_u.resok4.data.data_len);
+    }
+}
+
+void IOPatternAnalyzer::write41(const RPCProcedure* proc,
+                                const struct NFS41::WRITE4args* args,
+                                const struct NFS41::WRITE4res* res)
+{
+    if (args)
+    {
+        if (_handles.known())
+        {
+            account(Direction::Write, _handles.current(), args->offset, args->data.data_len);
+        }
+        else
+        {
+            ++_unknownHandleAmount;
+        }
+    }
+    if (res && res->status == NFS41::NFS4_OK)
+    {
+        accountClient(proc, Direction::Write, res->WRITE4res_u.resok4.count);
+    }
+}
+
+void IOPatternAnalyzer::flush_statistics()
+{
+    _out << "### I/O pattern statistics ###" << std::endl;
+    printCounters("READ", _totalReads);
+    printCounters("WRITE", _totalWrites);
+    if (_unknownHandleAmount != 0U)
+    {
+        _out << "NFSv4.x I/O without known file handle: " << _unknownHandleAmount << std::endl;
+    }
+
+    _out << "Files: " << _files.size() << " (capacity " << _files.capacity()
+         << ", evicted " << _files.evictedAmount() << ")" << std::endl;
+    std::vector<const FileStat*> files = _files.files();
+    const std::size_t top = std::min(_topAmount, files.size());
+    std::partial_sort(files.begin(), files.begin() + top, files.end(), [](const FileStat* a, const FileStat* b)
+    {
+        return a->reads.counters().bytes + a->writes.counters().bytes > b->reads.counters().bytes + b->writes.counters().bytes;
+    });
+    for (std::size_t i = 0; i < top; ++i)
+    {
+        _out << "FH " << files[i]->handle.str() << std::endl;
+        printCounters("READ", files[i]->reads.counters());
+        printCounters("WRITE", files[i]->writes.counters());
+    }
+
+    _out << "Clients:" << std::endl;
+    for (const auto& client : _clients)
+    {
+        const ClientStat& stat = client.second;
+        const double duration = seconds(stat.first, stat.last);
+        _out << client.first.str()
+             << " read " << stat.readBytes << " B"
+             << " write " << stat.writeBytes << " B";
+        if (duration > 0.0)
+        {
+            _out << std::fixed << std::setprecision(1)
+                 << " read " << stat.readBytes / duration << " B/s"
+                 << " write " << stat.writeBytes / duration << " B/s"
+                 << " during " << duration << " s";
+            _out.unsetf(std::ios::floatfield);
+        }
+        _out << std::endl;
+    }
+}
+
+void IOPatternAnalyzer::account(Direction direction, const FileHandle& handle, uint64_t offset, uint64_t size)
+{
+    FileStat& file = _files.find(handle);
+    if (direction == Direction::Read)
+    {
+        _totalReads.add(file.reads.account(offset, size), size);
+    }
+    else
+    {
+        _totalWrites.add(file.writes.account(offset, size), size);
+    }
+}
+
+void IOPatternAnalyzer::accountClient(const RPCProcedure* proc, Direction direction, uint64_t bytes)
+{
+    auto inserted = _clients.emplace(ClientAddress{*proc->session}, ClientStat{0U, 0U, *proc->ctimestamp, *proc->rtimestamp});
+    ClientStat& stat = inserted.first->second;
+    stat.last = *proc->rtimestamp;
+    if (direction == Direction::Read)
+    {
+        stat.readBytes += bytes;
+    }
+    else
+    {
+        stat.writeBytes += bytes;
+    }
+}
+
+void IOPatternAnalyzer::printCounters(const char* name, const AccessCounters& counters)
+{
+    if (counters.ops == 0U)
+    {
+        return;
+    }
+    _out << "  " << name << " ops " << counters.ops << " bytes " << counters.bytes
+         << std::fixed << std::setprecision(1)
+         << " sequential " << percent(counters.sequential, counters.ops) << "%"
+         << " strided " << percent(counters.strided, counters.ops) << "%"
+         << " random " << percent(counters.random, counters.ops) << "%";
+    _out.unsetf(std::ios::floatfield);
+    _out << std::endl << "    sizes";
+    for (std::size_t i = 0; i < AccessCounters::SizeBuckets; ++i)
+    {
+        if (counters.sizes[i] != 0U)
+        {
+            _out << " " << AccessCounters::bucketLabel(i) << ":" << counters.sizes[i];
+        }
+    }
+    _out << std::endl;
+}
+//------------------------------------------------------------------------------
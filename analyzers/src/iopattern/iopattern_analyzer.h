@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of sizes and offsets of NFS reads and writes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef IOPATTERN_ANALYZER_H
+#define IOPATTERN_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <unordered_map>
+
+#include "api/ianalyzer.h"
+#include "common/compound_handles.h"
+#include "file_table.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer of I/O patterns of NFS clients
+/*!
+ * Builds histograms of request sizes per file handle, classifies reads and
+ * writes of each file as sequential, strided or random and measures
+ * throughput of each client. NFSv4.x READ and WRITE operations carry no file
+ * handle, so the current file handle of a COMPOUND is tracked from PUTFH and
+ * GETFH operations.
+ */
+class IOPatternAnalyzer : public IAnalyzer
+{
+public:
+    IOPatternAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param filesCapacity Max amount of files to keep statistics of
+     * \param topAmount Amount of the busiest files to report
+     * \param out Stream to report to
+     */
+    IOPatternAnalyzer(std::size_t filesCapacity, std::size_t topAmount, std::ostream& out = std::cout);
+    IOPatternAnalyzer(const IOPatternAnalyzer&) = delete;
+    IOPatternAnalyzer& operator=(const IOPatternAnalyzer&) = delete;
+
+    // NFSv3 procedures
+
+    void read3(const RPCProcedure* proc,
+               const struct NFS3::READ3args* args,
+               const struct NFS3::READ3res* res) override final;
+    void write3(const RPCProcedure* proc,
+                const struct NFS3::WRITE3args* args,
+                const struct NFS3::WRITE3res* res) override final;
+
+    // NFSv4.0 procedures and operations
+
+    void compound4(const RPCProcedure* proc,
+                   const struct NFS4::COMPOUND4args* args,
+                   const struct NFS4::COMPOUND4res* res) override final;
+    void putfh40(const RPCProcedure* proc,
+                 const struct NFS4::PUTFH4args* args,
+                 const struct NFS4::PUTFH4res* res) override final;
+    void getfh40(const RPCProcedure* proc,
+                 const struct NFS4::GETFH4res* res) override final;
+    void putrootfh40(const RPCProcedure* proc,
+                     const struct NFS4::PUTROOTFH4res* res) override final;
+    void putpubfh40(const RPCProcedure* proc,
+                    const struct NFS4::PUTPUBFH4res* res) override final;
+    void lookup40(const RPCProcedure* proc,
+                  const struct NFS4::LOOKUP4args* args,
+                  const struct NFS4::LOOKUP4res* res) override final;
+    void lookupp40(const RPCProcedure* proc,
+                   const struct NFS4::LOOKUPP4res* res) override final;
+    void open40(const RPCProcedure* proc,
+                const struct NFS4::OPEN4args* args,
+                const struct NFS4::OPEN4res* res) override final;
+    void restorefh40(const RPCProcedure* proc,
+                     const struct NFS4::RESTOREFH4res* res) override final;
+    void savefh40(const RPCProcedure* proc,
+                  const struct NFS4::SAVEFH4res* res) override final;
+    void read40(const RPCProcedure* proc,
+                const struct NFS4::READ4args* args,
+                const struct NFS4::READ4res* res) override final;
+    void write40(const RPCProcedure* proc,
+                 const struct NFS4::WRITE4args* args,
+                 const struct NFS4::WRITE4res* res) override final;
+
+    // NFSv4.1 procedures and operations
+
+    void compound41(const RPCProcedure* proc,
+                    const struct NFS41::COMPOUND4args* args,
+                    const struct NFS41::COMPOUND4res* res) override final;
+    void putfh41(const RPCProcedure* proc,
+                 const struct NFS41::PUTFH4args* args,
+                 const struct NFS41::PUTFH4res* res) override final;
+    void getfh41(const RPCProcedure* proc,
+                 const struct NFS41::GETFH4res* res) override final;
+    void putrootfh41(const RPCProcedure* proc,
+                     const struct NFS41::PUTROOTFH4res* res) override final;
+    void putpubfh41(const RPCProcedure* proc,
+                    const struct NFS41::PUTPUBFH4res* res) override final;
+    void lookup41(const RPCProcedure* proc,
+                  const struct NFS41::LOOKUP4args* args,
+                  const struct NFS41::LOOKUP4res* res) override final;
+    void lookupp41(const RPCProcedure* proc,
+                   const struct NFS41::LOOKUPP4res* res) override final;
+    void open41(const RPCProcedure* proc,
+                const struct NFS41::OPEN4args* args,
+                const struct NFS41::OPEN4res* res) override final;
+    void restorefh41(const RPCProcedure* proc,
+                     const struct NFS41::RESTOREFH4res* res) override final;
+    void savefh41(const RPCProcedure* proc,
+                  const struct NFS41::SAVEFH4res* res) override final;
+    void read41(const RPCProcedure* proc,
+                const struct NFS41::READ4args* args,
+                const struct NFS41::READ4res* res) override final;
+    void write41(const RPCProcedure* proc,
+                 const struct NFS41::WRITE4args* args,
+                 const struct NFS41::WRITE4res* res) override final;
+
+    void flush_statistics() override final;
+private:
+    //! IP-address of a client
+    struct ClientAddress
+    {
+        explicit ClientAddress(const Session& session);
+
+        bool operator==(const ClientAddress& other) const;
+        std::string str() const;
+
+        uint32_t words[4]; // IPv4 address is stored in the first word
+        Session::IPType type;
+    };
+
+    struct ClientAddressHash
+    {
+        std::size_t operator()(const ClientAddress& address) const;
+    };
+
+    //! Transferred bytes of a client
+    struct ClientStat
+    {
+        uint64_t readBytes;
+        uint64_t writeBytes;
+        struct timeval first;
+        struct timeval last;
+    };
+
+    enum class Direction
+    {
+        Read,
+        Write
+    };
+
+    void account(Direction direction, const FileHandle& handle, uint64_t offset, uint64_t size);
+    void accountClient(const RPCProcedure* proc, Direction direction, uint64_t bytes);
+    void printCounters(const char* name, const AccessCounters& counters);
+
+    FileTable _files;
+    std::size_t _topAmount;
+    std::ostream& _out;
+    AccessCounters _totalReads;
+    AccessCounters _totalWrites;
+    std::unordered_map<ClientAddress, ClientStat, ClientAddressHash> _clients;
+    CompoundHandles _handles; // current and saved file handles of NFSv4.x COMPOUND
+    uint64_t _unknownHandleAmount; // NFSv4.x I/O without known current file handle
+};
+//------------------------------------------------------------------------------
+#endif//IOPATTERN_ANALYZER_H
+//------------------------------------------------------------------------------
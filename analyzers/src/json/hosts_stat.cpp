@@ -0,0 +1,242 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Per-host statistics with bounded amount of hosts
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <arpa/inet.h>
+
+#include "hosts_stat.h"
+//------------------------------------------------------------------------------
+using NST::API::Session;
+
+constexpr std::size_t HostsStat::ShardsAmount;
+constexpr std::size_t HostsStat::CacheLineSize;
+
+HostsStat::Address::Address(const Session& session, Session::Direction side) :
+    words{0U, 0U, 0U, 0U},
+    type{session.ip_type}
+{
+    switch (type)
+    {
+    case Session::IPType::v4:
+        words[0] = session.ip.v4.addr[side];
+        break;
+    case Session::IPType::v6:
+        memcpy(words, session.ip.v6.addr[side], sizeof(words));
+        break;
+    }
+}
+
+bool HostsStat::Address::operator==(const Address& other) const
+{
+    return type == other.type && memcmp(words, other.words, sizeof(words)) == 0;
+}
+
+std::string HostsStat::Address::str() const
+{
+    char buf[INET6_ADDRSTRLEN];
+    if (!inet_ntop(type == Session::IPType::v4 ? AF_INET : AF_INET6, words, buf, sizeof(buf)))
+    {
+        return std::string{};
+    }
+    return std::string{buf};
+}
+
+std::size_t HostsStat::AddressHash::operator()(const Address& address) const
+{
+    // FNV-1a over 32-bit words of address
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t word : address.words)
+    {
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+}
+
+void HostsStat::EntriesDeleter::operator()(Entry* entries) const
+{
+    free(entries);
+}
+
+//------------------------------------------------------------------------------
+
+HostsStat::HostsStat(std::size_t capacity) :
+    _shardCapacity{std::max<std::size_t>(capacity / ShardsAmount, 1U)},
+    _evictedAmount{0U}
+{
+    for (auto& shard : _shards)
+    {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, CacheLineSize, _shardCapacity * sizeof(Entry)) != 0)
+        {
+            throw std::bad_alloc{};
+        }
+        shard.entries.reset(static_cast<Entry*>(memory));
+        shard.index.reserve(_shardCapacity);
+        shard.freeEntries.reserve(_shardCapacity);
+        shard.hand = 0U;
+        for (std::size_t i = _shardCapacity; i > 0U; --i)
+        {
+            shard.freeEntries.push_back(i - 1U);
+        }
+    }
+}
+
+void HostsStat::account(const Address& address, uint64_t ops, uint64_t reads, uint64_t writes, uint64_t bytes)
+{
+    Shard& shard = _shards[AddressHash{}(address) % ShardsAmount];
+    Entry& entry = findOrInsert(shard, address);
+    if (ops != 0U)
+    {
+        increment(entry.ops, ops);
+    }
+    if (reads != 0U)
+    {
+        increment(entry.reads, reads);
+    }
+    if (writes != 0U)
+    {
+        increment(entry.writes, writes);
+    }
+    if (bytes != 0U)
+    {
+        increment(entry.bytes, bytes);
+    }
+}
+
+std::vector<HostsStat::Host> HostsStat::top(std::size_t amount, SortKey key) const
+{
+    std::vector<Host> hosts;
+    for (const auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        for (const auto& i : shard.index)
+        {
+            const Entry& entry = shard.entries[i.second];
+            hosts.push_back(Host{i.first.str(),
+                                 entry.ops.load(std::memory_order_relaxed),
+                                 entry.reads.load(std::memory_order_relaxed),
+                                 entry.writes.load(std::memory_order_relaxed),
+                                 entry.bytes.load(std::memory_order_relaxed)});
+        }
+    }
+    uint64_t Host::* field = &Host::ops;
+    switch (key)
+    {
+    case SortKey::Ops:
+        field = &Host::ops;
+        break;
+    case SortKey::Reads:
+        field = &Host::reads;
+        break;
+    case SortKey::Writes:
+        field = &Host::writes;
+        break;
+    case SortKey::Bytes:
+        field = &Host::bytes;
+        break;
+    }
+    auto greater = [field](const Host& a, const Host& b)
+    {
+        return a.*field > b.*field;
+    };
+    if (amount < hosts.size())
+    {
+        std::partial_sort(hosts.begin(), hosts.begin() + amount, hosts.end(), greater);
+        hosts.resize(amount);
+    }
+    else
+    {
+        std::sort(hosts.begin(), hosts.end(), greater);
+    }
+    return hosts;
+}
+
+bool HostsStat::parseSortKey(const std::string& name, SortKey& key)
+{
+    if (name == "ops")
+    {
+        key = SortKey::Ops;
+    }
+    else if (name == "reads")
+    {
+        key = SortKey::Reads;
+    }
+    else if (name == "writes")
+    {
+        key = SortKey::Writes;
+    }
+    else if (name == "bytes")
+    {
+        key = SortKey::Bytes;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+HostsStat::Entry& HostsStat::findOrInsert(Shard& shard, const Address& address)
+{
+    // Only this thread modifies index, so lookup does not need the lock
+    auto i = shard.index.find(address);
+    if (i != shard.index.end())
+    {
+        Entry& entry = shard.entries[i->second];
+        entry.referenced = true;
+        return entry;
+    }
+
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    std::size_t position;
+    if (!shard.freeEntries.empty())
+    {
+        position = shard.freeEntries.back();
+        shard.freeEntries.pop_back();
+    }
+    else
+    {
+        // Clock: a host seen since the last pass of the hand gets a second chance
+        for (;;)
+        {
+            position = shard.hand;
+            shard.hand = (shard.hand + 1U) % _shardCapacity;
+            Entry& candidate = shard.entries[position];
+            if (!candidate.referenced)
+            {
+                break;
+            }
+            candidate.referenced = false;
+        }
+        shard.index.erase(shard.entries[position].address);
+        _evictedAmount.fetch_add(1U, std::memory_order_relaxed);
+    }
+    Entry* entry = new (&shard.entries[position]) Entry{{0U}, {0U}, {0U}, {0U}, address, false};
+    shard.index.emplace(address, position);
+    return *entry;
+}
+
+//------------------------------------------------------------------------------
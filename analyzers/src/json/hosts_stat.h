@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Per-host statistics with bounded amount of hosts
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef HOSTS_STAT_H
+#define HOSTS_STAT_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "api/session.h"
+//------------------------------------------------------------------------------
+//! Statistics of hosts (clients or servers) addressed by IP-address
+/*!
+ * Counters are updated by a single thread (the parser thread of nfstrace) and
+ * may be read by any amount of threads. Hosts are distributed between shards,
+ * the writer locks a shard only to insert or evict a host, so accounting of a
+ * known host is a lookup and a few relaxed stores. The amount of hosts is
+ * bounded by capacity - when a new host does not fit, a clock hand of the
+ * shard evicts the first host not seen again since its insertion or the last
+ * pass of the hand, so a burst of new hosts evicts itself and eviction costs
+ * O(1) amortized.
+ */
+class HostsStat
+{
+public:
+    static constexpr std::size_t ShardsAmount = 16U;
+    static constexpr std::size_t CacheLineSize = 64U;
+
+    //! Key to sort hosts by
+    enum class SortKey
+    {
+        Ops,
+        Reads,
+        Writes,
+        Bytes
+    };
+
+    //! IP-address of a host
+    struct Address
+    {
+        Address(const NST::API::Session& session, NST::API::Session::Direction side);
+
+        bool operator==(const Address& other) const;
+        std::string str() const;
+
+        uint32_t words[4]; // IPv4 address is stored in the first word
+        NST::API::Session::IPType type;
+    };
+
+    //! Snapshot of host counters
+    struct Host
+    {
+        std::string address;
+        uint64_t ops;
+        uint64_t reads;
+        uint64_t writes;
+        uint64_t bytes;
+    };
+
+    HostsStat() = delete;
+    //! Constructs statistics
+    /*!
+     * \param capacity Max amount of hosts to keep
+     */
+    explicit HostsStat(std::size_t capacity);
+    HostsStat(const HostsStat&) = delete;
+    HostsStat& operator=(const HostsStat&) = delete;
+
+    //! Accounts activity of host, must be called from the single writer thread
+    /*!
+     * \param address Address of the host
+     * \param ops Amount of operations
+     * \param reads Amount of read operations
+     * \param writes Amount of write operations
+     * \param bytes Amount of read or written bytes
+     */
+    void account(const Address& address, uint64_t ops, uint64_t reads, uint64_t writes, uint64_t bytes);
+    //! Returns hosts with the greatest value of key in descending order
+    std::vector<Host> top(std::size_t amount, SortKey key) const;
+    //! Returns amount of evicted hosts
+    inline uint64_t evictedAmount() const
+    {
+        return _evictedAmount.load(std::memory_order_relaxed);
+    }
+    //! Parses sort key name ("ops", "reads", "writes" or "bytes")
+    static bool parseSortKey(const std::string& name, SortKey& key);
+private:
+    // Counters are written by a single thread, so relaxed stores are enough.
+    // An entry occupies a whole cache line to prevent false sharing.
+    struct alignas(CacheLineSize) Entry
+    {
+        std::atomic<uint64_t> ops;
+        std::atomic<uint64_t> reads;
+        std::atomic<uint64_t> writes;
+        std::atomic<uint64_t> bytes;
+        Address address;
+        bool referenced; // seen again since insertion or the last pass of the clock hand
+    };
+
+    struct AddressHash
+    {
+        std::size_t operator()(const Address& address) const;
+    };
+
+    struct EntriesDeleter
+    {
+        void operator()(Entry* entries) const;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex; // guards modification of index
+        std::unordered_map<Address, std::size_t, AddressHash> index;
+        std::unique_ptr<Entry[], EntriesDeleter> entries;
+        std::vector<std::size_t> freeEntries;
+        std::size_t hand; // position of the clock hand
+    };
+
+    static inline void increment(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    Entry& findOrInsert(Shard& shard, const Address& address);
+
+    const std::size_t _shardCapacity;
+    Shard _shards[ShardsAmount];
+    std::atomic<uint64_t> _evictedAmount;
+};
+//------------------------------------------------------------------------------
+#endif//HOSTS_STAT_H
+//------------------------------------------------------------------------------
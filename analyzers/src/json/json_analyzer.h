@@ -23,157 +23,209 @@
 #define JSON_ANALYZER_H
 //------------------------------------------------------------------------------
 #include <atomic>
+#include <cstdint>
+#include <mutex>
 
 #include "api/ianalyzer.h"
+#include "hosts_stat.h"
 #include "json_tcp_service.h"
+#include "seq_counter.h"
 //------------------------------------------------------------------------------
 using namespace NST::API;
 
 class JsonAnalyzer : public IAnalyzer
 {
 public:
-    struct NfsV3Stat
+    static constexpr std::size_t CacheLineSize = 64U;
+
+    // Counters of each block are incremented by the parser thread only and
+    // read by scraping threads, so every block occupies its own cache lines
+    // and readers take consistent snapshots of a block by its sequence lock.
+    // Counters are addressed by enumerators of the block.
+    struct NfsV3Counters
+    {
+        enum Index : std::size_t
+        {
+            // Procedures:
+            nullProcsAmount,
+            getattrProcsAmount,
+            setattrProcsAmount,
+            lookupProcsAmount,
+            accessProcsAmount,
+            readlinkProcsAmount,
+            readProcsAmount,
+            writeProcsAmount,
+            createProcsAmount,
+            mkdirProcsAmount,
+            symlinkProcsAmount,
+            mknodProcsAmount,
+            removeProcsAmount,
+            rmdirProcsAmount,
+            renameProcsAmount,
+            linkProcsAmount,
+            readdirProcsAmount,
+            readdirplusProcsAmount,
+            fsstatProcsAmount,
+            fsinfoProcsAmount,
+            pathconfProcsAmount,
+            commitProcsAmount,
+            Amount
+        };
+    };
+    struct alignas(CacheLineSize) NfsV3Stat : NfsV3Counters, SeqCounters<NfsV3Counters::Amount>
+    {
+    };
+    struct NfsV40Counters
+    {
+        enum Index : std::size_t
+        {
+            // Procedures:
+            nullProcsAmount,
+            compoundProcsAmount,
+
+            // Operations:
+            accessOpsAmount,
+            closeOpsAmount,
+            commitOpsAmount,
+            createOpsAmount,
+            delegpurgeOpsAmount,
+            delegreturnOpsAmount,
+            getattrOpsAmount,
+            getfhOpsAmount,
+            linkOpsAmount,
+            lockOpsAmount,
+            locktOpsAmount,
+            lockuOpsAmount,
+            lookupOpsAmount,
+            lookuppOpsAmount,
+            nverifyOpsAmount,
+            openOpsAmount,
+            openattrOpsAmount,
+            open_confirmOpsAmount,
+            open_downgradeOpsAmount,
+            putfhOpsAmount,
+            putpubfhOpsAmount,
+            putrootfhOpsAmount,
+            readOpsAmount,
+            readdirOpsAmount,
+            readlinkOpsAmount,
+            removeOpsAmount,
+            renameOpsAmount,
+            renewOpsAmount,
+            restorefhOpsAmount,
+            savefhOpsAmount,
+            secinfoOpsAmount,
+            setattrOpsAmount,
+            setclientidOpsAmount,
+            setclientid_confirmOpsAmount,
+            verifyOpsAmount,
+            writeOpsAmount,
+            release_lockownerOpsAmount,
+            get_dir_delegationOpsAmount,
+            illegalOpsAmount,
+            Amount
+        };
+    };
+    struct alignas(CacheLineSize) NfsV40Stat : NfsV40Counters, SeqCounters<NfsV40Counters::Amount>
     {
-        // Procedures:
-        std::atomic_int nullProcsAmount = {0};
-        std::atomic_int getattrProcsAmount = {0};
-        std::atomic_int setattrProcsAmount = {0};
-        std::atomic_int lookupProcsAmount = {0};
-        std::atomic_int accessProcsAmount = {0};
-        std::atomic_int readlinkProcsAmount = {0};
-        std::atomic_int readProcsAmount = {0};
-        std::atomic_int writeProcsAmount = {0};
-        std::atomic_int createProcsAmount = {0};
-        std::atomic_int mkdirProcsAmount = {0};
-        std::atomic_int symlinkProcsAmount = {0};
-        std::atomic_int mknodProcsAmount = {0};
-        std::atomic_int removeProcsAmount = {0};
-        std::atomic_int rmdirProcsAmount = {0};
-        std::atomic_int renameProcsAmount = {0};
-        std::atomic_int linkProcsAmount = {0};
-        std::atomic_int readdirProcsAmount = {0};
-        std::atomic_int readdirplusProcsAmount = {0};
-        std::atomic_int fsstatProcsAmount = {0};
-        std::atomic_int fsinfoProcsAmount = {0};
-        std::atomic_int pathconfProcsAmount = {0};
-        std::atomic_int commitProcsAmount = {0};
     };
-    struct NfsV40Stat
+    struct NfsV41Counters
     {
-        // Procedures:
-        std::atomic_int nullProcsAmount = {0};
-        std::atomic_int compoundProcsAmount = {0};
-
-        // Operations:
-        std::atomic_int accessOpsAmount = {0};
-        std::atomic_int closeOpsAmount = {0};
-        std::atomic_int commitOpsAmount = {0};
-        std::atomic_int createOpsAmount = {0};
-        std::atomic_int delegpurgeOpsAmount = {0};
-        std::atomic_int delegreturnOpsAmount = {0};
-        std::atomic_int getattrOpsAmount = {0};
-        std::atomic_int getfhOpsAmount = {0};
-        std::atomic_int linkOpsAmount = {0};
-        std::atomic_int lockOpsAmount = {0};
-        std::atomic_int locktOpsAmount = {0};
-        std::atomic_int lockuOpsAmount = {0};
-        std::atomic_int lookupOpsAmount = {0};
-        std::atomic_int lookuppOpsAmount = {0};
-        std::atomic_int nverifyOpsAmount = {0};
-        std::atomic_int openOpsAmount = {0};
-        std::atomic_int openattrOpsAmount = {0};
-        std::atomic_int open_confirmOpsAmount = {0};
-        std::atomic_int open_downgradeOpsAmount = {0};
-        std::atomic_int putfhOpsAmount = {0};
-        std::atomic_int putpubfhOpsAmount = {0};
-        std::atomic_int putrootfhOpsAmount = {0};
-        std::atomic_int readOpsAmount = {0};
-        std::atomic_int readdirOpsAmount = {0};
-        std::atomic_int readlinkOpsAmount = {0};
-        std::atomic_int removeOpsAmount = {0};
-        std::atomic_int renameOpsAmount = {0};
-        std::atomic_int renewOpsAmount = {0};
-        std::atomic_int restorefhOpsAmount = {0};
-        std::atomic_int savefhOpsAmount = {0};
-        std::atomic_int secinfoOpsAmount = {0};
-        std::atomic_int setattrOpsAmount = {0};
-        std::atomic_int setclientidOpsAmount = {0};
-        std::atomic_int setclientid_confirmOpsAmount = {0};
-        std::atomic_int verifyOpsAmount = {0};
-        std::atomic_int writeOpsAmount = {0};
-        std::atomic_int release_lockownerOpsAmount = {0};
-        std::atomic_int get_dir_delegationOpsAmount = {0};
-        std::atomic_int illegalOpsAmount = {0};
+        enum Index : std::size_t
+        {
+            // Procedures:
+            nullProcsAmount,
+            compoundProcsAmount,
+
+            // Operations:
+            accessOpsAmount,
+            closeOpsAmount,
+            commitOpsAmount,
+            createOpsAmount,
+            delegpurgeOpsAmount,
+            delegreturnOpsAmount,
+            getattrOpsAmount,
+            getfhOpsAmount,
+            linkOpsAmount,
+            lockOpsAmount,
+            locktOpsAmount,
+            lockuOpsAmount,
+            lookupOpsAmount,
+            lookuppOpsAmount,
+            nverifyOpsAmount,
+            openOpsAmount,
+            openattrOpsAmount,
+            open_confirmOpsAmount,
+            open_downgradeOpsAmount,
+            putfhOpsAmount,
+            putpubfhOpsAmount,
+            putrootfhOpsAmount,
+            readOpsAmount,
+            readdirOpsAmount,
+            readlinkOpsAmount,
+            removeOpsAmount,
+            renameOpsAmount,
+            renewOpsAmount,
+            restorefhOpsAmount,
+            savefhOpsAmount,
+            secinfoOpsAmount,
+            setattrOpsAmount,
+            setclientidOpsAmount,
+            setclientid_confirmOpsAmount,
+            verifyOpsAmount,
+            writeOpsAmount,
+            release_lockownerOpsAmount,
+            backchannel_ctlOpsAmount,
+            bind_conn_to_sessionOpsAmount,
+            exchange_idOpsAmount,
+            create_sessionOpsAmount,
+            destroy_sessionOpsAmount,
+            free_stateidOpsAmount,
+            get_dir_delegationOpsAmount,
+            getdeviceinfoOpsAmount,
+            getdevicelistOpsAmount,
+            layoutcommitOpsAmount,
+            layoutgetOpsAmount,
+            layoutreturnOpsAmount,
+            secinfo_no_nameOpsAmount,
+            sequenceOpsAmount,
+            set_ssvOpsAmount,
+            test_stateidOpsAmount,
+            want_delegationOpsAmount,
+            destroy_clientidOpsAmount,
+            reclaim_completeOpsAmount,
+            illegalOpsAmount,
+            Amount
+        };
     };
-    struct NfsV41Stat
+    struct alignas(CacheLineSize) NfsV41Stat : NfsV41Counters, SeqCounters<NfsV41Counters::Amount>
     {
-        // Procedures:
-        std::atomic_int nullProcsAmount = {0};
-        std::atomic_int compoundProcsAmount = {0};
-
-        // Operations:
-        std::atomic_int accessOpsAmount = {0};
-        std::atomic_int closeOpsAmount = {0};
-        std::atomic_int commitOpsAmount = {0};
-        std::atomic_int createOpsAmount = {0};
-        std::atomic_int delegpurgeOpsAmount = {0};
-        std::atomic_int delegreturnOpsAmount = {0};
-        std::atomic_int getattrOpsAmount = {0};
-        std::atomic_int getfhOpsAmount = {0};
-        std::atomic_int linkOpsAmount = {0};
-        std::atomic_int lockOpsAmount = {0};
-        std::atomic_int locktOpsAmount = {0};
-        std::atomic_int lockuOpsAmount = {0};
-        std::atomic_int lookupOpsAmount = {0};
-        std::atomic_int lookuppOpsAmount = {0};
-        std::atomic_int nverifyOpsAmount = {0};
-        std::atomic_int openOpsAmount = {0};
-        std::atomic_int openattrOpsAmount = {0};
-        std::atomic_int open_confirmOpsAmount = {0};
-        std::atomic_int open_downgradeOpsAmount = {0};
-        std::atomic_int putfhOpsAmount = {0};
-        std::atomic_int putpubfhOpsAmount = {0};
-        std::atomic_int putrootfhOpsAmount = {0};
-        std::atomic_int readOpsAmount = {0};
-        std::atomic_int readdirOpsAmount = {0};
-        std::atomic_int readlinkOpsAmount = {0};
-        std::atomic_int removeOpsAmount = {0};
-        std::atomic_int renameOpsAmount = {0};
-        std::atomic_int renewOpsAmount = {0};
-        std::atomic_int restorefhOpsAmount = {0};
-        std::atomic_int savefhOpsAmount = {0};
-        std::atomic_int secinfoOpsAmount = {0};
-        std::atomic_int setattrOpsAmount = {0};
-        std::atomic_int setclientidOpsAmount = {0};
-        std::atomic_int setclientid_confirmOpsAmount = {0};
-        std::atomic_int verifyOpsAmount = {0};
-        std::atomic_int writeOpsAmount = {0};
-        std::atomic_int release_lockownerOpsAmount = {0};
-        std::atomic_int backchannel_ctlOpsAmount = {0};
-        std::atomic_int bind_conn_to_sessionOpsAmount = {0};
-        std::atomic_int exchange_idOpsAmount = {0};
-        std::atomic_int create_sessionOpsAmount = {0};
-        std::atomic_int destroy_sessionOpsAmount = {0};
-        std::atomic_int free_stateidOpsAmount = {0};
-        std::atomic_int get_dir_delegationOpsAmount = {0};
-        std::atomic_int getdeviceinfoOpsAmount = {0};
-        std::atomic_int getdevicelistOpsAmount = {0};
-        std::atomic_int layoutcommitOpsAmount = {0};
-        std::atomic_int layoutgetOpsAmount = {0};
-        std::atomic_int layoutreturnOpsAmount = {0};
-        std::atomic_int secinfo_no_nameOpsAmount = {0};
-        std::atomic_int sequenceOpsAmount = {0};
-        std::atomic_int set_ssvOpsAmount = {0};
-        std::atomic_int test_stateidOpsAmount = {0};
-        std::atomic_int want_delegationOpsAmount = {0};
-        std::atomic_int destroy_clientidOpsAmount = {0};
-        std::atomic_int reclaim_completeOpsAmount = {0};
-        std::atomic_int illegalOpsAmount = {0};
     };
 
-    JsonAnalyzer(std::size_t workersAmount, int port, const std::string& host, std::size_t maxServingDurationMs, int backlog);
+    //! Histogram of procedures latencies with fixed bounds
+    struct alignas(CacheLineSize) LatencyHistogram
+    {
+        static constexpr std::size_t BoundsAmount = 14U;
+        //! Upper bounds of buckets in microseconds
+        static const uint64_t Bounds[BoundsAmount];
+
+        LatencyHistogram();
+        //! Accounts latency between call and reply of procedure
+        void add(const RPCProcedure* proc);
+
+        SeqLock lock;
+        std::atomic<uint64_t> buckets[BoundsAmount + 1U]; // last bucket is +Inf
+        std::atomic<uint64_t> sumUs;
+    };
+
+    JsonAnalyzer(std::size_t workersAmount, int port, const std::string& host, std::size_t maxServingDurationMs, int backlog,
+                 std::size_t hostsCapacity);
     ~JsonAnalyzer();
 
+    // Allocation aligned to cache line for blocks of counters
+    static void* operator new(std::size_t size);
+    static void operator delete(void* memory);
+
     // NFSv3 procedures
 
     void null(const RPCProcedure* /*proc*/,
@@ -559,6 +611,7 @@ public:
                    const struct NFS41::ILLEGAL4res* res) override final;
 
     void flush_statistics() override final;
+    void on_pipeline_metrics(const MetricsStat::Snapshot& metrics) override final;
 
     inline const NfsV3Stat& getNfsV3Stat() const
     {
@@ -575,11 +628,48 @@ public:
         return _nfsV41Stat;
     }
 
+    inline const LatencyHistogram& getNfsV3Latency() const
+    {
+        return _nfsV3Latency;
+    }
+
+    inline const LatencyHistogram& getNfsV40Latency() const
+    {
+        return _nfsV40Latency;
+    }
+
+    inline const LatencyHistogram& getNfsV41Latency() const
+    {
+        return _nfsV41Latency;
+    }
+
+    inline const HostsStat& getClientsStat() const
+    {
+        return _clientsStat;
+    }
+
+    inline const HostsStat& getServersStat() const
+    {
+        return _serversStat;
+    }
+
+    //! Copies the last metrics of nfstrace internals, returns false if they were not provided yet
+    bool getPipelineMetrics(MetricsStat::Snapshot& metrics) const;
+
 private:
+    void accountHosts(const RPCProcedure* proc, uint64_t ops, uint64_t reads, uint64_t writes, uint64_t bytes);
+
     JsonTcpService _jsonTcpService;
     NfsV3Stat  _nfsV3Stat;
     NfsV40Stat _nfsV40Stat;
     NfsV41Stat _nfsV41Stat;
+    LatencyHistogram _nfsV3Latency;
+    LatencyHistogram _nfsV40Latency;
+    LatencyHistogram _nfsV41Latency;
+    HostsStat _clientsStat;
+    HostsStat _serversStat;
+    mutable std::mutex _pipelineMetricsLock;
+    MetricsStat::Snapshot _pipelineMetrics;
 };
 //------------------------------------------------------------------------------
 #endif//JSON_ANALYZER_H
@@ -28,6 +28,7 @@ static constexpr const char * DefaultHost = IpEndpoint::WildcardAddress;
 static constexpr std::size_t DefaultWorkersAmount = 10U;
 static constexpr int DefaultBacklog = 15;
 static constexpr std::size_t DefaultMaxServingDurationMs = 500U;
+static constexpr std::size_t DefaultHostsCapacity = 1024U;
 
 extern "C"
 {
@@ -38,7 +39,8 @@ extern "C"
                "port - IP-port to bind to (default is 8888)\n"
                "workers - Amount of worker threads (default is 10)\n"
                "duration - Max serving duration in milliseconds (default is 500 ms)\n"
-               "backlog - Listen backlog (default is 15)";
+               "backlog - Listen backlog (default is 15)\n"
+               "hosts - Max amount of clients and servers to keep statistics of (default is 1024)";
     }
 
     IAnalyzer* create(const char* opts)
@@ -47,6 +49,7 @@ extern "C"
         int backlog = DefaultBacklog;
         std::size_t maxServingDurationMs = DefaultMaxServingDurationMs;
         std::string host{DefaultHost};
+        std::size_t hostsCapacity = DefaultHostsCapacity;
         int port = DefaultPort;
         std::size_t workersAmount = DefaultWorkersAmount;
         // Parising plugin options
@@ -55,12 +58,14 @@ extern "C"
             BACKLOG_SUBOPT_INDEX = 0,
             DURATION_SUBOPT_INDEX,
             HOST_SUBOPT_INDEX,
+            HOSTS_SUBOPT_INDEX,
             PORT_SUBOPT_INDEX,
             WORKERS_SUBOPT_INDEX
         };
         char backlogSubOptName[] = "backlog";
         char durationSubOptName[] = "duration";
         char hostSubOptName[] = "host";
+        char hostsSubOptName[] = "hosts";
         char portSubOptName[] = "port";
         char workersSubOptName[] = "workers";
         char* const tokens[] =
@@ -68,6 +73,7 @@ extern "C"
             backlogSubOptName,
             durationSubOptName,
             hostSubOptName,
+            hostsSubOptName,
             portSubOptName,
             workersSubOptName,
             NULL
@@ -92,6 +98,9 @@ extern "C"
                 case HOST_SUBOPT_INDEX:
                     host = valuep;
                     break;
+                case HOSTS_SUBOPT_INDEX:
+                    hostsCapacity = std::stoul(valuep);
+                    break;
                 case PORT_SUBOPT_INDEX:
                     port = std::stoi(valuep);
                     break;
@@ -108,7 +117,7 @@ extern "C"
             }
         }
         // Creating and returning plugin
-        return new JsonAnalyzer{workersAmount, port, host, maxServingDurationMs, backlog};
+        return new JsonAnalyzer{workersAmount, port, host, maxServingDurationMs, backlog, hostsCapacity};
     }
 
     void destroy(IAnalyzer* instance)
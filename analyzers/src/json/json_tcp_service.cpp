@@ -20,13 +20,396 @@
 */
 //------------------------------------------------------------------------------
 #include <chrono>
+#include <system_error>
+#include <type_traits>
 
 #include <json.h>
+#include <sys/select.h>
+#include <sys/socket.h>
 
 #include "json_analyzer.h"
 #include "json_tcp_service.h"
+#include "open_metrics_writer.h"
 #include "utils/log.h"
 //------------------------------------------------------------------------------
+namespace
+{
+
+constexpr std::size_t DefaultTopAmount = 20U;
+
+template <typename Stat>
+struct CounterDescriptor
+{
+    const char* name;
+    std::size_t counter;   // index in the block
+};
+
+const CounterDescriptor<JsonAnalyzer::NfsV3Stat> NfsV3Procedures[] =
+{
+    {"null",        JsonAnalyzer::NfsV3Stat::nullProcsAmount},
+    {"getattr",     JsonAnalyzer::NfsV3Stat::getattrProcsAmount},
+    {"setattr",     JsonAnalyzer::NfsV3Stat::setattrProcsAmount},
+    {"lookup",      JsonAnalyzer::NfsV3Stat::lookupProcsAmount},
+    {"access",      JsonAnalyzer::NfsV3Stat::accessProcsAmount},
+    {"readlink",    JsonAnalyzer::NfsV3Stat::readlinkProcsAmount},
+    {"read",        JsonAnalyzer::NfsV3Stat::readProcsAmount},
+    {"write",       JsonAnalyzer::NfsV3Stat::writeProcsAmount},
+    {"create",      JsonAnalyzer::NfsV3Stat::createProcsAmount},
+    {"mkdir",       JsonAnalyzer::NfsV3Stat::mkdirProcsAmount},
+    {"symlink",     JsonAnalyzer::NfsV3Stat::symlinkProcsAmount},
+    {"mknod",       JsonAnalyzer::NfsV3Stat::mknodProcsAmount},
+    {"remove",      JsonAnalyzer::NfsV3Stat::removeProcsAmount},
+    {"rmdir",       JsonAnalyzer::NfsV3Stat::rmdirProcsAmount},
+    {"rename",      JsonAnalyzer::NfsV3Stat::renameProcsAmount},
+    {"link",        JsonAnalyzer::NfsV3Stat::linkProcsAmount},
+    {"readdir",     JsonAnalyzer::NfsV3Stat::readdirProcsAmount},
+    {"readdirplus", JsonAnalyzer::NfsV3Stat::readdirplusProcsAmount},
+    {"fsstat",      JsonAnalyzer::NfsV3Stat::fsstatProcsAmount},
+    {"fsinfo",      JsonAnalyzer::NfsV3Stat::fsinfoProcsAmount},
+    {"pathconf",    JsonAnalyzer::NfsV3Stat::pathconfProcsAmount},
+    {"commit",      JsonAnalyzer::NfsV3Stat::commitProcsAmount}
+};
+
+const CounterDescriptor<JsonAnalyzer::NfsV40Stat> NfsV40Procedures[] =
+{
+    {"null",     JsonAnalyzer::NfsV40Stat::nullProcsAmount},
+    {"compound", JsonAnalyzer::NfsV40Stat::compoundProcsAmount}
+};
+
+const CounterDescriptor<JsonAnalyzer::NfsV40Stat> NfsV40Operations[] =
+{
+    {"access",              JsonAnalyzer::NfsV40Stat::accessOpsAmount},
+    {"close",               JsonAnalyzer::NfsV40Stat::closeOpsAmount},
+    {"commit",              JsonAnalyzer::NfsV40Stat::commitOpsAmount},
+    {"create",              JsonAnalyzer::NfsV40Stat::createOpsAmount},
+    {"delegpurge",          JsonAnalyzer::NfsV40Stat::delegpurgeOpsAmount},
+    {"delegreturn",         JsonAnalyzer::NfsV40Stat::delegreturnOpsAmount},
+    {"getattr",             JsonAnalyzer::NfsV40Stat::getattrOpsAmount},
+    {"getfh",               JsonAnalyzer::NfsV40Stat::getfhOpsAmount},
+    {"link",                JsonAnalyzer::NfsV40Stat::linkOpsAmount},
+    {"lock",                JsonAnalyzer::NfsV40Stat::lockOpsAmount},
+    {"lockt",               JsonAnalyzer::NfsV40Stat::locktOpsAmount},
+    {"locku",               JsonAnalyzer::NfsV40Stat::lockuOpsAmount},
+    {"lookup",              JsonAnalyzer::NfsV40Stat::lookupOpsAmount},
+    {"lookupp",             JsonAnalyzer::NfsV40Stat::lookuppOpsAmount},
+    {"nverify",             JsonAnalyzer::NfsV40Stat::nverifyOpsAmount},
+    {"open",                JsonAnalyzer::NfsV40Stat::openOpsAmount},
+    {"openattr",            JsonAnalyzer::NfsV40Stat::openattrOpsAmount},
+    {"open_confirm",        JsonAnalyzer::NfsV40Stat::open_confirmOpsAmount},
+    {"open_downgrade",      JsonAnalyzer::NfsV40Stat::open_downgradeOpsAmount},
+    {"putfh",               JsonAnalyzer::NfsV40Stat::putfhOpsAmount},
+    {"putpubfh",            JsonAnalyzer::NfsV40Stat::putpubfhOpsAmount},
+    {"putrootfh",           JsonAnalyzer::NfsV40Stat::putrootfhOpsAmount},
+    {"read",                JsonAnalyzer::NfsV40Stat::readOpsAmount},
+    {"readdir",             JsonAnalyzer::NfsV40Stat::readdirOpsAmount},
+    {"readlink",            JsonAnalyzer::NfsV40Stat::readlinkOpsAmount},
+    {"remove",              JsonAnalyzer::NfsV40Stat::removeOpsAmount},
+    {"rename",              JsonAnalyzer::NfsV40Stat::renameOpsAmount},
+    {"renew",               JsonAnalyzer::NfsV40Stat::renewOpsAmount},
+    {"restorefh",           JsonAnalyzer::NfsV40Stat::restorefhOpsAmount},
+    {"savefh",              JsonAnalyzer::NfsV40Stat::savefhOpsAmount},
+    {"secinfo",             JsonAnalyzer::NfsV40Stat::secinfoOpsAmount},
+    {"setattr",             JsonAnalyzer::NfsV40Stat::setattrOpsAmount},
+    {"setclientid",         JsonAnalyzer::NfsV40Stat::setclientidOpsAmount},
+    {"setclientid_confirm", JsonAnalyzer::NfsV40Stat::setclientid_confirmOpsAmount},
+    {"verify",              JsonAnalyzer::NfsV40Stat::verifyOpsAmount},
+    {"write",               JsonAnalyzer::NfsV40Stat::writeOpsAmount},
+    {"release_lockowner",   JsonAnalyzer::NfsV40Stat::release_lockownerOpsAmount},
+    {"get_dir_delegation",  JsonAnalyzer::NfsV40Stat::get_dir_delegationOpsAmount},
+    {"illegal",             JsonAnalyzer::NfsV40Stat::illegalOpsAmount}
+};
+
+const CounterDescriptor<JsonAnalyzer::NfsV41Stat> NfsV41Procedures[] =
+{
+    {"null",     JsonAnalyzer::NfsV41Stat::nullProcsAmount},
+    {"compound", JsonAnalyzer::NfsV41Stat::compoundProcsAmount}
+};
+
+const CounterDescriptor<JsonAnalyzer::NfsV41Stat> NfsV41Operations[] =
+{
+    {"access",               JsonAnalyzer::NfsV41Stat::accessOpsAmount},
+    {"close",                JsonAnalyzer::NfsV41Stat::closeOpsAmount},
+    {"commit",               JsonAnalyzer::NfsV41Stat::commitOpsAmount},
+    {"create",               JsonAnalyzer::NfsV41Stat::createOpsAmount},
+    {"delegpurge",           JsonAnalyzer::NfsV41Stat::delegpurgeOpsAmount},
+    {"delegreturn",          JsonAnalyzer::NfsV41Stat::delegreturnOpsAmount},
+    {"getattr",              JsonAnalyzer::NfsV41Stat::getattrOpsAmount},
+    {"getfh",                JsonAnalyzer::NfsV41Stat::getfhOpsAmount},
+    {"link",                 JsonAnalyzer::NfsV41Stat::linkOpsAmount},
+    {"lock",                 JsonAnalyzer::NfsV41Stat::lockOpsAmount},
+    {"lockt",                JsonAnalyzer::NfsV41Stat::locktOpsAmount},
+    {"locku",                JsonAnalyzer::NfsV41Stat::lockuOpsAmount},
+    {"lookup",               JsonAnalyzer::NfsV41Stat::lookupOpsAmount},
+    {"lookupp",              JsonAnalyzer::NfsV41Stat::lookuppOpsAmount},
+    {"nverify",              JsonAnalyzer::NfsV41Stat::nverifyOpsAmount},
+    {"open",                 JsonAnalyzer::NfsV41Stat::openOpsAmount},
+    {"openattr",             JsonAnalyzer::NfsV41Stat::openattrOpsAmount},
+    {"open_confirm",         JsonAnalyzer::NfsV41Stat::open_confirmOpsAmount},
+    {"open_downgrade",       JsonAnalyzer::NfsV41Stat::open_downgradeOpsAmount},
+    {"putfh",                JsonAnalyzer::NfsV41Stat::putfhOpsAmount},
+    {"putpubfh",             JsonAnalyzer::NfsV41Stat::putpubfhOpsAmount},
+    {"putrootfh",            JsonAnalyzer::NfsV41Stat::putrootfhOpsAmount},
+    {"read",                 JsonAnalyzer::NfsV41Stat::readOpsAmount},
+    {"readdir",              JsonAnalyzer::NfsV41Stat::readdirOpsAmount},
+    {"readlink",             JsonAnalyzer::NfsV41Stat::readlinkOpsAmount},
+    {"remove",               JsonAnalyzer::NfsV41Stat::removeOpsAmount},
+    {"rename",               JsonAnalyzer::NfsV41Stat::renameOpsAmount},
+    {"renew",                JsonAnalyzer::NfsV41Stat::renewOpsAmount},
+    {"restorefh",            JsonAnalyzer::NfsV41Stat::restorefhOpsAmount},
+    {"savefh",               JsonAnalyzer::NfsV41Stat::savefhOpsAmount},
+    {"secinfo",              JsonAnalyzer::NfsV41Stat::secinfoOpsAmount},
+    {"setattr",              JsonAnalyzer::NfsV41Stat::setattrOpsAmount},
+    {"setclientid",          JsonAnalyzer::NfsV41Stat::setclientidOpsAmount},
+    {"setclientid_confirm",  JsonAnalyzer::NfsV41Stat::setclientid_confirmOpsAmount},
+    {"verify",               JsonAnalyzer::NfsV41Stat::verifyOpsAmount},
+    {"write",                JsonAnalyzer::NfsV41Stat::writeOpsAmount},
+    {"release_lockowner",    JsonAnalyzer::NfsV41Stat::release_lockownerOpsAmount},
+    {"backchannel_ctl",      JsonAnalyzer::NfsV41Stat::backchannel_ctlOpsAmount},
+    {"bind_conn_to_session", JsonAnalyzer::NfsV41Stat::bind_conn_to_sessionOpsAmount},
+    {"exchange_id",          JsonAnalyzer::NfsV41Stat::exchange_idOpsAmount},
+    {"create_session",       JsonAnalyzer::NfsV41Stat::create_sessionOpsAmount},
+    {"destroy_session",      JsonAnalyzer::NfsV41Stat::destroy_sessionOpsAmount},
+    {"free_stateid",         JsonAnalyzer::NfsV41Stat::free_stateidOpsAmount},
+    {"get_dir_delegation",   JsonAnalyzer::NfsV41Stat::get_dir_delegationOpsAmount},
+    {"getdeviceinfo",        JsonAnalyzer::NfsV41Stat::getdeviceinfoOpsAmount},
+    {"getdevicelist",        JsonAnalyzer::NfsV41Stat::getdevicelistOpsAmount},
+    {"layoutcommit",         JsonAnalyzer::NfsV41Stat::layoutcommitOpsAmount},
+    {"layoutget",            JsonAnalyzer::NfsV41Stat::layoutgetOpsAmount},
+    {"layoutreturn",         JsonAnalyzer::NfsV41Stat::layoutreturnOpsAmount},
+    {"secinfo_no_name",      JsonAnalyzer::NfsV41Stat::secinfo_no_nameOpsAmount},
+    {"sequence",             JsonAnalyzer::NfsV41Stat::sequenceOpsAmount},
+    {"set_ssv",              JsonAnalyzer::NfsV41Stat::set_ssvOpsAmount},
+    {"test_stateid",         JsonAnalyzer::NfsV41Stat::test_stateidOpsAmount},
+    {"want_delegation",      JsonAnalyzer::NfsV41Stat::want_delegationOpsAmount},
+    {"destroy_clientid",     JsonAnalyzer::NfsV41Stat::destroy_clientidOpsAmount},
+    {"reclaim_complete",     JsonAnalyzer::NfsV41Stat::reclaim_completeOpsAmount},
+    {"illegal",              JsonAnalyzer::NfsV41Stat::illegalOpsAmount}
+};
+
+template <typename Stat, std::size_t Size>
+void loadCounters(const Stat& stat, const CounterDescriptor<Stat> (&descriptors)[Size], uint64_t (&values)[Size])
+{
+    for (std::size_t i = 0U; i < Size; ++i)
+    {
+        values[i] = stat.load(descriptors[i].counter);
+    }
+}
+
+//! Values of counters of each NFS version taken at the same moment
+struct CountersSnapshot
+{
+    explicit CountersSnapshot(const JsonAnalyzer& analyzer)
+    {
+        const JsonAnalyzer::NfsV3Stat& nfsV3Stat = analyzer.getNfsV3Stat();
+        nfsV3Stat.read([&]()
+        {
+            loadCounters(nfsV3Stat, NfsV3Procedures, nfsV3Procedures);
+        });
+        const JsonAnalyzer::NfsV40Stat& nfsV40Stat = analyzer.getNfsV40Stat();
+        nfsV40Stat.read([&]()
+        {
+            loadCounters(nfsV40Stat, NfsV40Procedures, nfsV40Procedures);
+            loadCounters(nfsV40Stat, NfsV40Operations, nfsV40Operations);
+        });
+        const JsonAnalyzer::NfsV41Stat& nfsV41Stat = analyzer.getNfsV41Stat();
+        nfsV41Stat.read([&]()
+        {
+            loadCounters(nfsV41Stat, NfsV41Procedures, nfsV41Procedures);
+            loadCounters(nfsV41Stat, NfsV41Operations, nfsV41Operations);
+        });
+    }
+
+    uint64_t nfsV3Procedures[std::extent<decltype(NfsV3Procedures)>::value];
+    uint64_t nfsV40Procedures[std::extent<decltype(NfsV40Procedures)>::value];
+    uint64_t nfsV40Operations[std::extent<decltype(NfsV40Operations)>::value];
+    uint64_t nfsV41Procedures[std::extent<decltype(NfsV41Procedures)>::value];
+    uint64_t nfsV41Operations[std::extent<decltype(NfsV41Operations)>::value];
+};
+
+template <typename Stat, std::size_t Size>
+void writeCounters(OpenMetricsWriter& writer, const char* family, const char* version, const char* label,
+                   const CounterDescriptor<Stat> (&descriptors)[Size], const uint64_t (&values)[Size])
+{
+    std::string labels;
+    for (std::size_t i = 0U; i < Size; ++i)
+    {
+        labels = "version=\"";
+        labels += version;
+        labels += "\",";
+        labels += label;
+        labels += "=\"";
+        labels += descriptors[i].name;
+        labels += '"';
+        writer.sample(family, "_total", labels, values[i]);
+    }
+}
+
+void writeLatency(OpenMetricsWriter& writer, const char* version, const JsonAnalyzer::LatencyHistogram& histogram)
+{
+    constexpr std::size_t BucketsAmount = JsonAnalyzer::LatencyHistogram::BoundsAmount + 1U;
+    uint64_t buckets[BucketsAmount];
+    uint64_t sumUs = 0U;
+    histogram.lock.read([&]()
+    {
+        for (std::size_t i = 0U; i < BucketsAmount; ++i)
+        {
+            buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+        }
+        sumUs = histogram.sumUs.load(std::memory_order_relaxed);
+    });
+    writer.histogram("nfstrace_nfs_latency_seconds", std::string{"version=\""} + version + '"',
+                     JsonAnalyzer::LatencyHistogram::Bounds, buckets, JsonAnalyzer::LatencyHistogram::BoundsAmount,
+                     sumUs);
+}
+
+void writeProbes(OpenMetricsWriter& writer, const ProbeStat& probes)
+{
+    static const char* const Quantiles[] = {"0.5", "0.9", "0.99"};
+    static const double QuantileValues[] = {0.5, 0.9, 0.99};
+
+    ProbeStat::Summary summary;
+    std::string labels;
+    for (uint32_t i = 0U; i < probes.size(); ++i)
+    {
+        probes.summary(i, summary);
+        const std::string probe = std::string{"probe=\""} + summary.name + '"';
+        for (std::size_t q = 0U; q < std::extent<decltype(Quantiles)>::value; ++q)
+        {
+            labels = probe + ",quantile=\"" + Quantiles[q] + '"';
+            writer.sample("nfstrace_probe_nanoseconds", "", labels, static_cast<uint64_t>(summary.quantile_ns(QuantileValues[q])));
+        }
+        writer.sample("nfstrace_probe_nanoseconds", "_sum", probe, static_cast<uint64_t>(summary.total_ns));
+        writer.sample("nfstrace_probe_nanoseconds", "_count", probe, summary.count);
+    }
+}
+
+void writePipelineMetrics(OpenMetricsWriter& writer, const MetricsStat::Snapshot& metrics)
+{
+    static const char* const Quantiles[] = {"0.5", "0.99"};
+    static const double QuantileValues[] = {0.5, 0.99};
+
+    const std::string noLabels;
+    std::string family;
+    for (uint32_t i = 0U; i < metrics.size; ++i)
+    {
+        const MetricsStat::Metric& metric = metrics.metrics[i];
+        family = std::string{"nfstrace_pipeline_"} + metric.name;
+        // Gauges are sums of increments and decrements of threads which may be seen partially
+        const uint64_t value = metric.value > 0 ? static_cast<uint64_t>(metric.value) : 0U;
+        switch (metric.type)
+        {
+        case MetricsStat::Type::Counter:
+            writer.family(family.c_str(), "counter", metric.help);
+            writer.sample(family.c_str(), "_total", noLabels, value);
+            break;
+        case MetricsStat::Type::Gauge:
+            writer.family(family.c_str(), "gauge", metric.help);
+            writer.sample(family.c_str(), "", noLabels, value);
+            break;
+        case MetricsStat::Type::Histogram:
+            writer.family(family.c_str(), "summary", metric.help);
+            for (std::size_t q = 0U; q < std::extent<decltype(Quantiles)>::value; ++q)
+            {
+                writer.sample(family.c_str(), "", std::string{"quantile=\""} + Quantiles[q] + '"', metric.quantile(QuantileValues[q]));
+            }
+            writer.sample(family.c_str(), "_sum", noLabels, value);
+            writer.sample(family.c_str(), "_count", noLabels, metric.count);
+            break;
+        }
+    }
+}
+
+struct json_object* composePipelineMetrics(const MetricsStat::Snapshot& metrics)
+{
+    struct json_object* object = json_object_new_object();
+    for (uint32_t i = 0U; i < metrics.size; ++i)
+    {
+        const MetricsStat::Metric& metric = metrics.metrics[i];
+        if (metric.type == MetricsStat::Type::Histogram)
+        {
+            struct json_object* histogram = json_object_new_object();
+            json_object_object_add(histogram, "count", json_object_new_int64(metric.count));
+            json_object_object_add(histogram, "mean", json_object_new_double(metric.mean()));
+            json_object_object_add(histogram, "p50", json_object_new_int64(metric.quantile(0.5)));
+            json_object_object_add(histogram, "p99", json_object_new_int64(metric.quantile(0.99)));
+            json_object_object_add(object, metric.name, histogram);
+        }
+        else
+        {
+            json_object_object_add(object, metric.name, json_object_new_int64(metric.value));
+        }
+    }
+    return object;
+}
+
+template <typename Stat, std::size_t Size>
+void composeCounters(struct json_object* object, const CounterDescriptor<Stat> (&descriptors)[Size], const uint64_t (&values)[Size])
+{
+    for (std::size_t i = 0U; i < Size; ++i)
+    {
+        json_object_object_add(object, descriptors[i].name, json_object_new_int64(values[i]));
+    }
+}
+
+struct json_object* composeHosts(const HostsStat& stat, std::size_t amount, HostsStat::SortKey key)
+{
+    struct json_object* hosts = json_object_new_array();
+    for (const auto& host : stat.top(amount, key))
+    {
+        struct json_object* item = json_object_new_object();
+        json_object_object_add(item, "address", json_object_new_string(host.address.c_str()));
+        json_object_object_add(item, "ops", json_object_new_int64(host.ops));
+        json_object_object_add(item, "reads", json_object_new_int64(host.reads));
+        json_object_object_add(item, "writes", json_object_new_int64(host.writes));
+        json_object_object_add(item, "bytes", json_object_new_int64(host.bytes));
+        json_object_array_add(hosts, item);
+    }
+    return hosts;
+}
+
+//! Parses "top=<amount>&by=<key>" query, unknown parameters are ignored
+bool parseQuery(const std::string& query, std::size_t& amount, HostsStat::SortKey& key)
+{
+    std::size_t begin = 0U;
+    while (begin < query.length())
+    {
+        std::size_t end = query.find('&', begin);
+        if (end == std::string::npos)
+        {
+            end = query.length();
+        }
+        std::size_t delimiter = query.find('=', begin);
+        if (delimiter < end)
+        {
+            std::string name{query, begin, delimiter - begin};
+            std::string value{query, delimiter + 1U, end - delimiter - 1U};
+            if (name == "top")
+            {
+                if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+                {
+                    return false;
+                }
+                try
+                {
+                    amount = std::stoul(value);
+                }
+                catch (std::out_of_range&)
+                {
+                    return false;
+                }
+            }
+            else if (name == "by" && !HostsStat::parseSortKey(value, key))
+            {
+                return false;
+            }
+        }
+        begin = end + 1U;
+    }
+    return true;
+}
+
+} // unnamed namespace
+//------------------------------------------------------------------------------
 
 JsonTcpService::JsonTcpService(JsonAnalyzer& analyzer, std::size_t workersAmount, int port, const std::string& host,
                                std::size_t maxServingDurationMs, int backlog) :
@@ -44,164 +427,219 @@ AbstractTcpService::AbstractTask* JsonTcpService::createTask(int socket)
 
 JsonTcpService::Task::Task(JsonTcpService& service, int socket) :
     AbstractTask{socket},
-    _service(service)
+    _service(service),
+    _servingStarted{std::chrono::system_clock::now()}
 {}
 
 void JsonTcpService::Task::execute()
 {
-    std::chrono::system_clock::time_point servingStarted = std::chrono::system_clock::now();
+    std::string request;
+    if (!readRequest(request))
+    {
+        return;
+    }
+    std::size_t topAmount = DefaultTopAmount;
+    HostsStat::SortKey sortKey = HostsStat::SortKey::Ops;
+    if (request.empty())
+    {
+        // Client has sent nothing - serving a raw JSON as previous versions did
+        std::string json;
+        composeJson(json, topAmount, sortKey);
+        sendData(json);
+        return;
+    }
+
+    // Parsing request line: "<method> <request-target> HTTP/<version>"
+    std::size_t methodEnd = request.find(' ');
+    std::size_t targetEnd = methodEnd == std::string::npos ? std::string::npos : request.find(' ', methodEnd + 1U);
+    if (targetEnd == std::string::npos || request.compare(targetEnd + 1U, 5U, "HTTP/") != 0)
+    {
+        sendResponse("400 Bad Request", "text/plain", "Bad Request\n");
+        return;
+    }
+    if (request.compare(0U, methodEnd, "GET") != 0)
+    {
+        sendResponse("405 Method Not Allowed", "text/plain", "Method Not Allowed\n");
+        return;
+    }
+    std::string target{request, methodEnd + 1U, targetEnd - methodEnd - 1U};
+    std::size_t queryBegin = target.find('?');
+    std::string path{target, 0U, queryBegin};
+    if (queryBegin != std::string::npos && !parseQuery(target.substr(queryBegin + 1U), topAmount, sortKey))
+    {
+        sendResponse("400 Bad Request", "text/plain", "Bad Request\n");
+        return;
+    }
+    if (path == "/metrics")
+    {
+        std::string metrics;
+        composeMetrics(metrics);
+        sendResponse("200 OK", OpenMetricsWriter::ContentType, metrics);
+    }
+    else if (path == "/")
+    {
+        std::string json;
+        composeJson(json, topAmount, sortKey);
+        sendResponse("200 OK", "application/json", json);
+    }
+    else
+    {
+        sendResponse("404 Not Found", "text/plain", "Not Found\n");
+    }
+}
+
+bool JsonTcpService::Task::readRequest(std::string& request)
+{
+    char buffer[ReadBufferSize];
+    bool awaitingFirstByte = true;
+    while (request.find("\r\n\r\n") == std::string::npos)
+    {
+        if (!checkServing())
+        {
+            return false;
+        }
+        if (request.length() > MaxRequestSize)
+        {
+            LOG("WARNING: HTTP request is too large - terminating task execution");
+            return false;
+        }
+        struct timespec readDuration;
+        AbstractTcpService::fillDuration(readDuration);
+        fd_set readDescriptorsSet;
+        FD_ZERO(&readDescriptorsSet);
+        FD_SET(socket(), &readDescriptorsSet);
+        int descriptorsCount = pselect(socket() + 1, &readDescriptorsSet, NULL, NULL, &readDuration, NULL);
+        if (descriptorsCount < 0)
+        {
+            throw std::system_error{errno, std::system_category(), "Error awaiting for receiving data availability on socket"};
+        }
+        else if (descriptorsCount == 0)
+        {
+            if (awaitingFirstByte)
+            {
+                // Timeout expired and nothing has been received
+                return true;
+            }
+            continue;
+        }
+        ssize_t bytesReceived = recv(socket(), buffer, sizeof(buffer), 0);
+        if (bytesReceived < 0)
+        {
+            std::system_error e{errno, std::system_category(), "Receiving data from client error"};
+            LOG("WARNING: %s", e.what());
+            return false;
+        }
+        else if (bytesReceived == 0)
+        {
+            // Client has shut down its side of connection - serving what has been received
+            return true;
+        }
+        request.append(buffer, bytesReceived);
+        awaitingFirstByte = false;
+    }
+    return true;
+}
+
+void JsonTcpService::Task::composeJson(std::string& json, std::size_t topAmount, HostsStat::SortKey sortKey)
+{
     // Composing JSON with statistics
+    const CountersSnapshot snapshot{_service._analyzer};
     struct json_object* root = json_object_new_object();
     struct json_object* nfsV3Stat = json_object_new_object();
-    // NFS3 procedures:
-    json_object_object_add(nfsV3Stat, "null", json_object_new_int64(_service._analyzer.getNfsV3Stat().nullProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "getattr", json_object_new_int64(_service._analyzer.getNfsV3Stat().getattrProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "setattr", json_object_new_int64(_service._analyzer.getNfsV3Stat().setattrProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "lookup", json_object_new_int64(_service._analyzer.getNfsV3Stat().lookupProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "access", json_object_new_int64(_service._analyzer.getNfsV3Stat().accessProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "readlink", json_object_new_int64(_service._analyzer.getNfsV3Stat().readlinkProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "read", json_object_new_int64(_service._analyzer.getNfsV3Stat().readProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "write", json_object_new_int64(_service._analyzer.getNfsV3Stat().writeProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "create", json_object_new_int64(_service._analyzer.getNfsV3Stat().createProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "mkdir", json_object_new_int64(_service._analyzer.getNfsV3Stat().mkdirProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "symlink", json_object_new_int64(_service._analyzer.getNfsV3Stat().symlinkProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "mkdnod", json_object_new_int64(_service._analyzer.getNfsV3Stat().mknodProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "remove", json_object_new_int64(_service._analyzer.getNfsV3Stat().removeProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "rmdir", json_object_new_int64(_service._analyzer.getNfsV3Stat().rmdirProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "rename", json_object_new_int64(_service._analyzer.getNfsV3Stat().renameProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "link", json_object_new_int64(_service._analyzer.getNfsV3Stat().linkProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "readdir", json_object_new_int64(_service._analyzer.getNfsV3Stat().readdirProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "readdirplus", json_object_new_int64(_service._analyzer.getNfsV3Stat().readdirplusProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "fsstat", json_object_new_int64(_service._analyzer.getNfsV3Stat().fsstatProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "fsinfo", json_object_new_int64(_service._analyzer.getNfsV3Stat().fsinfoProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "pathconf", json_object_new_int64(_service._analyzer.getNfsV3Stat().pathconfProcsAmount.load()));
-    json_object_object_add(nfsV3Stat, "commit", json_object_new_int64(_service._analyzer.getNfsV3Stat().commitProcsAmount.load()));
+    composeCounters(nfsV3Stat, NfsV3Procedures, snapshot.nfsV3Procedures);
     json_object_object_add(root, "nfs_v3", nfsV3Stat);
     struct json_object* nfsV40Stat = json_object_new_object();
-    // NFS4.0 procedures:
-    json_object_object_add(nfsV40Stat, "null", json_object_new_int64(_service._analyzer.getNfsV40Stat().nullProcsAmount.load()));
-    json_object_object_add(nfsV40Stat, "compound", json_object_new_int64(_service._analyzer.getNfsV40Stat().compoundProcsAmount.load()));
-    // NFS4.0 operations:
-    json_object_object_add(nfsV40Stat, "access", json_object_new_int64(_service._analyzer.getNfsV40Stat().accessOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "close", json_object_new_int64(_service._analyzer.getNfsV40Stat().closeOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "commit", json_object_new_int64(_service._analyzer.getNfsV40Stat().commitOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "create", json_object_new_int64(_service._analyzer.getNfsV40Stat().createOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "delegpurge", json_object_new_int64(_service._analyzer.getNfsV40Stat().delegpurgeOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "delegreturn", json_object_new_int64(_service._analyzer.getNfsV40Stat().delegreturnOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "getattr", json_object_new_int64(_service._analyzer.getNfsV40Stat().getattrOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "getfh", json_object_new_int64(_service._analyzer.getNfsV40Stat().getfhOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "link", json_object_new_int64(_service._analyzer.getNfsV40Stat().linkOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "lock", json_object_new_int64(_service._analyzer.getNfsV40Stat().lockOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "lockt", json_object_new_int64(_service._analyzer.getNfsV40Stat().locktOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "locku", json_object_new_int64(_service._analyzer.getNfsV40Stat().lockuOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "lookup", json_object_new_int64(_service._analyzer.getNfsV40Stat().lookupOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "lookupp", json_object_new_int64(_service._analyzer.getNfsV40Stat().lookuppOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "nverify", json_object_new_int64(_service._analyzer.getNfsV40Stat().nverifyOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "open", json_object_new_int64(_service._analyzer.getNfsV40Stat().openOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "openattr", json_object_new_int64(_service._analyzer.getNfsV40Stat().openattrOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "open_confirm", json_object_new_int64(_service._analyzer.getNfsV40Stat().open_confirmOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "open_downgrade", json_object_new_int64(_service._analyzer.getNfsV40Stat().open_downgradeOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "putfh", json_object_new_int64(_service._analyzer.getNfsV40Stat().putfhOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "putpubfh", json_object_new_int64(_service._analyzer.getNfsV40Stat().putpubfhOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "putrootfh", json_object_new_int64(_service._analyzer.getNfsV40Stat().putrootfhOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "read", json_object_new_int64(_service._analyzer.getNfsV40Stat().readOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "readdir", json_object_new_int64(_service._analyzer.getNfsV40Stat().readdirOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "readlink", json_object_new_int64(_service._analyzer.getNfsV40Stat().readlinkOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "remove", json_object_new_int64(_service._analyzer.getNfsV40Stat().removeOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "rename", json_object_new_int64(_service._analyzer.getNfsV40Stat().renameOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "renew", json_object_new_int64(_service._analyzer.getNfsV40Stat().renewOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "restorefh", json_object_new_int64(_service._analyzer.getNfsV40Stat().restorefhOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "savefh", json_object_new_int64(_service._analyzer.getNfsV40Stat().savefhOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "secinfo", json_object_new_int64(_service._analyzer.getNfsV40Stat().secinfoOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "setattr", json_object_new_int64(_service._analyzer.getNfsV40Stat().setattrOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "setclientid", json_object_new_int64(_service._analyzer.getNfsV40Stat().setclientidOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "setclientid_confirm", json_object_new_int64(_service._analyzer.getNfsV40Stat().setclientid_confirmOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "verify", json_object_new_int64(_service._analyzer.getNfsV40Stat().verifyOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "write", json_object_new_int64(_service._analyzer.getNfsV40Stat().writeOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "release_lockowner", json_object_new_int64(_service._analyzer.getNfsV40Stat().release_lockownerOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "get_dir_delegation", json_object_new_int64(_service._analyzer.getNfsV40Stat().get_dir_delegationOpsAmount.load()));
-    json_object_object_add(nfsV40Stat, "illegal", json_object_new_int64(_service._analyzer.getNfsV40Stat().illegalOpsAmount.load()));
+    composeCounters(nfsV40Stat, NfsV40Procedures, snapshot.nfsV40Procedures);
+    composeCounters(nfsV40Stat, NfsV40Operations, snapshot.nfsV40Operations);
     json_object_object_add(root, "nfs_v40", nfsV40Stat);
     struct json_object* nfsV41Stat = json_object_new_object();
-    // NFS4.1 procedures:
-    json_object_object_add(nfsV41Stat, "null", json_object_new_int64(_service._analyzer.getNfsV41Stat().nullProcsAmount.load()));
-    json_object_object_add(nfsV41Stat, "compound", json_object_new_int64(_service._analyzer.getNfsV41Stat().compoundProcsAmount.load()));
-    // NFS4.1 operations:
-    json_object_object_add(nfsV41Stat, "access", json_object_new_int64(_service._analyzer.getNfsV41Stat().accessOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "close", json_object_new_int64(_service._analyzer.getNfsV41Stat().closeOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "commit", json_object_new_int64(_service._analyzer.getNfsV41Stat().commitOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "create", json_object_new_int64(_service._analyzer.getNfsV41Stat().createOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "delegpurge", json_object_new_int64(_service._analyzer.getNfsV41Stat().delegpurgeOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "delegreturn", json_object_new_int64(_service._analyzer.getNfsV41Stat().delegreturnOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "getattr", json_object_new_int64(_service._analyzer.getNfsV41Stat().getattrOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "getfh", json_object_new_int64(_service._analyzer.getNfsV41Stat().getfhOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "link", json_object_new_int64(_service._analyzer.getNfsV41Stat().linkOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "lock", json_object_new_int64(_service._analyzer.getNfsV41Stat().lockOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "lockt", json_object_new_int64(_service._analyzer.getNfsV41Stat().locktOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "locku", json_object_new_int64(_service._analyzer.getNfsV41Stat().lockuOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "lookup", json_object_new_int64(_service._analyzer.getNfsV41Stat().lookupOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "lookupp", json_object_new_int64(_service._analyzer.getNfsV41Stat().lookuppOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "nverify", json_object_new_int64(_service._analyzer.getNfsV41Stat().nverifyOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "open", json_object_new_int64(_service._analyzer.getNfsV41Stat().openOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "openattr", json_object_new_int64(_service._analyzer.getNfsV41Stat().openattrOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "open_confirm", json_object_new_int64(_service._analyzer.getNfsV41Stat().open_confirmOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "open_downgrade", json_object_new_int64(_service._analyzer.getNfsV41Stat().open_downgradeOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "putfh", json_object_new_int64(_service._analyzer.getNfsV41Stat().putfhOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "putpubfh", json_object_new_int64(_service._analyzer.getNfsV41Stat().putpubfhOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "putrootfh", json_object_new_int64(_service._analyzer.getNfsV41Stat().putrootfhOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "read", json_object_new_int64(_service._analyzer.getNfsV41Stat().readOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "readdir", json_object_new_int64(_service._analyzer.getNfsV41Stat().readdirOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "readlink", json_object_new_int64(_service._analyzer.getNfsV41Stat().readlinkOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "remove", json_object_new_int64(_service._analyzer.getNfsV41Stat().removeOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "rename", json_object_new_int64(_service._analyzer.getNfsV41Stat().renameOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "renew", json_object_new_int64(_service._analyzer.getNfsV41Stat().renewOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "restorefh", json_object_new_int64(_service._analyzer.getNfsV41Stat().restorefhOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "savefh", json_object_new_int64(_service._analyzer.getNfsV41Stat().savefhOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "secinfo", json_object_new_int64(_service._analyzer.getNfsV41Stat().secinfoOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "setattr", json_object_new_int64(_service._analyzer.getNfsV41Stat().setattrOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "setclientid", json_object_new_int64(_service._analyzer.getNfsV41Stat().setclientidOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "setclientid_confirm", json_object_new_int64(_service._analyzer.getNfsV41Stat().setclientid_confirmOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "verify", json_object_new_int64(_service._analyzer.getNfsV41Stat().verifyOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "write", json_object_new_int64(_service._analyzer.getNfsV41Stat().writeOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "release_lockowner", json_object_new_int64(_service._analyzer.getNfsV41Stat().release_lockownerOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "backchannel_ctl", json_object_new_int64(_service._analyzer.getNfsV41Stat().backchannel_ctlOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "bind_conn_to_session", json_object_new_int64(_service._analyzer.getNfsV41Stat().bind_conn_to_sessionOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "exchange_id", json_object_new_int64(_service._analyzer.getNfsV41Stat().exchange_idOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "create_session", json_object_new_int64(_service._analyzer.getNfsV41Stat().create_sessionOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "destroy_session", json_object_new_int64(_service._analyzer.getNfsV41Stat().destroy_sessionOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "free_stateid", json_object_new_int64(_service._analyzer.getNfsV41Stat().free_stateidOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "get_dir_delegation", json_object_new_int64(_service._analyzer.getNfsV41Stat().get_dir_delegationOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "getdeviceinfo", json_object_new_int64(_service._analyzer.getNfsV41Stat().getdeviceinfoOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "getdevicelist", json_object_new_int64(_service._analyzer.getNfsV41Stat().getdevicelistOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "layoutcommit", json_object_new_int64(_service._analyzer.getNfsV41Stat().layoutcommitOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "layoutget", json_object_new_int64(_service._analyzer.getNfsV41Stat().layoutgetOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "layoutreturn", json_object_new_int64(_service._analyzer.getNfsV41Stat().layoutreturnOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "secinfo_no_name", json_object_new_int64(_service._analyzer.getNfsV41Stat().secinfo_no_nameOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "sequence", json_object_new_int64(_service._analyzer.getNfsV41Stat().sequenceOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "set_ssv", json_object_new_int64(_service._analyzer.getNfsV41Stat().set_ssvOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "test_stateid", json_object_new_int64(_service._analyzer.getNfsV41Stat().test_stateidOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "want_delegation", json_object_new_int64(_service._analyzer.getNfsV41Stat().want_delegationOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "destroy_clientid", json_object_new_int64(_service._analyzer.getNfsV41Stat().destroy_clientidOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "reclaim_complete", json_object_new_int64(_service._analyzer.getNfsV41Stat().reclaim_completeOpsAmount.load()));
-    json_object_object_add(nfsV41Stat, "illegal", json_object_new_int64(_service._analyzer.getNfsV41Stat().illegalOpsAmount.load()));
+    composeCounters(nfsV41Stat, NfsV41Procedures, snapshot.nfsV41Procedures);
+    composeCounters(nfsV41Stat, NfsV41Operations, snapshot.nfsV41Operations);
     json_object_object_add(root, "nfs_v41", nfsV41Stat);
-    std::string json(json_object_to_json_string_ext(root, JSON_C_TO_STRING_PRETTY));
+    // Most active hosts:
+    json_object_object_add(root, "clients", composeHosts(_service._analyzer.getClientsStat(), topAmount, sortKey));
+    json_object_object_add(root, "servers", composeHosts(_service._analyzer.getServersStat(), topAmount, sortKey));
+    // Health of filtration, queuing and analysis
+    MetricsStat::Snapshot metrics;
+    if (_service._analyzer.getPipelineMetrics(metrics))
+    {
+        json_object_object_add(root, "pipeline", composePipelineMetrics(metrics));
+    }
+    json = json_object_to_json_string_ext(root, JSON_C_TO_STRING_PRETTY);
     json_object_put(root);
+}
 
-    // Sending JSON to the client
-    std::size_t totalBytesSent = 0U;
-    while (totalBytesSent < json.length())
+void JsonTcpService::Task::composeMetrics(std::string& metrics)
+{
+    const JsonAnalyzer& analyzer = _service._analyzer;
+    const CountersSnapshot snapshot{analyzer};
+    OpenMetricsWriter writer{metrics};
+
+    writer.family("nfstrace_nfs_procedures", "counter", "NFS procedures observed.");
+    writeCounters(writer, "nfstrace_nfs_procedures", "3", "procedure", NfsV3Procedures, snapshot.nfsV3Procedures);
+    writeCounters(writer, "nfstrace_nfs_procedures", "4.0", "procedure", NfsV40Procedures, snapshot.nfsV40Procedures);
+    writeCounters(writer, "nfstrace_nfs_procedures", "4.1", "procedure", NfsV41Procedures, snapshot.nfsV41Procedures);
+
+    writer.family("nfstrace_nfs_operations", "counter", "NFSv4.x operations of COMPOUND procedures observed.");
+    writeCounters(writer, "nfstrace_nfs_operations", "4.0", "operation", NfsV40Operations, snapshot.nfsV40Operations);
+    writeCounters(writer, "nfstrace_nfs_operations", "4.1", "operation", NfsV41Operations, snapshot.nfsV41Operations);
+
+    writer.family("nfstrace_nfs_latency_seconds", "histogram", "Latency between NFS call and reply.");
+    writeLatency(writer, "3", analyzer.getNfsV3Latency());
+    writeLatency(writer, "4.0", analyzer.getNfsV40Latency());
+    writeLatency(writer, "4.1", analyzer.getNfsV41Latency());
+
+    MetricsStat::Snapshot pipelineMetrics;
+    if (analyzer.getPipelineMetrics(pipelineMetrics))
     {
-        if (!_service.isRunning())
+        writePipelineMetrics(writer, pipelineMetrics);
+        const ProbeStat* probes = pipelineMetrics.probes;
+        if (probes && probes->enabled.load(std::memory_order_relaxed))
         {
-            LOG("WARNING: Service shutdown detected - terminating task execution");
-            return;
+            writer.family("nfstrace_probe_nanoseconds", "summary", "Latency of pipeline stages and module dispatch measured by probes.");
+            writeProbes(writer, *probes);
         }
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - servingStarted).count() >
-                static_cast<std::chrono::milliseconds::rep>(_service._maxServingDurationMs))
+    }
+    writer.finish();
+}
+
+void JsonTcpService::Task::sendResponse(const char* status, const char* contentType, const std::string& body)
+{
+    std::string response{"HTTP/1.1 "};
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += contentType;
+    response += "\r\nContent-Length: ";
+    response += std::to_string(body.length());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+    sendData(response);
+}
+
+bool JsonTcpService::Task::checkServing() const
+{
+    if (!_service.isRunning())
+    {
+        LOG("WARNING: Service shutdown detected - terminating task execution");
+        return false;
+    }
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - _servingStarted).count() >
+            static_cast<std::chrono::milliseconds::rep>(_service._maxServingDurationMs))
+    {
+        // TODO: Use general logging
+        LOG("WARNING: A client is too slow - terminating task execution");
+        return false;
+    }
+    return true;
+}
+
+void JsonTcpService::Task::sendData(const std::string& data)
+{
+    std::size_t totalBytesSent = 0U;
+    while (totalBytesSent < data.length())
+    {
+        if (!checkServing())
         {
-            // TODO: Use general logging
-            LOG("WARNING: A client is too slow - terminating task execution");
             return;
         }
         struct timespec writeDuration;
@@ -219,7 +657,7 @@ void JsonTcpService::Task::execute()
             // Timeout expired
             continue;
         }
-        ssize_t bytesSent = send(socket(), json.data() + totalBytesSent, json.length() - totalBytesSent, MSG_NOSIGNAL);
+        ssize_t bytesSent = send(socket(), data.data() + totalBytesSent, data.length() - totalBytesSent, MSG_NOSIGNAL);
         if (bytesSent < 0)
         {
             std::system_error e{errno, std::system_category(), "Sending data to client error"};
@@ -22,8 +22,20 @@
 #ifndef JSON_TCP_SERVICE_H
 #define JSON_TCP_SERVICE_H
 //------------------------------------------------------------------------------
+#include <chrono>
+#include <string>
+
 #include "abstract_tcp_service.h"
+#include "hosts_stat.h"
 //------------------------------------------------------------------------------
+//! TCP-service which serves statistics of JSON analyzer
+/*!
+ * HTTP/1.1 GET requests are served: "/" returns JSON document and "/metrics"
+ * returns the same counters in OpenMetrics text format. Clients which send
+ * nothing just after connection receive raw JSON document. JSON document
+ * contains the most active clients and servers, their amount and sort key
+ * may be requested by "/?top=<amount>&by=<ops|reads|writes|bytes>".
+ */
 class JsonTcpService : public AbstractTcpService
 {
 public:
@@ -31,6 +43,9 @@ public:
     JsonTcpService(class JsonAnalyzer& analyzer, std::size_t workersAmount, int port, const std::string& host,
                    std::size_t maxServingDurationMs, int backlog);
 private:
+    static constexpr std::size_t ReadBufferSize = 1024U;
+    static constexpr std::size_t MaxRequestSize = 8192U;
+
     class Task : public AbstractTask
     {
     public:
@@ -39,7 +54,17 @@ private:
 
         void execute() override final;
     private:
+        //! Reads request header, leaves request empty if client sent nothing
+        bool readRequest(std::string& request);
+        void composeJson(std::string& json, std::size_t topAmount, HostsStat::SortKey sortKey);
+        void composeMetrics(std::string& metrics);
+        void sendResponse(const char* status, const char* contentType, const std::string& body);
+        void sendData(const std::string& data);
+        //! Returns FALSE if serving has to be terminated
+        bool checkServing() const;
+
         JsonTcpService& _service;
+        std::chrono::system_clock::time_point _servingStarted;
     };
 
     AbstractTask* createTask(int socket) override final;
@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: OpenMetrics text exposition format writer
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include "open_metrics_writer.h"
+//------------------------------------------------------------------------------
+
+OpenMetricsWriter::OpenMetricsWriter(std::string& output) :
+    _output(output)
+{}
+
+void OpenMetricsWriter::family(const char* name, const char* type, const char* help)
+{
+    _output += "# TYPE ";
+    _output += name;
+    _output += ' ';
+    _output += type;
+    _output += "\n# HELP ";
+    _output += name;
+    _output += ' ';
+    _output += help;
+    _output += '\n';
+}
+
+void OpenMetricsWriter::sample(const char* name, const char* suffix, const std::string& labels, uint64_t value)
+{
+    appendName(name, suffix, labels, nullptr);
+    appendUnsigned(_output, value);
+    _output += '\n';
+}
+
+void OpenMetricsWriter::histogram(const char* name, const std::string& labels, const uint64_t* bounds,
+                                  const uint64_t* buckets, std::size_t boundsAmount, uint64_t sumUs)
+{
+    // Buckets are cumulative in exposition
+    uint64_t count = 0U;
+    std::string le;
+    for (std::size_t i = 0U; i < boundsAmount; ++i)
+    {
+        count += buckets[i];
+        le.clear();
+        appendSeconds(le, bounds[i]);
+        appendName(name, "_bucket", labels, le.c_str());
+        appendUnsigned(_output, count);
+        _output += '\n';
+    }
+    count += buckets[boundsAmount];
+    appendName(name, "_bucket", labels, "+Inf");
+    appendUnsigned(_output, count);
+    _output += '\n';
+    appendName(name, "_sum", labels, nullptr);
+    appendSeconds(_output, sumUs);
+    _output += '\n';
+    appendName(name, "_count", labels, nullptr);
+    appendUnsigned(_output, count);
+    _output += '\n';
+}
+
+void OpenMetricsWriter::finish()
+{
+    _output += "# EOF\n";
+}
+
+void OpenMetricsWriter::appendName(const char* name, const char* suffix, const std::string& labels, const char* le)
+{
+    _output += name;
+    _output += suffix;
+    if (!labels.empty() || le)
+    {
+        _output += '{';
+        _output += labels;
+        if (le)
+        {
+            if (!labels.empty())
+            {
+                _output += ',';
+            }
+            _output += "le=\"";
+            _output += le;
+            _output += '"';
+        }
+        _output += '}';
+    }
+    _output += ' ';
+}
+
+void OpenMetricsWriter::appendUnsigned(std::string& output, uint64_t value)
+{
+    char buf[20];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    do
+    {
+        *--p = static_cast<char>('0' + value % 10U);
+        value /= 10U;
+    }
+    while (value != 0U);
+    output.append(p, end);
+}
+
+void OpenMetricsWriter::appendSeconds(std::string& output, uint64_t us)
+{
+    // Microseconds are printed as decimal seconds without trailing zeros
+    appendUnsigned(output, us / 1000000U);
+    uint64_t fraction = us % 1000000U;
+    if (fraction == 0U)
+    {
+        output += ".0";
+        return;
+    }
+    char buf[7] = {'.', '0', '0', '0', '0', '0', '0'};
+    std::size_t length = sizeof(buf);
+    for (std::size_t i = sizeof(buf) - 1U; i > 0U; --i)
+    {
+        buf[i] = static_cast<char>('0' + fraction % 10U);
+        fraction /= 10U;
+    }
+    while (buf[length - 1U] == '0')
+    {
+        --length;
+    }
+    output.append(buf, length);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: OpenMetrics text exposition format writer
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef OPEN_METRICS_WRITER_H
+#define OPEN_METRICS_WRITER_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+//------------------------------------------------------------------------------
+//! Appends metric families to a string in OpenMetrics text format
+/*!
+ * Label values are not escaped - callers have to pass only values from
+ * fixed tables (procedure names, protocol versions) which keeps the amount
+ * of exposed series bounded and known in advance.
+ */
+class OpenMetricsWriter
+{
+public:
+    //! Content-Type of the produced document
+    static constexpr const char* ContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    OpenMetricsWriter() = delete;
+    //! Constructs writer
+    /*!
+     * \param output String to append exposition to
+     */
+    explicit OpenMetricsWriter(std::string& output);
+    OpenMetricsWriter(const OpenMetricsWriter&) = delete;
+    OpenMetricsWriter& operator=(const OpenMetricsWriter&) = delete;
+
+    //! Writes metric family metadata
+    /*!
+     * \param name Name of the family without any suffixes
+     * \param type Type of the family: "counter", "gauge" or "histogram"
+     * \param help Description of the family
+     */
+    void family(const char* name, const char* type, const char* help);
+    //! Writes sample of counter or gauge
+    /*!
+     * \param name Name of the family
+     * \param suffix Suffix of the sample name ("_total" for counters) or empty string
+     * \param labels Comma-separated list of label pairs or empty string
+     * \param value Value of the sample
+     */
+    void sample(const char* name, const char* suffix, const std::string& labels, uint64_t value);
+    //! Writes samples of histogram
+    /*!
+     * \param name Name of the family
+     * \param labels Comma-separated list of label pairs or empty string
+     * \param bounds Upper bounds of buckets in microseconds
+     * \param buckets Non-cumulative counts of buckets, the last one is +Inf
+     * \param boundsAmount Amount of bounds (buckets amount minus one)
+     * \param sumUs Sum of all observations in microseconds
+     */
+    void histogram(const char* name, const std::string& labels, const uint64_t* bounds,
+                   const uint64_t* buckets, std::size_t boundsAmount, uint64_t sumUs);
+    //! Writes end of exposition marker
+    void finish();
+private:
+    void appendName(const char* name, const char* suffix, const std::string& labels, const char* le);
+    static void appendUnsigned(std::string& output, uint64_t value);
+    static void appendSeconds(std::string& output, uint64_t us);
+
+    std::string& _output;
+};
+//------------------------------------------------------------------------------
+#endif//OPEN_METRICS_WRITER_H
+//------------------------------------------------------------------------------
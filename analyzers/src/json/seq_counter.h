@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Single-writer counters with consistent snapshots
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef SEQ_COUNTER_H
+#define SEQ_COUNTER_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+//------------------------------------------------------------------------------
+//! Sequence lock for data which is modified by a single writer thread
+/*!
+ * The writer never waits: it makes the sequence odd, modifies data by relaxed
+ * stores and makes the sequence even again. Readers retry while the sequence
+ * is odd or has been changed during reading.
+ */
+class SeqLock
+{
+public:
+    //! Write section of the single writer
+    class WriteGuard
+    {
+    public:
+        explicit WriteGuard(SeqLock& lock) :
+            _lock(lock)
+        {
+            _lock.beginWrite();
+        }
+        ~WriteGuard()
+        {
+            _lock.endWrite();
+        }
+        WriteGuard(const WriteGuard&) = delete;
+        WriteGuard& operator=(const WriteGuard&) = delete;
+    private:
+        SeqLock& _lock;
+    };
+
+    SeqLock() :
+        _sequence{0U}
+    {}
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    inline void beginWrite()
+    {
+        _sequence.store(_sequence.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    inline void endWrite()
+    {
+        _sequence.store(_sequence.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+    }
+
+    //! Calls reader until it observes data not modified by the writer
+    /*!
+     * \param reader Function which copies data by relaxed loads
+     */
+    template <typename Reader>
+    inline void read(Reader reader) const
+    {
+        while (true)
+        {
+            const uint32_t before = _sequence.load(std::memory_order_acquire);
+            if (before & 1U)
+            {
+                continue;
+            }
+            reader();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == before)
+            {
+                return;
+            }
+        }
+    }
+private:
+    std::atomic<uint32_t> _sequence;
+};
+
+//! Block of 64-bit counters which are incremented by a single writer thread
+/*!
+ * All counters of the block share its sequence lock: an increment is a write
+ * section of the lock, so no read-modify-write atomic operation is used, and
+ * readers take consistent snapshots of the whole block. Counters are
+ * addressed by indexes, usually enumerators of the derived block.
+ */
+template <std::size_t Size>
+class SeqCounters
+{
+public:
+    static constexpr std::size_t CountersAmount = Size;
+
+    SeqCounters() :
+        _lock{}
+    {
+        for (auto& value : _values)
+        {
+            value.store(0U, std::memory_order_relaxed);
+        }
+    }
+    SeqCounters(const SeqCounters&) = delete;
+    SeqCounters& operator=(const SeqCounters&) = delete;
+
+    inline void increment(std::size_t index)
+    {
+        _lock.beginWrite();
+        _values[index].store(_values[index].load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+        _lock.endWrite();
+    }
+
+    //! Value of the counter, consistent with others inside read() only
+    inline uint64_t load(std::size_t index) const
+    {
+        return _values[index].load(std::memory_order_relaxed);
+    }
+
+    template <typename Reader>
+    inline void read(Reader reader) const
+    {
+        _lock.read(reader);
+    }
+private:
+    SeqLock _lock;
+    std::atomic<uint64_t> _values[Size];
+};
+
+template <std::size_t Size>
+constexpr std::size_t SeqCounters<Size>::CountersAmount;
+//------------------------------------------------------------------------------
+#endif//SEQ_COUNTER_H
+//------------------------------------------------------------------------------
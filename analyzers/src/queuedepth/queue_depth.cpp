@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Time-weighted amount of outstanding requests
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <limits>
+
+#include "queue_depth.h"
+//------------------------------------------------------------------------------
+namespace
+{
+const double MicrosecondsPerSecond = 1000000.0;
+}
+
+QueueDepth::QueueDepth(uint64_t window) :
+    _window{window},
+    _calls{},
+    _replies{},
+    _started{false},
+    _first{0U},
+    _now{0U},
+    _latestReply{0U},
+    _depth{0U},
+    _maxDepth{0U},
+    _area{0U},
+    _latencies{0U},
+    _requests{0U},
+    _late{0U}
+{
+}
+
+void QueueDepth::add(uint64_t call, uint64_t reply)
+{
+    reply = std::max(reply, call);
+    ++_requests;
+    _latencies += reply - call;
+
+    if (_started && call < _now)
+    {
+        // Sweep has already passed the call, account the missed part only
+        ++_late;
+        if (reply <= _now)
+        {
+            _area += reply - call;
+            return;
+        }
+        _area += _now - call;
+        call = _now;
+    }
+    _calls.push(call);
+    _replies.push(reply);
+
+    _latestReply = std::max(_latestReply, reply);
+    if (_latestReply > _window)
+    {
+        sweep(_latestReply - _window);
+    }
+}
+
+void QueueDepth::finish()
+{
+    sweep(std::numeric_limits<uint64_t>::max());
+}
+
+double QueueDepth::averageDepth() const
+{
+    const double duration = period();
+    return duration > 0.0 ? static_cast<double>(_area) / duration : 0.0;
+}
+
+double QueueDepth::averageLatency() const
+{
+    return _requests != 0U ? static_cast<double>(_latencies) / static_cast<double>(_requests) : 0.0;
+}
+
+double QueueDepth::throughput() const
+{
+    const double duration = period();
+    return duration > 0.0 ? static_cast<double>(_requests) * MicrosecondsPerSecond / duration : 0.0;
+}
+
+double QueueDepth::littleThroughput() const
+{
+    const double latency = averageLatency();
+    return latency > 0.0 ? averageDepth() * MicrosecondsPerSecond / latency : 0.0;
+}
+
+double QueueDepth::maxDepthThroughput() const
+{
+    const double latency = averageLatency();
+    return latency > 0.0 ? static_cast<double>(_maxDepth) * MicrosecondsPerSecond / latency : 0.0;
+}
+
+void QueueDepth::sweep(uint64_t until)
+{
+    for (;;)
+    {
+        const bool hasCall = !_calls.empty() && _calls.top() <= until;
+        const bool hasReply = !_replies.empty() && _replies.top() <= until;
+        if (!hasCall && !hasReply)
+        {
+            break;
+        }
+        // On a tie a reply goes first, so back-to-back requests do not overlap,
+        // unless nothing is in flight yet (zero latency request)
+        if (hasReply && (!hasCall || _replies.top() < _calls.top() || (_replies.top() == _calls.top() && _depth > 0U)))
+        {
+            moveTo(_replies.top());
+            _replies.pop();
+            --_depth;
+        }
+        else
+        {
+            moveTo(_calls.top());
+            _calls.pop();
+            _maxDepth = std::max(_maxDepth, ++_depth);
+        }
+    }
+}
+
+void QueueDepth::moveTo(uint64_t time)
+{
+    if (!_started)
+    {
+        _started = true;
+        _first = time;
+        _now = time;
+        return;
+    }
+    if (time > _now)
+    {
+        _area += static_cast<uint64_t>(_depth) * (time - _now);
+        _now = time;
+    }
+}
+
+double QueueDepth::period() const
+{
+    return static_cast<double>(_now - _first);
+}
+//------------------------------------------------------------------------------
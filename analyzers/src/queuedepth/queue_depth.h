@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Time-weighted amount of outstanding requests
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef QUEUE_DEPTH_H
+#define QUEUE_DEPTH_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+//------------------------------------------------------------------------------
+//! Queue depth (amount of requests in flight) over time
+/*!
+ * Requests are reported when their reply is seen, i.e. ordered by reply time,
+ * while depth changes at call times too. Call and reply times are pushed to
+ * two min-heaps and swept in time order up to a watermark which lags behind
+ * the latest reply by a reorder window, so each request costs O(log n).
+ * A request whose call precedes the swept time (its latency exceeds the
+ * window) is counted as late: its missed part is added to the area, but it
+ * can not raise max depth in the past.
+ *
+ * All times are in microseconds.
+ */
+class QueueDepth
+{
+public:
+    QueueDepth() = delete;
+    //! Constructs empty queue
+    /*!
+     * \param window Reorder window - lag of the sweep behind the latest reply
+     */
+    explicit QueueDepth(uint64_t window);
+
+    //! Accounts request
+    /*!
+     * \param call Time of call
+     * \param reply Time of reply
+     */
+    void add(uint64_t call, uint64_t reply);
+    //! Sweeps all pending events
+    void finish();
+
+    //! Returns time-weighted average depth over the observed period
+    double averageDepth() const;
+    //! Returns average latency of requests
+    double averageLatency() const;
+    //! Returns measured throughput, requests per second
+    double throughput() const;
+    //! Returns Little's law estimate of throughput: average depth / average latency
+    double littleThroughput() const;
+    //! Returns throughput sustainable with max depth by Little's law
+    double maxDepthThroughput() const;
+
+    inline uint32_t maxDepth() const
+    {
+        return _maxDepth;
+    }
+    inline uint64_t requestsAmount() const
+    {
+        return _requests;
+    }
+    inline uint64_t lateAmount() const
+    {
+        return _late;
+    }
+private:
+    using MinHeap = std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>;
+
+    void sweep(uint64_t until);
+    void moveTo(uint64_t time);
+    double period() const;
+
+    uint64_t _window;
+    MinHeap _calls;
+    MinHeap _replies;
+    bool _started;
+    uint64_t _first;        // time of the first swept event
+    uint64_t _now;          // time of the last swept event
+    uint64_t _latestReply;
+    uint32_t _depth;
+    uint32_t _maxDepth;
+    uint64_t _area;         // integral of depth over time
+    uint64_t _latencies;    // sum of latencies
+    uint64_t _requests;
+    uint64_t _late;
+};
+//------------------------------------------------------------------------------
+#endif//QUEUE_DEPTH_H
+//------------------------------------------------------------------------------
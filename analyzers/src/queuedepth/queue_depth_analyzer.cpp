@@ -0,0 +1,393 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of amount of outstanding RPC requests
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+#include <arpa/inet.h>
+
+#include "queue_depth_analyzer.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+uint64_t microseconds(const struct timeval& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000U + static_cast<uint64_t>(time.tv_usec);
+}
+
+uint64_t fnv1a(const uint8_t* data, std::size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash ^ (hash >> 32);
+}
+
+} // namespace
+
+QueueDepthAnalyzer::HostAddress::HostAddress(const Session& session, Session::Direction side) :
+    words{0U, 0U, 0U, 0U},
+    type{session.ip_type}
+{
+    switch (type)
+    {
+    case Session::IPType::v4:
+        words[0] = session.ip.v4.addr[side];
+        break;
+    case Session::IPType::v6:
+        memcpy(words, session.ip.v6.addr[side], sizeof(words));
+        break;
+    }
+}
+
+bool QueueDepthAnalyzer::HostAddress::operator==(const HostAddress& other) const
+{
+    return type == other.type && memcmp(words, other.words, sizeof(words)) == 0;
+}
+
+std::string QueueDepthAnalyzer::HostAddress::str() const
+{
+    char buf[INET6_ADDRSTRLEN];
+    if (!inet_ntop(type == Session::IPType::v4 ? AF_INET : AF_INET6, words, buf, sizeof(buf)))
+    {
+        return std::string{};
+    }
+    return std::string{buf};
+}
+
+std::size_t QueueDepthAnalyzer::HostAddressHash::operator()(const HostAddress& address) const
+{
+    return static_cast<std::size_t>(fnv1a(reinterpret_cast<const uint8_t*>(address.words), sizeof(address.words)));
+}
+
+QueueDepthAnalyzer::SessionId::SessionId(const NFS41::sessionid4& id)
+{
+    memcpy(data, id, sizeof(data));
+}
+
+bool QueueDepthAnalyzer::SessionId::operator==(const SessionId& other) const
+{
+    return memcmp(data, other.data, sizeof(data)) == 0;
+}
+
+std::string QueueDepthAnalyzer::SessionId::str() const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string result;
+    for (char c : data)
+    {
+        result += digits[(static_cast<uint8_t>(c) >> 4) & 0x0f];
+        result += digits[static_cast<uint8_t>(c) & 0x0f];
+    }
+    return result;
+}
+
+std::size_t QueueDepthAnalyzer::SessionIdHash::operator()(const SessionId& id) const
+{
+    return static_cast<std::size_t>(fnv1a(reinterpret_cast<const uint8_t*>(id.data), sizeof(id.data)));
+}
+
+QueueDepthAnalyzer::SessionQueue::SessionQueue(uint64_t window) :
+    depth{window},
+    maxSlot{0U},
+    highestSlot{0U},
+    targetHighestSlot{0U}
+{
+}
+
+QueueDepthAnalyzer::QueueDepthAnalyzer(uint64_t window, std::ostream& out) :
+    _window{window},
+    _out(out),
+    _clients{},
+    _servers{},
+    _sessions{}
+{
+}
+
+void QueueDepthAnalyzer::null(const RPCProcedure* proc,
+                              const struct NFS3::NULL3args*,
+                              const struct NFS3::NULL3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::getattr3(const RPCProcedure* proc,
+                                  const struct NFS3::GETATTR3args*,
+                                  const struct NFS3::GETATTR3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::setattr3(const RPCProcedure* proc,
+                                  const struct NFS3::SETATTR3args*,
+                                  const struct NFS3::SETATTR3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::lookup3(const RPCProcedure* proc,
+                                 const struct NFS3::LOOKUP3args*,
+                                 const struct NFS3::LOOKUP3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::access3(const RPCProcedure* proc,
+                                 const struct NFS3::ACCESS3args*,
+                                 const struct NFS3::ACCESS3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::readlink3(const RPCProcedure* proc,
+                                   const struct NFS3::READLINK3args*,
+                                   const struct NFS3::READLINK3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::read3(const RPCProcedure* proc,
+                               const struct NFS3::READ3args*,
+                               const struct NFS3::READ3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::write3(const RPCProcedure* proc,
+                                const struct NFS3::WRITE3args*,
+                                const struct NFS3::WRITE3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::create3(const RPCProcedure* proc,
+                                 const struct NFS3::CREATE3args*,
+                                 const struct NFS3::CREATE3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::mkdir3(const RPCProcedure* proc,
+                                const struct NFS3::MKDIR3args*,
+                                const struct NFS3::MKDIR3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::symlink3(const RPCProcedure* proc,
+                                  const struct NFS3::SYMLINK3args*,
+                                  const struct NFS3::SYMLINK3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::mknod3(const RPCProcedure* proc,
+                                const struct NFS3::MKNOD3args*,
+                                const struct NFS3::MKNOD3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::remove3(const RPCProcedure* proc,
+                                 const struct NFS3::REMOVE3args*,
+                                 const struct NFS3::REMOVE3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::rmdir3(const RPCProcedure* proc,
+                                const struct NFS3::RMDIR3args*,
+                                const struct NFS3::RMDIR3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::rename3(const RPCProcedure* proc,
+                                 const struct NFS3::RENAME3args*,
+                                 const struct NFS3::RENAME3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::link3(const RPCProcedure* proc,
+                               const struct NFS3::LINK3args*,
+                               const struct NFS3::LINK3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::readdir3(const RPCProcedure* proc,
+                                  const struct NFS3::READDIR3args*,
+                                  const struct NFS3::READDIR3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::readdirplus3(const RPCProcedure* proc,
+                                      const struct NFS3::READDIRPLUS3args*,
+                                      const struct NFS3::READDIRPLUS3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::fsstat3(const RPCProcedure* proc,
+                                 const struct NFS3::FSSTAT3args*,
+                                 const struct NFS3::FSSTAT3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::fsinfo3(const RPCProcedure* proc,
+                                 const struct NFS3::FSINFO3args*,
+                                 const struct NFS3::FSINFO3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::pathconf3(const RPCProcedure* proc,
+                                   const struct NFS3::PATHCONF3args*,
+                                   const struct NFS3::PATHCONF3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::commit3(const RPCProcedure* proc,
+                                 const struct NFS3::COMMIT3args*,
+                                 const struct NFS3::COMMIT3res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::null4(const RPCProcedure* proc,
+                               const struct NFS4::NULL4args*,
+                               const struct NFS4::NULL4res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::compound4(const RPCProcedure* proc,
+                                   const struct NFS4::COMPOUND4args*,
+                                   const struct NFS4::COMPOUND4res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::compound41(const RPCProcedure* proc,
+                                    const struct NFS41::COMPOUND4args*,
+                                    const struct NFS41::COMPOUND4res*)
+{
+    account(proc);
+}
+
+void QueueDepthAnalyzer::sequence41(const RPCProcedure* proc,
+                                    const struct NFS41::SEQUENCE4args* args,
+                                    const struct NFS41::SEQUENCE4res* res)
+{
+    if (!args)
+    {
+        return;
+    }
+    SessionId id{args->sa_sessionid};
+    auto found = _sessions.find(id);
+    if (found == _sessions.end())
+    {
+        found = _sessions.emplace(id, SessionQueue{_window}).first;
+    }
+    SessionQueue& session = found->second;
+    session.depth.add(microseconds(*proc->ctimestamp), microseconds(*proc->rtimestamp));
+    session.maxSlot = std::max(session.maxSlot, args->sa_slotid);
+    session.highestSlot = std::max(session.highestSlot, args->sa_highest_slotid);
+    if (res && res->sr_status == NFS41::NFS4_OK)
+    {
+        session.targetHighestSlot = res->SEQUENCE4res_u.sr_resok4.sr_target_highest_slotid;
+    }
+}
+
+void QueueDepthAnalyzer::flush_statistics()
+{
+    _out << "### Queue depth statistics ###" << std::endl;
+    _out << "Clients:" << std::endl;
+    for (auto& client : _clients)
+    {
+        printQueue(client.first.str(), client.second);
+    }
+    _out << "Servers:" << std::endl;
+    for (auto& server : _servers)
+    {
+        printQueue(server.first.str(), server.second);
+    }
+    if (!_sessions.empty())
+    {
+        _out << "NFSv4.1 sessions:" << std::endl;
+        for (auto& session : _sessions)
+        {
+            printQueue(session.first.str(), session.second.depth);
+            _out << "    slots: max used " << session.second.maxSlot
+                 << " highest " << session.second.highestSlot
+                 << " target highest " << session.second.targetHighestSlot << std::endl;
+        }
+    }
+}
+
+void QueueDepthAnalyzer::account(const RPCProcedure* proc)
+{
+    const uint64_t call = microseconds(*proc->ctimestamp);
+    const uint64_t reply = microseconds(*proc->rtimestamp);
+    accountHost(_clients, HostAddress{*proc->session, Session::Source}, call, reply);
+    accountHost(_servers, HostAddress{*proc->session, Session::Destination}, call, reply);
+}
+
+void QueueDepthAnalyzer::accountHost(HostQueues& queues, const HostAddress& address, uint64_t call, uint64_t reply)
+{
+    auto found = queues.find(address);
+    if (found == queues.end())
+    {
+        found = queues.emplace(address, QueueDepth{_window}).first;
+    }
+    found->second.add(call, reply);
+}
+
+void QueueDepthAnalyzer::printQueue(const std::string& name, QueueDepth& queue)
+{
+    queue.finish();
+    _out << "  " << name
+         << " requests " << queue.requestsAmount()
+         << std::fixed << std::setprecision(2)
+         << " avg depth " << queue.averageDepth()
+         << " max depth " << queue.maxDepth()
+         << " avg latency " << queue.averageLatency() / 1000.0 << " ms"
+         << std::setprecision(1)
+         << " ops/s " << queue.throughput()
+         << " Little's law ops/s " << queue.littleThroughput()
+         << " at max depth ops/s " << queue.maxDepthThroughput();
+    _out.unsetf(std::ios::floatfield);
+    if (queue.lateAmount() != 0U)
+    {
+        _out << " late " << queue.lateAmount();
+    }
+    _out << std::endl;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of amount of outstanding RPC requests
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef QUEUE_DEPTH_ANALYZER_H
+#define QUEUE_DEPTH_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "api/ianalyzer.h"
+#include "queue_depth.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer of queue depth of NFS clients, servers and NFSv4.1 sessions
+/*!
+ * Reconstructs amount of RPC requests in flight over time from call and reply
+ * timestamps of each procedure and reports time-weighted average and max
+ * depth together with Little's law estimates of throughput. For NFSv4.1
+ * sessions slots are the queue: max depth is compared with the highest slot
+ * used by the client and the target highest slot of the server to show
+ * whether the client is starved of slots.
+ */
+class QueueDepthAnalyzer : public IAnalyzer
+{
+public:
+    QueueDepthAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param window Reorder window in microseconds, see QueueDepth
+     * \param out Stream to report to
+     */
+    explicit QueueDepthAnalyzer(uint64_t window, std::ostream& out = std::cout);
+    QueueDepthAnalyzer(const QueueDepthAnalyzer&) = delete;
+    QueueDepthAnalyzer& operator=(const QueueDepthAnalyzer&) = delete;
+
+    // NFSv3 procedures
+
+    void null(const RPCProcedure* proc,
+              const struct NFS3::NULL3args*,
+              const struct NFS3::NULL3res*) override final;
+    void getattr3(const RPCProcedure* proc,
+                  const struct NFS3::GETATTR3args*,
+                  const struct NFS3::GETATTR3res*) override final;
+    void setattr3(const RPCProcedure* proc,
+                  const struct NFS3::SETATTR3args*,
+                  const struct NFS3::SETATTR3res*) override final;
+    void lookup3(const RPCProcedure* proc,
+                 const struct NFS3::LOOKUP3args*,
+                 const struct NFS3::LOOKUP3res*) override final;
+    void access3(const RPCProcedure* proc,
+                 const struct NFS3::ACCESS3args*,
+                 const struct NFS3::ACCESS3res*) override final;
+    void readlink3(const RPCProcedure* proc,
+                   const struct NFS3::READLINK3args*,
+                   const struct NFS3::READLINK3res*) override final;
+    void read3(const RPCProcedure* proc,
+               const struct NFS3::READ3args*,
+               const struct NFS3::READ3res*) override final;
+    void write3(const RPCProcedure* proc,
+                const struct NFS3::WRITE3args*,
+                const struct NFS3::WRITE3res*) override final;
+    void create3(const RPCProcedure* proc,
+                 const struct NFS3::CREATE3args*,
+                 const struct NFS3::CREATE3res*) override final;
+    void mkdir3(const RPCProcedure* proc,
+                const struct NFS3::MKDIR3args*,
+                const struct NFS3::MKDIR3res*) override final;
+    void symlink3(const RPCProcedure* proc,
+                  const struct NFS3::SYMLINK3args*,
+                  const struct NFS3::SYMLINK3res*) override final;
+    void mknod3(const RPCProcedure* proc,
+                const struct NFS3::MKNOD3args*,
+                const struct NFS3::MKNOD3res*) override final;
+    void remove3(const RPCProcedure* proc,
+                 const struct NFS3::REMOVE3args*,
+                 const struct NFS3::REMOVE3res*) override final;
+    void rmdir3(const RPCProcedure* proc,
+                const struct NFS3::RMDIR3args*,
+                const struct NFS3::RMDIR3res*) override final;
+    void rename3(const RPCProcedure* proc,
+                 const struct NFS3::RENAME3args*,
+                 const struct NFS3::RENAME3res*) override final;
+    void link3(const RPCProcedure* proc,
+               const struct NFS3::LINK3args*,
+               const struct NFS3::LINK3res*) override final;
+    void readdir3(const RPCProcedure* proc,
+                  const struct NFS3::READDIR3args*,
+                  const struct NFS3::READDIR3res*) override final;
+    void readdirplus3(const RPCProcedure* proc,
+                      const struct NFS3::READDIRPLUS3args*,
+                      const struct NFS3::READDIRPLUS3res*) override final;
+    void fsstat3(const RPCProcedure* proc,
+                 const struct NFS3::FSSTAT3args*,
+                 const struct NFS3::FSSTAT3res*) override final;
+    void fsinfo3(const RPCProcedure* proc,
+                 const struct NFS3::FSINFO3args*,
+                 const struct NFS3::FSINFO3res*) override final;
+    void pathconf3(const RPCProcedure* proc,
+                   const struct NFS3::PATHCONF3args*,
+                   const struct NFS3::PATHCONF3res*) override final;
+    void commit3(const RPCProcedure* proc,
+                 const struct NFS3::COMMIT3args*,
+                 const struct NFS3::COMMIT3res*) override final;
+    // NFSv4.x procedures
+
+    void null4(const RPCProcedure* proc,
+               const struct NFS4::NULL4args*,
+               const struct NFS4::NULL4res*) override final;
+    void compound4(const RPCProcedure* proc,
+                   const struct NFS4::COMPOUND4args*,
+                   const struct NFS4::COMPOUND4res*) override final;
+    void compound41(const RPCProcedure* proc,
+                    const struct NFS41::COMPOUND4args*,
+                    const struct NFS41::COMPOUND4res*) override final;
+    // NFSv4.1 operations
+
+    void sequence41(const RPCProcedure* proc,
+                    const struct NFS41::SEQUENCE4args* args,
+                    const struct NFS41::SEQUENCE4res* res) override final;
+
+    void flush_statistics() override final;
+private:
+    //! IP-address of a client or a server
+    struct HostAddress
+    {
+        HostAddress(const Session& session, Session::Direction side);
+
+        bool operator==(const HostAddress& other) const;
+        std::string str() const;
+
+        uint32_t words[4]; // IPv4 address is stored in the first word
+        Session::IPType type;
+    };
+
+    struct HostAddressHash
+    {
+        std::size_t operator()(const HostAddress& address) const;
+    };
+
+    //! Identifier of NFSv4.1 session
+    struct SessionId
+    {
+        explicit SessionId(const NFS41::sessionid4& id);
+
+        bool operator==(const SessionId& other) const;
+        std::string str() const;
+
+        char data[NFS41::NFS4_SESSIONID_SIZE];
+    };
+
+    struct SessionIdHash
+    {
+        std::size_t operator()(const SessionId& id) const;
+    };
+
+    //! Queue of NFSv4.1 session and its slots
+    struct SessionQueue
+    {
+        explicit SessionQueue(uint64_t window);
+
+        QueueDepth depth;
+        uint32_t maxSlot;           // the highest slot used by client
+        uint32_t highestSlot;       // the highest slot known to client
+        uint32_t targetHighestSlot; // the highest slot server wants client to use
+    };
+
+    using HostQueues = std::unordered_map<HostAddress, QueueDepth, HostAddressHash>;
+
+    void account(const RPCProcedure* proc);
+    void accountHost(HostQueues& queues, const HostAddress& address, uint64_t call, uint64_t reply);
+    void printQueue(const std::string& name, QueueDepth& queue);
+
+    uint64_t _window;
+    std::ostream& _out;
+    HostQueues _clients;
+    HostQueues _servers;
+    std::unordered_map<SessionId, SessionQueue, SessionIdHash> _sessions;
+};
+//------------------------------------------------------------------------------
+#endif//QUEUE_DEPTH_ANALYZER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Entry points of queue depth analyzer plugin
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "api/plugin_api.h" // include plugin development definitions
+#include "queue_depth_analyzer.h"
+//------------------------------------------------------------------------------
+
+static constexpr uint64_t DefaultWindowMs = 1000U;
+
+extern "C"
+{
+
+    const char* usage()
+    {
+        return "window - Reorder window in milliseconds: replies are swept this long after\n"
+               "         they are seen, requests with greater latency are counted as late (default is 1000)";
+    }
+
+    IAnalyzer* create(const char* opts)
+    {
+        // Initializing plugin options with default values
+        uint64_t windowMs = DefaultWindowMs;
+        // Parising plugin options
+        enum
+        {
+            WINDOW_SUBOPT_INDEX = 0
+        };
+        char windowSubOptName[] = "window";
+        char* const tokens[] =
+        {
+            windowSubOptName,
+            NULL
+        };
+        std::size_t optsLen = strlen(opts);
+        std::vector<char> optsBuf{opts, opts + optsLen + 2};
+        char* optionp = &optsBuf[0];
+        char* valuep;
+        int optIndex;
+        while ((optIndex = getsubopt(&optionp, tokens, &valuep)) >= 0)
+        {
+            try
+            {
+                switch (optIndex)
+                {
+                case WINDOW_SUBOPT_INDEX:
+                    windowMs = std::stoull(valuep);
+                    break;
+                default:
+                    throw std::runtime_error{std::string{"Invalid suboption index: "} + std::to_string(optIndex)};
+                }
+            }
+            catch (std::logic_error& e)
+            {
+                throw std::runtime_error{std::string{"Invalid value provided for '"} + tokens[optIndex] + "' suboption"};
+            }
+        }
+        // Creating and returning plugin
+        return new QueueDepthAnalyzer{windowMs * 1000U};
+    }
+
+    void destroy(IAnalyzer* instance)
+    {
+        delete instance;
+    }
+
+    NST_PLUGIN_ENTRY_POINTS (&usage, &create, &destroy, nullptr)
+
+} //extern "C"
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,899 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer writing NFS operations to workload replay trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+
+#include "replay_analyzer.h"
+//------------------------------------------------------------------------------
+using namespace Replay;
+
+namespace
+{
+
+uint64_t microseconds(const struct timeval& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000U + static_cast<uint64_t>(time.tv_usec);
+}
+
+} // namespace
+
+ReplayAnalyzer::ReplayAnalyzer(const std::string& path, std::size_t bufferSize, std::ostream& out) :
+    _encoder{},
+    _writer{path},
+    _bufferSize{bufferSize},
+    _out(out),
+    _handles{}
+{
+    _encoder.buffer().reserve(bufferSize);
+}
+
+ReplayAnalyzer::~ReplayAnalyzer()
+{
+    _writer.submit(_encoder.buffer());
+}
+
+void ReplayAnalyzer::null(const RPCProcedure* proc,
+                          const struct NFS3::NULL3args*,
+                          const struct NFS3::NULL3res*)
+{
+    commit(start(proc, Program::NFSv3, ProcEnumNFS3::NFS_NULL));
+}
+
+void ReplayAnalyzer::getattr3(const RPCProcedure* proc,
+                              const struct NFS3::GETATTR3args* args,
+                              const struct NFS3::GETATTR3res* res)
+{
+    object3(proc, ProcEnumNFS3::GETATTR, args ? &args->object : nullptr, res);
+}
+
+void ReplayAnalyzer::setattr3(const RPCProcedure* proc,
+                              const struct NFS3::SETATTR3args* args,
+                              const struct NFS3::SETATTR3res* res)
+{
+    object3(proc, ProcEnumNFS3::SETATTR, args ? &args->object : nullptr, res);
+}
+
+void ReplayAnalyzer::lookup3(const RPCProcedure* proc,
+                             const struct NFS3::LOOKUP3args* args,
+                             const struct NFS3::LOOKUP3res* res)
+{
+    entry3(proc, ProcEnumNFS3::LOOKUP, args ? &args->what : nullptr, res);
+}
+
+void ReplayAnalyzer::access3(const RPCProcedure* proc,
+                             const struct NFS3::ACCESS3args* args,
+                             const struct NFS3::ACCESS3res* res)
+{
+    object3(proc, ProcEnumNFS3::ACCESS, args ? &args->object : nullptr, res);
+}
+
+void ReplayAnalyzer::readlink3(const RPCProcedure* proc,
+                               const struct NFS3::READLINK3args* args,
+                               const struct NFS3::READLINK3res* res)
+{
+    object3(proc, ProcEnumNFS3::READLINK, args ? &args->symlink : nullptr, res);
+}
+
+void ReplayAnalyzer::read3(const RPCProcedure* proc,
+                           const struct NFS3::READ3args* args,
+                           const struct NFS3::READ3res* res)
+{
+    if (args)
+    {
+        range3(proc, ProcEnumNFS3::READ, &args->file, args->offset, args->count, res);
+    }
+    else
+    {
+        range3(proc, ProcEnumNFS3::READ, nullptr, 0U, 0U, res);
+    }
+}
+
+void ReplayAnalyzer::write3(const RPCProcedure* proc,
+                            const struct NFS3::WRITE3args* args,
+                            const struct NFS3::WRITE3res* res)
+{
+    if (args)
+    {
+        range3(proc, ProcEnumNFS3::WRITE, &args->file, args->offset, args->count, res);
+    }
+    else
+    {
+        range3(proc, ProcEnumNFS3::WRITE, nullptr, 0U, 0U, res);
+    }
+}
+
+void ReplayAnalyzer::create3(const RPCProcedure* proc,
+                             const struct NFS3::CREATE3args* args,
+                             const struct NFS3::CREATE3res* res)
+{
+    entry3(proc, ProcEnumNFS3::CREATE, args ? &args->where : nullptr, res);
+}
+
+void ReplayAnalyzer::mkdir3(const RPCProcedure* proc,
+                            const struct NFS3::MKDIR3args* args,
+                            const struct NFS3::MKDIR3res* res)
+{
+    entry3(proc, ProcEnumNFS3::MKDIR, args ? &args->where : nullptr, res);
+}
+
+void ReplayAnalyzer::symlink3(const RPCProcedure* proc,
+                              const struct NFS3::SYMLINK3args* args,
+                              const struct NFS3::SYMLINK3res* res)
+{
+    entry3(proc, ProcEnumNFS3::SYMLINK, args ? &args->where : nullptr, res);
+}
+
+void ReplayAnalyzer::mknod3(const RPCProcedure* proc,
+                            const struct NFS3::MKNOD3args* args,
+                            const struct NFS3::MKNOD3res* res)
+{
+    entry3(proc, ProcEnumNFS3::MKNOD, args ? &args->where : nullptr, res);
+}
+
+void ReplayAnalyzer::remove3(const RPCProcedure* proc,
+                             const struct NFS3::REMOVE3args* args,
+                             const struct NFS3::REMOVE3res* res)
+{
+    entry3(proc, ProcEnumNFS3::REMOVE, args ? &args->object : nullptr, res);
+}
+
+void ReplayAnalyzer::rmdir3(const RPCProcedure* proc,
+                            const struct NFS3::RMDIR3args* args,
+                            const struct NFS3::RMDIR3res* res)
+{
+    entry3(proc, ProcEnumNFS3::RMDIR, args ? &args->object : nullptr, res);
+}
+
+void ReplayAnalyzer::rename3(const RPCProcedure* proc,
+                             const struct NFS3::RENAME3args* args,
+                             const struct NFS3::RENAME3res* res)
+{
+    Op op = start(proc, Program::NFSv3, ProcEnumNFS3::RENAME);
+    if (args)
+    {
+        setHandle(op, args->from.dir);
+        setName(op, args->from.name, strlen(args->from.name));
+        setHandle2(op, args->to.dir);
+        setName2(op, args->to.name, strlen(args->to.name));
+    }
+    setStatus(op, res);
+    commit(op);
+}
+
+void ReplayAnalyzer::link3(const RPCProcedure* proc,
+                           const struct NFS3::LINK3args* args,
+                           const struct NFS3::LINK3res* res)
+{
+    Op op = start(proc, Program::NFSv3, ProcEnumNFS3::LINK);
+    if (args)
+    {
+        setHandle(op, args->file);
+        setHandle2(op, args->link.dir);
+        setName2(op, args->link.name, strlen(args->link.name));
+    }
+    setStatus(op, res);
+    commit(op);
+}
+
+void ReplayAnalyzer::readdir3(const RPCProcedure* proc,
+                              const struct NFS3::READDIR3args* args,
+                              const struct NFS3::READDIR3res* res)
+{
+    if (args)
+    {
+        range3(proc, ProcEnumNFS3::READDIR, &args->dir, args->cookie, args->count, res);
+    }
+    else
+    {
+        range3(proc, ProcEnumNFS3::READDIR, nullptr, 0U, 0U, res);
+    }
+}
+
+void ReplayAnalyzer::readdirplus3(const RPCProcedure* proc,
+                                  const struct NFS3::READDIRPLUS3args* args,
+                                  const struct NFS3::READDIRPLUS3res* res)
+{
+    if (args)
+    {
+        range3(proc, ProcEnumNFS3::READDIRPLUS, &args->dir, args->cookie, args->maxcount, res);
+    }
+    else
+    {
+        range3(proc, ProcEnumNFS3::READDIRPLUS, nullptr, 0U, 0U, res);
+    }
+}
+
+void ReplayAnalyzer::fsstat3(const RPCProcedure* proc,
+                             const struct NFS3::FSSTAT3args* args,
+                             const struct NFS3::FSSTAT3res* res)
+{
+    object3(proc, ProcEnumNFS3::FSSTAT, args ? &args->fsroot : nullptr, res);
+}
+
+void ReplayAnalyzer::fsinfo3(const RPCProcedure* proc,
+                             const struct NFS3::FSINFO3args* args,
+                             const struct NFS3::FSINFO3res* res)
+{
+    object3(proc, ProcEnumNFS3::FSINFO, args ? &args->fsroot : nullptr, res);
+}
+
+void ReplayAnalyzer::pathconf3(const RPCProcedure* proc,
+                               const struct NFS3::PATHCONF3args* args,
+                               const struct NFS3::PATHCONF3res* res)
+{
+    object3(proc, ProcEnumNFS3::PATHCONF, args ? &args->object : nullptr, res);
+}
+
+void ReplayAnalyzer::commit3(const RPCProcedure* proc,
+                             const struct NFS3::COMMIT3args* args,
+                             const struct NFS3::COMMIT3res* res)
+{
+    if (args)
+    {
+        range3(proc, ProcEnumNFS3::COMMIT, &args->file, args->offset, args->count, res);
+    }
+    else
+    {
+        range3(proc, ProcEnumNFS3::COMMIT, nullptr, 0U, 0U, res);
+    }
+}
+
+void ReplayAnalyzer::compound4(const RPCProcedure*,
+                               const struct NFS4::COMPOUND4args*,
+                               const struct NFS4::COMPOUND4res*)
+{
+    _handles.start();
+}
+
+void ReplayAnalyzer::putfh40(const RPCProcedure*,
+                             const struct NFS4::PUTFH4args* args,
+                             const struct NFS4::PUTFH4res*)
+{
+    _handles.putfh(args);
+}
+
+void ReplayAnalyzer::getfh40(const RPCProcedure*,
+                             const struct NFS4::GETFH4res* res)
+{
+    _handles.getfh(res);
+}
+
+void ReplayAnalyzer::putrootfh40(const RPCProcedure*,
+                                 const struct NFS4::PUTROOTFH4res*)
+{
+    _handles.forget();
+}
+
+void ReplayAnalyzer::putpubfh40(const RPCProcedure*,
+                                const struct NFS4::PUTPUBFH4res*)
+{
+    _handles.forget();
+}
+
+void ReplayAnalyzer::savefh40(const RPCProcedure*,
+                              const struct NFS4::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void ReplayAnalyzer::restorefh40(const RPCProcedure*,
+                                 const struct NFS4::RESTOREFH4res*)
+{
+    _handles.restore();
+}
+
+void ReplayAnalyzer::access40(const RPCProcedure* proc,
+                              const struct NFS4::ACCESS4args*,
+                              const struct NFS4::ACCESS4res* res)
+{
+    object4(proc, Program::NFSv40, ProcEnumNFS4::ACCESS, res);
+}
+
+void ReplayAnalyzer::close40(const RPCProcedure* proc,
+                             const struct NFS4::CLOSE4args*,
+                             const struct NFS4::CLOSE4res* res)
+{
+    object4(proc, Program::NFSv40, ProcEnumNFS4::CLOSE, res);
+}
+
+void ReplayAnalyzer::getattr40(const RPCProcedure* proc,
+                               const struct NFS4::GETATTR4args*,
+                               const struct NFS4::GETATTR4res* res)
+{
+    object4(proc, Program::NFSv40, ProcEnumNFS4::GETATTR, res);
+}
+
+void ReplayAnalyzer::setattr40(const RPCProcedure* proc,
+                               const struct NFS4::SETATTR4args*,
+                               const struct NFS4::SETATTR4res* res)
+{
+    object4(proc, Program::NFSv40, ProcEnumNFS4::SETATTR, res);
+}
+
+void ReplayAnalyzer::commit40(const RPCProcedure* proc,
+                              const struct NFS4::COMMIT4args* args,
+                              const struct NFS4::COMMIT4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv40, ProcEnumNFS4::COMMIT, args->offset, args->count, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::COMMIT, res);
+    }
+}
+
+void ReplayAnalyzer::create40(const RPCProcedure* proc,
+                              const struct NFS4::CREATE4args* args,
+                              const struct NFS4::CREATE4res* res)
+{
+    if (args)
+    {
+        entry4(proc, Program::NFSv40, ProcEnumNFS4::CREATE, args->objname.utf8string_val, args->objname.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::CREATE, res);
+    }
+    _handles.forget();
+}
+
+void ReplayAnalyzer::link40(const RPCProcedure* proc,
+                            const struct NFS4::LINK4args* args,
+                            const struct NFS4::LINK4res* res)
+{
+    link4(proc, Program::NFSv40, args, res);
+}
+
+void ReplayAnalyzer::lookup40(const RPCProcedure* proc,
+                              const struct NFS4::LOOKUP4args* args,
+                              const struct NFS4::LOOKUP4res* res)
+{
+    if (args)
+    {
+        entry4(proc, Program::NFSv40, ProcEnumNFS4::LOOKUP, args->objname.utf8string_val, args->objname.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::LOOKUP, res);
+    }
+    _handles.forget();
+}
+
+void ReplayAnalyzer::lookupp40(const RPCProcedure* proc,
+                               const struct NFS4::LOOKUPP4res* res)
+{
+    object4(proc, Program::NFSv40, ProcEnumNFS4::LOOKUPP, res);
+    _handles.forget();
+}
+
+void ReplayAnalyzer::open40(const RPCProcedure* proc,
+                            const struct NFS4::OPEN4args* args,
+                            const struct NFS4::OPEN4res* res)
+{
+    if (args && args->claim.claim == NFS4::CLAIM_NULL)
+    {
+        entry4(proc, Program::NFSv40, ProcEnumNFS4::OPEN, args->claim.open_claim4_u.file.utf8string_val, args->claim.open_claim4_u.file.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::OPEN, res);
+    }
+    _handles.forget();
+}
+
+void ReplayAnalyzer::read40(const RPCProcedure* proc,
+                            const struct NFS4::READ4args* args,
+                            const struct NFS4::READ4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv40, ProcEnumNFS4::READ, args->offset, args->count, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::READ, res);
+    }
+}
+
+void ReplayAnalyzer::readdir40(const RPCProcedure* proc,
+                               const struct NFS4::READDIR4args* args,
+                               const struct NFS4::READDIR4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv40, ProcEnumNFS4::READDIR, args->cookie, args->maxcount, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::READDIR, res);
+    }
+}
+
+void ReplayAnalyzer::readlink40(const RPCProcedure* proc,
+                                const struct NFS4::READLINK4res* res)
+{
+    object4(proc, Program::NFSv40, ProcEnumNFS4::READLINK, res);
+}
+
+void ReplayAnalyzer::remove40(const RPCProcedure* proc,
+                              const struct NFS4::REMOVE4args* args,
+                              const struct NFS4::REMOVE4res* res)
+{
+    if (args)
+    {
+        entry4(proc, Program::NFSv40, ProcEnumNFS4::REMOVE, args->target.utf8string_val, args->target.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::REMOVE, res);
+    }
+}
+
+void ReplayAnalyzer::rename40(const RPCProcedure* proc,
+                              const struct NFS4::RENAME4args* args,
+                              const struct NFS4::RENAME4res* res)
+{
+    rename4(proc, Program::NFSv40, args, res);
+}
+
+void ReplayAnalyzer::write40(const RPCProcedure* proc,
+                             const struct NFS4::WRITE4args* args,
+                             const struct NFS4::WRITE4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv40, ProcEnumNFS4::WRITE, args->offset, args->data.data_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv40, ProcEnumNFS4::WRITE, res);
+    }
+}
+
+void ReplayAnalyzer::compound41(const RPCProcedure*,
+                                const struct NFS41::COMPOUND4args*,
+                                const struct NFS41::COMPOUND4res*)
+{
+    _handles.start();
+}
+
+void ReplayAnalyzer::putfh41(const RPCProcedure*,
+                             const struct NFS41::PUTFH4args* args,
+                             const struct NFS41::PUTFH4res*)
+{
+    _handles.putfh(args);
+}
+
+void ReplayAnalyzer::getfh41(const RPCProcedure*,
+                             const struct NFS41::GETFH4res* res)
+{
+    _handles.getfh(res);
+}
+
+void ReplayAnalyzer::putrootfh41(const RPCProcedure*,
+                                 const struct NFS41::PUTROOTFH4res*)
+{
+    _handles.forget();
+}
+
+void ReplayAnalyzer::putpubfh41(const RPCProcedure*,
+                                const struct NFS41::PUTPUBFH4res*)
+{
+    _handles.forget();
+}
+
+void ReplayAnalyzer::savefh41(const RPCProcedure*,
+                              const struct NFS41::SAVEFH4res*)
+{
+    _handles.save();
+}
+
+void ReplayAnalyzer::restorefh41(const RPCProcedure*,
+                                 const struct NFS41::RESTOREFH4res*)
+{
+    _handles.restore();
+}
+
+void ReplayAnalyzer::access41(const RPCProcedure* proc,
+                              const struct NFS41::ACCESS4args*,
+                              const struct NFS41::ACCESS4res* res)
+{
+    object4(proc, Program::NFSv41, ProcEnumNFS4::ACCESS, res);
+}
+
+void ReplayAnalyzer::close41(const RPCProcedure* proc,
+                             const struct NFS41::CLOSE4args*,
+                             const struct NFS41::CLOSE4res* res)
+{
+    object4(proc, Program::NFSv41, ProcEnumNFS4::CLOSE, res);
+}
+
+void ReplayAnalyzer::getattr41(const RPCProcedure* proc,
+                               const struct NFS41::GETATTR4args*,
+                               const struct NFS41::GETATTR4res* res)
+{
+    object4(proc, Program::NFSv41, ProcEnumNFS4::GETATTR, res);
+}
+
+void ReplayAnalyzer::setattr41(const RPCProcedure* proc,
+                               const struct NFS41::SETATTR4args*,
+                               const struct NFS41::SETATTR4res* res)
+{
+    object4(proc, Program::NFSv41, ProcEnumNFS4::SETATTR, res);
+}
+
+void ReplayAnalyzer::commit41(const RPCProcedure* proc,
+                              const struct NFS41::COMMIT4args* args,
+                              const struct NFS41::COMMIT4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv41, ProcEnumNFS4::COMMIT, args->offset, args->count, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::COMMIT, res);
+    }
+}
+
+void ReplayAnalyzer::create41(const RPCProcedure* proc,
+                              const struct NFS41::CREATE4args* args,
+                              const struct NFS41::CREATE4res* res)
+{
+    if (args)
+    {
+        entry4(proc, Program::NFSv41, ProcEnumNFS4::CREATE, args->objname.utf8string_val, args->objname.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::CREATE, res);
+    }
+    _handles.forget();
+}
+
+void ReplayAnalyzer::link41(const RPCProcedure* proc,
+                            const struct NFS41::LINK4args* args,
+                            const struct NFS41::LINK4res* res)
+{
+    link4(proc, Program::NFSv41, args, res);
+}
+
+void ReplayAnalyzer::lookup41(const RPCProcedure* proc,
+                              const struct NFS41::LOOKUP4args* args,
+                              const struct NFS41::LOOKUP4res* res)
+{
+    if (args)
+    {
+        entry4(proc, Program::NFSv41, ProcEnumNFS4::LOOKUP, args->objname.utf8string_val, args->objname.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::LOOKUP, res);
+    }
+    _handles.forget();
+}
+
+void ReplayAnalyzer::lookupp41(const RPCProcedure* proc,
+                               const struct NFS41::LOOKUPP4res* res)
+{
+    object4(proc, Program::NFSv41, ProcEnumNFS4::LOOKUPP, res);
+    _handles.forget();
+}
+
+void ReplayAnalyzer::open41(const RPCProcedure* proc,
+                            const struct NFS41::OPEN4args* args,
+                            const struct NFS41::OPEN4res* res)
+{
+    if (args && args->claim.claim == NFS41::CLAIM_NULL)
+    {
+        entry4(proc, Program::NFSv41, ProcEnumNFS4::OPEN, args->claim.open_claim4_u.file.utf8string_val, args->claim.open_claim4_u.file.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::OPEN, res);
+    }
+    _handles.forget();
+}
+
+void ReplayAnalyzer::read41(const RPCProcedure* proc,
+                            const struct NFS41::READ4args* args,
+                            const struct NFS41::READ4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv41, ProcEnumNFS4::READ, args->offset, args->count, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::READ, res);
+    }
+}
+
+void ReplayAnalyzer::readdir41(const RPCProcedure* proc,
+                               const struct NFS41::READDIR4args* args,
+                               const struct NFS41::READDIR4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv41, ProcEnumNFS4::READDIR, args->cookie, args->maxcount, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::READDIR, res);
+    }
+}
+
+void ReplayAnalyzer::readlink41(const RPCProcedure* proc,
+                                const struct NFS41::READLINK4res* res)
+{
+    object4(proc, Program::NFSv41, ProcEnumNFS4::READLINK, res);
+}
+
+void ReplayAnalyzer::remove41(const RPCProcedure* proc,
+                              const struct NFS41::REMOVE4args* args,
+                              const struct NFS41::REMOVE4res* res)
+{
+    if (args)
+    {
+        entry4(proc, Program::NFSv41, ProcEnumNFS4::REMOVE, args->target.utf8string_val, args->target.utf8string_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::REMOVE, res);
+    }
+}
+
+void ReplayAnalyzer::rename41(const RPCProcedure* proc,
+                              const struct NFS41::RENAME4args* args,
+                              const struct NFS41::RENAME4res* res)
+{
+    rename4(proc, Program::NFSv41, args, res);
+}
+
+void ReplayAnalyzer::write41(const RPCProcedure* proc,
+                             const struct NFS41::WRITE4args* args,
+                             const struct NFS41::WRITE4res* res)
+{
+    if (args)
+    {
+        range4(proc, Program::NFSv41, ProcEnumNFS4::WRITE, args->offset, args->data.data_len, res);
+    }
+    else
+    {
+        object4(proc, Program::NFSv41, ProcEnumNFS4::WRITE, res);
+    }
+}
+
+void ReplayAnalyzer::flush_statistics()
+{
+    _writer.submit(_encoder.buffer());
+    _writer.flush();
+
+    _out << "### Replay trace statistics ###" << std::endl;
+    _out << "Replay operations: " << _encoder.opsAmount() << std::endl;
+    _out << "Written bytes: " << _writer.writtenBytes() << std::endl;
+    if (_writer.failed())
+    {
+        _out << "Some data was not written to replay trace" << std::endl;
+    }
+}
+
+Op ReplayAnalyzer::start(const RPCProcedure* proc, Program program, uint32_t procedure)
+{
+    Op op{};
+    const uint64_t call = microseconds(*proc->ctimestamp);
+    const uint64_t reply = microseconds(*proc->rtimestamp);
+    op.timestamp = call;
+    op.latency = static_cast<uint32_t>(std::min<uint64_t>(reply > call ? reply - call : 0U, UINT32_MAX));
+    op.program = program;
+    op.procedure = procedure;
+
+    const Session& session = *proc->session;
+    switch (session.ip_type)
+    {
+    case Session::IPType::v4:
+        op.client = _encoder.client(reinterpret_cast<const uint8_t*>(&session.ip.v4.addr[Session::Source]), 4U);
+        break;
+    case Session::IPType::v6:
+        op.client = _encoder.client(session.ip.v6.addr[Session::Source], 16U);
+        break;
+    }
+    return op;
+}
+
+Op ReplayAnalyzer::start4(const RPCProcedure* proc, Program program, uint32_t procedure)
+{
+    Op op = start(proc, program, procedure);
+    if (_handles.known())
+    {
+        op.fields |= Field::Handle;
+        op.handle = intern(_handles.current());
+    }
+    return op;
+}
+
+void ReplayAnalyzer::setHandle(Op& op, const NFS3::nfs_fh3& handle)
+{
+    op.fields |= Field::Handle;
+    op.handle = _encoder.handle(handle.data.data_val, handle.data.data_len);
+}
+
+void ReplayAnalyzer::setHandle2(Op& op, const NFS3::nfs_fh3& handle)
+{
+    op.fields |= Field::Handle2;
+    op.handle2 = _encoder.handle(handle.data.data_val, handle.data.data_len);
+}
+
+void ReplayAnalyzer::setName(Op& op, const char* name, std::size_t length)
+{
+    op.fields |= Field::Name;
+    op.name = _encoder.name(name, length);
+}
+
+void ReplayAnalyzer::setName2(Op& op, const char* name, std::size_t length)
+{
+    op.fields |= Field::Name2;
+    op.name2 = _encoder.name(name, length);
+}
+
+template <typename Res>
+void ReplayAnalyzer::setStatus(Op& op, const Res* res)
+{
+    // Procedure without results has failed on RPC level
+    if (res)
+    {
+        op.fields |= Field::Status;
+        op.status = static_cast<uint32_t>(res->status);
+    }
+}
+
+void ReplayAnalyzer::commit(const Op& op)
+{
+    _encoder.op(op);
+    if (_encoder.buffer().size() >= _bufferSize)
+    {
+        _writer.submit(_encoder.buffer());
+    }
+}
+
+template <typename Res>
+void ReplayAnalyzer::object3(const RPCProcedure* proc, uint32_t procedure, const NFS3::nfs_fh3* handle, const Res* res)
+{
+    Op op = start(proc, Program::NFSv3, procedure);
+    if (handle)
+    {
+        setHandle(op, *handle);
+    }
+    setStatus(op, res);
+    commit(op);
+}
+
+template <typename Res>
+void ReplayAnalyzer::entry3(const RPCProcedure* proc, uint32_t procedure, const NFS3::diropargs3* entry, const Res* res)
+{
+    Op op = start(proc, Program::NFSv3, procedure);
+    if (entry)
+    {
+        setHandle(op, entry->dir);
+        setName(op, entry->name, strlen(entry->name));
+    }
+    setStatus(op, res);
+    commit(op);
+}
+
+template <typename Res>
+void ReplayAnalyzer::range3(const RPCProcedure* proc, uint32_t procedure, const NFS3::nfs_fh3* handle, uint64_t offset, uint32_t count, const Res* res)
+{
+    Op op = start(proc, Program::NFSv3, procedure);
+    if (handle)
+    {
+        setHandle(op, *handle);
+        op.fields |= Field::Offset | Field::Count;
+        op.offset = offset;
+        op.count = count;
+    }
+    setStatus(op, res);
+    commit(op);
+}
+
+uint32_t ReplayAnalyzer::intern(const FileHandle& handle)
+{
+    return _encoder.handle(reinterpret_cast<const char*>(handle.data), handle.length);
+}
+
+template <typename Res>
+void ReplayAnalyzer::object4(const RPCProcedure* proc, Program program, uint32_t procedure, const Res* res)
+{
+    Op op = start4(proc, program, procedure);
+    setStatus(op, res);
+    commit(op);
+}
+
+template <typename Res>
+void ReplayAnalyzer::entry4(const RPCProcedure* proc, Program program, uint32_t procedure, const char* name, std::size_t length, const Res* res)
+{
+    Op op = start4(proc, program, procedure);
+    setName(op, name, length);
+    setStatus(op, res);
+    commit(op);
+}
+
+template <typename Res>
+void ReplayAnalyzer::range4(const RPCProcedure* proc, Program program, uint32_t procedure, uint64_t offset, uint32_t count, const Res* res)
+{
+    Op op = start4(proc, program, procedure);
+    op.fields |= Field::Offset | Field::Count;
+    op.offset = offset;
+    op.count = count;
+    setStatus(op, res);
+    commit(op);
+}
+
+template <typename Args, typename Res>
+void ReplayAnalyzer::link4(const RPCProcedure* proc, Program program, const Args* args, const Res* res)
+{
+    // LINK makes saved file handle (object) a new entry of current one (directory)
+    Op op = start(proc, program, ProcEnumNFS4::LINK);
+    if (_handles.saved_known())
+    {
+        op.fields |= Field::Handle;
+        op.handle = intern(_handles.saved());
+    }
+    if (_handles.known())
+    {
+        op.fields |= Field::Handle2;
+        op.handle2 = intern(_handles.current());
+    }
+    if (args)
+    {
+        setName2(op, args->newname.utf8string_val, args->newname.utf8string_len);
+    }
+    setStatus(op, res);
+    commit(op);
+}
+
+template <typename Args, typename Res>
+void ReplayAnalyzer::rename4(const RPCProcedure* proc, Program program, const Args* args, const Res* res)
+{
+    // RENAME moves entry of saved file handle to current one
+    Op op = start(proc, program, ProcEnumNFS4::RENAME);
+    if (_handles.saved_known())
+    {
+        op.fields |= Field::Handle;
+        op.handle = intern(_handles.saved());
+    }
+    if (_handles.known())
+    {
+        op.fields |= Field::Handle2;
+        op.handle2 = intern(_handles.current());
+    }
+    if (args)
+    {
+        setName(op, args->oldname.utf8string_val, args->oldname.utf8string_len);
+        setName2(op, args->newname.utf8string_val, args->newname.utf8string_len);
+    }
+    setStatus(op, res);
+    commit(op);
+}
+//------------------------------------------------------------------------------
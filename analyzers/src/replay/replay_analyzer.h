@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer writing NFS operations to workload replay trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef REPLAY_ANALYZER_H
+#define REPLAY_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <string>
+
+#include "api/ianalyzer.h"
+#include "common/compound_handles.h"
+#include "replay_encoder.h"
+#include "replay_writer.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer writing NFS operations to workload replay trace
+/*!
+ * Each NFSv3 procedure and each NFSv4.x operation which a replay tool would
+ * send is written as an op of the compact binary trace described in
+ * replay_format.h. NFSv4.x operations carry no file handle, so the current
+ * and saved file handles of COMPOUND are tracked from PUTFH, GETFH, SAVEFH
+ * and RESTOREFH operations. Records are encoded into a buffer which is
+ * written to file by a background thread.
+ */
+class ReplayAnalyzer : public IAnalyzer
+{
+public:
+    ReplayAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param path Path of trace file to create
+     * \param bufferSize Size of buffer passed to writing thread, bytes
+     * \param out Stream to report to
+     */
+    ReplayAnalyzer(const std::string& path, std::size_t bufferSize, std::ostream& out = std::cout);
+    ReplayAnalyzer(const ReplayAnalyzer&) = delete;
+    ReplayAnalyzer& operator=(const ReplayAnalyzer&) = delete;
+    ~ReplayAnalyzer();
+
+    // NFSv3 procedures
+
+    void null(const RPCProcedure* proc,
+              const struct NFS3::NULL3args* args,
+              const struct NFS3::NULL3res* res) override final;
+    void getattr3(const RPCProcedure* proc,
+                  const struct NFS3::GETATTR3args* args,
+                  const struct NFS3::GETATTR3res* res) override final;
+    void setattr3(const RPCProcedure* proc,
+                  const struct NFS3::SETATTR3args* args,
+                  const struct NFS3::SETATTR3res* res) override final;
+    void lookup3(const RPCProcedure* proc,
+                 const struct NFS3::LOOKUP3args* args,
+                 const struct NFS3::LOOKUP3res* res) override final;
+    void access3(const RPCProcedure* proc,
+                 const struct NFS3::ACCESS3args* args,
+                 const struct NFS3::ACCESS3res* res) override final;
+    void readlink3(const RPCProcedure* proc,
+                   const struct NFS3::READLINK3args* args,
+                   const struct NFS3::READLINK3res* res) override final;
+    void read3(const RPCProcedure* proc,
+               const struct NFS3::READ3args* args,
+               const struct NFS3::READ3res* res) override final;
+    void write3(const RPCProcedure* proc,
+                const struct NFS3::WRITE3args* args,
+                const struct NFS3::WRITE3res* res) override final;
+    void create3(const RPCProcedure* proc,
+                 const struct NFS3::CREATE3args* args,
+                 const struct NFS3::CREATE3res* res) override final;
+    void mkdir3(const RPCProcedure* proc,
+                const struct NFS3::MKDIR3args* args,
+                const struct NFS3::MKDIR3res* res) override final;
+    void symlink3(const RPCProcedure* proc,
+                  const struct NFS3::SYMLINK3args* args,
+                  const struct NFS3::SYMLINK3res* res) override final;
+    void mknod3(const RPCProcedure* proc,
+                const struct NFS3::MKNOD3args* args,
+                const struct NFS3::MKNOD3res* res) override final;
+    void remove3(const RPCProcedure* proc,
+                 const struct NFS3::REMOVE3args* args,
+                 const struct NFS3::REMOVE3res* res) override final;
+    void rmdir3(const RPCProcedure* proc,
+                const struct NFS3::RMDIR3args* args,
+                const struct NFS3::RMDIR3res* res) override final;
+    void rename3(const RPCProcedure* proc,
+                 const struct NFS3::RENAME3args* args,
+                 const struct NFS3::RENAME3res* res) override final;
+    void link3(const RPCProcedure* proc,
+               const struct NFS3::LINK3args* args,
+               const struct NFS3::LINK3res* res) override final;
+    void readdir3(const RPCProcedure* proc,
+                  const struct NFS3::READDIR3args* args,
+                  const struct NFS3::READDIR3res* res) override final;
+    void readdirplus3(const RPCProcedure* proc,
+                      const struct NFS3::READDIRPLUS3args* args,
+                      const struct NFS3::READDIRPLUS3res* res) override final;
+    void fsstat3(const RPCProcedure* proc,
+                 const struct NFS3::FSSTAT3args* args,
+                 const struct NFS3::FSSTAT3res* res) override final;
+    void fsinfo3(const RPCProcedure* proc,
+                 const struct NFS3::FSINFO3args* args,
+                 const struct NFS3::FSINFO3res* res) override final;
+    void pathconf3(const RPCProcedure* proc,
+                   const struct NFS3::PATHCONF3args* args,
+                   const struct NFS3::PATHCONF3res* res) override final;
+    void commit3(const RPCProcedure* proc,
+                 const struct NFS3::COMMIT3args* args,
+                 const struct NFS3::COMMIT3res* res) override final;
+
+    // NFSv4.0 procedures and operations
+
+    void compound4(const RPCProcedure* proc,
+                   const struct NFS4::COMPOUND4args* args,
+                   const struct NFS4::COMPOUND4res* res) override final;
+    void putfh40(const RPCProcedure* proc,
+                 const struct NFS4::PUTFH4args* args,
+                 const struct NFS4::PUTFH4res* res) override final;
+    void getfh40(const RPCProcedure* proc,
+                 const struct NFS4::GETFH4res* res) override final;
+    void putrootfh40(const RPCProcedure* proc,
+                     const struct NFS4::PUTROOTFH4res* res) override final;
+    void putpubfh40(const RPCProcedure* proc,
+                    const struct NFS4::PUTPUBFH4res* res) override final;
+    void savefh40(const RPCProcedure* proc,
+                  const struct NFS4::SAVEFH4res* res) override final;
+    void restorefh40(const RPCProcedure* proc,
+                     const struct NFS4::RESTOREFH4res* res) override final;
+    void access40(const RPCProcedure* proc,
+                  const struct NFS4::ACCESS4args* args,
+                  const struct NFS4::ACCESS4res* res) override final;
+    void close40(const RPCProcedure* proc,
+                 const struct NFS4::CLOSE4args* args,
+                 const struct NFS4::CLOSE4res* res) override final;
+    void commit40(const RPCProcedure* proc,
+                  const struct NFS4::COMMIT4args* args,
+                  const struct NFS4::COMMIT4res* res) override final;
+    void create40(const RPCProcedure* proc,
+                  const struct NFS4::CREATE4args* args,
+                  const struct NFS4::CREATE4res* res) override final;
+    void getattr40(const RPCProcedure* proc,
+                   const struct NFS4::GETATTR4args* args,
+                   const struct NFS4::GETATTR4res* res) override final;
+    void link40(const RPCProcedure* proc,
+                const struct NFS4::LINK4args* args,
+                const struct NFS4::LINK4res* res) override final;
+    void lookup40(const RPCProcedure* proc,
+                  const struct NFS4::LOOKUP4args* args,
+                  const struct NFS4::LOOKUP4res* res) override final;
+    void lookupp40(const RPCProcedure* proc,
+                   const struct NFS4::LOOKUPP4res* res) override final;
+    void open40(const RPCProcedure* proc,
+                const struct NFS4::OPEN4args* args,
+                const struct NFS4::OPEN4res* res) override final;
+    void read40(const RPCProcedure* proc,
+                const struct NFS4::READ4args* args,
+                const struct NFS4::READ4res* res) override final;
+    void readdir40(const RPCProcedure* proc,
+                   const struct NFS4::READDIR4args* args,
+                   const struct NFS4::READDIR4res* res) override final;
+    void readlink40(const RPCProcedure* proc,
+                    const struct NFS4::READLINK4res* res) override final;
+    void remove40(const RPCProcedure* proc,
+                  const struct NFS4::REMOVE4args* args,
+                  const struct NFS4::REMOVE4res* res) override final;
+    void rename40(const RPCProcedure* proc,
+                  const struct NFS4::RENAME4args* args,
+                  const struct NFS4::RENAME4res* res) override final;
+    void setattr40(const RPCProcedure* proc,
+                   const struct NFS4::SETATTR4args* args,
+                   const struct NFS4::SETATTR4res* res) override final;
+    void write40(const RPCProcedure* proc,
+                 const struct NFS4::WRITE4args* args,
+                 const struct NFS4::WRITE4res* res) override final;
+
+    // NFSv4.1 procedures and operations
+
+    void compound41(const RPCProcedure* proc,
+                    const struct NFS41::COMPOUND4args* args,
+                    const struct NFS41::COMPOUND4res* res) override final;
+    void putfh41(const RPCProcedure* proc,
+                 const struct NFS41::PUTFH4args* args,
+                 const struct NFS41::PUTFH4res* res) override final;
+    void getfh41(const RPCProcedure* proc,
+                 const struct NFS41::GETFH4res* res) override final;
+    void putrootfh41(const RPCProcedure* proc,
+                     const struct NFS41::PUTROOTFH4res* res) override final;
+    void putpubfh41(const RPCProcedure* proc,
+                    const struct NFS41::PUTPUBFH4res* res) override final;
+    void savefh41(const RPCProcedure* proc,
+                  const struct NFS41::SAVEFH4res* res) override final;
+    void restorefh41(const RPCProcedure* proc,
+                     const struct NFS41::RESTOREFH4res* res) override final;
+    void access41(const RPCProcedure* proc,
+                  const struct NFS41::ACCESS4args* args,
+                  const struct NFS41::ACCESS4res* res) override final;
+    void close41(const RPCProcedure* proc,
+                 const struct NFS41::CLOSE4args* args,
+                 const struct NFS41::CLOSE4res* res) override final;
+    void commit41(const RPCProcedure* proc,
+                  const struct NFS41::COMMIT4args* args,
+                  const struct NFS41::COMMIT4res* res) override final;
+    void create41(const RPCProcedure* proc,
+                  const struct NFS41::CREATE4args* args,
+                  const struct NFS41::CREATE4res* res) override final;
+    void getattr41(const RPCProcedure* proc,
+                   const struct NFS41::GETATTR4args* args,
+                   const struct NFS41::GETATTR4res* res) override final;
+    void link41(const RPCProcedure* proc,
+                const struct NFS41::LINK4args* args,
+                const struct NFS41::LINK4res* res) override final;
+    void lookup41(const RPCProcedure* proc,
+                  const struct NFS41::LOOKUP4args* args,
+                  const struct NFS41::LOOKUP4res* res) override final;
+    void lookupp41(const RPCProcedure* proc,
+                   const struct NFS41::LOOKUPP4res* res) override final;
+    void open41(const RPCProcedure* proc,
+                const struct NFS41::OPEN4args* args,
+                const struct NFS41::OPEN4res* res) override final;
+    void read41(const RPCProcedure* proc,
+                const struct NFS41::READ4args* args,
+                const struct NFS41::READ4res* res) override final;
+    void readdir41(const RPCProcedure* proc,
+                   const struct NFS41::READDIR4args* args,
+                   const struct NFS41::READDIR4res* res) override final;
+    void readlink41(const RPCProcedure* proc,
+                    const struct NFS41::READLINK4res* res) override final;
+    void remove41(const RPCProcedure* proc,
+                  const struct NFS41::REMOVE4args* args,
+                  const struct NFS41::REMOVE4res* res) override final;
+    void rename41(const RPCProcedure* proc,
+                  const struct NFS41::RENAME4args* args,
+                  const struct NFS41::RENAME4res* res) override final;
+    void setattr41(const RPCProcedure* proc,
+                   const struct NFS41::SETATTR4args* args,
+                   const struct NFS41::SETATTR4res* res) override final;
+    void write41(const RPCProcedure* proc,
+                 const struct NFS41::WRITE4args* args,
+                 const struct NFS41::WRITE4res* res) override final;
+
+    void flush_statistics() override final;
+private:
+    Replay::Op start(const RPCProcedure* proc, Replay::Program program, uint32_t procedure);
+    Replay::Op start4(const RPCProcedure* proc, Replay::Program program, uint32_t procedure);
+    void setHandle(Replay::Op& op, const NFS3::nfs_fh3& handle);
+    void setHandle2(Replay::Op& op, const NFS3::nfs_fh3& handle);
+    void setName(Replay::Op& op, const char* name, std::size_t length);
+    void setName2(Replay::Op& op, const char* name, std::size_t length);
+    template <typename Res>
+    void setStatus(Replay::Op& op, const Res* res);
+    void commit(const Replay::Op& op);
+
+    template <typename Res>
+    void object3(const RPCProcedure* proc, uint32_t procedure, const NFS3::nfs_fh3* handle, const Res* res);
+    template <typename Res>
+    void entry3(const RPCProcedure* proc, uint32_t procedure, const NFS3::diropargs3* entry, const Res* res);
+    template <typename Res>
+    void range3(const RPCProcedure* proc, uint32_t procedure, const NFS3::nfs_fh3* handle, uint64_t offset, uint32_t count, const Res* res);
+
+    uint32_t intern(const FileHandle& handle);
+    template <typename Res>
+    void object4(const RPCProcedure* proc, Replay::Program program, uint32_t procedure, const Res* res);
+    template <typename Res>
+    void entry4(const RPCProcedure* proc, Replay::Program program, uint32_t procedure, const char* name, std::size_t length, const Res* res);
+    template <typename Res>
+    void range4(const RPCProcedure* proc, Replay::Program program, uint32_t procedure, uint64_t offset, uint32_t count, const Res* res);
+    template <typename Args, typename Res>
+    void link4(const RPCProcedure* proc, Replay::Program program, const Args* args, const Res* res);
+    template <typename Args, typename Res>
+    void rename4(const RPCProcedure* proc, Replay::Program program, const Args* args, const Res* res);
+
+    ReplayEncoder _encoder;
+    ReplayWriter _writer;
+    std::size_t _bufferSize;
+    std::ostream& _out;
+    CompoundHandles _handles; // current and saved file handles of NFSv4.x COMPOUND
+};
+//------------------------------------------------------------------------------
+#endif//REPLAY_ANALYZER_H
+//------------------------------------------------------------------------------
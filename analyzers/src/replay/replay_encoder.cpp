@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Encoder of workload replay trace records
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+
+#include "replay_encoder.h"
+//------------------------------------------------------------------------------
+using namespace Replay;
+
+ReplayEncoder::ReplayEncoder() :
+    _buffer{Magic, Magic + MagicSize},
+    _clients{},
+    _handles{},
+    _names{},
+    _lastTimestamp{0U},
+    _ops{0U}
+{
+}
+
+uint32_t ReplayEncoder::client(const uint8_t* address, std::size_t length)
+{
+    auto inserted = _clients.emplace(std::string{reinterpret_cast<const char*>(address), length}, _clients.size());
+    if (inserted.second)
+    {
+        uint8_t payload[1U + 16U];
+        payload[0] = length == 4U ? 4U : 6U;
+        std::copy(address, address + std::min<std::size_t>(length, 16U), payload + 1);
+        record(Record::Client, payload, 1U + std::min<std::size_t>(length, 16U));
+    }
+    return inserted.first->second;
+}
+
+uint32_t ReplayEncoder::handle(const char* data, std::size_t length)
+{
+    auto inserted = _handles.emplace(FileHandle{data, length}, _handles.size());
+    if (inserted.second)
+    {
+        record(Record::Handle, inserted.first->first.data, inserted.first->first.length);
+    }
+    return inserted.first->second;
+}
+
+uint32_t ReplayEncoder::name(const char* data, std::size_t length)
+{
+    auto inserted = _names.emplace(std::string{data, length}, _names.size());
+    if (inserted.second)
+    {
+        record(Record::Name, data, length);
+    }
+    return inserted.first->second;
+}
+
+void ReplayEncoder::op(const Op& op)
+{
+    uint8_t payload[2U + 12U * MaxVarintSize];
+    uint8_t* out = payload;
+
+    *out++ = static_cast<uint8_t>(Record::Op);
+    *out++ = op.fields;
+    out = putVarint(out, zigzag(static_cast<int64_t>(op.timestamp - _lastTimestamp)));
+    out = putVarint(out, op.client);
+    *out++ = static_cast<uint8_t>(op.program);
+    out = putVarint(out, op.procedure);
+    out = putVarint(out, op.latency);
+    if (op.fields & Field::Status)
+    {
+        out = putVarint(out, op.status);
+    }
+    if (op.fields & Field::Handle)
+    {
+        out = putVarint(out, op.handle);
+    }
+    if (op.fields & Field::Name)
+    {
+        out = putVarint(out, op.name);
+    }
+    if (op.fields & Field::Offset)
+    {
+        out = putVarint(out, op.offset);
+    }
+    if (op.fields & Field::Count)
+    {
+        out = putVarint(out, op.count);
+    }
+    if (op.fields & Field::Handle2)
+    {
+        out = putVarint(out, op.handle2);
+    }
+    if (op.fields & Field::Name2)
+    {
+        out = putVarint(out, op.name2);
+    }
+    _lastTimestamp = op.timestamp;
+    ++_ops;
+
+    uint8_t length[MaxVarintSize];
+    _buffer.insert(_buffer.end(), length, putVarint(length, out - payload));
+    _buffer.insert(_buffer.end(), payload, out);
+}
+
+void ReplayEncoder::record(Record type, const void* data, std::size_t length)
+{
+    uint8_t prefix[MaxVarintSize + 1U];
+    uint8_t* out = putVarint(prefix, length + 1U);
+    *out++ = static_cast<uint8_t>(type);
+    _buffer.insert(_buffer.end(), prefix, out);
+    _buffer.insert(_buffer.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + length);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,76 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Encoder of workload replay trace records
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef REPLAY_ENCODER_H
+#define REPLAY_ENCODER_H
+//------------------------------------------------------------------------------
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/file_handle.h"
+#include "replay_format.h"
+//------------------------------------------------------------------------------
+//! Encoder of replay trace records to memory buffer
+/*!
+ * Interns clients, file handles and names: a dictionary record is emitted
+ * once for each of them, so an op takes about 20 bytes. Dictionaries are
+ * never shrunk since the whole trace refers to them.
+ */
+class ReplayEncoder
+{
+public:
+    //! Constructs encoder, buffer starts with file magic
+    ReplayEncoder();
+    ReplayEncoder(const ReplayEncoder&) = delete;
+    ReplayEncoder& operator=(const ReplayEncoder&) = delete;
+
+    //! Returns index of client, IPv4 or IPv6 address in network byte order
+    uint32_t client(const uint8_t* address, std::size_t length);
+    //! Returns index of file handle
+    uint32_t handle(const char* data, std::size_t length);
+    //! Returns index of name
+    uint32_t name(const char* data, std::size_t length);
+    //! Appends op record
+    void op(const Replay::Op& op);
+
+    //! Returns encoded records, client code may take them out and clear buffer
+    inline std::vector<uint8_t>& buffer()
+    {
+        return _buffer;
+    }
+    inline uint64_t opsAmount() const
+    {
+        return _ops;
+    }
+private:
+    void record(Replay::Record type, const void* data, std::size_t length);
+
+    std::vector<uint8_t> _buffer;
+    std::unordered_map<std::string, uint32_t> _clients;
+    std::unordered_map<FileHandle, uint32_t, FileHandleHash> _handles;
+    std::unordered_map<std::string, uint32_t> _names;
+    uint64_t _lastTimestamp;
+    uint64_t _ops;
+};
+//------------------------------------------------------------------------------
+#endif//REPLAY_ENCODER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,154 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Binary format of workload replay trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef REPLAY_FORMAT_H
+#define REPLAY_FORMAT_H
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+//------------------------------------------------------------------------------
+//! Binary format of workload replay trace
+/*!
+ * File starts with Magic followed by records. Each record is prefixed with
+ * its length and starts with its type:
+ *
+ *   record  := length:varint type:u8 payload
+ *   Client  := family:u8 address:4|16 bytes
+ *   Handle  := file handle bytes up to the end of record
+ *   Name    := name bytes up to the end of record
+ *   Op      := flags:u8 delta:zigzag client program:u8 procedure latency
+ *              [status] [handle] [name] [offset] [count] [handle2] [name2]
+ *
+ * All integers are LEB128 varints. Clients, file handles and names are
+ * interned: a dictionary record precedes the first op referring to it and
+ * ops refer to entries by index (order of definition from 0). Delta is the
+ * difference of call timestamps of an op and the previous op in microseconds,
+ * the first op stores absolute timestamp. Optional fields of an op are
+ * present when their bit is set in flags. Readers skip records of unknown
+ * types and unknown trailing fields of ops.
+ */
+namespace Replay
+{
+
+constexpr std::size_t MagicSize = 8U;
+constexpr uint8_t Magic[MagicSize] = {'N', 'S', 'T', 'R', 'P', 'L', 'Y', '1'};
+
+enum class Record : uint8_t
+{
+    Client = 1,
+    Handle = 2,
+    Name   = 3,
+    Op     = 4
+};
+
+enum class Program : uint8_t
+{
+    NFSv3  = 3,
+    NFSv40 = 40,
+    NFSv41 = 41
+};
+
+//! Flags of optional fields of op
+enum Field : uint8_t
+{
+    Status  = 0x01,
+    Handle  = 0x02,
+    Name    = 0x04,
+    Offset  = 0x08,
+    Count   = 0x10,
+    Handle2 = 0x20,
+    Name2   = 0x40
+};
+
+//! Operation of trace
+/*!
+ * Procedure is NFSv3 procedure or NFSv4.x operation number. Handle and Name
+ * are the object of the operation (directory and entry name for directory
+ * operations), Handle2 and Name2 are the target of RENAME and LINK.
+ */
+struct Op
+{
+    uint64_t timestamp; // call time, microseconds since Epoch
+    uint32_t client;
+    Program  program;
+    uint32_t procedure;
+    uint32_t latency;   // microseconds
+    uint8_t  fields;    // set of Field flags
+    uint32_t status;
+    uint32_t handle;
+    uint32_t name;
+    uint64_t offset;
+    uint32_t count;
+    uint32_t handle2;
+    uint32_t name2;
+};
+
+//! Max length of encoded varint
+constexpr std::size_t MaxVarintSize = 10U;
+
+//! Encodes varint to buffer which has at least MaxVarintSize bytes
+/*!
+ * \return Pointer past the last written byte
+ */
+inline uint8_t* putVarint(uint8_t* out, uint64_t value)
+{
+    while (value >= 0x80U)
+    {
+        *out++ = static_cast<uint8_t>(value | 0x80U);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+//! Decodes varint
+/*!
+ * \return Pointer past the last read byte or nullptr if data is truncated
+ */
+inline const uint8_t* getVarint(const uint8_t* in, const uint8_t* end, uint64_t& value)
+{
+    value = 0U;
+    for (unsigned shift = 0U; in != end && shift < 64U; shift += 7U)
+    {
+        const uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7fU) << shift;
+        if ((byte & 0x80U) == 0U)
+        {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+inline uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1U);
+}
+
+} // namespace Replay
+//------------------------------------------------------------------------------
+#endif//REPLAY_FORMAT_H
+//------------------------------------------------------------------------------
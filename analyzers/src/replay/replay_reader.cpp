@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Reader of workload replay trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "replay_reader.h"
+//------------------------------------------------------------------------------
+using namespace Replay;
+
+namespace
+{
+
+constexpr std::size_t BlockSize = 1024U * 1024U;
+
+const uint8_t* field(const uint8_t* in, const uint8_t* end, uint64_t& value)
+{
+    in = getVarint(in, end, value);
+    if (!in)
+    {
+        throw std::runtime_error{"Truncated op in replay trace"};
+    }
+    return in;
+}
+
+const std::string& entry(const std::vector<std::string>& dictionary, uint32_t index, const char* kind)
+{
+    if (index >= dictionary.size())
+    {
+        throw std::out_of_range{std::string{"Unknown "} + kind + " index in replay trace: " + std::to_string(index)};
+    }
+    return dictionary[index];
+}
+
+} // namespace
+
+ReplayReader::ReplayReader(const std::string& path) :
+    _file{fopen(path.c_str(), "rb")},
+    _buffer(BlockSize),
+    _begin{0U},
+    _end{0U},
+    _lastTimestamp{0U},
+    _clients{},
+    _handles{},
+    _names{}
+{
+    if (!_file)
+    {
+        throw std::runtime_error{"Can't open replay trace " + path + ": " + strerror(errno)};
+    }
+    if (!fill(MagicSize) || memcmp(&_buffer[_begin], Magic, MagicSize) != 0)
+    {
+        fclose(_file);
+        throw std::runtime_error{path + " is not a replay trace"};
+    }
+    _begin += MagicSize;
+}
+
+ReplayReader::~ReplayReader()
+{
+    fclose(_file);
+}
+
+bool ReplayReader::next(Op& op)
+{
+    for (;;)
+    {
+        if (!fill(1U))
+        {
+            return false;
+        }
+        // Length prefix is complete or the file ends
+        fill(MaxVarintSize);
+        uint64_t length;
+        const uint8_t* data = &_buffer[_begin];
+        const uint8_t* payload = getVarint(data, data + (_end - _begin), length);
+        if (!payload || length == 0U || length > BlockSize)
+        {
+            throw std::runtime_error{"Malformed record length in replay trace"};
+        }
+        const std::size_t prefix = payload - data;
+        if (!fill(prefix + length))
+        {
+            throw std::runtime_error{"Truncated record in replay trace"};
+        }
+        payload = &_buffer[_begin + prefix];
+        const uint8_t* end = payload + length;
+        _begin += prefix + length;
+
+        switch (static_cast<Record>(*payload))
+        {
+        case Record::Client:
+            _clients.emplace_back(reinterpret_cast<const char*>(payload + 2), length > 2U ? length - 2U : 0U);
+            break;
+        case Record::Handle:
+            _handles.emplace_back(reinterpret_cast<const char*>(payload + 1), length - 1U);
+            break;
+        case Record::Name:
+            _names.emplace_back(reinterpret_cast<const char*>(payload + 1), length - 1U);
+            break;
+        case Record::Op:
+            decodeOp(payload + 1, end, op);
+            return true;
+        default:
+            break; // record of unknown type is skipped
+        }
+    }
+}
+
+const std::string& ReplayReader::client(uint32_t index) const
+{
+    return entry(_clients, index, "client");
+}
+
+const std::string& ReplayReader::handle(uint32_t index) const
+{
+    return entry(_handles, index, "file handle");
+}
+
+const std::string& ReplayReader::name(uint32_t index) const
+{
+    return entry(_names, index, "name");
+}
+
+bool ReplayReader::fill(std::size_t size)
+{
+    if (_end - _begin >= size)
+    {
+        return true;
+    }
+    // Move unread data to the beginning and read the rest of block
+    memmove(&_buffer[0], &_buffer[_begin], _end - _begin);
+    _end -= _begin;
+    _begin = 0U;
+    if (_buffer.size() < size)
+    {
+        _buffer.resize(size);
+    }
+    _end += fread(&_buffer[_end], 1, _buffer.size() - _end, _file);
+    return _end >= size;
+}
+
+void ReplayReader::decodeOp(const uint8_t* in, const uint8_t* end, Op& op)
+{
+    uint64_t value;
+    if (end - in < 2)
+    {
+        throw std::runtime_error{"Truncated op in replay trace"};
+    }
+    op = Op{};
+    op.fields = *in++;
+    in = field(in, end, value);
+    op.timestamp = _lastTimestamp + static_cast<uint64_t>(unzigzag(value));
+    _lastTimestamp = op.timestamp;
+    in = field(in, end, value);
+    op.client = static_cast<uint32_t>(value);
+    if (in == end)
+    {
+        throw std::runtime_error{"Truncated op in replay trace"};
+    }
+    op.program = static_cast<Program>(*in++);
+    in = field(in, end, value);
+    op.procedure = static_cast<uint32_t>(value);
+    in = field(in, end, value);
+    op.latency = static_cast<uint32_t>(value);
+    if (op.fields & Field::Status)
+    {
+        in = field(in, end, value);
+        op.status = static_cast<uint32_t>(value);
+    }
+    if (op.fields & Field::Handle)
+    {
+        in = field(in, end, value);
+        op.handle = static_cast<uint32_t>(value);
+    }
+    if (op.fields & Field::Name)
+    {
+        in = field(in, end, value);
+        op.name = static_cast<uint32_t>(value);
+    }
+    if (op.fields & Field::Offset)
+    {
+        in = field(in, end, op.offset);
+    }
+    if (op.fields & Field::Count)
+    {
+        in = field(in, end, value);
+        op.count = static_cast<uint32_t>(value);
+    }
+    if (op.fields & Field::Handle2)
+    {
+        in = field(in, end, value);
+        op.handle2 = static_cast<uint32_t>(value);
+    }
+    if (op.fields & Field::Name2)
+    {
+        field(in, end, value);
+        op.name2 = static_cast<uint32_t>(value);
+    }
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Reader of workload replay trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef REPLAY_READER_H
+#define REPLAY_READER_H
+//------------------------------------------------------------------------------
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "replay_format.h"
+//------------------------------------------------------------------------------
+//! Sequential reader of replay trace
+/*!
+ * Reads file by large blocks and resolves dictionary records, so client code
+ * sees ops only and looks up their clients, handles and names by index.
+ */
+class ReplayReader
+{
+public:
+    ReplayReader() = delete;
+    //! Opens trace and checks its magic
+    /*!
+     * \param path Path of trace file
+     * \throw std::runtime_error if file can not be opened or is not a trace
+     */
+    explicit ReplayReader(const std::string& path);
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+    ~ReplayReader();
+
+    //! Reads next op
+    /*!
+     * \param op Op to fill
+     * \return False at the end of trace
+     * \throw std::runtime_error if trace is truncated or malformed
+     */
+    bool next(Replay::Op& op);
+
+    //! Returns address of client, 4 or 16 bytes in network byte order
+    const std::string& client(uint32_t index) const;
+    //! Returns bytes of file handle
+    const std::string& handle(uint32_t index) const;
+    const std::string& name(uint32_t index) const;
+
+    inline std::size_t clientsAmount() const
+    {
+        return _clients.size();
+    }
+    inline std::size_t handlesAmount() const
+    {
+        return _handles.size();
+    }
+    inline std::size_t namesAmount() const
+    {
+        return _names.size();
+    }
+private:
+    bool fill(std::size_t size);
+    void decodeOp(const uint8_t* in, const uint8_t* end, Replay::Op& op);
+
+    FILE* _file;
+    std::vector<uint8_t> _buffer;
+    std::size_t _begin; // position of unread data in buffer
+    std::size_t _end;   // end of data in buffer
+    uint64_t _lastTimestamp;
+    std::vector<std::string> _clients;
+    std::vector<std::string> _handles;
+    std::vector<std::string> _names;
+};
+//------------------------------------------------------------------------------
+#endif//REPLAY_READER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Double-buffered background writer of replay trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "replay_writer.h"
+//------------------------------------------------------------------------------
+ReplayWriter::ReplayWriter(const std::string& path) :
+    _file{fopen(path.c_str(), "wb")},
+    _mutex{},
+    _condition{},
+    _pending{},
+    _hasPending{false},
+    _stop{false},
+    _writtenBytes{0U},
+    _failed{false},
+    _thread{}
+{
+    if (!_file)
+    {
+        throw std::runtime_error{"Can't create replay trace " + path + ": " + strerror(errno)};
+    }
+    _thread = std::thread{&ReplayWriter::run, this};
+}
+
+ReplayWriter::~ReplayWriter()
+{
+    {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _stop = true;
+    }
+    _condition.notify_all();
+    _thread.join();
+    fclose(_file);
+}
+
+void ReplayWriter::submit(std::vector<uint8_t>& buffer)
+{
+    std::unique_lock<std::mutex> lock{_mutex};
+    _condition.wait(lock, [this]
+    {
+        return !_hasPending;
+    });
+    _pending.swap(buffer);
+    _hasPending = true;
+    lock.unlock();
+    _condition.notify_all();
+    buffer.clear();
+}
+
+void ReplayWriter::flush()
+{
+    std::unique_lock<std::mutex> lock{_mutex};
+    _condition.wait(lock, [this]
+    {
+        return !_hasPending;
+    });
+    if (fflush(_file) != 0)
+    {
+        _failed = true;
+    }
+}
+
+void ReplayWriter::run()
+{
+    std::unique_lock<std::mutex> lock{_mutex};
+    for (;;)
+    {
+        _condition.wait(lock, [this]
+        {
+            return _hasPending || _stop;
+        });
+        if (!_hasPending)
+        {
+            break;
+        }
+        // Pending buffer is not touched by client code until it is released
+        lock.unlock();
+        if (fwrite(_pending.data(), 1, _pending.size(), _file) == _pending.size())
+        {
+            _writtenBytes += _pending.size();
+        }
+        else
+        {
+            _failed = true;
+        }
+        _pending.clear();
+        lock.lock();
+        _hasPending = false;
+        _condition.notify_all();
+    }
+}
+//------------------------------------------------------------------------------
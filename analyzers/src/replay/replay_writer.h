@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Double-buffered background writer of replay trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef REPLAY_WRITER_H
+#define REPLAY_WRITER_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+//------------------------------------------------------------------------------
+//! Writer of buffers to file by background thread
+/*!
+ * There are two buffers: one is filled by client code while another one is
+ * written to file. Client code waits only if it fills its buffer before the
+ * previous one is written.
+ */
+class ReplayWriter
+{
+public:
+    ReplayWriter() = delete;
+    //! Creates file and starts writing thread
+    /*!
+     * \param path Path of file to create
+     * \throw std::runtime_error if file can not be created
+     */
+    explicit ReplayWriter(const std::string& path);
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+    //! Writes pending buffer, stops thread and closes file
+    ~ReplayWriter();
+
+    //! Passes filled buffer to writing thread
+    /*!
+     * \param buffer Buffer to write, gets replaced with empty one
+     */
+    void submit(std::vector<uint8_t>& buffer);
+    //! Waits until submitted buffer is written and flushes file
+    void flush();
+
+    inline uint64_t writtenBytes() const
+    {
+        return _writtenBytes.load(std::memory_order_relaxed);
+    }
+    inline bool failed() const
+    {
+        return _failed.load(std::memory_order_relaxed);
+    }
+private:
+    void run();
+
+    FILE* _file;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::vector<uint8_t> _pending;  // buffer passed to writing thread
+    bool _hasPending;
+    bool _stop;
+    std::atomic<uint64_t> _writtenBytes;
+    std::atomic<bool> _failed;      // some data was not written
+    std::thread _thread;
+};
+//------------------------------------------------------------------------------
+#endif//REPLAY_WRITER_H
+//------------------------------------------------------------------------------
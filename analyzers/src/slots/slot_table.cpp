@@ -0,0 +1,196 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Slot table of NFSv4.1 session
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+
+#include "slot_table.h"
+//------------------------------------------------------------------------------
+constexpr uint32_t SlotTable::MaxSlots;
+
+SlotTable::SlotTable(uint32_t size, uint64_t interval) :
+    _size{std::min(size, MaxSlots)},
+    _interval{std::max<uint64_t>(interval, 1U)},
+    _sequences(_size, 0U),
+    _requests(_size, 0U),
+    _requestsAmount{0U},
+    _retries{0U},
+    _misordered{0U},
+    _outOfTable{0U},
+    _errors{},
+    _maxSlot{0U},
+    _highestSlot{0U},
+    _maxHighestSlot{0U},
+    _hasResult{false},
+    _serverHighestSlot{0U},
+    _targetHighestSlot{0U},
+    _minTargetHighestSlot{0U},
+    _targetDecreases{0U},
+    _first{0U},
+    _last{0U},
+    _busy{0U},
+    _intervalIndex{0U},
+    _intervalBusy{0U},
+    _peakUtilization{0.0},
+    _exhausted{false},
+    _exhaustedSince{0U},
+    _exhaustedUntil{0U},
+    _exhaustions{0U},
+    _waitTime{0U}
+{
+}
+
+void SlotTable::add(const Request& request)
+{
+    const uint64_t reply = std::max(request.reply, request.call);
+    const uint32_t usable = usableSlots(); // limit known when request was sent
+    if (_requestsAmount == 0U)
+    {
+        _first = request.call;
+        _intervalIndex = request.call / _interval;
+    }
+    ++_requestsAmount;
+    _first = std::min(_first, request.call);
+    _last = std::max(_last, reply);
+
+    // Slot state
+    if (request.slot >= MaxSlots || (_size != 0U && request.slot >= _size))
+    {
+        ++_outOfTable;
+    }
+    else if (!request.failed)
+    {
+        if (request.slot >= _requests.size())
+        {
+            _sequences.resize(request.slot + 1U, 0U);
+            _requests.resize(request.slot + 1U, 0U);
+        }
+        if (_requests[request.slot] != 0U)
+        {
+            const uint32_t previous = _sequences[request.slot];
+            if (request.sequence == previous)
+            {
+                ++_retries;
+            }
+            else if (request.sequence != previous + 1U)
+            {
+                ++_misordered;
+            }
+        }
+        _sequences[request.slot] = request.sequence;
+        ++_requests[request.slot];
+        _maxSlot = std::max(_maxSlot, request.slot);
+    }
+    _highestSlot = request.highestSlot;
+    _maxHighestSlot = std::max(_maxHighestSlot, request.highestSlot);
+
+    if (request.hasResult)
+    {
+        if (!_hasResult)
+        {
+            _minTargetHighestSlot = request.targetHighestSlot;
+        }
+        else if (request.targetHighestSlot < _targetHighestSlot)
+        {
+            ++_targetDecreases;
+        }
+        _hasResult = true;
+        _serverHighestSlot = request.serverHighestSlot;
+        _targetHighestSlot = request.targetHighestSlot;
+        _minTargetHighestSlot = std::min(_minTargetHighestSlot, request.targetHighestSlot);
+    }
+
+    // Utilization
+    const uint64_t busy = reply - request.call;
+    _busy += busy;
+    const uint64_t index = request.call / _interval;
+    if (index > _intervalIndex)
+    {
+        closeInterval();
+        _intervalIndex = index;
+    }
+    _intervalBusy += busy; // late request of a closed interval goes to the current one
+
+    // Exhaustion of table
+    if (_exhausted && request.call > _exhaustedSince)
+    {
+        _waitTime += std::min(request.call, _exhaustedUntil) - _exhaustedSince;
+        _exhausted = false;
+    }
+    if (usable != 0U && request.slot + 1U >= usable)
+    {
+        ++_exhaustions;
+        _exhausted = true;
+        _exhaustedSince = request.call;
+        _exhaustedUntil = reply;
+    }
+}
+
+void SlotTable::addError(Error error)
+{
+    ++_errors[static_cast<std::size_t>(error)];
+}
+
+void SlotTable::finish()
+{
+    if (_requestsAmount != 0U)
+    {
+        closeInterval();
+    }
+    if (_exhausted)
+    {
+        _waitTime += _exhaustedUntil - _exhaustedSince;
+        _exhausted = false;
+    }
+}
+
+uint32_t SlotTable::size() const
+{
+    return _size != 0U ? _size : static_cast<uint32_t>(_requests.size());
+}
+
+double SlotTable::utilization() const
+{
+    const double capacity = static_cast<double>(_last - _first) * size();
+    return capacity > 0.0 ? std::min(static_cast<double>(_busy) / capacity, 1.0) : 0.0;
+}
+
+uint32_t SlotTable::usableSlots() const
+{
+    // Server tells the highest slot it wants client to use, otherwise
+    // negotiated size limits the table, 0 if nothing is known yet
+    if (_hasResult)
+    {
+        const uint32_t usable = std::min(_targetHighestSlot, _serverHighestSlot) + 1U;
+        return _size != 0U ? std::min(usable, _size) : usable;
+    }
+    return _size;
+}
+
+void SlotTable::closeInterval()
+{
+    const double capacity = static_cast<double>(_interval) * size();
+    if (capacity > 0.0)
+    {
+        _peakUtilization = std::max(_peakUtilization, std::min(static_cast<double>(_intervalBusy) / capacity, 1.0));
+    }
+    _intervalBusy = 0U;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,211 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Slot table of NFSv4.1 session
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef SLOT_TABLE_H
+#define SLOT_TABLE_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+//------------------------------------------------------------------------------
+//! Slot table of NFSv4.1 session and statistics of its use
+/*!
+ * State of each slot is kept in flat arrays indexed by slot id, so a SEQUENCE
+ * is accounted in O(1). Requests are reported when their reply is seen.
+ *
+ * Utilization is busy time of slots divided by time and size of the table,
+ * it is measured for the whole session and for each interval (busy time of
+ * a request is accounted to the interval of its call) to find peaks.
+ *
+ * Time spent waiting for a slot is estimated: clients take the lowest free
+ * slot, so a request sent on the highest usable slot (target highest slot of
+ * server or negotiated size of table) exhausts the table.
+ * The table stays exhausted until the next call on the session, but not
+ * longer than the reply to that request, which frees its slot.
+ *
+ * All times are in microseconds.
+ */
+class SlotTable
+{
+public:
+    //! Limit of table size, greater slot ids are counted as errors
+    static constexpr uint32_t MaxSlots = 4096U;
+
+    //! Errors of SEQUENCE
+    enum class Error
+    {
+        Delay,              //!< NFS4ERR_DELAY
+        SeqMisordered,      //!< NFS4ERR_SEQ_MISORDERED
+        BadSlot,            //!< NFS4ERR_BADSLOT
+        BadSession,         //!< NFS4ERR_BADSESSION or NFS4ERR_DEADSESSION
+        RetryUncachedRep,   //!< NFS4ERR_RETRY_UNCACHED_REP
+        SeqFalseRetry,      //!< NFS4ERR_SEQ_FALSE_RETRY
+        Other,
+        Amount
+    };
+
+    //! SEQUENCE operation
+    struct Request
+    {
+        uint64_t call;
+        uint64_t reply;
+        uint32_t slot;
+        uint32_t sequence;
+        uint32_t highestSlot;       //!< the highest slot known to client
+        bool failed;                //!< SEQUENCE returned an error, slot state is kept
+        bool hasResult;             //!< SEQUENCE succeeded and next fields are set
+        uint32_t serverHighestSlot; //!< the highest slot server accepts
+        uint32_t targetHighestSlot; //!< the highest slot server wants client to use
+    };
+
+    SlotTable() = delete;
+    //! Constructs empty table
+    /*!
+     * \param size Amount of slots negotiated by CREATE_SESSION, 0 if unknown
+     * \param interval Length of intervals to measure utilization peaks
+     */
+    SlotTable(uint32_t size, uint64_t interval);
+
+    //! Accounts successful or failed SEQUENCE
+    void add(const Request& request);
+    //! Accounts error of SEQUENCE
+    void addError(Error error);
+    //! Finishes the last interval
+    void finish();
+
+    //! Returns size of table, negotiated or the highest used slot + 1
+    uint32_t size() const;
+    //! Returns amount of requests on a slot
+    inline uint64_t slotRequests(uint32_t slot) const
+    {
+        return slot < _requests.size() ? _requests[slot] : 0U;
+    }
+    //! Returns utilization over the observed period, 0..1
+    double utilization() const;
+    //! Returns the highest utilization of an interval, 0..1
+    inline double peakUtilization() const
+    {
+        return _peakUtilization;
+    }
+
+    inline uint64_t requestsAmount() const
+    {
+        return _requestsAmount;
+    }
+    inline uint64_t retriesAmount() const
+    {
+        return _retries;
+    }
+    inline uint64_t misorderedAmount() const
+    {
+        return _misordered;
+    }
+    inline uint64_t outOfTableAmount() const
+    {
+        return _outOfTable;
+    }
+    inline uint64_t errorsAmount(Error error) const
+    {
+        return _errors[static_cast<std::size_t>(error)];
+    }
+    inline uint32_t maxSlot() const
+    {
+        return _maxSlot;
+    }
+    inline uint32_t highestSlot() const
+    {
+        return _highestSlot;
+    }
+    inline uint32_t maxHighestSlot() const
+    {
+        return _maxHighestSlot;
+    }
+    inline bool hasResult() const
+    {
+        return _hasResult;
+    }
+    inline uint32_t serverHighestSlot() const
+    {
+        return _serverHighestSlot;
+    }
+    inline uint32_t targetHighestSlot() const
+    {
+        return _targetHighestSlot;
+    }
+    inline uint32_t minTargetHighestSlot() const
+    {
+        return _minTargetHighestSlot;
+    }
+    inline uint64_t targetDecreasesAmount() const
+    {
+        return _targetDecreases;
+    }
+    //! Returns amount of requests which exhausted the table
+    inline uint64_t exhaustionsAmount() const
+    {
+        return _exhaustions;
+    }
+    //! Returns estimated time spent waiting for a free slot
+    inline uint64_t waitTime() const
+    {
+        return _waitTime;
+    }
+private:
+    uint32_t usableSlots() const;
+    void closeInterval();
+
+    uint32_t _size; // negotiated size or 0
+    uint64_t _interval;
+
+    // state of slots indexed by slot id
+    std::vector<uint32_t> _sequences;
+    std::vector<uint64_t> _requests;
+
+    uint64_t _requestsAmount;
+    uint64_t _retries;      // sequence id of a slot was repeated
+    uint64_t _misordered;   // sequence id of a slot was not the next one
+    uint64_t _outOfTable;   // slot id exceeds size of table
+    uint64_t _errors[static_cast<std::size_t>(Error::Amount)];
+
+    uint32_t _maxSlot;
+    uint32_t _highestSlot;
+    uint32_t _maxHighestSlot;
+    bool _hasResult;
+    uint32_t _serverHighestSlot;
+    uint32_t _targetHighestSlot;
+    uint32_t _minTargetHighestSlot;
+    uint64_t _targetDecreases;
+
+    uint64_t _first;        // the first call
+    uint64_t _last;         // the latest reply
+    uint64_t _busy;         // sum of busy time of slots
+    uint64_t _intervalIndex;
+    uint64_t _intervalBusy;
+    double _peakUtilization;
+
+    bool _exhausted;
+    uint64_t _exhaustedSince;
+    uint64_t _exhaustedUntil;
+    uint64_t _exhaustions;
+    uint64_t _waitTime;
+};
+//------------------------------------------------------------------------------
+#endif//SLOT_TABLE_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,275 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of slots of NFSv4.1 sessions
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <iomanip>
+
+#include <arpa/inet.h>
+
+#include "slots_analyzer.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+uint64_t microseconds(const struct timeval& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000U + static_cast<uint64_t>(time.tv_usec);
+}
+
+uint64_t fnv1a(const uint8_t* data, std::size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash ^ (hash >> 32);
+}
+
+std::string clientAddress(const Session& session)
+{
+    char buf[INET6_ADDRSTRLEN];
+    const void* address = session.ip_type == Session::IPType::v4
+                        ? static_cast<const void*>(&session.ip.v4.addr[Session::Source])
+                        : static_cast<const void*>(session.ip.v6.addr[Session::Source]);
+    if (!inet_ntop(session.ip_type == Session::IPType::v4 ? AF_INET : AF_INET6, address, buf, sizeof(buf)))
+    {
+        return std::string{};
+    }
+    return std::string{buf};
+}
+
+SlotTable::Error sequenceError(NFS41::nfsstat4 status)
+{
+    switch (status)
+    {
+    case NFS41::NFS4ERR_DELAY:
+        return SlotTable::Error::Delay;
+    case NFS41::NFS4ERR_SEQ_MISORDERED:
+        return SlotTable::Error::SeqMisordered;
+    case NFS41::NFS4ERR_BADSLOT:
+        return SlotTable::Error::BadSlot;
+    case NFS41::NFS4ERR_BADSESSION:
+    case NFS41::NFS4ERR_DEADSESSION:
+        return SlotTable::Error::BadSession;
+    case NFS41::NFS4ERR_RETRY_UNCACHED_REP:
+        return SlotTable::Error::RetryUncachedRep;
+    case NFS41::NFS4ERR_SEQ_FALSE_RETRY:
+        return SlotTable::Error::SeqFalseRetry;
+    default:
+        return SlotTable::Error::Other;
+    }
+}
+
+const char* const ErrorNames[] =
+{
+    "DELAY",
+    "SEQ_MISORDERED",
+    "BADSLOT",
+    "BADSESSION",
+    "RETRY_UNCACHED_REP",
+    "SEQ_FALSE_RETRY",
+    "other"
+};
+static_assert(sizeof(ErrorNames) / sizeof(ErrorNames[0]) == static_cast<std::size_t>(SlotTable::Error::Amount),
+              "names of all errors must be defined");
+
+} // namespace
+
+SlotsAnalyzer::SessionId::SessionId(const NFS41::sessionid4& id)
+{
+    memcpy(data, id, sizeof(data));
+}
+
+bool SlotsAnalyzer::SessionId::operator==(const SessionId& other) const
+{
+    return memcmp(data, other.data, sizeof(data)) == 0;
+}
+
+std::string SlotsAnalyzer::SessionId::str() const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string result;
+    for (char c : data)
+    {
+        result += digits[(static_cast<uint8_t>(c) >> 4) & 0x0f];
+        result += digits[static_cast<uint8_t>(c) & 0x0f];
+    }
+    return result;
+}
+
+std::size_t SlotsAnalyzer::SessionIdHash::operator()(const SessionId& id) const
+{
+    return static_cast<std::size_t>(fnv1a(reinterpret_cast<const uint8_t*>(id.data), sizeof(id.data)));
+}
+
+SlotsAnalyzer::SessionStat::SessionStat(const std::string& client, uint32_t size, uint64_t interval) :
+    client{client},
+    slots{size, interval},
+    destroyed{false}
+{
+}
+
+SlotsAnalyzer::SlotsAnalyzer(uint64_t interval, std::ostream& out) :
+    _interval{interval},
+    _out(out),
+    _sessions{}
+{
+}
+
+void SlotsAnalyzer::create_session41(const RPCProcedure* proc,
+                                     const struct NFS41::CREATE_SESSION4args*,
+                                     const struct NFS41::CREATE_SESSION4res* res)
+{
+    if (!res || res->csr_status != NFS41::NFS4_OK)
+    {
+        return;
+    }
+    const NFS41::CREATE_SESSION4resok& resok = res->CREATE_SESSION4res_u.csr_resok4;
+    const SessionId id{resok.csr_sessionid};
+    // Session id may be reused by server, statistics of the old session are replaced
+    _sessions.erase(id);
+    _sessions.emplace(id, SessionStat{clientAddress(*proc->session),
+                                      resok.csr_fore_chan_attrs.ca_maxrequests,
+                                      _interval});
+}
+
+void SlotsAnalyzer::destroy_session41(const RPCProcedure* proc,
+                                      const struct NFS41::DESTROY_SESSION4args* args,
+                                      const struct NFS41::DESTROY_SESSION4res* res)
+{
+    if (!args || !res || res->dsr_status != NFS41::NFS4_OK)
+    {
+        return;
+    }
+    findSession(proc, args->dsa_sessionid)->second.destroyed = true;
+}
+
+void SlotsAnalyzer::sequence41(const RPCProcedure* proc,
+                               const struct NFS41::SEQUENCE4args* args,
+                               const struct NFS41::SEQUENCE4res* res)
+{
+    if (!args)
+    {
+        return;
+    }
+    SlotTable& slots = findSession(proc, args->sa_sessionid)->second.slots;
+
+    SlotTable::Request request{};
+    request.call = microseconds(*proc->ctimestamp);
+    request.reply = microseconds(*proc->rtimestamp);
+    request.slot = args->sa_slotid;
+    request.sequence = args->sa_sequenceid;
+    request.highestSlot = args->sa_highest_slotid;
+    if (res)
+    {
+        if (res->sr_status == NFS41::NFS4_OK)
+        {
+            const NFS41::SEQUENCE4resok& resok = res->SEQUENCE4res_u.sr_resok4;
+            request.hasResult = true;
+            request.serverHighestSlot = resok.sr_highest_slotid;
+            request.targetHighestSlot = resok.sr_target_highest_slotid;
+        }
+        else
+        {
+            request.failed = true;
+            slots.addError(sequenceError(res->sr_status));
+        }
+    }
+    slots.add(request);
+}
+
+void SlotsAnalyzer::flush_statistics()
+{
+    _out << "### NFSv4.1 slot statistics ###" << std::endl;
+    for (auto& session : _sessions)
+    {
+        printSession(session.first, session.second);
+    }
+}
+
+SlotsAnalyzer::Sessions::iterator SlotsAnalyzer::findSession(const RPCProcedure* proc, const NFS41::sessionid4& id)
+{
+    const SessionId key{id};
+    auto found = _sessions.find(key);
+    if (found == _sessions.end())
+    {
+        // Session was created before capture, size of its table is unknown
+        found = _sessions.emplace(key, SessionStat{clientAddress(*proc->session), 0U, _interval}).first;
+    }
+    return found;
+}
+
+void SlotsAnalyzer::printSession(const SessionId& id, SessionStat& session)
+{
+    SlotTable& slots = session.slots;
+    slots.finish();
+
+    _out << "Session " << id.str() << " client " << session.client;
+    if (session.destroyed)
+    {
+        _out << " (destroyed)";
+    }
+    _out << std::endl;
+    if (slots.requestsAmount() == 0U)
+    {
+        return;
+    }
+
+    _out << "  requests " << slots.requestsAmount()
+         << " slots " << slots.size()
+         << " max used slot " << slots.maxSlot()
+         << " client highest slot " << slots.highestSlot()
+         << " (max " << slots.maxHighestSlot() << ")" << std::endl;
+    if (slots.hasResult())
+    {
+        _out << "  server highest slot " << slots.serverHighestSlot()
+             << " target highest slot " << slots.targetHighestSlot()
+             << " (min " << slots.minTargetHighestSlot()
+             << ", decreased " << slots.targetDecreasesAmount() << " times)" << std::endl;
+    }
+    _out << std::fixed << std::setprecision(2)
+         << "  utilization " << slots.utilization() * 100.0 << "%"
+         << " peak " << slots.peakUtilization() * 100.0 << "%"
+         << " table exhausted " << slots.exhaustionsAmount() << " times"
+         << " slot wait " << static_cast<double>(slots.waitTime()) / 1000.0 << " ms" << std::endl;
+    _out.unsetf(std::ios::floatfield);
+    _out << "  sequence retries " << slots.retriesAmount()
+         << " misordered " << slots.misorderedAmount()
+         << " out of table " << slots.outOfTableAmount() << std::endl;
+    _out << "  errors";
+    for (std::size_t i = 0; i < static_cast<std::size_t>(SlotTable::Error::Amount); ++i)
+    {
+        _out << ' ' << ErrorNames[i] << ' ' << slots.errorsAmount(static_cast<SlotTable::Error>(i));
+    }
+    _out << std::endl;
+    _out << "  requests per slot";
+    for (uint32_t slot = 0; slot < slots.size(); ++slot)
+    {
+        if (slots.slotRequests(slot) != 0U)
+        {
+            _out << ' ' << slot << ':' << slots.slotRequests(slot);
+        }
+    }
+    _out << std::endl;
+}
+//------------------------------------------------------------------------------
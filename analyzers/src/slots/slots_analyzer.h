@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of slots of NFSv4.1 sessions
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef SLOTS_ANALYZER_H
+#define SLOTS_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "api/ianalyzer.h"
+#include "slot_table.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer of slot tables of NFSv4.1 sessions
+/*!
+ * Follows CREATE_SESSION, SEQUENCE and DESTROY_SESSION operations and reports
+ * for each session the highest slots used by client and wanted by server,
+ * slot utilization, estimated time spent waiting for a free slot, sequence
+ * id anomalies and SEQUENCE errors. Sessions created before the capture are
+ * discovered by their SEQUENCE operations, their table size is unknown.
+ */
+class SlotsAnalyzer : public IAnalyzer
+{
+public:
+    SlotsAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param interval Length of intervals to measure utilization peaks in microseconds
+     * \param out Stream to report to
+     */
+    explicit SlotsAnalyzer(uint64_t interval, std::ostream& out = std::cout);
+    SlotsAnalyzer(const SlotsAnalyzer&) = delete;
+    SlotsAnalyzer& operator=(const SlotsAnalyzer&) = delete;
+
+    void create_session41(const RPCProcedure* proc,
+                          const struct NFS41::CREATE_SESSION4args* args,
+                          const struct NFS41::CREATE_SESSION4res* res) override final;
+    void destroy_session41(const RPCProcedure* proc,
+                           const struct NFS41::DESTROY_SESSION4args* args,
+                           const struct NFS41::DESTROY_SESSION4res* res) override final;
+    void sequence41(const RPCProcedure* proc,
+                    const struct NFS41::SEQUENCE4args* args,
+                    const struct NFS41::SEQUENCE4res* res) override final;
+
+    void flush_statistics() override final;
+private:
+    //! Identifier of NFSv4.1 session
+    struct SessionId
+    {
+        explicit SessionId(const NFS41::sessionid4& id);
+
+        bool operator==(const SessionId& other) const;
+        std::string str() const;
+
+        char data[NFS41::NFS4_SESSIONID_SIZE];
+    };
+
+    struct SessionIdHash
+    {
+        std::size_t operator()(const SessionId& id) const;
+    };
+
+    struct SessionStat
+    {
+        SessionStat(const std::string& client, uint32_t size, uint64_t interval);
+
+        std::string client;
+        SlotTable slots;
+        bool destroyed;
+    };
+
+    using Sessions = std::unordered_map<SessionId, SessionStat, SessionIdHash>;
+
+    Sessions::iterator findSession(const RPCProcedure* proc, const NFS41::sessionid4& id);
+    void printSession(const SessionId& id, SessionStat& session);
+
+    uint64_t _interval;
+    std::ostream& _out;
+    Sessions _sessions;
+};
+//------------------------------------------------------------------------------
+#endif//SLOTS_ANALYZER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Entry points of NFSv4.1 slots analyzer plugin
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "api/plugin_api.h" // include plugin development definitions
+#include "slots_analyzer.h"
+//------------------------------------------------------------------------------
+
+static constexpr uint64_t DefaultIntervalMs = 1000U;
+
+extern "C"
+{
+
+    const char* usage()
+    {
+        return "interval - Length of intervals in milliseconds to find peaks of slot utilization (default is 1000)";
+    }
+
+    IAnalyzer* create(const char* opts)
+    {
+        // Initializing plugin options with default values
+        uint64_t intervalMs = DefaultIntervalMs;
+        // Parising plugin options
+        enum
+        {
+            INTERVAL_SUBOPT_INDEX = 0
+        };
+        char intervalSubOptName[] = "interval";
+        char* const tokens[] =
+        {
+            intervalSubOptName,
+            NULL
+        };
+        std::size_t optsLen = strlen(opts);
+        std::vector<char> optsBuf{opts, opts + optsLen + 2};
+        char* optionp = &optsBuf[0];
+        char* valuep;
+        int optIndex;
+        while ((optIndex = getsubopt(&optionp, tokens, &valuep)) >= 0)
+        {
+            try
+            {
+                switch (optIndex)
+                {
+                case INTERVAL_SUBOPT_INDEX:
+                    intervalMs = std::stoull(valuep);
+                    break;
+                default:
+                    throw std::runtime_error{std::string{"Invalid suboption index: "} + std::to_string(optIndex)};
+                }
+            }
+            catch (std::logic_error& e)
+            {
+                throw std::runtime_error{std::string{"Invalid value provided for '"} + tokens[optIndex] + "' suboption"};
+            }
+        }
+        if (intervalMs == 0U)
+        {
+            throw std::runtime_error{"Value of 'interval' suboption must be positive"};
+        }
+        // Creating and returning plugin
+        return new SlotsAnalyzer{intervalMs * 1000U};
+    }
+
+    void destroy(IAnalyzer* instance)
+    {
+        delete instance;
+    }
+
+    NST_PLUGIN_ENTRY_POINTS (&usage, &create, &destroy, nullptr)
+
+} //extern "C"
+
+//------------------------------------------------------------------------------
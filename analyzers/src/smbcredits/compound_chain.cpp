@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Walk over SMB2 commands compounded in one message
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+
+#include "compound_chain.h"
+//------------------------------------------------------------------------------
+using NST::protocols::CIFSv2::RawMessageHeader;
+using NST::protocols::CIFSv2::SMBv2Commands;
+
+namespace
+{
+
+uint32_t charge(const RawMessageHeader& header)
+{
+    if (header.cmd_code == SMBv2Commands::CANCEL)
+    {
+        return 0U;
+    }
+    return std::max<uint32_t>(1U, static_cast<uint16_t>(header.CreditCharge));
+}
+
+uint32_t grant(const RawMessageHeader& header)
+{
+    return static_cast<uint16_t>(header.Credit);
+}
+
+template<typename Credits>
+CompoundChain walk(const RawMessageHeader* header, std::size_t size, Credits credits)
+{
+    const uint8_t* message = reinterpret_cast<const uint8_t*>(header);
+    CompoundChain chain{0U, 0U};
+    std::size_t offset = 0U;
+    for (;;)
+    {
+        const RawMessageHeader* current = reinterpret_cast<const RawMessageHeader*>(message + offset);
+        ++chain.length;
+        chain.credits += credits(*current);
+
+        const std::size_t next = static_cast<uint32_t>(current->nextCommand);
+        if (next < sizeof(RawMessageHeader) || size < sizeof(RawMessageHeader) || offset + next > size - sizeof(RawMessageHeader))
+        {
+            break;
+        }
+        offset += next;
+    }
+    return chain;
+}
+
+} // namespace
+
+CompoundChain chargedCredits(const RawMessageHeader* header, std::size_t size)
+{
+    return walk(header, size, &charge);
+}
+
+CompoundChain grantedCredits(const RawMessageHeader* header, std::size_t size)
+{
+    return walk(header, size, &grant);
+}
+//------------------------------------------------------------------------------
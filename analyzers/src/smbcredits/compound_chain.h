@@ -0,0 +1,59 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Walk over SMB2 commands compounded in one message
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef COMPOUND_CHAIN_H
+#define COMPOUND_CHAIN_H
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+
+#include "protocols/cifs2/cifs2.h"
+//------------------------------------------------------------------------------
+//! Summary of SMB2 commands compounded in one message
+/*!
+ * Each SMB2 header of a compounded message carries the offset of the next
+ * header, the last one has zero offset. The chain is walked within captured
+ * data only, so a truncated message gives a shorter chain.
+ */
+struct CompoundChain
+{
+    uint32_t length;    //!< Amount of commands in the chain
+    uint32_t credits;   //!< Credits charged by the requests or granted by the responses
+};
+
+//! Sums up credits charged by compounded requests
+/*!
+ * CreditCharge of zero is charged as one credit (SMB 2.0.2 dialect), CANCEL
+ * requests are not charged at all.
+ * \param header The first header of message
+ * \param size Captured size of message
+ */
+CompoundChain chargedCredits(const NST::protocols::CIFSv2::RawMessageHeader* header, std::size_t size);
+
+//! Sums up credits granted by compounded responses
+/*!
+ * \param header The first header of message
+ * \param size Captured size of message
+ */
+CompoundChain grantedCredits(const NST::protocols::CIFSv2::RawMessageHeader* header, std::size_t size);
+//------------------------------------------------------------------------------
+#endif//COMPOUND_CHAIN_H
+//------------------------------------------------------------------------------
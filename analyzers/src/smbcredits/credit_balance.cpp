@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Available SMB2 credits of a connection over time
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <limits>
+
+#include "credit_balance.h"
+//------------------------------------------------------------------------------
+CreditBalance::CreditBalance(uint64_t window) :
+    _window{window},
+    _calls{},
+    _replies{},
+    _now{0U},
+    _latestReply{0U},
+    _anchored{false},
+    _anchorTime{0U},
+    _balance{0U},
+    _maxBalance{0U},
+    _starved{false},
+    _starvedSince{0U},
+    _requests{0U},
+    _charged{0U},
+    _granted{0U},
+    _starvations{0U},
+    _starvedTime{0U},
+    _longestStarvation{0U},
+    _overdrawn{0U},
+    _late{0U}
+{
+}
+
+void CreditBalance::add(uint64_t call, uint32_t charge, uint64_t reply, uint32_t granted)
+{
+    reply = std::max(reply, call);
+    ++_requests;
+    _charged += charge;
+    _granted += granted;
+
+    if (call < _now)
+    {
+        // Sweep has already passed the call, charge it now
+        ++_late;
+        call = _now;
+        reply = std::max(reply, _now);
+    }
+    _calls.push(Event{call, charge});
+    _replies.push(Event{reply, granted});
+
+    _latestReply = std::max(_latestReply, reply);
+    if (_latestReply > _window)
+    {
+        sweep(_latestReply - _window);
+    }
+}
+
+void CreditBalance::anchor(uint64_t time, uint32_t credits)
+{
+    sweep(time);
+    _now = std::max(_now, time);
+    _anchored = true;
+    _anchorTime = _now;
+    _balance = credits;
+    _maxBalance = std::max(_maxBalance, credits);
+    _starved = credits == 0U;
+    _starvedSince = _now;
+}
+
+void CreditBalance::finish()
+{
+    sweep(std::numeric_limits<uint64_t>::max());
+    if (_starved)
+    {
+        // Close the window at the end of the trace
+        _starved = false;
+        ++_starvations;
+        _starvedTime += _now - _starvedSince;
+        _longestStarvation = std::max(_longestStarvation, _now - _starvedSince);
+    }
+}
+
+double CreditBalance::starvedShare() const
+{
+    if (!_anchored || _now <= _anchorTime)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(_starvedTime) / static_cast<double>(_now - _anchorTime);
+}
+
+void CreditBalance::sweep(uint64_t until)
+{
+    for (;;)
+    {
+        const bool hasCall = !_calls.empty() && _calls.top().time <= until;
+        const bool hasReply = !_replies.empty() && _replies.top().time <= until;
+        if (!hasCall && !hasReply)
+        {
+            break;
+        }
+        // On a tie credits are granted first, so a request sent right after
+        // a response is not reported as starved
+        if (hasReply && (!hasCall || _replies.top().time <= _calls.top().time))
+        {
+            grant(_replies.top());
+            _replies.pop();
+        }
+        else
+        {
+            consume(_calls.top());
+            _calls.pop();
+        }
+    }
+}
+
+void CreditBalance::consume(const Event& event)
+{
+    _now = std::max(_now, event.time);
+    if (!_anchored || event.credits == 0U)
+    {
+        return;
+    }
+    if (event.credits > _balance)
+    {
+        // Some grants were missed (e.g. lost responses), do not go below zero
+        ++_overdrawn;
+        _balance = 0U;
+    }
+    else
+    {
+        _balance -= event.credits;
+    }
+    if (_balance == 0U && !_starved)
+    {
+        _starved = true;
+        _starvedSince = _now;
+    }
+}
+
+void CreditBalance::grant(const Event& event)
+{
+    _now = std::max(_now, event.time);
+    if (!_anchored)
+    {
+        return;
+    }
+    _balance += event.credits;
+    _maxBalance = std::max(_maxBalance, _balance);
+    if (_starved && _balance != 0U)
+    {
+        const uint64_t duration = _now - _starvedSince;
+        _starved = false;
+        ++_starvations;
+        _starvedTime += duration;
+        _longestStarvation = std::max(_longestStarvation, duration);
+    }
+}
+//------------------------------------------------------------------------------
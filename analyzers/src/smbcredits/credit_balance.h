@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Available SMB2 credits of a connection over time
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef CREDIT_BALANCE_H
+#define CREDIT_BALANCE_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+//------------------------------------------------------------------------------
+//! Credits available to a SMB2 client over time
+/*!
+ * A request consumes its credit charge when it is sent and the response
+ * grants new credits when it is received, so the balance of a connection
+ * is replayed from call and reply timestamps. Requests are reported when
+ * their response is seen, therefore both kinds of events are pushed to
+ * min-heaps and swept in time order up to a watermark which lags behind the
+ * latest reply by a reorder window, as in QueueDepth. A request whose call
+ * precedes the swept time is counted as late and charged at the swept time.
+ *
+ * The absolute balance is known only if the connection is seen from its
+ * NEGOTIATE, see anchor(). Until then credits are just summed up. A window
+ * of starvation begins when the balance drops to zero and ends when the next
+ * response grants credits: the client can not send anything in between.
+ *
+ * All times are in microseconds.
+ */
+class CreditBalance
+{
+public:
+    CreditBalance() = delete;
+    //! Constructs balance which is not anchored yet
+    /*!
+     * \param window Reorder window - lag of the sweep behind the latest reply
+     */
+    explicit CreditBalance(uint64_t window);
+
+    //! Accounts request
+    /*!
+     * \param call Time of call
+     * \param charge Credits consumed by the request
+     * \param reply Time of reply
+     * \param granted Credits granted by the response
+     */
+    void add(uint64_t call, uint32_t charge, uint64_t reply, uint32_t granted);
+    //! Sweeps events up to the time and sets the known balance since then
+    /*!
+     * \param time Time since the balance is known
+     * \param credits Credits available to the client at that time
+     */
+    void anchor(uint64_t time, uint32_t credits);
+    //! Sweeps all pending events and closes open window of starvation
+    void finish();
+
+    //! Returns share of the anchored period when the client had no credits
+    double starvedShare() const;
+
+    inline bool anchored() const
+    {
+        return _anchored;
+    }
+    inline uint64_t requestsAmount() const
+    {
+        return _requests;
+    }
+    inline uint64_t chargedAmount() const
+    {
+        return _charged;
+    }
+    inline uint64_t grantedAmount() const
+    {
+        return _granted;
+    }
+    inline uint32_t balance() const
+    {
+        return _balance;
+    }
+    inline uint32_t maxBalance() const
+    {
+        return _maxBalance;
+    }
+    inline uint64_t starvationsAmount() const
+    {
+        return _starvations;
+    }
+    inline uint64_t starvedTime() const
+    {
+        return _starvedTime;
+    }
+    inline uint64_t longestStarvation() const
+    {
+        return _longestStarvation;
+    }
+    inline uint64_t overdrawnAmount() const
+    {
+        return _overdrawn;
+    }
+    inline uint64_t lateAmount() const
+    {
+        return _late;
+    }
+private:
+    //! Change of balance
+    struct Event
+    {
+        bool operator>(const Event& other) const
+        {
+            return time > other.time;
+        }
+
+        uint64_t time;
+        uint32_t credits;
+    };
+
+    using MinHeap = std::priority_queue<Event, std::vector<Event>, std::greater<Event>>;
+
+    void sweep(uint64_t until);
+    void consume(const Event& event);
+    void grant(const Event& event);
+
+    uint64_t _window;
+    MinHeap _calls;
+    MinHeap _replies;
+    uint64_t _now;          // time of the last swept event
+    uint64_t _latestReply;
+    bool _anchored;
+    uint64_t _anchorTime;
+    uint32_t _balance;
+    uint32_t _maxBalance;
+    bool _starved;
+    uint64_t _starvedSince;
+    uint64_t _requests;
+    uint64_t _charged;
+    uint64_t _granted;
+    uint64_t _starvations;
+    uint64_t _starvedTime;
+    uint64_t _longestStarvation;
+    uint64_t _overdrawn;    // requests charged more than available
+    uint64_t _late;
+};
+//------------------------------------------------------------------------------
+#endif//CREDIT_BALANCE_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,352 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of SMB2 credits and compounded requests
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+#include <arpa/inet.h>
+
+#include "smb_credits_analyzer.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+uint64_t microseconds(const struct timeval& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000U + static_cast<uint64_t>(time.tv_usec);
+}
+
+uint64_t fnv1a(const uint8_t* data, std::size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+constexpr std::size_t SmbCreditsAnalyzer::MaxChainLength;
+
+SmbCreditsAnalyzer::ConnectionAddress::ConnectionAddress(const Session& session) :
+    words{{0U, 0U, 0U, 0U}, {0U, 0U, 0U, 0U}},
+    ports{session.port[Session::Source], session.port[Session::Destination]},
+    type{session.ip_type}
+{
+    switch (type)
+    {
+    case Session::IPType::v4:
+        words[Session::Source][0] = session.ip.v4.addr[Session::Source];
+        words[Session::Destination][0] = session.ip.v4.addr[Session::Destination];
+        break;
+    case Session::IPType::v6:
+        memcpy(words[Session::Source], session.ip.v6.addr[Session::Source], sizeof(words[0]));
+        memcpy(words[Session::Destination], session.ip.v6.addr[Session::Destination], sizeof(words[0]));
+        break;
+    }
+}
+
+bool SmbCreditsAnalyzer::ConnectionAddress::operator==(const ConnectionAddress& other) const
+{
+    return type == other.type
+           && memcmp(ports, other.ports, sizeof(ports)) == 0
+           && memcmp(words, other.words, sizeof(words)) == 0;
+}
+
+std::string SmbCreditsAnalyzer::ConnectionAddress::str() const
+{
+    const int family = type == Session::IPType::v4 ? AF_INET : AF_INET6;
+    char client[INET6_ADDRSTRLEN];
+    char server[INET6_ADDRSTRLEN];
+    if (!inet_ntop(family, words[Session::Source], client, sizeof(client))
+        || !inet_ntop(family, words[Session::Destination], server, sizeof(server)))
+    {
+        return std::string{};
+    }
+    return std::string{client} + ':' + std::to_string(ntohs(ports[Session::Source]))
+           + " -> " + server + ':' + std::to_string(ntohs(ports[Session::Destination]));
+}
+
+std::size_t SmbCreditsAnalyzer::ConnectionAddressHash::operator()(const ConnectionAddress& address) const
+{
+    const uint64_t hash = fnv1a(reinterpret_cast<const uint8_t*>(address.ports), sizeof(address.ports),
+                                fnv1a(reinterpret_cast<const uint8_t*>(address.words), sizeof(address.words)));
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+}
+
+SmbCreditsAnalyzer::ConnectionStat::ConnectionStat(uint64_t window) :
+    credits{window},
+    commands{0U},
+    compounds{0U},
+    longestChain{0U},
+    chains{}
+{
+}
+
+SmbCreditsAnalyzer::SmbCreditsAnalyzer(uint64_t window, std::ostream& out) :
+    _window{window},
+    _out(out),
+    _connections{}
+{
+}
+
+void SmbCreditsAnalyzer::closeFileSMBv2(const SMBv2::CloseFileCommand* cmd,
+                                        const SMBv2::CloseRequest*,
+                                        const SMBv2::CloseResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::negotiateSMBv2(const SMBv2::NegotiateCommand* cmd,
+                                        const SMBv2::NegotiateRequest*,
+                                        const SMBv2::NegotiateResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::sessionSetupSMBv2(const SMBv2::SessionSetupCommand* cmd,
+                                           const SMBv2::SessionSetupRequest*,
+                                           const SMBv2::SessionSetupResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::logOffSMBv2(const SMBv2::LogOffCommand* cmd,
+                                     const SMBv2::LogOffRequest*,
+                                     const SMBv2::LogOffResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::treeConnectSMBv2(const SMBv2::TreeConnectCommand* cmd,
+                                          const SMBv2::TreeConnectRequest*,
+                                          const SMBv2::TreeConnectResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::treeDisconnectSMBv2(const SMBv2::TreeDisconnectCommand* cmd,
+                                             const SMBv2::TreeDisconnectRequest*,
+                                             const SMBv2::TreeDisconnectResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::createSMBv2(const SMBv2::CreateCommand* cmd,
+                                     const SMBv2::CreateRequest*,
+                                     const SMBv2::CreateResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::flushSMBv2(const SMBv2::FlushCommand* cmd,
+                                    const SMBv2::FlushRequest*,
+                                    const SMBv2::FlushResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::readSMBv2(const SMBv2::ReadCommand* cmd,
+                                   const SMBv2::ReadRequest*,
+                                   const SMBv2::ReadResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::writeSMBv2(const SMBv2::WriteCommand* cmd,
+                                    const SMBv2::WriteRequest*,
+                                    const SMBv2::WriteResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::lockSMBv2(const SMBv2::LockCommand* cmd,
+                                   const SMBv2::LockRequest*,
+                                   const SMBv2::LockResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::ioctlSMBv2(const SMBv2::IoctlCommand* cmd,
+                                    const SMBv2::IoCtlRequest*,
+                                    const SMBv2::IoCtlResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::cancelSMBv2(const SMBv2::CancelCommand* cmd,
+                                     const SMBv2::CancelRequest*,
+                                     const SMBv2::CancelResponce*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::echoSMBv2(const SMBv2::EchoCommand* cmd,
+                                   const SMBv2::EchoRequest*,
+                                   const SMBv2::EchoResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::queryDirSMBv2(const SMBv2::QueryDirCommand* cmd,
+                                       const SMBv2::QueryDirRequest*,
+                                       const SMBv2::QueryDirResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::changeNotifySMBv2(const SMBv2::ChangeNotifyCommand* cmd,
+                                           const SMBv2::ChangeNotifyRequest*,
+                                           const SMBv2::ChangeNotifyResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::queryInfoSMBv2(const SMBv2::QueryInfoCommand* cmd,
+                                        const SMBv2::QueryInfoRequest*,
+                                        const SMBv2::QueryInfoResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::setInfoSMBv2(const SMBv2::SetInfoCommand* cmd,
+                                      const SMBv2::SetInfoRequest*,
+                                      const SMBv2::SetInfoResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::breakOplockSMBv2(const SMBv2::BreakOpLockCommand* cmd,
+                                          const SMBv2::OplockAcknowledgment*,
+                                          const SMBv2::OplockResponse*)
+{
+    account(cmd);
+}
+
+void SmbCreditsAnalyzer::flush_statistics()
+{
+    _out << "### SMB2 credits statistics ###" << std::endl;
+    for (auto& connection : _connections)
+    {
+        printConnection(connection.first, connection.second);
+    }
+}
+
+void SmbCreditsAnalyzer::account(const Procedure<int>& proc,
+                                 const RawMessageHeader* request, uint32_t requestLength,
+                                 const RawMessageHeader* response, uint32_t responseLength)
+{
+    if (!request)
+    {
+        return;
+    }
+    ConnectionAddress address{*proc.session};
+    auto found = _connections.find(address);
+    const bool first = found == _connections.end();
+    if (first)
+    {
+        found = _connections.emplace(address, ConnectionStat{_window}).first;
+    }
+    ConnectionStat& connection = found->second;
+
+    const CompoundChain requests = chargedCredits(request, requestLength);
+    const CompoundChain responses = response ? grantedCredits(response, responseLength) : CompoundChain{0U, 0U};
+    const uint64_t call = microseconds(*proc.ctimestamp);
+    const uint64_t reply = microseconds(*proc.rtimestamp);
+    connection.credits.add(call, requests.credits, reply, responses.credits);
+    // Nothing can be sent before NEGOTIATE response, so it is the only
+    // pending request and credits granted by it are all the client has
+    if (first && response && request->cmd_code == SMBv2::SMBv2Commands::NEGOTIATE)
+    {
+        connection.credits.anchor(reply, responses.credits);
+    }
+
+    connection.commands += requests.length;
+    if (requests.length > 1U)
+    {
+        ++connection.compounds;
+        ++connection.chains[std::min<std::size_t>(requests.length, MaxChainLength)];
+        connection.longestChain = std::max(connection.longestChain, requests.length);
+    }
+}
+
+void SmbCreditsAnalyzer::printConnection(const ConnectionAddress& address, ConnectionStat& connection)
+{
+    CreditBalance& credits = connection.credits;
+    credits.finish();
+    _out << "  " << address.str()
+         << " messages " << credits.requestsAmount()
+         << " commands " << connection.commands
+         << " credits charged " << credits.chargedAmount()
+         << " granted " << credits.grantedAmount() << std::endl;
+
+    if (connection.compounds != 0U)
+    {
+        const uint64_t compounded = connection.commands - (credits.requestsAmount() - connection.compounds);
+        _out << "    compounds " << connection.compounds
+             << std::fixed << std::setprecision(2)
+             << " avg length " << static_cast<double>(compounded) / static_cast<double>(connection.compounds)
+             << " longest " << connection.longestChain
+             << " by length";
+        _out.unsetf(std::ios::floatfield);
+        for (std::size_t length = 2U; length < MaxChainLength; ++length)
+        {
+            if (connection.chains[length] != 0U)
+            {
+                _out << ' ' << length << ':' << connection.chains[length];
+            }
+        }
+        if (connection.chains[MaxChainLength] != 0U)
+        {
+            _out << ' ' << MaxChainLength << "+:" << connection.chains[MaxChainLength];
+        }
+        _out << std::endl;
+    }
+
+    if (!credits.anchored())
+    {
+        _out << "    balance unknown: NEGOTIATE of connection was not captured" << std::endl;
+        return;
+    }
+    _out << "    balance " << credits.balance()
+         << " max " << credits.maxBalance()
+         << " starvations " << credits.starvationsAmount()
+         << std::fixed << std::setprecision(2)
+         << " starved " << credits.starvedTime() / 1000.0 << " ms"
+         << std::setprecision(1)
+         << " (" << credits.starvedShare() * 100.0 << "%)"
+         << std::setprecision(2)
+         << " longest " << credits.longestStarvation() / 1000.0 << " ms";
+    _out.unsetf(std::ios::floatfield);
+    if (credits.overdrawnAmount() != 0U)
+    {
+        _out << " overdrawn " << credits.overdrawnAmount();
+    }
+    if (credits.lateAmount() != 0U)
+    {
+        _out << " late " << credits.lateAmount();
+    }
+    _out << std::endl;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,171 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Analyzer of SMB2 credits and compounded requests
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef SMB_CREDITS_ANALYZER_H
+#define SMB_CREDITS_ANALYZER_H
+//------------------------------------------------------------------------------
+#include <array>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "api/ianalyzer.h"
+#include "compound_chain.h"
+#include "credit_balance.h"
+//------------------------------------------------------------------------------
+using namespace NST::API;
+
+//! Analyzer of SMB2 credits and compound chains of connections
+/*!
+ * Credits are granted by the server per transport connection (a channel in
+ * SMB 3.x terms), so statistics are kept per connection: credits charged by
+ * requests and granted by responses, lengths of compound chains and windows
+ * of starvation, when the client has no credits and can not send requests.
+ * The balance of credits is known only if NEGOTIATE of connection was
+ * captured, see CreditBalance.
+ */
+class SmbCreditsAnalyzer : public IAnalyzer
+{
+public:
+    SmbCreditsAnalyzer() = delete;
+    //! Constructs analyzer
+    /*!
+     * \param window Reorder window in microseconds, see CreditBalance
+     * \param out Stream to report to
+     */
+    explicit SmbCreditsAnalyzer(uint64_t window, std::ostream& out = std::cout);
+    SmbCreditsAnalyzer(const SmbCreditsAnalyzer&) = delete;
+    SmbCreditsAnalyzer& operator=(const SmbCreditsAnalyzer&) = delete;
+
+    // SMBv2 commands
+
+    void closeFileSMBv2(const SMBv2::CloseFileCommand* cmd,
+                        const SMBv2::CloseRequest*,
+                        const SMBv2::CloseResponse*) override final;
+    void negotiateSMBv2(const SMBv2::NegotiateCommand* cmd,
+                        const SMBv2::NegotiateRequest*,
+                        const SMBv2::NegotiateResponse*) override final;
+    void sessionSetupSMBv2(const SMBv2::SessionSetupCommand* cmd,
+                           const SMBv2::SessionSetupRequest*,
+                           const SMBv2::SessionSetupResponse*) override final;
+    void logOffSMBv2(const SMBv2::LogOffCommand* cmd,
+                     const SMBv2::LogOffRequest*,
+                     const SMBv2::LogOffResponse*) override final;
+    void treeConnectSMBv2(const SMBv2::TreeConnectCommand* cmd,
+                          const SMBv2::TreeConnectRequest*,
+                          const SMBv2::TreeConnectResponse*) override final;
+    void treeDisconnectSMBv2(const SMBv2::TreeDisconnectCommand* cmd,
+                             const SMBv2::TreeDisconnectRequest*,
+                             const SMBv2::TreeDisconnectResponse*) override final;
+    void createSMBv2(const SMBv2::CreateCommand* cmd,
+                     const SMBv2::CreateRequest*,
+                     const SMBv2::CreateResponse*) override final;
+    void flushSMBv2(const SMBv2::FlushCommand* cmd,
+                    const SMBv2::FlushRequest*,
+                    const SMBv2::FlushResponse*) override final;
+    void readSMBv2(const SMBv2::ReadCommand* cmd,
+                   const SMBv2::ReadRequest*,
+                   const SMBv2::ReadResponse*) override final;
+    void writeSMBv2(const SMBv2::WriteCommand* cmd,
+                    const SMBv2::WriteRequest*,
+                    const SMBv2::WriteResponse*) override final;
+    void lockSMBv2(const SMBv2::LockCommand* cmd,
+                   const SMBv2::LockRequest*,
+                   const SMBv2::LockResponse*) override final;
+    void ioctlSMBv2(const SMBv2::IoctlCommand* cmd,
+                    const SMBv2::IoCtlRequest*,
+                    const SMBv2::IoCtlResponse*) override final;
+    void cancelSMBv2(const SMBv2::CancelCommand* cmd,
+                     const SMBv2::CancelRequest*,
+                     const SMBv2::CancelResponce*) override final;
+    void echoSMBv2(const SMBv2::EchoCommand* cmd,
+                   const SMBv2::EchoRequest*,
+                   const SMBv2::EchoResponse*) override final;
+    void queryDirSMBv2(const SMBv2::QueryDirCommand* cmd,
+                       const SMBv2::QueryDirRequest*,
+                       const SMBv2::QueryDirResponse*) override final;
+    void changeNotifySMBv2(const SMBv2::ChangeNotifyCommand* cmd,
+                           const SMBv2::ChangeNotifyRequest*,
+                           const SMBv2::ChangeNotifyResponse*) override final;
+    void queryInfoSMBv2(const SMBv2::QueryInfoCommand* cmd,
+                        const SMBv2::QueryInfoRequest*,
+                        const SMBv2::QueryInfoResponse*) override final;
+    void setInfoSMBv2(const SMBv2::SetInfoCommand* cmd,
+                      const SMBv2::SetInfoRequest*,
+                      const SMBv2::SetInfoResponse*) override final;
+    void breakOplockSMBv2(const SMBv2::BreakOpLockCommand* cmd,
+                          const SMBv2::OplockAcknowledgment*,
+                          const SMBv2::OplockResponse*) override final;
+
+    void flush_statistics() override final;
+private:
+    using RawMessageHeader = NST::protocols::CIFSv2::RawMessageHeader;
+
+    //! Longest compound chain reported separately, longer ones are summed up
+    static constexpr std::size_t MaxChainLength = 8U;
+
+    //! Client and server addresses and ports of a connection
+    struct ConnectionAddress
+    {
+        explicit ConnectionAddress(const Session& session);
+
+        bool operator==(const ConnectionAddress& other) const;
+        std::string str() const;
+
+        uint32_t words[2][4]; // IPv4 addresses are stored in the first words
+        in_port_t ports[2];
+        Session::IPType type;
+    };
+
+    struct ConnectionAddressHash
+    {
+        std::size_t operator()(const ConnectionAddress& address) const;
+    };
+
+    //! Credits and compound chains of a connection
+    struct ConnectionStat
+    {
+        explicit ConnectionStat(uint64_t window);
+
+        CreditBalance credits;
+        uint64_t commands;      // including compounded ones
+        uint64_t compounds;     // messages of more than one command
+        uint32_t longestChain;
+        std::array<uint64_t, MaxChainLength + 1> chains; // amount of compounds by length
+    };
+
+    template<typename Command>
+    void account(const Command* cmd)
+    {
+        account(*cmd, cmd->req_header, cmd->req_length, cmd->res_header, cmd->res_length);
+    }
+    void account(const Procedure<int>& proc,
+                 const RawMessageHeader* request, uint32_t requestLength,
+                 const RawMessageHeader* response, uint32_t responseLength);
+    void printConnection(const ConnectionAddress& address, ConnectionStat& connection);
+
+    uint64_t _window;
+    std::ostream& _out;
+    std::unordered_map<ConnectionAddress, ConnectionStat, ConnectionAddressHash> _connections;
+};
+//------------------------------------------------------------------------------
+#endif//SMB_CREDITS_ANALYZER_H
+//------------------------------------------------------------------------------
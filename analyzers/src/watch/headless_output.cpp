@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Source for text output of rates without terminal.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "headless_output.h"
+//------------------------------------------------------------------------------
+namespace
+{
+const int PROCEDURES_GROUP = 1;
+
+void appendRate(std::string& buffer, const char* name, const char* format, double rate)
+{
+    char number[32];
+    snprintf(number, sizeof(number), format, rate);
+    buffer += ' ';
+    buffer += name;
+    buffer += '=';
+    buffer += number;
+}
+
+void appendTime(std::string& buffer, std::time_t time)
+{
+    char timestamp[32];
+    struct tm local;
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", localtime_r(&time, &local));
+    buffer += timestamp;
+    buffer += ' ';
+}
+}
+
+HeadlessOutput::HeadlessOutput(const std::string& path, std::size_t movers)
+: _file {stdout}
+, _ownFile {false}
+, _movers {movers}
+{
+    if (!path.empty() && path != "-")
+    {
+        _file = fopen(path.c_str(), "a");
+        if (_file == nullptr)
+        {
+            throw std::runtime_error {std::string{"Can't open output file: "} + path + " Error: " + strerror(errno)};
+        }
+        _ownFile = true;
+    }
+}
+
+HeadlessOutput::~HeadlessOutput()
+{
+    flush();
+    if (_ownFile)
+    {
+        fclose(_file);
+    }
+}
+
+void HeadlessOutput::write(std::time_t time, AbstractProtocol& protocol, const ProtocolRates& rates)
+{
+    const ProtocolStatistic& counters = rates.getCounters();
+    if (std::all_of(counters.begin(), counters.end(), [](std::size_t c) { return c == 0; }))
+    {
+        return;
+    }
+
+    appendTime(_buffer, time);
+    std::string name = protocol.getProtocolName();
+    name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+    _buffer += name;
+
+    double total = 0.0;
+    double average = 0.0;
+    for (std::size_t i = protocol.getGroupBegin(PROCEDURES_GROUP); i < protocol.getGroupBegin(PROCEDURES_GROUP + 1); ++i)
+    {
+        total += rates.getRates()[i];
+        average += rates.getAverages()[i];
+    }
+    appendRate(_buffer, "total", "%.1f", total);
+    appendRate(_buffer, "avg", "%.1f", average);
+
+    for (std::size_t i = 0; i < counters.size(); ++i)
+    {
+        if (rates.getRates()[i] > 0.0 && protocol.printProcedure(i) != nullptr)
+        {
+            appendRate(_buffer, protocol.printProcedure(i), "%.1f", rates.getRates()[i]);
+        }
+    }
+
+    // top movers are taken from all procedures, even stopped ones
+    _order.clear();
+    for (std::size_t i = 0; i < counters.size(); ++i)
+    {
+        if (rates.getRates()[i] != rates.getAverages()[i] && protocol.printProcedure(i) != nullptr)
+        {
+            _order.push_back(i);
+        }
+    }
+    const std::size_t movers = std::min(_movers, _order.size());
+    std::partial_sort(_order.begin(), _order.begin() + movers, _order.end(), [&](std::size_t a, std::size_t b)
+    {
+        return std::fabs(rates.getRates()[a] - rates.getAverages()[a]) > std::fabs(rates.getRates()[b] - rates.getAverages()[b]);
+    });
+    if (movers > 0)
+    {
+        _buffer += " movers:";
+        for (std::size_t i = 0; i < movers; ++i)
+        {
+            appendRate(_buffer, protocol.printProcedure(_order[i]), "%+.1f", rates.getRates()[_order[i]] - rates.getAverages()[_order[i]]);
+        }
+    }
+    _buffer += '\n';
+}
+
+void HeadlessOutput::write(std::time_t time, const PipelineHealth& pipeline)
+{
+    if (!pipeline.format(_pipeline))
+    {
+        return;
+    }
+    appendTime(_buffer, time);
+    _buffer += "pipeline ";
+    _buffer += _pipeline;
+    _buffer += '\n';
+}
+
+void HeadlessOutput::flush()
+{
+    if (_buffer.empty())
+    {
+        return;
+    }
+    fwrite(_buffer.data(), 1, _buffer.size(), _file);
+    fflush(_file);
+    _buffer.clear();
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Header for text output of rates without terminal.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef HEADLESS_OUTPUT_H
+#define HEADLESS_OUTPUT_H
+//------------------------------------------------------------------------------
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "protocols/abstract_protocol.h"
+#include "pipeline_health.h"
+#include "protocol_counters.h"
+//------------------------------------------------------------------------------
+/*! Writes one line per active protocol for each update interval:
+ *  time, protocol, total rate, rates of procedures and top movers -
+ *  procedures whose rate differs most from their moving average.
+ *  Protocols without any procedure since start are skipped.
+ *  The last line of an interval shows health of nfstrace pipeline.
+ */
+class HeadlessOutput
+{
+public:
+    HeadlessOutput() = delete;
+    /*! Open output. Empty path or "-" means standard output.
+    */
+    HeadlessOutput(const std::string& path, std::size_t movers);
+    ~HeadlessOutput();
+    HeadlessOutput(const HeadlessOutput&) = delete;
+    HeadlessOutput& operator=(const HeadlessOutput&) = delete;
+
+    /*! Format line with rates of protocol.
+    */
+    void write(std::time_t, AbstractProtocol&, const ProtocolRates&);
+
+    /*! Format line with metrics of nfstrace pipeline if they are known.
+    */
+    void write(std::time_t, const PipelineHealth&);
+
+    /*! Write formatted lines to output.
+    */
+    void flush();
+
+private:
+    FILE* _file;
+    bool _ownFile;
+    std::size_t _movers;
+    std::string _buffer;
+    std::vector<std::size_t> _order;
+    std::string _pipeline;
+};
+//------------------------------------------------------------------------------
+#endif//HEADLESS_OUTPUT_H
+//------------------------------------------------------------------------------
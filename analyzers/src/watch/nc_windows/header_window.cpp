@@ -34,6 +34,7 @@ const int MEMO_LINE = 1;
 const int HOST_LINE = 2;
 const int DATE_LINE = 3;
 const int ELAPSED_LINE = 4;
+const int PIPELINE_LINE = 5;
 const int HOST_SIZE = 128;
 }
 
@@ -63,7 +64,7 @@ HeaderWindow::~HeaderWindow()
 {
 }
 
-void HeaderWindow::update()
+void HeaderWindow::update(const PipelineHealth& pipeline)
 {
     if (_window == nullptr)
     {
@@ -76,6 +77,12 @@ void HeaderWindow::update()
     mvwprintw(_window, HEADER::DATE_LINE, FIRST_CHAR_POS, "Date: \t %d.%d.%d \t Time: %d:%d:%d  ", t->tm_mday, t->tm_mon + 1, t->tm_year + 1900, t->tm_hour, t->tm_min, t->tm_sec);
     mvwprintw(_window, HEADER::ELAPSED_LINE, FIRST_CHAR_POS, "Elapsed time:  \t %d days; %d:%d:%d times",
               shift_time / SECINDAY, shift_time % SECINDAY / SECINHOUR, shift_time % SECINHOUR / SECINMIN, shift_time % SECINMIN);
+    if (pipeline.format(_pipeline))
+    {
+        // line is cut by the right border
+        _pipeline.resize(GUI_LENGTH - 2 * BORDER_SIZE - FIRST_CHAR_POS, ' ');
+        mvwprintw(_window, HEADER::PIPELINE_LINE, FIRST_CHAR_POS, "%s", _pipeline.c_str());
+    }
     wrefresh (_window);
 }
 
@@ -24,12 +24,14 @@
 //------------------------------------------------------------------------------
 #include <ncurses.h>
 
+#include "../pipeline_health.h"
 #include "main_window.h"
 //------------------------------------------------------------------------------
 class HeaderWindow
 {
     WINDOW* _window;
     time_t _start_time;
+    std::string _pipeline;
     void destroy();
 
 public:
@@ -39,7 +41,7 @@ public:
 
     /*! Update Header Window
     */
-    void update();
+    void update(const PipelineHealth&);
 
     /*! Resize Header Window
     */
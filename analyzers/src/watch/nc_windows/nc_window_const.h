@@ -35,9 +35,11 @@ const int MAXSHIFT = 25;
 const int SHIFTCU  = 1;
 
 const int GUI_LENGTH        = 80;
-const int GUI_HEADER_HEIGHT = 6;
-const int PERSENT_POS       = 29;
+const int GUI_HEADER_HEIGHT = 7;
+const int PERSENT_POS       = 34;
 const int COUNTERS_POS      = 22;
+const int RATE_POS          = 44;
+const int AVERAGE_POS       = 58;
 
 const int FIRST_CHAR_POS = 1;
 const int EMPTY_LINE     = 1;
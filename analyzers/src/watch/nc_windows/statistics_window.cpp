@@ -21,6 +21,7 @@
 //------------------------------------------------------------------------------
 #include <algorithm>
 #include <numeric>
+#include <stdexcept>
 
 #include <unistd.h>
 
@@ -30,6 +31,7 @@
 namespace STATISTICS
 {
 const int PROTOCOLS_LINE = 1;
+const int COLUMNS_LINE = 2;
 const int FIRST_OPERATION_LINE = 3;
 const int DEFAULT_LINES = 10;
 const int DEFAULT_GROUP = 1;
@@ -52,7 +54,7 @@ bool StatisticsWindow::canWrite(unsigned int i)
     return (i >= _scrollOffset.at(_activeProtocol) + STATISTICS::FIRST_OPERATION_LINE  && i - _scrollOffset.at(_activeProtocol) + BORDER_SIZE < static_cast<unsigned int>(_window->_maxy));
 }
 
-StatisticsWindow::StatisticsWindow(MainWindow& w, StatisticsContainers& c)
+StatisticsWindow::StatisticsWindow(MainWindow& w, const std::vector<AbstractProtocol*>& c)
 : _window {nullptr}
 , _activeProtocol {nullptr}
 {
@@ -62,11 +64,11 @@ StatisticsWindow::StatisticsWindow(MainWindow& w, StatisticsContainers& c)
     }
     for (auto i : c)
     {
-        _allProtocols.push_back((i.first)->getProtocolName());
-        _scrollOffset.insert(std::make_pair<AbstractProtocol*, std::size_t>(reinterpret_cast<AbstractProtocol*>(i.first), 0));
+        _allProtocols.push_back(i->getProtocolName());
+        _scrollOffset.insert(std::make_pair(i, 0U));
     };
-    _activeProtocol = (c.begin())->first;
-    _statistic = c.at(_activeProtocol);
+    _activeProtocol = c.front();
+    _statistic.assign(_activeProtocol->getAmount(), 0);
     resize(w);
 }
 
@@ -113,6 +115,10 @@ void StatisticsWindow::updateProtocol(AbstractProtocol* p)
 
     });
     mvwprintw(_window, STATISTICS::PROTOCOLS_LINE , FIRST_CHAR_POS, "%s", tmp.c_str());
+    mvwprintw(_window, STATISTICS::COLUMNS_LINE, COUNTERS_POS, "%s", "count");
+    mvwprintw(_window, STATISTICS::COLUMNS_LINE, PERSENT_POS, "%s", "%");
+    mvwprintw(_window, STATISTICS::COLUMNS_LINE, RATE_POS, "%s", "ops/s");
+    mvwprintw(_window, STATISTICS::COLUMNS_LINE, AVERAGE_POS, "%s", "avg ops/s");
 
     unsigned int line = STATISTICS::FIRST_OPERATION_LINE;
     for(unsigned int i = STATISTICS::DEFAULT_GROUP; i <= _activeProtocol->getGroups(); i++)
@@ -135,9 +141,11 @@ void StatisticsWindow::updateProtocol(AbstractProtocol* p)
 
 }
 
-void StatisticsWindow::update(const ProtocolStatistic& d)
+void StatisticsWindow::update(const ProtocolRates& d)
 {
-    _statistic = d;
+    _statistic = d.getCounters();
+    _rates = d.getRates();
+    _averages = d.getAverages();
     if (_statistic.empty() || _window == nullptr)
     {
         return;
@@ -147,14 +155,20 @@ void StatisticsWindow::update(const ProtocolStatistic& d)
     for(unsigned int i = STATISTICS::DEFAULT_GROUP; i <= _activeProtocol->getGroups(); i++)
     {
         std::size_t m = 0; // sum of all counters
+        double rate = 0.0;
+        double average = 0.0;
 
         for(std::size_t tmp = _activeProtocol->getGroupBegin(i); tmp < _activeProtocol->getGroupBegin(i + 1); tmp++)
         {
             m += _statistic[tmp];
+            rate += _rates[tmp];
+            average += _averages[tmp];
         }
         if ( canWrite(line))
         {
-            mvwprintw(_window, line - (_scrollOffset.at(_activeProtocol)), FIRST_CHAR_POS + 25, "%d", m);
+            mvwprintw(_window, line - (_scrollOffset.at(_activeProtocol)), COUNTERS_POS, "%lu ", m);
+            mvwprintw(_window, line - (_scrollOffset.at(_activeProtocol)), RATE_POS, "%-10.1f ", rate);
+            mvwprintw(_window, line - (_scrollOffset.at(_activeProtocol)), AVERAGE_POS, "%-10.1f ", average);
         }
         line++;
         for (unsigned int j = _activeProtocol->getGroupBegin(i); j < _activeProtocol->getGroupBegin(i + 1); j++)
@@ -164,6 +178,8 @@ void StatisticsWindow::update(const ProtocolStatistic& d)
                 mvwprintw(_window, line - _scrollOffset.at(_activeProtocol), COUNTERS_POS, "%lu ", _statistic[j]);
                 mvwprintw(_window, line - _scrollOffset.at(_activeProtocol), PERSENT_POS, "%-3.2f%% ",
                           m > 0 ? static_cast<double>(_statistic[j]) / static_cast<double>(m) * 100.0 : 0.0);
+                mvwprintw(_window, line - _scrollOffset.at(_activeProtocol), RATE_POS, "%-10.1f ", _rates[j]);
+                mvwprintw(_window, line - _scrollOffset.at(_activeProtocol), AVERAGE_POS, "%-10.1f ", _averages[j]);
             }
             line++;
         }
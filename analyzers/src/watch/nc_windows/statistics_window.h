@@ -26,25 +26,25 @@
 #include <vector>
 
 #include "../protocols/abstract_protocol.h"
+#include "../protocol_counters.h"
 #include "main_window.h"
 //------------------------------------------------------------------------------
 class StatisticsWindow
 {
-    using ProtocolStatistic = std::vector<std::size_t>;
-    using StatisticsContainers = std::unordered_map<AbstractProtocol*, ProtocolStatistic>;
-
 private:
     WINDOW* _window;
     AbstractProtocol* _activeProtocol;
     std::vector<std::string> _allProtocols;
     std::unordered_map<AbstractProtocol*, unsigned int> _scrollOffset;
     ProtocolStatistic _statistic;
+    std::vector<double> _rates;
+    std::vector<double> _averages;
     void destroy();
     bool canWrite(unsigned int);
 
 public:
     StatisticsWindow() = delete;
-    StatisticsWindow(MainWindow&, StatisticsContainers&);
+    StatisticsWindow(MainWindow&, const std::vector<AbstractProtocol*>&);
     ~StatisticsWindow();
 
     /*! Scroll content of Statistic Winodow Up or Down
@@ -55,9 +55,9 @@ public:
     */
     void updateProtocol(AbstractProtocol*);
 
-    /*! Update counters on Statistics Window
+    /*! Update counters, rates and average rates on Statistics Window
     */
-    void update(const ProtocolStatistic&);
+    void update(const ProtocolRates&);
 
     /*! Resize Statistic Window
     */
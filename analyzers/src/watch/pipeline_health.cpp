@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Health metrics of nfstrace pipeline.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include "pipeline_health.h"
+//------------------------------------------------------------------------------
+namespace
+{
+struct Shown
+{
+    const char* metric; // name in registry of nfstrace
+    const char* label;  // name on screen
+};
+
+const Shown SHOWN[] =
+{
+    {"queue_elements",    "queue"},
+    {"queue_free_chunks", "free"},
+    {"queue_exhausted",   "exhausted"},
+    {"sessions",          "sessions"},
+    {"tcp_fragments",     "fragments"},
+    {"tcp_lost_bytes",    "lost_bytes"},
+    {"xdr_errors",        "xdr_errors"},
+};
+}
+
+PipelineHealth::PipelineHealth()
+: _known {false}
+{
+    static_assert(sizeof(SHOWN) / sizeof(SHOWN[0]) == SHOWN_AMOUNT, "Shown metrics and their values must match");
+    for (auto& value : _values)
+    {
+        value.store(0, std::memory_order_relaxed);
+    }
+}
+
+void PipelineHealth::update(const NST::API::MetricsStat::Snapshot& metrics)
+{
+    for (std::size_t i = 0; i < SHOWN_AMOUNT; ++i)
+    {
+        const NST::API::MetricsStat::Metric* metric = metrics.find(SHOWN[i].metric);
+        _values[i].store(metric ? metric->value : 0, std::memory_order_relaxed);
+    }
+    _known.store(true, std::memory_order_release);
+}
+
+bool PipelineHealth::format(std::string& line) const
+{
+    line.clear();
+    if (!_known.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < SHOWN_AMOUNT; ++i)
+    {
+        if (i != 0)
+        {
+            line += ' ';
+        }
+        line += SHOWN[i].label;
+        line += '=';
+        line += std::to_string(_values[i].load(std::memory_order_relaxed));
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
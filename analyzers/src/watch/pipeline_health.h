@@ -0,0 +1,59 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Header for health metrics of nfstrace pipeline.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef PIPELINE_HEALTH_H
+#define PIPELINE_HEALTH_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <api/metrics_stat.h>
+//------------------------------------------------------------------------------
+/*! Metrics of filtration, queuing and analysis shown with rates.
+ *  Values are stored by the parser thread about once per second and read by
+ *  the GUI thread, so both sides use relaxed atomics without locks.
+ */
+class PipelineHealth
+{
+public:
+    PipelineHealth();
+    PipelineHealth(const PipelineHealth&) = delete;
+    PipelineHealth& operator=(const PipelineHealth&) = delete;
+
+    /*! Store values of shown metrics. Called by the parser thread, never blocks.
+    */
+    void update(const NST::API::MetricsStat::Snapshot&);
+
+    /*! Format shown metrics as "name=value" pairs separated by spaces.
+     *  Return false if no metrics were stored yet.
+    */
+    bool format(std::string&) const;
+
+private:
+    static const std::size_t SHOWN_AMOUNT = 7;
+
+    std::atomic<bool> _known;
+    std::atomic<int64_t> _values[SHOWN_AMOUNT];
+};
+//------------------------------------------------------------------------------
+#endif//PIPELINE_HEALTH_H
+//------------------------------------------------------------------------------
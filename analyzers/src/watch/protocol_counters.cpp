@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Source for counters and rates of protocol's procedures.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include "protocol_counters.h"
+//------------------------------------------------------------------------------
+const std::size_t ProtocolRates::AVERAGE_INTERVALS;
+
+ProtocolCounters::ProtocolCounters(std::size_t amount)
+: _amount {amount}
+, _counters {new std::atomic<uint64_t>[amount]()}
+{
+}
+
+void ProtocolCounters::load(ProtocolStatistic& statistic) const
+{
+    statistic.resize(_amount);
+    for (std::size_t i = 0; i < _amount; ++i)
+    {
+        statistic[i] = _counters[i].load(std::memory_order_relaxed);
+    }
+}
+
+std::size_t ProtocolCounters::getAmount() const
+{
+    return _amount;
+}
+
+ProtocolRates::ProtocolRates(std::size_t amount)
+: _counters (amount, 0)
+, _rates (amount, 0.0)
+, _averages (amount, 0.0)
+{
+}
+
+void ProtocolRates::update(const ProtocolStatistic& counters, Clock::time_point time)
+{
+    _counters = counters;
+    _samples.push_back(Sample{time, counters});
+    if (_samples.size() > AVERAGE_INTERVALS + 1)
+    {
+        _samples.pop_front();
+    }
+    if (_samples.size() < 2)
+    {
+        return;
+    }
+    calculate(_samples[_samples.size() - 2], _samples.back(), _rates);
+    calculate(_samples.front(), _samples.back(), _averages);
+}
+
+const ProtocolStatistic& ProtocolRates::getCounters() const
+{
+    return _counters;
+}
+
+const std::vector<double>& ProtocolRates::getRates() const
+{
+    return _rates;
+}
+
+const std::vector<double>& ProtocolRates::getAverages() const
+{
+    return _averages;
+}
+
+void ProtocolRates::calculate(const Sample& from, const Sample& to, std::vector<double>& rates)
+{
+    const double seconds = std::chrono::duration<double>(to.time - from.time).count();
+    for (std::size_t i = 0; i < rates.size() && i < to.counters.size() && i < from.counters.size(); ++i)
+    {
+        rates[i] = seconds > 0.0 ? static_cast<double>(to.counters[i] - from.counters[i]) / seconds : 0.0;
+    }
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Header for counters and rates of protocol's procedures.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef PROTOCOL_COUNTERS_H
+#define PROTOCOL_COUNTERS_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <vector>
+//------------------------------------------------------------------------------
+using ProtocolStatistic = std::vector<std::size_t>;
+
+/*! Fixed array of procedure's counters of one protocol.
+ *  Counters are incremented by the parser thread only, so increment is a
+ *  relaxed load and store without locks. Any thread may take a snapshot.
+ */
+class ProtocolCounters
+{
+public:
+    ProtocolCounters() = delete;
+    explicit ProtocolCounters(std::size_t amount);
+    ProtocolCounters(const ProtocolCounters&) = delete;
+    ProtocolCounters& operator=(const ProtocolCounters&) = delete;
+
+    /*! Account one procedure. Must be called by the single writer thread.
+    */
+    inline void account(std::size_t procedure)
+    {
+        if (procedure < _amount)
+        {
+            std::atomic<uint64_t>& counter = _counters[procedure];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    /*! Copy current values of counters.
+    */
+    void load(ProtocolStatistic&) const;
+
+    /*! Return amount of counters.
+    */
+    std::size_t getAmount() const;
+
+private:
+    std::size_t _amount;
+    std::unique_ptr<std::atomic<uint64_t>[]> _counters;
+};
+
+/*! Rates of procedures (ops/s) computed from snapshots of counters.
+ *  The last rate and the moving average over AVERAGE_INTERVALS intervals
+ *  are kept. Used by the reader thread only.
+ */
+class ProtocolRates
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static const std::size_t AVERAGE_INTERVALS = 10;
+
+    ProtocolRates() = delete;
+    explicit ProtocolRates(std::size_t amount);
+
+    /*! Add snapshot of counters taken at time and recalculate rates.
+    */
+    void update(const ProtocolStatistic&, Clock::time_point);
+
+    /*! Return counters of the last snapshot.
+    */
+    const ProtocolStatistic& getCounters() const;
+
+    /*! Return rates of procedures during the last interval.
+    */
+    const std::vector<double>& getRates() const;
+
+    /*! Return moving average of rates of procedures.
+    */
+    const std::vector<double>& getAverages() const;
+
+private:
+    struct Sample
+    {
+        Clock::time_point time;
+        ProtocolStatistic counters;
+    };
+
+    static void calculate(const Sample& from, const Sample& to, std::vector<double>& rates);
+
+    std::deque<Sample> _samples;
+    ProtocolStatistic _counters;
+    std::vector<double> _rates;
+    std::vector<double> _averages;
+};
+//------------------------------------------------------------------------------
+#endif//PROTOCOL_COUNTERS_H
+//------------------------------------------------------------------------------
@@ -20,8 +20,12 @@
 */
 //------------------------------------------------------------------------------
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
 #include <exception>
 #include <iostream>
+#include <stdexcept>
 #include <system_error>
 
 #include <unistd.h>
@@ -30,6 +34,7 @@
 #include "nc_windows/header_window.h"
 #include "nc_windows/main_window.h"
 #include "nc_windows/statistics_window.h"
+#include "headless_output.h"
 #include "user_gui.h"
 //-----------------------------------------------------------------------------
 namespace
@@ -37,18 +42,72 @@ namespace
 const int SCROLL_UP   = 1;
 const int SCROLL_DOWN = -1;
 const int MSEC        = 1000000;
+const std::size_t DEFAULT_MOVERS = 3;
 }
 //------------------------------------------------------------------------------
 void UserGUI::run()
+{
+    if (_headless)
+    {
+        runHeadless();
+    }
+    else
+    {
+        runCurses();
+    }
+}
+
+void UserGUI::runHeadless()
+{
+    try
+    {
+        HeadlessOutput output(_outputPath, _movers);
+        const std::chrono::microseconds refresh {_refresh_delta};
+        ProtocolRates::Clock::time_point next = ProtocolRates::Clock::now();
+
+        takeSnapshots();
+        while (_running.test_and_set())
+        {
+            next += refresh;
+            {
+                std::unique_lock<std::mutex> lck(_wakeupMutex);
+                if (_wakeup.wait_until(lck, next, [this]{ return _stopRequested; }))
+                {
+                    break;
+                }
+            }
+            takeSnapshots();
+            const std::time_t now = time(nullptr);
+            for (auto& entry : _protocols)
+            {
+                output.write(now, *entry.protocol, entry.rates);
+            }
+            output.write(now, _pipeline);
+            output.flush();
+        }
+    }
+    catch (std::runtime_error& e)
+    {
+        std::cerr << "Watch plugin error: " << e.what();
+    }
+}
+
+void UserGUI::runCurses()
 {
     try
     {
         // prepare for select
         fd_set rfds;
 
+        std::vector<AbstractProtocol*> protocols;
+        for (auto& entry : _protocols)
+        {
+            protocols.push_back(entry.protocol);
+        }
+
         MainWindow mainWindow;
         HeaderWindow     headerWindow(mainWindow);
-        StatisticsWindow statisticsWindow(mainWindow, _statisticsContainers);
+        StatisticsWindow statisticsWindow(mainWindow, protocols);
 
         /* Watch stdin (fd 0) to see when it has input. */
         FD_ZERO(&rfds);
@@ -59,7 +118,8 @@ void UserGUI::run()
 
         uint16_t key = 0;
 
-        std::vector<std::size_t> tmp;
+        const std::chrono::microseconds refresh {_refresh_delta};
+        ProtocolRates::Clock::time_point lastSnapshot = ProtocolRates::Clock::now() - refresh;
 
         statisticsWindow.updateProtocol(_activeProtocol);
 
@@ -74,13 +134,15 @@ void UserGUI::run()
 
                 _shouldResize = false;
             }
-            if (_running.test_and_set())
+            // rates are recalculated once per refresh interval, not on each key
+            if (ProtocolRates::Clock::now() - lastSnapshot >= refresh)
             {
-                std::unique_lock<std::mutex>lck(_statisticsDeltaMutex);
-                tmp = _statisticsContainers.at(_activeProtocol);
+                lastSnapshot = ProtocolRates::Clock::now();
+                takeSnapshots();
             }
-            headerWindow.update();
-            statisticsWindow.update(tmp);
+            ProtocolEntry* active = findProtocol(_activeProtocol->getProtocolName());
+            headerWindow.update(_pipeline);
+            statisticsWindow.update(active->rates);
             mainWindow.update();
 
             if( select(STDIN_FILENO + 1, &rfds, nullptr, nullptr, &tv) == -1)
@@ -112,32 +174,25 @@ void UserGUI::run()
                             else
                                 --it;
                         }
-                        auto a = find_if ( _statisticsContainers.begin(), _statisticsContainers.end(),[&](std::pair<AbstractProtocol*, std::vector<std::size_t> > p)
-                        {
-                            return !(p.first->getProtocolName().compare(*it));
-                        });
-                        if (a != _statisticsContainers.end())
+                        ProtocolEntry* a = findProtocol(*it);
+                        if (a != nullptr)
                         {
-                            _activeProtocol = a->first;
+                            _activeProtocol = a->protocol;
                             statisticsWindow.setProtocol(_activeProtocol);
                             statisticsWindow.resize(mainWindow);
-                            {
-                                std::unique_lock<std::mutex>lck(_statisticsDeltaMutex);
-                                tmp = a->second;
-                            }
-                            statisticsWindow.update(tmp);
+                            statisticsWindow.update(a->rates);
                         }
                     }
                 }
                 else if (key == KEY_UP)
                 {
                     statisticsWindow.scrollContent(SCROLL_UP);
-                    statisticsWindow.update(tmp);
+                    statisticsWindow.update(active->rates);
                 }
                 else if (key == KEY_DOWN)
                 {
                     statisticsWindow.scrollContent(SCROLL_DOWN);
-                    statisticsWindow.update(tmp);
+                    statisticsWindow.update(active->rates);
                 }
             }
             tv = getTimeval();
@@ -149,6 +204,26 @@ void UserGUI::run()
     }
 }
 
+void UserGUI::takeSnapshots()
+{
+    ProtocolStatistic counters;
+    const ProtocolRates::Clock::time_point now = ProtocolRates::Clock::now();
+    for (auto& entry : _protocols)
+    {
+        entry.counters->load(counters);
+        entry.rates.update(counters, now);
+    }
+}
+
+UserGUI::ProtocolEntry* UserGUI::findProtocol(const std::string& name)
+{
+    auto it = find_if (_protocols.begin(), _protocols.end(), [&](const ProtocolEntry& entry)
+    {
+        return !(entry.protocol->getProtocolName().compare(name));
+    });
+    return it != _protocols.end() ? &(*it) : nullptr;
+}
+
 timeval UserGUI::getTimeval() const
 {
     struct timeval tv;
@@ -159,20 +234,23 @@ timeval UserGUI::getTimeval() const
 
 UserGUI::UserGUI(const char* opts, std::vector<AbstractProtocol* >& data)
 : _refresh_delta {900000}
+, _headless {false}
+, _movers {DEFAULT_MOVERS}
 , _shouldResize {false}
 , _running {ATOMIC_FLAG_INIT}
+, _stopRequested {false}
 , _activeProtocol(nullptr)
 {
     try
     {
         if (opts != nullptr && *opts != '\0' )
         {
-            _refresh_delta = std::stoul(opts);
+            parseOptions(opts);
         }
         for (auto it = data.begin(); it != data.end(); ++it)
         {
             _allProtocols.push_back((*it)->getProtocolName());
-            _statisticsContainers.insert(std::make_pair<AbstractProtocol*, std::vector<std::size_t> >((AbstractProtocol*&&)(*it), std::vector<std::size_t>((*it)->getAmount(), 0)));
+            _protocols.push_back(ProtocolEntry{*it, std::unique_ptr<ProtocolCounters>{new ProtocolCounters{(*it)->getAmount()}}, ProtocolRates{(*it)->getAmount()}});
         }
         if (_activeProtocol == nullptr && ! data.empty())
         {
@@ -190,17 +268,62 @@ UserGUI::UserGUI(const char* opts, std::vector<AbstractProtocol* >& data)
 UserGUI::~UserGUI()
 {
     _running.clear();
+    {
+        std::unique_lock<std::mutex> lck(_wakeupMutex);
+        _stopRequested = true;
+    }
+    _wakeup.notify_all();
     _guiThread.join();
 }
 
-void UserGUI::update(AbstractProtocol* p, std::vector<std::size_t>& d)
+void UserGUI::parseOptions(const char* opts)
 {
-    std::vector<std::size_t>::iterator it;
-    std::vector<std::size_t>::iterator st;
-    std::unique_lock<std::mutex>lck(_statisticsDeltaMutex);
-    for (it = (_statisticsContainers.at(p)).begin(), st = d.begin(); it != (_statisticsContainers.at(p)).end() && st != d.end(); ++it, ++st)
+    enum
+    {
+        HEADLESS_SUBOPT_INDEX = 0,
+        MOVERS_SUBOPT_INDEX,
+        OUTPUT_SUBOPT_INDEX
+    };
+    char headlessSubOptName[] = "headless";
+    char moversSubOptName[] = "movers";
+    char outputSubOptName[] = "output";
+    char* const tokens[] =
+    {
+        headlessSubOptName,
+        moversSubOptName,
+        outputSubOptName,
+        NULL
+    };
+    std::vector<char> optsBuf{opts, opts + strlen(opts) + 1};
+    char* optionp = &optsBuf[0];
+    char* valuep;
+    while (*optionp != '\0')
     {
-        (*it) += (*st);
+        switch (getsubopt(&optionp, tokens, &valuep))
+        {
+        case HEADLESS_SUBOPT_INDEX:
+            _headless = true;
+            break;
+        case MOVERS_SUBOPT_INDEX:
+            if (valuep == nullptr)
+            {
+                throw std::invalid_argument {"movers requires a value"};
+            }
+            _movers = std::stoul(valuep);
+            break;
+        case OUTPUT_SUBOPT_INDEX:
+            if (valuep == nullptr)
+            {
+                throw std::invalid_argument {"output requires a value"};
+            }
+            _outputPath = valuep;
+            _headless = true;
+            break;
+        default:
+            // refresh timeout is the only suboption without name
+            _refresh_delta = std::stoul(valuep);
+            break;
+        }
     }
 }
 
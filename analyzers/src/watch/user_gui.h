@@ -23,33 +23,51 @@
 #define USERGUI_H
 //------------------------------------------------------------------------------
 #include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include <ncurses.h>
 #include "protocols/abstract_protocol.h"
+#include "pipeline_health.h"
+#include "protocol_counters.h"
 //------------------------------------------------------------------------------
 class UserGUI
 {
-public:
-    using ProtocolStatistic = std::vector<std::size_t>;
-    using StatisticsContainers = std::unordered_map<AbstractProtocol*, ProtocolStatistic>;
+    struct ProtocolEntry
+    {
+        AbstractProtocol* protocol;
+        std::unique_ptr<ProtocolCounters> counters; // written by parser thread
+        ProtocolRates rates;                        // used by GUI thread only
+    };
 
-private:
     unsigned long _refresh_delta; // in microseconds
+    bool _headless;               // rates are written as text instead of ncurses
+    std::string _outputPath;      // empty for standard output
+    std::size_t _movers;
 
     std::atomic<bool> _shouldResize;
-    std::mutex _statisticsDeltaMutex;
     std::atomic_flag _running;
+    std::mutex _wakeupMutex;
+    std::condition_variable _wakeup;
+    bool _stopRequested;          // guarded by _wakeupMutex
 
-    StatisticsContainers _statisticsContainers;
+    std::vector<ProtocolEntry> _protocols;
+    PipelineHealth _pipeline;
 
     AbstractProtocol* _activeProtocol;
     std::thread _guiThread;
     std::vector<std::string> _allProtocols;
     void run();
+    void runCurses();
+    void runHeadless();
+    void parseOptions(const char*);
+    void takeSnapshots();
+    ProtocolEntry* findProtocol(const std::string&);
     timeval getTimeval() const;
 public:
 
@@ -57,9 +75,26 @@ public:
     UserGUI(const char*, std::vector<AbstractProtocol* >&);
     ~UserGUI();
 
-    /*! Update Protocol's data.
+    /*! Account Protocol's procedure. Called by the parser thread, never blocks.
+    */
+    inline void update(AbstractProtocol* p, std::size_t procedure)
+    {
+        for (auto& entry : _protocols)
+        {
+            if (entry.protocol == p)
+            {
+                entry.counters->account(procedure);
+                return;
+            }
+        }
+    }
+
+    /*! Store metrics of nfstrace pipeline. Called by the parser thread, never blocks.
     */
-    void update(AbstractProtocol*, std::vector<std::size_t>&);
+    inline void updatePipeline(const NST::API::MetricsStat::Snapshot& metrics)
+    {
+        _pipeline.update(metrics);
+    }
 
     /*! Enable screen full update. Use for resize main window.
     */
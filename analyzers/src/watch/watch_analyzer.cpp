@@ -891,11 +891,14 @@ void WatchAnalyzer::on_unix_signal(int signo)
     }
 }
 
+void WatchAnalyzer::on_pipeline_metrics(const MetricsStat::Snapshot& metrics)
+{
+    gui.updatePipeline(metrics);
+}
+
 void WatchAnalyzer::cifs_account(AbstractProtocol &protocol, int cmd_code)
 {
-    std::vector<std::size_t> cifs_proc_count (static_cast<std::size_t>(protocol.getAmount()), 0);
-    ++cifs_proc_count[cmd_code];
-    gui.update(&protocol, cifs_proc_count);
+    gui.update(&protocol, static_cast<std::size_t>(cmd_code));
 }
 
 void WatchAnalyzer::nfs_account(const RPCProcedure* proc, const unsigned int nfs_minor_vers)
@@ -907,38 +910,28 @@ void WatchAnalyzer::nfs_account(const RPCProcedure* proc, const unsigned int nfs
     {
         if (nfs_minor_vers == NFS_V40)
         {
-            std::vector<std::size_t> nfs4_proc_count (ProcEnumNFS4::count, 0);
-            ++nfs4_proc_count[nfs_proc];
-            gui.update(&_nfsv4, nfs4_proc_count);
+            gui.update(&_nfsv4, nfs_proc);
         }
 
         if (nfs_minor_vers == NFS_V41 || nfs_proc == ProcEnumNFS4::NFS_NULL)
         {
-            std::vector<std::size_t> nfs41_proc_count (ProcEnumNFS41::count, 0);
-            ++nfs41_proc_count[nfs_proc];
-            gui.update(&_nfsv41, nfs41_proc_count);
+            gui.update(&_nfsv41, nfs_proc);
         }
     }
     else if (nfs_vers == NFS_V3)
     {
-        std::vector<std::size_t> nfs3_proc_count (ProcEnumNFS3::count, 0);
-        ++nfs3_proc_count[nfs_proc];
-        gui.update(&_nfsv3, nfs3_proc_count);
+        gui.update(&_nfsv3, nfs_proc);
     }
 }
 
 void WatchAnalyzer::account40_op(const RPCProcedure* /*proc*/, const ProcEnumNFS4::NFSProcedure operation)
 {
-    std::vector<std::size_t> nfs4_proc_count (ProcEnumNFS4::count, 0);
-    ++nfs4_proc_count[operation];
-    gui.update(&_nfsv4, nfs4_proc_count);
+    gui.update(&_nfsv4, operation);
 }
 
 void WatchAnalyzer::account41_op(const RPCProcedure* /*proc*/, const ProcEnumNFS41::NFSProcedure operation)
 {
-    std::vector<std::size_t> nfs41_proc_count (ProcEnumNFS41::count, 0);
-    ++nfs41_proc_count[operation];
-    gui.update(&_nfsv41, nfs41_proc_count);
+    gui.update(&_nfsv41, operation);
 }
 //------------------------------------------------------------------------------
 extern "C"
@@ -946,7 +939,10 @@ extern "C"
 
     const char* usage()
     {
-        return "User can set chrono output timeout in msec.\n"
+        return "<timeout> - Refresh timeout in microseconds (default is 900000)\n"
+               "headless - Write rates as text lines instead of ncurses screen\n"
+               "output - File to append text lines to (implies headless, default is standard output)\n"
+               "movers - Amount of procedures with the greatest change of rate to report (default is 3)\n"
                "You have to run nfstrace with verbosity level set to 0 (nfstrace -v 0 ...)";
     }
 
@@ -41,6 +41,7 @@ public:
 
     void flush_statistics() override final;
     void on_unix_signal(int signo) override final;
+    void on_pipeline_metrics(const MetricsStat::Snapshot& metrics) override final;
     // NFS v3
     virtual void null(const RPCProcedure*,
                       const struct NFS3::NULL3args*,
@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Reader of packets from memory image for FiltrationProcessor
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef MEMORY_READER_H
+#define MEMORY_READER_H
+//------------------------------------------------------------------------------
+#include <ostream>
+
+#include <pcap/pcap.h>
+
+#include "pcap_image.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace bench
+{
+
+/*! Replays packets of PcapImage through the interface FiltrationProcessor
+ *  expects from pcap readers (see filtration/pcap/base_reader.h).
+ */
+class MemoryReader
+{
+public:
+    explicit MemoryReader(const PcapImage& i)
+    : image   {i}
+    , stopped {false}
+    {
+    }
+    MemoryReader(const MemoryReader&)            = delete;
+    MemoryReader& operator=(const MemoryReader&) = delete;
+
+    // returns true if all packets were passed to callback
+    bool loop(void* user, pcap_handler callback)
+    {
+        for(const auto& packet : image.packets())
+        {
+            if(stopped) return false;
+
+            callback(reinterpret_cast<u_char*>(user), &packet.header, packet.data);
+        }
+        return true;
+    }
+
+    inline void break_loop()      { stopped = true;            }
+    inline int  datalink() const  { return image.datalink();   }
+    inline static const char* datalink_description(const int dlt) { return pcap_datalink_val_to_description(dlt); }
+
+    void print_statistic(std::ostream& /*out*/) const { /*dummy method*/ }
+    bool get_statistic(struct pcap_stat& /*stat*/) const { return false; }
+
+private:
+    const PcapImage& image;
+    bool stopped;
+};
+
+} // namespace bench
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//MEMORY_READER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Command line tool generating synthetic NFS/SMB captures
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pcap/pcap.h>
+#include <unistd.h>
+
+#include "pcap_writer.h"
+#include "traffic_generator.h"
+//------------------------------------------------------------------------------
+using namespace NST::bench;
+
+using Protocol = TrafficGenerator::Protocol;
+//------------------------------------------------------------------------------
+namespace // unnamed
+{
+
+void usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options] OUTPUT.pcap\n"
+                 "Generates call/reply conversations of NFS/SMB clients over Ethernet:IPv4:TCP.\n"
+                 "OUTPUT '-' means standard output.\n"
+                 "  -p LIST    protocols of clients: nfs3,nfs40,nfs41,smb2 (default is nfs3)\n"
+                 "  -c N       amount of clients (default is 16)\n"
+                 "  -n N       amount of operations (default is 100000)\n"
+                 "  -m MIX     weights of operations, e.g. getattr=30,lookup=15,access=10,\n"
+                 "             read=20,write=15,readdir=10 (default)\n"
+                 "  -s BYTES   size of reads and writes (default is 65536)\n"
+                 "  -e N       entries of directory listings (default is 32)\n"
+                 "  -M BYTES   TCP maximum segment size (default is 1448)\n"
+                 "  -w N       outstanding calls before a reply is sent (default is 8)\n"
+                 "  -l PERCENT lost TCP segments (default is 0)\n"
+                 "  -r PERCENT reordered TCP segments (default is 0)\n"
+                 "  -d N       max distance of reordering, segments (default is 4)\n"
+                 "  -R PERCENT retransmitted calls (default is 0)\n"
+                 "  -g NSEC    interval between packets (default is 1000)\n"
+                 "  -S SEED    seed of random generator (default is 1)" << std::endl;
+}
+
+std::vector<Protocol> parse_protocols(const char* list)
+{
+    std::vector<Protocol> protocols;
+    std::string value {list};
+    std::size_t begin {0};
+    while(begin <= value.size())
+    {
+        const std::size_t end {std::min(value.find(',', begin), value.size())};
+        const std::string name {value.substr(begin, end - begin)};
+        bool found {false};
+        for(Protocol p : {Protocol::NFSv3, Protocol::NFSv40, Protocol::NFSv41, Protocol::SMBv2})
+        {
+            if(name == TrafficGenerator::protocol_name(p))
+            {
+                protocols.push_back(p);
+                found = true;
+            }
+        }
+        if(!found)
+        {
+            throw std::runtime_error{"unknown protocol: " + name};
+        }
+        begin = end + 1;
+    }
+    return protocols;
+}
+
+void parse_mix(const char* opts, TrafficGenerator::Options& options)
+{
+    std::vector<char*> tokens;
+    std::vector<std::string> names;
+    for(uint32_t i {0}; i < TrafficGenerator::OPERATIONS_COUNT; ++i)
+    {
+        names.emplace_back(TrafficGenerator::operation_name(static_cast<TrafficGenerator::Operation>(i)));
+    }
+    for(auto& name : names)
+    {
+        tokens.push_back(&name[0]);
+    }
+    tokens.push_back(nullptr);
+
+    std::vector<char> buffer {opts, opts + strlen(opts) + 1};
+    char* optionp {buffer.data()};
+    char* valuep;
+    int index;
+    while(*optionp != '\0')
+    {
+        index = getsubopt(&optionp, tokens.data(), &valuep);
+        if(index < 0 || !valuep)
+        {
+            throw std::runtime_error{std::string{"invalid operation mix: "} + opts};
+        }
+        options.mix[index] = static_cast<uint32_t>(std::strtoul(valuep, nullptr, 10));
+    }
+}
+
+double percent(const char* value)
+{
+    return std::strtod(value, nullptr) / 100.0;
+}
+
+} // unnamed namespace
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) try
+{
+    TrafficGenerator::Options options;
+    int opt;
+    while((opt = getopt(argc, argv, "p:c:n:m:s:e:M:w:l:r:d:R:g:S:h")) != -1)
+    {
+        switch(opt)
+        {
+        case 'p': options.protocols     = parse_protocols(optarg);                         break;
+        case 'c': options.clients       = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'n': options.operations    = std::strtoull(optarg, nullptr, 10);              break;
+        case 'm': parse_mix(optarg, options);                                              break;
+        case 's': options.io_size       = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'e': options.dir_entries   = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'M': options.mss           = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'w': options.window        = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'l': options.loss          = percent(optarg);                                 break;
+        case 'r': options.reorder       = percent(optarg);                                 break;
+        case 'd': options.reorder_depth = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'R': options.retransmit    = percent(optarg);                                 break;
+        case 'g': options.gap           = std::strtoull(optarg, nullptr, 10);              break;
+        case 'S': options.seed          = std::strtoull(optarg, nullptr, 10);              break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(optind + 1 != argc)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    PcapWriter writer {argv[optind], 65535, DLT_EN10MB};
+    TrafficGenerator generator {options, writer};
+
+    const auto start = std::chrono::steady_clock::now();
+    generator.run();
+    const std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+
+    const TrafficGenerator::Statistic& stat = generator.statistic();
+    std::cerr << std::fixed << std::setprecision(2)
+              << "operations:    " << stat.operations    << '\n'
+              << "connections:   " << stat.connections   << '\n'
+              << "packets:       " << writer.packets()   << '\n'
+              << "bytes:         " << writer.bytes()     << '\n'
+              << "lost:          " << stat.lost          << '\n'
+              << "reordered:     " << stat.reordered     << '\n'
+              << "retransmitted: " << stat.retransmitted << '\n'
+              << "time:          " << elapsed.count()    << " s, "
+              << static_cast<double>(writer.packets()) / elapsed.count() << " packets/s, "
+              << static_cast<double>(writer.bytes()) / elapsed.count() / (1024 * 1024) << " MiB/s" << std::endl;
+    return EXIT_SUCCESS;
+}
+catch (const std::exception& e)
+{
+    std::cerr << argv[0] << ": " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
+//------------------------------------------------------------------------------
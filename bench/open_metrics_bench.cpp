@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Benchmark of OpenMetrics scrapes of the json module
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "open_metrics_writer.h"
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    const std::size_t series  = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000U;
+    const std::size_t scrapes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000U;
+    if (series == 0U || scrapes == 0U)
+    {
+        std::cerr << "Usage: " << argv[0] << " [SERIES [SCRAPES]]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> labels;
+    for (std::size_t i = 0U; i < series; ++i)
+    {
+        labels.emplace_back("version=\"4.1\",operation=\"op" + std::to_string(i) + '"');
+    }
+
+    std::string output;
+    auto started = std::chrono::steady_clock::now();
+    for (std::size_t scrape = 0U; scrape < scrapes; ++scrape)
+    {
+        output.clear();
+        OpenMetricsWriter writer{output};
+        writer.family("nfstrace_nfs_operations", "counter", "NFSv4.x operations of COMPOUND procedures observed.");
+        for (std::size_t i = 0U; i < series; ++i)
+        {
+            writer.sample("nfstrace_nfs_operations", "_total", labels[i], scrape * series + i);
+        }
+        writer.finish();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+
+    std::cout << "Scrape of " << series << " series: "
+              << elapsed.count() / scrapes << " us, "
+              << output.length() << " bytes" << std::endl;
+    return EXIT_SUCCESS;
+}
+//------------------------------------------------------------------------------
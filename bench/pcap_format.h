@@ -0,0 +1,65 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Structures of pcap file format
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef PCAP_FORMAT_H
+#define PCAP_FORMAT_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace bench
+{
+namespace pcap_format
+{
+
+// Magic numbers of pcap file format
+const uint32_t MagicMicroseconds {0xa1b2c3d4};
+const uint32_t MagicNanoseconds  {0xa1b23c4d};
+
+const uint16_t VersionMajor {2};
+const uint16_t VersionMinor {4};
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t  thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+};
+
+struct RecordHeader
+{
+    uint32_t ts_sec;
+    uint32_t ts_frac;   // microseconds or nanoseconds
+    uint32_t incl_len;
+    uint32_t orig_len;
+};
+
+} // namespace pcap_format
+} // namespace bench
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//PCAP_FORMAT_H
+//------------------------------------------------------------------------------
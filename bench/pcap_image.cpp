@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Pcap file preloaded to memory for benchmarking
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pcap_format.h"
+#include "pcap_image.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace bench
+{
+namespace // unnamed
+{
+
+using namespace pcap_format;
+
+inline uint32_t swap32(uint32_t v)
+{
+    return ((v & 0xFF000000) >> 24)
+         | ((v & 0x00FF0000) >> 8)
+         | ((v & 0x0000FF00) << 8)
+         | ((v & 0x000000FF) << 24);
+}
+
+} // unnamed namespace
+
+PcapImage::PcapImage(const std::string& path)
+: file    {path}
+, memory  {nullptr}
+, length  {0}
+, linktype{0}
+, index   {}
+{
+    const int fd {open(path.c_str(), O_RDONLY)};
+    if(fd == -1)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in opening file: " + path}};
+    }
+    struct stat st;
+    if(fstat(fd, &st) == -1 || st.st_size < static_cast<off_t>(sizeof(FileHeader)))
+    {
+        close(fd);
+        throw std::runtime_error{"Not a pcap file: " + path};
+    }
+    length = static_cast<std::size_t>(st.st_size);
+
+    int flags {MAP_PRIVATE};
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;
+#endif
+    void* mapped {mmap(nullptr, length, PROT_READ, flags, fd, 0)};
+    close(fd);
+    if(mapped == MAP_FAILED)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in mapping file: " + path}};
+    }
+    memory = static_cast<uint8_t*>(mapped);
+
+    // Touch each page, so page faults are not measured by benchmark
+    const long page {sysconf(_SC_PAGESIZE)};
+    volatile uint8_t sum {0};
+    for(std::size_t i {0}; i < length; i += static_cast<std::size_t>(page))
+    {
+        sum += memory[i];
+    }
+
+    try
+    {
+        build_index();
+    }
+    catch(...)
+    {
+        munmap(memory, length);
+        throw;
+    }
+}
+
+PcapImage::~PcapImage()
+{
+    munmap(memory, length);
+}
+
+void PcapImage::build_index()
+{
+    FileHeader header;
+    memcpy(&header, memory, sizeof(header));
+
+    bool swapped {false};
+    bool nanoseconds {false};
+    if(header.magic == MagicMicroseconds || header.magic == swap32(MagicMicroseconds))
+    {
+        swapped = header.magic != MagicMicroseconds;
+    }
+    else if(header.magic == MagicNanoseconds || header.magic == swap32(MagicNanoseconds))
+    {
+        swapped = header.magic != MagicNanoseconds;
+        nanoseconds = true;
+    }
+    else
+    {
+        throw std::runtime_error{"Not a pcap file: " + file};
+    }
+    auto host = [swapped](uint32_t v) { return swapped ? swap32(v) : v; };
+    linktype = static_cast<int>(host(header.network));
+
+    std::size_t offset {sizeof(FileHeader)};
+    while(offset + sizeof(RecordHeader) <= length)
+    {
+        RecordHeader record;
+        memcpy(&record, memory + offset, sizeof(record));
+        offset += sizeof(RecordHeader);
+
+        const uint32_t caplen {host(record.incl_len)};
+        if(caplen > length - offset)
+        {
+            break; // the last packet is truncated
+        }
+        Packet packet;
+        packet.header.ts.tv_sec  = host(record.ts_sec);
+        packet.header.ts.tv_usec = nanoseconds ? host(record.ts_frac) / 1000 : host(record.ts_frac);
+        packet.header.caplen     = caplen;
+        packet.header.len        = host(record.orig_len);
+        packet.data              = memory + offset;
+        index.push_back(packet);
+
+        offset += caplen;
+    }
+}
+
+} // namespace bench
+} // namespace NST
+//------------------------------------------------------------------------------
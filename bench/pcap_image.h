@@ -1,7 +1,7 @@
 //------------------------------------------------------------------------------
-// Author: Pavel Karneliuk
-// Description: Dumping pcap frames to a file.
-// Copyright (c) 2013 EPAM Systems
+// Author: Andrey Kuznetsov
+// Description: Pcap file preloaded to memory for benchmarking
+// Copyright (c) 2015 EPAM Systems
 //------------------------------------------------------------------------------
 /*
     This file is part of Nfstrace.
@@ -19,62 +19,55 @@
     along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
 */
 //------------------------------------------------------------------------------
-#ifndef PACKET_DUMPER_H
-#define PACKET_DUMPER_H
+#ifndef PCAP_IMAGE_H
+#define PCAP_IMAGE_H
 //------------------------------------------------------------------------------
-#include <pcap/pcap.h>
+#include <cstdint>
+#include <string>
+#include <vector>
 
-#include "filtration/pcap/pcap_error.h"
+#include <pcap/pcap.h>
 //------------------------------------------------------------------------------
 namespace NST
 {
-namespace filtration
-{
-namespace pcap
+namespace bench
 {
 
-class PacketDumper
+/*! Pcap file mapped to memory with prefaulted pages and an index of packets.
+ *  Headers of packets are decoded once, so replay of the image costs no file
+ *  I/O and no libpcap calls.
+ */
+class PcapImage
 {
 public:
-    PacketDumper(pcap_t* handle, const char* path)
-    : dumper{ pcap_dump_open(handle, path) }
-    {
-        if(dumper == nullptr)
-        {
-            throw PcapError{"pcap_dump_open", pcap_geterr(handle)};
-        }
-    }
-    PacketDumper(const PacketDumper&)            = delete;
-    PacketDumper& operator=(const PacketDumper&) = delete;
-    ~PacketDumper()
+    struct Packet
     {
-        pcap_dump_close(dumper);
-    }
+        struct pcap_pkthdr header;
+        const u_char* data;
+    };
 
-    inline void dump(const pcap_pkthdr *h, const u_char *sp)
-    {
-        pcap_dump((u_char*)dumper, h, sp);
-    }
-
-    inline void                flush() { pcap_dump_flush(dumper); }
-    inline pcap_dumper_t* get_dumper() { return dumper; }
-    inline FILE*          get_stream() { return pcap_dump_file(dumper); }
+    explicit PcapImage(const std::string& path);
+    ~PcapImage();
+    PcapImage(const PcapImage&)            = delete;
+    PcapImage& operator=(const PcapImage&) = delete;
 
-    void truncate_all_pcap_data_and_header()
-    {
-        pcap_dump_flush(dumper);
-        FILE* stream {pcap_dump_file(dumper)};
-        rewind(stream); // truncate a file to zero
-        pcap_dump_flush(dumper);
-    }
+    inline const std::string& path()             const { return file;    }
+    inline int datalink()                        const { return linktype; }
+    inline std::size_t size()                    const { return length;  }
+    inline const std::vector<Packet>& packets()  const { return index;   }
 
 private:
-    pcap_dumper_t* dumper;
+    void build_index();
+
+    std::string file;
+    uint8_t* memory;
+    std::size_t length;
+    int linktype;
+    std::vector<Packet> index;
 };
 
-} // namespace pcap
-} // namespace filtration
+} // namespace bench
 } // namespace NST
 //------------------------------------------------------------------------------
-#endif//PACKET_DUMPER_H
+#endif//PCAP_IMAGE_H
 //------------------------------------------------------------------------------
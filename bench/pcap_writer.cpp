@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Buffered writer of pcap files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include "pcap_format.h"
+#include "pcap_writer.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace bench
+{
+namespace // unnamed
+{
+
+using namespace pcap_format;
+
+const std::size_t BufferSize {4 * 1024 * 1024};
+
+} // unnamed namespace
+
+PcapWriter::PcapWriter(const std::string& path, uint32_t snaplen, int datalink)
+: file_path {path}
+, file      {nullptr}
+, buffer    (BufferSize)
+, used      {0}
+, written   {0}
+, amount    {0}
+{
+    if(path == "-")
+    {
+        file = stdout;
+    }
+    else
+    {
+        file = fopen(path.c_str(), "wb");
+        if(!file)
+        {
+            throw std::system_error{errno, std::system_category(), {"Error in opening file: " + path}};
+        }
+    }
+
+    FileHeader header;
+    header.magic         = MagicMicroseconds;
+    header.version_major = VersionMajor;
+    header.version_minor = VersionMinor;
+    header.thiszone      = 0;
+    header.sigfigs       = 0;
+    header.snaplen       = snaplen;
+    header.network       = static_cast<uint32_t>(datalink);
+    append(&header, sizeof(header));
+}
+
+PcapWriter::~PcapWriter()
+{
+    try
+    {
+        flush();
+    }
+    catch(...)
+    {
+    }
+    if(file != stdout)
+    {
+        fclose(file);
+    }
+}
+
+void PcapWriter::packet(uint64_t time,
+                        const uint8_t* header, uint32_t header_len,
+                        const uint8_t* data,   uint32_t data_len,
+                        uint32_t zeros)
+{
+    const uint32_t len {header_len + data_len + zeros};
+
+    RecordHeader record;
+    record.ts_sec   = static_cast<uint32_t>(time / 1000000000U);
+    record.ts_frac  = static_cast<uint32_t>(time % 1000000000U / 1000U);
+    record.incl_len = len;
+    record.orig_len = len;
+
+    if(used + sizeof(record) + len > buffer.size())
+    {
+        flush();
+        if(sizeof(record) + len > buffer.size())
+        {
+            buffer.resize(sizeof(record) + len);
+        }
+    }
+    append(&record, sizeof(record));
+    append(header, header_len);
+    append(data, data_len);
+    memset(buffer.data() + used, 0, zeros);
+    used += zeros;
+    ++amount;
+}
+
+void PcapWriter::flush()
+{
+    write(buffer.data(), used);
+    written += used;
+    used = 0;
+    if(fflush(file) != 0)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in writing file: " + file_path}};
+    }
+}
+
+inline void PcapWriter::append(const void* data, std::size_t len)
+{
+    if(len != 0)
+    {
+        memcpy(buffer.data() + used, data, len);
+        used += len;
+    }
+}
+
+void PcapWriter::write(const uint8_t* data, std::size_t len)
+{
+    if(len != 0 && fwrite(data, len, 1, file) != 1)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in writing file: " + file_path}};
+    }
+}
+
+} // namespace bench
+} // namespace NST
+//------------------------------------------------------------------------------
@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Buffered writer of pcap files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef PCAP_WRITER_H
+#define PCAP_WRITER_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace bench
+{
+
+/*! Writer of pcap files with microsecond timestamps.
+ *  Records are assembled in a large buffer and passed to the file in blocks,
+ *  payload may be given as a part of real data followed by zero bytes, so
+ *  bulk data of generated traffic is never materialized.
+ *  Path "-" means standard output.
+ */
+class PcapWriter
+{
+public:
+    PcapWriter(const std::string& path, uint32_t snaplen, int datalink);
+    ~PcapWriter();
+    PcapWriter(const PcapWriter&)            = delete;
+    PcapWriter& operator=(const PcapWriter&) = delete;
+
+    //! Appends packet of (header_len + data_len + zeros) bytes captured at time (ns)
+    void packet(uint64_t time,
+                const uint8_t* header, uint32_t header_len,
+                const uint8_t* data,   uint32_t data_len,
+                uint32_t zeros);
+    void flush();
+
+    inline uint64_t bytes()   const { return written + used; }
+    inline uint64_t packets() const { return amount;         }
+
+private:
+    inline void append(const void* data, std::size_t len);
+    void write(const uint8_t* data, std::size_t len);
+
+    std::string file_path;
+    FILE* file;
+    std::vector<uint8_t> buffer;
+    std::size_t used;
+    uint64_t written;
+    uint64_t amount;
+};
+
+} // namespace bench
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//PCAP_WRITER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,575 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: End-to-end benchmark of filtration and analysis pipeline
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "analysis/analyzers.h"
+#include "analysis/parser_thread.h"
+#include "analysis/parsers.h"
+#include "controller/parameters.h"
+#include "controller/running_status.h"
+#include "filtration/filtration_processor.h"
+#include "filtration/filtrators.h"
+#include "filtration/queuing.h"
+#include "utils/filtered_data.h"
+#include "utils/log.h"
+#include "utils/metrics.h"
+#include "utils/probes.h"
+#include "utils/out.h"
+#include "memory_reader.h"
+#include "pcap_image.h"
+//------------------------------------------------------------------------------
+using namespace NST;
+using namespace NST::bench;
+
+using Parameters        = NST::controller::Parameters;
+using RunningStatus     = NST::controller::RunningStatus;
+using FilteredDataQueue = NST::utils::FilteredDataQueue;
+//------------------------------------------------------------------------------
+namespace // unnamed
+{
+
+const int ExitRegression {2};
+
+// Queueing which counts messages passed to the queue
+class CountingQueueing : public filtration::Queueing
+{
+public:
+    class Collection : public filtration::Queueing::Collection
+    {
+    public:
+        inline Collection() noexcept
+        : filtration::Queueing::Collection{}
+        , counter{nullptr}
+        {
+        }
+        inline Collection(CountingQueueing* q, utils::NetworkSession* s) noexcept
+        : filtration::Queueing::Collection{q, s}
+        , counter{&q->messages}
+        {
+        }
+
+        inline void set(CountingQueueing& q, utils::NetworkSession* s)
+        {
+            filtration::Queueing::Collection::set(q, s);
+            counter = &q.messages;
+        }
+
+        inline void complete(const filtration::PacketInfo& info)
+        {
+            filtration::Queueing::Collection::complete(info);
+            ++(*counter);
+        }
+
+    private:
+        uint64_t* counter;
+    };
+
+    explicit CountingQueueing(FilteredDataQueue& q)
+    : filtration::Queueing{q}
+    , messages{0}
+    {
+    }
+
+    uint64_t messages; // written and read by filtration thread only
+};
+
+using Filtration = filtration::FiltrationProcessor<MemoryReader,
+                                                   CountingQueueing,
+                                                   filtration::Filtrators<CountingQueueing>>;
+
+// Progress of parser thread shared with benchmark thread
+struct ParsingStage
+{
+    std::atomic<uint64_t> messages {0};
+    std::atomic<bool>     started  {false};
+    std::atomic<bool>     failed   {false};
+    clockid_t             clock;    // CPU-time clock of parser thread, valid if started
+};
+
+// Parsers which count parsed messages for ParserThread
+class TimedParser
+{
+public:
+    TimedParser(analysis::Parsers& p, ParsingStage& s)
+    : parser(p)
+    , stage (s)
+    {
+    }
+
+    inline void parse_data(FilteredDataQueue::Ptr& data)
+    {
+        if(!stage.started.load(std::memory_order_relaxed))
+        {
+            pthread_getcpuclockid(pthread_self(), &stage.clock);
+            stage.started.store(true, std::memory_order_release);
+        }
+        try
+        {
+            parser.parse_data(data);
+        }
+        catch(...)
+        {
+            stage.failed.store(true, std::memory_order_release);
+            throw;
+        }
+        stage.messages.store(stage.messages.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    analysis::Parsers& parser;
+    ParsingStage& stage;
+};
+
+struct Options
+{
+    std::vector<std::string> modules;
+    std::vector<std::string> captures;
+    std::vector<std::string> passthrough; // options of nfstrace after '--'
+    unsigned    loops     {1};
+    std::string output;
+    std::string baseline;
+    double      tolerance {10.0}; // percents
+    std::string log       {"nfstrace-bench.log"};
+};
+
+struct Result
+{
+    std::string name;
+    uint64_t bytes;
+    uint64_t packets;
+    uint64_t messages;      // RPC and SMB messages passed to the queue
+    uint64_t procedures;    // procedures passed to analyzers
+    uint64_t wall_ns;       // from the first packet till the last message is parsed
+    uint64_t read_ns;       // replay of memory image only
+    uint64_t filtration_ns; // CPU time of filtration thread
+    uint64_t parsing_ns;    // CPU time of parser thread
+    long     peak_rss_kb;
+};
+
+inline uint64_t nanoseconds(const struct timespec& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000U + static_cast<uint64_t>(time.tv_nsec);
+}
+
+uint64_t cpu_time(clockid_t clock)
+{
+    struct timespec time;
+    if(clock_gettime(clock, &time) == -1)
+    {
+        return 0;
+    }
+    return nanoseconds(time);
+}
+
+uint64_t wall_time()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Resets peak RSS of the process (Linux 4.0+), ignored elsewhere
+void reset_peak_rss()
+{
+    if(FILE* file = fopen("/proc/self/clear_refs", "w"))
+    {
+        fputs("5", file);
+        fclose(file);
+    }
+}
+
+long peak_rss_kb()
+{
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == -1)
+    {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
+void count_packet(u_char* user, const struct pcap_pkthdr* header, const u_char* /*packet*/)
+{
+    *reinterpret_cast<uint64_t*>(user) += header->caplen;
+}
+
+// Time of replay of memory image without processing
+uint64_t measure_read(const PcapImage& image, unsigned loops)
+{
+    uint64_t bytes {0};
+    const uint64_t start {cpu_time(CLOCK_THREAD_CPUTIME_ID)};
+    for(unsigned i {0}; i < loops; ++i)
+    {
+        MemoryReader reader{image};
+        reader.loop(&bytes, &count_packet);
+    }
+    const uint64_t duration {cpu_time(CLOCK_THREAD_CPUTIME_ID) - start};
+    return bytes != 0 ? duration : 0;
+}
+
+// Value of metric merged from all threads, metrics are kept through all runs
+int64_t metric_value(uint32_t metric)
+{
+    API::MetricsStat::Snapshot snapshot;
+    utils::Metrics::statistic().snapshot(snapshot);
+    return snapshot.metrics[metric].value;
+}
+
+// Waits for parser thread, it sleeps between rounds of processing of the queue
+bool wait_parsed(const ParsingStage& stage, uint64_t messages)
+{
+    while(stage.messages.load(std::memory_order_acquire) < messages)
+    {
+        if(stage.failed.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+}
+
+Result run(const Parameters& params, const PcapImage& image, unsigned loops)
+{
+    reset_peak_rss();
+
+    Result result{};
+    const std::string& path {image.path()};
+    result.name    = path.substr(path.find_last_of('/') + 1);
+    result.bytes   = static_cast<uint64_t>(image.size()) * loops;
+    result.packets = static_cast<uint64_t>(image.packets().size()) * loops;
+    result.read_ns = measure_read(image, loops);
+
+    analysis::Analyzers analyzers{params};
+    FilteredDataQueue queue{params.queue_capacity(), 1};
+    RunningStatus status;
+    ParsingStage stage;
+    analysis::Parsers parsers{analyzers};
+    TimedParser parser{parsers, stage};
+    analysis::ParserThread<TimedParser> parsing{parser, queue, status, analyzers};
+
+    const int64_t procedures {metric_value(utils::Metrics::Procedures)};
+    const uint64_t wall_start {wall_time()};
+    const uint64_t cpu_start {cpu_time(CLOCK_THREAD_CPUTIME_ID)};
+    parsing.start();
+    for(unsigned i {0}; i < loops; ++i)
+    {
+        // New processor for each loop, so TCP streams are reassembled from scratch
+        std::unique_ptr<MemoryReader> reader{new MemoryReader{image}};
+        std::unique_ptr<CountingQueueing> writer{new CountingQueueing{queue}};
+        const CountingQueueing& counter = *writer;
+
+        Filtration processor{reader, writer};
+        try
+        {
+            processor.run();
+        }
+        catch(const controller::ProcessingDone&)
+        {
+        }
+        result.messages += counter.messages;
+
+        // Queued messages refer to sessions of the processor, so it is kept
+        // until the queue is drained. Draining after each loop also keeps
+        // the backlog of the queue and peak RSS independent of loops
+        if(!wait_parsed(stage, result.messages))
+        {
+            break;
+        }
+    }
+    result.filtration_ns = cpu_time(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    result.wall_ns = wall_time() - wall_start;
+    if(stage.started.load(std::memory_order_acquire))
+    {
+        result.parsing_ns = cpu_time(stage.clock);
+    }
+    parsing.stop();
+    if(stage.failed.load(std::memory_order_acquire))
+    {
+        status.wait_and_rethrow_exception();
+    }
+
+    result.procedures  = static_cast<uint64_t>(metric_value(utils::Metrics::Procedures) - procedures);
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+inline double per_second(uint64_t amount, uint64_t ns)
+{
+    return ns != 0 ? static_cast<double>(amount) * 1e9 / static_cast<double>(ns) : 0.0;
+}
+
+inline double per_item(uint64_t ns, uint64_t amount)
+{
+    return amount != 0 ? static_cast<double>(ns) / static_cast<double>(amount) : 0.0;
+}
+
+std::string quoted(const std::string& str)
+{
+    std::string result{"\""};
+    for(const char c : str)
+    {
+        if(c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result += '"';
+}
+
+// One value per line, so a baseline can be read back by read_baseline()
+void write_json(std::ostream& out, const Options& options, const std::vector<Result>& results)
+{
+    out << std::fixed << std::setprecision(1);
+    out << "{\n";
+    out << "  \"modules\": [";
+    for(std::size_t i {0}; i < options.modules.size(); ++i)
+    {
+        out << (i ? ", " : "") << quoted(options.modules[i]);
+    }
+    out << "],\n";
+    out << "  \"loops\": " << options.loops << ",\n";
+    out << "  \"captures\": [\n";
+    for(std::size_t i {0}; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        out << "    {\n"
+            << "      \"name\": " << quoted(r.name) << ",\n"
+            << "      \"bytes\": " << r.bytes << ",\n"
+            << "      \"packets\": " << r.packets << ",\n"
+            << "      \"messages\": " << r.messages << ",\n"
+            << "      \"rpcs\": " << r.procedures << ",\n"
+            << "      \"seconds\": " << std::setprecision(6) << r.wall_ns / 1e9 << std::setprecision(1) << ",\n"
+            << "      \"packets_per_sec\": " << per_second(r.packets, r.wall_ns) << ",\n"
+            << "      \"rpcs_per_sec\": " << per_second(r.procedures, r.wall_ns) << ",\n"
+            << "      \"mbytes_per_sec\": " << per_second(r.bytes, r.wall_ns) / (1024 * 1024) << ",\n"
+            << "      \"stages\": {\n"
+            << "        \"read\": {\"ns_per_packet\": " << per_item(r.read_ns, r.packets) << "},\n"
+            << "        \"filtration\": {\"ns_per_packet\": " << per_item(r.filtration_ns, r.packets)
+            << ", \"cpu_seconds\": " << std::setprecision(6) << r.filtration_ns / 1e9 << std::setprecision(1) << "},\n"
+            << "        \"parsing\": {\"ns_per_packet\": " << per_item(r.parsing_ns, r.packets)
+            << ", \"ns_per_message\": " << per_item(r.parsing_ns, r.messages)
+            << ", \"cpu_seconds\": " << std::setprecision(6) << r.parsing_ns / 1e9 << std::setprecision(1) << "}\n"
+            << "      },\n"
+            << "      \"peak_rss_kb\": " << r.peak_rss_kb << "\n"
+            << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+    out << "  \"peak_rss_kb\": " << peak_rss_kb() << "\n";
+    out << "}" << std::endl;
+}
+
+// Reads packets/s of captures from a report written by write_json()
+std::map<std::string, double> read_baseline(const std::string& path)
+{
+    std::ifstream in{path};
+    if(!in)
+    {
+        throw std::runtime_error{"Error in opening baseline: " + path};
+    }
+    std::map<std::string, double> baseline;
+    std::string name;
+    std::string line;
+    while(std::getline(in, line))
+    {
+        const auto colon = line.find(':');
+        if(colon == std::string::npos)
+        {
+            continue;
+        }
+        const std::string key {line.substr(0, colon)};
+        std::string value {line.substr(colon + 1)};
+        value.erase(0, value.find_first_not_of(' '));
+        if(key.find("\"name\"") != std::string::npos)
+        {
+            name = value.substr(1, value.rfind('"') - 1);
+        }
+        else if(key.find("\"packets_per_sec\"") != std::string::npos && !name.empty())
+        {
+            baseline[name] = std::strtod(value.c_str(), nullptr);
+        }
+    }
+    return baseline;
+}
+
+// Returns amount of captures slower than baseline more than tolerated
+unsigned compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double tolerance)
+{
+    unsigned regressions {0};
+    for(const Result& r : results)
+    {
+        const auto found = baseline.find(r.name);
+        if(found == baseline.end() || found->second <= 0.0)
+        {
+            std::cerr << r.name << ": no baseline" << std::endl;
+            continue;
+        }
+        const double current {per_second(r.packets, r.wall_ns)};
+        const double change {(current / found->second - 1.0) * 100.0};
+        const bool regression {change < -tolerance};
+        std::cerr << r.name << ": " << std::fixed << std::setprecision(1)
+                  << current << " packets/s, baseline " << found->second
+                  << " (" << std::showpos << change << std::noshowpos << "%)"
+                  << (regression ? " REGRESSION" : "") << std::endl;
+        if(regression)
+        {
+            ++regressions;
+        }
+    }
+    return regressions;
+}
+
+void usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [options] CAPTURE.pcap... [-- nfstrace options]\n"
+                 "Replays captures from memory through filtration, queue, parser thread and\n"
+                 "analysis modules of nfstrace and reports throughput as JSON.\n"
+                 "  -a PATH#opts  analysis module, may be repeated (default is " NST_BENCH_DEFAULT_MODULE ")\n"
+                 "  -n LOOPS      replay each capture LOOPS times (default is 1)\n"
+                 "  -o FILE       write report to FILE (default is standard output)\n"
+                 "  -b FILE       compare packets/s with baseline report, exit with code 2 on regression\n"
+                 "  -t PERCENT    tolerated slowdown against baseline (default is 10)\n"
+                 "  -l FILE       log file of nfstrace (default is nfstrace-bench.log)" << std::endl;
+}
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    int opt;
+    // '+' stops at the first capture, so options of nfstrace are not permuted
+    while((opt = getopt(argc, argv, "+a:n:o:b:t:l:h")) != -1)
+    {
+        switch(opt)
+        {
+        case 'a': options.modules.emplace_back(optarg);                      break;
+        case 'n': options.loops = std::max(1, std::atoi(optarg));            break;
+        case 'o': options.output = optarg;                                   break;
+        case 'b': options.baseline = optarg;                                 break;
+        case 't': options.tolerance = std::strtod(optarg, nullptr);          break;
+        case 'l': options.log = optarg;                                      break;
+        default:
+            usage(argv[0]);
+            std::exit(opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+    int i {optind};
+    for(; i < argc && std::string{argv[i]} != "--"; ++i)
+    {
+        options.captures.emplace_back(argv[i]);
+    }
+    for(++i; i < argc; ++i)
+    {
+        options.passthrough.emplace_back(argv[i]);
+    }
+    if(options.captures.empty())
+    {
+        usage(argv[0]);
+        std::exit(EXIT_FAILURE);
+    }
+    if(options.modules.empty())
+    {
+        options.modules.emplace_back(NST_BENCH_DEFAULT_MODULE);
+    }
+    return options;
+}
+
+} // unnamed namespace
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) try
+{
+    const Options options {parse_options(argc, argv)};
+
+    // Parameters of nfstrace are set as if they were passed in its command line
+    std::vector<std::string> args {argv[0], "--mode=stat", "--verbose=0", "--log=" + options.log};
+    for(const auto& module : options.modules)
+    {
+        args.emplace_back("--analysis=" + module);
+    }
+    args.insert(args.end(), options.passthrough.begin(), options.passthrough.end());
+    std::vector<char*> cargs;
+    for(auto& arg : args)
+    {
+        cargs.push_back(&arg[0]);
+    }
+    cargs.push_back(nullptr);
+    optind = 1; // restart getopt_long() for parser of Parameters
+    Parameters params(static_cast<int>(args.size()), cargs.data());
+
+    utils::Out::Global gout{utils::Out::Level::Silent};
+    utils::Log::Global glog{params.log_path()};
+    if(params.probes())
+    {
+        utils::Probes::enable();
+    }
+
+    std::vector<Result> results;
+    for(const auto& capture : options.captures)
+    {
+        PcapImage image{capture};
+        results.emplace_back(run(params, image, options.loops));
+    }
+    if(utils::Probes::enabled())
+    {
+        utils::Probes::print(std::cerr);
+    }
+
+    if(options.output.empty())
+    {
+        write_json(std::cout, options, results);
+    }
+    else
+    {
+        std::ofstream out{options.output};
+        write_json(out, options, results);
+    }
+
+    if(!options.baseline.empty())
+    {
+        if(compare(results, read_baseline(options.baseline), options.tolerance) != 0)
+        {
+            return ExitRegression;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+catch (const std::exception& e)
+{
+    std::cerr << argv[0] << ": " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Benchmark of single-writer counters of the json module read by scrapers
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "seq_counter.h"
+//------------------------------------------------------------------------------
+namespace // unnamed
+{
+
+constexpr std::size_t ScrapersAmount = 4U;
+
+struct BlockCounters
+{
+    enum Index : std::size_t
+    {
+        nullProcsAmount,
+        getattrProcsAmount,
+        lookupProcsAmount,
+        accessProcsAmount,
+        readProcsAmount,
+        writeProcsAmount,
+        createProcsAmount,
+        commitProcsAmount,
+        Amount
+    };
+};
+
+struct alignas(64) Block : BlockCounters, SeqCounters<BlockCounters::Amount>
+{
+};
+
+struct alignas(64) SharedBlock
+{
+    std::atomic<uint64_t> counters[Block::CountersAmount];
+};
+
+//! Runs callbacks of the writer while scrapers read counters, returns ns per callback
+template <typename Callback, typename Scrape>
+double measure(uint64_t calls, Callback callback, Scrape scrape)
+{
+    std::atomic<bool> running{true};
+    std::vector<std::thread> scrapers;
+    for (std::size_t i = 0U; i < ScrapersAmount; ++i)
+    {
+        scrapers.emplace_back([&]()
+        {
+            while (running.load(std::memory_order_relaxed))
+            {
+                scrape();
+            }
+        });
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    for (uint64_t i = 0U; i < calls; ++i)
+    {
+        callback(i % Block::CountersAmount);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+
+    running = false;
+    for (auto& scraper : scrapers)
+    {
+        scraper.join();
+    }
+    return static_cast<double>(elapsed.count()) / calls;
+}
+
+} // unnamed namespace
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    const uint64_t calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000U;
+    if (calls == 0U)
+    {
+        std::cerr << "Usage: " << argv[0] << " [CALLS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Block block;
+    const double seqCounterNs = measure(calls, [&](std::size_t i)
+    {
+        block.increment(i);
+    },
+    [&]()
+    {
+        uint64_t values[Block::CountersAmount];
+        block.read([&]()
+        {
+            for (std::size_t i = 0U; i < Block::CountersAmount; ++i)
+            {
+                values[i] = block.load(i);
+            }
+        });
+        (void)values;
+    });
+
+    SharedBlock shared;
+    for (auto& counter : shared.counters)
+    {
+        counter.store(0U);
+    }
+    const double fetchAddNs = measure(calls, [&](std::size_t i)
+    {
+        shared.counters[i].fetch_add(1U);
+    },
+    [&]()
+    {
+        uint64_t values[Block::CountersAmount];
+        for (std::size_t i = 0U; i < Block::CountersAmount; ++i)
+        {
+            values[i] = shared.counters[i].load();
+        }
+        (void)values;
+    });
+
+    uint64_t total = 0U;
+    for (std::size_t i = 0U; i < Block::CountersAmount; ++i)
+    {
+        total += block.load(i);
+    }
+    if (total != calls)
+    {
+        std::cerr << "Lost increments: " << calls - total << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Callback with " << ScrapersAmount << " scrapers: "
+              << seqCounterNs << " ns (single-writer), "
+              << fetchAddNs << " ns (atomic increment)" << std::endl;
+    return EXIT_SUCCESS;
+}
+//------------------------------------------------------------------------------
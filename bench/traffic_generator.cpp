@@ -0,0 +1,1271 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Generator of synthetic NFS/SMB traffic
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include <endian.h>
+#include <pcap/pcap.h>
+
+#include "api/cifs2_commands.h"
+#include "protocols/cifs2/cifs2.h"
+#include "protocols/ethernet/ethernet_header.h"
+#include "protocols/ip/ipv4_header.h"
+#include "protocols/netbios/netbios.h"
+#include "protocols/nfs3/nfs3_utils.h"
+#include "protocols/nfs4/nfs41_utils.h"
+#include "protocols/nfs4/nfs4_utils.h"
+#include "protocols/tcp/tcp_header.h"
+#include "traffic_generator.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace bench
+{
+namespace // unnamed
+{
+
+namespace NFS3  = NST::API::NFS3;
+
+using Request   = TrafficGenerator::Request;
+using Message   = TrafficGenerator::Message;
+using Operation = TrafficGenerator::Operation;
+
+const uint32_t NFSProgram       {100003};
+const uint16_t NFSPort          {2049};
+const uint16_t SMBPort          {445};
+const uint32_t ServerAddress    {0xC0A80001};           // 192.168.0.1
+const uint32_t ClientAddresses  {0x0A000001};           // 10.0.0.1 and next
+const uint32_t FileHandleSize   {32};
+const uint32_t FilesPerClient   {64};
+const uint64_t FileSize         {1024 * 1024 * 1024};   // wrap of sequential I/O
+const uint64_t StartTime        {1420070400};           // 2015-01-01, seconds
+const uint64_t NanosecondsPerSecond {1000000000};
+const uint32_t MaxSlots         {64};
+const uint16_t SMBCredits       {256};                  // granted by NEGOTIATE
+const uint32_t SMBCreditSize    {65536};
+const uint32_t FrameHeaderSize  {sizeof(protocols::ethernet::ethernet_header) +
+                                 sizeof(protocols::ip::ipv4_header) +
+                                 sizeof(protocols::tcp::tcp_header)};
+
+// Body of AUTH_SYS credentials: stamp, machine name "gen", uid, gid, no groups
+char AuthSysBody[] {0, 0, 0, 1,  0, 0, 0, 3,  'g', 'e', 'n', 0,  0, 0, 0, 0,  0, 0, 0, 0,  0, 0, 0, 0};
+
+inline uint32_t padded(uint32_t len)
+{
+    return (len + 3) & ~3U;
+}
+
+// Handle of the file of a client, file FilesPerClient is the directory
+inline void file_handle(char (&handle)[FileHandleSize], uint32_t client, uint32_t file)
+{
+    memset(handle, 0, sizeof(handle));
+    const uint32_t words[] {htonl(0x4E535447 /*NSTG*/), htonl(client), htonl(file)};
+    memcpy(handle, words, sizeof(words));
+}
+
+inline std::string file_name(uint32_t file)
+{
+    return "file" + std::to_string(file);
+}
+
+inline uint16_t ip_checksum(const void* header, std::size_t len)
+{
+    const uint16_t* words {static_cast<const uint16_t*>(header)};
+    uint32_t sum {0};
+    for(std::size_t i {0}; i < len / 2; ++i)
+    {
+        sum += words[i];
+    }
+    while(sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+// RPC message encoder, the record mark is filled by finish()
+class XDREncoder
+{
+public:
+    explicit XDREncoder(Message& m)
+    : message(m)
+    {
+        xdrmem_create(&txdr, reinterpret_cast<char*>(m.data.data()) + sizeof(uint32_t),
+                      static_cast<u_int>(m.data.size() - sizeof(uint32_t)), XDR_ENCODE);
+    }
+    ~XDREncoder()
+    {
+        xdr_destroy(&txdr);
+    }
+    XDREncoder(const XDREncoder&)            = delete;
+    XDREncoder& operator=(const XDREncoder&) = delete;
+
+    void call(uint32_t xid, uint32_t version, uint32_t procedure)
+    {
+        struct rpc_msg msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.rm_xid                     = xid;
+        msg.rm_direction               = ::CALL;
+        msg.rm_call.cb_rpcvers         = 2;
+        msg.rm_call.cb_prog            = NFSProgram;
+        msg.rm_call.cb_vers            = version;
+        msg.rm_call.cb_proc            = procedure;
+        msg.rm_call.cb_cred.oa_flavor  = AUTH_SYS;
+        msg.rm_call.cb_cred.oa_base    = AuthSysBody;
+        msg.rm_call.cb_cred.oa_length  = sizeof(AuthSysBody);
+        msg.rm_call.cb_verf.oa_flavor  = AUTH_NONE;
+        check(xdr_callmsg(&txdr, &msg));
+    }
+
+    void reply(uint32_t xid)
+    {
+        struct rpc_msg msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.rm_xid                          = xid;
+        msg.rm_direction                    = ::REPLY;
+        msg.rm_reply.rp_stat                = MSG_ACCEPTED;
+        msg.acpted_rply.ar_verf.oa_flavor   = AUTH_NONE;
+        msg.acpted_rply.ar_stat             = SUCCESS;
+        msg.acpted_rply.ar_results.where    = nullptr;
+        msg.acpted_rply.ar_results.proc     = reinterpret_cast<xdrproc_t>(reinterpret_cast<void (*)()>(xdr_void));
+        check(xdr_replymsg(&txdr, &msg));
+    }
+
+    template<typename T>
+    void encode(bool_t (*proc)(XDR*, T*), T& object)
+    {
+        check(proc(&txdr, &object));
+    }
+
+    // Appends length of opaque data which follows the message as payload
+    void length(uint32_t len)
+    {
+        check(xdr_u_int(&txdr, &len));
+    }
+
+    // Rewrites the last encoded word, i.e. the length of empty opaque data
+    void patch_length(uint32_t len)
+    {
+        const u_int pos {xdr_getpos(&txdr)};
+        xdr_setpos(&txdr, pos - sizeof(uint32_t));
+        length(len);
+    }
+
+    void finish(uint32_t payload = 0)
+    {
+        message.length  = sizeof(uint32_t) + xdr_getpos(&txdr);
+        message.payload = payload;
+        const uint32_t mark {htonl(0x80000000 | (message.length - sizeof(uint32_t) + payload))};
+        memcpy(message.data.data(), &mark, sizeof(mark));
+    }
+
+private:
+    static void check(bool_t result)
+    {
+        if(!result)
+        {
+            throw std::runtime_error{"XDR encoding failed, message is too long"};
+        }
+    }
+
+    Message& message;
+    XDR txdr;
+};
+
+class NFSv3Encoder : public TrafficGenerator::Encoder
+{
+public:
+    NFSv3Encoder(uint32_t io_size, uint32_t dir_entries)
+    : size {io_size}
+    , names(dir_entries)
+    , entries(dir_entries)
+    {
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.type  = NFS3::NF3REG;
+        attributes.mode  = 0644;
+        attributes.nlink = 1;
+        attributes.size  = FileSize;
+        attributes.used  = FileSize;
+
+        memset(&handle, 0, sizeof(handle));
+        handle.data.data_len = FileHandleSize;
+        handle.data.data_val = fh;
+        memset(&dir, 0, sizeof(dir));
+        dir.data.data_len = FileHandleSize;
+        dir.data.data_val = dir_fh;
+
+        file_handle(entry_fh, 0, 0);
+        for(uint32_t i {0}; i < dir_entries; ++i)
+        {
+            names[i] = file_name(i);
+
+            NFS3::entryplus3& entry = entries[i];
+            memset(&entry, 0, sizeof(entry));
+            entry.fileid = i + 1;
+            entry.name   = &names[i][0];
+            entry.cookie = i + 1;
+            entry.name_attributes.attributes_follow       = TRUE;
+            entry.name_attributes.post_op_attr_u.attributes = attributes;
+            entry.name_handle.handle_follows              = TRUE;
+            entry.name_handle.post_op_fh3_u.handle.data.data_len = FileHandleSize;
+            entry.name_handle.post_op_fh3_u.handle.data.data_val = entry_fh;
+            entry.nextentry = (i + 1 < dir_entries) ? &entries[i + 1] : nullptr;
+        }
+    }
+
+    uint16_t port() const override
+    {
+        return NFSPort;
+    }
+
+    void call(const Request& r, Message& m) override
+    {
+        using Proc = API::ProcEnumNFS3;
+
+        XDREncoder e {m};
+        set_handles(r);
+        const uint32_t xid {static_cast<uint32_t>(r.id)};
+        switch(r.operation)
+        {
+        case TrafficGenerator::GETATTR:
+            {
+                e.call(xid, 3, Proc::GETATTR);
+                NFS3::GETATTR3args args;
+                args.object = handle;
+                e.encode(protocols::NFS3::xdr_GETATTR3args, args);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::LOOKUP:
+            {
+                e.call(xid, 3, Proc::LOOKUP);
+                std::string name {file_name(r.file)};
+                NFS3::LOOKUP3args args;
+                args.what.dir  = dir;
+                args.what.name = &name[0];
+                e.encode(protocols::NFS3::xdr_LOOKUP3args, args);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::ACCESS:
+            {
+                e.call(xid, 3, Proc::ACCESS);
+                NFS3::ACCESS3args args;
+                args.object = handle;
+                args.access = 0x3F;
+                e.encode(protocols::NFS3::xdr_ACCESS3args, args);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::READ:
+            {
+                e.call(xid, 3, Proc::READ);
+                NFS3::READ3args args;
+                args.file   = handle;
+                args.offset = r.offset;
+                args.count  = size;
+                e.encode(protocols::NFS3::xdr_READ3args, args);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::WRITE:
+            {
+                e.call(xid, 3, Proc::WRITE);
+                NFS3::WRITE3args args;
+                memset(&args, 0, sizeof(args));
+                args.file   = handle;
+                args.offset = r.offset;
+                args.count  = size;
+                args.stable = NFS3::UNSTABLE;
+                e.encode(protocols::NFS3::xdr_WRITE3args, args);
+                e.length(size); // data isn't encoded by xdr_WRITE3args
+                e.finish(padded(size));
+            }
+            break;
+        case TrafficGenerator::READDIR:
+            {
+                e.call(xid, 3, Proc::READDIRPLUS);
+                NFS3::READDIRPLUS3args args;
+                memset(&args, 0, sizeof(args));
+                args.dir      = dir;
+                args.dircount = 4096;
+                args.maxcount = 32768;
+                e.encode(protocols::NFS3::xdr_READDIRPLUS3args, args);
+                e.finish();
+            }
+            break;
+        default:
+            throw std::logic_error{"unknown operation"};
+        }
+    }
+
+    void reply(const Request& r, Message& m) override
+    {
+        XDREncoder e {m};
+        set_handles(r);
+        e.reply(static_cast<uint32_t>(r.id));
+        switch(r.operation)
+        {
+        case TrafficGenerator::GETATTR:
+            {
+                NFS3::GETATTR3res res;
+                res.status = NFS3::NFS3_OK;
+                res.GETATTR3res_u.resok.obj_attributes = attributes;
+                e.encode(protocols::NFS3::xdr_GETATTR3res, res);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::LOOKUP:
+            {
+                NFS3::LOOKUP3res res;
+                memset(&res, 0, sizeof(res));
+                res.status = NFS3::NFS3_OK;
+                res.LOOKUP3res_u.resok.object = handle;
+                res.LOOKUP3res_u.resok.obj_attributes.attributes_follow = TRUE;
+                res.LOOKUP3res_u.resok.obj_attributes.post_op_attr_u.attributes = attributes;
+                e.encode(protocols::NFS3::xdr_LOOKUP3res, res);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::ACCESS:
+            {
+                NFS3::ACCESS3res res;
+                memset(&res, 0, sizeof(res));
+                res.status = NFS3::NFS3_OK;
+                res.ACCESS3res_u.resok.obj_attributes.attributes_follow = TRUE;
+                res.ACCESS3res_u.resok.obj_attributes.post_op_attr_u.attributes = attributes;
+                res.ACCESS3res_u.resok.access = 0x1F;
+                e.encode(protocols::NFS3::xdr_ACCESS3res, res);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::READ:
+            {
+                NFS3::READ3res res;
+                memset(&res, 0, sizeof(res));
+                res.status = NFS3::NFS3_OK;
+                res.READ3res_u.resok.file_attributes.attributes_follow = TRUE;
+                res.READ3res_u.resok.file_attributes.post_op_attr_u.attributes = attributes;
+                res.READ3res_u.resok.count = size;
+                res.READ3res_u.resok.eof   = FALSE;
+                e.encode(protocols::NFS3::xdr_READ3res, res);
+                e.length(size); // data isn't encoded by xdr_READ3resok
+                e.finish(padded(size));
+            }
+            break;
+        case TrafficGenerator::WRITE:
+            {
+                NFS3::WRITE3res res;
+                memset(&res, 0, sizeof(res));
+                res.status = NFS3::NFS3_OK;
+                res.WRITE3res_u.resok.file_wcc.after.attributes_follow = TRUE;
+                res.WRITE3res_u.resok.file_wcc.after.post_op_attr_u.attributes = attributes;
+                res.WRITE3res_u.resok.count     = size;
+                res.WRITE3res_u.resok.committed = NFS3::UNSTABLE;
+                e.encode(protocols::NFS3::xdr_WRITE3res, res);
+                e.finish();
+            }
+            break;
+        case TrafficGenerator::READDIR:
+            {
+                NFS3::READDIRPLUS3res res;
+                memset(&res, 0, sizeof(res));
+                res.status = NFS3::NFS3_OK;
+                res.READDIRPLUS3res_u.resok.dir_attributes.attributes_follow = TRUE;
+                res.READDIRPLUS3res_u.resok.dir_attributes.post_op_attr_u.attributes = attributes;
+                res.READDIRPLUS3res_u.resok.reply.entries = entries.empty() ? nullptr : &entries[0];
+                res.READDIRPLUS3res_u.resok.reply.eof     = TRUE;
+                e.encode(protocols::NFS3::xdr_READDIRPLUS3res, res);
+                e.finish();
+            }
+            break;
+        default:
+            throw std::logic_error{"unknown operation"};
+        }
+    }
+
+private:
+    void set_handles(const Request& r)
+    {
+        file_handle(fh, r.client, r.file);
+        file_handle(dir_fh, r.client, FilesPerClient);
+    }
+
+    const uint32_t size;
+    char fh[FileHandleSize];
+    char dir_fh[FileHandleSize];
+    char entry_fh[FileHandleSize];
+    NFS3::nfs_fh3 handle;
+    NFS3::nfs_fh3 dir;
+    NFS3::fattr3 attributes;
+    std::vector<std::string> names;
+    std::vector<NFS3::entryplus3> entries;
+};
+
+// Types and routines of NFSv4.0
+struct NFSv40
+{
+    using COMPOUND4args = API::NFS4::COMPOUND4args;
+    using COMPOUND4res  = API::NFS4::COMPOUND4res;
+    using nfs_argop4    = API::NFS4::nfs_argop4;
+    using nfs_resop4    = API::NFS4::nfs_resop4;
+    using nfs_opnum4    = API::NFS4::nfs_opnum4;
+    using nfsstat4      = API::NFS4::nfsstat4;
+    using stable_how4   = API::NFS4::stable_how4;
+    using entry4        = API::NFS4::entry4;
+
+    static const uint32_t minor_version {0};
+
+    static bool_t encode(XDR* xdr, COMPOUND4args* args) { return protocols::NFS4::xdr_COMPOUND4args(xdr, args); }
+    static bool_t encode(XDR* xdr, COMPOUND4res* res)   { return protocols::NFS4::xdr_COMPOUND4res(xdr, res);   }
+
+    // NFSv4.0 has no sessions
+    static bool sequence(nfs_argop4&, const Request&, uint32_t) { return false; }
+    static bool sequence(nfs_resop4&, const Request&, uint32_t) { return false; }
+};
+
+// Types and routines of NFSv4.1
+struct NFSv41
+{
+    using COMPOUND4args = API::NFS41::COMPOUND4args;
+    using COMPOUND4res  = API::NFS41::COMPOUND4res;
+    using nfs_argop4    = API::NFS41::nfs_argop4;
+    using nfs_resop4    = API::NFS41::nfs_resop4;
+    using nfs_opnum4    = API::NFS41::nfs_opnum4;
+    using nfsstat4      = API::NFS41::nfsstat4;
+    using stable_how4   = API::NFS41::stable_how4;
+    using entry4        = API::NFS41::entry4;
+
+    static const uint32_t minor_version {1};
+
+    static bool_t encode(XDR* xdr, COMPOUND4args* args) { return protocols::NFS41::xdr_COMPOUND4args(xdr, args); }
+    static bool_t encode(XDR* xdr, COMPOUND4res* res)   { return protocols::NFS41::xdr_COMPOUND4res(xdr, res);   }
+
+    static bool sequence(nfs_argop4& op, const Request& r, uint32_t slots)
+    {
+        op.argop = API::NFS41::OP_SEQUENCE;
+        API::NFS41::SEQUENCE4args& args = op.nfs_argop4_u.opsequence;
+        session(args.sa_sessionid, r.client);
+        args.sa_sequenceid     = r.sequence;
+        args.sa_slotid         = r.slot;
+        args.sa_highest_slotid = slots - 1;
+        args.sa_cachethis      = FALSE;
+        return true;
+    }
+
+    static bool sequence(nfs_resop4& op, const Request& r, uint32_t slots)
+    {
+        op.resop = API::NFS41::OP_SEQUENCE;
+        op.nfs_resop4_u.opsequence.sr_status = API::NFS41::NFS4_OK;
+        API::NFS41::SEQUENCE4resok& res = op.nfs_resop4_u.opsequence.SEQUENCE4res_u.sr_resok4;
+        session(res.sr_sessionid, r.client);
+        res.sr_sequenceid            = r.sequence;
+        res.sr_slotid                = r.slot;
+        res.sr_highest_slotid        = slots - 1;
+        res.sr_target_highest_slotid = slots - 1;
+        res.sr_status_flags          = 0;
+        return true;
+    }
+
+private:
+    static void session(API::NFS41::sessionid4 id, uint32_t client)
+    {
+        memset(id, 0, sizeof(API::NFS41::sessionid4));
+        const uint32_t word {htonl(client)};
+        memcpy(id, &word, sizeof(word));
+    }
+};
+
+// COMPOUND of [SEQUENCE] PUTFH and an operation (LOOKUP is followed by GETFH)
+template<typename V>
+class NFSv4Encoder : public TrafficGenerator::Encoder
+{
+    using COMPOUND4args = typename V::COMPOUND4args;
+    using COMPOUND4res  = typename V::COMPOUND4res;
+    using nfs_argop4    = typename V::nfs_argop4;
+    using nfs_resop4    = typename V::nfs_resop4;
+    using nfs_opnum4    = typename V::nfs_opnum4;
+    using nfsstat4      = typename V::nfsstat4;
+    using stable_how4   = typename V::stable_how4;
+    using entry4        = typename V::entry4;
+    using Proc          = API::ProcEnumNFS4;
+
+    static const uint32_t MaxOperations {4};
+
+public:
+    NFSv4Encoder(uint32_t io_size, uint32_t dir_entries, uint32_t slots_amount)
+    : size {io_size}
+    , slots{slots_amount}
+    , names(dir_entries)
+    , entries(dir_entries)
+    {
+        // type and size attributes: type NF4REG and size FileSize
+        mask[0] = (1U << 1) | (1U << 4);
+        mask[1] = 0;
+        const uint32_t type {htonl(1)};
+        const uint32_t size_words[] {htonl(static_cast<uint32_t>(FileSize >> 32)),
+                                     htonl(static_cast<uint32_t>(FileSize))};
+        memcpy(values, &type, sizeof(type));
+        memcpy(values + sizeof(type), size_words, sizeof(size_words));
+
+        for(uint32_t i {0}; i < dir_entries; ++i)
+        {
+            names[i] = file_name(i);
+
+            entry4& entry = entries[i];
+            memset(&entry, 0, sizeof(entry));
+            entry.cookie = i + 3; // 0, 1 and 2 are reserved
+            entry.name.utf8string_len = static_cast<u_int>(names[i].size());
+            entry.name.utf8string_val = &names[i][0];
+            set_attributes(entry.attrs);
+            entry.nextentry = (i + 1 < dir_entries) ? &entries[i + 1] : nullptr;
+        }
+    }
+
+    uint16_t port() const override
+    {
+        return NFSPort;
+    }
+
+    void call(const Request& r, Message& m) override
+    {
+        XDREncoder e {m};
+        e.call(static_cast<uint32_t>(r.id), 4, Proc::COMPOUND);
+
+        nfs_argop4 ops[MaxOperations];
+        memset(ops, 0, sizeof(ops));
+        uint32_t count {0};
+        if(V::sequence(ops[count], r, slots))
+        {
+            ++count;
+        }
+
+        std::string name;
+        nfs_argop4& putfh = ops[count++];
+        putfh.argop = static_cast<nfs_opnum4>(Proc::PUTFH);
+        putfh.nfs_argop4_u.opputfh.object.nfs_fh4_len = FileHandleSize;
+        putfh.nfs_argop4_u.opputfh.object.nfs_fh4_val = fh;
+        file_handle(fh, r.client, (r.operation == TrafficGenerator::LOOKUP ||
+                                   r.operation == TrafficGenerator::READDIR) ? FilesPerClient : r.file);
+
+        nfs_argop4& op = ops[count++];
+        uint32_t payload {0};
+        switch(r.operation)
+        {
+        case TrafficGenerator::GETATTR:
+            op.argop = static_cast<nfs_opnum4>(Proc::GETATTR);
+            set_mask(op.nfs_argop4_u.opgetattr.attr_request);
+            break;
+        case TrafficGenerator::LOOKUP:
+            name = file_name(r.file);
+            op.argop = static_cast<nfs_opnum4>(Proc::LOOKUP);
+            op.nfs_argop4_u.oplookup.objname.utf8string_len = static_cast<u_int>(name.size());
+            op.nfs_argop4_u.oplookup.objname.utf8string_val = &name[0];
+            ops[count++].argop = static_cast<nfs_opnum4>(Proc::GETFH);
+            break;
+        case TrafficGenerator::ACCESS:
+            op.argop = static_cast<nfs_opnum4>(Proc::ACCESS);
+            op.nfs_argop4_u.opaccess.access = 0x3F;
+            break;
+        case TrafficGenerator::READ:
+            op.argop = static_cast<nfs_opnum4>(Proc::READ);
+            op.nfs_argop4_u.opread.offset = r.offset;
+            op.nfs_argop4_u.opread.count  = size;
+            break;
+        case TrafficGenerator::WRITE:
+            op.argop = static_cast<nfs_opnum4>(Proc::WRITE);
+            op.nfs_argop4_u.opwrite.offset = r.offset;
+            op.nfs_argop4_u.opwrite.stable = static_cast<stable_how4>(0); // UNSTABLE4
+            payload = padded(size);
+            break;
+        case TrafficGenerator::READDIR:
+            op.argop = static_cast<nfs_opnum4>(Proc::READDIR);
+            op.nfs_argop4_u.opreaddir.dircount = 4096;
+            op.nfs_argop4_u.opreaddir.maxcount = 32768;
+            set_mask(op.nfs_argop4_u.opreaddir.attr_request);
+            break;
+        default:
+            throw std::logic_error{"unknown operation"};
+        }
+
+        COMPOUND4args args;
+        memset(&args, 0, sizeof(args));
+        args.minorversion            = V::minor_version;
+        args.argarray.argarray_len   = count;
+        args.argarray.argarray_val   = ops;
+        e.encode(V::encode, args);
+        if(payload)
+        {
+            e.patch_length(size); // WRITE is the last operation, data follows
+        }
+        e.finish(payload);
+    }
+
+    void reply(const Request& r, Message& m) override
+    {
+        XDREncoder e {m};
+        e.reply(static_cast<uint32_t>(r.id));
+
+        nfs_resop4 res[MaxOperations];
+        memset(res, 0, sizeof(res));
+        uint32_t count {0};
+        if(V::sequence(res[count], r, slots))
+        {
+            ++count;
+        }
+        res[count++].resop = static_cast<nfs_opnum4>(Proc::PUTFH);
+
+        nfs_resop4& op = res[count++];
+        uint32_t payload {0};
+        switch(r.operation)
+        {
+        case TrafficGenerator::GETATTR:
+            op.resop = static_cast<nfs_opnum4>(Proc::GETATTR);
+            set_attributes(op.nfs_resop4_u.opgetattr.GETATTR4res_u.resok4.obj_attributes);
+            break;
+        case TrafficGenerator::LOOKUP:
+            {
+                op.resop = static_cast<nfs_opnum4>(Proc::LOOKUP);
+                nfs_resop4& getfh = res[count++];
+                getfh.resop = static_cast<nfs_opnum4>(Proc::GETFH);
+                getfh.nfs_resop4_u.opgetfh.GETFH4res_u.resok4.object.nfs_fh4_len = FileHandleSize;
+                getfh.nfs_resop4_u.opgetfh.GETFH4res_u.resok4.object.nfs_fh4_val = fh;
+                file_handle(fh, r.client, r.file);
+            }
+            break;
+        case TrafficGenerator::ACCESS:
+            op.resop = static_cast<nfs_opnum4>(Proc::ACCESS);
+            op.nfs_resop4_u.opaccess.ACCESS4res_u.resok4.supported = 0x3F;
+            op.nfs_resop4_u.opaccess.ACCESS4res_u.resok4.access    = 0x1F;
+            break;
+        case TrafficGenerator::READ:
+            op.resop = static_cast<nfs_opnum4>(Proc::READ);
+            op.nfs_resop4_u.opread.READ4res_u.resok4.eof = FALSE;
+            payload = padded(size);
+            break;
+        case TrafficGenerator::WRITE:
+            op.resop = static_cast<nfs_opnum4>(Proc::WRITE);
+            op.nfs_resop4_u.opwrite.WRITE4res_u.resok4.count     = size;
+            op.nfs_resop4_u.opwrite.WRITE4res_u.resok4.committed = static_cast<stable_how4>(0);
+            break;
+        case TrafficGenerator::READDIR:
+            op.resop = static_cast<nfs_opnum4>(Proc::READDIR);
+            op.nfs_resop4_u.opreaddir.READDIR4res_u.resok4.reply.entries = entries.empty() ? nullptr : &entries[0];
+            op.nfs_resop4_u.opreaddir.READDIR4res_u.resok4.reply.eof     = TRUE;
+            break;
+        default:
+            throw std::logic_error{"unknown operation"};
+        }
+
+        COMPOUND4res result;
+        memset(&result, 0, sizeof(result));
+        result.status                  = static_cast<nfsstat4>(0); // NFS4_OK
+        result.resarray.resarray_len   = count;
+        result.resarray.resarray_val   = res;
+        e.encode(V::encode, result);
+        if(payload)
+        {
+            e.patch_length(size); // READ is the last operation, data follows
+        }
+        e.finish(payload);
+    }
+
+private:
+    template<typename Bitmap>
+    void set_mask(Bitmap& bitmap)
+    {
+        bitmap.bitmap4_len = 2;
+        bitmap.bitmap4_val = mask;
+    }
+
+    template<typename Attributes>
+    void set_attributes(Attributes& attrs)
+    {
+        set_mask(attrs.attrmask);
+        attrs.attr_vals.attrlist4_len = sizeof(values);
+        attrs.attr_vals.attrlist4_val = values;
+    }
+
+    const uint32_t size;
+    const uint32_t slots;
+    char fh[FileHandleSize];
+    uint32_t mask[2];
+    char values[12];
+    std::vector<std::string> names;
+    std::vector<entry4> entries;
+};
+
+// SMBv2 messages over NetBIOS session service, integers are little-endian
+class SMBv2Encoder : public TrafficGenerator::Encoder
+{
+    using Commands = API::SMBv2::SMBv2Commands;
+
+    // Size of FILE_ID_BOTH_DIR_INFORMATION with 8 characters in a name
+    static const uint32_t DirEntrySize {104 + 16};
+    static const uint32_t FileInfoSize {56};    // FILE_NETWORK_OPEN_INFORMATION
+    static const uint32_t SecurityInfoSize {120};
+
+public:
+    SMBv2Encoder(uint32_t io_size, uint32_t dir_entries)
+    : size {io_size}
+    , listing {dir_entries * DirEntrySize}
+    {
+    }
+
+    uint16_t port() const override
+    {
+        return SMBPort;
+    }
+
+    uint64_t ids(const Request& r) const override
+    {
+        return charge(r.operation);
+    }
+
+    bool connect(uint32_t client, Message& call, Message& reply) override
+    {
+        {
+            auto body = header<API::SMBv2::NegotiateRequest>(call, Commands::NEGOTIATE, 0, client, false, 1);
+            body->structureSize = htole16(36);
+            body->dialectCount  = htole16(1);
+            body->securityMode  = API::SMBv2::SecurityMode::SIGNING_ENABLED;
+            body->capabilities  = API::SMBv2::Capabilities::LARGE_MTU;
+            body->dialects[0]   = API::SMBv2::Dialects::SMB_2_1;
+            memcpy(body->clientGUID, &client, sizeof(client));
+            finish(call, sizeof(*body), 0);
+        }
+        {
+            auto body = header<API::SMBv2::NegotiateResponse>(reply, Commands::NEGOTIATE, 0, client, true, SMBCredits);
+            body->structureSize   = htole16(65);
+            body->securityMode    = API::SMBv2::SecurityMode::SIGNING_ENABLED;
+            body->dialectRevision = htole16(0x0210);
+            body->capabilities    = API::SMBv2::Capabilities::LARGE_MTU;
+            body->maxTransactSize = htole32(8 * 1024 * 1024);
+            body->maxReadSize     = htole32(8 * 1024 * 1024);
+            body->maxWriteSize    = htole32(8 * 1024 * 1024);
+            body->securityBufferOffset = htole16(sizeof(CIFSv2Header) + sizeof(*body) - 1);
+            finish(reply, sizeof(*body), 0);
+        }
+        return true;
+    }
+
+    void call(const Request& r, Message& m) override
+    {
+        using namespace API::SMBv2;
+
+        const uint16_t credits {charge(r.operation)};
+        switch(r.operation)
+        {
+        case TrafficGenerator::GETATTR:
+        case TrafficGenerator::ACCESS:
+            {
+                const bool file {r.operation == TrafficGenerator::GETATTR};
+                auto body = header<QueryInfoRequest>(m, Commands::QUERY_INFO, r.id, r.client, false, credits);
+                body->structureSize      = htole16(41);
+                body->infoType           = file ? InfoTypes::FILE : InfoTypes::SECURITY;
+                body->FileInfoClass      = file ? 34 : 0; // FileNetworkOpenInformation
+                body->OutputBufferLength = htole32(4096);
+                body->AdditionalInformation = static_cast<AdditionInfo>(htole32(file ? 0 : 0x7));
+                body->PersistentFileId = file_id(r, 0);
+                body->VolatileFileId = file_id(r, 1);
+                finish(m, sizeof(*body) - 1, 0);
+            }
+            break;
+        case TrafficGenerator::LOOKUP:
+            {
+                const std::string name {file_name(r.file)};
+                auto body = header<CreateRequest>(m, Commands::CREATE, r.id, r.client, false, credits);
+                body->structureSize        = htole16(57);
+                body->ImpersonationLevel   = static_cast<ImpersonationLevels>(htole32(2));
+                body->desiredAccess        = static_cast<DesiredAccessFlags>(htole32(0x00120089));
+                body->shareAccess          = static_cast<ShareAccessFlags>(htole32(0x7));
+                body->createDisposition    = static_cast<CreateDisposition>(htole32(1)); // OPEN
+                body->createOptions        = static_cast<CreateOptionsFlags>(htole32(0x40)); // NON_DIRECTORY_FILE
+                body->NameOffset           = htole16(sizeof(CIFSv2Header) + sizeof(*body) - 1);
+                body->NameLength           = htole16(static_cast<uint16_t>(name.size() * 2));
+                // name in UTF-16LE
+                for(std::size_t i {0}; i < name.size(); ++i)
+                {
+                    body->Buffer[i * 2]     = static_cast<uint8_t>(name[i]);
+                    body->Buffer[i * 2 + 1] = 0;
+                }
+                finish(m, sizeof(*body) - 1 + name.size() * 2, 0);
+            }
+            break;
+        case TrafficGenerator::READ:
+            {
+                auto body = header<ReadRequest>(m, Commands::READ, r.id, r.client, false, credits);
+                body->structureSize = htole16(49);
+                body->padding       = 80;
+                body->length        = htole32(size);
+                body->offset        = htole64(r.offset);
+                body->persistentFileId = file_id(r, 0);
+                body->volatileFileId = file_id(r, 1);
+                finish(m, sizeof(*body), 0);
+            }
+            break;
+        case TrafficGenerator::WRITE:
+            {
+                auto body = header<WriteRequest>(m, Commands::WRITE, r.id, r.client, false, credits);
+                body->structureSize = htole16(49);
+                body->dataOffset    = htole16(sizeof(CIFSv2Header) + sizeof(*body) - 1);
+                body->Length        = htole32(size);
+                body->Offset        = htole64(r.offset);
+                body->persistentFileId = file_id(r, 0);
+                body->volatileFileId = file_id(r, 1);
+                finish(m, sizeof(*body) - 1, size);
+            }
+            break;
+        case TrafficGenerator::READDIR:
+            {
+                auto body = header<QueryDirRequest>(m, Commands::QUERY_DIRECTORY, r.id, r.client, false, credits);
+                body->structureSize      = htole16(33);
+                body->infoType           = static_cast<QueryInfoLevels>(37); // FileIdBothDirectoryInformation
+                body->FileNameOffset     = htole16(sizeof(CIFSv2Header) + sizeof(*body) - 1);
+                body->FileNameLength     = htole16(2);
+                body->OutputBufferLength = htole32(65536);
+                body->Buffer[0] = '*';
+                body->PersistentFileId = file_id(r, 0);
+                body->VolatileFileId = file_id(r, 1);
+                finish(m, sizeof(*body) - 1 + 2, 0);
+            }
+            break;
+        default:
+            throw std::logic_error{"unknown operation"};
+        }
+    }
+
+    void reply(const Request& r, Message& m) override
+    {
+        using namespace API::SMBv2;
+
+        const uint16_t credits {charge(r.operation)};
+        switch(r.operation)
+        {
+        case TrafficGenerator::GETATTR:
+        case TrafficGenerator::ACCESS:
+            {
+                const uint32_t info {r.operation == TrafficGenerator::GETATTR ? FileInfoSize : SecurityInfoSize};
+                auto body = header<QueryInfoResponse>(m, Commands::QUERY_INFO, r.id, r.client, true, credits);
+                body->structureSize      = htole16(9);
+                body->OutputBufferOffset = htole16(sizeof(CIFSv2Header) + sizeof(*body) - 1);
+                body->OutputBufferLength = htole32(info);
+                finish(m, sizeof(*body) - 1, info);
+            }
+            break;
+        case TrafficGenerator::LOOKUP:
+            {
+                auto body = header<CreateResponse>(m, Commands::CREATE, r.id, r.client, true, credits);
+                body->structureSize  = htole16(89);
+                body->CreateAction   = static_cast<CreateActions>(htole32(1)); // OPENED
+                body->AllocationSize = htole64(FileSize);
+                body->EndofFile      = htole64(FileSize);
+                body->attributes     = static_cast<FileAttributes>(htole32(0x80)); // NORMAL
+                body->PersistentFileId = file_id(r, 0);
+                body->VolatileFileId = file_id(r, 1);
+                finish(m, sizeof(*body), 0);
+            }
+            break;
+        case TrafficGenerator::READ:
+            {
+                auto body = header<ReadResponse>(m, Commands::READ, r.id, r.client, true, credits);
+                body->structureSize = htole16(17);
+                body->DataOffset    = static_cast<uint8_t>(sizeof(CIFSv2Header) + sizeof(*body) - 1);
+                body->DataLength    = htole32(size);
+                finish(m, sizeof(*body) - 1, size);
+            }
+            break;
+        case TrafficGenerator::WRITE:
+            {
+                auto body = header<WriteResponse>(m, Commands::WRITE, r.id, r.client, true, credits);
+                body->structureSize = htole16(17);
+                body->Count         = htole32(size);
+                finish(m, sizeof(*body), 0);
+            }
+            break;
+        case TrafficGenerator::READDIR:
+            {
+                auto body = header<QueryDirResponse>(m, Commands::QUERY_DIRECTORY, r.id, r.client, true, credits);
+                body->structureSize      = htole16(9);
+                body->OutputBufferOffset = htole16(sizeof(CIFSv2Header) + sizeof(*body) - 1);
+                body->OutputBufferLength = htole32(listing);
+                finish(m, sizeof(*body) - 1, listing);
+            }
+            break;
+        default:
+            throw std::logic_error{"unknown operation"};
+        }
+    }
+
+private:
+    using NetBIOSHeader = protocols::NetBIOS::RawMessageHeader;
+    using CIFSv2Header  = protocols::CIFSv2::RawMessageHeader;
+
+    uint16_t charge(Operation operation) const
+    {
+        if(operation == TrafficGenerator::READ || operation == TrafficGenerator::WRITE)
+        {
+            return static_cast<uint16_t>(std::max<uint32_t>(1, (size + SMBCreditSize - 1) / SMBCreditSize));
+        }
+        return 1;
+    }
+
+    // Persistent (0) or volatile (1) part of FileId of the requested file
+    static uint64_t file_id(const Request& r, uint64_t part)
+    {
+        return htole64(((static_cast<uint64_t>(r.client) << 32) | (r.file << 1)) + part);
+    }
+
+    // Fills headers and returns zeroed body of the command
+    template<typename Body>
+    Body* header(Message& m, Commands command, uint64_t id, uint32_t client, bool response, uint16_t credits)
+    {
+        static const uint8_t protocol[] {0xFE, 'S', 'M', 'B'};
+
+        uint8_t* data {m.data.data()};
+        memset(data, 0, sizeof(NetBIOSHeader) + sizeof(CIFSv2Header) + sizeof(Body) + 64);
+
+        CIFSv2Header* h {reinterpret_cast<CIFSv2Header*>(data + sizeof(NetBIOSHeader))};
+        memcpy(&h->head_code, protocol, sizeof(protocol));
+        h->StructureSize = static_cast<int16_t>(htole16(64));
+        h->CreditCharge  = static_cast<int16_t>(htole16(credits));
+        h->cmd_code      = command;
+        h->Credit        = static_cast<int16_t>(htole16(credits));
+        h->flags         = response ? static_cast<int32_t>(protocols::CIFSv2::Flags::SERVER_TO_REDIR) : 0;
+        h->messageId     = static_cast<int64_t>(htole64(id));
+        h->_             = static_cast<int32_t>(htole32(0xFEFF)); // process id
+        if(command != Commands::NEGOTIATE)
+        {
+            h->TreeId    = static_cast<int32_t>(htole32(1));
+            h->SessionId = static_cast<int64_t>(htole64(client + 1));
+        }
+        return reinterpret_cast<Body*>(data + sizeof(NetBIOSHeader) + sizeof(CIFSv2Header));
+    }
+
+    static void finish(Message& m, std::size_t body_len, uint32_t payload)
+    {
+        m.length  = static_cast<uint32_t>(sizeof(NetBIOSHeader) + sizeof(CIFSv2Header) + body_len);
+        m.payload = payload;
+
+        const uint32_t len {m.length - static_cast<uint32_t>(sizeof(NetBIOSHeader)) + payload};
+        NetBIOSHeader* h {reinterpret_cast<NetBIOSHeader*>(m.data.data())};
+        h->_start = 0;
+        h->_      = static_cast<uint8_t>(len >> 16);
+        h->length = htons(static_cast<uint16_t>(len & 0xFFFF));
+    }
+
+    const uint32_t size;
+    const uint32_t listing;
+};
+
+} // unnamed namespace
+
+const char* TrafficGenerator::operation_name(Operation operation)
+{
+    static const char* const names[] {"getattr", "lookup", "access", "read", "write", "readdir"};
+    return operation < OPERATIONS_COUNT ? names[operation] : "unknown";
+}
+
+const char* TrafficGenerator::protocol_name(Protocol protocol)
+{
+    switch(protocol)
+    {
+    case Protocol::NFSv3:  return "nfs3";
+    case Protocol::NFSv40: return "nfs40";
+    case Protocol::NFSv41: return "nfs41";
+    case Protocol::SMBv2:  return "smb2";
+    }
+    return "unknown";
+}
+
+TrafficGenerator::TrafficGenerator(const Options& o, PcapWriter& w)
+: options (o)
+, writer  (w)
+, encoders{}
+, clients {}
+, pending {}
+, message {}
+, order   {}
+, mix_total{std::accumulate(std::begin(o.mix), std::end(o.mix), 0U)}
+, loss_threshold      {0}
+, reorder_threshold   {0}
+, retransmit_threshold{0}
+, state   {o.seed ? o.seed : 1}
+, clock   {StartTime * NanosecondsPerSecond}
+, ip_id   {0}
+, stat    {0, 0, 0, 0, 0}
+{
+    if(options.protocols.empty())   throw std::runtime_error{"no protocols are specified"};
+    if(options.clients == 0 || options.clients > 0xFFFFFF) throw std::runtime_error{"amount of clients must be in range 1-16777215"};
+    if(mix_total == 0)              throw std::runtime_error{"operation mix is empty"};
+    if(options.window == 0)         throw std::runtime_error{"window must be positive"};
+    if(options.reorder_depth == 0)  throw std::runtime_error{"reorder depth must be positive"};
+    if(options.io_size == 0 || options.io_size > 8 * 1024 * 1024) throw std::runtime_error{"I/O size must be in range 1-8388608"};
+    if(options.dir_entries > 65536) throw std::runtime_error{"amount of directory entries must not exceed 65536"};
+    if(options.mss < 64 || options.mss > 65535 - FrameHeaderSize) throw std::runtime_error{"MSS must be in range 64-65481"};
+
+    auto threshold = [](double probability) -> uint64_t
+    {
+        if(probability < 0.0 || probability > 1.0) throw std::runtime_error{"probability must be in range 0-1"};
+        return static_cast<uint64_t>(probability * 18446744073709551615.0);
+    };
+    loss_threshold       = threshold(options.loss);
+    reorder_threshold    = threshold(options.reorder);
+    retransmit_threshold = threshold(options.retransmit);
+
+    const uint32_t slots {std::min(options.window, MaxSlots)};
+    for(Protocol protocol : options.protocols)
+    {
+        switch(protocol)
+        {
+        case Protocol::NFSv3:
+            encoders.emplace_back(new NFSv3Encoder{options.io_size, options.dir_entries});
+            break;
+        case Protocol::NFSv40:
+            encoders.emplace_back(new NFSv4Encoder<NFSv40>{options.io_size, options.dir_entries, slots});
+            break;
+        case Protocol::NFSv41:
+            encoders.emplace_back(new NFSv4Encoder<NFSv41>{options.io_size, options.dir_entries, slots});
+            break;
+        case Protocol::SMBv2:
+            encoders.emplace_back(new SMBv2Encoder{options.io_size, options.dir_entries});
+            break;
+        }
+    }
+
+    // Encoded part of the largest message is a directory listing
+    message.data.resize(4096 + options.dir_entries * 256);
+
+    clients.resize(options.clients);
+    for(uint32_t i {0}; i < options.clients; ++i)
+    {
+        Client& c   = clients[i];
+        c.encoder   = encoders[i % encoders.size()].get();
+        c.address   = htonl(ClientAddresses + i);
+        c.port      = htons(static_cast<uint16_t>(700 + i % 300));
+        c.connected = false;
+        c.seq[ToServer] = static_cast<uint32_t>(random());
+        c.seq[ToClient] = static_cast<uint32_t>(random());
+        c.next_id   = 1;
+        c.offset    = 0;
+    }
+}
+
+TrafficGenerator::~TrafficGenerator()
+{
+}
+
+void TrafficGenerator::run()
+{
+    for(uint64_t i {0}; i < options.operations; ++i)
+    {
+        const uint32_t index {static_cast<uint32_t>(random() % clients.size())};
+        if(!clients[index].connected)
+        {
+            connect(index);
+        }
+
+        const Request r {request(index)};
+        Client& c = clients[index];
+        c.encoder->call(r, message);
+        send(c, ToServer, message);
+        pending.push_back(r);
+
+        if(pending.size() > options.window)
+        {
+            complete(pending.front());
+            pending.pop_front();
+        }
+    }
+    while(!pending.empty())
+    {
+        complete(pending.front());
+        pending.pop_front();
+    }
+    writer.flush();
+}
+
+void TrafficGenerator::connect(uint32_t index)
+{
+    Client& c = clients[index];
+    c.connected = true;
+    ++stat.connections;
+
+    using Flag = protocols::tcp::tcp_header::Flag;
+    segment(c, ToServer, c.seq[ToServer]++, Flag::SYN,             nullptr, 0, 0);
+    segment(c, ToClient, c.seq[ToClient]++, Flag::SYN | Flag::ACK, nullptr, 0, 0);
+    segment(c, ToServer, c.seq[ToServer],   Flag::ACK,             nullptr, 0, 0);
+
+    Message reply;
+    reply.data.resize(message.data.size());
+    if(c.encoder->connect(index, message, reply))
+    {
+        send(c, ToServer, message);
+        send(c, ToClient, reply);
+    }
+}
+
+TrafficGenerator::Request TrafficGenerator::request(uint32_t index)
+{
+    Client& c = clients[index];
+
+    Request r;
+    r.client     = index;
+    r.operation  = pick_operation();
+    r.id         = c.next_id;
+    r.file       = static_cast<uint32_t>(random() % FilesPerClient);
+    r.offset     = 0;
+    if(r.operation == READ || r.operation == WRITE)
+    {
+        r.offset = c.offset;
+        c.offset = (c.offset + options.io_size) % FileSize;
+    }
+    const uint32_t slots {std::min(options.window, MaxSlots)};
+    r.slot       = static_cast<uint32_t>(r.id % slots);
+    r.sequence   = static_cast<uint32_t>(r.id / slots + 1);
+    r.retransmit = chance(retransmit_threshold);
+
+    c.next_id += c.encoder->ids(r);
+    return r;
+}
+
+void TrafficGenerator::complete(const Request& r)
+{
+    const Client& c = clients[r.client];
+    if(r.retransmit)
+    {
+        c.encoder->call(r, message);
+        send(c, ToServer, message);
+        ++stat.retransmitted;
+    }
+    c.encoder->reply(r, message);
+    send(c, ToClient, message);
+    ++stat.operations;
+}
+
+void TrafficGenerator::send(const Client& client, Direction direction, const Message& m)
+{
+    const uint32_t total {m.length + m.payload};
+    const uint32_t amount {(total + options.mss - 1) / options.mss};
+
+    order.resize(amount);
+    std::iota(order.begin(), order.end(), 0U);
+    for(uint32_t i {0}; i + 1 < amount; ++i)
+    {
+        if(chance(reorder_threshold))
+        {
+            const uint32_t j {i + 1 + static_cast<uint32_t>(random() % options.reorder_depth)};
+            if(j < amount)
+            {
+                std::swap(order[i], order[j]);
+                ++stat.reordered;
+            }
+        }
+    }
+
+    using Flag = protocols::tcp::tcp_header::Flag;
+    const uint32_t base {client.seq[direction]};
+    for(uint32_t k {0}; k < amount; ++k)
+    {
+        if(chance(loss_threshold))
+        {
+            ++stat.lost;
+            continue;
+        }
+
+        const uint32_t offset {order[k] * options.mss};
+        const uint32_t len    {std::min(options.mss, total - offset)};
+        // split the segment into encoded part and zero payload
+        const uint32_t data_len {offset < m.length ? std::min(len, m.length - offset) : 0};
+        const uint8_t  flags    {static_cast<uint8_t>(order[k] + 1 == amount ? Flag::ACK | Flag::PSH : Flag::ACK)};
+        segment(client, direction, base + offset, flags,
+                m.data.data() + std::min(offset, m.length), data_len, len - data_len);
+    }
+    const_cast<Client&>(client).seq[direction] = base + total;
+}
+
+void TrafficGenerator::segment(const Client& client, Direction direction, uint32_t seq, uint8_t flags,
+                               const uint8_t* data, uint32_t data_len, uint32_t zeros)
+{
+    using namespace protocols;
+
+    uint8_t frame[FrameHeaderSize];
+    memset(frame, 0, sizeof(frame));
+
+    ethernet::ethernet_header* eth {reinterpret_cast<ethernet::ethernet_header*>(frame)};
+    ip::ipv4_header* ip {reinterpret_cast<ip::ipv4_header*>(frame + sizeof(*eth))};
+    tcp::tcp_header* tcp {reinterpret_cast<tcp::tcp_header*>(frame + sizeof(*eth) + sizeof(*ip))};
+
+    const uint32_t server {htonl(ServerAddress)};
+    const bool to_server {direction == ToServer};
+
+    // locally administered MACs built from IP addresses
+    uint8_t* client_mac {to_server ? eth->eth_shost : eth->eth_dhost};
+    uint8_t* server_mac {to_server ? eth->eth_dhost : eth->eth_shost};
+    client_mac[0] = server_mac[0] = 0x02;
+    memcpy(client_mac + 2, &client.address, sizeof(client.address));
+    memcpy(server_mac + 2, &server, sizeof(server));
+    eth->eth_type = htons(ethernet::ethernet_header::IP);
+
+    ip->ipv4_vhl           = 0x45;
+    ip->ipv4_len           = htons(static_cast<uint16_t>(sizeof(*ip) + sizeof(*tcp) + data_len + zeros));
+    ip->ipv4_id            = htons(ip_id++);
+    ip->ipv4_fragmentation = htons(ip::ipv4_header::DF);
+    ip->ipv4_ttl           = 64;
+    ip->ipv4_protocol      = IPPROTO_TCP;
+    ip->ipv4_src           = to_server ? client.address : server;
+    ip->ipv4_dst           = to_server ? server : client.address;
+    ip->ipv4_checksum      = ip_checksum(ip, sizeof(*ip));
+
+    const uint16_t server_port {htons(client.encoder->port())};
+    tcp->tcp_sport     = to_server ? client.port : server_port;
+    tcp->tcp_dport     = to_server ? server_port : client.port;
+    tcp->tcp_seq       = htonl(seq);
+    tcp->tcp_ack       = (flags & tcp::tcp_header::ACK) ? htonl(client.seq[1 - direction]) : 0;
+    tcp->tcp_rsrvd_off = static_cast<uint8_t>((sizeof(*tcp) / 4) << 4);
+    tcp->tcp_flags     = flags;
+    tcp->tcp_win       = htons(65535);
+
+    writer.packet(clock, frame, sizeof(frame), data, data_len, zeros);
+    clock += options.gap;
+}
+
+TrafficGenerator::Operation TrafficGenerator::pick_operation()
+{
+    uint32_t value {static_cast<uint32_t>(random() % mix_total)};
+    for(uint32_t i {0}; i < OPERATIONS_COUNT; ++i)
+    {
+        if(value < options.mix[i])
+        {
+            return static_cast<Operation>(i);
+        }
+        value -= options.mix[i];
+    }
+    return GETATTR;
+}
+
+} // namespace bench
+} // namespace NST
+//------------------------------------------------------------------------------
@@ -0,0 +1,210 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Generator of synthetic NFS and SMB traffic
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef TRAFFIC_GENERATOR_H
+#define TRAFFIC_GENERATOR_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pcap_writer.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace bench
+{
+
+/*! Generator of call/reply conversations of NFSv3, NFSv4.0, NFSv4.1 and SMBv2
+ *  over Ethernet:IPv4:TCP.
+ *  Messages are encoded by the XDR routines and protocol structures used by
+ *  nfstrace itself, so generated traffic decodes through the real parsers.
+ *  Bulk data (READ/WRITE payload, directory listings of SMB) is never
+ *  materialized: it is written as zero bytes by PcapWriter.
+ *
+ *  Each client has its own TCP connection, calls of random clients are sent
+ *  in turn and a reply is sent when more than 'window' calls are outstanding.
+ *  TCP segments may be lost (not captured, but acknowledged by the peer) or
+ *  delayed by up to 'reorder_depth' segments of the same message; a call may
+ *  be retransmitted with the same XID/MessageId before its reply.
+ */
+class TrafficGenerator
+{
+public:
+    enum class Protocol
+    {
+        NFSv3,
+        NFSv40,
+        NFSv41,
+        SMBv2
+    };
+
+    enum Operation
+    {
+        GETATTR = 0,    // NFSv3 GETATTR, NFSv4.x GETATTR, SMBv2 QUERY_INFO (file)
+        LOOKUP,         // NFSv3 LOOKUP, NFSv4.x LOOKUP+GETFH, SMBv2 CREATE
+        ACCESS,         // NFSv3 ACCESS, NFSv4.x ACCESS, SMBv2 QUERY_INFO (security)
+        READ,
+        WRITE,
+        READDIR,        // NFSv3 READDIRPLUS, NFSv4.x READDIR, SMBv2 QUERY_DIRECTORY
+        OPERATIONS_COUNT
+    };
+
+    struct Options
+    {
+        std::vector<Protocol> protocols {Protocol::NFSv3}; // assigned to clients round-robin
+        uint32_t clients       {16};
+        uint64_t operations    {100000};
+        uint32_t mix[OPERATIONS_COUNT] {30, 15, 10, 20, 15, 10}; // weights of operations
+        uint32_t io_size       {65536};
+        uint32_t dir_entries   {32};
+        uint32_t mss           {1448};
+        uint32_t window        {8};
+        double   loss          {0.0};   // probabilities
+        double   reorder       {0.0};
+        uint32_t reorder_depth {4};
+        double   retransmit    {0.0};
+        uint64_t gap           {1000};  // nanoseconds between packets
+        uint64_t seed          {1};
+    };
+
+    struct Statistic
+    {
+        uint64_t operations;
+        uint64_t connections;
+        uint64_t lost;
+        uint64_t reordered;
+        uint64_t retransmitted;
+    };
+
+    //! Parameters of a call, enough to encode the call and its reply again
+    struct Request
+    {
+        uint32_t  client;
+        Operation operation;
+        uint64_t  id;           // RPC XID or SMB MessageId
+        uint32_t  file;
+        uint64_t  offset;
+        uint32_t  slot;         // NFSv4.1 slot and its sequence id
+        uint32_t  sequence;
+        bool      retransmit;
+    };
+
+    //! Message of a protocol: encoded part followed by 'payload' zero bytes
+    struct Message
+    {
+        std::vector<uint8_t> data;
+        uint32_t length;
+        uint32_t payload;
+    };
+
+    class Encoder
+    {
+    public:
+        virtual ~Encoder() {}
+
+        //! TCP port of server
+        virtual uint16_t port() const = 0;
+        //! Amount of ids consumed by the operation
+        virtual uint64_t ids(const Request&) const { return 1; }
+        //! Encodes messages exchanged right after TCP handshake, returns false if none
+        virtual bool connect(uint32_t /*client*/, Message& /*call*/, Message& /*reply*/) { return false; }
+
+        virtual void call(const Request&, Message&)  = 0;
+        virtual void reply(const Request&, Message&) = 0;
+    };
+
+    static const char* operation_name(Operation operation);
+    static const char* protocol_name(Protocol protocol);
+
+    TrafficGenerator(const Options& options, PcapWriter& writer);
+    ~TrafficGenerator();
+    TrafficGenerator(const TrafficGenerator&)            = delete;
+    TrafficGenerator& operator=(const TrafficGenerator&) = delete;
+
+    //! Generates all operations and flushes the writer
+    void run();
+
+    inline const Statistic& statistic() const { return stat; }
+
+private:
+    enum Direction
+    {
+        ToServer = 0,
+        ToClient = 1
+    };
+
+    struct Client
+    {
+        Encoder* encoder;
+        uint32_t address;   // in network byte order
+        uint16_t port;      // in network byte order
+        bool     connected;
+        uint32_t seq[2];    // next sequence numbers of both directions
+        uint64_t next_id;
+        uint64_t offset;    // of sequential I/O
+    };
+
+    void connect(uint32_t index);
+    Request request(uint32_t index);
+    void complete(const Request& request);
+    void send(const Client& client, Direction direction, const Message& message);
+    void segment(const Client& client, Direction direction, uint32_t seq, uint8_t flags,
+                 const uint8_t* data, uint32_t data_len, uint32_t zeros);
+    Operation pick_operation();
+
+    inline uint64_t random()
+    {
+        // xorshift64*
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+    inline bool chance(uint64_t threshold)
+    {
+        return threshold != 0 && random() < threshold;
+    }
+
+    const Options options;
+    PcapWriter& writer;
+    std::vector<std::unique_ptr<Encoder>> encoders;
+    std::vector<Client> clients;
+    std::deque<Request> pending;
+    Message message;
+    std::vector<uint32_t> order;    // order of segments of a message
+    uint32_t mix_total;
+    uint64_t loss_threshold;
+    uint64_t reorder_threshold;
+    uint64_t retransmit_threshold;
+    uint64_t state;                 // of random generator
+    uint64_t clock;                 // time of the next packet, ns
+    uint16_t ip_id;
+    Statistic stat;
+};
+
+} // namespace bench
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//TRAFFIC_GENERATOR_H
+//------------------------------------------------------------------------------
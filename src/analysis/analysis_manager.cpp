@@ -36,7 +36,7 @@ AnalysisManager::AnalysisManager(RunningStatus& status, const Parameters& params
     queue.reset(new FilteredDataQueue(params.queue_capacity(), 1));
 
     Parsers parser(*analysiss);
-    parser_thread.reset(new ParserThread<Parsers>(parser, *queue, status));
+    parser_thread.reset(new ParserThread<Parsers>(parser, *queue, status, *analysiss));
 }
 
 void AnalysisManager::start()
@@ -19,6 +19,8 @@
     along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
 */
 //------------------------------------------------------------------------------
+#include <unistd.h>
+
 #include "analysis/analyzers.h"
 #include "analysis/print_analyzer.h"
 #include "utils/out.h"
@@ -29,7 +31,8 @@ namespace analysis
 {
 
 Analyzers::Analyzers(const controller::Parameters& params)
-: _silent{false}
+: trace{nullptr}
+, _silent{false}
 {
     for(const auto& a : params.analysis_modules())
     {
@@ -55,6 +58,7 @@ Analyzers::Analyzers(const controller::Parameters& params)
             }
 
             modules.emplace_back(plugin->instance());
+            dispatch.emplace_back(utils::Probes::add(("dispatch:" + a.path).c_str()));
             plugins.emplace_back(std::move(plugin));
         }
         catch(std::runtime_error& e)
@@ -65,8 +69,14 @@ Analyzers::Analyzers(const controller::Parameters& params)
 
     if(params.trace()) // add special module for tracing RPC procedures
     {
-        std::unique_ptr<IAnalyzer> tracer{new PrintAnalyzer{std::cout}};
-        modules.emplace_back(tracer.get());
+        // Trace is written to a terminal immediately and otherwise in blocks
+        // once per parsing round and before messages of the parser thread.
+        // Tracer goes first to write its last block before statistics of plugins
+        const bool buffered {isatty(STDOUT_FILENO) == 0};
+        std::unique_ptr<PrintAnalyzer> tracer{new PrintAnalyzer{std::cout, buffered}};
+        trace = tracer->block();
+        modules.insert(modules.begin(), tracer.get());
+        dispatch.insert(dispatch.begin(), utils::Probes::add("dispatch:trace"));
         builtin.emplace_back(std::move(tracer));
     }
 }
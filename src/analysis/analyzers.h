@@ -28,6 +28,8 @@
 #include "analysis/plugin.h"
 #include "api/plugin_api.h"
 #include "controller/parameters.h"
+#include "utils/metrics.h"
+#include "utils/probes.h"
 //------------------------------------------------------------------------------
 namespace NST
 {
@@ -53,9 +55,11 @@ public:
     >
     inline void operator()(Handle handle, const Procedure& proc)
     {
-        for(const auto a : modules)
+        utils::Metrics::add(utils::Metrics::Procedures, 1);
+        for(std::size_t i {0}; i < modules.size(); ++i)
         {
-            (a->*handle)(&proc, proc.parg, proc.pres);
+            utils::Probes::Scope probe{dispatch[i]};
+            (modules[i]->*handle)(&proc, proc.parg, proc.pres);
         }
     }
 
@@ -67,9 +71,10 @@ public:
     >
     inline void operator()(Handle handle, const RPCProcedure* rpc, ArgOrResType* arg_or_res)
     {
-        for(const auto a : modules)
+        for(std::size_t i {0}; i < modules.size(); ++i)
         {
-            (a->*handle)(rpc, arg_or_res);
+            utils::Probes::Scope probe{dispatch[i]};
+            (modules[i]->*handle)(rpc, arg_or_res);
         }
     }
 
@@ -82,9 +87,10 @@ public:
     >
     inline void operator()(Handle handle, const RPCProcedure* rpc, ArgopType* arg, ResopType* res)
     {
-        for(const auto a : modules)
+        for(std::size_t i {0}; i < modules.size(); ++i)
         {
-            (a->*handle)(rpc, arg, res);
+            utils::Probes::Scope probe{dispatch[i]};
+            (modules[i]->*handle)(rpc, arg, res);
         }
     }
 
@@ -103,14 +109,49 @@ public:
             a->on_unix_signal(signo);
         }
     }
+    inline void on_rpc_retransmission(const RPCRetransmission& retransmission)
+    {
+        for(const auto a : modules)
+        {
+            a->on_rpc_retransmission(retransmission);
+        }
+    }
+    inline void on_pipeline_metrics()
+    {
+        utils::Metrics::statistic().snapshot(metrics);
+        metrics.probes = &utils::Probes::statistic();
+        for(const auto a : modules)
+        {
+            a->on_pipeline_metrics(metrics);
+        }
+    }
+
+    //! Passes trace collected in a block to output, called by the parser thread
+    inline void flush_trace()
+    {
+        if(trace)
+        {
+            trace->pubsync();
+        }
+    }
+
+    //! Buffer of trace collected in blocks or nullptr if trace is written at once
+    inline std::streambuf* get_trace_buffer()
+    {
+        return trace;
+    }
+
     inline bool isSilent()
     {
         return _silent;
     }
 private:
     Storage  modules; // pointers to all modules (plugins and builtins)
+    std::vector<uint32_t> dispatch; // probes of modules
     Plugins  plugins;
     BuiltIns builtin;
+    MetricsStat::Snapshot metrics; // the last snapshot passed to modules
+    std::streambuf* trace; // block of tracer, it is owned by builtin
     bool _silent;
 };
 
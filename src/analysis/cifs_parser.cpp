@@ -22,6 +22,7 @@
 #include "analysis/cifs_parser.h"
 #include "api/cifs_types.h"
 #include "utils/log.h"
+#include "utils/metrics.h"
 //------------------------------------------------------------------------------
 using namespace NST::protocols;
 using namespace NST::analysis;
@@ -60,7 +61,7 @@ void CIFSParser::parse_packet(const CIFSv1::MessageHeader* header, NST::utils::F
         // It is response
         if (Session* session = sessions.get_session(ptr->session, ptr->direction, MsgType::REPLY))
         {
-            FilteredDataQueue::Ptr&& requestData = session->get_call_data(header->sec.sequenceNumber);
+            FilteredDataQueue::Ptr requestData {std::move(session->get_call_data(header->sec.sequenceNumber).data)};
             if (requestData)
             {
                 if (const MessageHeader* request = get_header(requestData->data))
@@ -77,7 +78,13 @@ void CIFSParser::parse_packet(const CIFSv1::MessageHeader* header, NST::utils::F
         // It is request
         if (Session* session = sessions.get_session(ptr->session, ptr->direction, MsgType::CALL))
         {
-            return session->save_call_data(header->sec.sequenceNumber, std::move(ptr));
+            const auto sequence = header->sec.sequenceNumber;
+            if (session->save_call_data(sequence, std::move(ptr)))
+            {
+                utils::Metrics::add(utils::Metrics::Retransmits, 1);
+                LOG("Replace CIFS request with sequence number %d for %s", sequence, session->str().c_str());
+            }
+            return;
         }
         LOG("Can't get right CIFS session");
     }
@@ -93,7 +100,7 @@ void CIFSParser::parse_packet(const CIFSv2::MessageHeader* header, utils::Filter
         // It is response
         if (Session* session = sessions.get_session(ptr->session, ptr->direction, MsgType::REPLY))
         {
-            FilteredDataQueue::Ptr&& requestData = session->get_call_data(header->messageId);
+            FilteredDataQueue::Ptr requestData {std::move(session->get_call_data(header->messageId).data)};
             if (requestData)
             {
                 if (const MessageHeader* request = get_header(requestData->data))
@@ -115,7 +122,13 @@ void CIFSParser::parse_packet(const CIFSv2::MessageHeader* header, utils::Filter
             {
                 return analyse_operation(session, header, nullptr, std::move(ptr), std::move(nullptr));
             }
-            return session->save_call_data(header->messageId, std::move(ptr));
+            const auto messageId = header->messageId;
+            if (session->save_call_data(messageId, std::move(ptr)))
+            {
+                utils::Metrics::add(utils::Metrics::Retransmits, 1);
+                LOG("Replace SMB2 request with MessageId %d for %s", messageId, session->str().c_str());
+            }
+            return;
         }
         LOG("Can't get right CIFS session");
     }
@@ -24,6 +24,7 @@
 #include "protocols/rpc/rpc_header.h"
 #include "protocols/xdr/xdr_decoder.h"
 #include "utils/log.h"
+#include "utils/metrics.h"
 //------------------------------------------------------------------------------
 using namespace NST::protocols::xdr;
 //------------------------------------------------------------------------------
@@ -60,7 +61,10 @@ bool NFSParser::parse_data(FilteredDataQueue::Ptr& ptr)
             Session* session = sessions.get_session(ptr->session, ptr->direction, MsgType::CALL);
             if (session)
             {
-                session->save_call_data(call->xid(), std::move(ptr));
+                if (session->save_call_data(call->xid(), std::move(ptr)))
+                {
+                    utils::Metrics::add(utils::Metrics::Retransmits, 1);
+                }
             }
             return true;
         }
@@ -82,10 +86,21 @@ bool NFSParser::parse_data(FilteredDataQueue::Ptr& ptr)
         Session* session = sessions.get_session(ptr->session, ptr->direction, MsgType::REPLY);
         if (session)
         {
-            FilteredDataQueue::Ptr&& call_data = session->get_call_data(reply->xid());
-            if (call_data)
+            Session::Call&& call = session->get_call_data(reply->xid());
+            if (call.data)
             {
-                analyze_nfs_procedure(std::move(call_data), std::move(ptr), session);
+                if (call.retransmits)
+                {
+                    const RPCRetransmission retransmission {session->get_session(),
+                                                            &call.first,
+                                                            &call.data->timestamp,
+                                                            &ptr->timestamp,
+                                                            reply->xid(),
+                                                            call.retransmits,
+                                                            session->get_retransmits()};
+                    analyzers.on_rpc_retransmission(retransmission);
+                }
+                analyze_nfs_procedure(std::move(call.data), std::move(ptr), session);
             }
             return true;
         }
@@ -269,6 +284,8 @@ void NFSParser::analyze_nfs_procedure( FilteredDataQueue::Ptr&& call,
     }
     catch (XDRDecoderError& e)
     {
+        utils::Metrics::add(utils::Metrics::XDRErrors, 1);
+
         const char* procedure_name {"Unknown procedure"};
         switch (major_version)
         {
@@ -23,11 +23,15 @@
 #define NFS_PARSER_THREAD_H
 //------------------------------------------------------------------------------
 #include <atomic>
+#include <chrono>
 #include <thread>
 
 #include "analysis/analyzers.h"
 #include "controller/running_status.h"
 #include "utils/filtered_data.h"
+#include "utils/metrics.h"
+#include "utils/out.h"
+#include "utils/probes.h"
 //------------------------------------------------------------------------------
 namespace NST
 {
@@ -40,9 +44,10 @@ class ParserThread
     using RunningStatus     = NST::controller::RunningStatus;
     using FilteredDataQueue = NST::utils::FilteredDataQueue;
 public:
-    ParserThread(Parser p, FilteredDataQueue& q, RunningStatus& s)
+    ParserThread(Parser p, FilteredDataQueue& q, RunningStatus& s, Analyzers& a)
     : status   (s)
     , queue    (q)
+    , analyzers(a)
     , running  {ATOMIC_FLAG_INIT} // false
     , parser(p)
     {
@@ -72,15 +77,27 @@ private:
     {
         try
         {
+            // messages of this thread follow trace of preceding procedures
+            utils::Out::Preceding trace{analyzers.get_trace_buffer()};
+            const std::chrono::seconds period {1}; // of reports of metrics to analyzers
+            auto report = std::chrono::steady_clock::now() + period;
             while(running.test_and_set())
             {
                 // process all available items from queue
                 process_queue();
 
+                const auto now = std::chrono::steady_clock::now();
+                if(now >= report)
+                {
+                    analyzers.on_pipeline_metrics();
+                    report = now + period;
+                }
+
                 // then sleep this thread
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
             process_queue(); // flush data from queue
+            analyzers.on_pipeline_metrics();
         }
         catch(...)
         {
@@ -90,26 +107,38 @@ private:
 
     inline void process_queue()
     {
+        uint64_t depth {0};
         while(true)
         {
             // take all items from the queue
             FilteredDataQueue::List list{queue};
             if(!list)
             {
-                return; // list from queue is empty, break infinity loop
+                break; // list from queue is empty, break infinity loop
             }
 
             do
             {
                 FilteredDataQueue::Ptr data = list.get_current();
+                if(data->queued)
+                {
+                    utils::Probes::record(utils::Probes::QueueWait, utils::Probes::now() - data->queued);
+                }
                 parser.parse_data(data);
+                ++depth;
             }
             while(list);
         }
+        if(depth)
+        {
+            utils::Metrics::record(utils::Metrics::ParsingRound, depth);
+            analyzers.flush_trace(); // trace of the round is written at once
+        }
     }
 
     RunningStatus& status;
     FilteredDataQueue& queue;
+    Analyzers& analyzers;
 
     std::thread parsing;
     std::atomic_flag running;
@@ -33,6 +33,7 @@
 #include "protocols/nfs4/nfs4_utils.h"
 #include "protocols/nfs4/nfs41_utils.h"
 #include "protocols/cifs2/cifs2_utils.h"
+#include "utils/fast_num_put.h"
 #include "utils/sessions.h"
 //------------------------------------------------------------------------------
 namespace NST
@@ -53,6 +54,8 @@ namespace NFS41 = NST::API::NFS41;
 
 namespace
 { 
+const std::size_t BlockSize {1024 * 1024}; // size of output block if buffered
+
 bool print_procedure(std::ostream& out, const RPCProcedure* proc)
 {
     using namespace NST::utils;
@@ -814,6 +817,18 @@ void PrintAnalyzer::breakOplockSMBv2(const SMBv2::BreakOpLockCommand* cmd,
 // 2nd line - <tabulation>related RPC procedure-specific arguments
 // 3rd line - <tabulation>related RPC procedure-specific results
 
+PrintAnalyzer::PrintAnalyzer(std::ostream& o, bool buffered)
+    : buffer{buffered ? new utils::BlockBuffer{o.rdbuf(), BlockSize} : nullptr}
+    , out(buffered ? buffer.get() : o.rdbuf())
+{
+    utils::imbue_fast_num_put(out);
+}
+
+PrintAnalyzer::~PrintAnalyzer()
+{
+    out.flush();
+}
+
 void PrintAnalyzer::null(const RPCProcedure* proc,
                          const struct NFS3::NULL3args*,
                          const struct NFS3::NULL3res*)
@@ -4025,7 +4040,7 @@ void PrintAnalyzer::nfs41_operation(const struct NFS41::ILLEGAL4res* res)
 
 void PrintAnalyzer::flush_statistics()
 {
-    // flush is in each handler
+    out.flush();
 }
 
 } // namespace analysis
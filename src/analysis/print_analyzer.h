@@ -22,9 +22,11 @@
 #ifndef PRINT_ANALYZER_H
 #define PRINT_ANALYZER_H
 //------------------------------------------------------------------------------
+#include <memory>
 #include <ostream>
 
 #include "api/plugin_api.h"
+#include "utils/block_buffer.h"
 //------------------------------------------------------------------------------
 namespace NST
 {
@@ -38,12 +40,13 @@ namespace NFS41 = NST::API::NFS41;
 class PrintAnalyzer : public IAnalyzer
 {
 public:
-    PrintAnalyzer(std::ostream& o) : out(o)
-    {
-    }
-    ~PrintAnalyzer()
-    {
-    }
+    // If buffered is true output is collected in large blocks and passed to
+    // the stream by one call, otherwise it is written as soon as formatted
+    PrintAnalyzer(std::ostream& o, bool buffered = false);
+    ~PrintAnalyzer();
+
+    // Returns buffer of the block collected for the stream or nullptr
+    inline std::streambuf* block() const { return buffer.get(); }
 
     void closeFileSMBv2(const SMBv2::CloseFileCommand*,
                         const SMBv2::CloseRequest*,
@@ -463,7 +466,8 @@ private:
     PrintAnalyzer(const PrintAnalyzer&)            = delete;
     PrintAnalyzer& operator=(const PrintAnalyzer&) = delete;
 
-    std::ostream& out;
+    std::unique_ptr<utils::BlockBuffer> buffer;
+    std::ostream out;
 };
 
 } // namespace analysis
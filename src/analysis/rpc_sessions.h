@@ -29,6 +29,8 @@
 #include <unordered_map>
 #include <utility>
 
+#include <sys/time.h>
+
 #include "protocols/rpc/rpc_header.h"
 #include "utils/filtered_data.h"
 #include "utils/log.h"
@@ -45,8 +47,17 @@ class Session : public utils::ApplicationSession
     using FilteredDataQueue = NST::utils::FilteredDataQueue;
 public:
 
+    //! RPC Call waiting for its Reply
+    struct Call
+    {
+        FilteredDataQueue::Ptr data;    // data of the last sent Call
+        struct timeval first;           // timestamp of the first sent Call
+        std::uint32_t  retransmits;     // amount of Calls sent again with the same XID
+    };
+
     Session(const utils::NetworkSession& s, utils::Session::Direction call_direction)
     : utils::ApplicationSession{s, call_direction}
+    , retransmits{0}
     {
         utils::Out message;
         message << "Detect session " << str();
@@ -54,40 +65,53 @@ public:
     ~Session() = default;
     Session(const Session&)            = delete;
     Session& operator=(const Session&) = delete;
-    
-    void save_call_data(const std::uint64_t xid, FilteredDataQueue::Ptr&& data)
+
+    //! Saves Call until its Reply
+    /*! Call with the XID which is waiting for Reply already is a retransmission:
+     *  the latest data replaces previous one, but the first timestamp is kept.
+     *  \return True if the Call is a retransmission
+     */
+    bool save_call_data(const std::uint64_t xid, FilteredDataQueue::Ptr&& data)
     {
-        FilteredDataQueue::Ptr& e = operations[xid];
-        if(e)                   // xid call already exists
+        Call& e = operations[xid];
+        if(e.data)              // xid call already exists
         {
-            LOG("replace RPC Call XID:%" PRIu64 " for %s", xid, str().c_str());
+            ++e.retransmits;
+            ++retransmits;
+            e.data = std::move(data);   // replace existing
+            return true;
         }
 
-        e = std::move(data);    // replace existing or set new
+        e.first = data->timestamp;
+        e.retransmits = 0;
+        e.data = std::move(data);       // set new
+        return false;
     }
-    inline FilteredDataQueue::Ptr get_call_data(const std::uint64_t xid)
+    inline Call get_call_data(const std::uint64_t xid)
     {
         auto i = operations.find(xid);
         if(i != operations.end())
         {
-            FilteredDataQueue::Ptr ptr{std::move(i->second)};
+            Call call = std::move(i->second);
             operations.erase(i);
-            return ptr;
+            return call;
         }
         else
         {
             LOG("RPC Call XID:%" PRIu64 " is not found for %s", xid, str().c_str());
         }
 
-        return FilteredDataQueue::Ptr{};
+        return Call{};
     }
 
+    inline std::uint64_t get_retransmits() const { return retransmits; }
     inline const Session* get_session() const { return this; }
 private:
 
     // TODO: add custom allocator based on BlockAllocator
     // to decrease cost of expensive insert/erase operations
-    std::unordered_map<std::uint64_t, FilteredDataQueue::Ptr> operations;
+    std::unordered_map<std::uint64_t, Call> operations;
+    std::uint64_t retransmits; // amount of retransmitted Calls
 };
 
 template <typename Session>
@@ -114,7 +138,14 @@ public:
             }
         }
 
-        return reinterpret_cast<Session*>(app->application);
+        Session* session {reinterpret_cast<Session*>(app->application)};
+        // "Detect session" has numeric addresses, names are told when known
+        if(session && session->names_resolved())
+        {
+            utils::Out message;
+            message << "Resolve session " << session->str();
+        }
+        return session;
     }
 
 private:
@@ -68,6 +68,8 @@ public:
     const HeaderType* res_header = nullptr;
     const RequestType* parg = nullptr;//!< Arguments of specified command
     const ResponseType* pres = nullptr;//!< Results of specified command
+    uint32_t req_length = 0;//!< Captured length of call message, it includes commands compounded after this one (SMBv2 only)
+    uint32_t res_length = 0;//!< Captured length of reply message, it includes commands compounded after this one (SMBv2 only)
 };
 
 using CreateDirectoryCommand = SMBv1::Command< NST::protocols::CIFSv1::RawMessageHeader, CreateDirectoryArgumentType, CreateDirectoryResultType>;                          //!< CreateDirectory command
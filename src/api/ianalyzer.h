@@ -29,6 +29,7 @@
 #include "nfs3_types_rpcgen.h"
 #include "nfs4_types_rpcgen.h"
 #include "nfs41_types_rpcgen.h"
+#include "metrics_stat.h"
 #include "rpc_types.h"
 //------------------------------------------------------------------------------
 namespace NST
@@ -1802,6 +1803,17 @@ public:
     virtual ~IAnalyzer() {}
     virtual void flush_statistics() = 0;
     virtual void on_unix_signal(int /*signo*/) {}
+
+    /*! Passes metrics of filtration, queuing and analysis to analyzer about
+     *  once per second and when processing is finished
+     * \param Snapshot - merged metrics, valid during the call only
+     */
+    virtual void on_pipeline_metrics(const MetricsStat::Snapshot& /*metrics*/) {}
+
+    /*! Reports RPC Call which was retransmitted before its Reply
+     * \param RPCRetransmission - Call details, valid during the call only
+     */
+    virtual void on_rpc_retransmission(const RPCRetransmission& /*retransmission*/) {}
 };
 
 } // namespace API
@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Registry of counters, gauges and histograms of nfstrace internals
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef METRICS_STAT_H
+#define METRICS_STAT_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "probe_stat.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace API
+{
+
+/*! Counters, gauges and histograms of filtration, queuing and analysis.
+ *  As in ProbeStat each thread updates its own shard without read-modify-write
+ *  operations and readers merge shards at any time. A gauge is kept as a sum
+ *  of increments and decrements, so it may be changed by different threads
+ *  (e.g. elements of the queue are allocated by filtration and freed by
+ *  analysis). Bucket i of a histogram counts values in [2^i, 2^(i+1)).
+ */
+struct MetricsStat
+{
+    static const uint32_t Buckets    {32};
+    static const uint32_t MaxMetrics {32}; //!< metrics beyond the limit share the last one
+    static const uint32_t MaxShards  {16}; //!< threads beyond the limit share the last shard atomically
+
+    enum class Type : uint32_t
+    {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Descriptor
+    {
+        const char* name;
+        const char* help;
+        Type        type;
+    };
+
+    struct Cell
+    {
+        std::atomic<int64_t>  value; //!< counter, gauge or sum of histogram values
+        std::atomic<uint64_t> count; //!< values recorded to histogram
+        std::atomic<uint64_t> buckets[Buckets];
+    };
+
+    struct alignas(64) Shard
+    {
+        Cell metrics[MaxMetrics];
+    };
+
+    //! Metric merged from all shards
+    struct Metric
+    {
+        const char* name;
+        const char* help;
+        Type        type;
+        int64_t     value;
+        uint64_t    count;
+        uint64_t    buckets[Buckets];
+
+        inline double mean() const
+        {
+            return count ? static_cast<double>(value) / count : 0.0;
+        }
+
+        //! Upper bound of the bucket which holds the given quantile (0..1)
+        inline uint64_t quantile(double q) const
+        {
+            const uint64_t rank {static_cast<uint64_t>(q * count)};
+            uint64_t seen {0};
+            for(uint32_t i {0}; i < Buckets; ++i)
+            {
+                seen += buckets[i];
+                if(seen > rank)
+                {
+                    return uint64_t{2} << i;
+                }
+            }
+            return 0;
+        }
+    };
+
+    //! Consistent copy of all registered metrics
+    struct Snapshot
+    {
+        uint32_t size;
+        Metric   metrics[MaxMetrics];
+        const ProbeStat* probes {nullptr}; //!< latency histograms of pipeline stages, see ProbeStat::enabled
+
+        //! Returns metric by name or nullptr if it is not registered
+        inline const Metric* find(const char* name) const
+        {
+            for(uint32_t i {0}; i < size; ++i)
+            {
+                if(std::strcmp(metrics[i].name, name) == 0)
+                {
+                    return &metrics[i];
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    //! Amount of registered metrics
+    inline uint32_t size() const
+    {
+        return registered.load(std::memory_order_acquire);
+    }
+
+    //! Merges shards of all registered metrics
+    inline void snapshot(Snapshot& s) const
+    {
+        s.size = size();
+        for(uint32_t m {0}; m < s.size; ++m)
+        {
+            Metric& metric = s.metrics[m];
+            metric.name  = descriptors[m].name;
+            metric.help  = descriptors[m].help;
+            metric.type  = descriptors[m].type;
+            metric.value = 0;
+            metric.count = 0;
+            for(uint32_t i {0}; i < Buckets; ++i)
+            {
+                metric.buckets[i] = 0;
+            }
+        }
+        const uint32_t used {shards.load(std::memory_order_acquire)};
+        for(uint32_t n {0}; n < used && n < MaxShards; ++n)
+        {
+            for(uint32_t m {0}; m < s.size; ++m)
+            {
+                const Cell& c = shard[n].metrics[m];
+                Metric& metric = s.metrics[m];
+                metric.value += c.value.load(std::memory_order_relaxed);
+                if(metric.type == Type::Histogram)
+                {
+                    metric.count += c.count.load(std::memory_order_relaxed);
+                    for(uint32_t i {0}; i < Buckets; ++i)
+                    {
+                        metric.buckets[i] += c.buckets[i].load(std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+    }
+
+    std::atomic<uint32_t> registered {0};   //!< registered metrics
+    std::atomic<uint32_t> shards     {0};   //!< shards taken by threads
+    Descriptor descriptors[MaxMetrics] {};  //!< written before registered is increased
+    Shard shard[MaxShards] {};
+};
+
+} // namespace API
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//METRICS_STAT_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Latency histograms of hot-path probes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef PROBE_STAT_H
+#define PROBE_STAT_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace API
+{
+
+/*! Latency histograms of probes placed in hot paths of nfstrace.
+ *  Each thread records to its own shard, so writers never share cache lines
+ *  and need no read-modify-write operations; readers merge shards at any time.
+ *  Bucket i of a histogram counts durations in [2^i, 2^(i+1)) ticks, ticks
+ *  are converted to nanoseconds with ns_per_tick.
+ */
+struct ProbeStat
+{
+    static const uint32_t Buckets   {48};
+    static const uint32_t MaxProbes {24}; //!< probes beyond the limit share the last one
+    static const uint32_t MaxShards {16}; //!< threads beyond the limit are not recorded
+
+    struct alignas(64) Histogram
+    {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> ticks; //!< sum of durations
+        std::atomic<uint64_t> max;
+        std::atomic<uint64_t> buckets[Buckets];
+    };
+
+    struct Shard
+    {
+        Histogram probes[MaxProbes];
+    };
+
+    //! Histogram of a probe merged from all shards
+    struct Summary
+    {
+        const char* name;
+        uint64_t count;
+        double   total_ns;
+        double   max_ns;
+        double   ns_per_tick;
+        uint64_t buckets[Buckets];
+
+        inline double mean_ns() const
+        {
+            return count ? total_ns / count : 0.0;
+        }
+
+        //! Upper bound of the bucket which holds the given quantile (0..1)
+        inline double quantile_ns(double q) const
+        {
+            const uint64_t rank {static_cast<uint64_t>(q * count)};
+            uint64_t seen {0};
+            for(uint32_t i {0}; i < Buckets; ++i)
+            {
+                seen += buckets[i];
+                if(seen > rank)
+                {
+                    const double bound {static_cast<double>(uint64_t{2} << i) * ns_per_tick};
+                    return bound < max_ns ? bound : max_ns;
+                }
+            }
+            return max_ns;
+        }
+    };
+
+    //! Amount of registered probes
+    inline uint32_t size() const
+    {
+        return probes.load(std::memory_order_acquire);
+    }
+
+    //! Merges shards of a registered probe
+    inline void summary(uint32_t probe, Summary& s) const
+    {
+        s.name        = names[probe];
+        s.count       = 0;
+        s.total_ns    = 0.0;
+        s.max_ns      = 0.0;
+        s.ns_per_tick = ns_per_tick.load(std::memory_order_relaxed);
+
+        uint64_t ticks {0};
+        uint64_t max   {0};
+        for(uint32_t i {0}; i < Buckets; ++i)
+        {
+            s.buckets[i] = 0;
+        }
+        const uint32_t used {shards.load(std::memory_order_acquire)};
+        for(uint32_t n {0}; n < used && n < MaxShards; ++n)
+        {
+            const Histogram& h = shard[n].probes[probe];
+            s.count += h.count.load(std::memory_order_relaxed);
+            ticks   += h.ticks.load(std::memory_order_relaxed);
+            const uint64_t m {h.max.load(std::memory_order_relaxed)};
+            max = m > max ? m : max;
+            for(uint32_t i {0}; i < Buckets; ++i)
+            {
+                s.buckets[i] += h.buckets[i].load(std::memory_order_relaxed);
+            }
+        }
+        s.total_ns = ticks * s.ns_per_tick;
+        s.max_ns   = max   * s.ns_per_tick;
+    }
+
+    std::atomic<bool>     enabled     {false};
+    std::atomic<double>   ns_per_tick {1.0};
+    std::atomic<uint32_t> probes      {0};  //!< registered probes
+    std::atomic<uint32_t> shards      {0};  //!< shards taken by threads
+    const char* names[MaxProbes] {};        //!< written before probes is increased
+    Shard shard[MaxShards] {};
+};
+
+} // namespace API
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//PROBE_STAT_H
+//------------------------------------------------------------------------------
@@ -33,6 +33,21 @@ namespace API
 
 using RPCProcedure = Procedure<struct rpc_msg>;
 
+/*! RPC Call which was sent again with the same XID before its Reply was seen.
+ *  It is passed to analyzers right before the procedure is, so latency may be
+ *  measured from the first send as well as from the last one (ctimestamp).
+ */
+struct RPCRetransmission
+{
+    const struct Session* session;
+    const struct timeval* first_ctimestamp; //!< first send of the Call
+    const struct timeval* last_ctimestamp;  //!< last send of the Call
+    const struct timeval* rtimestamp;       //!< Reply
+    uint32_t xid;
+    uint32_t retransmits;                   //!< amount of repeated sends of the Call
+    uint64_t session_retransmits;           //!< retransmitted Calls of the session so far
+};
+
 const uint32_t SUNRPC_MSG_VERSION = 2;
 
 enum MsgType : int32_t
@@ -51,14 +51,24 @@ Opt Args::options[Args::num] =
     {'d', "direction",  Opt::REQ, "inout",               "set the direction for which packets will be captured",                "in|out|inout",           nullptr, false},
     {'a', "analysis",   Opt::MUL, "",                    "specify the path to an analysis module and set its options (if any)", "PATH#opt1,opt2=val,...", nullptr, false},
     {'I', "ifile",      Opt::REQ, "PROGRAMNAME-BPF.pcap","specify the input file for " STAT " mode, the '-' means stdin",       "PATH",                   nullptr, false},
+    { 0 , "start",      Opt::REQ, "",                    "read packets of the input file from the time, the index of the file is used if there is one", "SECONDS[.FRACTION]|YYYY-MM-DDTHH:MM:SS (UTC)", nullptr, false},
+    { 0 , "end",        Opt::REQ, "",                    "read packets of the input file until the time (exclusive)",          "SECONDS[.FRACTION]|YYYY-MM-DDTHH:MM:SS (UTC)", nullptr, false},
+    { 0 , "flow",       Opt::REQ, "",                    "read packets of the TCP or UDP flow from the input file, '*' means any address", "ADDR[:PORT][-ADDR[:PORT]][/tcp|/udp]", nullptr, false},
     {'O', "ofile",      Opt::REQ, "PROGRAMNAME-BPF.pcap","specify the output file for " DUMP " mode, the '-' means stdout",     "PATH",                   nullptr, false},
     { 0 , "log",        Opt::REQ, "nfstrace.log",        "specify the log file",                                                "PATH",                   nullptr, false},
     {'C', "command",    Opt::REQ, "",                    "execute command for each dumped file",                                "\"shell command\"",      nullptr, false},
     {'D', "dump-size",  Opt::REQ, "0",                   "set the size of dumping file portion, 0 means no limit",              "MBytes",                 nullptr, false},
+    { 0 , "dump-interval", Opt::REQ, "0",                "rotate dumping file at multiples of the interval, parts are named by UTC start time, 0 means no limit", "Seconds", nullptr, false},
+    { 0 , "dump-packets", Opt::REQ, "0",                 "set the amount of packets in dumping file portion, 0 means no limit", "Packets",              nullptr, false},
+    { 0 , "dump-index", Opt::REQ, "1000",                "write index of each dumping file portion to PATH.idx with an entry per amount of packets, 0 disables it", "Packets", nullptr, false},
+    { 0 , "compress",   Opt::REQ, "none",                "compress dumped files by worker threads, the dump-size limits compressed bytes", "none|gzip[:1..9]", nullptr, false},
+    { 0 , "compress-threads", Opt::REQ, "0",             "set the amount of compression threads, 0 means a half of CPUs",      "0..64",                  nullptr, false},
     {'E', "enum",       Opt::REQ, "none",                "enumerate all available network interfaces and/or all available plugins, then exit", "interfaces|plugins|-", nullptr, false},
     {'M', "msg-header", Opt::REQ, "512",                 "Truncate RPC messages to this limit (specified in bytes) before passing to a pluggable analysis module", "1..4000", nullptr, false},
     {'Q', "qcapacity",  Opt::REQ, "4096",                "set the initial capacity of the queue with RPC messages",                                   "1..65535", nullptr, false},
     {'T', "trace",      Opt::NOA, "false",               "print collected NFSv3 or NFSv4 procedures, true if no modules were passed with -a option",  nullptr,    nullptr, false},
+    { 0 , "probes",     Opt::NOA, "false",               "measure latency of pipeline stages and modules, report it on SIGUSR1 and exit",          nullptr,    nullptr, false},
+    { 0 , "no-dns",     Opt::NOA, "false",               "don't look up host names of sessions, they are looked up in background with -v 2",     nullptr,    nullptr, false},
     {'Z', "droproot",   Opt::REQ, "",                    "drop root privileges after opening the capture device",                                    "username", nullptr, false},
     {'v', "verbose",    Opt::REQ, "1",                   "specify verbosity level",                                                                   "0|1|2",    nullptr, false},
     {'h', "help",       Opt::NOA, "false",               "print help message and usage for modules passed with -a options, then exit",                nullptr,    nullptr, false}
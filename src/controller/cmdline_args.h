@@ -47,14 +47,24 @@ struct Args
         ArgDirection,
         ArgAnalyzers,
         ArgIFile,
+        ArgStart,
+        ArgEnd,
+        ArgFlow,
         ArgOFile,
         ArgLogPath,
         ArgCommand,
         ArgDSize,
+        ArgDInterval,
+        ArgDPackets,
+        ArgDIndex,
+        ArgCompress,
+        ArgCompressThreads,
         ArgEnum,
         ArgMSize,
         ArgQSize,
         ArgTrace,
+        ArgProbes,
+        ArgNoDNS,
         ArgDropRoot,
         ArgVerbose,
         ArgHelp,
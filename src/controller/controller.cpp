@@ -29,6 +29,8 @@
 #include "utils/filtered_data.h"
 #include "controller/controller.h"
 #include "controller/parameters.h"
+#include "utils/metrics.h"
+#include "utils/probes.h"
 //------------------------------------------------------------------------------
 namespace NST
 {
@@ -61,10 +63,16 @@ Controller::Running::~Running()
 Controller::Controller(const Parameters& params) try
     : gout       {utils::Out::Level(params.verbose_level())}
     , glog       {params.log_path()}
+    , gnames     {params.dns_lookups()}
     , signals    {status}
     , analysis   {}
     , filtration {new FiltrationManager{status}}
 {
+    if(params.probes())
+    {
+        utils::Probes::enable();
+    }
+
     switch(params.running_mode())
     {
         case RunningMode::Profiling:
@@ -87,7 +95,7 @@ Controller::Controller(const Parameters& params) try
             if(analysis->isSilent())
                 utils::Out::Global::set_level(utils::Out::Level::Silent);
 
-            filtration->add_offline_analysis(params.input_file(),
+            filtration->add_offline_analysis(params,
                                              analysis->get_queue());
         }
         break;
@@ -133,6 +141,18 @@ int Controller::run()
                 {
                     analysis->on_unix_signal(s.signal_number);
                 }
+                else if(s.signal_number == SIGUSR1)
+                {
+                    static utils::Log::Site log_site;
+                    if(utils::Log message{log_site})
+                    {
+                        utils::Metrics::print(message);
+                        if(utils::Probes::enabled())
+                        {
+                            utils::Probes::print(message);
+                        }
+                    }
+                }
                 else if(s.signal_number == SIGINT)
                 {
                     throw ProcessingDone{std::string{"Interrupted by user."}};
@@ -155,9 +175,15 @@ int Controller::run()
             message << e.what();
         }
     }
-    if(utils::Log message{})
+    static utils::Log::Site log_site;
+    if(utils::Log message{log_site})
     {
         status.print(message);
+        utils::Metrics::print(message);
+        if(utils::Probes::enabled())
+        {
+            utils::Probes::print(message);
+        }
     }
     return 0;
 }
@@ -30,6 +30,7 @@
 #include "controller/parameters.h"
 #include "controller/running_status.h"
 #include "controller/signal_handler.h"
+#include "utils/host_names.h"
 #include "utils/log.h"
 #include "utils/out.h"
 //------------------------------------------------------------------------------
@@ -76,6 +77,8 @@ private:
     utils::Out::Global gout;
     // initializer for global logger
     utils::Log::Global glog;
+    // initializer for background lookups of host names
+    utils::HostNames::Global gnames;
 
     // storage for exceptions
     RunningStatus status;
@@ -19,9 +19,16 @@
     along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
 */
 //------------------------------------------------------------------------------
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 
+#include <arpa/inet.h>
 #include <dirent.h>
+#include <netinet/in.h>
 #include <unistd.h>
 
 #include "analysis/plugin.h"
@@ -30,6 +37,7 @@
 #include "controller/parameters.h"
 #include "controller/build_info.h"
 #include "filtration/pcap/network_interfaces.h"
+#include "utils/out.h"
 //------------------------------------------------------------------------------
 namespace NST
 {
@@ -196,6 +204,138 @@ private:
     std::vector<AParams> analysis_modules;
 };
 
+// seconds since Epoch with an optional fraction or UTC date and time
+static uint64_t parse_time(const std::string& value)
+{
+    const char* s {value.c_str()};
+    uint64_t seconds {0};
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    const char* rest {strptime(s, "%Y-%m-%d", &tm)};
+    if(rest && (*rest == 'T' || *rest == ' '))
+    {
+        rest = strptime(rest + 1, "%H:%M:%S", &tm);
+    }
+    if(rest)
+    {
+        const time_t time {timegm(&tm)};
+        if(time < 0)
+        {
+            throw cmdline::CLIError{std::string{"Invalid time: "} + value};
+        }
+        seconds = static_cast<uint64_t>(time);
+        s = rest;
+    }
+    else if(isdigit(*s))
+    {
+        char* end {nullptr};
+        seconds = strtoull(s, &end, 10);
+        s = end;
+    }
+    uint64_t fraction {0};
+    if(*s == '.')
+    {
+        for(uint64_t scale = 100000; isdigit(*++s); scale /= 10)
+        {
+            fraction += (*s - '0') * scale;
+        }
+    }
+    if(*s != '\0' || s == value.c_str())
+    {
+        throw cmdline::CLIError{std::string{"Invalid time: "} + value};
+    }
+    return seconds * 1000000 + fraction;
+}
+
+// ADDR[:PORT], [IPv6][:PORT] or *:PORT
+static bool parse_endpoint(const std::string& text, filtration::pcap::SelectiveReader::Endpoint& endpoint)
+{
+    std::string address {text};
+    std::string port;
+    if(!text.empty() && text[0] == '[')
+    {
+        const size_t close {text.find(']')};
+        if(close == std::string::npos ||
+           (close + 1 < text.size() && text[close + 1] != ':'))
+        {
+            return false;
+        }
+        address = text.substr(1, close - 1);
+        port    = text.substr(std::min(close + 2, text.size()));
+    }
+    else if(std::count(text.begin(), text.end(), ':') == 1) // IPv6 has more
+    {
+        const size_t colon {text.find(':')};
+        address = text.substr(0, colon);
+        port    = text.substr(colon + 1);
+    }
+
+    endpoint = filtration::pcap::SelectiveReader::Endpoint{};
+    if(address != "*")
+    {
+        if(inet_pton(AF_INET, address.c_str(), endpoint.address) == 1)
+        {
+            endpoint.family = 4;
+        }
+        else if(inet_pton(AF_INET6, address.c_str(), endpoint.address) == 1)
+        {
+            endpoint.family = 6;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if(!port.empty())
+    {
+        if(port.size() > 5 || port.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        const int number {atoi(port.c_str())};
+        if(number < 1 || number > 65535)
+        {
+            return false;
+        }
+        endpoint.port = static_cast<uint16_t>(number);
+    }
+    return endpoint.family || endpoint.port;
+}
+
+// ENDPOINT[-ENDPOINT][/tcp|/udp]
+static bool parse_flow(const std::string& text, filtration::pcap::SelectiveReader::Flow& flow)
+{
+    std::string endpoints {text};
+    flow = filtration::pcap::SelectiveReader::Flow{};
+    const size_t slash {text.rfind('/')};
+    if(slash != std::string::npos)
+    {
+        const std::string protocol {text.substr(slash + 1)};
+        if(protocol == "tcp")
+        {
+            flow.protocol = IPPROTO_TCP;
+        }
+        else if(protocol == "udp")
+        {
+            flow.protocol = IPPROTO_UDP;
+        }
+        else
+        {
+            return false;
+        }
+        endpoints = text.substr(0, slash);
+    }
+    const size_t dash {endpoints.find('-')};
+    if(dash == std::string::npos)
+    {
+        flow.amount = 1;
+        return parse_endpoint(endpoints, flow.endpoints[0]);
+    }
+    flow.amount = 2;
+    return parse_endpoint(endpoints.substr(0, dash),  flow.endpoints[0]) &&
+           parse_endpoint(endpoints.substr(dash + 1), flow.endpoints[1]);
+}
+
 } // unnamed namespace
 
 Parameters::Parameters(int argc, char** argv)
@@ -282,6 +422,17 @@ bool Parameters::trace() const
     return impl->get(CLI::ArgTrace).to_bool() || impl->analysis_modules.empty();
 }
 
+bool Parameters::probes() const
+{
+    return impl->get(CLI::ArgProbes).to_bool();
+}
+
+bool Parameters::dns_lookups() const
+{
+    // names are shown by the highest verbosity level only
+    return !impl->get(CLI::ArgNoDNS).to_bool() && verbose_level() == static_cast<int>(utils::Out::Level::All);
+}
+
 int Parameters::verbose_level() const
 {
     return impl->get(CLI::ArgVerbose).to_int();
@@ -357,11 +508,82 @@ const Parameters::DumpingParams Parameters::dumping_params() const
     {
         throw cmdline::CLIError{std::string{"Output file \"-\" means stdout, the dump-size must be 0"}};
     }
+    const int dinterval = impl->get(CLI::ArgDInterval).to_int();
+    const int dpackets  = impl->get(CLI::ArgDPackets).to_int();
+    const int dindex    = impl->get(CLI::ArgDIndex).to_int();
+    if(dinterval < 0 || dpackets < 0 || dindex < 0)
+    {
+        throw cmdline::CLIError{std::string{"Rotation and index options of dumping must not be negative"}};
+    }
+    if((dinterval != 0 || dpackets != 0) && ofile == "-")
+    {
+        throw cmdline::CLIError{std::string{"Output file \"-\" means stdout, the dump-interval and dump-packets must be 0"}};
+    }
 
     Parameters::DumpingParams params;
-    params.output_file = ofile;
-    params.command     = impl->get(CLI::ArgCommand);
-    params.size_limit  = dsize * 1024 * 1024; // MBytes
+    params.output_file  = ofile;
+    params.command      = impl->get(CLI::ArgCommand);
+    params.size_limit   = dsize * 1024 * 1024; // MBytes
+    params.interval     = dinterval;
+    params.packet_limit = dpackets;
+    params.index        = dindex;
+
+    const std::string compress {impl->get(CLI::ArgCompress)};
+    if(compress.compare(0, 4, "gzip") == 0 && (compress.size() == 4 || compress[4] == ':'))
+    {
+        params.compression = filtration::DumpWriter::Compression::Gzip;
+        if(compress.size() > 4)
+        {
+            params.level = atoi(compress.c_str() + 5);
+            if(params.level < 1 || params.level > 9)
+            {
+                throw cmdline::CLIError{std::string{"Invalid level of compression: "} + compress};
+            }
+        }
+    }
+    else if(compress != "none")
+    {
+        throw cmdline::CLIError{std::string{"Unknown compression: "} + compress};
+    }
+
+    const int threads = impl->get(CLI::ArgCompressThreads).to_int();
+    if(threads < 0 || threads > 64)
+    {
+        throw cmdline::CLIError{std::string{"Invalid amount of compression threads: "}
+                                 + impl->get(CLI::ArgCompressThreads).to_cstr()};
+    }
+    params.threads = threads;
+    return params;
+}
+
+const Parameters::SelectionParams Parameters::selection_params() const
+{
+    Parameters::SelectionParams params;
+    if(!impl->is_default(CLI::ArgStart))
+    {
+        params.start = parse_time(impl->get(CLI::ArgStart));
+    }
+    if(!impl->is_default(CLI::ArgEnd))
+    {
+        params.end = parse_time(impl->get(CLI::ArgEnd));
+    }
+    if(params.end <= params.start)
+    {
+        throw cmdline::CLIError{std::string{"The end of time range must be after its start"}};
+    }
+    if(!impl->is_default(CLI::ArgFlow))
+    {
+        params.flow_text = impl->get(CLI::ArgFlow);
+        params.has_flow  = true;
+        if(!parse_flow(params.flow_text, params.flow))
+        {
+            throw cmdline::CLIError{std::string{"Invalid flow: "} + params.flow_text};
+        }
+    }
+    if(params.enabled() && input_file() == "-")
+    {
+        throw cmdline::CLIError{std::string{"Input file \"-\" means stdin, the start, end and flow can't be used"}};
+    }
     return params;
 }
 
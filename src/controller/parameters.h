@@ -27,6 +27,7 @@
 
 #include "filtration/dumping.h"
 #include "filtration/pcap/capture_reader.h"
+#include "filtration/pcap/selective_reader.h"
 //------------------------------------------------------------------------------
 namespace NST
 {
@@ -60,8 +61,9 @@ enum class NetProtocol
 
 class Parameters
 {
-    using CaptureParams = filtration::pcap::CaptureReader::Params;
-    using DumpingParams = filtration::Dumping::Params;
+    using CaptureParams   = filtration::pcap::CaptureReader::Params;
+    using DumpingParams   = filtration::Dumping::Params;
+    using SelectionParams = filtration::pcap::SelectiveReader::Params;
 
 public:
     // initialize global instance
@@ -82,9 +84,12 @@ public:
     const std::string   log_path() const;
     unsigned short      queue_capacity() const;
     bool                trace() const;
+    bool                probes() const;
+    bool                dns_lookups() const;
     int                 verbose_level() const;
     const CaptureParams capture_params() const;
     const DumpingParams dumping_params() const;
+    const SelectionParams selection_params() const; // of input file
     const std::vector<AParams>& analysis_modules() const;
     static unsigned short rpcmsg_limit();
 };
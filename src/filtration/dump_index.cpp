@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Sidecar index of dumped .pcap files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>   // std::swap()
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/stat.h>
+
+#include "filtration/dump_index.h"
+#include "filtration/packet.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace filtration
+{
+namespace // unnamed
+{
+
+struct FileCloser
+{
+    void operator()(FILE* file) const { fclose(file); }
+};
+
+} // unnamed namespace
+
+const uint32_t DumpIndex::Magic;
+const uint16_t DumpIndex::Version;
+const uint32_t DumpIndex::MaxFlows;
+
+bool DumpIndex::Key::operator==(const Key& other) const
+{
+    return memcmp(this, &other, sizeof(Key)) == 0;
+}
+
+std::size_t DumpIndex::KeyHash::operator()(const Key& key) const
+{
+    // FNV-1a
+    const uint8_t* byte {reinterpret_cast<const uint8_t*>(&key)};
+    uint64_t hash {14695981039346656037ULL};
+    for(std::size_t i = 0; i < sizeof(Key); ++i)
+    {
+        hash = (hash ^ byte[i]) * 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+DumpIndex::DumpIndex(uint32_t interval, int linktype, bool gzip_members)
+: head   {Magic, Version, static_cast<uint16_t>(gzip_members ? GzipMembers : 0),
+          interval, static_cast<uint32_t>(linktype), 0, 0}
+, records{0}
+{
+}
+
+void DumpIndex::add(const pcap_pkthdr* header, const uint8_t* packet, uint64_t offset, uint32_t skip)
+{
+    const uint32_t sec  {static_cast<uint32_t>(header->ts.tv_sec)};
+    const uint32_t usec {static_cast<uint32_t>(header->ts.tv_usec)};
+    if(records % head.interval == 0)
+    {
+        time_entries.push_back(Time{sec, usec, offset, skip, static_cast<uint32_t>(records)});
+    }
+    ++records;
+
+    Key k;
+    if(!key(header, packet, static_cast<int>(head.linktype), k))
+    {
+        return;
+    }
+    const auto i = flow_ids.find(k);
+    if(i != flow_ids.end())
+    {
+        Flow& flow {flow_entries[i->second]};
+        flow.last_sec    = sec;
+        flow.last_offset = offset;
+        flow.last_skip   = skip;
+        ++flow.packets;
+    }
+    else if(flow_entries.size() < MaxFlows)
+    {
+        flow_ids.emplace(k, flow_entries.size());
+        flow_entries.push_back(Flow{k, sec, sec, offset, offset, skip, skip, 1});
+    }
+    else
+    {
+        head.flags |= FlowsTruncated;
+    }
+}
+
+void DumpIndex::write(const std::string& part)
+{
+    head.times = time_entries.size();
+    head.flows = flow_entries.size();
+    try
+    {
+        save(path(part));
+    }
+    catch(...)
+    {
+        clear(); // entries of the part mustn't get into the next one
+        throw;
+    }
+    clear();
+}
+
+void DumpIndex::save(const std::string& name) const
+{
+    std::unique_ptr<FILE, FileCloser> file {fopen(name.c_str(), "wb")};
+    if(!file)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in opening file: " + name}};
+    }
+    const bool written {fwrite(&head, sizeof(head), 1, file.get()) == 1 &&
+                        fwrite(time_entries.data(), sizeof(Time), time_entries.size(), file.get()) == time_entries.size() &&
+                        fwrite(flow_entries.data(), sizeof(Flow), flow_entries.size(), file.get()) == flow_entries.size() &&
+                        fflush(file.get()) == 0};
+    if(!written)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in writing file: " + name}};
+    }
+}
+
+void DumpIndex::clear()
+{
+    head.flags &= ~FlowsTruncated;
+    records = 0;
+    time_entries.clear();
+    flow_entries.clear();
+    flow_ids.clear();
+}
+
+bool DumpIndex::read(const std::string& part)
+{
+    std::unique_ptr<FILE, FileCloser> file {fopen(path(part).c_str(), "rb")};
+    if(!file)
+    {
+        return false;
+    }
+    Header h;
+    if(fread(&h, sizeof(h), 1, file.get()) != 1 || h.magic != Magic || h.version != Version)
+    {
+        return false;
+    }
+    // sizes of arrays are checked before allocation, a damaged header may be huge
+    struct stat st;
+    if(fstat(fileno(file.get()), &st) != 0 || st.st_size < static_cast<off_t>(sizeof(h)))
+    {
+        return false;
+    }
+    const uint64_t rest {static_cast<uint64_t>(st.st_size) - sizeof(h)};
+    if(h.times > rest / sizeof(Time) || h.flows != (rest - h.times * sizeof(Time)) / sizeof(Flow) ||
+       (rest - h.times * sizeof(Time)) % sizeof(Flow) != 0)
+    {
+        return false; // truncated or damaged index
+    }
+    std::vector<Time> t(h.times);
+    std::vector<Flow> f(h.flows);
+    if(fread(t.data(), sizeof(Time), t.size(), file.get()) != t.size() ||
+       fread(f.data(), sizeof(Flow), f.size(), file.get()) != f.size())
+    {
+        return false; // truncated index
+    }
+    head = h;
+    records = 0;
+    time_entries.swap(t);
+    flow_entries.swap(f);
+    flow_ids.clear();
+    return true;
+}
+
+bool DumpIndex::key(const pcap_pkthdr* header, const uint8_t* packet, int linktype, Key& key)
+{
+    const PacketInfo info {header, packet, static_cast<uint32_t>(linktype)};
+    if(!info.tcp && !info.udp)
+    {
+        return false;
+    }
+    memset(&key, 0, sizeof(key));
+    if(info.ipv4)
+    {
+        const in_addr_t src {info.ipv4->src()};
+        const in_addr_t dst {info.ipv4->dst()};
+        memcpy(key.address[0], &src, sizeof(src));
+        memcpy(key.address[1], &dst, sizeof(dst));
+        key.family = 4;
+    }
+    else if(info.ipv6)
+    {
+        memcpy(key.address[0], &info.ipv6->src(), 16);
+        memcpy(key.address[1], &info.ipv6->dst(), 16);
+        key.family = 6;
+    }
+    else
+    {
+        return false;
+    }
+    if(info.tcp)
+    {
+        key.port[0]  = ntohs(info.tcp->sport());
+        key.port[1]  = ntohs(info.tcp->dport());
+        key.protocol = IPPROTO_TCP;
+    }
+    else
+    {
+        key.port[0]  = ntohs(info.udp->sport());
+        key.port[1]  = ntohs(info.udp->dport());
+        key.protocol = IPPROTO_UDP;
+    }
+
+    const int order {memcmp(key.address[0], key.address[1], sizeof(key.address[0]))};
+    if(order > 0 || (order == 0 && key.port[0] > key.port[1]))
+    {
+        uint8_t address[16];
+        memcpy(address, key.address[0], sizeof(address));
+        memcpy(key.address[0], key.address[1], sizeof(address));
+        memcpy(key.address[1], address, sizeof(address));
+        std::swap(key.port[0], key.port[1]);
+    }
+    return true;
+}
+
+} // namespace filtration
+} // namespace NST
+//------------------------------------------------------------------------------
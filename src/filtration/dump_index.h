@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Sidecar index of dumped .pcap files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef DUMP_INDEX_H
+#define DUMP_INDEX_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pcap/pcap.h>
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace filtration
+{
+
+/*! Index of a part of dump, written alongside the part to <part>.idx.
+ *  It keeps position of each N-th record with its timestamp, so a reader
+ *  can seek to a time range, and first/last positions of each flow, so a
+ *  reader can skip parts and regions without packets of a flow.
+ *
+ *  A position is an offset in the file where decoding can be started and
+ *  amount of bytes to skip after it: for plain .pcap files the offset
+ *  points to the record and skip is 0, for compressed parts the offset
+ *  points to the independent gzip member and skip is the offset of the
+ *  record in the uncompressed member.
+ *
+ *  The file has a Header followed by arrays of Time and Flow entries in
+ *  host byte order, like .pcap files written by libpcap.
+ */
+class DumpIndex
+{
+public:
+    static const uint32_t Magic   {0x4954534e}; // "NSTI" on little-endian hosts
+    static const uint16_t Version {1};
+    static const uint32_t MaxFlows {1 << 20};   // flows of a part to keep
+
+    enum Flags : uint16_t
+    {
+        GzipMembers    = 1 << 0,    // positions point to gzip members
+        FlowsTruncated = 1 << 1,    // not all flows of the part are indexed
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t flags;
+        uint32_t interval;          // records between Time entries
+        uint32_t linktype;
+        uint64_t times;
+        uint64_t flows;
+    };
+
+    struct Time
+    {
+        uint32_t sec;
+        uint32_t usec;
+        uint64_t offset;
+        uint32_t skip;
+        uint32_t record;            // number of the record in the part
+    };
+
+    //! Canonical 5-tuple: lower endpoint goes first, so both directions match
+    struct Key
+    {
+        uint8_t  address[2][16];    // IPv4 address takes first 4 bytes
+        uint16_t port[2];           // in host byte order
+        uint8_t  protocol;          // IPPROTO_TCP or IPPROTO_UDP
+        uint8_t  family;            // 4 or 6
+        uint8_t  reserved[2];
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Flow
+    {
+        Key      key;
+        uint32_t first_sec;
+        uint32_t last_sec;
+        uint64_t first_offset;
+        uint64_t last_offset;
+        uint32_t first_skip;
+        uint32_t last_skip;
+        uint64_t packets;
+    };
+
+    DumpIndex() : DumpIndex{1, DLT_EN10MB, false} {}   // to read indexes
+    DumpIndex(uint32_t interval, int linktype, bool gzip_members);
+
+    //! Accounts record placed at the position
+    void add(const pcap_pkthdr* header, const uint8_t* packet, uint64_t offset, uint32_t skip);
+    //! Writes index of the part and clears it for the next one, even on error
+    void write(const std::string& part);
+
+    //! Reads index of the part, returns false if there is no index
+    bool read(const std::string& part);
+
+    //! Extracts flow of the packet, returns false for non TCP/UDP packets
+    static bool key(const pcap_pkthdr* header, const uint8_t* packet, int linktype, Key& key);
+    static inline std::string path(const std::string& part) { return part + ".idx"; }
+
+    inline const Header&             header() const { return head;  }
+    inline const std::vector<Time>&  times()  const { return time_entries; }
+    inline const std::vector<Flow>&  flows()  const { return flow_entries; }
+
+private:
+    void save(const std::string& name) const;
+    void clear();
+
+    Header head;
+    uint64_t records;
+    std::vector<Time> time_entries;
+    std::vector<Flow> flow_entries;
+    std::unordered_map<Key, std::size_t, KeyHash> flow_ids;
+};
+
+static_assert(sizeof(DumpIndex::Header) == 32 && sizeof(DumpIndex::Time) == 24 &&
+              sizeof(DumpIndex::Key) == 40 && sizeof(DumpIndex::Flow) == 80, "Entries of dump index");
+
+} // namespace filtration
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//DUMP_INDEX_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,867 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Writer thread of dump mode with coalesced aligned writes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>     // rename()
+#include <cstdlib>
+#include <cstring>
+#include <exception>    // std::terminate()
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "filtration/dump_writer.h"
+#include "utils/log.h"
+#include "utils/metrics.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace filtration
+{
+namespace // unnamed
+{
+
+// .pcap file format, see pcap-savefile(5)
+struct FileHeader
+{
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t  thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+struct RecordHeader
+{
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t caplen;
+    uint32_t len;
+};
+
+static_assert(sizeof(FileHeader) == 24 && sizeof(RecordHeader) == 16, "Headers of .pcap file format");
+
+const std::chrono::milliseconds WakeupPeriod {100};
+const char NextSuffix[] {".next"};  // of a pre-opened part until it is used
+
+uint64_t coarse_second()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return static_cast<uint64_t>(now.tv_sec);
+}
+
+uint8_t* allocate_aligned(std::size_t size)
+{
+    void* memory {nullptr};
+    if(posix_memalign(&memory, DumpWriter::Alignment, size) != 0)
+    {
+        throw std::bad_alloc{};
+    }
+    return static_cast<uint8_t*>(memory);
+}
+
+} // unnamed namespace
+
+// Output file, written with O_DIRECT if the file system supports it
+class DumpWriter::File
+{
+public:
+    // an exclusive file must not exist, an existing one is truncated otherwise
+    explicit File(const std::string& file_path, bool exclusive = false)
+    : path   {file_path}
+    , fd     {STDOUT_FILENO}
+    , owned  {false}
+    , direct {false}
+    {
+        if(path == "-")
+        {
+            return;
+        }
+        const int flags {O_WRONLY | O_CREAT | (exclusive ? O_EXCL : O_TRUNC)};
+#ifdef O_DIRECT
+        fd = open(path.c_str(), flags | O_DIRECT, 0666);
+        direct = fd >= 0;
+        if(fd < 0 && errno == EINVAL) // O_DIRECT isn't supported
+#endif
+        {
+            fd = open(path.c_str(), flags, 0666);
+        }
+        if(fd < 0)
+        {
+            throw std::system_error{errno, std::system_category(),
+                                    {"Error in opening file: " + path}};
+        }
+        owned = true;
+    }
+    ~File()
+    {
+        if(owned)
+        {
+            ::close(fd);
+        }
+    }
+    File(const File&)            = delete;
+    File& operator=(const File&) = delete;
+
+    inline bool is_direct() const { return direct; }
+
+    //! Writes whole buffer, size and offset must be aligned for O_DIRECT
+    void write(const uint8_t* data, std::size_t size)
+    {
+        while(size)
+        {
+            const ssize_t n {::write(fd, data, size)};
+            if(n < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                if(errno == EINVAL && direct) // alignment isn't accepted
+                {
+                    buffered();
+                    continue;
+                }
+                throw std::system_error{errno, std::system_category(),
+                                        {"Error in writing file: " + path}};
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+    }
+
+    //! Gives the file its name, a file with this name is replaced
+    void rename(const std::string& name)
+    {
+        if(::rename(path.c_str(), name.c_str()) != 0)
+        {
+            throw std::system_error{errno, std::system_category(),
+                                    {"Error in renaming file: " + path + " to " + name}};
+        }
+        path = name;
+    }
+
+    //! Writes the unaligned rest of the file
+    void write_tail(const uint8_t* data, std::size_t size)
+    {
+        if(direct)
+        {
+            buffered();
+        }
+        write(data, size);
+    }
+
+    std::string path;
+
+private:
+    void buffered()
+    {
+#ifdef O_DIRECT
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+#endif
+        direct = false;
+    }
+
+    int  fd;
+    bool owned;
+    bool direct;
+};
+
+// Compressor of blocks to independent gzip members, one per thread
+class DumpWriter::Gzip
+{
+public:
+    explicit Gzip(int level)
+    {
+        memset(&stream, 0, sizeof(stream));
+        // 16 is added to window bits to write gzip header and trailer
+        if(deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw std::runtime_error{"Error in initialization of gzip compression"};
+        }
+    }
+    ~Gzip()
+    {
+        deflateEnd(&stream);
+    }
+    Gzip(const Gzip&)            = delete;
+    Gzip& operator=(const Gzip&) = delete;
+
+    //! Returns size of the gzip member, out must have bound(size) bytes
+    uint32_t pack(const uint8_t* data, uint32_t size, uint8_t* out)
+    {
+        deflateReset(&stream);
+        stream.next_in   = const_cast<Bytef*>(data);
+        stream.avail_in  = size;
+        stream.next_out  = out;
+        stream.avail_out = bound(size);
+        if(deflate(&stream, Z_FINISH) != Z_STREAM_END)
+        {
+            throw std::runtime_error{"Error in gzip compression"};
+        }
+        return bound(size) - stream.avail_out;
+    }
+
+    // gzip header and trailer are 12 bytes longer than zlib ones
+    static inline uint32_t bound(uint32_t size) { return compressBound(size) + 32; }
+
+private:
+    z_stream stream;
+};
+
+DumpWriter::DumpWriter(const Params& p)
+: params        (p)
+, current       {nullptr}
+, current_since {0}
+, part          {0}
+, part_size     {0}
+, part_packets  {0}
+, part_period   {0}
+, drops         {0}
+, published     {0}
+, written       {0}
+, claimed       {0}
+, file          {nullptr}
+, next          {nullptr}
+, file_part     {0}
+, file_period   {0}
+, file_sequence {0}
+, file_size     {0}
+, staging       {nullptr}
+, staged        {0}
+, stop          {false}
+, failed        {false}
+{
+    const bool compressed {params.compression != Compression::None};
+    for(auto& b : blocks)
+    {
+        b.data   = nullptr;
+        b.packed = nullptr;
+        b.ready  = false;
+    }
+    try
+    {
+        for(auto& b : blocks)
+        {
+            b.data = allocate_aligned(BlockSize);
+            b.used = 0;
+            b.part = 0;
+            b.period = 0;
+            b.packed_size = 0;
+            if(compressed)
+            {
+                b.packed = allocate_aligned(Gzip::bound(BlockSize));
+            }
+        }
+        staging = allocate_aligned((compressed ? Gzip::bound(BlockSize) : BlockSize) + Alignment);
+
+        if(params.index && params.path != "-")
+        {
+            index.reset(new DumpIndex{params.index, params.linktype, compressed});
+        }
+        // the first part is opened here to report errors at once,
+        // name of a time-rotated part is known from the first packet only
+        if(params.interval == 0)
+        {
+            file = new File{part_name(0, 0)};
+            LOG("Dumping packets to file:%s", file->path.c_str());
+            stage_header();
+            open_next();
+        }
+    }
+    catch(...)
+    {
+        delete file;
+        delete next;
+        free(staging);
+        for(auto& b : blocks)
+        {
+            free(b.data);
+            free(b.packed);
+        }
+        throw;
+    }
+    writer = std::thread{&DumpWriter::run, this};
+    if(compressed)
+    {
+        const uint32_t threads {params.threads ? params.threads
+                                               : std::max(1U, std::thread::hardware_concurrency() / 2)};
+        for(uint32_t i = 0; i < threads; ++i)
+        {
+            compressors.emplace_back(&DumpWriter::compress, this);
+        }
+    }
+}
+
+DumpWriter::~DumpWriter()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> guard{lock};
+        stop = true;
+    }
+    pending.notify_all();
+    wakeup.notify_one();
+    for(auto& compressor : compressors)
+    {
+        compressor.join();
+    }
+    writer.join();
+
+    free(staging);
+    for(auto& b : blocks)
+    {
+        free(b.data);
+        free(b.packed);
+    }
+}
+
+bool DumpWriter::push(const pcap_pkthdr* header, const u_char* packet)
+{
+    if(failed.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> guard{lock};
+        std::rethrow_exception(error);
+    }
+
+    const uint32_t record {static_cast<uint32_t>(sizeof(RecordHeader)) + header->caplen};
+    if(record > BlockSize)
+    {
+        ++drops;
+        utils::Metrics::add(utils::Metrics::DumpDropped, 1);
+        return false;
+    }
+
+    // compressed parts are rotated by size in the writer
+    bool rotate {(params.size_limit && params.compression == Compression::None &&
+                  part_size && part_size + record > params.size_limit) ||
+                 (params.packet_limit && part_packets >= params.packet_limit)};
+    uint64_t period {part_period};
+    if(params.interval)
+    {
+        const uint64_t second {static_cast<uint64_t>(header->ts.tv_sec)};
+        const uint64_t aligned {second - second % params.interval};
+        if(part_packets == 0 && part == 0)
+        {
+            period = aligned; // the first packet
+        }
+        else if(aligned > part_period) // time going back doesn't rewrite parts
+        {
+            rotate = true;
+            period = aligned;
+        }
+    }
+    if(current && (rotate || current->used + record > BlockSize))
+    {
+        publish();
+    }
+    if(current == nullptr)
+    {
+        if((current = acquire()) == nullptr)
+        {
+            ++drops;
+            utils::Metrics::add(utils::Metrics::DumpDropped, 1);
+            return false;
+        }
+        if(rotate)
+        {
+            ++part;
+            part_size = 0;
+            part_packets = 0;
+        }
+        part_period = period;
+        current->part = part;
+        current->period = period;
+        current_since = coarse_second();
+    }
+
+    const RecordHeader h {static_cast<uint32_t>(header->ts.tv_sec),
+                          static_cast<uint32_t>(header->ts.tv_usec),
+                          header->caplen,
+                          header->len};
+    uint8_t* data {current->data + current->used};
+    memcpy(data, &h, sizeof(h));
+    memcpy(data + sizeof(h), packet, header->caplen);
+    current->used += record;
+    part_size += record;
+    ++part_packets;
+
+    // a block of slow traffic is passed by the first packet of a later
+    // second, the writer doesn't take blocks which are being filled
+    if(current_since != coarse_second())
+    {
+        publish();
+    }
+    return true;
+}
+
+void DumpWriter::flush()
+{
+    publish();
+}
+
+DumpWriter::Block* DumpWriter::acquire()
+{
+    const uint64_t p {published.load(std::memory_order_relaxed)};
+    if(p - written.load(std::memory_order_acquire) == Blocks)
+    {
+        return nullptr; // the writer is behind
+    }
+    Block* block {&blocks[p % Blocks]};
+    block->used = 0;
+    return block;
+}
+
+void DumpWriter::publish()
+{
+    if(current == nullptr)
+    {
+        return;
+    }
+    current = nullptr;
+    published.store(published.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    if(params.compression == Compression::None)
+    {
+        wakeup.notify_one();
+    }
+    else
+    {
+        pending.notify_one();
+    }
+}
+
+void DumpWriter::run()
+{
+    std::unique_lock<std::mutex> guard{lock};
+    for(;;)
+    {
+        wakeup.wait_for(guard, WakeupPeriod, [this]
+        {
+            return available() || (stop && written.load(std::memory_order_relaxed) == published.load(std::memory_order_acquire));
+        });
+        if(!available())
+        {
+            if(stop && written.load(std::memory_order_relaxed) == published.load(std::memory_order_acquire))
+            {
+                break;
+            }
+            continue;
+        }
+        guard.unlock();
+
+        while(available())
+        {
+            const uint64_t w {written.load(std::memory_order_relaxed)};
+            Block& block {blocks[w % Blocks]};
+            if(!failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    write_block(block);
+                }
+                catch(...)
+                {
+                    LOG("Dumping is stopped: error in writing");
+                    fail();
+                }
+            }
+            block.ready.store(false, std::memory_order_relaxed);
+            written.store(w + 1, std::memory_order_release);
+        }
+
+        guard.lock();
+    }
+    guard.unlock();
+
+    if(next)
+    {
+        unlink(next->path.c_str()); // part wasn't used, its name is temporary
+        delete next;
+        next = nullptr;
+    }
+    // close the last part, it may be not opened if there were no packets
+    if(file)
+    {
+        try
+        {
+            if(failed.load(std::memory_order_relaxed))
+            {
+                staged = 0;
+            }
+            close_part();
+        }
+        catch(const std::exception& e)
+        {
+            LOG("Dumping is stopped: %s", e.what());
+            delete file;
+            file = nullptr;
+        }
+    }
+}
+
+void DumpWriter::compress()
+{
+    std::unique_ptr<Gzip> gzip;
+    try
+    {
+        gzip.reset(new Gzip{params.level});
+    }
+    catch(...)
+    {
+        LOG("Dumping is stopped: error in compression");
+        fail();
+    }
+
+    std::unique_lock<std::mutex> guard{lock};
+    for(;;)
+    {
+        pending.wait_for(guard, WakeupPeriod, [this]
+        {
+            return stop || claimed != published.load(std::memory_order_acquire);
+        });
+        if(claimed == published.load(std::memory_order_acquire))
+        {
+            if(stop)
+            {
+                break;
+            }
+            continue;
+        }
+        Block& block {blocks[claimed++ % Blocks]};
+        guard.unlock();
+
+        block.packed_size = 0;
+        if(!failed.load(std::memory_order_relaxed))
+        {
+            try
+            {
+                block.packed_size = gzip->pack(block.data, block.used, block.packed);
+            }
+            catch(...)
+            {
+                LOG("Dumping is stopped: error in compression");
+                fail();
+            }
+        }
+        block.ready.store(true, std::memory_order_release);
+
+        guard.lock();
+        wakeup.notify_one();
+    }
+}
+
+bool DumpWriter::available() const
+{
+    const uint64_t w {written.load(std::memory_order_relaxed)};
+    if(w == published.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    // blocks are written in order, so the writer waits for compression of the oldest one
+    return params.compression == Compression::None || blocks[w % Blocks].ready.load(std::memory_order_acquire);
+}
+
+void DumpWriter::write_block(const Block& block)
+{
+    if(file == nullptr || block.part != file_part)
+    {
+        switch_to(block.part, block.period);
+    }
+    if(params.compression == Compression::None)
+    {
+        index_block(block, file_size);
+        write_data(block.data, block.used);
+        return;
+    }
+    if(params.size_limit && file_size && file_size + block.packed_size > params.size_limit)
+    {
+        switch_to(file_part, file_period);
+    }
+    index_block(block, file_size);
+    write_data(block.packed, block.packed_size);
+}
+
+void DumpWriter::write_data(const uint8_t* data, uint32_t size)
+{
+    file_size += size;
+    if(!file->is_direct())
+    {
+        if(staged) // header of the first part
+        {
+            file->write(staging, staged);
+            staged = 0;
+        }
+        file->write(data, size);
+        return;
+    }
+    memcpy(staging + staged, data, size);
+    staged += size;
+    const uint32_t aligned {staged & ~(Alignment - 1)};
+    if(aligned)
+    {
+        file->write(staging, aligned);
+        memmove(staging, staging + aligned, staged - aligned);
+        staged -= aligned;
+    }
+}
+
+void DumpWriter::index_block(const Block& block, uint64_t offset)
+{
+    if(!index)
+    {
+        return;
+    }
+    const bool members {params.compression != Compression::None};
+    for(uint32_t at = 0; at < block.used;)
+    {
+        RecordHeader h;
+        memcpy(&h, block.data + at, sizeof(h));
+        pcap_pkthdr header;
+        header.ts.tv_sec  = h.ts_sec;
+        header.ts.tv_usec = h.ts_usec;
+        header.caplen     = h.caplen;
+        header.len        = h.len;
+        const uint8_t* packet {block.data + at + sizeof(h)};
+        if(members)
+        {
+            index->add(&header, packet, offset, at);
+        }
+        else
+        {
+            index->add(&header, packet, offset + at, 0);
+        }
+        at += sizeof(h) + h.caplen;
+    }
+}
+
+// .pcap header starts the first part and each standalone part
+void DumpWriter::stage_header()
+{
+    const FileHeader header {0xa1b2c3d4, 2, 4, 0, 0,
+                             static_cast<uint32_t>(params.snaplen),
+                             static_cast<uint32_t>(params.linktype)};
+    if(params.compression != Compression::None)
+    {
+        Gzip gzip{params.level};
+        staged = gzip.pack(reinterpret_cast<const uint8_t*>(&header), sizeof(header), staging);
+    }
+    else
+    {
+        memcpy(staging, &header, sizeof(header));
+        staged = sizeof(header);
+    }
+    file_size = staged;
+}
+
+void DumpWriter::switch_to(uint32_t new_part, uint64_t period)
+{
+    const bool first {file == nullptr};
+    if(file)
+    {
+        close_part();
+    }
+    file_sequence = (!first && period == file_period) ? file_sequence + 1 : 0;
+    file_part     = new_part;
+    file_period   = period;
+
+    const std::string name {part_name(file_period, file_sequence)};
+    if(next && next->path == name + NextSuffix)
+    {
+        file = next;
+        next = nullptr;
+        file->rename(name);
+    }
+    else
+    {
+        if(next) // the guess was wrong
+        {
+            unlink(next->path.c_str());
+            delete next;
+            next = nullptr;
+        }
+        file = new File{name};
+    }
+    file_size = 0;
+    if(first || params.interval || params.packet_limit)
+    {
+        stage_header();
+    }
+    LOG("Dumping packets to file:%s", file->path.c_str());
+    open_next();
+}
+
+void DumpWriter::close_part()
+{
+    file->write_tail(staging, staged);
+    staged = 0;
+    const std::string name {file->path};
+    delete file;
+    file = nullptr;
+    if(index)
+    {
+        try
+        {
+            index->write(name);
+        }
+        catch(const std::exception& e)
+        {
+            LOG("Index of %s isn't written: %s", name.c_str(), e.what());
+        }
+    }
+    exec_command(name);
+}
+
+// the next part is guessed and opened in advance with a temporary name,
+// so an existing file isn't touched until the part is used
+void DumpWriter::open_next()
+{
+    if(next)
+    {
+        return;
+    }
+    std::string name;
+    if(params.size_limit || params.packet_limit)
+    {
+        name = part_name(file_period, file_sequence + 1);
+    }
+    else if(params.interval)
+    {
+        name = part_name(file_period + params.interval, 0);
+    }
+    else
+    {
+        return;
+    }
+    try
+    {
+        next = new File{name + NextSuffix, true};
+    }
+    catch(const std::system_error& e)
+    {
+        // the part is opened when it is needed
+        LOG("Next part isn't opened in advance: %s", e.what());
+    }
+}
+
+void DumpWriter::fail()
+{
+    std::lock_guard<std::mutex> guard{lock};
+    if(!failed.load(std::memory_order_relaxed))
+    {
+        error = std::current_exception();
+        failed.store(true, std::memory_order_release);
+    }
+}
+
+std::string DumpWriter::part_name(uint64_t period, uint32_t sequence) const
+{
+    std::string name;
+    if(params.interval == 0)
+    {
+        name = sequence ? params.path + '-' + std::to_string(sequence) : params.path;
+    }
+    else
+    {
+        // UTC start of the interval is inserted before extension: dump-20151019-153000.pcap
+        const time_t start {static_cast<time_t>(period)};
+        struct tm utc;
+        gmtime_r(&start, &utc);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "-%Y%m%d-%H%M%S", &utc);
+
+        const std::size_t slash {params.path.rfind('/')};
+        const std::size_t dot   {params.path.rfind('.')};
+        const std::size_t ext   {(dot != std::string::npos && (slash == std::string::npos || dot > slash + 1))
+                                 ? dot : params.path.size()};
+        name = params.path.substr(0, ext) + stamp;
+        if(sequence)
+        {
+            name += '-' + std::to_string(sequence);
+        }
+        name += params.path.substr(ext);
+    }
+    if(params.compression == Compression::Gzip && params.path != "-")
+    {
+        name += ".gz";
+    }
+    return name;
+}
+
+void DumpWriter::exec_command(const std::string& name) const
+{
+    if(params.command.empty()) return;
+
+    NST::utils::Log::flush();   // flush buffer
+
+    if(pid_t pid = fork()) // spawn child process
+    {
+        // parent process
+        LOG("Try to execute(%s %s) in %u child process", params.command.c_str(), name.c_str(), pid);
+        NST::utils::Log::flush();   // flush buffer
+        return;
+    }
+    else
+    {
+        // child process
+        std::istringstream ss(params.command);
+        std::vector<std::string> tokens;
+        std::vector<char*> args;
+
+        // TODO: this parser doesn't work with dual quotes, like rm "a file.cpp"
+        for(std::string arg; ss >> arg;)
+        {
+           tokens.emplace_back(arg);
+        }
+        // pointers are taken when tokens are not reallocated anymore
+        for(auto& token : tokens)
+        {
+           args.emplace_back(const_cast<char*>(token.c_str()));
+        }
+        args.push_back(const_cast<char*>(name.c_str()));
+        args.push_back(nullptr);  // need termination null pointer
+
+        if(execvp(args[0], &args[0]) == -1)
+        {
+            LOG("execvp(%s,%s %s) return: %s", args[0], params.command.c_str(), name.c_str(), strerror(errno));
+        }
+
+        LOG("child process %u will be terminated.", getpid());
+        std::terminate();
+    }
+}
+
+} // namespace filtration
+} // namespace NST
+//------------------------------------------------------------------------------
@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Writer thread of dump mode with coalesced aligned writes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef DUMP_WRITER_H
+#define DUMP_WRITER_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pcap/pcap.h>
+
+#include "filtration/dump_index.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace filtration
+{
+
+/*! Writes captured packets to .pcap files in a background thread.
+ *  The capture thread copies packets as .pcap records to blocks of a
+ *  single producer - single consumer ring and never waits for the disk:
+ *  if all blocks are busy the packet is dropped and counted. The writer
+ *  thread coalesces blocks to large aligned writes, with O_DIRECT where
+ *  the file system supports it. Parts of a rotated dump are opened in
+ *  advance, closing of a part and the rotation command are run by the
+ *  writer thread too. As before, only the first part has a .pcap header.
+ *
+ *  With compression each block is compressed to an independent gzip member
+ *  by a pool of worker threads and the writer puts members to the file in
+ *  order of blocks, so 'zcat' of a part gives the .pcap stream. Parts are
+ *  rotated by compressed size then.
+ *
+ *  Parts rotated by time or amount of packets are standalone captures with
+ *  their own .pcap header. Time-rotated parts start at multiples of the
+ *  interval and are named by its UTC start time. The writer thread keeps
+ *  index of each part and writes it to <part>.idx when the part is closed.
+ */
+class DumpWriter
+{
+public:
+    static const uint32_t BlockSize {1024 * 1024};
+    static const uint32_t Blocks    {32};
+    static const uint32_t Alignment {4096};   // of O_DIRECT buffers and offsets
+
+    enum class Compression
+    {
+        None,
+        Gzip
+    };
+
+    struct Params
+    {
+        std::string path;           // '-' means stdout
+        std::string command;        // executed for each closed part
+        uint32_t    size_limit;     // bytes of a part, 0 means no limit
+        uint32_t    interval;       // seconds of a part, 0 means no limit
+        uint32_t    packet_limit;   // packets of a part, 0 means no limit
+        uint32_t    index;          // packets between index entries, 0 means no index
+        int         linktype;
+        int         snaplen;
+        Compression compression;
+        int         level;          // of compression, 1..9
+        uint32_t    threads;        // of compression, 0 means a half of CPUs
+    };
+
+    explicit DumpWriter(const Params& params);
+    ~DumpWriter();
+    DumpWriter(const DumpWriter&)            = delete;
+    DumpWriter& operator=(const DumpWriter&) = delete;
+
+    //! Copies packet to the ring, returns false if it is dropped
+    bool push(const pcap_pkthdr* header, const u_char* packet);
+
+    //! Passes filled part of the current block to the writer
+    void flush();
+
+    inline uint64_t dropped() const { return drops; }
+
+private:
+    struct Block
+    {
+        uint8_t* data;
+        uint32_t used;
+        uint32_t part;
+        uint64_t period;            // start of the time interval of the part
+        uint8_t* packed;            // compressed data
+        uint32_t packed_size;
+        std::atomic<bool> ready;    // is compressed
+    };
+
+    class File;
+    class Gzip;
+
+    Block* acquire();
+    void publish();
+    void run();
+    void compress();
+    bool available() const;
+    void write_block(const Block& block);
+    void write_data(const uint8_t* data, uint32_t size);
+    void index_block(const Block& block, uint64_t offset);
+    void fail();
+    void stage_header();
+    void switch_to(uint32_t part, uint64_t period);
+    void close_part();
+    void open_next();
+    std::string part_name(uint64_t period, uint32_t sequence) const;
+    void exec_command(const std::string& name) const;
+
+    const Params params;
+
+    // producer side, owned by the capture thread
+    Block*   current;
+    uint64_t current_since;     // coarse second when current block was taken
+    uint32_t part;
+    uint64_t part_size;
+    uint32_t part_packets;
+    uint64_t part_period;
+    uint64_t drops;
+
+    Block blocks[Blocks];
+    std::atomic<uint64_t> published;   // blocks passed to the writer
+    std::atomic<uint64_t> written;     // blocks returned to the capture thread
+    uint64_t              claimed;     // blocks taken by compressors, guarded by lock
+
+    // writer side
+    File*    file;
+    File*    next;              // pre-opened file of the next part
+    uint32_t file_part;
+    uint64_t file_period;
+    uint32_t file_sequence;     // of parts in the period
+    uint64_t file_size;
+    std::unique_ptr<DumpIndex> index;
+    uint8_t* staging;           // aligned buffer of the current write
+    uint32_t staged;
+
+    std::mutex              lock;
+    std::condition_variable wakeup;     // of the writer
+    std::condition_variable pending;    // of compressors
+    bool                    stop;
+    std::exception_ptr      error; // of the writer, rethrown by push()
+    std::atomic<bool>       failed;
+    std::thread             writer;
+    std::vector<std::thread> compressors;
+};
+
+} // namespace filtration
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//DUMP_WRITER_H
+//------------------------------------------------------------------------------
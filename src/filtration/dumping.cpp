@@ -19,12 +19,6 @@
     along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
 */
 //------------------------------------------------------------------------------
-#include <cerrno>
-#include <exception>    // std::terminate()
-#include <vector>
-
-#include <unistd.h>
-
 #include "filtration/dumping.h"
 //------------------------------------------------------------------------------
 namespace NST
@@ -33,70 +27,30 @@ namespace filtration
 {
 
 Dumping::Dumping(pcap_t*const h, const Params& params)
-    : handle  {h}
-    , base    {params.output_file}
-    , name    {params.output_file}
-    , command {params.command}
-    , limit   {params.size_limit}
-    , part    {0}
-    , size    {0}
-{
-    open_dumping_file(name);
-}
-Dumping::~Dumping()
+    : Dumping{pcap_datalink(h), pcap_snapshot(h), params}
 {
-    close_dumping_file();
 }
 
-void Dumping::open_dumping_file(const std::string& file_path)
+Dumping::Dumping(int linktype, int snaplen, const Params& params)
+    : writer {DumpWriter::Params{params.output_file,
+                                 params.command,
+                                 params.size_limit,
+                                 params.interval,
+                                 params.packet_limit,
+                                 params.index,
+                                 linktype,
+                                 snaplen,
+                                 params.compression,
+                                 params.level,
+                                 params.threads}}
 {
-    const char* path {file_path.c_str()};
-    LOG("Dumping packets to file:%s", path);
-    dumper.reset(new pcap::PacketDumper{handle, path});
 }
 
-void Dumping::close_dumping_file()
-{
-    dumper.reset(); // close current dumper
-    exec_command();
-}
-
-void Dumping::exec_command() const
+Dumping::~Dumping()
 {
-    if(command.empty()) return;
-
-    NST::utils::Log::flush();   // flush buffer
-
-    if(pid_t pid = fork()) // spawn child process
+    if(writer.dropped())
     {
-        // parent process
-        LOG("Try to execute(%s %s) in %u child process", command.c_str(), name.c_str(), pid);
-        NST::utils::Log::flush();   // flush buffer
-        return;
-    }
-    else
-    {
-        // child process
-        std::istringstream ss(command);
-        std::vector<std::string> tokens;
-        std::vector<char*> args;
-
-        // TODO: this parser doesn't work with dual quotes, like rm "a file.cpp"
-        for(std::string arg; ss >> arg;)
-        {
-           tokens.emplace_back(arg);
-           args  .emplace_back(const_cast<char*>(tokens.back().c_str()));
-        }
-        args.push_back(const_cast<char*>(name.c_str()));
-        args.push_back(nullptr);  // need termination null pointer
-
-        if(execvp(args[0], &args[0]) == -1)
-        {
-            LOG("execvp(%s,%s %s) return: %s", args[0], command.c_str(), name.c_str(), strerror(errno));
-        }
-
-        LOG("child process %u will be terminated.", getpid());
-        std::terminate();
+        LOG("Dumping dropped %d packets", writer.dropped());
     }
 }
 
@@ -104,7 +58,15 @@ std::ostream& operator<<(std::ostream& out, const Dumping::Params& params)
 {
     out << "Dump packets to file: " << params.output_file << '\n'
         << "  file rotation size: " << params.size_limit << " bytes\n"
+        << "  file rotation interval: " << params.interval << " seconds\n"
+        << "  file rotation packets: " << params.packet_limit << '\n'
+        << "  index entry per: " << params.index << " packets\n"
         << "  file rotation command: [" << params.command << ']';
+    if(params.compression == DumpWriter::Compression::Gzip)
+    {
+        out << "\n  compression: gzip level " << params.level
+            << ", threads: " << (params.threads ? std::to_string(params.threads) : "auto");
+    }
     return out;
 }
 
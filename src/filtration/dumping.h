@@ -23,13 +23,12 @@
 #define DUMPING_H
 //------------------------------------------------------------------------------
 #include <cstring> // memcpy()
-#include <memory>
 #include <string>
 
 #include <sys/time.h>
 
+#include "filtration/dump_writer.h"
 #include "filtration/packet.h"
-#include "filtration/pcap/packet_dumper.h"
 #include "utils/log.h"
 #include "utils/sessions.h"
 //------------------------------------------------------------------------------
@@ -144,53 +143,35 @@ public:
 
     struct Params
     {
-        std::string output_file{ };
-        std::string command    { };
-        uint32_t    size_limit {0};
+        std::string output_file  { };
+        std::string command      { };
+        uint32_t    size_limit   {0};
+        uint32_t    interval     {0};
+        uint32_t    packet_limit {0};
+        uint32_t    index        {0};
+        DumpWriter::Compression compression {DumpWriter::Compression::None};
+        int         level        {1};
+        uint32_t    threads      {0};
     };
 
     Dumping(pcap_t*const h, const Params& params);
+    Dumping(int linktype, int snaplen, const Params& params);
     ~Dumping();
     Dumping(const Dumping&)            = delete;
     Dumping& operator=(const Dumping&) = delete;
 
+    // the packet is copied to the ring of the writer thread, capture never waits for disk,
+    // drops are counted in metrics, only the first one is logged here and the total at the end
     inline void dump(const pcap_pkthdr* header, const u_char* packet)
     {
-        if(limit)
+        if(!writer.push(header, packet) && writer.dropped() == 1)
         {
-            if( (size + sizeof(pcap_pkthdr) + header->caplen) > limit )
-            {
-                close_dumping_file();
-
-                ++part;
-                char suffix[64];
-                sprintf(suffix, "-%u", part);
-                name = base + /*'-' + std::to_string(part)*/ suffix;
-                size = 0;
-                open_dumping_file(name);
-
-                // new part of dump file shouldn't have ./pcap header
-                dumper->truncate_all_pcap_data_and_header();
-            }
-            size += sizeof(pcap_pkthdr) + header->caplen;
+            LOG("Dumping can't keep up with capture, packets are dropped");
         }
-
-        dumper->dump(header, packet);
     }
 
 private:
-    void open_dumping_file(const std::string& file_path);
-    void close_dumping_file();
-    void exec_command() const;
-
-    std::unique_ptr<pcap::PacketDumper> dumper;
-    pcap_t* const       handle;
-    const std::string   base;
-    std::string         name;
-    const std::string   command;
-    const uint32_t      limit;
-    uint32_t            part;
-    uint32_t            size;
+    DumpWriter writer;
 };
 
 std::ostream& operator<<(std::ostream& out, const Dumping::Params& params);
@@ -27,6 +27,7 @@
 #include "filtration/filtrators.h"
 #include "filtration/pcap/capture_reader.h"
 #include "filtration/pcap/file_reader.h"
+#include "filtration/pcap/selective_reader.h"
 #include "filtration/processing_thread.h"
 #include "filtration/queuing.h"
 //------------------------------------------------------------------------------
@@ -37,6 +38,7 @@ namespace filtration
 
 using CaptureReader = NST::filtration::pcap::CaptureReader;
 using FileReader    = NST::filtration::pcap::FileReader;
+using SelectiveReader = NST::filtration::pcap::SelectiveReader;
 
 using Parameters        = NST::controller::Parameters;
 using RunningStatus     = NST::controller::RunningStatus;
@@ -154,6 +156,24 @@ void FiltrationManager::add_offline_dumping (const Parameters& params)
         }
 
     }
+    auto selection = params.selection_params();
+    if(selection.enabled())
+    {
+        std::unique_ptr<SelectiveReader> reader { new SelectiveReader{ifile, selection} };
+
+        if(utils::Out message{}) // print parameters to user
+        {
+            message << *reader;
+        }
+        std::unique_ptr<Dumping>       writer { new Dumping{ reader->datalink(),
+                                                             reader->snapshot(),
+                                                             dumping_params
+                                                           }
+                                              };
+
+        threads.emplace_back(create_thread(reader, writer, status));
+        return;
+    }
     std::unique_ptr<FileReader> reader { new FileReader{ifile} };
 
     if(utils::Out message{}) // print parameters to user
@@ -179,9 +199,23 @@ void FiltrationManager::add_online_analysis(const Parameters& params,
 }
 
 // read from file and pass to queue - OfflineAnalysis(Analysis)
-void FiltrationManager::add_offline_analysis(const std::string& ifile,
+void FiltrationManager::add_offline_analysis(const Parameters& params,
                                              FilteredDataQueue& queue)
 {
+    auto ifile     = params.input_file();
+    auto selection = params.selection_params();
+    if(selection.enabled())
+    {
+        std::unique_ptr<SelectiveReader> reader { new SelectiveReader{ifile, selection} };
+        if(utils::Out message{}) // print parameters to user
+        {
+            message << *reader;
+        }
+        std::unique_ptr<Queueing>        writer { new Queueing{queue} };
+
+        threads.emplace_back(create_thread(reader, writer, status));
+        return;
+    }
     std::unique_ptr<FileReader> reader { new FileReader{ifile} };
     if(utils::Out message{}) // print parameters to user
     {
@@ -33,9 +33,10 @@
 #include <pcap/pcap.h>
 
 #include "utils/log.h"
+#include "utils/metrics.h"
 #include "utils/out.h"
+#include "utils/probes.h"
 #include "utils/sessions.h"
-#include "utils/profiler.h"
 #include "controller/parameters.h"
 #include "filtration/packet.h"
 #include "filtration/sessions_hash.h"
@@ -189,6 +190,7 @@ public:
                 Packet* c = fragments;
                 fragments = c->next;
                 Packet::destroy(c);
+                utils::Metrics::add(utils::Metrics::TCPFragments, -1);
             }
 
             sequence = 0;
@@ -267,6 +269,7 @@ public:
                 {
                     //TRACE("ADD FRAGMENT seq: %u dlen: %u sequence: %u", seq, info.dlen, sequence);
                     fragments = Packet::create(info, fragments);
+                    utils::Metrics::add(utils::Metrics::TCPFragments, 1);
                 }
             }
         }
@@ -324,6 +327,7 @@ public:
                         }
 
                         Packet::destroy(current);
+                        utils::Metrics::add(utils::Metrics::TCPFragments, -1);
 
                         return true;
                     }
@@ -343,6 +347,7 @@ public:
 
                         reader.push(*current);
                         Packet::destroy(current);
+                        utils::Metrics::add(utils::Metrics::TCPFragments, -1);
 
                         return true;
                     }
@@ -356,6 +361,7 @@ public:
                     // There are frames missing in the capture stream that were seen
                     // by the receiving host. Inform stream about it.
                     reader.lost(lowest_seq - sequence);
+                    utils::Metrics::add(utils::Metrics::TCPLostBytes, lowest_seq - sequence);
                     sequence = lowest_seq;
                     return true;
                 }
@@ -382,6 +388,7 @@ public:
 
     void collect(PacketInfo& info)
     {
+        utils::Probes::Scope probe{utils::Probes::Reassembly};
         const uint32_t ack {info.tcp->ack()};
 
         //check whether this frame acks fragments that were already seen.
@@ -411,6 +418,9 @@ public:
     , ipv4_udp_sessions{writer.get()}
     , ipv6_tcp_sessions{writer.get()}
     , ipv6_udp_sessions{writer.get()}
+    , packets{0}
+    , drops{0}
+    , ifdrops{0}
     {
         // check datalink layer
         datalink = reader->datalink();
@@ -441,9 +451,14 @@ public:
 
     static void callback(u_char *user, const struct pcap_pkthdr *pkthdr, const u_char* packet)
     {
-        PROF;// Calc how much time was spent in this func
+        utils::Probes::Scope probe{utils::Probes::Capture};
         auto processor = reinterpret_cast<FiltrationProcessor*>(user);
 
+        if((++processor->packets % StatisticPeriod) == 0)
+        {
+            processor->update_statistic();
+        }
+
         PacketInfo info(pkthdr, packet, processor->datalink);
 
         if(info.tcp)
@@ -482,6 +497,22 @@ public:
 
 private:
 
+    // count of packets between polling statistic of Reader
+    static const uint32_t StatisticPeriod {1024};
+
+    // pcap counts drops since start of capture, metrics get their increase
+    void update_statistic()
+    {
+        struct pcap_stat ps;
+        if(reader->get_statistic(ps))
+        {
+            utils::Metrics::add(utils::Metrics::KernelDrops,    static_cast<u_int>(ps.ps_drop   - drops));
+            utils::Metrics::add(utils::Metrics::InterfaceDrops, static_cast<u_int>(ps.ps_ifdrop - ifdrops));
+            drops   = ps.ps_drop;
+            ifdrops = ps.ps_ifdrop;
+        }
+    }
+
     std::unique_ptr<Reader> reader;
     std::unique_ptr<Writer> writer;
 
@@ -491,6 +522,9 @@ private:
     SessionsHash< IPv6TCPMapper, TCPSession < Filtrator> , Writer > ipv6_tcp_sessions;
     SessionsHash< IPv6UDPMapper, UDPSession < Writer > , Writer >                  ipv6_udp_sessions;
 
+    uint32_t packets;
+    u_int drops;   // reported by the last poll of statistic of Reader
+    u_int ifdrops;
     int datalink;
 };
 
@@ -23,6 +23,8 @@
 #ifndef IFILTRATOR_H
 #define IFILTRATOR_H
 //------------------------------------------------------------------------------
+#include "utils/probes.h"
+//------------------------------------------------------------------------------
 namespace NST
 {
 namespace filtration
@@ -147,6 +149,7 @@ public:
      */
     inline void push(PacketInfo& info)
     {
+        utils::Probes::Scope probe{utils::Probes::Framing};
         Filtrator* filtrator = static_cast<Filtrator* >(this);
         assert(info.dlen != 0);
 
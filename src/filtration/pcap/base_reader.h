@@ -72,6 +72,7 @@ public:
     inline static const char* datalink_description (const int dlt) { return pcap_datalink_val_to_description(dlt); }
 
     virtual void print_statistic(std::ostream& out) const = 0;
+    virtual bool get_statistic(struct pcap_stat& stat) const = 0;
 
 protected:
     pcap_t* handle;
@@ -108,6 +108,11 @@ void CaptureReader::print_statistic(std::ostream& out) const
     }
 }
 
+bool CaptureReader::get_statistic(struct pcap_stat& stat) const
+{
+    return pcap_stats(handle, &stat) == 0;
+}
+
 std::ostream& operator<<(std::ostream& out, const CaptureReader::Params& params)
 {
     out << "Read from interface: " << params.interface << '\n'
@@ -58,6 +58,7 @@ public:
     ~CaptureReader() = default;
 
     void print_statistic(std::ostream& out) const override;
+    bool get_statistic(struct pcap_stat& stat) const override;
 
 };
 
@@ -42,6 +42,7 @@ public:
     inline FILE* get_file() { return pcap_file(handle); }
 
     void print_statistic(std::ostream& /*out*/) const override { /*dummy method*/ }
+    bool get_statistic(struct pcap_stat& /*stat*/) const override { return false; }
 
     inline int  major_version() { return pcap_major_version(handle); }
     inline int  minor_version() { return pcap_minor_version(handle); }
@@ -0,0 +1,598 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Reader of time range and flow of .pcap files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "filtration/pcap/selective_reader.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace filtration
+{
+namespace pcap
+{
+namespace // unnamed
+{
+
+// .pcap file format, see pcap-savefile(5)
+struct FileHeader
+{
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t  thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+struct RecordHeader
+{
+    uint32_t ts_sec;
+    uint32_t ts_frac;           // microseconds or nanoseconds
+    uint32_t caplen;
+    uint32_t len;
+};
+
+const uint32_t MagicMicroseconds {0xa1b2c3d4};
+const uint32_t MagicNanoseconds  {0xa1b23c4d};
+
+const uint32_t MaxRecord     {262144};          // max snaplen of libpcap
+const int      ResyncChain   {4};               // records checked after a found one
+const uint64_t ResyncGap     {86400};           // max seconds between them
+const uint64_t SearchWindow  {1024 * 1024};     // scanned linearly
+const uint64_t Microseconds  {1000000};
+const uint64_t Unlimited     {std::numeric_limits<uint64_t>::max()};
+
+inline uint32_t swap32(uint32_t v)
+{
+    return ((v & 0xFF000000) >> 24)
+         | ((v & 0x00FF0000) >> 8)
+         | ((v & 0x0000FF00) << 8)
+         | ((v & 0x000000FF) << 24);
+}
+
+} // unnamed namespace
+
+bool SelectiveReader::Endpoint::matches(const DumpIndex::Key& key, int side) const
+{
+    if(family && (family != key.family ||
+                  memcmp(address, key.address[side], family == 4 ? 4 : 16) != 0))
+    {
+        return false;
+    }
+    return port == 0 || port == key.port[side];
+}
+
+bool SelectiveReader::Flow::matches(const DumpIndex::Key& key) const
+{
+    if(protocol && protocol != key.protocol)
+    {
+        return false;
+    }
+    if(amount == 1)
+    {
+        return endpoints[0].matches(key, 0) || endpoints[0].matches(key, 1);
+    }
+    return (endpoints[0].matches(key, 0) && endpoints[1].matches(key, 1)) ||
+           (endpoints[0].matches(key, 1) && endpoints[1].matches(key, 0));
+}
+
+SelectiveReader::SelectiveReader(const std::string& file, const Params& p)
+: source          {file}
+, params          (p)
+, fd              {-1}
+, memory          {nullptr}
+, length          {0}
+, gzip            {nullptr}
+, swapped         {false}
+, nanoseconds     {false}
+, linktype        {0}
+, snaplen         {0}
+, begin           {sizeof(FileHeader), 0}
+, last            {Unlimited, 0}
+, end             {params.end}
+, empty           {false}
+, method          {"scan"}
+, read_packets    {0}
+, selected_packets{0}
+, read_bytes      {0}
+, buffer          {}
+, stopped         {false}
+{
+    fd = open(file.c_str(), O_RDONLY);
+    if(fd == -1)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in opening file: " + file}};
+    }
+    try
+    {
+        struct stat st;
+        if(fstat(fd, &st) == -1)
+        {
+            throw std::system_error{errno, std::system_category(), {"Error in opening file: " + file}};
+        }
+        length = static_cast<uint64_t>(st.st_size);
+
+        uint8_t magic[2] {0, 0};
+        if(pread(fd, magic, sizeof(magic), 0) == sizeof(magic) && magic[0] == 0x1f && magic[1] == 0x8b)
+        {
+            // compressed part is read from the beginning of the stream by default
+            begin.offset = 0;
+            reopen_gzip();
+            uint8_t header[sizeof(FileHeader)];
+            if(gzread(gzip, header, sizeof(header)) != sizeof(header))
+            {
+                throw std::runtime_error{"Not a pcap file: " + file};
+            }
+            read_header(header);
+        }
+        else
+        {
+            if(length < sizeof(FileHeader))
+            {
+                throw std::runtime_error{"Not a pcap file: " + file};
+            }
+            void* mapped {mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0)};
+            if(mapped == MAP_FAILED)
+            {
+                throw std::system_error{errno, std::system_category(), {"Error in mapping file: " + file}};
+            }
+            memory = static_cast<uint8_t*>(mapped);
+            read_header(memory);
+        }
+
+        if(!use_index() && memory && params.start)
+        {
+            begin.offset = search(params.start);
+            method = "binary search";
+        }
+        if(gzip && begin.offset)
+        {
+            reopen_gzip();
+        }
+        if(memory)
+        {
+            const uint64_t page {static_cast<uint64_t>(sysconf(_SC_PAGESIZE))};
+            const uint64_t from {begin.offset - begin.offset % page};
+            madvise(memory + from, length - from, MADV_SEQUENTIAL);
+        }
+    }
+    catch(...)
+    {
+        if(memory)
+        {
+            munmap(memory, length);
+        }
+        if(gzip)
+        {
+            gzclose(gzip);
+        }
+        close(fd);
+        throw;
+    }
+}
+
+SelectiveReader::~SelectiveReader()
+{
+    if(memory)
+    {
+        munmap(memory, length);
+    }
+    if(gzip)
+    {
+        gzclose(gzip);
+    }
+    close(fd);
+}
+
+bool SelectiveReader::loop(void* user, pcap_handler callback)
+{
+    if(empty)
+    {
+        return true;
+    }
+    return memory ? loop_mapped(user, callback) : loop_gzip(user, callback);
+}
+
+void SelectiveReader::print_statistic(std::ostream& out) const
+{
+    out << "Statistics from file: " << source << '\n'
+        << "  packets read by filtration: " << read_packets << '\n'
+        << "  packets selected          : " << selected_packets << '\n'
+        << "  bytes read                : " << read_bytes;
+    if(memory)
+    {
+        out << " of " << length;
+    }
+    out << "\n  first packet is found by  : " << method;
+}
+
+void SelectiveReader::read_header(const uint8_t* data)
+{
+    FileHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if(header.magic == MagicMicroseconds || header.magic == swap32(MagicMicroseconds))
+    {
+        swapped = header.magic != MagicMicroseconds;
+    }
+    else if(header.magic == MagicNanoseconds || header.magic == swap32(MagicNanoseconds))
+    {
+        swapped = header.magic != MagicNanoseconds;
+        nanoseconds = true;
+    }
+    else
+    {
+        throw std::runtime_error{"Not a pcap file: " + source};
+    }
+    linktype = static_cast<int>(swapped ? swap32(header.linktype) : header.linktype);
+    snaplen  = static_cast<int>(swapped ? swap32(header.snaplen)  : header.snaplen);
+}
+
+// gzip stream is started from the member at begin position
+void SelectiveReader::reopen_gzip()
+{
+    if(gzip)
+    {
+        gzclose(gzip);
+        gzip = nullptr;
+    }
+    if(lseek(fd, static_cast<off_t>(begin.offset), SEEK_SET) == -1)
+    {
+        throw std::system_error{errno, std::system_category(), {"Error in reading file: " + source}};
+    }
+    const int stream {dup(fd)}; // it is closed by gzclose()
+    if(stream == -1 || (gzip = gzdopen(stream, "rb")) == nullptr)
+    {
+        if(stream != -1)
+        {
+            close(stream);
+        }
+        throw std::runtime_error{"Error in reading gzip file: " + source};
+    }
+    if(begin.skip && gzseek(gzip, begin.skip, SEEK_CUR) == -1)
+    {
+        throw std::runtime_error{"Error in reading gzip file: " + source};
+    }
+}
+
+bool SelectiveReader::use_index()
+{
+    DumpIndex index;
+    if(!index.read(source))
+    {
+        return false;
+    }
+    const DumpIndex::Header& header {index.header()};
+    const bool members {(header.flags & DumpIndex::GzipMembers) != 0};
+    if(members != (gzip != nullptr) || static_cast<int>(header.linktype) != linktype)
+    {
+        return false; // index of another file
+    }
+
+    Position first {begin};
+    if(params.start)
+    {
+        // the last entry before the first one after start
+        for(const auto& entry : index.times())
+        {
+            if(entry.sec * Microseconds + entry.usec > params.start)
+            {
+                break;
+            }
+            first = Position{entry.offset, entry.skip};
+        }
+    }
+    if(params.has_flow && !(header.flags & DumpIndex::FlowsTruncated))
+    {
+        bool found {false};
+        Position from {Unlimited, 0};
+        Position to   {0, 0};
+        uint64_t until {0};
+        for(const auto& flow : index.flows())
+        {
+            if(!params.flow.matches(flow.key) ||
+               (flow.last_sec + 1) * Microseconds <= params.start ||
+               flow.first_sec * Microseconds >= params.end)
+            {
+                continue;
+            }
+            found = true;
+            from  = std::min(from, Position{flow.first_offset, flow.first_skip});
+            to    = std::max(to, Position{flow.last_offset, flow.last_skip});
+            until = std::max(until, (flow.last_sec + 1) * Microseconds);
+        }
+        if(!found)
+        {
+            empty = true;
+        }
+        first = std::max(first, from);
+        last  = to;
+        end   = std::min(end, until);
+    }
+    begin  = first;
+    method = "index";
+    return true;
+}
+
+// offset of a record before the first one at start or later
+uint64_t SelectiveReader::search(uint64_t start) const
+{
+    uint64_t low {sizeof(FileHeader)};
+    pcap_pkthdr header;
+    if(!record(low, header) || microseconds(header) >= start)
+    {
+        return low;
+    }
+    uint32_t since {static_cast<uint32_t>(header.ts.tv_sec)}; // of the record at low
+    uint64_t high {length};
+    while(high - low > SearchWindow)
+    {
+        const uint64_t middle {low + (high - low) / 2};
+        const uint64_t found {resync(middle, high, since)};
+        if(found == high)
+        {
+            high = middle;
+        }
+        else if(record(found, header) && microseconds(header) < start)
+        {
+            low   = found;
+            since = static_cast<uint32_t>(header.ts.tv_sec);
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// offset of the first record boundary in [from, limit) or limit,
+// since is seconds of a record before from
+uint64_t SelectiveReader::resync(uint64_t from, uint64_t limit, uint32_t since) const
+{
+    pcap_pkthdr header;
+    for(uint64_t offset = from; offset + sizeof(RecordHeader) <= limit; ++offset)
+    {
+        // a boundary is followed by a chain of plausible records or by the end of file,
+        // the first one isn't earlier than since, a capture may last for any time,
+        // each next one is close to the previous
+        uint64_t next {offset};
+        uint64_t earliest {since};
+        uint64_t latest {Unlimited};
+        int chain {0};
+        for(; chain < ResyncChain && next != length; ++chain)
+        {
+            if(!plausible(next, earliest, latest, header))
+            {
+                break;
+            }
+            earliest = static_cast<uint64_t>(header.ts.tv_sec);
+            latest   = earliest + ResyncGap;
+            next += sizeof(RecordHeader) + header.caplen;
+        }
+        if(chain == ResyncChain || (chain > 0 && next == length))
+        {
+            return offset;
+        }
+    }
+    return limit;
+}
+
+// a second of reordering is allowed before earliest
+bool SelectiveReader::plausible(uint64_t offset, uint64_t earliest, uint64_t latest, pcap_pkthdr& header) const
+{
+    if(!record(offset, header))
+    {
+        return false;
+    }
+    const uint64_t seconds {static_cast<uint32_t>(header.ts.tv_sec)};
+    return header.caplen <= header.len && header.len <= MaxRecord &&
+           header.ts.tv_usec < static_cast<suseconds_t>(Microseconds) &&
+           seconds + 1 >= earliest && seconds <= latest;
+}
+
+bool SelectiveReader::record(uint64_t offset, pcap_pkthdr& header) const
+{
+    if(offset + sizeof(RecordHeader) > length)
+    {
+        return false;
+    }
+    RecordHeader r;
+    memcpy(&r, memory + offset, sizeof(r));
+    if(swapped)
+    {
+        r.ts_sec  = swap32(r.ts_sec);
+        r.ts_frac = swap32(r.ts_frac);
+        r.caplen  = swap32(r.caplen);
+        r.len     = swap32(r.len);
+    }
+    if(r.caplen > MaxRecord || offset + sizeof(RecordHeader) + r.caplen > length)
+    {
+        return false; // truncated
+    }
+    header.ts.tv_sec  = r.ts_sec;
+    header.ts.tv_usec = nanoseconds ? r.ts_frac / 1000 : r.ts_frac;
+    header.caplen     = r.caplen;
+    header.len        = r.len;
+    return true;
+}
+
+uint64_t SelectiveReader::microseconds(const pcap_pkthdr& header) const
+{
+    return static_cast<uint64_t>(header.ts.tv_sec) * Microseconds + static_cast<uint64_t>(header.ts.tv_usec);
+}
+
+bool SelectiveReader::selected(const pcap_pkthdr& header, const uint8_t* packet) const
+{
+    if(microseconds(header) < params.start)
+    {
+        return false;
+    }
+    DumpIndex::Key key;
+    return !params.has_flow || (DumpIndex::key(&header, packet, linktype, key) && params.flow.matches(key));
+}
+
+bool SelectiveReader::loop_mapped(void* user, pcap_handler callback)
+{
+    pcap_pkthdr header;
+    while(begin.offset <= last.offset && record(begin.offset, header))
+    {
+        if(stopped.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        if(microseconds(header) >= end)
+        {
+            break;
+        }
+        const uint8_t* packet {memory + begin.offset + sizeof(RecordHeader)};
+        begin.offset += sizeof(RecordHeader) + header.caplen;
+        ++read_packets;
+        read_bytes += sizeof(RecordHeader) + header.caplen;
+
+        if(selected(header, packet))
+        {
+            ++selected_packets;
+            callback(reinterpret_cast<u_char*>(user), &header, packet);
+        }
+    }
+    empty = true;
+    return true;
+}
+
+// zlib stops inflating at the end of each gzip member, so after a record is
+// read gzoffset() points into its member, and the member of the last position
+// starts at decompressed offset base
+bool SelectiveReader::loop_gzip(void* user, pcap_handler callback)
+{
+    pcap_pkthdr header;
+    RecordHeader r;
+    const bool bounded {last.offset != Unlimited};
+    bool in_last {begin.offset == last.offset};
+    uint64_t base {0};
+    if(bounded && last < begin)
+    {
+        empty = true;
+        return true;
+    }
+    for(;;)
+    {
+        if(stopped.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        const uint64_t at {static_cast<uint64_t>(gztell(gzip))};
+        if(gzread(gzip, &r, sizeof(r)) != sizeof(r))
+        {
+            break;
+        }
+        if(bounded)
+        {
+            if(!in_last && static_cast<uint64_t>(gzoffset(gzip)) > last.offset)
+            {
+                in_last = true;
+                base    = at;
+            }
+            if(in_last && at - base > last.skip)
+            {
+                break;
+            }
+        }
+        if(swapped)
+        {
+            r.ts_sec  = swap32(r.ts_sec);
+            r.ts_frac = swap32(r.ts_frac);
+            r.caplen  = swap32(r.caplen);
+            r.len     = swap32(r.len);
+        }
+        if(r.caplen > MaxRecord)
+        {
+            throw std::runtime_error{"Broken record in file: " + source};
+        }
+        buffer.resize(std::max<std::size_t>(buffer.size(), r.caplen));
+        if(gzread(gzip, buffer.data(), r.caplen) != static_cast<int>(r.caplen))
+        {
+            break; // truncated
+        }
+        header.ts.tv_sec  = r.ts_sec;
+        header.ts.tv_usec = nanoseconds ? r.ts_frac / 1000 : r.ts_frac;
+        header.caplen     = r.caplen;
+        header.len        = r.len;
+        if(microseconds(header) >= end)
+        {
+            break;
+        }
+        ++read_packets;
+        read_bytes += sizeof(RecordHeader) + header.caplen;
+
+        if(selected(header, buffer.data()))
+        {
+            ++selected_packets;
+            callback(reinterpret_cast<u_char*>(user), &header, buffer.data());
+        }
+    }
+    empty = true;
+    return true;
+}
+
+std::ostream& operator<<(std::ostream& out, const SelectiveReader& r)
+{
+    out << "Read packets from: " << r.source << '\n';
+    out << "  datalink: " << pcap_datalink_val_to_name(r.linktype)
+        << " (" << SelectiveReader::datalink_description(r.linktype) << ")\n";
+    out << "  selection:";
+    const auto time = [&out](uint64_t t)
+    {
+        out << t / Microseconds << '.' << std::setw(6) << std::setfill('0') << t % Microseconds << std::setfill(' ');
+    };
+    if(r.params.start)
+    {
+        out << " from ";
+        time(r.params.start);
+    }
+    if(r.params.end != Unlimited)
+    {
+        out << " until ";
+        time(r.params.end);
+    }
+    if(r.params.has_flow)
+    {
+        out << " flow " << r.params.flow_text;
+    }
+    return out;
+}
+
+} // namespace pcap
+} // namespace filtration
+} // namespace NST
+//------------------------------------------------------------------------------
@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Reader of time range and flow of .pcap files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef SELECTIVE_READER_H
+#define SELECTIVE_READER_H
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <pcap/pcap.h>
+#include <zlib.h>
+
+#include "filtration/dump_index.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace filtration
+{
+namespace pcap
+{
+
+/*! Reads packets of a time range and/or a flow from a .pcap file through
+ *  the interface FiltrationProcessor expects from pcap readers (see
+ *  filtration/pcap/base_reader.h), other packets never reach it.
+ *  The first packet to read is found by the sidecar index of the file (see
+ *  DumpIndex) if there is one, otherwise by binary search over timestamps
+ *  of the mapped file. Reading stops after the end of the range or after
+ *  the last packet of the flow, so timestamps are assumed to be ordered as
+ *  they are in captures. Parts compressed by dump mode are read from the
+ *  gzip member pointed by the index or from the beginning without it.
+ */
+class SelectiveReader
+{
+public:
+    //! Endpoint of a flow, zero family or port matches any
+    struct Endpoint
+    {
+        uint8_t  family;            // 4 or 6
+        uint8_t  address[16];
+        uint16_t port;
+
+        bool matches(const DumpIndex::Key& key, int side) const;
+    };
+
+    struct Flow
+    {
+        Endpoint endpoints[2];
+        uint8_t  amount;            // of endpoints, a single one matches either side
+        uint8_t  protocol;          // IPPROTO_TCP, IPPROTO_UDP or 0 for any
+
+        bool matches(const DumpIndex::Key& key) const;
+    };
+
+    struct Params
+    {
+        uint64_t    start    {0};   // microseconds since Epoch, inclusive
+        uint64_t    end      {std::numeric_limits<uint64_t>::max()}; // exclusive
+        bool        has_flow {false};
+        Flow        flow     { };
+        std::string flow_text{ };   // as it was passed
+
+        inline bool enabled() const
+        {
+            return start != 0 || end != std::numeric_limits<uint64_t>::max() || has_flow;
+        }
+    };
+
+    SelectiveReader(const std::string& file, const Params& params);
+    ~SelectiveReader();
+    SelectiveReader(const SelectiveReader&)            = delete;
+    SelectiveReader& operator=(const SelectiveReader&) = delete;
+
+    // returns true if all selected packets were passed to callback
+    bool loop(void* user, pcap_handler callback);
+
+    inline void break_loop()      { stopped.store(true, std::memory_order_relaxed); }
+    inline int  datalink() const  { return linktype; }
+    inline int  snapshot() const  { return snaplen;  }
+    inline static const char* datalink_description(const int dlt) { return pcap_datalink_val_to_description(dlt); }
+
+    void print_statistic(std::ostream& out) const;
+    bool get_statistic(struct pcap_stat& /*stat*/) const { return false; }
+
+    friend std::ostream& operator<<(std::ostream& out, const SelectiveReader& r);
+
+private:
+    struct Position
+    {
+        uint64_t offset;
+        uint32_t skip;              // in uncompressed gzip member
+
+        bool operator<(const Position& other) const
+        {
+            return offset < other.offset || (offset == other.offset && skip < other.skip);
+        }
+    };
+
+    void read_header(const uint8_t* data);
+    void reopen_gzip();
+    bool use_index();
+    uint64_t search(uint64_t start) const;
+    uint64_t resync(uint64_t from, uint64_t limit, uint32_t since) const;
+    bool plausible(uint64_t offset, uint64_t earliest, uint64_t latest, pcap_pkthdr& header) const;
+    bool record(uint64_t offset, pcap_pkthdr& header) const;
+    uint64_t microseconds(const pcap_pkthdr& header) const;
+    bool selected(const pcap_pkthdr& header, const uint8_t* packet) const;
+    bool loop_mapped(void* user, pcap_handler callback);
+    bool loop_gzip(void* user, pcap_handler callback);
+
+    const std::string source;
+    const Params params;
+
+    int      fd;
+    uint8_t* memory;            // mapped plain file
+    uint64_t length;
+    gzFile   gzip;              // or compressed one
+    bool     swapped;
+    bool     nanoseconds;
+    int      linktype;
+    int      snaplen;
+
+    Position    begin;
+    Position    last;           // position of the last packet to read
+    uint64_t    end;            // microseconds, exclusive
+    bool        empty;          // nothing can be selected
+    const char* method;         // how the first packet was found
+
+    uint64_t read_packets;
+    uint64_t selected_packets;
+    uint64_t read_bytes;
+    std::vector<uint8_t> buffer; // of compressed file records
+    std::atomic<bool> stopped;
+};
+
+} // namespace pcap
+} // namespace filtration
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//SELECTIVE_READER_H
+//------------------------------------------------------------------------------
@@ -26,6 +26,8 @@
 
 #include "utils/filtered_data.h"
 #include "utils/log.h"
+#include "utils/metrics.h"
+#include "utils/probes.h"
 #include "utils/sessions.h"
 //------------------------------------------------------------------------------
 namespace NST
@@ -80,6 +82,7 @@ public:
                 ptr = queue->allocate();
                 if (!ptr)
                 {
+                    utils::Metrics::add(utils::Metrics::QueueExhausted, 1);
                     LOG("free elements of the Queue are exhausted");
                 }
             }
@@ -143,6 +146,8 @@ public:
             ptr->session   = session;
             ptr->timestamp = info.header->ts;
             ptr->direction = info.direction;
+            ptr->queued    = utils::Probes::enabled() ? utils::Probes::now() : 0;
+            utils::Metrics::record(utils::Metrics::MessageBytes, ptr->dlen);
 
             queue->push(ptr);
             ptr = nullptr;
@@ -31,6 +31,7 @@
 
 #include "controller/parameters.h"
 #include "filtration/packet.h"
+#include "utils/metrics.h"
 #include "utils/out.h"
 #include "utils/sessions.h"
 //------------------------------------------------------------------------------
@@ -323,6 +324,7 @@ public:
         {
             delete s.second;
         }
+        utils::Metrics::add(utils::Metrics::Sessions, -static_cast<int64_t>(sessions.size()));
     }
 
     void collect_packet(PacketInfo& info)
@@ -340,6 +342,7 @@ public:
             {
                 ptr.release();
                 i = res.first;
+                utils::Metrics::add(utils::Metrics::Sessions, 1);
 
                 // fill new session after construction
                 utils::NetworkSession& session = *(res.first->second);
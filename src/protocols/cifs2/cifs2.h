@@ -182,9 +182,11 @@ inline const Cmd command(Data& request, Data& response, Session* session)
     parse(pargs);
 
     cmd.req_header = req_header;
+    cmd.req_length = request->dlen;
     if(response)
     {
         cmd.res_header = reinterpret_cast<RawMessageHeader*>(response->data);
+        cmd.res_length = response->dlen;
         cmd.pres = reinterpret_cast<typename Cmd::ResponseType*>(response->data + sizeof(RawMessageHeader));
     }
     cmd.parg = pargs; 
@@ -28,6 +28,7 @@
 #include "protocols/nfs3/nfs3_utils.h"
 #include "protocols/nfs4/nfs4_utils.h"
 #include "protocols/nfs4/nfs41_utils.h"
+#include "utils/probes.h"
 #include "utils/sessions.h"
 //------------------------------------------------------------------------------
 namespace NST
@@ -51,6 +52,7 @@ public:
     : parg{&arg}    // set pointer to argument
     , pres{&res}    // set pointer to result
     {
+        utils::Probes::Scope probe{utils::Probes::XDRDecode};
         memset(&call, 0,sizeof(call ));
         memset(&reply,0,sizeof(reply));
         memset(&arg,      0,sizeof(arg      ));
@@ -30,30 +30,80 @@ namespace protocols
 namespace NFS
 {
 
-void print_hex64(std::ostream& out, uint64_t val)
+namespace
+{
 
+const char HexDigits[] = "0123456789abcdef";
+
+// Puts at least width hex digits of value before end, returns the first one
+char* put_hex(char* end, uint64_t value, int width)
 {
-    out << "0x" << std::setfill('0') << std::setw(16) << std::hex << val
-        << std::dec << std::setfill(' ');
+    char* begin {end};
+    do
+    {
+        *--begin = HexDigits[value & 0xF];
+        value >>= 4;
+    }
+    while(value != 0);
+    while(end - begin < width)
+    {
+        *--begin = '0';
+    }
+    return begin;
+}
+
+// Writes "0x" and width hex digits of value, leaves stream in decimal mode
+// with space fill as if std::hex and std::setfill('0') were used
+void write_hex(std::ostream& out, uint64_t value, int width)
+{
+    char buffer[2 + 16];
+    char* const end {buffer + sizeof(buffer)};
+    char* begin {put_hex(end, value, width)};
+    *--begin = 'x';
+    *--begin = '0';
+    out.write(begin, end - begin);
+    out.setf(std::ios_base::dec, std::ios_base::basefield);
+    out.fill(' ');
+}
+
+// Writes two hex digits of each byte, prints data by chunks
+void write_hex_bytes(std::ostream& out, const char* const val, const uint32_t len)
+{
+    char buffer[128];
+    uint32_t i {0};
+    while(i < len)
+    {
+        char* p {buffer};
+        for(; i < len && p != buffer + sizeof(buffer); i++)
+        {
+            const uint8_t byte {static_cast<uint8_t>(val[i])};
+            *p++ = HexDigits[byte >> 4];
+            *p++ = HexDigits[byte & 0xF];
+        }
+        out.write(buffer, p - buffer);
+    }
+}
+
+} // unnamed namespace
+
+void print_hex64(std::ostream& out, uint64_t val)
+{
+    write_hex(out, val, 16);
 }
 
 void print_hex32(std::ostream& out, uint32_t val)
 {
-    out << "0x" << std::setfill('0') << std::setw(8) << std::hex << val
-        << std::dec << std::setfill(' ');
+    write_hex(out, val, 8);
 }
 
 void print_hex16(std::ostream& out, uint16_t val)
 {
-    out << "0x" << std::setfill('0') << std::setw(4) << std::hex << val
-        << std::dec << std::setfill(' ');
+    write_hex(out, val, 4);
 }
 
 void print_hex8(std::ostream& out, uint8_t val)
 {
-    out << "0x" << std::setfill('0') << std::setw(2) << std::hex
-        << static_cast<u_int16_t>(val)          // prevent implicit cast to char
-        << std::dec << std::setfill(' ');
+    write_hex(out, val, 2);
 }
 
 
@@ -61,12 +111,16 @@ void print_hex(std::ostream& out, const uint32_t* const val, const uint32_t len)
 {
     if (len)
     {
-        out << std::hex << std::setfill('0') << "0x";
+        out.write("0x", 2);
         for (uint32_t i {0}; i < len; i++)
         {
-            out << std::setw(2) << val[i];
+            char buffer[8];
+            char* const end {buffer + sizeof(buffer)};
+            const char* begin {put_hex(end, val[i], 2)};
+            out.write(begin, end - begin);
         }
-        out << std::dec << std::setfill(' ');
+        out.setf(std::ios_base::dec, std::ios_base::basefield);
+        out.fill(' ');
     }
     else
     {
@@ -78,13 +132,10 @@ void print_hex(std::ostream& out, const char* const val, const uint32_t len)
 {
     if (len)
     {
-        out << std::hex << std::setfill('0') << "0x";
-        for (uint32_t i {0}; i < len; i++)
-        {
-            out << std::setw(2)
-                << ((static_cast<int32_t>(val[i])) & 0xFF);
-        }
-        out << std::dec << std::setfill(' ');
+        out.write("0x", 2);
+        write_hex_bytes(out, val, len);
+        out.setf(std::ios_base::dec, std::ios_base::basefield);
+        out.fill(' ');
     }
     else
     {
@@ -96,30 +147,18 @@ void print_nfs_fh(std::ostream& out, const char* const val, const uint32_t len)
 {
     if (len)
     {
-        out << std::hex << std::setfill('0');
         if (len <= 8 || out_all())
         {
-            for (uint32_t i {0}; i < len; i++)
-            {
-                out << std::setw(2)
-                    << ((static_cast<int32_t>(val[i])) & 0xFF);
-            }
+            write_hex_bytes(out, val, len);
         }
         else // truncate binary data to: 00112233...CCDDEEFF
         {
-            for (uint32_t i {0}; i < 4; i++)
-            {
-                out << std::setw(2)
-                    << ((static_cast<int32_t>(val[i])) & 0xFF);
-            }
-            out << "...";
-            for (uint32_t i {len - 4}; i < len; i++)
-            {
-                out << std::setw(2)
-                    << ((static_cast<int32_t>(val[i])) & 0xFF);
-            }
+            write_hex_bytes(out, val, 4);
+            out.write("...", 3);
+            write_hex_bytes(out, val + len - 4, 4);
         }
-        out << std::dec << std::setfill(' ');
+        out.setf(std::ios_base::dec, std::ios_base::basefield);
+        out.fill(' ');
     }
     else
     {
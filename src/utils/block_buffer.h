@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Stream buffer writing to another one in large blocks
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef BLOCK_BUFFER_H
+#define BLOCK_BUFFER_H
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <streambuf>
+#include <vector>
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+
+// Collects characters in preallocated block and passes it to sink streambuf
+// by one call when the block is full or on flush. It avoids per-insertion
+// overhead of sink (e.g. locking of stdio) for heavy text output.
+class BlockBuffer : public std::streambuf
+{
+public:
+    BlockBuffer(std::streambuf* sink, std::size_t capacity)
+    : block(capacity != 0 ? capacity : 1)
+    , sink {sink}
+    {
+        setp(block.data(), block.data() + block.size());
+    }
+    BlockBuffer(const BlockBuffer&)            = delete;
+    BlockBuffer& operator=(const BlockBuffer&) = delete;
+    ~BlockBuffer()
+    {
+        sync();
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if(!write_block())
+        {
+            return traits_type::eof();
+        }
+        if(!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char_type* s, std::streamsize n) override
+    {
+        if(n <= 0)
+        {
+            return 0; // s may be nullptr, e.g. for empty string
+        }
+        if(n <= epptr() - pptr())
+        {
+            std::memcpy(pptr(), s, n);
+            pbump(static_cast<int>(n));
+            return n;
+        }
+        if(!write_block())
+        {
+            return 0;
+        }
+        if(static_cast<std::size_t>(n) >= block.size())
+        {
+            return sink->sputn(s, n); // too large to be collected
+        }
+        std::memcpy(pptr(), s, n);
+        pbump(static_cast<int>(n));
+        return n;
+    }
+
+    int sync() override
+    {
+        return (write_block() && sink->pubsync() == 0) ? 0 : -1;
+    }
+
+private:
+    bool write_block()
+    {
+        const std::streamsize size {pptr() - pbase()};
+        const bool written {size == 0 || sink->sputn(pbase(), size) == size};
+        setp(block.data(), block.data() + block.size());
+        return written;
+    }
+
+    std::vector<char> block;
+    std::streambuf* sink;
+};
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//BLOCK_BUFFER_H
+//------------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Fast formatting of integers for output streams
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <type_traits>
+
+#include "utils/fast_num_put.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+namespace
+{
+
+const char HexDigits[] = "0123456789abcdef";
+
+} // unnamed namespace
+
+template<typename T>
+FastNumPut::iter_type FastNumPut::put_integer(iter_type s, std::ios_base& str, char_type fill, T v) const
+{
+    using Unsigned = typename std::make_unsigned<T>::type;
+
+    const std::ios_base::fmtflags flags  {str.flags()};
+    const std::ios_base::fmtflags base   {flags & std::ios_base::basefield};
+    const std::ios_base::fmtflags adjust {flags & std::ios_base::adjustfield};
+    const bool hex      {base == std::ios_base::hex};
+    const bool negative {!hex && v < 0}; // hex of negative value is its two's complement
+
+    if(base == std::ios_base::oct ||
+       (flags & (std::ios_base::showbase | std::ios_base::showpos | std::ios_base::uppercase)) ||
+       (negative && adjust == std::ios_base::internal))
+    {
+        return std::num_put<char>::do_put(s, str, fill, v);
+    }
+
+    char buffer[24]; // enough for 64-bit value with sign
+    char* const end {buffer + sizeof(buffer)};
+    char* begin {end};
+
+    Unsigned value {negative ? static_cast<Unsigned>(Unsigned{0} - static_cast<Unsigned>(v))
+                             : static_cast<Unsigned>(v)};
+    if(hex)
+    {
+        do
+        {
+            *--begin = HexDigits[value & 0xF];
+            value >>= 4;
+        }
+        while(value != 0);
+    }
+    else
+    {
+        do
+        {
+            *--begin = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        while(value != 0);
+    }
+    if(negative)
+    {
+        *--begin = '-';
+    }
+
+    const std::streamsize length {end - begin};
+    const std::streamsize width  {str.width()};
+    str.width(0);
+    if(width > length)
+    {
+        if(adjust == std::ios_base::left)
+        {
+            return std::fill_n(std::copy(begin, end, s), width - length, fill);
+        }
+        s = std::fill_n(s, width - length, fill);
+    }
+    return std::copy(begin, end, s);
+}
+
+FastNumPut::iter_type FastNumPut::do_put(iter_type s, std::ios_base& str, char_type fill, long v) const
+{
+    return put_integer(s, str, fill, v);
+}
+
+FastNumPut::iter_type FastNumPut::do_put(iter_type s, std::ios_base& str, char_type fill, unsigned long v) const
+{
+    return put_integer(s, str, fill, v);
+}
+
+FastNumPut::iter_type FastNumPut::do_put(iter_type s, std::ios_base& str, char_type fill, long long v) const
+{
+    return put_integer(s, str, fill, v);
+}
+
+FastNumPut::iter_type FastNumPut::do_put(iter_type s, std::ios_base& str, char_type fill, unsigned long long v) const
+{
+    return put_integer(s, str, fill, v);
+}
+
+void imbue_fast_num_put(std::ostream& out)
+{
+    const std::locale locale {out.getloc()};
+    if(std::use_facet<std::numpunct<char>>(locale).grouping().empty())
+    {
+        out.imbue(std::locale{locale, new FastNumPut});
+    }
+}
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Fast formatting of integers for output streams
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef FAST_NUM_PUT_H
+#define FAST_NUM_PUT_H
+//------------------------------------------------------------------------------
+#include <locale>
+#include <ostream>
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+
+// Converts integers to text by hand instead of generic std::num_put which
+// is slow. Decimal and hex output with width, fill and adjustment are handled
+// here, other flags (showbase, showpos, uppercase, oct) and floating point
+// values are passed to std::num_put, so the output is the same as with
+// the classic locale.
+class FastNumPut : public std::num_put<char>
+{
+public:
+    explicit FastNumPut(std::size_t refs = 0)
+    : std::num_put<char>{refs}
+    {
+    }
+
+protected:
+    iter_type do_put(iter_type s, std::ios_base& str, char_type fill, long v) const override;
+    iter_type do_put(iter_type s, std::ios_base& str, char_type fill, unsigned long v) const override;
+    iter_type do_put(iter_type s, std::ios_base& str, char_type fill, long long v) const override;
+    iter_type do_put(iter_type s, std::ios_base& str, char_type fill, unsigned long long v) const override;
+    using std::num_put<char>::do_put;
+
+private:
+    template<typename T>
+    iter_type put_integer(iter_type s, std::ios_base& str, char_type fill, T v) const;
+};
+
+// Imbues FastNumPut to the stream if its locale does not group digits
+void imbue_fast_num_put(std::ostream& out);
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//FAST_NUM_PUT_H
+//------------------------------------------------------------------------------
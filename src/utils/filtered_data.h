@@ -42,6 +42,7 @@ public:
     NetworkSession* session{nullptr}; // pointer to immutable session in Filtration
     struct timeval  timestamp; // timestamp of last collected packet
     Direction       direction; // direction of data transmission
+    uint64_t        queued{0}; // ticks of Probes when pushed to the queue, 0 if probes are disabled
 
     uint32_t    dlen{0};     // length of filtered data
     uint8_t*    data{cache}; // pointer to data in memory. {Readonly. Always points to proper memory buffer}
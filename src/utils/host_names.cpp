@@ -0,0 +1,284 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Background reverse DNS lookups of session addresses
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <arpa/inet.h> // for ntohs()
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include "utils/host_names.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+namespace // unnamed
+{
+
+using Clock   = std::chrono::steady_clock;
+using Address = HostNames::Address;
+using Status  = HostNames::Status;
+
+const Clock::duration PositiveTTL {std::chrono::hours{1}};
+const Clock::duration NegativeTTL {std::chrono::minutes{5}};
+const std::size_t     MaxRequests {256}; // queued lookups, others are asked later
+
+struct Entry
+{
+    Address           address;
+    Status            status;
+    std::string       name;
+    Clock::time_point expires;
+};
+
+struct AddressHash
+{
+    std::size_t operator()(const Address& a) const
+    {
+        // FNV-1a
+        std::size_t hash {2166136261U};
+        const std::size_t length {a.type == API::Session::IPType::v4 ? 4U : 16U};
+        for(std::size_t i {0}; i < length; ++i)
+        {
+            hash = (hash ^ a.bytes[i]) * 16777619U;
+        }
+        return hash;
+    }
+};
+
+using LRU = std::list<Entry>; // the most recently used entry is the first
+
+std::atomic<bool>       running {false};
+std::atomic<uint64_t>   lookups {0};     // completed
+std::mutex              lock;       // protects fields below
+std::condition_variable requested;
+bool                    stop {false};
+std::size_t             capacity {HostNames::DefaultCapacity};
+HostNames::Resolve      resolve {nullptr};
+LRU                     lru;
+std::unordered_map<Address, LRU::iterator, AddressHash> index;
+std::deque<Address>     requests;
+std::thread             resolver;
+
+std::unordered_map<in_port_t, std::string> services; // read-only while running
+
+// Reads service names of TCP ports like getnameinfo() finds them
+void read_services()
+{
+    setservent(0);
+    while(const servent* entry = getservent())
+    {
+        if(strcmp(entry->s_proto, "tcp") == 0)
+        {
+            services.emplace(static_cast<in_port_t>(entry->s_port), entry->s_name); // the first one wins
+        }
+    }
+    endservent();
+}
+
+bool reverse_lookup(const Address& address, std::string& name)
+{
+    sockaddr_storage storage;
+    socklen_t length {0};
+    memset(&storage, 0, sizeof(storage));
+    if(address.type == API::Session::IPType::v4)
+    {
+        sockaddr_in& addr = reinterpret_cast<sockaddr_in&>(storage);
+        addr.sin_family = AF_INET;
+        memcpy(&addr.sin_addr, address.bytes, sizeof(addr.sin_addr));
+        length = sizeof(addr);
+    }
+    else
+    {
+        sockaddr_in6& addr = reinterpret_cast<sockaddr_in6&>(storage);
+        addr.sin6_family = AF_INET6;
+        memcpy(&addr.sin6_addr, address.bytes, sizeof(addr.sin6_addr));
+        length = sizeof(addr);
+    }
+
+    char hostname[NI_MAXHOST];
+    if(getnameinfo(reinterpret_cast<sockaddr*>(&storage), length,
+                   hostname, sizeof(hostname), nullptr, 0, NI_NAMEREQD) != 0)
+    {
+        return false;
+    }
+    name = hostname;
+    return true;
+}
+
+void run_resolver()
+{
+    std::unique_lock<std::mutex> guard{lock};
+    for(;;)
+    {
+        requested.wait(guard, []{ return stop || !requests.empty(); });
+        if(stop)
+        {
+            break;
+        }
+        const Address address {requests.front()};
+        requests.pop_front();
+
+        guard.unlock();
+        std::string name;
+        const bool found {resolve(address, name)};
+        guard.lock();
+
+        // the entry may be evicted while the lookup was running
+        auto i = index.find(address);
+        if(i != index.end() && i->second->status == Status::Pending)
+        {
+            Entry& entry = *i->second;
+            entry.status  = found ? Status::Resolved : Status::Failed;
+            entry.name    = std::move(name);
+            entry.expires = Clock::now() + (found ? PositiveTTL : NegativeTTL);
+        }
+        lookups.fetch_add(1, std::memory_order_release);
+    }
+}
+
+} // unnamed namespace
+
+HostNames::Address::Address(API::Session::IPType ip_type, const void* address)
+: type {ip_type}
+{
+    memset(bytes, 0, sizeof(bytes));
+    memcpy(bytes, address, type == API::Session::IPType::v4 ? 4 : 16);
+}
+
+bool HostNames::Address::operator==(const Address& other) const
+{
+    return type == other.type && memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+HostNames::Global::Global(bool enabled, std::size_t lru_capacity, Resolve lookup)
+{
+    if(!enabled)
+    {
+        return;
+    }
+    capacity = lru_capacity ? lru_capacity : 1;
+    resolve  = lookup ? lookup : &reverse_lookup;
+    stop     = false;
+    read_services();
+    resolver = std::thread{&run_resolver};
+    running.store(true, std::memory_order_release);
+}
+
+HostNames::Global::~Global()
+{
+    if(!running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    running.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> guard{lock};
+        stop = true;
+    }
+    requested.notify_one();
+    resolver.join(); // waits for the running lookup
+
+    index.clear();
+    lru.clear();
+    requests.clear();
+    services.clear();
+}
+
+bool HostNames::enabled()
+{
+    return running.load(std::memory_order_acquire);
+}
+
+uint64_t HostNames::completed()
+{
+    return lookups.load(std::memory_order_acquire);
+}
+
+HostNames::Status HostNames::find(const Address& address, std::string& name)
+{
+    if(!enabled())
+    {
+        return Status::Disabled;
+    }
+
+    std::lock_guard<std::mutex> guard{lock};
+    const Clock::time_point now {Clock::now()};
+    auto i = index.find(address);
+    if(i != index.end())
+    {
+        Entry& entry = *i->second;
+        lru.splice(lru.begin(), lru, i->second);
+        if(entry.status == Status::Pending || now < entry.expires)
+        {
+            if(entry.status == Status::Resolved)
+            {
+                name = entry.name;
+            }
+            return entry.status;
+        }
+    }
+    if(requests.size() >= MaxRequests)
+    {
+        return Status::Pending; // lookup will be requested by the next call
+    }
+
+    if(i != index.end()) // expired
+    {
+        i->second->status = Status::Pending;
+    }
+    else
+    {
+        lru.push_front(Entry{address, Status::Pending, std::string{}, now});
+        index.emplace(address, lru.begin());
+        if(lru.size() > capacity)
+        {
+            index.erase(lru.back().address);
+            lru.pop_back();
+        }
+    }
+    requests.push_back(address);
+    requested.notify_one();
+    return Status::Pending;
+}
+
+std::string HostNames::service(in_port_t port)
+{
+    auto i = services.find(port);
+    if(i != services.end())
+    {
+        return i->second;
+    }
+    return std::to_string(ntohs(port));
+}
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
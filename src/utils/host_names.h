@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Background reverse DNS lookups of session addresses
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef HOST_NAMES_H
+#define HOST_NAMES_H
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <netinet/in.h> // for in_port_t
+
+#include "api/session.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+
+/*! Reverse DNS lookups without blocking of callers.
+ *  find() answers from a bounded LRU cache. An address which isn't cached
+ *  yet is queued to a background thread and reported as pending, so the
+ *  caller uses the numeric address and asks again later. Failed lookups
+ *  are cached too (negative caching), entries expire after a TTL.
+ *  Service names of TCP ports are read once by Global.
+ */
+class HostNames
+{
+public:
+    enum class Status
+    {
+        Disabled,   // lookups are off
+        Pending,    // lookup is queued or running
+        Resolved,   // name is found
+        Failed      // address has no name
+    };
+
+    struct Address
+    {
+        Address(API::Session::IPType type, const void* address);
+
+        bool operator==(const Address& other) const;
+
+        API::Session::IPType type;
+        uint8_t bytes[16];  // network byte order, IPv4 takes the first 4 bytes
+    };
+
+    // blocking lookup, called by the background thread
+    using Resolve = bool (*)(const Address& address, std::string& name);
+
+    static const std::size_t DefaultCapacity {4096};
+
+    // helper for creation and destruction of the background thread
+    // isn't thread-safe!
+    struct Global
+    {
+        explicit Global(bool enabled, std::size_t capacity = DefaultCapacity, Resolve resolve = nullptr);
+        ~Global();
+        Global(const Global&)            = delete;
+        Global& operator=(const Global&) = delete;
+    };
+
+    HostNames() = delete;
+
+    static bool enabled();
+
+    // never blocks, name is set for Status::Resolved only
+    static Status find(const Address& address, std::string& name);
+
+    // amount of lookups completed by the background thread, a pending
+    // address may be found only after it has changed
+    static uint64_t completed();
+
+    // service name of port in network byte order or its number
+    static std::string service(in_port_t port);
+};
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//HOST_NAMES_H
+//------------------------------------------------------------------------------
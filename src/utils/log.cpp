@@ -20,13 +20,20 @@
 */
 //------------------------------------------------------------------------------
 #include <cerrno>
-#include <cstdarg>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <system_error>
+#include <thread>
+#include <vector>
 
+#include <pthread.h>
 #include <sys/file.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -55,6 +62,363 @@ static bool  own_file {false};
 namespace // unnanmed
 {
 
+using Record = Log::Record;
+
+static_assert(sizeof(Record) == 256, "Record of log must fill 4 cache lines");
+
+const uint32_t Truncated     {0xFFFFFFFF}; // offset of a string which didn't fit
+const uint64_t RingCapacity  {512};        // records of a thread
+const uint32_t MaxRawLength  {sizeof(Record::strings)};
+const std::chrono::milliseconds WritePeriod {20};
+
+// Single producer - single consumer ring of records of a thread
+struct Ring
+{
+    std::atomic<uint64_t> head {0};             // read by the writer
+    char                  padding[56];          // head and tail are in different cache lines
+    std::atomic<uint64_t> tail {0};             // written by the owner
+    std::atomic<uint64_t> dropped {0};          // records dropped by the owner
+    std::atomic<bool>     taken   {false};      // ring has an owner thread
+    uint64_t              reported {0};         // dropped records reported by the writer
+    Record                records[RingCapacity];
+};
+
+std::atomic<bool>     async    {false}; // the writer is running
+std::atomic<uint64_t> sequence {0};
+
+std::mutex rings_lock;                  // protects rings
+std::vector<std::unique_ptr<Ring>> rings;
+
+std::mutex file_lock;                   // protects log_file from reopen() while writing
+
+std::thread             writer;
+std::mutex              writer_lock;    // protects fields below
+std::condition_variable writer_cv;
+bool                    writer_stop {false};
+uint64_t                flush_requested {0};
+uint64_t                flush_done {0};
+
+// Releases the ring on exit of its thread, so rings are reused by new threads
+struct Owner
+{
+    ~Owner()
+    {
+        if(ring)
+        {
+            ring->taken.store(false, std::memory_order_release);
+        }
+    }
+    Ring* ring {nullptr};
+};
+
+thread_local Owner owner;
+thread_local Record scratch;            // record written synchronously
+
+Ring* attach()
+{
+    std::lock_guard<std::mutex> lock{rings_lock};
+    for(auto& r : rings)
+    {
+        bool expected {false};
+        if(r->taken.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        {
+            return owner.ring = r.get();
+        }
+    }
+    rings.emplace_back(new Ring);
+    rings.back()->taken.store(true, std::memory_order_relaxed);
+    return owner.ring = rings.back().get();
+}
+
+// Returns free record of the ring of the calling thread or nullptr if it is full
+Record* slot()
+{
+    Ring* ring {owner.ring ? owner.ring : attach()};
+    const uint64_t tail {ring->tail.load(std::memory_order_relaxed)};
+    if(tail - ring->head.load(std::memory_order_acquire) == RingCapacity)
+    {
+        ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &ring->records[tail % RingCapacity];
+}
+
+// Returns the ring of the calling thread if it has count free records,
+// otherwise they are counted as dropped
+Ring* room(uint64_t count)
+{
+    Ring* ring {owner.ring ? owner.ring : attach()};
+    const uint64_t used {ring->tail.load(std::memory_order_relaxed) - ring->head.load(std::memory_order_acquire)};
+    if(used + count > RingCapacity)
+    {
+        ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return ring;
+}
+
+void publish(uint64_t count = 1)
+{
+    Ring* ring {owner.ring};
+    ring->tail.store(ring->tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
+
+uint64_t coarse_second()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return static_cast<uint64_t>(now.tv_sec);
+}
+
+bool admit(Log::Site& site, uint32_t& suppressed)
+{
+    const uint64_t second {coarse_second()};
+    if(site.second.load(std::memory_order_relaxed) != second)
+    {
+        site.second.store(second, std::memory_order_relaxed);
+        site.amount.store(0, std::memory_order_relaxed);
+    }
+    if(site.amount.fetch_add(1, std::memory_order_relaxed) >= Log::Site::MaxPerSecond)
+    {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+// Appends argument formatted by printf conversion specification.
+// Length modifiers of the specification are replaced by ones of the stored type.
+void append(std::string& out, std::string& spec, char conversion, const Record& record, uint8_t i)
+{
+    char buffer[128];
+    int length {0};
+    const Record::Value& value = record.values[i];
+    switch(record.types[i])
+    {
+    case Record::Signed:
+    case Record::Unsigned:
+        if(conversion == 'c')
+        {
+            spec += 'c';
+            length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(value.i));
+            break;
+        }
+        if(!strchr("diouxX", conversion))
+        {
+            conversion = record.types[i] == Record::Signed ? 'd' : 'u';
+        }
+        spec += "ll";
+        spec += conversion;
+        if(record.types[i] == Record::Signed)
+        {
+            length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<long long>(value.i));
+        }
+        else
+        {
+            length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(value.u));
+        }
+        break;
+    case Record::Double:
+        spec += strchr("eEfFgGaA", conversion) ? conversion : 'g';
+        length = snprintf(buffer, sizeof(buffer), spec.c_str(), value.d);
+        break;
+    case Record::String:
+        spec += 's';
+        length = snprintf(buffer, sizeof(buffer), spec.c_str(),
+                          value.offset == Truncated ? "..." : record.strings + value.offset);
+        if(length >= static_cast<int>(sizeof(buffer)))
+        {
+            // wide strings are not cut by the buffer
+            out.append(record.strings + value.offset);
+            return;
+        }
+        break;
+    case Record::Pointer:
+        spec += 'p';
+        length = snprintf(buffer, sizeof(buffer), spec.c_str(), value.p);
+        break;
+    }
+    if(length > 0)
+    {
+        out.append(buffer, std::min(static_cast<std::size_t>(length), sizeof(buffer) - 1));
+    }
+}
+
+// Formats record as printf() with its format and arguments
+void format(const Record& record, std::string& out)
+{
+    if(record.format == nullptr)
+    {
+        out.append(record.strings, record.used);
+        return;
+    }
+
+    std::string spec;
+    uint8_t arg {0};
+    for(const char* p {record.format}; *p; ++p)
+    {
+        if(*p != '%')
+        {
+            out += *p;
+            continue;
+        }
+        if(p[1] == '%')
+        {
+            out += '%';
+            ++p;
+            continue;
+        }
+        const char* begin {p++};
+        while(*p && strchr("-+ #0", *p)) ++p;
+        while(*p && ((*p >= '0' && *p <= '9') || *p == '.')) ++p;
+        spec.assign(begin, p);
+        while(*p && strchr("hljztL", *p)) ++p;
+        if(*p == '\0' || arg == record.amount)
+        {
+            // no conversion or argument, keep the text as is
+            out.append(begin, *p ? p + 1 : p);
+            if(*p == '\0') break;
+            continue;
+        }
+        append(out, spec, *p, record, arg++);
+    }
+    if(record.suppressed)
+    {
+        out += " (";
+        out += std::to_string(record.suppressed);
+        out += " similar messages were suppressed)";
+    }
+    out += '\n';
+}
+
+void write_out(const std::string& out)
+{
+    if(!out.empty())
+    {
+        fwrite(out.data(), out.size(), 1, log_file);
+    }
+}
+
+// Writes records of all rings in order of their sequence numbers.
+// Records published after the call are left for the next one.
+void drain(std::string& out)
+{
+    std::vector<std::pair<Ring*, uint64_t>> pending; // ring and its tail
+    {
+        std::lock_guard<std::mutex> lock{rings_lock};
+        for(auto& r : rings)
+        {
+            pending.emplace_back(r.get(), r->tail.load(std::memory_order_acquire));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock{file_lock};
+    for(;;)
+    {
+        Ring* next {nullptr};
+        const Record* first {nullptr};
+        for(auto& p : pending)
+        {
+            const uint64_t head {p.first->head.load(std::memory_order_relaxed)};
+            if(head != p.second)
+            {
+                const Record* r {&p.first->records[head % RingCapacity]};
+                if(first == nullptr || r->seq < first->seq)
+                {
+                    first = r;
+                    next  = p.first;
+                }
+            }
+        }
+        if(next == nullptr)
+        {
+            break;
+        }
+        format(*first, out);
+        next->head.store(next->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        if(out.size() >= 64 * 1024)
+        {
+            write_out(out);
+            out.clear();
+        }
+    }
+    for(auto& p : pending)
+    {
+        const uint64_t dropped {p.first->dropped.load(std::memory_order_relaxed)};
+        if(dropped != p.first->reported)
+        {
+            out += std::to_string(dropped - p.first->reported);
+            out += " log messages were dropped: ring of a thread is full\n";
+            p.first->reported = dropped;
+        }
+    }
+    write_out(out);
+    if(!out.empty())
+    {
+        fflush(log_file);
+        out.clear();
+    }
+}
+
+void run_writer()
+{
+    std::string out;
+    std::unique_lock<std::mutex> lock{writer_lock};
+    for(;;)
+    {
+        writer_cv.wait_for(lock, WritePeriod, []{ return writer_stop || flush_requested != flush_done; });
+        const bool stop {writer_stop};
+        const uint64_t request {flush_requested};
+        lock.unlock();
+
+        drain(out);
+        if(request != flush_done)
+        {
+            std::lock_guard<std::mutex> file{file_lock};
+            fflush(log_file);
+        }
+
+        lock.lock();
+        flush_done = request;
+        writer_cv.notify_all();
+        if(stop)
+        {
+            break;
+        }
+    }
+}
+
+// The writer thread doesn't exist in a forked child
+void disable_async_in_child()
+{
+    async.store(false, std::memory_order_release);
+}
+
+void start_writer()
+{
+    static std::once_flag atfork;
+    std::call_once(atfork, []{ pthread_atfork(nullptr, nullptr, &disable_async_in_child); });
+
+    writer_stop = false;
+    writer = std::thread{&run_writer};
+    async.store(true, std::memory_order_release);
+}
+
+void stop_writer()
+{
+    async.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock{writer_lock};
+        writer_stop = true;
+    }
+    writer_cv.notify_all();
+    writer.join();
+
+    std::string out;
+    drain(out); // records published after the last round
+}
+
 static FILE* try_open(const std::string& file_name)
 {
     FILE* file = fopen(file_name.c_str(), "a+");
@@ -112,6 +476,7 @@ Log::Global::Global(const std::string& path)
 
     log_file = try_open(log_file_path);
     own_file = true;
+    start_writer();
 
     if(utils::Out message{})
     {
@@ -123,6 +488,7 @@ Log::Global::~Global()
 {
     if(own_file)
     {
+        stop_writer();
         flock(fileno(log_file), LOCK_UN);
         fclose(log_file);
         own_file = false;
@@ -134,6 +500,7 @@ void Log::Global::reopen()
 {
     if(!own_file || log_file == ::stderr || log_file == ::stdout || log_file == nullptr)
         return;
+    std::lock_guard<std::mutex> lock{file_lock};
     FILE* temp = freopen(log_file_path.c_str(), "a+", log_file);
     if(temp == nullptr)
     {
@@ -143,32 +510,125 @@ void Log::Global::reopen()
     log_file = temp;
 }
 
-Log::Log()
+Log::Log(Site& site)
 : std::stringbuf {ios_base::out}
 , std::ostream   {nullptr}
+, admitted       {admit(site, suppressed)}
 {
-    std::stringbuf::setp(buffer, buffer+sizeof(buffer));
     std::ostream::init(static_cast<std::stringbuf*>(this));
+    if(!admitted)
+    {
+        setstate(std::ios_base::badbit);
+        return;
+    }
     std::ostream::put('\n');
 }
 
 Log::~Log()
 {
-    size_t len = pptr() - pbase();
-    fwrite(pbase(), len, 1, log_file);
+    if(!admitted)
+    {
+        return;
+    }
+    std::string text {str()};
+    if(suppressed)
+    {
+        text += " (" + std::to_string(suppressed) + " similar messages were suppressed)";
+    }
+    if(!async.load(std::memory_order_acquire))
+    {
+        fwrite(text.data(), text.size(), 1, log_file);
+        return;
+    }
+    // text is passed by raw records, all of them or none
+    const uint64_t records {(text.size() + MaxRawLength - 1) / MaxRawLength};
+    Ring* ring {room(records)};
+    if(ring == nullptr)
+    {
+        return;
+    }
+    // records get consecutive numbers and are published together,
+    // so the writer can't put records of other threads between them
+    uint64_t seq {sequence.fetch_add(records, std::memory_order_relaxed)};
+    uint64_t tail {ring->tail.load(std::memory_order_relaxed)};
+    for(std::size_t pos {0}; pos < text.size(); pos += MaxRawLength)
+    {
+        const std::size_t length {std::min<std::size_t>(text.size() - pos, MaxRawLength)};
+        Record& record = ring->records[tail++ % RingCapacity];
+        record.seq        = seq++;
+        record.format     = nullptr;
+        record.suppressed = 0;
+        record.amount     = 0;
+        record.used       = static_cast<uint16_t>(length);
+        memcpy(record.strings, text.data() + pos, length);
+    }
+    publish(records);
+}
+
+Log::Record* Log::reserve(Site& site, const char* format)
+{
+    uint32_t suppressed {0};
+    if(!admit(site, suppressed))
+    {
+        return nullptr;
+    }
+    Record* record {async.load(std::memory_order_acquire) ? slot() : &scratch};
+    if(record)
+    {
+        record->seq        = sequence.fetch_add(1, std::memory_order_relaxed);
+        record->format     = format;
+        record->suppressed = suppressed;
+        record->used       = 0;
+        record->amount     = 0;
+    }
+    return record;
 }
 
-void Log::message(const char* format, ...)
+void Log::commit(Record* record)
 {
-    va_list args;
-    va_start(args, format);
-    vfprintf(log_file, format, args);
-    va_end(args);
+    if(record != &scratch)
+    {
+        publish();
+        return;
+    }
+    std::string out;
+    format(*record, out);
+    write_out(out);
+}
+
+void Log::copy(Record& record, const char* string)
+{
+    const uint8_t i {record.amount++};
+    record.types[i] = Record::String;
+
+    const std::size_t free {sizeof(record.strings) - record.used};
+    if(free == 0)
+    {
+        record.values[i].offset = Truncated;
+        return;
+    }
+    if(string == nullptr)
+    {
+        string = "(null)";
+    }
+    const std::size_t length {std::min(strlen(string), free - 1)};
+    memcpy(record.strings + record.used, string, length);
+    record.strings[record.used + length] = '\0';
+    record.values[i].offset = record.used;
+    record.used = static_cast<uint16_t>(record.used + length + 1);
 }
 
 void Log::flush()
 {
-    fflush(log_file);
+    if(!async.load(std::memory_order_acquire))
+    {
+        fflush(log_file);
+        return;
+    }
+    std::unique_lock<std::mutex> lock{writer_lock};
+    const uint64_t ticket {++flush_requested};
+    writer_cv.notify_all();
+    writer_cv.wait(lock, [ticket]{ return flush_done >= ticket || writer_stop; });
 }
 
 } // namespace utils
@@ -22,25 +22,25 @@
 #ifndef LOG_H
 #define LOG_H
 //------------------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
 #include <sstream>
+#include <type_traits>
 //------------------------------------------------------------------------------
 #ifdef NDEBUG
 #define TRACE(...)
 #else
 #define STRINGIZE(x) DO_STRINGIZE(x)
 #define DO_STRINGIZE(x) #x
-// TODO: DANGEROUS MACRO ! Passing custom client string as format to printf().
-// May be cause of SIGSEGV
 #define TRACE(...) {\
-    NST::utils::Log::message(__FILE__ ":" STRINGIZE(__LINE__) ": " __VA_ARGS__);\
-    NST::utils::Log::message("\n");\
-    NST::utils::Log::flush();\
+    static NST::utils::Log::Site log_site;\
+    NST::utils::Log::message(log_site, __FILE__ ":" STRINGIZE(__LINE__) ": " __VA_ARGS__);\
 }
 #endif
 
 #define LOG(...) {\
-    NST::utils::Log::message(__VA_ARGS__);\
-    NST::utils::Log::message("\n");\
+    static NST::utils::Log::Site log_site;\
+    NST::utils::Log::message(log_site, __VA_ARGS__);\
 }
 
 #define LOGONCE(...) {\
@@ -53,6 +53,18 @@ namespace NST
 namespace utils
 {
 
+/*! Asynchronous logger.
+ *  LOG() and TRACE() don't format anything in the calling thread: a record
+ *  with the format string and copies of arguments is put to a lock-free ring
+ *  of the thread and a background thread of Log::Global formats records of
+ *  all rings in order of calls and writes them to the log file.
+ *  If a ring is full, the record is dropped and counted. Each call site
+ *  writes at most Site::MaxPerSecond records per second, the amount of
+ *  suppressed ones is appended to the next written record of the site.
+ *  Stream messages of Log are formatted by the caller and follow the same
+ *  rules: a message which doesn't fit the ring is dropped whole.
+ *  Until Log::Global is created records are written synchronously.
+ */
 class Log : private std::stringbuf, public std::ostream
 {
 public:
@@ -69,16 +81,127 @@ public:
         std::string log_file_path;
     };
 
-    Log();
+    // state of a call site for rate limiting, zero-initialized as static
+    struct Site
+    {
+        static const uint32_t MaxPerSecond {100};
+
+        std::atomic<uint64_t> second;     // current second of CLOCK_MONOTONIC_COARSE
+        std::atomic<uint32_t> amount;     // records of the current second
+        std::atomic<uint32_t> suppressed; // records suppressed since the last written one
+    };
+
+    // binary record of a message, formatted by the background thread
+    struct Record
+    {
+        enum Type : uint8_t
+        {
+            Signed,
+            Unsigned,
+            Double,
+            String,
+            Pointer
+        };
+
+        union Value
+        {
+            int64_t     i;
+            uint64_t    u;
+            double      d;
+            const void* p;
+            uint32_t    offset; // of a copied string in strings
+        };
+
+        static const uint32_t MaxArgs {8};
+
+        uint64_t    seq;        // order of calls in all threads
+        const char* format;     // nullptr for raw text in strings
+        uint32_t    suppressed;
+        uint16_t    used;       // bytes of strings
+        uint8_t     amount;     // of arguments
+        uint8_t     reserved;
+        Type        types[MaxArgs];
+        Value       values[MaxArgs];
+        char        strings[160];
+    };
+
+    // stream message of a call site, disabled if the site is rate limited
+    explicit Log(Site& site);
     ~Log();
     Log(const Log&)            = delete;
     Log& operator=(const Log&) = delete;
 
-    // lightweight logging
-    static void message(const char* format, ...);
+    // lightweight logging, arguments are copied to a binary record
+    template<typename... Args>
+    static inline void message(Site& site, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= Record::MaxArgs, "Too many arguments of log message");
+        if(Record* record = reserve(site, format))
+        {
+            pack(*record, args...);
+            commit(record);
+        }
+    }
+
+    // wait until all records are written and flush the log file
     static void flush();
 private:
-    char buffer[256];
+    uint32_t suppressed {0}; // by the site before the stream message
+    bool     admitted   {false};
+
+    static Record* reserve(Site& site, const char* format);
+    static void commit(Record* record);
+    static void copy(Record& record, const char* string);
+
+    static inline void pack(Record&)
+    {
+    }
+
+    template<typename T, typename... Args>
+    static inline void pack(Record& record, const T& arg, const Args&... args)
+    {
+        put(record, arg);
+        pack(record, args...);
+    }
+
+    static inline void put(Record& record, const char* string)
+    {
+        copy(record, string);
+    }
+
+    template<typename T>
+    static inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+    put(Record& record, T arg)
+    {
+        const uint8_t i {record.amount++};
+        if(std::is_signed<T>::value)
+        {
+            record.types[i] = Record::Signed;
+            record.values[i].i = static_cast<int64_t>(arg);
+        }
+        else
+        {
+            record.types[i] = Record::Unsigned;
+            record.values[i].u = static_cast<uint64_t>(arg);
+        }
+    }
+
+    template<typename T>
+    static inline typename std::enable_if<std::is_floating_point<T>::value>::type
+    put(Record& record, T arg)
+    {
+        const uint8_t i {record.amount++};
+        record.types[i] = Record::Double;
+        record.values[i].d = static_cast<double>(arg);
+    }
+
+    template<typename T>
+    static inline void put(Record& record, const T* arg)
+    {
+        const uint8_t i {record.amount++};
+        record.types[i] = Record::Pointer;
+        record.values[i].p = arg;
+    }
 };
 
 } // namespace utils
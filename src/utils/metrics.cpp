@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Counters, gauges and histograms of nfstrace internals
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <string>
+
+#include "utils/metrics.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+namespace // unnamed
+{
+
+using Stat = API::MetricsStat;
+
+std::mutex mutex;                   // protects registration
+std::deque<std::string> strings;    // storage of names and help of defined metrics
+
+const char* store(const char* s)
+{
+    strings.emplace_back(s);
+    return strings.back().c_str();
+}
+
+} // unnamed namespace
+
+Stat Metrics::stat;
+thread_local Stat::Shard* Metrics::local {nullptr};
+
+// Fixed metrics take the first ids in order of Metrics::Metric
+static const uint32_t fixed_metrics[]
+{
+    Metrics::define("queue_elements",    "Elements of the queue being filled, queued or parsed.", Stat::Type::Gauge),
+    Metrics::define("queue_free_chunks", "Free chunks of the queue allocator.", Stat::Type::Gauge),
+    Metrics::define("queue_exhausted",   "Failed allocations of elements of the queue.", Stat::Type::Counter),
+    Metrics::define("sessions",          "TCP and UDP flows tracked by filtration.", Stat::Type::Gauge),
+    Metrics::define("tcp_fragments",     "Out of order TCP segments buffered by reassembly.", Stat::Type::Gauge),
+    Metrics::define("tcp_lost_bytes",    "Bytes missed in captured TCP streams.", Stat::Type::Counter),
+    Metrics::define("xdr_errors",        "RPC messages which were not decoded.", Stat::Type::Counter),
+    Metrics::define("message_bytes",     "Size of messages passed to the queue.", Stat::Type::Histogram),
+    Metrics::define("parsing_round",     "Messages taken from the queue by a parsing round.", Stat::Type::Histogram),
+    Metrics::define("dump_dropped",      "Packets dropped by dumping as the writer is behind.", Stat::Type::Counter),
+    Metrics::define("kernel_drops",      "Packets dropped by kernel.", Stat::Type::Counter),
+    Metrics::define("interface_drops",   "Packets dropped by network interface.", Stat::Type::Counter),
+    Metrics::define("rpc_retransmits",   "Requests sent again with the same RPC XID, CIFS sequence number or SMB2 MessageId.", Stat::Type::Counter),
+    Metrics::define("procedures",        "RPC procedures and SMB commands passed to analyzers.", Stat::Type::Counter),
+};
+
+uint32_t Metrics::define(const char* name, const char* help, Stat::Type type)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    const uint32_t id {stat.registered.load(std::memory_order_relaxed)};
+    for(uint32_t i {0}; i < id; ++i)
+    {
+        if(std::strcmp(stat.descriptors[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    if(id == Stat::MaxMetrics)
+    {
+        return id - 1;
+    }
+    stat.descriptors[id] = Stat::Descriptor{store(name), store(help), type};
+    stat.registered.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+void Metrics::print(std::ostream& out)
+{
+    Stat::Snapshot s;
+    stat.snapshot(s);
+
+    std::size_t width {24};
+    for(uint32_t i {0}; i < s.size; ++i)
+    {
+        width = std::max(width, std::strlen(s.metrics[i].name) + 2);
+    }
+
+    out << "Metrics:\n"
+        << std::left  << std::setw(width) << "metric"
+        << std::right << std::setw(14) << "value"
+        << std::setw(14) << "count"
+        << std::setw(12) << "mean"
+        << std::setw(12) << "p50"
+        << std::setw(12) << "p99" << '\n'
+        << std::fixed << std::setprecision(1);
+
+    for(uint32_t i {0}; i < s.size; ++i)
+    {
+        const Stat::Metric& m = s.metrics[i];
+        out << std::left  << std::setw(width) << m.name
+            << std::right << std::setw(14) << m.value;
+        if(m.type == Stat::Type::Histogram)
+        {
+            out << std::setw(14) << m.count
+                << std::setw(12) << m.mean()
+                << std::setw(12) << m.quantile(0.5)
+                << std::setw(12) << m.quantile(0.99);
+        }
+        out << '\n';
+    }
+    out << std::flush;
+}
+
+Stat::Shard* Metrics::attach()
+{
+    const uint32_t n {stat.shards.fetch_add(1, std::memory_order_acq_rel)};
+    local = &stat.shard[std::min(n, Stat::MaxShards - 1)];
+    return local;
+}
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Counters, gauges and histograms of nfstrace internals
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef METRICS_H
+#define METRICS_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <ostream>
+
+#include "api/metrics_stat.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+
+/*! Registry of metrics of the pipeline health.
+ *  Metrics are always on: an update is a relaxed load and store to the shard
+ *  of the calling thread, nothing is locked or allocated in hot paths.
+ *  Snapshots are passed to analyzers by IAnalyzer::on_pipeline_metrics().
+ */
+class Metrics
+{
+    using Stat = API::MetricsStat;
+public:
+    enum Metric : uint32_t
+    {
+        QueueElements = 0,  // gauge: elements of the queue being filled, queued or parsed
+        QueueFreeChunks,    // gauge: BlockAllocator::free_chunks() of the queue
+        QueueExhausted,     // counter: failed allocations of elements of the queue
+        Sessions,           // gauge: TCP and UDP flows tracked by filtration
+        TCPFragments,       // gauge: out of order TCP segments buffered by reassembly
+        TCPLostBytes,       // counter: bytes missed in captured TCP streams
+        XDRErrors,          // counter: RPC messages which were not decoded
+        MessageBytes,       // histogram: size of messages passed to the queue
+        ParsingRound,       // histogram: messages taken from the queue by a parsing round
+        DumpDropped,        // counter: packets dropped by dumping as the writer is behind
+        KernelDrops,        // counter: packets dropped by kernel (online capture only)
+        InterfaceDrops,     // counter: packets dropped by network interface
+        Retransmits,        // counter: RPC Calls or CIFS requests sent again with the same id
+        Procedures,         // counter: RPC procedures and SMB commands passed to analyzers
+        Count
+    };
+
+    //! Increases counter or gauge, gauges may be decreased
+    static inline void add(uint32_t metric, int64_t delta)
+    {
+        Stat::Shard& s = shard();
+        update(s.metrics[metric].value, delta, shared(s));
+    }
+
+    //! Records value to histogram
+    static inline void record(uint32_t metric, uint64_t value)
+    {
+        Stat::Shard& s = shard();
+        Stat::Cell& c = s.metrics[metric];
+        const bool atomically {shared(s)};
+
+        const uint32_t bucket {value ? 63U - static_cast<uint32_t>(__builtin_clzll(value)) : 0U};
+        update(c.buckets[bucket < Stat::Buckets ? bucket : Stat::Buckets - 1], uint64_t{1}, atomically);
+        update(c.count, uint64_t{1}, atomically);
+        update(c.value, static_cast<int64_t>(value), atomically);
+    }
+
+    //! Registers a metric, returns its id
+    static uint32_t define(const char* name, const char* help, Stat::Type type);
+    //! Prints snapshot of all metrics
+    static void print(std::ostream& out);
+
+    static inline const Stat& statistic()
+    {
+        return stat;
+    }
+
+private:
+    template<typename T>
+    static inline void update(std::atomic<T>& a, T delta, bool shared)
+    {
+        if(shared)
+        {
+            a.fetch_add(delta, std::memory_order_relaxed);
+        }
+        else // only this thread writes to the shard
+        {
+            a.store(a.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+    }
+
+    static inline Stat::Shard& shard()
+    {
+        return *(local ? local : attach());
+    }
+
+    //! The last shard is shared by threads beyond the limit
+    static inline bool shared(const Stat::Shard& s)
+    {
+        return &s == &stat.shard[Stat::MaxShards - 1];
+    }
+
+    static Stat::Shard* attach();
+
+    static Stat stat;
+    static thread_local Stat::Shard* local;
+};
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//METRICS_H
+//------------------------------------------------------------------------------
@@ -27,6 +27,7 @@ namespace utils
 {
 
 static Out::Level global = Out::Level::Info;
+static thread_local std::streambuf* preceding {nullptr};
 
 Out::Global::Global(const Level verbose_level)
 {
@@ -46,9 +47,22 @@ void Out::Global::set_level(Out::Level l)
     global = l;
 }
 
+Out::Preceding::Preceding(std::streambuf* buffer)
+{
+    preceding = buffer;
+}
+Out::Preceding::~Preceding()
+{
+    preceding = nullptr;
+}
+
 Out::Out(Level level)
 : std::ostream{ (global >= level) ? std::cout.rdbuf() : nullptr }
 {
+    if(preceding && rdbuf())
+    {
+        preceding->pubsync();
+    }
 }
 Out::~Out()
 {
@@ -51,6 +51,16 @@ public:
         static void set_level(Level); // set global level of verbosity
     };
 
+    // helper for registration of output buffered by current thread (e.g. trace
+    // collected in blocks) which is flushed before messages of this thread
+    struct Preceding
+    {
+        explicit Preceding(std::streambuf* buffer);
+        ~Preceding();
+        Preceding(const Preceding&)            = delete;
+        Preceding& operator=(const Preceding&) = delete;
+    };
+
     explicit Out(Level level=Level::Info);   // verbose level of message
     ~Out();
     Out(const Out&)            = delete;
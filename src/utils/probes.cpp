@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Low-overhead latency probes of pipeline stages
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <string>
+
+#include "utils/probes.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+namespace // unnamed
+{
+
+using ProbeStat = API::ProbeStat;
+
+// Duration of the initial calibration of ticks, ns
+const uint64_t CalibrationPeriod {10000000};
+
+std::mutex mutex;               // protects registration and calibration
+std::deque<std::string> names;  // storage of names of added probes
+ProbeStat::Shard discard;       // shard of threads beyond the limit
+uint64_t anchor_ticks {0};
+uint64_t anchor_ns    {0};
+
+uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // unnamed namespace
+
+ProbeStat Probes::stat;
+thread_local ProbeStat::Shard* Probes::local {nullptr};
+
+// Fixed probes take the first ids in order of Probes::Probe
+static const uint32_t fixed_probes[]
+{
+    Probes::add("capture"),
+    Probes::add("reassembly"),
+    Probes::add("framing"),
+    Probes::add("queue_wait"),
+    Probes::add("xdr_decode"),
+};
+
+void Probes::enable()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        anchor_ns    = monotonic_ns();
+        anchor_ticks = now();
+    }
+    while(monotonic_ns() - anchor_ns < CalibrationPeriod)
+    {
+        // busy wait is more precise than sleep
+    }
+    calibrate();
+    stat.enabled.store(true, std::memory_order_relaxed);
+}
+
+uint32_t Probes::add(const char* name)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    const uint32_t id {stat.probes.load(std::memory_order_relaxed)};
+    for(uint32_t i {0}; i < id; ++i)
+    {
+        if(names[i] == name) // e.g. plugin is loaded again
+        {
+            return i;
+        }
+    }
+    if(id == ProbeStat::MaxProbes)
+    {
+        return id - 1;
+    }
+    names.emplace_back(name);
+    stat.names[id] = names.back().c_str();
+    stat.probes.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+void Probes::print(std::ostream& out)
+{
+    calibrate();
+
+    const uint32_t amount {stat.size()};
+    std::size_t width {32};
+    for(uint32_t i {0}; i < amount; ++i)
+    {
+        width = std::max(width, std::strlen(stat.names[i]) + 2);
+    }
+
+    out << "Probes (ns):\n"
+        << std::left  << std::setw(width) << "probe"
+        << std::right << std::setw(14) << "count"
+        << std::setw(12) << "mean"
+        << std::setw(12) << "p50"
+        << std::setw(12) << "p99"
+        << std::setw(12) << "max" << '\n'
+        << std::fixed << std::setprecision(0);
+
+    ProbeStat::Summary s;
+    for(uint32_t i {0}; i < amount; ++i)
+    {
+        stat.summary(i, s);
+        if(s.count == 0)
+        {
+            continue;
+        }
+        out << std::left  << std::setw(width) << s.name
+            << std::right << std::setw(14) << s.count
+            << std::setw(12) << s.mean_ns()
+            << std::setw(12) << s.quantile_ns(0.5)
+            << std::setw(12) << s.quantile_ns(0.99)
+            << std::setw(12) << s.max_ns << '\n';
+    }
+    out << std::flush;
+}
+
+ProbeStat::Shard* Probes::attach()
+{
+    const uint32_t n {stat.shards.fetch_add(1, std::memory_order_acq_rel)};
+    local = (n < ProbeStat::MaxShards) ? &stat.shard[n] : &discard;
+    return local;
+}
+
+void Probes::calibrate()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // Ticks of TSC are measured against CLOCK_MONOTONIC_RAW since enable(),
+    // the longer period the more precise ratio
+    std::lock_guard<std::mutex> lock{mutex};
+    const uint64_t ns    {monotonic_ns()};
+    const uint64_t ticks {now()};
+    if(anchor_ns && ticks > anchor_ticks && ns > anchor_ns)
+    {
+        stat.ns_per_tick.store(static_cast<double>(ns - anchor_ns) / (ticks - anchor_ticks),
+                               std::memory_order_relaxed);
+    }
+#endif
+}
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
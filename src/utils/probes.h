@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Low-overhead latency probes of pipeline stages
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#ifndef PROBES_H
+#define PROBES_H
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <ostream>
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "api/probe_stat.h"
+//------------------------------------------------------------------------------
+namespace NST
+{
+namespace utils
+{
+
+/*! Latency probes of hot paths.
+ *  Probes are disabled by default: then a Scope costs one relaxed load and
+ *  a branch. When enabled, time is read by rdtsc (CLOCK_MONOTONIC_RAW on
+ *  other architectures) and recorded to a fixed-size log-histogram in the
+ *  shard of the calling thread, nothing is allocated in hot paths.
+ *  Nested scopes are measured inclusively.
+ */
+class Probes
+{
+public:
+    enum Probe : uint32_t
+    {
+        Capture = 0,    // capture callback of a packet
+        Reassembly,     // TCP reassembly of a packet
+        Framing,        // search of RPC/SMB messages in reassembled data
+        QueueWait,      // time of a message in the queue between filtration and parser
+        XDRDecode,      // decoding of NFS call and reply
+        Count           // plugin dispatch probes are registered by add()
+    };
+
+    //! Measures lifetime of the scope by a probe
+    class Scope
+    {
+    public:
+        explicit inline Scope(uint32_t p)
+        : probe{p}
+        , start{enabled() ? now() : 0}
+        {
+        }
+        inline ~Scope()
+        {
+            if(start)
+            {
+                record(probe, now() - start);
+            }
+        }
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        const uint32_t probe;
+        const uint64_t start;
+    };
+
+    static inline bool enabled()
+    {
+        return stat.enabled.load(std::memory_order_relaxed);
+    }
+
+    //! Current time in ticks
+    static inline uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+    }
+
+    static inline void record(uint32_t probe, uint64_t ticks)
+    {
+        API::ProbeStat::Histogram& h = (local ? local : attach())->probes[probe];
+
+        // Only this thread writes to the shard
+        const uint32_t bucket {ticks ? 63U - static_cast<uint32_t>(__builtin_clzll(ticks)) : 0U};
+        auto& b = h.buckets[bucket < API::ProbeStat::Buckets ? bucket : API::ProbeStat::Buckets - 1];
+        b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        h.count.store(h.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        h.ticks.store(h.ticks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+        if(ticks > h.max.load(std::memory_order_relaxed))
+        {
+            h.max.store(ticks, std::memory_order_relaxed);
+        }
+    }
+
+    //! Calibrates ticks and starts recording
+    static void enable();
+    //! Registers a probe (e.g. dispatch to a plugin), returns its id
+    static uint32_t add(const char* name);
+    //! Prints summaries of all probes which have recorded something
+    static void print(std::ostream& out);
+
+    static inline const API::ProbeStat& statistic()
+    {
+        return stat;
+    }
+
+private:
+    static API::ProbeStat::Shard* attach();
+    static void calibrate();
+
+    static API::ProbeStat stat;
+    static thread_local API::ProbeStat::Shard* local;
+};
+
+} // namespace utils
+} // namespace NST
+//------------------------------------------------------------------------------
+#endif//PROBES_H
+//------------------------------------------------------------------------------
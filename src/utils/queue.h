@@ -26,6 +26,7 @@
 #include <type_traits>
 
 #include "utils/block_allocator.h"
+#include "utils/metrics.h"
 #include "utils/spinlock.h"
 //------------------------------------------------------------------------------
 namespace NST
@@ -102,10 +103,14 @@ public:
     Queue(uint32_t size, uint32_t limit) : last{nullptr}, first{nullptr}
     {
         allocator.init_allocation(sizeof(Element), size, limit);
+        Metrics::add(Metrics::QueueFreeChunks, allocator.free_chunks());
     }
     ~Queue()
     {
-        List list{*this};   // deallocate items by destructor of List
+        {
+            List list{*this};   // deallocate items by destructor of List
+        }
+        Metrics::add(Metrics::QueueFreeChunks, -static_cast<int64_t>(allocator.free_chunks()));
     }
 
     inline T* allocate()
@@ -114,7 +119,11 @@ public:
                       "The construction of T must not to throw any exception");
 
         Spinlock::Lock lock{a_spinlock};
+            const std::size_t free_chunks {allocator.free_chunks()};
             Element* e {(Element*)allocator.allocate()}; // may throw std::bad_alloc
+            // a new block of chunks may be allocated
+            Metrics::add(Metrics::QueueFreeChunks, static_cast<int64_t>(allocator.free_chunks()) - free_chunks);
+            Metrics::add(Metrics::QueueElements, 1);
             auto ptr = &(e->data);
             ::new(ptr)T; // only call constructor of T (placement)
             return ptr;
@@ -164,6 +173,8 @@ private:
     {
         Spinlock::Lock lock{a_spinlock};
             allocator.deallocate(e);
+            Metrics::add(Metrics::QueueFreeChunks, 1);
+            Metrics::add(Metrics::QueueElements, -1);
     }
 
     BlockAllocator allocator;
@@ -23,8 +23,8 @@
 
 #include <arpa/inet.h>  // for inet_ntop(), ntohs()
 #include <sys/socket.h> // for AF_INET/AF_INET6
-#include <netdb.h>
 
+#include "utils/host_names.h"
 #include "utils/out.h"
 #include "utils/sessions.h"
 //------------------------------------------------------------------------------
@@ -33,10 +33,16 @@ namespace NST
 namespace utils
 {
 
-std::ostream& operator<<(std::ostream& out, const ApplicationSession& session);
+namespace
+{
+void print_application_session(std::ostream& out, const Session& session, const std::string (&names)[2]);
+}
 
 ApplicationSession::ApplicationSession(const NetworkSession& s, Direction from_client)
 : utils::Session (s)
+, unresolved     {false}
+, named          {false}
+, checked        {0}
 {
     if(s.direction != from_client)
     {
@@ -53,12 +59,40 @@ ApplicationSession::ApplicationSession(const NetworkSession& s, Direction from_c
         }
     }
 
-    // TODO: print network addresses in human readable form and
-    //       potential host name lookup may be expensive, to try to use
-    //       std::future(async | deferred, ...) and std::promise, to perform
-    //       this operation asynchronously
     std::stringstream stream(std::ios_base::out);
-    stream << *this;
+    print_session(stream, *this);
+    session_str = stream.str();
+
+    // host names are looked up in background, a cached name is used at once
+    if(Out::Global::get_level() == Out::Level::All && HostNames::enabled())
+    {
+        unresolved = true;
+        refresh();
+    }
+}
+
+void ApplicationSession::refresh() const
+{
+    checked = HostNames::completed();
+    std::string names[2];
+    for(const Direction d : {Session::Source, Session::Destination})
+    {
+        const void* address {ip_type == Session::IPType::v4 ? static_cast<const void*>(&ip.v4.addr[d])
+                                                            : static_cast<const void*>(ip.v6.addr[d])};
+        if(HostNames::find(HostNames::Address{ip_type, address}, names[d]) == HostNames::Status::Pending)
+        {
+            return; // numeric addresses are shown until both lookups are done
+        }
+    }
+    unresolved = false;
+    if(names[Session::Source].empty() && names[Session::Destination].empty())
+    {
+        return; // numeric addresses are final
+    }
+    named = true;
+
+    std::stringstream stream(std::ios_base::out);
+    print_application_session(stream, *this, names);
     session_str = stream.str();
 }
 
@@ -95,57 +129,15 @@ void print_ipv6_port(std::ostream& out, const uint8_t (&ipv6)[16], in_port_t por
         << ':' << ntohs(port);
 }
 
-// TODO: getnameinfo call may be expensive
-template<typename SockAddr>
-void print_sockaddr(std::ostream& out, SockAddr& addr)
+void print_host_name(std::ostream& out, const std::string& name, in_port_t port)
 {
-    char hostname[1025];
-    char service [65];
-    const int err {getnameinfo((sockaddr*)&addr, sizeof(addr),
-                                        hostname, sizeof(hostname),
-                                         service, sizeof(service),
-                                                  NI_NAMEREQD ) };
-    if(err == 0)
+    if(!name.empty())
     {
-        out << '(' << hostname << ':' << service << ')';
+        out << '(' << name << ':' << HostNames::service(port) << ')';
     }
 }
 
-void print_ipv4_port_as_hostname_service(std::ostream& out,
-                                            in_addr_t ipv4,
-                                            in_port_t port)
-{
-    sockaddr_in addr;
-    addr.sin_family     = AF_INET;
-    addr.sin_port       = port;
-    addr.sin_addr.s_addr= ipv4;
-
-    print_sockaddr(out, addr);
-}
-
-void print_ipv6_port_as_hostname_service(std::ostream& out,
-                                         const uint8_t (&ipv6)[16],
-                                             in_port_t port)
-{
-    sockaddr_in6 addr;
-    addr.sin6_family    = AF_INET6;
-    addr.sin6_port      = port;
-    addr.sin6_flowinfo  = 0;
-    addr.sin6_addr      = (in6_addr&)ipv6;
-    addr.sin6_scope_id  = 0;
-
-    print_sockaddr(out, addr);
-}
-
-} // unnamed namespace
-
-std::ostream& operator<<(std::ostream& out, const Session& session)
-{
-    print_session(out, session);
-    return out;
-}
-
-void print_session(std::ostream& out, const Session& session)
+void print_application_session(std::ostream& out, const Session& session, const std::string (&names)[2])
 {
     switch(session.ip_type)
     {
@@ -153,83 +145,60 @@ void print_session(std::ostream& out, const Session& session)
         {
             print_ipv4_port(out, session.ip.v4.addr[Session::Source],
                                  session.port      [Session::Source]);
+            print_host_name(out, names[Session::Source], session.port[Session::Source]);
             out << " --> ";
             print_ipv4_port(out, session.ip.v4.addr[Session::Destination],
                                  session.port      [Session::Destination]);
+            print_host_name(out, names[Session::Destination], session.port[Session::Destination]);
         }
         break;
         case Session::IPType::v6:
         {
             print_ipv6_port(out, session.ip.v6.addr[Session::Source],
                                  session.port      [Session::Source]);
+            print_host_name(out, names[Session::Source], session.port[Session::Source]);
             out << " --> ";
             print_ipv6_port(out, session.ip.v6.addr[Session::Destination],
                                  session.port      [Session::Destination]);
+            print_host_name(out, names[Session::Destination], session.port[Session::Destination]);
         }
         break;
     }
     out << session.type;
 }
 
-std::ostream& operator<<(std::ostream& out, const ApplicationSession& session)
+} // unnamed namespace
+
+std::ostream& operator<<(std::ostream& out, const Session& session)
 {
-    const bool namelookup {Out::Global::get_level() == Out::Level::All};
+    print_session(out, session);
+    return out;
+}
 
+void print_session(std::ostream& out, const Session& session)
+{
     switch(session.ip_type)
     {
         case Session::IPType::v4:
         {
-            {
-                auto& port = session.port      [Session::Source];
-                auto& addr = session.ip.v4.addr[Session::Source];
-
-                print_ipv4_port(out, addr, port);
-                if(namelookup)
-                {
-                    print_ipv4_port_as_hostname_service(out, addr, port);
-                }
-            }
+            print_ipv4_port(out, session.ip.v4.addr[Session::Source],
+                                 session.port      [Session::Source]);
             out << " --> ";
-            {
-                auto& port = session.port      [Session::Destination];
-                auto& addr = session.ip.v4.addr[Session::Destination];
-
-                print_ipv4_port(out, addr, port);
-                if(namelookup)
-                {
-                    print_ipv4_port_as_hostname_service(out, addr, port);
-                }
-            }
+            print_ipv4_port(out, session.ip.v4.addr[Session::Destination],
+                                 session.port      [Session::Destination]);
         }
         break;
         case Session::IPType::v6:
         {
-            {
-                auto& port = session.port      [Session::Source];
-                auto& addr = session.ip.v6.addr[Session::Source];
-
-                print_ipv6_port(out, addr, port);
-                if(namelookup)
-                {
-                    print_ipv6_port_as_hostname_service(out, addr, port);
-                }
-            }
+            print_ipv6_port(out, session.ip.v6.addr[Session::Source],
+                                 session.port      [Session::Source]);
             out << " --> ";
-            {
-                auto& port = session.port      [Session::Destination];
-                auto& addr = session.ip.v6.addr[Session::Destination];
-
-                print_ipv6_port(out, addr, port);
-                if(namelookup)
-                {
-                    print_ipv6_port_as_hostname_service(out, addr, port);
-                }
-            }
+            print_ipv6_port(out, session.ip.v6.addr[Session::Destination],
+                                 session.port      [Session::Destination]);
         }
         break;
     }
     out << session.type;
-    return out;
 }
 
 } // namespace utils
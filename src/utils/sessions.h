@@ -27,6 +27,7 @@
 #include <ostream>
 
 #include "api/session.h"
+#include "utils/host_names.h"
 //------------------------------------------------------------------------------
 #define NST_PUBLIC __attribute__ ((visibility("default")))
 //------------------------------------------------------------------------------
@@ -58,9 +59,32 @@ struct ApplicationSession : public Session
 public:
     ApplicationSession(const NetworkSession& s, Direction from_client);
 
-    const std::string& str() const { return session_str; }
+    // numeric addresses until host names are resolved in background,
+    // the cache is asked again only after some lookup is completed
+    const std::string& str() const
+    {
+        if(unresolved && checked != HostNames::completed())
+        {
+            refresh();
+        }
+        return session_str;
+    }
+
+    // true once, after str() has got host names resolved in background
+    bool names_resolved()
+    {
+        str();
+        const bool result {named};
+        named = false;
+        return result;
+    }
 private:
-    std::string session_str;
+    void refresh() const;
+
+    mutable std::string session_str;
+    mutable bool        unresolved;
+    mutable bool        named;
+    mutable uint64_t    checked;    // HostNames::completed() of the last refresh()
 };
 
 extern "C"
@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Checks replay trace written from sample trace
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+#include "replay_reader.h"
+//------------------------------------------------------------------------------
+// Usage: replay_check <replay trace> <expected amount of ops>
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <replay trace> <expected amount of ops>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    try
+    {
+        ReplayReader reader{argv[1]};
+        Replay::Op op;
+        uint64_t ops = 0U;
+        while (reader.next(op))
+        {
+            // each op refers to entries defined before it
+            reader.client(op.client);
+            if (op.fields & Replay::Field::Handle)
+            {
+                reader.handle(op.handle);
+            }
+            if (op.fields & Replay::Field::Name)
+            {
+                reader.name(op.name);
+            }
+            if (op.fields & Replay::Field::Handle2)
+            {
+                reader.handle(op.handle2);
+            }
+            if (op.fields & Replay::Field::Name2)
+            {
+                reader.name(op.name2);
+            }
+            ++ops;
+        }
+        const uint64_t expected = std::strtoull(argv[2], nullptr, 10);
+        if (ops != expected)
+        {
+            std::cerr << argv[1] << ": " << ops << " ops read, " << expected << " expected" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+//------------------------------------------------------------------------------
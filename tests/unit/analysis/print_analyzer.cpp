@@ -0,0 +1,251 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of trace of RPC procedures
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <arpa/inet.h>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "analysis/print_analyzer.h"
+#include "utils/out.h"
+//------------------------------------------------------------------------------
+using namespace NST::analysis;
+using namespace NST::API;
+using NST::utils::Out;
+//------------------------------------------------------------------------------
+namespace
+{
+
+// Passes NFSv3 procedures and COMPOUNDs with every NFSv4.0 and NFSv4.1
+// operation to the tracer
+void trace(PrintAnalyzer& analyzer)
+{
+    Session session{};
+    session.ip_type = Session::v4;
+    session.ip.v4.addr[0] = htonl(0x0a000002);
+    session.ip.v4.addr[1] = htonl(0x0a000001);
+    session.port[0] = htons(801);
+    session.port[1] = htons(2049);
+
+    timeval call{100, 0};
+    timeval reply{100, 1500};
+    RPCProcedure proc{};
+    proc.session = &session;
+    proc.ctimestamp = &call;
+    proc.rtimestamp = &reply;
+    proc.call.rm_xid = 0x1234abcd;
+    proc.call.ru.RM_cmb.cb_rpcvers = 2;
+    proc.call.ru.RM_cmb.cb_prog = 100003;
+    proc.reply.ru.RM_rmb.rp_stat = ::MSG_ACCEPTED;
+    proc.reply.ru.RM_rmb.ru.RP_ar.ar_stat = ::SUCCESS;
+
+    char handle[32];
+    for(std::size_t i {0}; i < sizeof(handle); ++i)
+    {
+        handle[i] = static_cast<char>(i * 37 + 5);
+    }
+    char name[] = "some-file.txt";
+
+    proc.call.ru.RM_cmb.cb_vers = 3;
+    proc.call.ru.RM_cmb.cb_proc = ProcEnumNFS3::GETATTR;
+    NFS3::GETATTR3args getattr_args{};
+    getattr_args.object.data.data_val = handle;
+    getattr_args.object.data.data_len = 27;
+    NFS3::GETATTR3res getattr_res{};
+    getattr_res.status = NFS3::NFS3_OK;
+    NFS3::fattr3& attributes = getattr_res.GETATTR3res_u.resok.obj_attributes;
+    attributes.type = NFS3::NF3REG;
+    attributes.mode = 0644;
+    attributes.nlink = 1;
+    attributes.uid = 1000;
+    attributes.gid = 100;
+    attributes.size = 0x123456789ULL;
+    attributes.used = 4096;
+    attributes.fsid = 0xfedcba9876543210ULL;
+    attributes.fileid = 42;
+    attributes.mtime.seconds = 1400000000;
+    attributes.mtime.nseconds = 999;
+    analyzer.getattr3(&proc, &getattr_args, &getattr_res);
+
+    proc.call.ru.RM_cmb.cb_proc = ProcEnumNFS3::READ;
+    NFS3::READ3args read_args{};
+    read_args.file.data.data_val = handle;
+    read_args.file.data.data_len = 32;
+    read_args.offset = 0xffffffffffffffffULL;
+    read_args.count = 65536;
+    NFS3::READ3res read_res{};
+    read_res.status = NFS3::NFS3_OK;
+    read_res.READ3res_u.resok.file_attributes.attributes_follow = 1;
+    read_res.READ3res_u.resok.file_attributes.post_op_attr_u.attributes = attributes;
+    read_res.READ3res_u.resok.count = 4096;
+    read_res.READ3res_u.resok.eof = 1;
+    analyzer.read3(&proc, &read_args, &read_res);
+
+    proc.call.ru.RM_cmb.cb_proc = ProcEnumNFS3::READDIR;
+    NFS3::entry3 second{};
+    second.fileid = 7;
+    second.name = name;
+    second.cookie = 2;
+    NFS3::entry3 first{};
+    first.fileid = 6;
+    first.name = name;
+    first.cookie = 1;
+    first.nextentry = &second;
+    NFS3::READDIR3args readdir_args{};
+    readdir_args.dir.data.data_val = handle;
+    readdir_args.dir.data.data_len = 16;
+    readdir_args.count = 512;
+    NFS3::READDIR3res readdir_res{};
+    readdir_res.status = NFS3::NFS3_OK;
+    readdir_res.READDIR3res_u.resok.reply.entries = &first;
+    analyzer.readdir3(&proc, &readdir_args, &readdir_res);
+
+    proc.call.ru.RM_cmb.cb_vers = 4;
+    proc.call.ru.RM_cmb.cb_proc = ProcEnumNFS4::COMPOUND;
+    {
+        const std::size_t count {NFS4::OP_RELEASE_LOCKOWNER - NFS4::OP_ACCESS + 1};
+        NFS4::nfs_argop4 args[count];
+        NFS4::nfs_resop4 res[count];
+        std::memset(args, 0, sizeof(args));
+        std::memset(res, 0, sizeof(res));
+        for(std::size_t i {0}; i < count; ++i)
+        {
+            args[i].argop = NFS4::nfs_opnum4(NFS4::OP_ACCESS + i);
+            res[i].resop = NFS4::nfs_opnum4(NFS4::OP_ACCESS + i);
+        }
+        args[NFS4::OP_PUTFH - NFS4::OP_ACCESS].nfs_argop4_u.opputfh.object.nfs_fh4_val = handle;
+        args[NFS4::OP_PUTFH - NFS4::OP_ACCESS].nfs_argop4_u.opputfh.object.nfs_fh4_len = 32;
+        NFS4::clientaddr4& location = args[NFS4::OP_SETCLIENTID - NFS4::OP_ACCESS].nfs_argop4_u.opsetclientid.callback.cb_location;
+        location.r_netid = name;
+        location.r_addr = name;
+        args[NFS4::OP_WRITE - NFS4::OP_ACCESS].nfs_argop4_u.opwrite.offset = 8192;
+        args[NFS4::OP_WRITE - NFS4::OP_ACCESS].nfs_argop4_u.opwrite.stable = NFS4::FILE_SYNC4;
+        res[NFS4::OP_WRITE - NFS4::OP_ACCESS].nfs_resop4_u.opwrite.WRITE4res_u.resok4.count = 8192;
+        NFS4::COMPOUND4args compound_args{};
+        compound_args.tag.utf8string_val = name;
+        compound_args.tag.utf8string_len = 4;
+        compound_args.argarray.argarray_len = count;
+        compound_args.argarray.argarray_val = args;
+        NFS4::COMPOUND4res compound_res{};
+        compound_res.resarray.resarray_len = count;
+        compound_res.resarray.resarray_val = res;
+        analyzer.compound4(&proc, &compound_args, &compound_res);
+    }
+
+    proc.call.ru.RM_cmb.cb_vers = 4;
+    {
+        const std::size_t count {NFS41::OP_RECLAIM_COMPLETE - NFS41::OP_ACCESS + 1};
+        NFS41::nfs_argop4 args[count];
+        NFS41::nfs_resop4 res[count];
+        std::memset(args, 0, sizeof(args));
+        std::memset(res, 0, sizeof(res));
+        for(std::size_t i {0}; i < count; ++i)
+        {
+            args[i].argop = NFS41::nfs_opnum4(NFS41::OP_ACCESS + i);
+            res[i].resop = NFS41::nfs_opnum4(NFS41::OP_ACCESS + i);
+        }
+        NFS41::netaddr4& location = args[NFS41::OP_SETCLIENTID - NFS41::OP_ACCESS].nfs_argop4_u.opsetclientid.callback.cb_location;
+        location.na_r_netid = name;
+        location.na_r_addr = name;
+        NFS41::SEQUENCE4args& sequence = args[NFS41::OP_SEQUENCE - NFS41::OP_ACCESS].nfs_argop4_u.opsequence;
+        std::memcpy(sequence.sa_sessionid, handle, sizeof(sequence.sa_sessionid));
+        sequence.sa_sequenceid = 17;
+        sequence.sa_slotid = 3;
+        NFS41::COMPOUND4args compound_args{};
+        compound_args.minorversion = 1;
+        compound_args.argarray.argarray_len = count;
+        compound_args.argarray.argarray_val = args;
+        NFS41::COMPOUND4res compound_res{};
+        compound_res.resarray.resarray_len = count;
+        compound_res.resarray.resarray_val = res;
+        analyzer.compound41(&proc, &compound_args, &compound_res);
+    }
+
+    proc.reply.ru.RM_rmb.ru.RP_ar.ar_stat = ::PROG_MISMATCH;
+    proc.reply.ru.RM_rmb.ru.RP_ar.ru.AR_versions.low = 3;
+    proc.reply.ru.RM_rmb.ru.RP_ar.ru.AR_versions.high = 4;
+    proc.call.ru.RM_cmb.cb_vers = 3;
+    proc.call.ru.RM_cmb.cb_proc = ProcEnumNFS3::GETATTR;
+    analyzer.getattr3(&proc, &getattr_args, &getattr_res);
+}
+
+std::string traced(Out::Level level, bool buffered)
+{
+    Out::Global::set_level(level);
+    std::ostringstream output;
+    {
+        PrintAnalyzer analyzer{output, buffered};
+        trace(analyzer);
+    }
+    return output.str();
+}
+
+// Trace written by PrintAnalyzer before its formatting was sped up
+std::string reference(const char* name)
+{
+    std::ifstream file{std::string{TRACE_REFERENCE_DIR} + "/" + name};
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+} // unnamed namespace
+//------------------------------------------------------------------------------
+TEST(PrintAnalyzer, same_trace_as_reference)
+{
+    const std::string info {reference("print_analyzer_info.trace")};
+    const std::string all {reference("print_analyzer_all.trace")};
+    ASSERT_FALSE(info.empty());
+    ASSERT_FALSE(all.empty());
+
+    EXPECT_EQ(info, traced(Out::Level::Info, false));
+    EXPECT_EQ(all, traced(Out::Level::All, false));
+}
+
+TEST(PrintAnalyzer, buffered_trace)
+{
+    EXPECT_EQ(traced(Out::Level::Info, false), traced(Out::Level::Info, true));
+    EXPECT_EQ(traced(Out::Level::All, false), traced(Out::Level::All, true));
+}
+
+TEST(PrintAnalyzer, messages_follow_buffered_trace)
+{
+    const std::string expected {traced(Out::Level::Info, false)};
+
+    std::stringbuf output;
+    std::streambuf* const stdout_buffer {std::cout.rdbuf(&output)};
+    {
+        std::ostream stream{&output};
+        PrintAnalyzer analyzer{stream, true};
+        ASSERT_NE(nullptr, analyzer.block());
+        trace(analyzer);
+        EXPECT_TRUE(output.str().empty()); // trace is collected in block
+
+        Out::Preceding preceding{analyzer.block()};
+        Out{} << "message";
+        EXPECT_EQ(expected + "message\n", output.str());
+    }
+    std::cout.rdbuf(stdout_buffer);
+}
+//------------------------------------------------------------------------------
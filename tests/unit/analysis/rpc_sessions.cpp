@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of RPC sessions
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "analysis/rpc_sessions.h"
+//------------------------------------------------------------------------------
+using namespace NST::analysis;
+using NST::utils::FilteredDataQueue;
+using NST::utils::NetworkSession;
+
+class RPCSessionTest : public ::testing::Test
+{
+protected:
+    RPCSessionTest()
+        : queue{16, 1}
+        , network{}
+    {
+        network.type = NST::utils::Session::TCP;
+        network.ip_type = NST::utils::Session::v4;
+        network.direction = NST::utils::Session::Source;
+    }
+
+    FilteredDataQueue::Ptr call(time_t seconds)
+    {
+        FilteredDataQueue::Ptr ptr{queue.allocate(), FilteredDataQueue::Ptr::deleter_type{&queue}};
+        ptr->timestamp.tv_sec = seconds;
+        ptr->timestamp.tv_usec = 0;
+        return ptr;
+    }
+
+    FilteredDataQueue queue;
+    NetworkSession network;
+};
+
+TEST_F(RPCSessionTest, single_call)
+{
+    Session session{network, NST::utils::Session::Source};
+
+    EXPECT_FALSE(session.save_call_data(1U, call(10)));
+
+    Session::Call&& c = session.get_call_data(1U);
+    ASSERT_TRUE(c.data != nullptr);
+    EXPECT_EQ(10, c.first.tv_sec);
+    EXPECT_EQ(0U, c.retransmits);
+    EXPECT_EQ(0U, session.get_retransmits());
+
+    // call is taken out
+    EXPECT_TRUE(session.get_call_data(1U).data == nullptr);
+}
+
+TEST_F(RPCSessionTest, retransmits)
+{
+    Session session{network, NST::utils::Session::Source};
+
+    EXPECT_FALSE(session.save_call_data(1U, call(10)));
+    EXPECT_FALSE(session.save_call_data(2U, call(11)));
+    EXPECT_TRUE(session.save_call_data(1U, call(12)));
+    EXPECT_TRUE(session.save_call_data(1U, call(15)));
+
+    Session::Call&& c = session.get_call_data(1U);
+    ASSERT_TRUE(c.data != nullptr);
+    EXPECT_EQ(10, c.first.tv_sec);          // first send is kept
+    EXPECT_EQ(15, c.data->timestamp.tv_sec); // data of the last send
+    EXPECT_EQ(2U, c.retransmits);
+    EXPECT_EQ(2U, session.get_retransmits());
+
+    // XID reused after reply is not a retransmission
+    EXPECT_FALSE(session.save_call_data(1U, call(20)));
+    EXPECT_EQ(0U, session.get_call_data(1U).retransmits);
+    EXPECT_EQ(0U, session.get_call_data(2U).retransmits);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of table of cached attributes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "attr_table.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+AttrKey key(uint32_t client, uint32_t file)
+{
+    AttrKey result{{client, 0U, 0U, 0U}, FileHandle{reinterpret_cast<const char*>(&file), sizeof(file)}};
+    return result;
+}
+
+}
+//------------------------------------------------------------------------------
+TEST(AttrTable, find)
+{
+    AttrTable table{16U, 1000U};
+    bool inserted;
+
+    table.find(key(1, 1), 0U, inserted).lastSeen = 0U;
+    EXPECT_TRUE(inserted);
+    table.find(key(2, 1), 0U, inserted);
+    EXPECT_TRUE(inserted);
+    AttrEntry& entry = table.find(key(1, 1), 10U, inserted);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(0U, entry.lastSeen);
+    EXPECT_EQ(2U, table.size());
+}
+
+TEST(AttrTable, idle_eviction)
+{
+    AttrTable table{16U, 100U};
+    bool inserted;
+
+    table.find(key(1, 1), 0U, inserted);
+    table.find(key(1, 2), 50U, inserted).lastSeen = 50U;
+    table.find(key(1, 3), 120U, inserted); // evicts file 1
+
+    EXPECT_EQ(2U, table.size());
+    EXPECT_EQ(1U, table.idleEvictedAmount());
+    table.find(key(1, 1), 120U, inserted);
+    EXPECT_TRUE(inserted);
+}
+
+TEST(AttrTable, bounded)
+{
+    AttrTable table{AttrTable::ChunkSize + 10U, 1000000U};
+    bool inserted;
+
+    for (uint32_t i = 0; i < 100000U; ++i)
+    {
+        table.find(key(i % 7U, i), i, inserted).lastSeen = i;
+    }
+    EXPECT_EQ(AttrTable::ChunkSize + 10U, table.size());
+    EXPECT_EQ(100000U - AttrTable::ChunkSize - 10U, table.forcedEvictedAmount());
+
+    // the most recent entries are kept
+    table.find(key(99999U % 7U, 99999U), 100000U, inserted);
+    EXPECT_FALSE(inserted);
+}
+//------------------------------------------------------------------------------
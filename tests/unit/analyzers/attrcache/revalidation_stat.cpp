@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of statistics of revalidations
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "revalidation_stat.h"
+//------------------------------------------------------------------------------
+TEST(RevalidationStat, intervals)
+{
+    RevalidationStat stat;
+
+    stat.account(Revalidation::First, 0U);
+    stat.account(Revalidation::Unchanged, 500000U);     // <1s
+    stat.account(Revalidation::Unchanged, 2000000U);    // <3s
+    stat.account(Revalidation::Unchanged, 45000000U);   // <60s
+    stat.account(Revalidation::Changed, 20000000U);     // <30s
+    stat.account(Revalidation::Unchanged, 7200000000U); // >=600s
+    stat.account(Revalidation::Unknown, 1000U);
+
+    EXPECT_EQ(7U, stat.total);
+    EXPECT_EQ(1U, stat.unchangedIntervals[0]);
+    EXPECT_EQ(1U, stat.unchangedIntervals[1]);
+    EXPECT_EQ(1U, stat.unchangedIntervals[4]);
+    EXPECT_EQ(1U, stat.unchangedIntervals[RevalidationStat::IntervalsAmount - 1]);
+    EXPECT_EQ(1U, stat.changedIntervals[3]);
+
+    EXPECT_EQ(2U, stat.savedWith(3U));
+    EXPECT_EQ(0U, stat.staleWith(3U));
+    EXPECT_EQ(3U, stat.savedWith(60U));
+    EXPECT_EQ(1U, stat.staleWith(60U));
+    EXPECT_EQ(3U, stat.savedWith(100000U));
+    EXPECT_EQ(4U, stat.savedWithDelegation());
+}
+//------------------------------------------------------------------------------
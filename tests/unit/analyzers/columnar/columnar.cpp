@@ -0,0 +1,169 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of columnar trace format, writer and reader
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "columnar_reader.h"
+#include "columnar_writer.h"
+//------------------------------------------------------------------------------
+using namespace Columnar;
+
+namespace
+{
+
+class TemporaryFile
+{
+public:
+    TemporaryFile() : path{"/tmp/nfstrace-columnar-XXXXXX"}
+    {
+        const int fd = mkstemp(&path[0]);
+        if (fd < 0)
+        {
+            throw std::runtime_error{"Can't create temporary file"};
+        }
+        close(fd);
+    }
+    ~TemporaryFile()
+    {
+        unlink(path.c_str());
+    }
+
+    std::string path;
+};
+
+const Schema TestSchema =
+{
+    {"time", Type::U64, Codec::Delta},
+    {"status", Type::U32, Codec::Varint},
+    {"size", Type::U16, Codec::Plain},
+    {"name", Type::String, Codec::Varint}
+};
+
+}
+//------------------------------------------------------------------------------
+TEST(Columnar, codecs)
+{
+    const std::vector<uint64_t> values = {1000U, 999U, 1000000U, 5U, 0U, 65535U};
+    const Codec codecs[] = {Codec::Plain, Codec::Varint, Codec::Delta};
+    for (Codec codec : codecs)
+    {
+        std::vector<uint8_t> data;
+        encode(codec, Type::U32, values, data);
+
+        std::vector<uint64_t> decoded;
+        decode(codec, Type::U32, data.data(), data.data() + data.size(), values.size(), decoded);
+        EXPECT_EQ(values, decoded);
+
+        EXPECT_THROW(decode(codec, Type::U32, data.data(), data.data() + data.size() - 1, values.size(), decoded),
+                     std::runtime_error);
+    }
+}
+
+TEST(Columnar, delta_compresses_ordered_values)
+{
+    std::vector<uint64_t> values;
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        values.push_back(1420070400000000ULL + i * 100U);
+    }
+    std::vector<uint8_t> plain;
+    encode(Codec::Plain, Type::U64, values, plain);
+    std::vector<uint8_t> delta;
+    encode(Codec::Delta, Type::U64, values, delta);
+
+    EXPECT_EQ(values.size() * 8U, plain.size());
+    EXPECT_GT(plain.size() / 3U, delta.size());
+}
+
+TEST(Columnar, round_trip)
+{
+    TemporaryFile file;
+    {
+        ColumnarWriter writer{file.path, TestSchema, 3U};
+        const char* const names[] = {"", "a", "bb", "a", "ccc", "", "bb"};
+        for (uint64_t i = 0; i < 7; ++i)
+        {
+            const uint64_t name = writer.intern(3U, names[i], strlen(names[i]));
+            const uint64_t row[] = {1000U + i * 10U, i % 2U, 512U * i, name};
+            writer.append(row);
+        }
+        EXPECT_EQ(7U, writer.rowsAmount());
+        EXPECT_FALSE(writer.failed());
+    }
+
+    ColumnarReader reader{file.path};
+    ASSERT_EQ(TestSchema.size(), reader.schema().size());
+    for (std::size_t i = 0; i < TestSchema.size(); ++i)
+    {
+        EXPECT_EQ(TestSchema[i].name, reader.schema()[i].name);
+        EXPECT_EQ(TestSchema[i].type, reader.schema()[i].type);
+        EXPECT_EQ(TestSchema[i].codec, reader.schema()[i].codec);
+    }
+    EXPECT_EQ(2U, reader.find("size"));
+    EXPECT_THROW(reader.find("missing"), std::out_of_range);
+
+    // Single column of all blocks
+    std::vector<uint64_t> sizes;
+    std::vector<uint64_t> block;
+    std::size_t blocks = 0;
+    while (reader.scan(2U, block))
+    {
+        ++blocks;
+        sizes.insert(sizes.end(), block.begin(), block.end());
+    }
+    EXPECT_EQ(3U, blocks);
+    EXPECT_EQ((std::vector<uint64_t>{0U, 512U, 1024U, 1536U, 2048U, 2560U, 3072U}), sizes);
+
+    // Another column after rewind, including dictionary
+    reader.rewind();
+    std::vector<uint64_t> ids;
+    while (reader.scan(3U, block))
+    {
+        ids.insert(ids.end(), block.begin(), block.end());
+    }
+    const std::vector<std::string>& dictionary = reader.dictionary(3U);
+    ASSERT_EQ(4U, dictionary.size());
+    ASSERT_EQ(7U, ids.size());
+    const char* const expected[] = {"", "a", "bb", "a", "ccc", "", "bb"};
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        ASSERT_LT(ids[i], dictionary.size());
+        EXPECT_EQ(expected[i], dictionary[ids[i]]);
+    }
+}
+
+TEST(Columnar, not_a_trace)
+{
+    TemporaryFile file;
+    FILE* f = fopen(file.path.c_str(), "wb");
+    ASSERT_NE(nullptr, f);
+    fputs("not a columnar trace", f);
+    fclose(f);
+
+    EXPECT_THROW(ColumnarReader{file.path}, std::runtime_error);
+}
+//------------------------------------------------------------------------------
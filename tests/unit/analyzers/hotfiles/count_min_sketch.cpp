@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of Count-Min sketch
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "count_min_sketch.h"
+//------------------------------------------------------------------------------
+TEST(CountMinSketch, never_underestimates)
+{
+    CountMinSketch sketch{64U, 4U};
+
+    for (uint64_t object = 1; object <= 1000U; ++object)
+    {
+        sketch.add(object * 0x9E3779B97F4A7C15ULL, object % 10U + 1U);
+    }
+
+    EXPECT_EQ(1000U / 10U * 55U, sketch.total());
+    for (uint64_t object = 1; object <= 1000U; ++object)
+    {
+        EXPECT_LE(object % 10U + 1U, sketch.estimate(object * 0x9E3779B97F4A7C15ULL));
+    }
+}
+
+TEST(CountMinSketch, heavy_object)
+{
+    CountMinSketch sketch{1024U, 4U};
+    const uint64_t heavy = 0x0123456789ABCDEFULL;
+
+    for (uint64_t i = 0; i < 10000U; ++i)
+    {
+        sketch.add(heavy, 1U);
+        sketch.add((i + 1) * 0x9E3779B97F4A7C15ULL, 1U);
+    }
+
+    // error is bounded by e * total / width with high probability
+    EXPECT_LE(10000U, sketch.estimate(heavy));
+    EXPECT_GE(10000U + 60U, sketch.estimate(heavy));
+}
+//------------------------------------------------------------------------------
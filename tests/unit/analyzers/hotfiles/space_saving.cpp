@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of Space-Saving top-K of file handles
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "space_saving.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+FileHandle handle(uint32_t id)
+{
+    const char data[] = {static_cast<char>(id), static_cast<char>(id >> 8), static_cast<char>(id >> 16), 0x7f};
+    return FileHandle{data, sizeof(data)};
+}
+
+}
+//------------------------------------------------------------------------------
+TEST(SpaceSaving, exact_while_not_full)
+{
+    SpaceSaving summary{4U};
+
+    summary.add(handle(1), 1U, 1U);
+    summary.add(handle(2), 5U, 5U);
+    summary.add(handle(1), 1U, 2U);
+
+    auto top = summary.top(10U);
+    ASSERT_EQ(2U, top.size());
+    EXPECT_TRUE(top[0]->handle == handle(2));
+    EXPECT_EQ(5U, top[0]->count);
+    EXPECT_EQ(2U, top[1]->count);
+    EXPECT_EQ(0U, top[1]->error);
+}
+
+TEST(SpaceSaving, heavy_hitters_survive)
+{
+    SpaceSaving summary{8U};
+
+    // two hot handles among a stream of distinct cold ones
+    for (uint32_t i = 0; i < 10000U; ++i)
+    {
+        summary.add(handle(1), 1U, i + 1U).account(Operation::Getattr, 0U, i / 1000U);
+        summary.add(handle(2), 1U, i + 1U).account(Operation::Lookup, 0U, i / 1000U);
+        summary.add(handle(100 + i), 1U, 1U);
+    }
+
+    EXPECT_EQ(8U, summary.size());
+    EXPECT_LT(0U, summary.replacedAmount());
+    auto top = summary.top(2U);
+    ASSERT_EQ(2U, top.size());
+    EXPECT_EQ(10000U, top[0]->count);
+    EXPECT_EQ(10000U, top[1]->count);
+    EXPECT_EQ(0U, top[0]->error);
+    EXPECT_EQ(1000U, top[0]->peakMetadataOps);
+}
+
+TEST(SpaceSaving, estimate_bounds_replacement)
+{
+    SpaceSaving summary{1U};
+
+    summary.add(handle(1), 100U, 100U);
+    // without estimate count would inherit 100
+    const HotObject& object = summary.add(handle(2), 1U, 3U);
+
+    EXPECT_TRUE(object.handle == handle(2));
+    EXPECT_EQ(3U, object.count);
+    EXPECT_EQ(2U, object.error);
+    EXPECT_EQ(1U, summary.replacedAmount());
+}
+
+TEST(HotObject, peaks)
+{
+    HotObject object{};
+
+    object.account(Operation::Getattr, 0U, 10U);
+    object.account(Operation::Getattr, 0U, 10U);
+    object.account(Operation::Read, 4096U, 10U);
+    object.account(Operation::Access, 0U, 11U);
+
+    EXPECT_EQ(2U, object.ops[static_cast<std::size_t>(Operation::Getattr)]);
+    EXPECT_EQ(4096U, object.bytes);
+    EXPECT_EQ(3U, object.peakOps);
+    EXPECT_EQ(2U, object.peakMetadataOps);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of classification of I/O requests
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "access_stream.h"
+//------------------------------------------------------------------------------
+TEST(AccessStream, sequential)
+{
+    AccessStream stream;
+
+    EXPECT_EQ(Access::First, stream.account(0U, 4096U));
+    EXPECT_EQ(Access::Sequential, stream.account(4096U, 4096U));
+    EXPECT_EQ(Access::Sequential, stream.account(8192U, 65536U));
+
+    EXPECT_EQ(3U, stream.counters().ops);
+    EXPECT_EQ(2U, stream.counters().sequential);
+    EXPECT_EQ(73728U, stream.counters().bytes);
+}
+
+TEST(AccessStream, strided_and_random)
+{
+    AccessStream stream;
+
+    // reads 4K of each 16K
+    EXPECT_EQ(Access::First, stream.account(0U, 4096U));
+    EXPECT_EQ(Access::Random, stream.account(16384U, 4096U));
+    EXPECT_EQ(Access::Strided, stream.account(32768U, 4096U));
+    EXPECT_EQ(Access::Strided, stream.account(49152U, 4096U));
+    // backward jump breaks the stride, re-reading the same offset is not a stride
+    EXPECT_EQ(Access::Random, stream.account(8192U, 4096U));
+    EXPECT_EQ(Access::Random, stream.account(8192U, 4096U));
+
+    EXPECT_EQ(0U, stream.counters().sequential);
+    EXPECT_EQ(2U, stream.counters().strided);
+    EXPECT_EQ(3U, stream.counters().random);
+}
+
+TEST(AccessCounters, size_buckets)
+{
+    EXPECT_EQ(0U, AccessCounters::sizeBucket(0U));
+    EXPECT_EQ(0U, AccessCounters::sizeBucket(512U));
+    EXPECT_EQ(1U, AccessCounters::sizeBucket(513U));
+    EXPECT_EQ(3U, AccessCounters::sizeBucket(4096U));
+    EXPECT_EQ(11U, AccessCounters::sizeBucket(1048576U));
+    EXPECT_EQ(12U, AccessCounters::sizeBucket(1048577U));
+    EXPECT_EQ(12U, AccessCounters::sizeBucket(uint64_t{1} << 40));
+    EXPECT_STREQ("<=4K", AccessCounters::bucketLabel(3U));
+    EXPECT_STREQ(">1M", AccessCounters::bucketLabel(12U));
+}
+//------------------------------------------------------------------------------
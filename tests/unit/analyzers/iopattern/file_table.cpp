@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of bounded LRU table of files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "file_table.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+FileHandle handle(uint32_t id)
+{
+    char data[32] = {};
+    memcpy(data, &id, sizeof(id));
+    return FileHandle{data, sizeof(data)};
+}
+
+}
+//------------------------------------------------------------------------------
+TEST(FileHandle, key)
+{
+    const char data[] = {0x01, 0x02, 0x7f};
+    FileHandle fh{data, sizeof(data)};
+
+    EXPECT_EQ(3U, fh.length);
+    EXPECT_EQ("01027f", fh.str());
+    EXPECT_TRUE(fh == (FileHandle{data, sizeof(data)}));
+    EXPECT_FALSE(fh == (FileHandle{data, 2U}));
+
+    // too long handles are truncated instead of growing the key
+    std::vector<char> longHandle(FileHandle::MaxSize + 10U, 'x');
+    EXPECT_EQ(FileHandle::MaxSize, FileHandle(longHandle.data(), longHandle.size()).length);
+}
+
+TEST(FileTable, lru_eviction)
+{
+    FileTable table{2U};
+
+    table.find(handle(1)).reads.account(0U, 4096U);
+    table.find(handle(2)).reads.account(0U, 4096U);
+    table.find(handle(1)).reads.account(4096U, 4096U); // 1 is the most recent now
+    table.find(handle(3));                             // evicts 2
+
+    EXPECT_EQ(2U, table.size());
+    EXPECT_EQ(1U, table.evictedAmount());
+
+    auto files = table.files();
+    ASSERT_EQ(2U, files.size());
+    EXPECT_TRUE(files[0]->handle == handle(3));
+    EXPECT_TRUE(files[1]->handle == handle(1));
+    EXPECT_EQ(2U, files[1]->reads.counters().ops);
+
+    // evicted file starts from scratch
+    EXPECT_EQ(0U, table.find(handle(2)).reads.counters().ops);
+    EXPECT_EQ(2U, table.evictedAmount());
+}
+
+TEST(FileTable, bounded)
+{
+    FileTable table{100U};
+
+    for (uint32_t i = 0; i < 100000U; ++i)
+    {
+        table.find(handle(i % 1000U)).writes.account(i, 512U);
+    }
+
+    EXPECT_EQ(100U, table.size());
+    EXPECT_EQ(100U, table.capacity());
+    EXPECT_EQ(100000U - 100U, table.evictedAmount());
+}
+//------------------------------------------------------------------------------
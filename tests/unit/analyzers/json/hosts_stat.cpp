@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of per-host statistics
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <arpa/inet.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "hosts_stat.h"
+//------------------------------------------------------------------------------
+using NST::API::Session;
+//------------------------------------------------------------------------------
+namespace
+{
+
+HostsStat::Address address(uint32_t client)
+{
+    Session session;
+    session.type = Session::TCP;
+    session.ip_type = Session::v4;
+    session.ip.v4.addr[Session::Source] = htonl(client);
+    session.ip.v4.addr[Session::Destination] = htonl(0x0A000001);
+    return HostsStat::Address{session, Session::Source};
+}
+
+}
+//------------------------------------------------------------------------------
+TEST(HostsStat, top)
+{
+    HostsStat stat{64U};
+
+    stat.account(address(0x0A000002), 1U, 0U, 0U, 0U);
+    stat.account(address(0x0A000003), 3U, 0U, 1U, 4096U);
+    stat.account(address(0x0A000004), 2U, 2U, 0U, 8192U);
+
+    auto byOps = stat.top(2U, HostsStat::SortKey::Ops);
+    ASSERT_EQ(2U, byOps.size());
+    EXPECT_EQ("10.0.0.3", byOps[0].address);
+    EXPECT_EQ(3U, byOps[0].ops);
+    EXPECT_EQ("10.0.0.4", byOps[1].address);
+
+    auto byBytes = stat.top(10U, HostsStat::SortKey::Bytes);
+    ASSERT_EQ(3U, byBytes.size());
+    EXPECT_EQ("10.0.0.4", byBytes[0].address);
+    EXPECT_EQ(8192U, byBytes[0].bytes);
+}
+
+TEST(HostsStat, eviction)
+{
+    HostsStat stat{HostsStat::ShardsAmount};
+    const uint32_t hostsAmount = 1000U;
+
+    for (uint32_t i = 0U; i < hostsAmount; ++i)
+    {
+        stat.account(address(0x0A000000 + i), 1U, 0U, 0U, 0U);
+    }
+
+    auto hosts = stat.top(hostsAmount, HostsStat::SortKey::Ops);
+    EXPECT_GE(HostsStat::ShardsAmount, hosts.size());
+    EXPECT_EQ(hostsAmount - hosts.size(), stat.evictedAmount());
+}
+
+TEST(HostsStat, active_host_survives_eviction)
+{
+    HostsStat stat{4U * HostsStat::ShardsAmount};
+    const HostsStat::Address active = address(0x0A000001);
+
+    for (uint32_t i = 2U; i < 1000U; ++i)
+    {
+        stat.account(active, 1U, 0U, 0U, 0U);
+        stat.account(address(0x0A000000 + i), 1U, 0U, 0U, 0U);
+    }
+
+    auto hosts = stat.top(1U, HostsStat::SortKey::Ops);
+    ASSERT_EQ(1U, hosts.size());
+    EXPECT_EQ("10.0.0.1", hosts[0].address);
+    EXPECT_EQ(998U, hosts[0].ops);
+    EXPECT_LT(0U, stat.evictedAmount());
+}
+
+TEST(HostsStat, sort_key)
+{
+    HostsStat::SortKey key = HostsStat::SortKey::Ops;
+
+    EXPECT_TRUE(HostsStat::parseSortKey("writes", key));
+    EXPECT_EQ(HostsStat::SortKey::Writes, key);
+    EXPECT_FALSE(HostsStat::parseSortKey("latency", key));
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,82 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests and scrape benchmark of OpenMetrics writer
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "open_metrics_writer.h"
+//------------------------------------------------------------------------------
+TEST(OpenMetricsWriter, counter)
+{
+    std::string output;
+    OpenMetricsWriter writer{output};
+
+    writer.family("nfstrace_nfs_procedures", "counter", "NFS procedures observed.");
+    writer.sample("nfstrace_nfs_procedures", "_total", "version=\"3\",procedure=\"read\"", 42U);
+    writer.sample("nfstrace_parse_errors", "_total", "", 0U);
+    writer.finish();
+
+    EXPECT_EQ("# TYPE nfstrace_nfs_procedures counter\n"
+              "# HELP nfstrace_nfs_procedures NFS procedures observed.\n"
+              "nfstrace_nfs_procedures_total{version=\"3\",procedure=\"read\"} 42\n"
+              "nfstrace_parse_errors_total 0\n"
+              "# EOF\n", output);
+}
+
+TEST(OpenMetricsWriter, histogram)
+{
+    const uint64_t bounds[]  = {250U, 1000000U};
+    const uint64_t buckets[] = {1U, 2U, 3U};
+    std::string output;
+    OpenMetricsWriter writer{output};
+
+    writer.histogram("lat_seconds", "version=\"4.1\"", bounds, buckets, 2U, 2500100U);
+
+    EXPECT_EQ("lat_seconds_bucket{version=\"4.1\",le=\"0.00025\"} 1\n"
+              "lat_seconds_bucket{version=\"4.1\",le=\"1.0\"} 3\n"
+              "lat_seconds_bucket{version=\"4.1\",le=\"+Inf\"} 6\n"
+              "lat_seconds_sum{version=\"4.1\"} 2.5001\n"
+              "lat_seconds_count{version=\"4.1\"} 6\n", output);
+}
+
+TEST(OpenMetricsWriter, scrape_1000_series)
+{
+    constexpr std::size_t SeriesAmount = 1000U;
+
+    std::string output;
+    std::string expected = "# TYPE nfstrace_nfs_operations counter\n"
+                           "# HELP nfstrace_nfs_operations NFSv4.x operations of COMPOUND procedures observed.\n";
+    OpenMetricsWriter writer{output};
+    writer.family("nfstrace_nfs_operations", "counter", "NFSv4.x operations of COMPOUND procedures observed.");
+    for (std::size_t i = 0U; i < SeriesAmount; ++i)
+    {
+        const std::string labels = "version=\"4.1\",operation=\"op" + std::to_string(i) + '"';
+        writer.sample("nfstrace_nfs_operations", "_total", labels, i * 1000U);
+        expected += "nfstrace_nfs_operations_total{" + labels + "} " + std::to_string(i * 1000U) + '\n';
+    }
+    writer.finish();
+    expected += "# EOF\n";
+
+    EXPECT_EQ(expected, output);
+}
+//------------------------------------------------------------------------------
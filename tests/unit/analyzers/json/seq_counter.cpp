@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests and throughput benchmark of single-writer counters
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "seq_counter.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+struct BlockCounters
+{
+    enum Index : std::size_t
+    {
+        nullProcsAmount,
+        getattrProcsAmount,
+        readProcsAmount,
+        writeProcsAmount,
+        Amount
+    };
+};
+
+struct alignas(64) Block : BlockCounters, SeqCounters<BlockCounters::Amount>
+{
+};
+
+}
+//------------------------------------------------------------------------------
+TEST(SeqCounter, increment)
+{
+    Block block;
+
+    block.increment(Block::getattrProcsAmount);
+    block.increment(Block::getattrProcsAmount);
+    block.increment(Block::writeProcsAmount);
+
+    uint64_t values[Block::CountersAmount] = {};
+    block.read([&]()
+    {
+        for (std::size_t i = 0U; i < Block::CountersAmount; ++i)
+        {
+            values[i] = block.load(i);
+        }
+    });
+    EXPECT_EQ(0U, values[Block::nullProcsAmount]);
+    EXPECT_EQ(2U, values[Block::getattrProcsAmount]);
+    EXPECT_EQ(0U, values[Block::readProcsAmount]);
+    EXPECT_EQ(1U, values[Block::writeProcsAmount]);
+}
+
+TEST(SeqCounter, counters_share_lock_of_block)
+{
+    // a counter is a bare 64-bit value, the block has a single lock
+    EXPECT_EQ((Block::CountersAmount + 1U) * sizeof(uint64_t), sizeof(SeqCounters<Block::CountersAmount>));
+    EXPECT_EQ(64U, sizeof(Block));
+}
+
+TEST(SeqCounter, consistent_snapshot)
+{
+    constexpr uint64_t WritesAmount = 1000000U;
+    SeqLock lock;
+    std::atomic<uint64_t> first{0U};
+    std::atomic<uint64_t> second{0U};
+
+    std::thread writer([&]()
+    {
+        for (uint64_t i = 1U; i <= WritesAmount; ++i)
+        {
+            SeqLock::WriteGuard guard{lock};
+            first.store(i, std::memory_order_relaxed);
+            second.store(i, std::memory_order_relaxed);
+        }
+    });
+
+    uint64_t a = 0U;
+    uint64_t b = 0U;
+    do
+    {
+        lock.read([&]()
+        {
+            a = first.load(std::memory_order_relaxed);
+            b = second.load(std::memory_order_relaxed);
+        });
+        ASSERT_EQ(a, b);
+    }
+    while (a != WritesAmount);
+    writer.join();
+}
+
+TEST(SeqCounter, snapshot_of_block_is_consistent)
+{
+    // the writer increments all counters of the block in turn,
+    // so values of a snapshot differ by one at most and never decrease
+    constexpr uint64_t RoundsAmount = 100000U;
+    Block block;
+
+    std::thread writer([&]()
+    {
+        for (uint64_t round = 0U; round < RoundsAmount; ++round)
+        {
+            for (std::size_t i = 0U; i < Block::CountersAmount; ++i)
+            {
+                block.increment(i);
+            }
+        }
+    });
+
+    uint64_t previous = 0U;
+    uint64_t values[Block::CountersAmount] = {};
+    do
+    {
+        block.read([&]()
+        {
+            for (std::size_t i = 0U; i < Block::CountersAmount; ++i)
+            {
+                values[i] = block.load(i);
+            }
+        });
+        for (std::size_t i = 1U; i < Block::CountersAmount; ++i)
+        {
+            ASSERT_LE(values[i], values[i - 1U]);
+            ASSERT_LE(values[i - 1U], values[i] + 1U);
+        }
+        ASSERT_LE(previous, values[0]);
+        previous = values[0];
+    }
+    while (values[Block::CountersAmount - 1U] != RoundsAmount);
+    writer.join();
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of time-weighted queue depth
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "queue_depth.h"
+//------------------------------------------------------------------------------
+TEST(QueueDepth, overlapping)
+{
+    QueueDepth queue{1000U};
+
+    // replies are reported in order of reply time
+    queue.add(0U, 100U);
+    queue.add(50U, 150U);
+    queue.finish();
+
+    EXPECT_EQ(2U, queue.requestsAmount());
+    EXPECT_EQ(2U, queue.maxDepth());
+    EXPECT_EQ(0U, queue.lateAmount());
+    EXPECT_DOUBLE_EQ(200.0 / 150.0, queue.averageDepth());
+    EXPECT_DOUBLE_EQ(100.0, queue.averageLatency());
+    EXPECT_DOUBLE_EQ(2.0 * 1000000.0 / 150.0, queue.throughput());
+    EXPECT_DOUBLE_EQ(queue.throughput(), queue.littleThroughput());
+    EXPECT_DOUBLE_EQ(2.0 * 1000000.0 / 100.0, queue.maxDepthThroughput());
+}
+
+TEST(QueueDepth, back_to_back)
+{
+    QueueDepth queue{0U};
+
+    queue.add(0U, 10U);
+    queue.add(10U, 20U);
+    queue.add(25U, 25U);
+    queue.finish();
+
+    EXPECT_EQ(1U, queue.maxDepth());
+    EXPECT_EQ(0U, queue.lateAmount());
+    EXPECT_DOUBLE_EQ(20.0 / 25.0, queue.averageDepth());
+}
+
+TEST(QueueDepth, late_request)
+{
+    QueueDepth queue{10U};
+
+    queue.add(0U, 100U);
+    queue.add(200U, 300U);
+    queue.add(150U, 310U); // latency exceeds reorder window
+    queue.finish();
+
+    EXPECT_EQ(1U, queue.lateAmount());
+    EXPECT_EQ(2U, queue.maxDepth());
+    // area is exact even for late requests
+    EXPECT_DOUBLE_EQ(360.0 / 310.0, queue.averageDepth());
+}
+//------------------------------------------------------------------------------
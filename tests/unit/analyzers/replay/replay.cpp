@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of workload replay trace encoding and reading
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstdio>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "replay_encoder.h"
+#include "replay_reader.h"
+#include "replay_writer.h"
+//------------------------------------------------------------------------------
+using namespace Replay;
+
+namespace
+{
+
+class TemporaryFile
+{
+public:
+    TemporaryFile() : path{"/tmp/nfstrace-replay-XXXXXX"}
+    {
+        const int fd = mkstemp(&path[0]);
+        if (fd < 0)
+        {
+            throw std::runtime_error{"Can't create temporary file"};
+        }
+        close(fd);
+    }
+    ~TemporaryFile()
+    {
+        unlink(path.c_str());
+    }
+
+    std::string path;
+};
+
+Op makeOp(uint64_t timestamp, uint32_t client, uint32_t procedure)
+{
+    Op op{};
+    op.timestamp = timestamp;
+    op.client = client;
+    op.program = Program::NFSv3;
+    op.procedure = procedure;
+    op.latency = 250U;
+    return op;
+}
+
+}
+//------------------------------------------------------------------------------
+TEST(Replay, varint)
+{
+    const uint64_t values[] = {0U, 1U, 127U, 128U, 300U, 0xffffffffU, 0xffffffffffffffffULL};
+    for (uint64_t value : values)
+    {
+        uint8_t buffer[MaxVarintSize];
+        const uint8_t* end = putVarint(buffer, value);
+        uint64_t decoded;
+        EXPECT_EQ(end, getVarint(buffer, end, decoded));
+        EXPECT_EQ(value, decoded);
+        EXPECT_EQ(nullptr, getVarint(buffer, end - 1, decoded));
+    }
+    EXPECT_EQ(-5, unzigzag(zigzag(-5)));
+    EXPECT_EQ(1U, zigzag(-1));
+}
+
+TEST(Replay, interning)
+{
+    ReplayEncoder encoder;
+    const uint8_t address[] = {10, 0, 0, 1};
+
+    EXPECT_EQ(0U, encoder.client(address, sizeof(address)));
+    EXPECT_EQ(0U, encoder.client(address, sizeof(address)));
+    EXPECT_EQ(0U, encoder.handle("fh-a", 4U));
+    EXPECT_EQ(1U, encoder.handle("fh-b", 4U));
+    EXPECT_EQ(0U, encoder.handle("fh-a", 4U));
+    EXPECT_EQ(0U, encoder.name("file", 4U));
+
+    // operation on known dictionary entries is about 20 bytes or less
+    Op op = makeOp(1434000000000000U, 0U, 6U);
+    encoder.op(op);
+    op.timestamp += 1500U;
+    op.fields = Field::Status | Field::Handle | Field::Offset | Field::Count;
+    op.handle = 1U;
+    op.offset = 1048576U;
+    op.count = 32768U;
+    const std::size_t before = encoder.buffer().size();
+    encoder.op(op);
+    EXPECT_GE(20U, encoder.buffer().size() - before);
+}
+
+TEST(Replay, round_trip)
+{
+    TemporaryFile file;
+    std::vector<Op> ops;
+    {
+        ReplayEncoder encoder;
+        ReplayWriter writer{file.path};
+        const uint8_t client4[] = {192, 168, 0, 10};
+        const uint8_t client6[] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+        for (uint32_t i = 0; i < 10000U; ++i)
+        {
+            // replies are not ordered by call time, so deltas may be negative
+            Op op = makeOp(1434000000000000U + i * 100U - (i % 3U) * 250U,
+                           i % 2U ? encoder.client(client4, sizeof(client4)) : encoder.client(client6, sizeof(client6)),
+                           i % 22U);
+            op.latency = i;
+            op.fields = Field::Status | Field::Handle;
+            op.status = i % 5U;
+            const std::string handle = "handle-" + std::to_string(i % 100U);
+            op.handle = encoder.handle(handle.data(), handle.size());
+            if (i % 4U == 0U)
+            {
+                const std::string name = "name-" + std::to_string(i % 7U);
+                op.fields |= Field::Name | Field::Name2 | Field::Handle2;
+                op.name = encoder.name(name.data(), name.size());
+                op.name2 = encoder.name("target", 6U);
+                op.handle2 = encoder.handle("dir", 3U);
+            }
+            if (i % 3U == 0U)
+            {
+                op.fields |= Field::Offset | Field::Count;
+                op.offset = static_cast<uint64_t>(i) << 20;
+                op.count = 4096U;
+            }
+            encoder.op(op);
+            ops.push_back(op);
+            // small buffer makes writer swap buffers many times
+            if (encoder.buffer().size() >= 4096U)
+            {
+                writer.submit(encoder.buffer());
+            }
+        }
+        writer.submit(encoder.buffer());
+        writer.flush();
+        EXPECT_FALSE(writer.failed());
+    }
+
+    ReplayReader reader{file.path};
+    Op op;
+    for (const Op& expected : ops)
+    {
+        ASSERT_TRUE(reader.next(op));
+        EXPECT_EQ(expected.timestamp, op.timestamp);
+        EXPECT_EQ(expected.client, op.client);
+        EXPECT_EQ(expected.program, op.program);
+        EXPECT_EQ(expected.procedure, op.procedure);
+        EXPECT_EQ(expected.latency, op.latency);
+        EXPECT_EQ(expected.fields, op.fields);
+        EXPECT_EQ(expected.status, op.status);
+        EXPECT_EQ(expected.handle, op.handle);
+        EXPECT_EQ(expected.name, op.name);
+        EXPECT_EQ(expected.offset, op.offset);
+        EXPECT_EQ(expected.count, op.count);
+        EXPECT_EQ(expected.handle2, op.handle2);
+        EXPECT_EQ(expected.name2, op.name2);
+    }
+    EXPECT_FALSE(reader.next(op));
+
+    EXPECT_EQ(2U, reader.clientsAmount());
+    EXPECT_EQ(16U, reader.client(0).size());
+    EXPECT_EQ(4U, reader.client(1).size());
+    EXPECT_EQ(101U, reader.handlesAmount());
+    EXPECT_EQ("handle-0", reader.handle(0));
+    EXPECT_EQ("name-0", reader.name(0));
+    EXPECT_EQ("target", reader.name(1));
+    EXPECT_THROW(reader.name(100), std::out_of_range);
+}
+
+TEST(Replay, malformed)
+{
+    TemporaryFile file;
+    EXPECT_THROW(ReplayReader{file.path}, std::runtime_error);
+
+    {
+        ReplayEncoder encoder;
+        encoder.op(makeOp(1U, 0U, 1U));
+        // cut the last byte of op
+        FILE* out = fopen(file.path.c_str(), "wb");
+        ASSERT_NE(nullptr, out);
+        fwrite(encoder.buffer().data(), 1, encoder.buffer().size() - 1U, out);
+        fclose(out);
+    }
+    ReplayReader reader{file.path};
+    Op op;
+    EXPECT_THROW(reader.next(op), std::runtime_error);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of slot table of NFSv4.1 session
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "slot_table.h"
+//------------------------------------------------------------------------------
+namespace
+{
+
+SlotTable::Request sequence(uint64_t call, uint64_t reply, uint32_t slot, uint32_t seq)
+{
+    SlotTable::Request request{};
+    request.call = call;
+    request.reply = reply;
+    request.slot = slot;
+    request.sequence = seq;
+    request.highestSlot = slot;
+    request.hasResult = true;
+    request.serverHighestSlot = 3U;
+    request.targetHighestSlot = 3U;
+    return request;
+}
+
+}
+//------------------------------------------------------------------------------
+TEST(SlotTable, sequence_ids)
+{
+    SlotTable table{4U, 1000U};
+
+    table.add(sequence(0U, 10U, 0U, 1U));
+    table.add(sequence(10U, 20U, 0U, 2U));
+    table.add(sequence(20U, 30U, 0U, 2U)); // retry
+    table.add(sequence(30U, 40U, 0U, 5U)); // gap
+    table.add(sequence(40U, 50U, 1U, 7U)); // first use of slot
+    table.add(sequence(50U, 60U, 4U, 1U)); // beyond negotiated size
+
+    EXPECT_EQ(6U, table.requestsAmount());
+    EXPECT_EQ(1U, table.retriesAmount());
+    EXPECT_EQ(1U, table.misorderedAmount());
+    EXPECT_EQ(1U, table.outOfTableAmount());
+    EXPECT_EQ(4U, table.slotRequests(0U));
+    EXPECT_EQ(1U, table.slotRequests(1U));
+    EXPECT_EQ(0U, table.slotRequests(4U));
+    EXPECT_EQ(1U, table.maxSlot());
+}
+
+TEST(SlotTable, failed_sequence_keeps_slot_state)
+{
+    SlotTable table{0U, 1000U};
+
+    table.add(sequence(0U, 10U, 2U, 1U));
+    SlotTable::Request misordered = sequence(10U, 20U, 2U, 9U);
+    misordered.failed = true;
+    misordered.hasResult = false;
+    table.add(misordered);
+    table.addError(SlotTable::Error::SeqMisordered);
+    table.add(sequence(20U, 30U, 2U, 2U));
+
+    EXPECT_EQ(0U, table.misorderedAmount());
+    EXPECT_EQ(1U, table.errorsAmount(SlotTable::Error::SeqMisordered));
+    EXPECT_EQ(0U, table.errorsAmount(SlotTable::Error::Delay));
+    EXPECT_EQ(3U, table.size()); // unknown size grows up to the highest slot
+    EXPECT_EQ(2U, table.slotRequests(2U));
+}
+
+TEST(SlotTable, highest_slots)
+{
+    SlotTable table{0U, 1000U};
+
+    SlotTable::Request request = sequence(0U, 10U, 0U, 1U);
+    request.highestSlot = 7U;
+    request.serverHighestSlot = 63U;
+    request.targetHighestSlot = 31U;
+    table.add(request);
+    request = sequence(10U, 20U, 0U, 2U);
+    request.highestSlot = 3U;
+    request.serverHighestSlot = 63U;
+    request.targetHighestSlot = 15U;
+    table.add(request);
+    request = sequence(20U, 30U, 0U, 3U);
+    request.highestSlot = 3U;
+    request.serverHighestSlot = 63U;
+    request.targetHighestSlot = 31U;
+    table.add(request);
+
+    EXPECT_EQ(3U, table.highestSlot());
+    EXPECT_EQ(7U, table.maxHighestSlot());
+    EXPECT_TRUE(table.hasResult());
+    EXPECT_EQ(63U, table.serverHighestSlot());
+    EXPECT_EQ(31U, table.targetHighestSlot());
+    EXPECT_EQ(15U, table.minTargetHighestSlot());
+    EXPECT_EQ(1U, table.targetDecreasesAmount());
+}
+
+TEST(SlotTable, utilization)
+{
+    SlotTable table{2U, 100U};
+
+    // both slots are busy during the first interval, one slot in the second one
+    table.add(sequence(0U, 100U, 0U, 1U));
+    table.add(sequence(0U, 100U, 1U, 1U));
+    table.add(sequence(100U, 200U, 0U, 2U));
+    table.finish();
+
+    EXPECT_DOUBLE_EQ(300.0 / 400.0, table.utilization());
+    EXPECT_DOUBLE_EQ(1.0, table.peakUtilization());
+}
+
+TEST(SlotTable, slot_wait)
+{
+    SlotTable table{4U, 1000U};
+
+    // target highest slot 3 is known after the first reply
+    table.add(sequence(0U, 10U, 0U, 1U));
+    // slot 3 exhausts the table at 100 until the next call at 130
+    table.add(sequence(100U, 200U, 3U, 1U));
+    table.add(sequence(130U, 150U, 1U, 1U));
+    // slot 3 again, the next call is after its reply, so wait is limited by it
+    table.add(sequence(300U, 320U, 3U, 2U));
+    table.add(sequence(400U, 410U, 0U, 2U));
+    table.finish();
+
+    EXPECT_EQ(2U, table.exhaustionsAmount());
+    EXPECT_EQ(30U + 20U, table.waitTime());
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of SMB2 credits accounting and compound chains
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstring>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "compound_chain.h"
+#include "credit_balance.h"
+//------------------------------------------------------------------------------
+using NST::protocols::CIFSv2::RawMessageHeader;
+using NST::protocols::CIFSv2::SMBv2Commands;
+
+namespace
+{
+
+//! Appends SMB2 header, offset of the previous one is set to the new one
+void append(std::vector<uint8_t>& message, std::size_t& last, SMBv2Commands command, int16_t charge, int16_t credit)
+{
+    const std::size_t offset = (message.size() + 7U) & ~std::size_t{7U};
+    if (!message.empty())
+    {
+        reinterpret_cast<RawMessageHeader*>(&message[last])->nextCommand = static_cast<int32_t>(offset - last);
+    }
+    message.resize(offset + sizeof(RawMessageHeader) + 20U); // header and some body
+    RawMessageHeader* header = reinterpret_cast<RawMessageHeader*>(&message[offset]);
+    memset(header, 0, sizeof(RawMessageHeader));
+    header->cmd_code = command;
+    header->CreditCharge = charge;
+    header->Credit = credit;
+    last = offset;
+}
+
+const RawMessageHeader* first(const std::vector<uint8_t>& message)
+{
+    return reinterpret_cast<const RawMessageHeader*>(message.data());
+}
+
+}
+//------------------------------------------------------------------------------
+TEST(CompoundChain, walk)
+{
+    std::vector<uint8_t> message;
+    std::size_t last = 0U;
+    append(message, last, SMBv2Commands::CREATE, 1, 10);
+    append(message, last, SMBv2Commands::READ, 4, 20);
+    append(message, last, SMBv2Commands::CLOSE, 0, 30);
+
+    CompoundChain requests = chargedCredits(first(message), message.size());
+    EXPECT_EQ(3U, requests.length);
+    EXPECT_EQ(6U, requests.credits); // zero charge costs one credit
+
+    CompoundChain responses = grantedCredits(first(message), message.size());
+    EXPECT_EQ(3U, responses.length);
+    EXPECT_EQ(60U, responses.credits);
+
+    // Truncated message: the last header is not captured
+    requests = chargedCredits(first(message), last + sizeof(RawMessageHeader) - 1U);
+    EXPECT_EQ(2U, requests.length);
+    EXPECT_EQ(5U, requests.credits);
+}
+
+TEST(CompoundChain, cancel_is_free)
+{
+    std::vector<uint8_t> message;
+    std::size_t last = 0U;
+    append(message, last, SMBv2Commands::CANCEL, 1, 0);
+
+    const CompoundChain requests = chargedCredits(first(message), message.size());
+    EXPECT_EQ(1U, requests.length);
+    EXPECT_EQ(0U, requests.credits);
+}
+
+TEST(CreditBalance, not_anchored)
+{
+    CreditBalance balance{1000U};
+    balance.add(0U, 1U, 10U, 2U);
+    balance.add(20U, 3U, 30U, 3U);
+    balance.finish();
+
+    EXPECT_FALSE(balance.anchored());
+    EXPECT_EQ(2U, balance.requestsAmount());
+    EXPECT_EQ(4U, balance.chargedAmount());
+    EXPECT_EQ(5U, balance.grantedAmount());
+    EXPECT_EQ(0U, balance.starvationsAmount());
+}
+
+TEST(CreditBalance, starvation)
+{
+    CreditBalance balance{1000U};
+    // NEGOTIATE grants one credit only
+    balance.add(0U, 1U, 100U, 1U);
+    balance.anchor(100U, 1U);
+    // Client has to wait for each response
+    balance.add(100U, 1U, 300U, 1U);
+    balance.add(300U, 1U, 400U, 2U);
+    // Now two requests fit, the response grants back one credit
+    balance.add(400U, 1U, 500U, 1U);
+    balance.add(410U, 1U, 600U, 1U);
+    balance.finish();
+
+    EXPECT_TRUE(balance.anchored());
+    EXPECT_EQ(5U, balance.requestsAmount());
+    EXPECT_EQ(3U, balance.starvationsAmount());
+    EXPECT_EQ(200U + 100U + 90U, balance.starvedTime());
+    EXPECT_EQ(200U, balance.longestStarvation());
+    EXPECT_EQ(2U, balance.maxBalance());
+    EXPECT_EQ(2U, balance.balance());
+    EXPECT_DOUBLE_EQ(390.0 / 500.0, balance.starvedShare());
+    EXPECT_EQ(0U, balance.overdrawnAmount());
+}
+
+TEST(CreditBalance, reorder_window)
+{
+    CreditBalance balance{100U};
+    balance.anchor(0U, 2U);
+    // Replies are seen out of order of calls
+    balance.add(10U, 1U, 50U, 1U);
+    balance.add(0U, 1U, 60U, 1U);
+    balance.add(500U, 1U, 510U, 1U);
+    // Sweep has passed the call, it is charged at the time of the last swept event
+    balance.add(30U, 1U, 520U, 1U);
+    balance.finish();
+
+    EXPECT_EQ(1U, balance.lateAmount());
+    EXPECT_EQ(0U, balance.overdrawnAmount());
+    EXPECT_EQ(2U, balance.starvationsAmount());
+    EXPECT_EQ(40U + 10U, balance.starvedTime()); // both credits are in flight from 10 till 50 and from 500 till 510
+    EXPECT_EQ(2U, balance.balance());
+}
+
+TEST(CreditBalance, overdrawn)
+{
+    CreditBalance balance{1000U};
+    balance.anchor(0U, 1U);
+    balance.add(10U, 4U, 20U, 4U);
+    balance.finish();
+
+    EXPECT_EQ(1U, balance.overdrawnAmount());
+    EXPECT_EQ(1U, balance.starvationsAmount());
+    EXPECT_EQ(10U, balance.starvedTime());
+    EXPECT_EQ(4U, balance.balance());
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,178 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of lines written by headless mode of watch plugin
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "headless_output.h"
+//------------------------------------------------------------------------------
+using MetricsStat = NST::API::MetricsStat;
+
+namespace
+{
+
+class TemporaryFile
+{
+public:
+    TemporaryFile() : path{"/tmp/nfstrace-watch-XXXXXX"}
+    {
+        const int fd = mkstemp(&path[0]);
+        if (fd < 0)
+        {
+            throw std::runtime_error{"Can't create temporary file"};
+        }
+        close(fd);
+    }
+    ~TemporaryFile()
+    {
+        unlink(path.c_str());
+    }
+
+    std::string content() const
+    {
+        std::ifstream file{path};
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    std::string path;
+};
+
+class TestProtocol : public AbstractProtocol
+{
+public:
+    TestProtocol() : AbstractProtocol{"Test Protocol", 3}
+    {
+    }
+
+    const char* printProcedure(std::size_t i) override
+    {
+        static const char* const names[] = {"null", "read", "write"};
+        return i < 3 ? names[i] : nullptr;
+    }
+};
+
+class HeadlessOutputTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // timestamps of lines are formatted in local time
+        setenv("TZ", "UTC", 1);
+        tzset();
+    }
+
+    // two intervals of 1 s: rates are {20, 0, 10}, averages are {15, 2.5, 25}
+    static void fill(ProtocolRates& rates)
+    {
+        const ProtocolRates::Clock::time_point start = ProtocolRates::Clock::now();
+        rates.update(ProtocolStatistic{0, 0, 0}, start);
+        rates.update(ProtocolStatistic{10, 5, 40}, start + std::chrono::seconds(1));
+        rates.update(ProtocolStatistic{30, 5, 50}, start + std::chrono::seconds(2));
+    }
+
+    TemporaryFile file;
+    TestProtocol protocol;
+};
+
+}
+//------------------------------------------------------------------------------
+TEST_F(HeadlessOutputTest, rates_and_movers)
+{
+    ProtocolRates rates{3};
+    fill(rates);
+    {
+        HeadlessOutput output{file.path, 3};
+        output.write(1000, protocol, rates);
+    }
+
+    // stopped procedure is not shown with rates but it is a mover
+    EXPECT_EQ("1970-01-01T00:16:40 TestProtocol total=30.0 avg=42.5 null=20.0 write=10.0"
+              " movers: write=-15.0 null=+5.0 read=-2.5\n", file.content());
+}
+
+TEST_F(HeadlessOutputTest, top_movers_only)
+{
+    ProtocolRates rates{3};
+    fill(rates);
+    {
+        HeadlessOutput output{file.path, 1};
+        output.write(1000, protocol, rates);
+    }
+
+    EXPECT_EQ("1970-01-01T00:16:40 TestProtocol total=30.0 avg=42.5 null=20.0 write=10.0"
+              " movers: write=-15.0\n", file.content());
+}
+
+TEST_F(HeadlessOutputTest, idle_protocol_is_skipped)
+{
+    const ProtocolRates::Clock::time_point start = ProtocolRates::Clock::now();
+    ProtocolRates idle{3};
+    idle.update(ProtocolStatistic{0, 0, 0}, start);
+    idle.update(ProtocolStatistic{0, 0, 0}, start + std::chrono::seconds(1));
+    ProtocolRates active{3};
+    fill(active);
+    {
+        HeadlessOutput output{file.path, 0};
+        output.write(1000, protocol, idle);
+        output.write(1001, protocol, active);
+        output.write(1001, protocol, idle);
+    }
+
+    EXPECT_EQ("1970-01-01T00:16:41 TestProtocol total=30.0 avg=42.5 null=20.0 write=10.0\n", file.content());
+}
+
+TEST_F(HeadlessOutputTest, intervals_with_pipeline)
+{
+    MetricsStat::Snapshot snapshot;
+    snapshot.size = 1;
+    snapshot.metrics[0] = MetricsStat::Metric{};
+    snapshot.metrics[0].name = "queue_elements";
+    snapshot.metrics[0].value = 12;
+    PipelineHealth health;
+
+    ProtocolRates rates{3};
+    fill(rates);
+    {
+        HeadlessOutput output{file.path, 0};
+        // pipeline line is skipped until metrics are known
+        output.write(1000, protocol, rates);
+        output.write(1000, health);
+        output.flush();
+        health.update(snapshot);
+        output.write(1001, protocol, rates);
+        output.write(1001, health);
+    }
+
+    EXPECT_EQ("1970-01-01T00:16:40 TestProtocol total=30.0 avg=42.5 null=20.0 write=10.0\n"
+              "1970-01-01T00:16:41 TestProtocol total=30.0 avg=42.5 null=20.0 write=10.0\n"
+              "1970-01-01T00:16:41 pipeline queue=12 free=0 exhausted=0 sessions=0 fragments=0 lost_bytes=0 xdr_errors=0\n",
+              file.content());
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of metrics of nfstrace pipeline shown by watch.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "pipeline_health.h"
+//------------------------------------------------------------------------------
+using MetricsStat = NST::API::MetricsStat;
+
+namespace
+{
+void set(MetricsStat::Snapshot& snapshot, const char* name, int64_t value)
+{
+    MetricsStat::Metric& metric = snapshot.metrics[snapshot.size++];
+    metric = MetricsStat::Metric{};
+    metric.name = name;
+    metric.value = value;
+}
+}
+
+TEST(PipelineHealth, unknown_before_update)
+{
+    PipelineHealth health;
+    std::string line {"garbage"};
+
+    EXPECT_FALSE(health.format(line));
+    EXPECT_TRUE(line.empty());
+}
+
+TEST(PipelineHealth, format)
+{
+    MetricsStat::Snapshot snapshot;
+    snapshot.size = 0;
+    set(snapshot, "queue_elements", 12);
+    set(snapshot, "queue_free_chunks", 4084);
+    set(snapshot, "message_bytes", 100); // not shown
+    set(snapshot, "tcp_lost_bytes", 1460);
+    set(snapshot, "sessions", 3);
+
+    PipelineHealth health;
+    health.update(snapshot);
+    std::string line;
+
+    ASSERT_TRUE(health.format(line));
+    // absent metrics are shown as zeros
+    EXPECT_EQ("queue=12 free=4084 exhausted=0 sessions=3 fragments=0 lost_bytes=1460 xdr_errors=0", line);
+}
+//------------------------------------------------------------------------------
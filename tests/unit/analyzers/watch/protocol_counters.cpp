@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Unit tests of counters and rates of protocol's procedures.
+// Copyright (c) 2015 EPAM Systems. All Rights Reserved.
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "protocol_counters.h"
+//------------------------------------------------------------------------------
+TEST(ProtocolCounters, account)
+{
+    ProtocolCounters counters {3};
+    ProtocolStatistic statistic;
+
+    counters.account(0);
+    counters.account(2);
+    counters.account(2);
+    counters.account(3); // out of range, ignored
+    counters.load(statistic);
+
+    ASSERT_EQ(3U, statistic.size());
+    EXPECT_EQ(1U, statistic[0]);
+    EXPECT_EQ(0U, statistic[1]);
+    EXPECT_EQ(2U, statistic[2]);
+}
+
+TEST(ProtocolRates, rates_and_averages)
+{
+    const ProtocolRates::Clock::time_point start = ProtocolRates::Clock::now();
+    ProtocolRates rates {1};
+
+    rates.update(ProtocolStatistic{0}, start);
+    rates.update(ProtocolStatistic{100}, start + std::chrono::seconds(1));
+    rates.update(ProtocolStatistic{400}, start + std::chrono::seconds(2));
+
+    EXPECT_EQ(400U, rates.getCounters()[0]);
+    EXPECT_DOUBLE_EQ(300.0, rates.getRates()[0]);
+    EXPECT_DOUBLE_EQ(200.0, rates.getAverages()[0]);
+}
+
+TEST(ProtocolRates, moving_window)
+{
+    const ProtocolRates::Clock::time_point start = ProtocolRates::Clock::now();
+    ProtocolRates rates {1};
+
+    // 1000 ops/s during first second, 10 ops/s afterwards
+    rates.update(ProtocolStatistic{0}, start);
+    std::size_t counter = 1000;
+    for (std::size_t i = 1; i <= ProtocolRates::AVERAGE_INTERVALS + 1; ++i)
+    {
+        rates.update(ProtocolStatistic{counter}, start + std::chrono::seconds(i));
+        counter += 10;
+    }
+
+    EXPECT_DOUBLE_EQ(10.0, rates.getRates()[0]);
+    EXPECT_DOUBLE_EQ(10.0, rates.getAverages()[0]);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,537 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of the writer thread of dump mode
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "filtration/dump_index.h"
+#include "filtration/dump_writer.h"
+//------------------------------------------------------------------------------
+using namespace NST::filtration;
+//------------------------------------------------------------------------------
+namespace
+{
+
+class DumpFile : public ::testing::Test
+{
+protected:
+    DumpFile()
+    {
+        char temp[] {"/tmp/nfstrace-test-XXXXXX"};
+        directory = mkdtemp(temp);
+        path = directory + "/dump.pcap";
+    }
+
+    ~DumpFile()
+    {
+        for(const auto& file : files())
+        {
+            unlink((directory + '/' + file).c_str());
+        }
+        rmdir(directory.c_str());
+    }
+
+    DumpWriter::Params params(uint32_t size_limit,
+                              DumpWriter::Compression compression = DumpWriter::Compression::None) const
+    {
+        return DumpWriter::Params{path, "", size_limit, 0, 0, 0, 1, 65535, compression, 1, 2};
+    }
+
+    std::string name(int part) const
+    {
+        return part ? path + '-' + std::to_string(part) : path;
+    }
+
+    //! Names of files in the directory
+    std::set<std::string> files() const
+    {
+        std::set<std::string> names;
+        if(DIR* dir = opendir(directory.c_str()))
+        {
+            while(const dirent* entry = readdir(dir))
+            {
+                if(entry->d_name[0] != '.')
+                {
+                    names.insert(entry->d_name);
+                }
+            }
+            closedir(dir);
+        }
+        return names;
+    }
+
+    std::string uncompressed(int part) const
+    {
+        return uncompressed(name(part) + ".gz");
+    }
+
+    std::string uncompressed(const std::string& file_name) const
+    {
+        std::string data;
+        gzFile file {gzopen(file_name.c_str(), "rb")};
+        if(file)
+        {
+            char buffer[4096];
+            int n;
+            while((n = gzread(file, buffer, sizeof(buffer))) > 0)
+            {
+                data.append(buffer, n);
+            }
+            gzclose(file);
+        }
+        return data;
+    }
+
+    std::string content(int part) const
+    {
+        return content(name(part));
+    }
+
+    std::string content(const std::string& file_name) const
+    {
+        std::ifstream file{file_name, std::ios::binary};
+        std::stringstream data;
+        data << file.rdbuf();
+        return data.str();
+    }
+
+    bool exists(int part) const
+    {
+        return access(name(part).c_str(), F_OK) == 0;
+    }
+
+    void push(DumpWriter& writer, uint32_t size, u_char fill)
+    {
+        const std::vector<u_char> packet(size, fill);
+        pcap_pkthdr header;
+        header.ts.tv_sec  = 1000;
+        header.ts.tv_usec = 20;
+        header.caplen     = size;
+        header.len        = size + 4;
+        ASSERT_TRUE(writer.push(&header, packet.data()));
+    }
+
+    std::string directory;
+    std::string path;
+};
+
+const std::size_t FileHeader {24};
+const std::size_t RecordHeader {16};
+
+//! Ethernet II + IPv4 + TCP packet
+std::vector<u_char> tcp_packet(uint8_t src, uint16_t sport, uint8_t dst, uint16_t dport, uint32_t payload)
+{
+    std::vector<u_char> packet(14 + 20 + 20 + payload, 0);
+    packet[12] = 0x08;                  // IP
+    u_char* ip {&packet[14]};
+    ip[0] = 0x45;                       // version and IHL
+    ip[2] = (20 + 20 + payload) >> 8;   // total length
+    ip[3] = (20 + 20 + payload) & 0xff;
+    ip[8] = 64;                         // TTL
+    ip[9] = 6;                          // TCP
+    const u_char src_address[] {10, 0, 0, src};
+    const u_char dst_address[] {10, 0, 0, dst};
+    memcpy(ip + 12, src_address, 4);
+    memcpy(ip + 16, dst_address, 4);
+    u_char* tcp {ip + 20};
+    tcp[0]  = sport >> 8;
+    tcp[1]  = sport & 0xff;
+    tcp[2]  = dport >> 8;
+    tcp[3]  = dport & 0xff;
+    tcp[12] = 0x50;                     // offset of data
+    return packet;
+}
+
+void push_packet(DumpWriter& writer, const std::vector<u_char>& packet, uint32_t seconds)
+{
+    pcap_pkthdr header;
+    header.ts.tv_sec  = seconds;
+    header.ts.tv_usec = 0;
+    header.caplen     = packet.size();
+    header.len        = packet.size();
+    ASSERT_TRUE(writer.push(&header, packet.data()));
+}
+
+} // unnamed namespace
+
+TEST_F(DumpFile, records_follow_header)
+{
+    {
+        DumpWriter writer{params(0)};
+        push(writer, 100, 'a');
+        push(writer, 5000, 'b'); // unaligned sizes
+    }
+    const std::string data {content(0)};
+    ASSERT_EQ(FileHeader + RecordHeader + 100 + RecordHeader + 5000, data.size());
+
+    uint32_t header[6];
+    memcpy(header, data.data(), sizeof(header));
+    EXPECT_EQ(0xa1b2c3d4, header[0]);
+    EXPECT_EQ(65535U, header[4]);   // snaplen
+    EXPECT_EQ(1U, header[5]);       // linktype
+
+    uint32_t record[4];
+    memcpy(record, data.data() + FileHeader, sizeof(record));
+    EXPECT_EQ(1000U, record[0]);
+    EXPECT_EQ(20U,   record[1]);
+    EXPECT_EQ(100U,  record[2]);
+    EXPECT_EQ(104U,  record[3]);
+    EXPECT_EQ(std::string(100, 'a'), data.substr(FileHeader + RecordHeader, 100));
+    EXPECT_EQ(std::string(5000, 'b'), data.substr(FileHeader + 2 * RecordHeader + 100));
+}
+
+TEST_F(DumpFile, empty_dump_has_header)
+{
+    {
+        DumpWriter writer{params(0)};
+    }
+    EXPECT_EQ(FileHeader, content(0).size());
+}
+
+TEST_F(DumpFile, many_blocks_are_written_in_order)
+{
+    const uint32_t size {60000};
+    const int amount {static_cast<int>(2 * DumpWriter::Blocks * DumpWriter::BlockSize / size)};
+    {
+        DumpWriter writer{params(0)};
+        for(int i = 0; i < amount; ++i)
+        {
+            const std::vector<u_char> packet(size, static_cast<u_char>(i));
+            pcap_pkthdr header;
+            header.ts.tv_sec  = i;
+            header.ts.tv_usec = 0;
+            header.caplen     = size;
+            header.len        = size;
+            // the ring may be full, the writer is given a time to catch up
+            while(!writer.push(&header, packet.data()))
+            {
+                usleep(1000);
+            }
+        }
+    }
+    const std::string data {content(0)};
+    ASSERT_EQ(FileHeader + amount * (RecordHeader + size), data.size());
+    for(int i = 0; i < amount; ++i)
+    {
+        const std::size_t offset {FileHeader + i * (RecordHeader + size)};
+        uint32_t seconds;
+        memcpy(&seconds, data.data() + offset, sizeof(seconds));
+        ASSERT_EQ(static_cast<uint32_t>(i), seconds);
+        ASSERT_EQ(static_cast<char>(i), data[offset + RecordHeader + size - 1]);
+    }
+}
+
+TEST_F(DumpFile, parts_are_rotated_by_size)
+{
+    {
+        // 3 records of 1016 bytes in a part
+        DumpWriter writer{params(3100)};
+        for(int i = 0; i < 7; ++i)
+        {
+            push(writer, 1000, 'a' + i);
+        }
+    }
+    EXPECT_EQ(FileHeader + 3 * 1016, content(0).size());
+    EXPECT_EQ(3 * 1016U, content(1).size()); // without header
+    EXPECT_EQ(1016U, content(2).size());
+    EXPECT_EQ(std::string(1000, 'd'), content(1).substr(RecordHeader, 1000));
+    EXPECT_FALSE(exists(3)); // pre-opened part is removed
+}
+
+TEST_F(DumpFile, existing_file_of_unused_part_is_kept)
+{
+    {
+        std::ofstream old{name(1)};
+        old << "previous run";
+    }
+    {
+        DumpWriter writer{params(3100)};
+        push(writer, 1000, 'a');
+    }
+    EXPECT_EQ(FileHeader + 1016, content(0).size());
+    EXPECT_EQ("previous run", content(1));
+    EXPECT_EQ((std::set<std::string>{"dump.pcap", "dump.pcap-1"}), files());
+}
+
+TEST_F(DumpFile, compressed_members_give_pcap)
+{
+    const uint32_t size {60000};
+    const int amount {100}; // several blocks compressed in parallel
+    {
+        DumpWriter writer{params(0, DumpWriter::Compression::Gzip)};
+        for(int i = 0; i < amount; ++i)
+        {
+            const std::vector<u_char> packet(size, static_cast<u_char>(i));
+            pcap_pkthdr header;
+            header.ts.tv_sec  = i;
+            header.ts.tv_usec = 0;
+            header.caplen     = size;
+            header.len        = size;
+            while(!writer.push(&header, packet.data()))
+            {
+                usleep(1000);
+            }
+        }
+    }
+    EXPECT_FALSE(exists(0));
+    const std::string data {uncompressed(0)};
+    ASSERT_EQ(FileHeader + amount * (RecordHeader + size), data.size());
+
+    uint32_t magic;
+    memcpy(&magic, data.data(), sizeof(magic));
+    EXPECT_EQ(0xa1b2c3d4, magic);
+    for(int i = 0; i < amount; ++i)
+    {
+        const std::size_t offset {FileHeader + i * (RecordHeader + size)};
+        uint32_t seconds;
+        memcpy(&seconds, data.data() + offset, sizeof(seconds));
+        ASSERT_EQ(static_cast<uint32_t>(i), seconds);
+        ASSERT_EQ(static_cast<char>(i), data[offset + RecordHeader + size - 1]);
+    }
+}
+
+TEST_F(DumpFile, compressed_parts_are_rotated_by_compressed_size)
+{
+    const uint32_t limit {64 * 1024};
+    const uint32_t size {30000};
+    {
+        DumpWriter writer{params(limit, DumpWriter::Compression::Gzip)};
+        // random bytes aren't compressed, so a part takes two blocks
+        std::vector<u_char> packet(size);
+        for(int i = 0; i < 6; ++i)
+        {
+            for(auto& byte : packet)
+            {
+                byte = static_cast<u_char>(rand());
+            }
+            pcap_pkthdr header;
+            header.ts.tv_sec  = i;
+            header.ts.tv_usec = 0;
+            header.caplen     = size;
+            header.len        = size;
+            ASSERT_TRUE(writer.push(&header, packet.data()));
+            writer.flush(); // a block per packet
+        }
+    }
+    std::size_t total {0};
+    for(int part = 0; part < 3; ++part)
+    {
+        struct stat info;
+        ASSERT_EQ(0, stat((name(part) + ".gz").c_str(), &info));
+        EXPECT_LE(info.st_size, limit);
+        total += uncompressed(part).size();
+    }
+    EXPECT_NE(0, access((name(3) + ".gz").c_str(), F_OK)); // pre-opened part is removed
+    EXPECT_EQ(FileHeader + 6 * (RecordHeader + size), total);
+}
+
+TEST_F(DumpFile, packet_limit_makes_standalone_parts_with_index)
+{
+    const std::vector<u_char> call  {tcp_packet(1, 1000, 2, 2049, 100)};
+    const std::vector<u_char> reply {tcp_packet(2, 2049, 1, 1000, 100)};
+    const std::vector<u_char> other {tcp_packet(3, 1001, 2, 2049, 100)};
+    const std::size_t record {RecordHeader + call.size()};
+    {
+        DumpWriter::Params p {params(0)};
+        p.packet_limit = 3;
+        p.index        = 2;
+        DumpWriter writer{p};
+        for(uint32_t i = 0; i < 7; ++i)
+        {
+            push_packet(writer, i % 3 == 2 ? other : (i % 2 ? reply : call), 100 + i);
+        }
+    }
+    EXPECT_EQ((std::set<std::string>{"dump.pcap", "dump.pcap-1", "dump.pcap-2",
+                                     "dump.pcap.idx", "dump.pcap-1.idx", "dump.pcap-2.idx"}), files());
+    EXPECT_EQ(FileHeader + 3 * record, content(0).size());
+    EXPECT_EQ(FileHeader + 3 * record, content(1).size()); // with header
+    EXPECT_EQ(FileHeader + 1 * record, content(2).size());
+
+    DumpIndex index;
+    ASSERT_TRUE(index.read(name(0)));
+    EXPECT_EQ(DumpIndex::Magic, index.header().magic);
+    EXPECT_EQ(0, index.header().flags);
+    ASSERT_EQ(2U, index.times().size()); // records 0 and 2
+    EXPECT_EQ(100U, index.times()[0].sec);
+    EXPECT_EQ(FileHeader, index.times()[0].offset);
+    EXPECT_EQ(102U, index.times()[1].sec);
+    EXPECT_EQ(FileHeader + 2 * record, index.times()[1].offset);
+    EXPECT_EQ(2U, index.times()[1].record);
+
+    // call and reply are the same flow
+    ASSERT_EQ(2U, index.flows().size());
+    const DumpIndex::Flow& flow {index.flows()[0]};
+    EXPECT_EQ(2U, flow.packets);
+    EXPECT_EQ(1000, flow.key.port[0]);
+    EXPECT_EQ(2049, flow.key.port[1]);
+    EXPECT_EQ(1, flow.key.address[0][3]);
+    EXPECT_EQ(6, flow.key.protocol);
+    EXPECT_EQ(FileHeader, flow.first_offset);
+    EXPECT_EQ(FileHeader + record, flow.last_offset);
+    EXPECT_EQ(101U, flow.last_sec);
+    EXPECT_EQ(FileHeader + 2 * record, index.flows()[1].first_offset);
+
+    // the record pointed by index is the one
+    const std::string data {content(0)};
+    uint32_t seconds;
+    memcpy(&seconds, data.data() + index.times()[1].offset, sizeof(seconds));
+    EXPECT_EQ(102U, seconds);
+}
+
+TEST_F(DumpFile, interval_parts_are_named_by_aligned_time)
+{
+    const std::vector<u_char> packet {tcp_packet(1, 1000, 2, 2049, 10)};
+    {
+        DumpWriter::Params p {params(0)};
+        p.interval = 60;
+        DumpWriter writer{p};
+        push_packet(writer, packet, 10);
+        push_packet(writer, packet, 59);
+        push_packet(writer, packet, 70);
+        push_packet(writer, packet, 65);   // time going back stays in the part
+        push_packet(writer, packet, 3601);
+    }
+    EXPECT_EQ((std::set<std::string>{"dump-19700101-000000.pcap", "dump-19700101-000100.pcap",
+                                     "dump-19700101-010000.pcap"}), files());
+    const std::size_t record {RecordHeader + packet.size()};
+    EXPECT_EQ(FileHeader + 2 * record, content(directory + "/dump-19700101-000000.pcap").size());
+    EXPECT_EQ(FileHeader + 2 * record, content(directory + "/dump-19700101-000100.pcap").size());
+    EXPECT_EQ(FileHeader + record, content(directory + "/dump-19700101-010000.pcap").size());
+}
+
+TEST_F(DumpFile, index_is_cleared_if_it_is_not_written)
+{
+    DumpIndex index{1, DLT_EN10MB, false};
+    const std::vector<u_char> packet {tcp_packet(1, 1000, 2, 2049, 100)};
+    pcap_pkthdr header;
+    header.ts.tv_sec  = 100;
+    header.ts.tv_usec = 0;
+    header.caplen     = packet.size();
+    header.len        = packet.size();
+    index.add(&header, packet.data(), FileHeader, 0);
+    EXPECT_THROW(index.write(directory + "/missing/dump.pcap"), std::system_error);
+    EXPECT_TRUE(index.times().empty());
+    EXPECT_TRUE(index.flows().empty());
+
+    header.ts.tv_sec = 200;
+    index.add(&header, packet.data(), FileHeader, 0);
+    index.write(name(0));
+
+    DumpIndex next;
+    ASSERT_TRUE(next.read(name(0)));
+    ASSERT_EQ(1U, next.times().size());
+    EXPECT_EQ(200U, next.times()[0].sec);
+    ASSERT_EQ(1U, next.flows().size());
+    EXPECT_EQ(1U, next.flows()[0].packets);
+}
+
+TEST_F(DumpFile, damaged_index_is_not_read)
+{
+    {
+        DumpWriter::Params p {params(0)};
+        p.index = 1;
+        DumpWriter writer{p};
+        push_packet(writer, tcp_packet(1, 1000, 2, 2049, 100), 100);
+    }
+    const std::string file {DumpIndex::path(name(0))};
+    std::string data {content(file)};
+    ASSERT_LT(sizeof(DumpIndex::Header), data.size());
+    auto rewrite = [&file](const std::string& bytes)
+    {
+        std::ofstream out{file, std::ios::binary | std::ios::trunc};
+        out << bytes;
+    };
+
+    DumpIndex::Header h;
+    memcpy(&h, data.data(), sizeof(h));
+    h.times = UINT64_MAX / 2;   // too big to allocate
+    memcpy(&data[0], &h, sizeof(h));
+    rewrite(data);
+    DumpIndex index;
+    EXPECT_FALSE(index.read(name(0)));
+
+    h.times = 0;
+    h.flows = 1 << 30;          // more than the file has
+    memcpy(&data[0], &h, sizeof(h));
+    rewrite(data);
+    EXPECT_FALSE(index.read(name(0)));
+
+    rewrite(data.substr(0, sizeof(h) - 1));
+    EXPECT_FALSE(index.read(name(0)));
+}
+
+TEST_F(DumpFile, index_of_compressed_part_points_to_members)
+{
+    const std::vector<u_char> packet {tcp_packet(1, 1000, 2, 2049, 1000)};
+    {
+        DumpWriter::Params p {params(0, DumpWriter::Compression::Gzip)};
+        p.index = 1;
+        DumpWriter writer{p};
+        for(uint32_t i = 0; i < 6; ++i)
+        {
+            push_packet(writer, packet, i);
+            if(i % 2)
+            {
+                writer.flush(); // two records in a member
+            }
+        }
+    }
+    DumpIndex index;
+    ASSERT_TRUE(index.read(name(0) + ".gz"));
+    EXPECT_EQ(DumpIndex::GzipMembers, index.header().flags);
+    ASSERT_EQ(6U, index.times().size());
+
+    const std::string data {content(name(0) + ".gz")};
+    for(const auto& time : index.times())
+    {
+        // a member is decompressed without preceding ones
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        ASSERT_EQ(Z_OK, inflateInit2(&stream, 15 + 16));
+        std::vector<uint8_t> member(64 * 1024);
+        stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + time.offset));
+        stream.avail_in  = data.size() - time.offset;
+        stream.next_out  = member.data();
+        stream.avail_out = member.size();
+        EXPECT_EQ(Z_STREAM_END, inflate(&stream, Z_FINISH));
+        inflateEnd(&stream);
+
+        uint32_t seconds;
+        memcpy(&seconds, member.data() + time.skip, sizeof(seconds));
+        EXPECT_EQ(time.sec, seconds);
+        EXPECT_EQ(time.record % 2 ? RecordHeader + packet.size() : 0U, time.skip);
+    }
+}
+//------------------------------------------------------------------------------
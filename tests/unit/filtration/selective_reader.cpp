@@ -0,0 +1,293 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of time range and flow selective reading of .pcap files
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <dirent.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "filtration/dump_writer.h"
+#include "filtration/pcap/selective_reader.h"
+//------------------------------------------------------------------------------
+using namespace NST::filtration;
+using NST::filtration::pcap::SelectiveReader;
+//------------------------------------------------------------------------------
+namespace
+{
+
+class SelectiveFile : public ::testing::Test
+{
+protected:
+    SelectiveFile()
+    {
+        char temp[] {"/tmp/nfstrace-test-XXXXXX"};
+        directory = mkdtemp(temp);
+        path = directory + "/dump.pcap";
+    }
+
+    ~SelectiveFile()
+    {
+        if(DIR* dir = opendir(directory.c_str()))
+        {
+            while(const dirent* entry = readdir(dir))
+            {
+                if(entry->d_name[0] != '.')
+                {
+                    unlink((directory + '/' + entry->d_name).c_str());
+                }
+            }
+            closedir(dir);
+        }
+        rmdir(directory.c_str());
+    }
+
+    //! Dumps packets of two flows, step seconds apart, to the single part,
+    //! the second flow stops after the first 'second' packets
+    void dump(int packets, uint32_t payload, uint32_t index,
+              DumpWriter::Compression compression = DumpWriter::Compression::None,
+              uint32_t step = 1, int second = -1)
+    {
+        DumpWriter writer{DumpWriter::Params{path, "", 0, 0, 0, index, 1, 65535, compression, 1, 2}};
+        for(int i = 0; i < packets; ++i)
+        {
+            const bool in_second {i % 2 && (second < 0 || i < second)};
+            const std::vector<u_char> packet {in_second ? tcp_packet(3, 801, 2, 2049, payload)
+                                                        : tcp_packet(1, 800, 2, 2049, payload)};
+            pcap_pkthdr header;
+            header.ts.tv_sec  = 1000 + i * step;
+            header.ts.tv_usec = 500;
+            header.caplen     = packet.size();
+            header.len        = packet.size();
+            // the ring may be full, the writer is given a time to catch up
+            while(!writer.push(&header, packet.data()))
+            {
+                usleep(1000);
+            }
+        }
+    }
+
+    //! Seconds of packets passed by reader
+    std::vector<uint32_t> read(SelectiveReader& reader)
+    {
+        std::vector<uint32_t> seconds;
+        EXPECT_TRUE(reader.loop(&seconds, callback));
+        reader.print_statistic(statistic);
+        return seconds;
+    }
+
+    static void callback(u_char* user, const pcap_pkthdr* header, const u_char* /*packet*/)
+    {
+        reinterpret_cast<std::vector<uint32_t>*>(user)->push_back(header->ts.tv_sec);
+    }
+
+    static std::vector<u_char> tcp_packet(uint8_t src, uint16_t sport, uint8_t dst, uint16_t dport, uint32_t payload)
+    {
+        std::vector<u_char> packet(14 + 20 + 20 + payload, 0);
+        packet[12] = 0x08;                  // IP
+        u_char* ip {&packet[14]};
+        ip[0] = 0x45;                       // version and IHL
+        ip[2] = (20 + 20 + payload) >> 8;   // total length
+        ip[3] = (20 + 20 + payload) & 0xff;
+        ip[8] = 64;                         // TTL
+        ip[9] = 6;                          // TCP
+        const u_char src_address[] {10, 0, 0, src};
+        const u_char dst_address[] {10, 0, 0, dst};
+        memcpy(ip + 12, src_address, 4);
+        memcpy(ip + 16, dst_address, 4);
+        u_char* tcp {ip + 20};
+        tcp[0]  = sport >> 8;
+        tcp[1]  = sport & 0xff;
+        tcp[2]  = dport >> 8;
+        tcp[3]  = dport & 0xff;
+        tcp[12] = 0x50;                     // offset of data
+        return packet;
+    }
+
+    static SelectiveReader::Params range(uint32_t start, uint32_t end)
+    {
+        SelectiveReader::Params params;
+        params.start = start * 1000000ULL;
+        params.end   = end   * 1000000ULL;
+        return params;
+    }
+
+    static SelectiveReader::Endpoint endpoint(uint8_t host, uint16_t port)
+    {
+        SelectiveReader::Endpoint endpoint {};
+        endpoint.family = 4;
+        const u_char address[] {10, 0, 0, host};
+        memcpy(endpoint.address, address, sizeof(address));
+        endpoint.port = port;
+        return endpoint;
+    }
+
+    static std::vector<uint32_t> seconds(uint32_t from, uint32_t to, uint32_t step = 1)
+    {
+        std::vector<uint32_t> result;
+        for(uint32_t s = from; s < to; s += step)
+        {
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    std::string directory;
+    std::string path;
+    std::ostringstream statistic;
+};
+
+} // unnamed namespace
+
+TEST_F(SelectiveFile, index_finds_start_of_range)
+{
+    dump(100, 100, 10);
+    SelectiveReader reader{path, range(1055, 1060)};
+    EXPECT_EQ(1, reader.datalink());
+    EXPECT_EQ(65535, reader.snapshot());
+    EXPECT_EQ(seconds(1055, 1060), read(reader));
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("found by  : index"));
+    // from the index entry before the start to the end of range
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("packets read by filtration: 10\n"));
+}
+
+TEST_F(SelectiveFile, binary_search_finds_start_without_index)
+{
+    dump(3000, 1000, 0);
+    SelectiveReader reader{path, range(2500, 2510)};
+    EXPECT_EQ(seconds(2500, 2510), read(reader));
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("found by  : binary search"));
+    // less than the whole file is read
+    const std::string text {statistic.str()};
+    const std::size_t found {text.find("packets read by filtration: ")};
+    ASSERT_NE(std::string::npos, found);
+    EXPECT_LT(atoi(text.c_str() + found + 28), 3000);
+}
+
+TEST_F(SelectiveFile, binary_search_works_in_capture_longer_than_day)
+{
+    // a packet per minute for 50 hours
+    dump(3000, 1000, 0, DumpWriter::Compression::None, 60);
+    const uint32_t start {1000 + 2500 * 60};
+    SelectiveReader reader{path, range(start, start + 600)};
+    EXPECT_EQ(seconds(start, start + 600, 60), read(reader));
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("found by  : binary search"));
+    const std::string text {statistic.str()};
+    const std::size_t found {text.find("packets read by filtration: ")};
+    ASSERT_NE(std::string::npos, found);
+    // no more than the linear search window of about 1000 records is read
+    EXPECT_LT(atoi(text.c_str() + found + 28), 1100);
+}
+
+TEST_F(SelectiveFile, range_before_and_after_capture_is_empty)
+{
+    dump(20, 100, 0);
+    {
+        SelectiveReader reader{path, range(1, 1000)};
+        EXPECT_TRUE(read(reader).empty());
+    }
+    {
+        SelectiveReader reader{path, range(2000, 3000)};
+        EXPECT_TRUE(read(reader).empty());
+    }
+    {
+        SelectiveReader reader{path, range(1, 3000)};
+        EXPECT_EQ(seconds(1000, 1020), read(reader));
+    }
+}
+
+TEST_F(SelectiveFile, compressed_part_is_read_from_indexed_member)
+{
+    dump(100, 100, 10, DumpWriter::Compression::Gzip);
+    path += ".gz";
+    SelectiveReader reader{path, range(1055, 1060)};
+    EXPECT_EQ(seconds(1055, 1060), read(reader));
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("found by  : index"));
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("packets read by filtration: 10\n"));
+}
+
+TEST_F(SelectiveFile, compressed_part_without_index_is_scanned)
+{
+    dump(30, 100, 0, DumpWriter::Compression::Gzip);
+    path += ".gz";
+    SelectiveReader reader{path, range(1010, 1015)};
+    EXPECT_EQ(seconds(1010, 1015), read(reader));
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("found by  : scan"));
+}
+
+TEST_F(SelectiveFile, flow_selects_its_packets_in_any_direction)
+{
+    dump(40, 100, 10);
+    SelectiveReader::Params params;
+    params.has_flow = true;
+    params.flow.amount = 2;
+    params.flow.protocol = IPPROTO_TCP;
+    params.flow.endpoints[0] = endpoint(2, 2049);
+    params.flow.endpoints[1] = endpoint(3, 0);
+    SelectiveReader reader{path, params};
+    EXPECT_EQ(seconds(1001, 1040, 2), read(reader));
+}
+
+TEST_F(SelectiveFile, compressed_part_is_read_to_last_packet_of_flow)
+{
+    // packets of the same second in several gzip members
+    dump(3000, 1000, 10, DumpWriter::Compression::Gzip, 0, 1500);
+    path += ".gz";
+    SelectiveReader::Params params;
+    params.has_flow = true;
+    params.flow.amount = 1;
+    params.flow.endpoints[0] = endpoint(3, 801);
+    SelectiveReader reader{path, params};
+    EXPECT_EQ(std::vector<uint32_t>(750, 1000), read(reader));
+    // from the first to the last packet of the flow
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("packets read by filtration: 1499\n"));
+}
+
+TEST_F(SelectiveFile, flow_absent_from_index_reads_nothing)
+{
+    dump(40, 100, 10);
+    SelectiveReader::Params params;
+    params.has_flow = true;
+    params.flow.amount = 1;
+    params.flow.endpoints[0] = endpoint(4, 0);
+    SelectiveReader reader{path, params};
+    EXPECT_TRUE(read(reader).empty());
+    EXPECT_THAT(statistic.str(), testing::HasSubstr("packets read by filtration: 0\n"));
+}
+
+TEST_F(SelectiveFile, not_pcap_file_is_rejected)
+{
+    EXPECT_THROW(SelectiveReader(path, range(1, 2)), std::system_error);
+    {
+        std::ofstream file{path};
+        file << "not a capture, but long enough to have a header";
+    }
+    EXPECT_THROW(SelectiveReader(path, range(1, 2)), std::runtime_error);
+}
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of NFS hex printing helpers
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <iomanip>
+#include <sstream>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "protocols/nfs/nfs_utils.h"
+//------------------------------------------------------------------------------
+using namespace NST::protocols::NFS;
+//------------------------------------------------------------------------------
+namespace
+{
+
+// Formatting by iostream manipulators which print_hex*() must reproduce
+std::string reference_hex(uint64_t value, int width)
+{
+    std::ostringstream out;
+    out << "0x" << std::setfill('0') << std::setw(width) << std::hex << value
+        << std::dec << std::setfill(' ');
+    return out.str();
+}
+
+std::string reference_bytes(const char* data, uint32_t len)
+{
+    std::ostringstream out;
+    out << std::hex << std::setfill('0');
+    for(uint32_t i {0}; i < len; i++)
+    {
+        out << std::setw(2) << ((static_cast<int32_t>(data[i])) & 0xFF);
+    }
+    return out.str();
+}
+
+template<typename Print>
+std::string print(Print p)
+{
+    std::ostringstream out;
+    p(out);
+    // stream must be left in decimal mode with space fill
+    out << ' ' << std::setw(3) << 10;
+    return out.str();
+}
+
+} // unnamed namespace
+//------------------------------------------------------------------------------
+TEST(NFSUtils, print_hex_numbers)
+{
+    const uint64_t values[] = {0U, 0x7U, 0xabU, 0xbeefU, 0xdeadbeefU, 0x0123456789abcdefULL, ~0ULL};
+    const std::string tail {"  10"};
+    for(const uint64_t v : values)
+    {
+        EXPECT_EQ(reference_hex(v, 16) + tail, print([v](std::ostream& o){ print_hex64(o, v); }));
+        EXPECT_EQ(reference_hex(static_cast<uint32_t>(v), 8) + tail,
+                  print([v](std::ostream& o){ print_hex32(o, static_cast<uint32_t>(v)); }));
+        EXPECT_EQ(reference_hex(static_cast<uint16_t>(v), 4) + tail,
+                  print([v](std::ostream& o){ print_hex16(o, static_cast<uint16_t>(v)); }));
+        EXPECT_EQ(reference_hex(static_cast<uint8_t>(v), 2) + tail,
+                  print([v](std::ostream& o){ print_hex8(o, static_cast<uint8_t>(v)); }));
+    }
+}
+
+TEST(NFSUtils, print_hex_arrays)
+{
+    const uint32_t words[] = {0x1U, 0xffU, 0x100U, 0xdeadbeefU};
+    EXPECT_EQ("0x01ff100deadbeef  10", print([&](std::ostream& o){ print_hex(o, words, 4); }));
+    EXPECT_EQ("void  10", print([&](std::ostream& o){ print_hex(o, words, 0); }));
+
+    char data[300];
+    for(std::size_t i {0}; i < sizeof(data); i++)
+    {
+        data[i] = static_cast<char>(i * 37);
+    }
+    EXPECT_EQ("0x" + reference_bytes(data, sizeof(data)) + "  10",
+              print([&](std::ostream& o){ print_hex(o, data, sizeof(data)); }));
+    EXPECT_EQ("void  10", print([&](std::ostream& o){ print_hex(o, data, 0); }));
+}
+
+TEST(NFSUtils, print_nfs_fh)
+{
+    char fh[32];
+    for(std::size_t i {0}; i < sizeof(fh); i++)
+    {
+        fh[i] = static_cast<char>(0xF0 + i);
+    }
+    EXPECT_EQ(reference_bytes(fh, 8) + "  10", print([&](std::ostream& o){ print_nfs_fh(o, fh, 8); }));
+    EXPECT_EQ(reference_bytes(fh, 4) + "..." + reference_bytes(fh + 28, 4) + "  10",
+              print([&](std::ostream& o){ print_nfs_fh(o, fh, sizeof(fh)); }));
+    EXPECT_EQ("void  10", print([&](std::ostream& o){ print_nfs_fh(o, fh, 0); }));
+}
+//------------------------------------------------------------------------------
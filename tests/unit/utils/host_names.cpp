@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of background lookups of host names
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <arpa/inet.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "utils/host_names.h"
+#include "utils/out.h"
+#include "utils/sessions.h"
+//------------------------------------------------------------------------------
+using namespace NST::utils;
+using Status = HostNames::Status;
+//------------------------------------------------------------------------------
+namespace
+{
+
+std::atomic<int> lookups {0};
+
+// names only addresses of 10.0.0.0/8
+bool fake_lookup(const HostNames::Address& address, std::string& name)
+{
+    ++lookups;
+    if(address.bytes[0] != 10)
+    {
+        return false;
+    }
+    name = "host" + std::to_string(address.bytes[3]);
+    return true;
+}
+
+HostNames::Address ipv4(const char* text)
+{
+    in_addr_t address;
+    inet_pton(AF_INET, text, &address);
+    return HostNames::Address{NST::API::Session::IPType::v4, &address};
+}
+
+// polls until the background lookup is done
+Status wait(const HostNames::Address& address, std::string& name)
+{
+    Status status {Status::Pending};
+    for(int i = 0; i < 1000 && status == Status::Pending; ++i)
+    {
+        status = HostNames::find(address, name);
+        if(status == Status::Pending)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    }
+    return status;
+}
+
+} // unnamed namespace
+
+TEST(HostNames, disabled)
+{
+    HostNames::Global names{false, 16, &fake_lookup};
+    std::string name;
+
+    EXPECT_FALSE(HostNames::enabled());
+    EXPECT_EQ(Status::Disabled, HostNames::find(ipv4("10.0.0.1"), name));
+}
+
+TEST(HostNames, lookup_does_not_block)
+{
+    lookups = 0;
+    HostNames::Global names{true, 16, &fake_lookup};
+    std::string name;
+
+    ASSERT_TRUE(HostNames::enabled());
+    const uint64_t completed {HostNames::completed()};
+    EXPECT_EQ(Status::Pending, HostNames::find(ipv4("10.0.0.1"), name));
+    EXPECT_EQ(Status::Resolved, wait(ipv4("10.0.0.1"), name));
+    EXPECT_EQ("host1", name);
+    EXPECT_EQ(1, lookups.load());
+    EXPECT_EQ(completed + 1, HostNames::completed());
+}
+
+TEST(HostNames, failures_are_cached)
+{
+    lookups = 0;
+    HostNames::Global names{true, 16, &fake_lookup};
+    std::string name;
+
+    EXPECT_EQ(Status::Failed, wait(ipv4("192.0.2.1"), name));
+    EXPECT_TRUE(name.empty());
+    EXPECT_EQ(Status::Failed, HostNames::find(ipv4("192.0.2.1"), name));
+    EXPECT_EQ(1, lookups.load());
+}
+
+TEST(HostNames, least_recently_used_is_evicted)
+{
+    lookups = 0;
+    HostNames::Global names{true, 2, &fake_lookup};
+    std::string name;
+
+    EXPECT_EQ(Status::Resolved, wait(ipv4("10.0.0.1"), name));
+    EXPECT_EQ(Status::Resolved, wait(ipv4("10.0.0.2"), name));
+    EXPECT_EQ(Status::Resolved, HostNames::find(ipv4("10.0.0.1"), name)); // 10.0.0.2 is the oldest now
+    EXPECT_EQ(Status::Resolved, wait(ipv4("10.0.0.3"), name));
+    EXPECT_EQ(3, lookups.load());
+
+    EXPECT_EQ(Status::Resolved, HostNames::find(ipv4("10.0.0.1"), name));
+    EXPECT_EQ("host1", name);
+    EXPECT_EQ(Status::Pending, HostNames::find(ipv4("10.0.0.2"), name));
+    EXPECT_EQ(Status::Resolved, wait(ipv4("10.0.0.2"), name));
+    EXPECT_EQ(4, lookups.load());
+}
+
+TEST(HostNames, session_is_named_later)
+{
+    Out::Global gout{Out::Level::All};
+    HostNames::Global names{true, 16, &fake_lookup};
+
+    NetworkSession network;
+    network.type      = Session::Type::TCP;
+    network.ip_type   = Session::IPType::v4;
+    network.direction = Session::Source;
+    network.port[Session::Source]      = htons(1021);
+    network.port[Session::Destination] = htons(2049);
+    inet_pton(AF_INET, "10.0.0.7", &network.ip.v4.addr[Session::Source]);
+    inet_pton(AF_INET, "192.0.2.1", &network.ip.v4.addr[Session::Destination]);
+
+    const ApplicationSession session{network, Session::Source};
+    EXPECT_EQ("10.0.0.7:1021 --> 192.0.2.1:2049 [TCP]", session.str());
+
+    std::string name;
+    ASSERT_EQ(Status::Resolved, wait(ipv4("10.0.0.7"), name));
+    ASSERT_EQ(Status::Failed, wait(ipv4("192.0.2.1"), name));
+    EXPECT_EQ("10.0.0.7:1021(host7:" + HostNames::service(htons(1021)) + ") --> 192.0.2.1:2049 [TCP]", session.str());
+}
+
+TEST(HostNames, session_names_are_told_once)
+{
+    Out::Global gout{Out::Level::All};
+    HostNames::Global names{true, 16, &fake_lookup};
+
+    NetworkSession network;
+    network.type      = Session::Type::TCP;
+    network.ip_type   = Session::IPType::v4;
+    network.direction = Session::Source;
+    network.port[Session::Source]      = htons(1022);
+    network.port[Session::Destination] = htons(2049);
+    inet_pton(AF_INET, "10.0.0.8", &network.ip.v4.addr[Session::Source]);
+    inet_pton(AF_INET, "10.0.0.9", &network.ip.v4.addr[Session::Destination]);
+
+    ApplicationSession session{network, Session::Source};
+    std::string name;
+    ASSERT_EQ(Status::Resolved, wait(ipv4("10.0.0.8"), name));
+    ASSERT_EQ(Status::Resolved, wait(ipv4("10.0.0.9"), name));
+
+    EXPECT_EQ("10.0.0.8:1022(host8:" + HostNames::service(htons(1022)) +
+              ") --> 10.0.0.9:2049(host9:" + HostNames::service(htons(2049)) + ") [TCP]", session.str());
+    EXPECT_TRUE(session.names_resolved());
+    EXPECT_FALSE(session.names_resolved());
+}
+
+TEST(HostNames, unknown_service_is_numeric)
+{
+    HostNames::Global names{true, 16, &fake_lookup};
+    EXPECT_EQ("65531", HostNames::service(htons(65531)));
+    EXPECT_FALSE(HostNames::service(htons(2049)).empty());
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,225 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of asynchronous logger
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <cinttypes>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "utils/log.h"
+//------------------------------------------------------------------------------
+using namespace NST::utils;
+//------------------------------------------------------------------------------
+namespace
+{
+
+class LogFile : public ::testing::Test
+{
+protected:
+    LogFile()
+    : path {"nfstrace-test-" + std::to_string(getpid()) + ".log"}
+    {
+    }
+
+    ~LogFile()
+    {
+        unlink(path.c_str());
+    }
+
+    std::string content() const
+    {
+        std::ifstream file{path};
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    std::string path;
+};
+
+void log_repeatedly(int amount)
+{
+    for(int i = 0; i < amount; ++i)
+    {
+        LOG("repeated message %d", i);
+    }
+}
+
+} // unnamed namespace
+
+TEST_F(LogFile, arguments_are_formatted_by_writer)
+{
+    {
+        Log::Global glog{path};
+        const std::string name {"session"};
+        const uint64_t xid {0xFFFFFFFFFFULL};
+        LOG("string:%s int:%d unsigned:%u hex:%x char:%c double:%5.2f", name.c_str(), -5, 7U, 255, 'z', 3.14159);
+        LOG("xid:%" PRIu64 " size:%zu long:%lu percent:100%%", xid, sizeof(int), 42UL);
+        LOG("missing argument:%s", "");
+        LOG("missing argument:%s %u");
+        LOG("null:%s", static_cast<const char*>(nullptr));
+    }
+    const std::string text {content()};
+    EXPECT_NE(std::string::npos, text.find("string:session int:-5 unsigned:7 hex:ff char:z double: 3.14\n"));
+    EXPECT_NE(std::string::npos, text.find("xid:1099511627775 size:4 long:42 percent:100%\n"));
+    EXPECT_NE(std::string::npos, text.find("missing argument:\n"));
+    EXPECT_NE(std::string::npos, text.find("missing argument:%s %u\n"));
+    EXPECT_NE(std::string::npos, text.find("null:(null)\n"));
+}
+
+TEST_F(LogFile, long_strings_are_truncated)
+{
+    {
+        Log::Global glog{path};
+        const std::string wide(1000, 'w');
+        LOG("wide:%s:%s", wide.c_str(), "next");
+    }
+    const std::string text {content()};
+    const std::size_t begin {text.find("wide:")};
+    ASSERT_NE(std::string::npos, begin);
+    const std::size_t end {text.find(":...\n", begin)};
+    ASSERT_NE(std::string::npos, end);
+    EXPECT_EQ(sizeof(Log::Record::strings) - 1, end - begin - 5);
+}
+
+TEST_F(LogFile, records_of_threads_are_ordered)
+{
+    {
+        Log::Global glog{path};
+        auto work = [](const char* name)
+        {
+            for(int i = 0; i < 40; ++i)
+            {
+                LOG("thread %s record %d", name, i);
+            }
+        };
+        std::thread first{work, "first"};
+        std::thread second{work, "second"};
+        first.join();
+        second.join();
+        Log::flush();
+
+        const std::string text {content()};
+        std::size_t first_pos {0};
+        std::size_t second_pos {0};
+        for(int i = 0; i < 40; ++i)
+        {
+            const std::string suffix {" record " + std::to_string(i) + "\n"};
+            const std::size_t f {text.find("thread first" + suffix)};
+            const std::size_t s {text.find("thread second" + suffix)};
+            ASSERT_NE(std::string::npos, f);
+            ASSERT_NE(std::string::npos, s);
+            EXPECT_LT(first_pos, f + 1);
+            EXPECT_LT(second_pos, s + 1);
+            first_pos = f;
+            second_pos = s;
+        }
+    }
+}
+
+TEST_F(LogFile, call_site_is_rate_limited)
+{
+    const int amount {250};
+    {
+        Log::Global glog{path};
+        log_repeatedly(amount);
+        // suppressed records are reported by the next record of the site
+        std::this_thread::sleep_for(std::chrono::milliseconds{1100});
+        log_repeatedly(1);
+    }
+    const std::string text {content()};
+    int written {0};
+    int suppressed {0};
+    std::istringstream lines{text};
+    for(std::string line; std::getline(lines, line); )
+    {
+        if(line.find("repeated message") == std::string::npos) continue;
+        ++written;
+        const std::size_t note {line.find(" (")};
+        if(note != std::string::npos)
+        {
+            suppressed += std::stoi(line.substr(note + 2));
+        }
+    }
+    EXPECT_GT(suppressed, 0);
+    EXPECT_EQ(amount + 1, written + suppressed);
+}
+
+TEST_F(LogFile, stream_message_is_written_whole)
+{
+    {
+        Log::Global glog{path};
+        static Log::Site site;
+        if(Log message{site})
+        {
+            message << "report:" << std::string(1000, 'r') << ":end";
+        }
+    }
+    const std::string text {content()};
+    EXPECT_NE(std::string::npos, text.find("\nreport:" + std::string(1000, 'r') + ":end"));
+}
+
+TEST_F(LogFile, stream_messages_are_rate_limited)
+{
+    const int amount {250};
+    {
+        Log::Global glog{path};
+        static Log::Site site;
+        int enabled {0};
+        for(int i {0}; i < amount; ++i)
+        {
+            if(Log message{site})
+            {
+                message << "stream message";
+                ++enabled;
+            }
+        }
+        EXPECT_LE(enabled, static_cast<int>(Log::Site::MaxPerSecond) * 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds{1100});
+        if(Log message{site})
+        {
+            message << "stream message";
+        }
+    }
+    const std::string text {content()};
+    int written {0};
+    int suppressed {0};
+    std::istringstream lines{text};
+    for(std::string line; std::getline(lines, line); )
+    {
+        if(line.find("stream message") == std::string::npos) continue;
+        ++written;
+        const std::size_t note {line.find(" (")};
+        if(note != std::string::npos)
+        {
+            suppressed += std::stoi(line.substr(note + 2));
+        }
+    }
+    EXPECT_GT(suppressed, 0);
+    EXPECT_EQ(amount + 1, written + suppressed);
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of metrics of the pipeline health
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <sstream>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "utils/metrics.h"
+//------------------------------------------------------------------------------
+using namespace NST::utils;
+using MetricsStat = NST::API::MetricsStat;
+//------------------------------------------------------------------------------
+TEST(Metrics, fixed_metrics)
+{
+    MetricsStat::Snapshot s;
+    Metrics::statistic().snapshot(s);
+    ASSERT_GE(s.size, static_cast<uint32_t>(Metrics::Count));
+    EXPECT_STREQ("queue_elements", s.metrics[Metrics::QueueElements].name);
+    EXPECT_STREQ("queue_exhausted", s.metrics[Metrics::QueueExhausted].name);
+    EXPECT_STREQ("tcp_lost_bytes", s.metrics[Metrics::TCPLostBytes].name);
+    EXPECT_STREQ("parsing_round", s.metrics[Metrics::ParsingRound].name);
+    EXPECT_STREQ("kernel_drops", s.metrics[Metrics::KernelDrops].name);
+    EXPECT_STREQ("procedures", s.metrics[Metrics::Procedures].name);
+    EXPECT_TRUE(nullptr == s.probes); // set by analysis for modules
+    EXPECT_TRUE(MetricsStat::Type::Gauge == s.metrics[Metrics::Sessions].type);
+    EXPECT_TRUE(MetricsStat::Type::Histogram == s.metrics[Metrics::MessageBytes].type);
+}
+
+TEST(Metrics, define_is_idempotent)
+{
+    const uint32_t id {Metrics::define("test_counter", "Counter of test.", MetricsStat::Type::Counter)};
+    EXPECT_GE(id, static_cast<uint32_t>(Metrics::Count));
+    EXPECT_EQ(id, Metrics::define("test_counter", "Counter of test.", MetricsStat::Type::Counter));
+    EXPECT_NE(id, Metrics::define("test_gauge", "Gauge of test.", MetricsStat::Type::Gauge));
+}
+
+TEST(Metrics, gauge_is_changed_by_different_threads)
+{
+    const uint32_t id {Metrics::define("test_gauge", "Gauge of test.", MetricsStat::Type::Gauge)};
+    // elements are allocated by one thread and freed by another one
+    std::thread producer{[id]() { for(int i = 0; i < 1000; ++i) Metrics::add(id, 1); }};
+    producer.join();
+    std::thread consumer{[id]() { for(int i = 0; i < 600; ++i) Metrics::add(id, -1); }};
+    consumer.join();
+
+    MetricsStat::Snapshot s;
+    Metrics::statistic().snapshot(s);
+    const MetricsStat::Metric* gauge {s.find("test_gauge")};
+    ASSERT_NE(nullptr, gauge);
+    EXPECT_EQ(400, gauge->value);
+    EXPECT_EQ(0U, gauge->count);
+    EXPECT_EQ(nullptr, s.find("unknown"));
+}
+
+TEST(Metrics, histograms_of_threads_are_merged)
+{
+    const uint32_t id {Metrics::define("test_histogram", "Histogram of test.", MetricsStat::Type::Histogram)};
+    auto record = [id]()
+    {
+        Metrics::record(id, 0);     // bucket 0
+        Metrics::record(id, 3);     // bucket 1
+        Metrics::record(id, 1000);  // bucket 9
+    };
+    std::thread first{record};
+    std::thread second{record};
+    first.join();
+    second.join();
+
+    MetricsStat::Snapshot s;
+    Metrics::statistic().snapshot(s);
+    const MetricsStat::Metric& m = s.metrics[id];
+    EXPECT_EQ(6U, m.count);
+    EXPECT_EQ(2006, m.value);
+    EXPECT_EQ(2U, m.buckets[0]);
+    EXPECT_EQ(2U, m.buckets[1]);
+    EXPECT_EQ(2U, m.buckets[9]);
+    EXPECT_DOUBLE_EQ(2006.0 / 6, m.mean());
+    // upper bounds of buckets
+    EXPECT_EQ(4U, m.quantile(0.5));
+    EXPECT_EQ(1024U, m.quantile(0.99));
+}
+
+TEST(Metrics, print)
+{
+    Metrics::add(Metrics::QueueExhausted, 1);
+
+    std::ostringstream out;
+    Metrics::print(out);
+    EXPECT_NE(std::string::npos, out.str().find("Metrics:"));
+    EXPECT_NE(std::string::npos, out.str().find("queue_exhausted"));
+    EXPECT_NE(std::string::npos, out.str().find("test_histogram"));
+}
+//------------------------------------------------------------------------------
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of latency probes
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <sstream>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "utils/probes.h"
+//------------------------------------------------------------------------------
+using namespace NST::utils;
+using ProbeStat = NST::API::ProbeStat;
+//------------------------------------------------------------------------------
+TEST(Probes, fixed_probes)
+{
+    const ProbeStat& stat = Probes::statistic();
+    ASSERT_GE(stat.size(), static_cast<uint32_t>(Probes::Count));
+    EXPECT_STREQ("capture",    stat.names[Probes::Capture]);
+    EXPECT_STREQ("reassembly", stat.names[Probes::Reassembly]);
+    EXPECT_STREQ("framing",    stat.names[Probes::Framing]);
+    EXPECT_STREQ("queue_wait", stat.names[Probes::QueueWait]);
+    EXPECT_STREQ("xdr_decode", stat.names[Probes::XDRDecode]);
+}
+
+TEST(Probes, add_is_idempotent)
+{
+    const uint32_t id {Probes::add("dispatch:test")};
+    EXPECT_GE(id, static_cast<uint32_t>(Probes::Count));
+    EXPECT_EQ(id, Probes::add("dispatch:test"));
+    EXPECT_NE(id, Probes::add("dispatch:other"));
+}
+
+TEST(Probes, disabled_scope_records_nothing)
+{
+    ASSERT_FALSE(Probes::enabled());
+    const uint32_t id {Probes::add("disabled")};
+    {
+        Probes::Scope probe{id};
+    }
+    ProbeStat::Summary s;
+    Probes::statistic().summary(id, s);
+    EXPECT_EQ(0U, s.count);
+}
+
+TEST(Probes, histograms_of_threads_are_merged)
+{
+    const uint32_t id {Probes::add("merged")};
+    auto record = [id]()
+    {
+        Probes::record(id, 1);      // bucket 0
+        Probes::record(id, 3);      // bucket 1
+        Probes::record(id, 1000);   // bucket 9
+    };
+    std::thread first{record};
+    std::thread second{record};
+    first.join();
+    second.join();
+
+    ProbeStat::Summary s;
+    Probes::statistic().summary(id, s);
+    EXPECT_EQ(6U, s.count);
+    EXPECT_EQ(2U, s.buckets[0]);
+    EXPECT_EQ(2U, s.buckets[1]);
+    EXPECT_EQ(2U, s.buckets[9]);
+    EXPECT_DOUBLE_EQ(2008.0 * s.ns_per_tick, s.total_ns);
+    EXPECT_DOUBLE_EQ(1000.0 * s.ns_per_tick, s.max_ns);
+    // upper bounds of buckets, limited by max
+    EXPECT_DOUBLE_EQ(4.0 * s.ns_per_tick, s.quantile_ns(0.5));
+    EXPECT_DOUBLE_EQ(1000.0 * s.ns_per_tick, s.quantile_ns(0.99));
+}
+
+TEST(Probes, enabled_scope_records_and_prints)
+{
+    Probes::enable();
+    ASSERT_TRUE(Probes::enabled());
+    EXPECT_GT(Probes::statistic().ns_per_tick.load(), 0.0);
+
+    const uint32_t id {Probes::add("enabled")};
+    for(int i = 0; i < 10; ++i)
+    {
+        Probes::Scope probe{id};
+    }
+    ProbeStat::Summary s;
+    Probes::statistic().summary(id, s);
+    EXPECT_EQ(10U, s.count);
+
+    std::ostringstream out;
+    Probes::print(out);
+    EXPECT_NE(std::string::npos, out.str().find("enabled"));
+    EXPECT_NE(std::string::npos, out.str().find("merged"));
+    EXPECT_EQ(std::string::npos, out.str().find("disabled"));
+}
+//------------------------------------------------------------------------------
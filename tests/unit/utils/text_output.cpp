@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------
+// Author: agent
+// Description: Tests of fast integer formatting and block buffer of text output
+// Copyright (c) 2015 EPAM Systems
+//------------------------------------------------------------------------------
+/*
+    This file is part of Nfstrace.
+
+    Nfstrace is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, version 2 of the License.
+
+    Nfstrace is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Nfstrace.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//------------------------------------------------------------------------------
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "utils/block_buffer.h"
+#include "utils/fast_num_put.h"
+//------------------------------------------------------------------------------
+using namespace NST::utils;
+//------------------------------------------------------------------------------
+namespace
+{
+
+// Formats value by the same manipulators with and without FastNumPut
+template<typename T, typename Format>
+void expect_same(T value, Format format)
+{
+    std::ostringstream expected;
+    std::ostringstream actual;
+    imbue_fast_num_put(actual);
+
+    format(expected);
+    expected << value << '|' << value;
+    format(actual);
+    actual << value << '|' << value;
+    EXPECT_EQ(expected.str(), actual.str());
+}
+
+template<typename T>
+void expect_same_formats(T value)
+{
+    expect_same(value, [](std::ostream&){});
+    expect_same(value, [](std::ostream& o){ o << std::hex; });
+    expect_same(value, [](std::ostream& o){ o << std::setfill('0') << std::setw(8) << std::hex; });
+    expect_same(value, [](std::ostream& o){ o << std::setw(25); });
+    expect_same(value, [](std::ostream& o){ o << std::left << std::setfill('.') << std::setw(25); });
+    expect_same(value, [](std::ostream& o){ o << std::internal << std::setw(25); });
+    expect_same(value, [](std::ostream& o){ o << std::showbase << std::hex << std::setw(20); });
+    expect_same(value, [](std::ostream& o){ o << std::uppercase << std::hex; });
+    expect_same(value, [](std::ostream& o){ o << std::showpos; });
+    expect_same(value, [](std::ostream& o){ o << std::oct; });
+}
+
+class CountingBuffer : public std::stringbuf
+{
+public:
+    std::size_t writes {0};
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        ++writes;
+        return std::stringbuf::xsputn(s, n);
+    }
+};
+
+} // unnamed namespace
+//------------------------------------------------------------------------------
+TEST(FastNumPut, same_as_num_put)
+{
+    expect_same_formats(0);
+    expect_same_formats(7U);
+    expect_same_formats(-1);
+    expect_same_formats(static_cast<short>(-300));
+    expect_same_formats(static_cast<unsigned short>(65535));
+    expect_same_formats(std::numeric_limits<int32_t>::min());
+    expect_same_formats(std::numeric_limits<uint32_t>::max());
+    expect_same_formats(std::numeric_limits<int64_t>::min());
+    expect_same_formats(std::numeric_limits<int64_t>::max());
+    expect_same_formats(std::numeric_limits<uint64_t>::max());
+    expect_same_formats(1234567890123ULL);
+    expect_same_formats(-1234567890123LL);
+    expect_same_formats(true);
+    expect_same_formats(3.25);
+}
+
+TEST(BlockBuffer, writes_in_blocks)
+{
+    CountingBuffer sink;
+    {
+        BlockBuffer buffer{&sink, 64};
+        std::ostream out{&buffer};
+        for(int i = 0; i < 100; i++)
+        {
+            out << "line " << i << '\n';
+        }
+        EXPECT_LT(sink.writes, 20U);
+        out << std::string(200, 'x'); // larger than block
+        out.flush();
+    }
+
+    std::ostringstream expected;
+    for(int i = 0; i < 100; i++)
+    {
+        expected << "line " << i << '\n';
+    }
+    expected << std::string(200, 'x');
+    EXPECT_EQ(expected.str(), sink.str());
+}
+
+TEST(BlockBuffer, flushes_on_destruction)
+{
+    std::stringbuf sink;
+    {
+        BlockBuffer buffer{&sink, 1024};
+        std::ostream out{&buffer};
+        out << "pending";
+        EXPECT_EQ("", sink.str());
+    }
+    EXPECT_EQ("pending", sink.str());
+}
+//------------------------------------------------------------------------------